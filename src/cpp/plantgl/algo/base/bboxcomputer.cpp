@@ -66,9 +66,7 @@ using namespace std;
 
 #define GEOM_BBOXCOMPUTER_CHECK_CACHE(geom) \
   if (!geom->unique()) { \
-    Cache<BoundingBoxPtr>::Iterator _it = __cache.find(geom->getObjectId()); \
-    if (! (_it == __cache.end())) { \
-       __bbox = _it->second; \
+    if (__cache.find(geom->getObjectId(), geom->getDeepModificationStamp(), __bbox)) { \
       return true; \
     }; \
   };
@@ -76,7 +74,7 @@ using namespace std;
 
 #define GEOM_BBOXCOMPUTER_UPDATE_CACHE(geom) \
   if (!geom->unique()) \
-     __cache.insert(geom->getObjectId(),__bbox);
+     __cache.insert(geom->getObjectId(), geom->getDeepModificationStamp(), __bbox, sizeof(BoundingBox));
 
 
 #define GEOM_BBOXCOMPUTER_TRANSFORM_BBOX(matrix) \
@@ -123,9 +121,17 @@ using namespace std;
 /* ----------------------------------------------------------------------- */
 
 
+const size_t BBoxComputer::DEFAULT_CACHE_MAX_SIZE = 64 * 1024 * 1024;
+
+static CacheBudget::Account * bboxCacheAccount()
+{
+  static CacheBudget::Account * account = CacheBudget::getAccount("BBoxComputer");
+  return account;
+}
+
 BBoxComputer::BBoxComputer( Discretizer& discretizer ) :
   Action(),
-  __cache(),
+  __cache(DEFAULT_CACHE_MAX_SIZE, bboxCacheAccount()),
   __bbox(),
   __discretizer(discretizer) {
 }
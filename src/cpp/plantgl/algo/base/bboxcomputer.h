@@ -94,6 +94,15 @@ public:
   /// Clears \e self.
   void clear( );
 
+  typedef LRUCache<BoundingBoxPtr> BoundingBoxCache;
+
+  /// Default memory budget of the cache, in bytes.
+  static const size_t DEFAULT_CACHE_MAX_SIZE;
+
+  /// Returns the cache of bounding boxes, to tune its budget or read its statistics.
+  inline BoundingBoxCache& getCache( ) { return __cache; }
+  inline const BoundingBoxCache& getCache( ) const { return __cache; }
+
   /** Returns the resulting bounding box when applying \e self for the
       last time. */
   BoundingBoxPtr getBoundingBox( );
@@ -223,7 +232,7 @@ public:
 protected:
 
   /// The cache storing the already computed bounding boxes.
-  Cache<BoundingBoxPtr> __cache;
+  BoundingBoxCache __cache;
 
   /// The resulting bounding box.
   BoundingBoxPtr __bbox;
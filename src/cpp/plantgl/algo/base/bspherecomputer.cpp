@@ -60,9 +60,7 @@ using namespace std;
 
 #define GEOM_BSPHERECOMPUTER_CHECK_CACHE(geom) \
   if (!geom->unique()) { \
-    Cache<BoundingSpherePtr>::Iterator _it = __cache.find(geom->getObjectId()); \
-    if (! (_it == __cache.end())) { \
-       __result = _it->second; \
+    if (__cache.find(geom->getObjectId(), geom->getDeepModificationStamp(), __result)) { \
       return true; \
     }; \
   };
@@ -70,7 +68,7 @@ using namespace std;
 
 #define GEOM_BSPHERECOMPUTER_UPDATE_CACHE(geom) \
   if (!geom->unique()) \
-     __cache.insert(geom->getObjectId(),__result);
+     __cache.insert(geom->getObjectId(), geom->getDeepModificationStamp(), __result, sizeof(BoundingSphere));
 
 
 #define GEOM_BSPHERECOMPUTER_DISCRETIZE(geom) \
@@ -127,8 +125,17 @@ using namespace std;
 /* ----------------------------------------------------------------------- */
 
 
+const size_t BSphereComputer::DEFAULT_CACHE_MAX_SIZE = 64 * 1024 * 1024;
+
+static CacheBudget::Account * bsphereCacheAccount()
+{
+  static CacheBudget::Account * account = CacheBudget::getAccount("BSphereComputer");
+  return account;
+}
+
 BSphereComputer::BSphereComputer(Discretizer& dis) :
   Action(),
+  __cache(DEFAULT_CACHE_MAX_SIZE, bsphereCacheAccount()),
   __result(),
   __discretizer(dis)
 {
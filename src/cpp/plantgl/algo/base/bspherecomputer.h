@@ -79,6 +79,15 @@ public :
   /// Get the result
   BoundingSpherePtr getResult() const;
 
+  typedef LRUCache<BoundingSpherePtr> BoundingSphereCache;
+
+  /// Default memory budget of the cache, in bytes.
+  static const size_t DEFAULT_CACHE_MAX_SIZE;
+
+  /// Returns the cache of bounding spheres, to tune its budget or read its statistics.
+  inline BoundingSphereCache& getCache( ) { return __cache; }
+  inline const BoundingSphereCache& getCache( ) const { return __cache; }
+
   Discretizer& getDiscretizer();
 
   const Discretizer& getDiscretizer() const;
@@ -333,7 +342,7 @@ public :
 protected :
 
     /// The cache storing the already computed bounding sphere.
-    Cache<BoundingSpherePtr> __cache;
+    BoundingSphereCache __cache;
 
     /// The resulting bounding box.
     BoundingSpherePtr __result;
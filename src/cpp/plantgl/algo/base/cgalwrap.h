@@ -65,7 +65,7 @@ inline Vector3 dir2Vector3(const CgalDirection3& v) { return Vector3(CGAL::to_do
 template<class CgalPoint3>
 inline std::list<CgalPoint3> toPoint3List(const Point3ArrayPtr v) {
     std::list<CgalPoint3> res;
-    for(Point3Array::const_iterator it = v->begin(); it != v->end(); ++it)
+    for(Point3Array::const_iterator it = const_array(*v).begin(); it != const_array(*v).end(); ++it)
         res.push_back(toPoint3<CgalPoint3>(*it));
     return res;
 }
@@ -74,7 +74,7 @@ template<class CgalPoint3>
 inline std::list<CgalPoint3> toPoint3List(const Point3ArrayPtr v, const Index& subset) {
     std::list<CgalPoint3> res;
     for(Index::const_iterator it = subset.begin(); it != subset.end(); ++it)
-        res.push_back(toPoint3<CgalPoint3>(v->getAt(*it)));
+        res.push_back(toPoint3<CgalPoint3>(const_array(*v).getAt(*it)));
     return res;
 }
 
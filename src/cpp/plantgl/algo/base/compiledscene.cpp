@@ -0,0 +1,356 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+
+#include "compiledscene.h"
+#include "tesselator.h"
+#include "parallelexecutor.h"
+#include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/scenegraph/appearance/material.h>
+#include <plantgl/math/util_math.h>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// Triangles of a single shape, compiled by a worker thread.
+struct CompiledScene::ShapeTriangles {
+    std::vector<Vector3> positions;
+    std::vector<Vector3> normals;
+};
+
+/* ----------------------------------------------------------------------- */
+
+CompiledScene::CompiledScene() :
+  RefCountObject()
+{
+}
+
+CompiledScene::CompiledScene(const ScenePtr& scene) :
+  RefCountObject()
+{
+  compile(scene);
+}
+
+CompiledScene::CompiledScene(const InstancedScenePtr& instances) :
+  RefCountObject()
+{
+  compile(instances);
+}
+
+CompiledScene::~CompiledScene()
+{
+}
+
+void
+CompiledScene::clear()
+{
+  __scene = ScenePtr();
+  __instances = InstancedScenePtr();
+  __shapes.clear();
+  __positions.clear();
+  __normals.clear();
+  __shapeids.clear();
+  __triangleids.clear();
+  __materialids.clear();
+  __materials.clear();
+}
+
+void
+CompiledScene::compile(const ScenePtr& scene)
+{
+  clear();
+  update(scene);
+}
+
+size_t
+CompiledScene::update()
+{
+  if (is_valid_ptr(__instances)) {
+      InstancedScenePtr instances = __instances;
+      compile(instances);
+      return instances->size();
+  }
+  return update(__scene);
+}
+
+/* ----------------------------------------------------------------------- */
+
+size_t
+CompiledScene::getDeepModificationStamp(const Shape3DPtr& shape)
+{
+  size_t stamp = shape->getModificationStamp();
+  ShapePtr sh = dynamic_pointer_cast<Shape>(shape);
+  if (is_null_ptr(sh)) return stamp;
+  return pglMax(stamp, deepModificationStamp(sh->getGeometry()));
+}
+
+uint32_t
+CompiledScene::materialIndex(const AppearancePtr& appearance, pgl_hash_map<size_t,uint32_t>& indices)
+{
+  const AppearancePtr& app = (is_valid_ptr(appearance) ? appearance : Material::DEFAULT_MATERIAL);
+  pgl_hash_map<size_t,uint32_t>::const_iterator it = indices.find((size_t)app.get());
+  if (it != indices.end()) return it->second;
+  uint32_t index = __materials.size();
+  __materials.push_back(app);
+  indices[(size_t)app.get()] = index;
+  return index;
+}
+
+static void compileShape(const ExplicitModelPtr& discretization, std::vector<Vector3>& positions, std::vector<Vector3>& normals)
+{
+  TriangleSetPtr triangles = dynamic_pointer_cast<TriangleSet>(discretization);
+  if (is_null_ptr(triangles)) return;
+
+  // Normals of the mesh are not computed in place, as the mesh may be shared with other shapes.
+  bool hasNormals = triangles->hasNormalList();
+  bool ccw = triangles->getCCW();
+  uint32_t nbfaces = triangles->getIndexListSize();
+  positions.reserve(3 * nbfaces);
+  normals.reserve(3 * nbfaces);
+  for (uint32_t i = 0; i < nbfaces; ++i){
+      const Vector3& v0 = triangles->getFacePointAt(i,0);
+      const Vector3& v1 = triangles->getFacePointAt(i,(ccw?1:2));
+      const Vector3& v2 = triangles->getFacePointAt(i,(ccw?2:1));
+      positions.push_back(v0);
+      positions.push_back(v1);
+      positions.push_back(v2);
+      if (hasNormals) {
+          normals.push_back(triangles->getFaceNormalAt(i,0));
+          normals.push_back(triangles->getFaceNormalAt(i,(ccw?1:2)));
+          normals.push_back(triangles->getFaceNormalAt(i,(ccw?2:1)));
+      }
+      else {
+          Vector3 n = cross(v1-v0, v2-v0);
+          n.normalize();
+          normals.push_back(n);
+          normals.push_back(n);
+          normals.push_back(n);
+      }
+  }
+}
+
+size_t
+CompiledScene::update(const ScenePtr& scene)
+{
+  if (is_null_ptr(scene)) { clear(); return 0; }
+
+  // Shapes of the previous compilation that can be reused, by address.
+  pgl_hash_map<size_t,size_t> previous;
+  for (size_t i = 0; i < __shapes.size(); ++i)
+      previous[(size_t)__shapes[i].shape.get()] = i;
+
+  std::vector<ShapeEntry> shapes;
+  // Index of each shape in the previous compilation or in the new compiled shapes.
+  std::vector<std::pair<bool,size_t> > sources;
+  std::vector<Shape3DPtr> tocompile;
+  shapes.reserve(scene->size());
+  sources.reserve(scene->size());
+  for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it){
+      ShapeEntry entry;
+      entry.shape = *it;
+      ShapePtr sh = dynamic_pointer_cast<Shape>(*it);
+      entry.id = (is_valid_ptr(sh) ? sh->getId() : (*it)->getObjectId());
+      entry.stamp = getDeepModificationStamp(*it);
+      entry.material = 0;
+      entry.begin = entry.end = 0;
+      pgl_hash_map<size_t,size_t>::const_iterator itprev = previous.find((size_t)it->get());
+      if (itprev != previous.end() && __shapes[itprev->second].stamp == entry.stamp && __shapes[itprev->second].id == entry.id)
+          sources.push_back(std::pair<bool,size_t>(true, itprev->second));
+      else {
+          sources.push_back(std::pair<bool,size_t>(false, tocompile.size()));
+          tocompile.push_back(*it);
+      }
+      shapes.push_back(entry);
+  }
+
+  // Tesselation of the new and modified shapes. Shared geometries are tesselated once.
+  Tesselator t;
+  std::vector<ExplicitModelPtr> triangulations = t.discretize(tocompile);
+  std::vector<ShapeTriangles> compiled(tocompile.size());
+  ParallelExecutor::get().parallel_for(0, tocompile.size(), [&triangulations, &compiled](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+          compileShape(triangulations[i], compiled[i].positions, compiled[i].normals);
+  });
+
+  // Concatenation in the order of the scene.
+  size_t nbtriangles = 0;
+  for (size_t i = 0; i < shapes.size(); ++i){
+      if (sources[i].first) nbtriangles += __shapes[sources[i].second].end - __shapes[sources[i].second].begin;
+      else nbtriangles += compiled[sources[i].second].positions.size() / 3;
+  }
+
+  std::vector<Vector3> positions, normals;
+  std::vector<uint32_t> shapeids, triangleids, materialids;
+  positions.reserve(3*nbtriangles);
+  normals.reserve(3*nbtriangles);
+  shapeids.reserve(nbtriangles);
+  triangleids.reserve(nbtriangles);
+  materialids.reserve(nbtriangles);
+
+  __materials.clear();
+  pgl_hash_map<size_t,uint32_t> materialindices;
+
+  for (size_t i = 0; i < shapes.size(); ++i){
+      ShapeEntry& entry = shapes[i];
+      ShapePtr sh = dynamic_pointer_cast<Shape>(entry.shape);
+      entry.material = materialIndex(is_valid_ptr(sh) ? sh->getAppearance() : AppearancePtr(), materialindices);
+      entry.begin = shapeids.size();
+      if (sources[i].first) {
+          const ShapeEntry& old = __shapes[sources[i].second];
+          positions.insert(positions.end(), __positions.begin() + 3*old.begin, __positions.begin() + 3*old.end);
+          normals.insert(normals.end(), __normals.begin() + 3*old.begin, __normals.begin() + 3*old.end);
+          triangleids.insert(triangleids.end(), __triangleids.begin() + old.begin, __triangleids.begin() + old.end);
+      }
+      else {
+          ShapeTriangles& triangles = compiled[sources[i].second];
+          positions.insert(positions.end(), triangles.positions.begin(), triangles.positions.end());
+          normals.insert(normals.end(), triangles.normals.begin(), triangles.normals.end());
+          for (uint32_t j = 0; j < triangles.positions.size() / 3; ++j) triangleids.push_back(j);
+      }
+      entry.end = triangleids.size();
+      shapeids.resize(entry.end, entry.id);
+      materialids.resize(entry.end, entry.material);
+  }
+
+  __scene = scene;
+  __shapes.swap(shapes);
+  __positions.swap(positions);
+  __normals.swap(normals);
+  __shapeids.swap(shapeids);
+  __triangleids.swap(triangleids);
+  __materialids.swap(materialids);
+  return tocompile.size();
+}
+
+/* ----------------------------------------------------------------------- */
+
+void
+CompiledScene::compile(const InstancedScenePtr& instances)
+{
+  clear();
+  if (is_null_ptr(instances)) return;
+
+  // Tesselation of the prototypes, in their own frame.
+  const std::vector<GeometryPtr>& prototypes = instances->getPrototypes();
+  std::vector<Shape3DPtr> prototypeshapes;
+  prototypeshapes.reserve(prototypes.size());
+  for (std::vector<GeometryPtr>::const_iterator it = prototypes.begin(); it != prototypes.end(); ++it)
+      prototypeshapes.push_back(Shape3DPtr(new Shape(*it)));
+  Tesselator t;
+  std::vector<ExplicitModelPtr> triangulations = t.discretize(prototypeshapes);
+  std::vector<ShapeTriangles> compiled(prototypes.size());
+  ParallelExecutor::get().parallel_for(0, prototypes.size(), [&triangulations, &compiled](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i)
+          compileShape(triangulations[i], compiled[i].positions, compiled[i].normals);
+  });
+
+  const std::vector<uint32_t>& prototypeids = instances->getPrototypeIds();
+  const std::vector<Matrix4>& transformations = instances->getTransformations();
+  const std::vector<uint32_t>& instancematerials = instances->getMaterialIds();
+  const std::vector<uint32_t>& instanceids = instances->getShapeIds();
+  size_t nbinstances = instances->size();
+
+  __shapes.resize(nbinstances);
+  size_t nbtriangles = 0;
+  for (size_t i = 0; i < nbinstances; ++i){
+      ShapeEntry& entry = __shapes[i];
+      entry.id = instanceids[i];
+      entry.stamp = 0;
+      entry.material = instancematerials[i];
+      entry.begin = nbtriangles;
+      nbtriangles += compiled[prototypeids[i]].positions.size() / 3;
+      entry.end = nbtriangles;
+  }
+
+  __positions.resize(3*nbtriangles);
+  __normals.resize(3*nbtriangles);
+  __shapeids.resize(nbtriangles);
+  __triangleids.resize(nbtriangles);
+  __materialids.resize(nbtriangles);
+
+  ParallelExecutor::get().parallel_for(0, nbinstances, [this, &compiled, &prototypeids, &transformations](size_t begin, size_t end) {
+      for (size_t i = begin; i < end; ++i) {
+          const ShapeEntry& entry = __shapes[i];
+          const ShapeTriangles& triangles = compiled[prototypeids[i]];
+          const Matrix4& m = transformations[i];
+          Matrix3 normalmatrix = transpose(inverse(Matrix3(m)));
+          // a mirroring transformation reverses the orientation of the triangles.
+          bool mirror = det(Matrix3(m)) < 0;
+          size_t nbvertices = triangles.positions.size();
+          for (size_t j = 0; j < nbvertices; ++j) {
+              size_t k = (mirror ? j - j % 3 + (3 - j % 3) % 3 : j);
+              __positions[3*entry.begin + k] = m * triangles.positions[j];
+              Vector3 n = normalmatrix * triangles.normals[j];
+              n.normalize();
+              __normals[3*entry.begin + k] = n;
+          }
+          for (size_t j = entry.begin; j < entry.end; ++j) {
+              __shapeids[j] = entry.id;
+              __triangleids[j] = j - entry.begin;
+              __materialids[j] = entry.material;
+          }
+      }
+  });
+
+  __materials = instances->getMaterials();
+  for (std::vector<AppearancePtr>::iterator it = __materials.begin(); it != __materials.end(); ++it)
+      if (is_null_ptr(*it)) *it = Material::DEFAULT_MATERIAL;
+  __instances = instances;
+}
+
+/* ----------------------------------------------------------------------- */
+
+Point3ArrayPtr
+CompiledScene::getPointList() const
+{
+  return Point3ArrayPtr(new Point3Array(__positions.begin(), __positions.end()));
+}
+
+Point3ArrayPtr
+CompiledScene::getNormalList() const
+{
+  return Point3ArrayPtr(new Point3Array(__normals.begin(), __normals.end()));
+}
+
+/* ----------------------------------------------------------------------- */
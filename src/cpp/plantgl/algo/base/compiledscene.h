@@ -0,0 +1,213 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+/*! \file compiledscene.h
+    \brief A scene flattened into world space triangle buffers. see CompiledScene.
+*/
+
+#ifndef __compiledscene_h__
+#define __compiledscene_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_array.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/appearance/appearance.h>
+#include <plantgl/scenegraph/container/pointarray.h>
+#include "instancedscene.h"
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+  \class CompiledScene
+  \brief The triangles of a scene, tesselated and transformed once into world space.
+
+  The triangles of all the shapes are stored as a structure of arrays:
+  three vertices and three normals per triangle, and for each triangle the
+  id of its shape, its index in the triangulation of the shape and the
+  index of its appearance in getMaterials(). Triangles are oriented
+  counter clockwise and the triangles of a shape are contiguous, shapes
+  being in the order of the scene. Geometries without surface (points and
+  lines) are ignored.
+
+  Shapes are tesselated in parallel. update() recompiles only the shapes
+  that were added or modified since the last compilation. A shape is
+  modified when the modification stamp of the shape, of its geometry or of
+  a geometry transformed by the chain of Transformed objects has changed.
+  Other changes, as in the content of a mesh modified in place, should be
+  notified with SceneObject::touch().
+
+  An InstancedScene can also be compiled. Each prototype is tesselated
+  once and its triangles are transformed for each instance. A compiled
+  shape is then created per instance, and getScene() returns a null scene.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class ALGO_API CompiledScene : public RefCountObject
+{
+
+public :
+
+  /// Constructor.
+  CompiledScene();
+
+  /// Constructor. Compile \e scene.
+  CompiledScene(const ScenePtr& scene);
+
+  /// Constructor. Compile \e instances.
+  CompiledScene(const InstancedScenePtr& instances);
+
+  /// Destructor.
+  virtual ~CompiledScene();
+
+  /// Compile all the shapes of \e scene.
+  void compile(const ScenePtr& scene);
+
+  /// Compile all the instances of \e instances.
+  void compile(const InstancedScenePtr& instances);
+
+  /// Compile the shapes of the current scene that were modified. Return the number of recompiled shapes.
+  /// Current instances are all recompiled.
+  size_t update();
+
+  /// Compile \e scene, reusing the shapes of the current scene that are not modified. Return the number of recompiled shapes.
+  size_t update(const ScenePtr& scene);
+
+  /// Remove all triangles from \e self.
+  void clear();
+
+  inline const ScenePtr& getScene() const { return __scene; }
+
+  inline const InstancedScenePtr& getInstances() const { return __instances; }
+
+  /// Return the number of triangles.
+  inline size_t nbTriangles() const { return __shapeids.size(); }
+
+  /// Return the number of compiled shapes.
+  inline size_t nbShapes() const { return __shapes.size(); }
+
+  /// Vertices of the triangles, 3 consecutive points per triangle.
+  inline const std::vector<Vector3>& getPositions() const { return __positions; }
+
+  /// Normals at the vertices of the triangles, 3 consecutive normals per triangle.
+  inline const std::vector<Vector3>& getNormals() const { return __normals; }
+
+  /// Id of the shape of each triangle.
+  inline const std::vector<uint32_t>& getShapeIds() const { return __shapeids; }
+
+  /// Index of each triangle in the triangulation of its shape.
+  inline const std::vector<uint32_t>& getTriangleIds() const { return __triangleids; }
+
+  /// Index in getMaterials() of the appearance of each triangle.
+  inline const std::vector<uint32_t>& getMaterialIds() const { return __materialids; }
+
+  /// Appearances of the compiled shapes, without duplicates.
+  inline const std::vector<AppearancePtr>& getMaterials() const { return __materials; }
+
+  inline const Vector3& getTrianglePointAt(size_t triangle, uint_t j) const { return __positions[3*triangle+j]; }
+  inline const Vector3& getTriangleNormalAt(size_t triangle, uint_t j) const { return __normals[3*triangle+j]; }
+  inline const AppearancePtr& getTriangleMaterial(size_t triangle) const { return __materials[__materialids[triangle]]; }
+
+  /// Range [first, last) of the triangles of the \e i-th compiled shape.
+  inline std::pair<size_t,size_t> getShapeTriangleRange(size_t i) const
+  { return std::pair<size_t,size_t>(__shapes[i].begin, __shapes[i].end); }
+
+  /// Id of the \e i-th compiled shape.
+  inline uint32_t getShapeId(size_t i) const { return __shapes[i].id; }
+
+  /// Vertices as a Point3Array.
+  Point3ArrayPtr getPointList() const;
+
+  /// Normals as a Point3Array.
+  Point3ArrayPtr getNormalList() const;
+
+  /// Return a stamp that changes when \e shape, its geometry or one of the arrays and components of the geometry is modified.
+  static size_t getDeepModificationStamp(const Shape3DPtr& shape);
+
+protected:
+
+  struct ShapeEntry {
+      Shape3DPtr shape;
+      uint32_t id;
+      size_t stamp;
+      uint32_t material;
+      size_t begin;
+      size_t end;
+  };
+
+  struct ShapeTriangles;
+
+  uint32_t materialIndex(const AppearancePtr& appearance, pgl_hash_map<size_t,uint32_t>& indices);
+
+  ScenePtr __scene;
+  InstancedScenePtr __instances;
+
+  std::vector<ShapeEntry> __shapes;
+
+  std::vector<Vector3> __positions;
+  std::vector<Vector3> __normals;
+  std::vector<uint32_t> __shapeids;
+  std::vector<uint32_t> __triangleids;
+  std::vector<uint32_t> __materialids;
+
+  std::vector<AppearancePtr> __materials;
+
+};
+
+typedef RCPtr<CompiledScene> CompiledScenePtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+// __compiledscene_h__
+#endif
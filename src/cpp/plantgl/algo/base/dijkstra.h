@@ -47,6 +47,7 @@
 #include <plantgl/tool/util_array.h>
 
 #include <memory>
+#include <vector>
 
 // #define PGL_USE_PRIORITY_QUEUE
 
@@ -125,6 +126,9 @@ struct DijkstraAllocator {
         delete [] colored;
     }
 
+    // Called for each node reached by a query.
+    void touch(uint32_t node) const { }
+
 #ifdef PGL_USE_FIBONACCI_HEAP
     void allocate(size_t nbnodes, dijkstrahandle *& handles)  const {
         handles = new dijkstrahandle[nbnodes];
@@ -189,6 +193,8 @@ public:
     void desallocate(RealArrayPtr distances, uint32_t * parents, color * colored)  const {
     }
 
+    void touch(uint32_t node) const { }
+
 #ifdef PGL_USE_FIBONACCI_HEAP
     void allocate(size_t nbnodes, dijkstrahandle *& handles)  const {
         if (__cache->handles == NULL){
@@ -206,8 +212,105 @@ protected:
 
 };
 
-template<class EdgeWeigthEvaluation, class Allocator>
-DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connections,
+/* 
+   Allocator for repeated queries in a range on the same graph.
+   Arrays are allocated and initialized once. Then only the nodes reached by a query are reset at its end,
+   so that the cost of a query depends on the size of the explored neighborhood and not on the size of the graph.
+   An instance should not be shared between threads.
+*/
+class DijkstraSparseResetAllocator {
+    class Cache {
+    public:
+        size_t nbnodes;
+        RealArrayPtr distances;
+        uint32_t * parents;
+        color * colored;
+        std::vector<uint32_t> touched;
+#ifdef PGL_USE_FIBONACCI_HEAP
+		dijkstrahandle * handles;
+#endif
+
+        Cache() : nbnodes(0), distances(), parents(NULL), colored(NULL), touched()
+#ifdef PGL_USE_FIBONACCI_HEAP
+        , handles(NULL)
+#endif
+        {}
+
+        ~Cache(){ clear(); }
+
+        void clear() {
+            delete [] parents;
+            delete [] colored;
+            parents = NULL;
+            colored = NULL;
+            distances = RealArrayPtr();
+            touched.clear();
+#ifdef PGL_USE_FIBONACCI_HEAP
+            delete [] handles;
+            handles = NULL;
+#endif
+        }
+
+    };
+
+public:
+    DijkstraSparseResetAllocator() : __cache(new Cache()) {}
+    ~DijkstraSparseResetAllocator() {
+        if (__cache) delete __cache;
+    }
+
+    void allocate(size_t nbnodes, RealArrayPtr& distances,  uint32_t *& parents, color *& colored) const {
+        if (__cache->parents == NULL || __cache->nbnodes != nbnodes){
+            __cache->clear();
+            __cache->nbnodes = nbnodes;
+            __cache->distances = RealArrayPtr(new RealArray(nbnodes,REAL_MAX));
+            __cache->parents = new uint32_t[nbnodes];
+            __cache->colored = new color[nbnodes];
+            for (color * itcol = __cache->colored ; itcol != __cache->colored+nbnodes ; ++itcol) *itcol = black;
+            for (uint32_t * itpar = __cache->parents ; itpar != __cache->parents+nbnodes ; ++itpar) *itpar = 0;
+        }
+
+        distances = __cache->distances;
+        parents = __cache->parents;
+        colored = __cache->colored;
+    }
+
+    // Reset only the nodes reached by the last query.
+    void desallocate(RealArrayPtr distances, uint32_t * parents, color * colored)  const {
+        for (std::vector<uint32_t>::const_iterator itnode = __cache->touched.begin(); itnode != __cache->touched.end(); ++itnode){
+            distances->setAt(*itnode, REAL_MAX);
+            parents[*itnode] = 0;
+            colored[*itnode] = black;
+        }
+        __cache->touched.clear();
+    }
+
+    void touch(uint32_t node) const { __cache->touched.push_back(node); }
+
+#ifdef PGL_USE_FIBONACCI_HEAP
+    void allocate(size_t nbnodes, dijkstrahandle *& handles)  const {
+        if (__cache->handles == NULL){
+            __cache->handles = new dijkstrahandle[nbnodes];
+        }
+        handles = __cache->handles;
+    }
+
+    void desallocate( dijkstrahandle * handles ) const {
+    }
+#endif
+
+protected:
+    Cache * __cache;
+
+private:
+    DijkstraSparseResetAllocator(const DijkstraSparseResetAllocator&);
+    DijkstraSparseResetAllocator& operator=(const DijkstraSparseResetAllocator&);
+
+};
+
+// IndexArrayType can be IndexArray or CSRIndexArray.
+template<class IndexArrayType, class EdgeWeigthEvaluation, class Allocator>
+DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const RCPtr<IndexArrayType>& connections,
                                              uint32_t root,
                                              EdgeWeigthEvaluation& distevaluator,
                                              real_t maxdist,
@@ -232,6 +335,7 @@ DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connec
 
      distances->setAt(root,0);
      parents[root] = root;
+     allocator.touch(root);
 
 
      struct nodecompare comp(distances);
@@ -268,8 +372,8 @@ DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connec
 
          nbprocessednodes += 1;
 
-         const Index& nextchildren = connections->getAt(current);
-         for (Index::const_iterator itchildren = nextchildren.begin();
+         const typename IndexArrayType::element_type& nextchildren = const_array(*connections).getAt(current);
+         for (typename IndexArrayType::element_type::const_iterator itchildren = nextchildren.begin();
              itchildren != nextchildren.end(); ++itchildren)
          {
              uint32_t v = *itchildren;
@@ -283,6 +387,7 @@ DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connec
 
                 if (colored[v] == black) {
                     colored[v] = grey;
+                    allocator.touch(v);
 #ifdef PGL_USE_FIBONACCI_HEAP
                     handles[v] = Q.push(v);
 #else
@@ -308,8 +413,8 @@ DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connec
  }
 
 
-template<class EdgeWeigthEvaluation>
-DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connections,
+template<class IndexArrayType, class EdgeWeigthEvaluation>
+DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const RCPtr<IndexArrayType>& connections,
                                              uint32_t root,
                                              EdgeWeigthEvaluation& distevaluator,
                                              real_t maxdist = REAL_MAX,
@@ -317,8 +422,8 @@ DijkstraNodeList  dijkstra_shortest_paths_in_a_range(const IndexArrayPtr& connec
 
  { return dijkstra_shortest_paths_in_a_range(connections,root,distevaluator,maxdist,maxnbelements,DijkstraAllocator());  }
 
-template<class EdgeWeigthEvaluation>
-std::pair<Uint32Array1Ptr,RealArrayPtr>  dijkstra_shortest_paths(const IndexArrayPtr& connections,
+template<class IndexArrayType, class EdgeWeigthEvaluation>
+std::pair<Uint32Array1Ptr,RealArrayPtr>  dijkstra_shortest_paths(const RCPtr<IndexArrayType>& connections,
                                    uint32_t root,
                                    EdgeWeigthEvaluation& distevaluator)
  {
@@ -351,8 +456,8 @@ std::pair<Uint32Array1Ptr,RealArrayPtr>  dijkstra_shortest_paths(const IndexArra
          if(colored[current] == white) continue;
 #endif
          colored[current] = white;
-         const Index& nextchildren = connections->getAt(current);
-         for (Index::const_iterator itchildren = nextchildren.begin();
+         const typename IndexArrayType::element_type& nextchildren = const_array(*connections).getAt(current);
+         for (typename IndexArrayType::element_type::const_iterator itchildren = nextchildren.begin();
              itchildren != nextchildren.end(); ++itchildren)
          {
              uint32_t v = *itchildren;
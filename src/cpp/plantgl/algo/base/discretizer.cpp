@@ -44,14 +44,18 @@
 
 #include "discretizer.h"
 #include "merge.h"
+#include "parallelexecutor.h"
 
 #include <plantgl/pgl_geometry.h>
 #include <plantgl/pgl_transformation.h>
 #include <plantgl/pgl_container.h>
 #include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/scenegraph/scene/scene.h>
 #include <plantgl/scenegraph/function/function.h>
 
 #include <plantgl/math/util_math.h>
+#include <plantgl/tool/util_profiler.h>
+#include <memory>
 
 #ifdef GEOM_DEBUG
 #include <plantgl/tool/timer.h>
@@ -63,12 +67,57 @@ using namespace std;
 
 /* ----------------------------------------------------------------------- */
 
+// Approximative memory size of a discretization, used as its cost in the cache.
+static size_t discretization_memory_size(const ExplicitModelPtr& discretization)
+{
+  size_t result = sizeof(Mesh);
+  if (!discretization) return result;
+  if (discretization->getPointList()) result += discretization->getPointList()->size() * sizeof(Vector3);
+  if (discretization->getColorList()) result += discretization->getColorList()->size() * sizeof(Color4);
+  MeshPtr mesh = dynamic_pointer_cast<Mesh>(discretization);
+  if (mesh) {
+    if (mesh->getNormalList()) result += mesh->getNormalList()->size() * sizeof(Vector3);
+    if (mesh->getTexCoordList()) result += mesh->getTexCoordList()->size() * sizeof(Vector2);
+    result += mesh->getIndexListSize() * 4 * sizeof(uint_t);
+  }
+  return result;
+}
+
+const size_t Discretizer::DEFAULT_CACHE_MAX_SIZE = 256 * 1024 * 1024;
+
+// Discretizers are constructed for each chunk of a parallel discretization. Their account is looked up once.
+static CacheBudget::Account * discretizerCacheAccount()
+{
+  static CacheBudget::Account * account = CacheBudget::getAccount("Discretizer");
+  return account;
+}
+
+SharedDiscretizationCache::SharedDiscretizationCache( ) :
+    RefCountObject(),
+    ConcurrentLRUCache<ExplicitModelPtr>(Discretizer::DEFAULT_CACHE_MAX_SIZE, discretizerCacheAccount()) {
+}
+
+SharedDiscretizationCache::SharedDiscretizationCache( size_t maxcost ) :
+    RefCountObject(),
+    ConcurrentLRUCache<ExplicitModelPtr>(maxcost, discretizerCacheAccount()) {
+}
+
+bool Discretizer::findInCache(size_t id, size_t stamp)
+{
+  if (__sharedCache) return __sharedCache->find(id, stamp, __discretization);
+  return __cache.find(id, stamp, __discretization);
+}
+
+void Discretizer::storeInCache(size_t id, size_t stamp)
+{
+  if (__sharedCache) __sharedCache->insert(id, stamp, __discretization, discretization_memory_size(__discretization));
+  else __cache.insert(id, stamp, __discretization, discretization_memory_size(__discretization));
+}
+
 template <class T> bool Discretizer::check_cache(T * geom)
 {
   if (!geom->unique()) {
-    Cache<ExplicitModelPtr>::Iterator _it = __cache.find(geom->getObjectId());
-    if (! (_it == __cache.end())) {
-       __discretization = ExplicitModelPtr(_it->second);
+    if (findInCache(geom->getObjectId(), geom->getDeepModificationStamp())) {
       if (__discretization) return true;
       else  cerr << "Cache of Discretizer Error !" << endl;
     }
@@ -80,9 +129,9 @@ template <class T> bool Discretizer::check_cache(T * geom)
 template <class T> bool Discretizer::check_cache_with_tex(T * geom)
 {
   if (!geom->unique()) {
-    Cache<ExplicitModelPtr>::Iterator _it = __cache.find(geom->getObjectId());
-    if ((_it != __cache.end()) && (dynamic_pointer_cast<Mesh>(_it->second))->hasTexCoordList()) {
-       __discretization = ExplicitModelPtr(_it->second);
+    // An entry computed without texture coordinates cannot be used if they are requested.
+    if (findInCache(geom->getObjectId(), geom->getDeepModificationStamp()) &&
+        (!__computeTexCoord || (dynamic_pointer_cast<Mesh>(__discretization))->hasTexCoordList())) {
       if (__discretization) return true;
       else  cerr << "Cache of Discretizer Error !" << endl;
     }
@@ -95,7 +144,7 @@ template <class T>
 void Discretizer::update_cache(T * geom) {
   if (!geom->unique()) {
     if(__discretization && geom->isNamed())__discretization->setName(geom->getName());
-    __cache.insert(geom->getObjectId(),__discretization);
+    storeInCache(geom->getObjectId(), geom->getDeepModificationStamp());
   }
 }
 
@@ -125,12 +174,24 @@ bool Discretizer::transformed(T * geom) {
 
 #define GEOM_DISCRETIZER_TRANSFORM(transf) return transformed(transf)
 
+// Points of a curve at increasing parameters. NURBS and Bezier curves evaluate them in one call.
+static Point3ArrayPtr curvePointsAt(const LineicModelPtr& curve, const RealArrayPtr& params)
+{
+  BezierCurvePtr bezier = dynamic_pointer_cast<BezierCurve>(curve);
+  if (bezier) return bezier->getPointsAt(params);
+  Point3ArrayPtr result(new Point3Array(params->size()));
+  Point3Array::iterator itres = result->begin();
+  for (RealArray::const_iterator itu = const_array(*params).begin(); itu != const_array(*params).end(); ++itu, ++itres)
+    *itres = curve->getPointAt(*itu);
+  return result;
+}
+
 /* ----------------------------------------------------------------------- */
 
 
 Discretizer::Discretizer( ) :
     Action(),
-    __cache(),
+    __cache(DEFAULT_CACHE_MAX_SIZE, discretizerCacheAccount()),
     __discretization(),
     __computeTexCoord(false){
 }
@@ -143,6 +204,58 @@ void Discretizer::clear( ) {
   __cache.clear();
 }
 
+Discretizer * Discretizer::newWorker( ) const {
+  Discretizer * worker = new Discretizer();
+  worker->computeTexCoord(__computeTexCoord);
+  return worker;
+}
+
+std::vector<ExplicitModelPtr> Discretizer::discretize( const ScenePtr& scene ) {
+  if (!scene) return std::vector<ExplicitModelPtr>();
+  return discretize(std::vector<Shape3DPtr>(scene->begin(), scene->end()));
+}
+
+std::vector<ExplicitModelPtr> Discretizer::discretize( const std::vector<Shape3DPtr>& shapes ) {
+  PGL_PROFILE_ZONE("Discretizer::discretize");
+  // The objects to discretize: the geometry of each shape, once per geometry.
+  std::vector<SceneObjectPtr> objects;
+  std::vector<size_t> objectOfShape(shapes.size(), size_t(-1));
+  pgl_hash_map<size_t,size_t> objectIndex;
+  for (size_t i = 0; i < shapes.size(); ++i) {
+    if (!shapes[i]) continue;
+    SceneObjectPtr object = SceneObjectPtr(shapes[i].get());
+    ShapePtr sh = dynamic_pointer_cast<Shape>(shapes[i]);
+    if (sh) {
+      if (!sh->getGeometry()) continue;
+      object = sh->getGeometry();
+    }
+    pgl_hash_map<size_t,size_t>::const_iterator it = objectIndex.find(object->getObjectId());
+    if (it != objectIndex.end()) objectOfShape[i] = it->second;
+    else {
+      objectOfShape[i] = objects.size();
+      objectIndex[object->getObjectId()] = objects.size();
+      objects.push_back(object);
+    }
+  }
+
+  SharedDiscretizationCachePtr cache = __sharedCache;
+  if (!cache) cache = SharedDiscretizationCachePtr(new SharedDiscretizationCache(__cache.getMaxCost()));
+
+  // Each chunk of objects is discretized by its own worker. Workers only share the cache.
+  std::vector<ExplicitModelPtr> discretizations(objects.size());
+  ParallelExecutor::get().parallel_for(0, objects.size(), [this, &cache, &objects, &discretizations](size_t begin, size_t end) {
+      std::unique_ptr<Discretizer> worker(newWorker());
+      worker->setSharedCache(cache);
+      for (size_t i = begin; i < end; ++i)
+        if (objects[i]->apply(*worker)) discretizations[i] = worker->getDiscretization();
+  });
+
+  std::vector<ExplicitModelPtr> result(shapes.size());
+  for (size_t i = 0; i < shapes.size(); ++i)
+    if (objectOfShape[i] != size_t(-1)) result[i] = discretizations[objectOfShape[i]];
+  return result;
+}
+
 /* ----------------------------------------------------------------------- */
 
 bool Discretizer::process(Shape * Shape){
@@ -440,13 +553,15 @@ bool Discretizer::process( BezierCurve * bezierCurve ) {
   real_t _start = 0;
   uint_t _size = bezierCurve->getStride();
   real_t _step = real_t(1.0) / (real_t)_size;
-  Point3ArrayPtr _pointList(new Point3Array(_size + 1));
+  RealArrayPtr _params(new RealArray(_size + 1));
 
   for (uint_t _i = 0; _i <= _size; _i++) {
-    _pointList->setAt(_i,bezierCurve->getPointAt(_start));
+    _params->setAt(_i,_start);
     _start += _step;
   };
 
+  Point3ArrayPtr _pointList = bezierCurve->getPointsAt(_params);
+
   __discretization = ExplicitModelPtr(new Polyline(_pointList,bezierCurve->getWidth()));
 
   GEOM_DISCRETIZER_UPDATE_CACHE(bezierCurve);
@@ -468,21 +583,28 @@ bool Discretizer::process( BezierPatch * bezierPatch ) {
   const real_t _uStride1 = bezierPatch->getUStride() - real_t(1);
   const real_t _vStride1 = bezierPatch->getVStride() - real_t(1);
 
-  Point3ArrayPtr _pointList(new Point3Array(_uStride * _vStride));
   Index4ArrayPtr _indexList(new Index4Array( (_uStride - 1) * (_vStride - 1)));
 
   uint_t _cur = 0;
 
-  uint_t _pointCount = 0;
   uint_t _indexCount = 0;
 
+  RealArrayPtr _uParams(new RealArray(_uStride));
+  RealArrayPtr _vParams(new RealArray(_vStride));
+
+  uint_t _paramCount = 0;
+  for ( real_t _u = 0 ; _u < _uStride1 ; _u ++)
+    _uParams->setAt(_paramCount++,(_u/_uStride1));
+  _uParams->setAt(_paramCount,1.0);
+
+  _paramCount = 0;
+  for (real_t _v = 0; _v < _vStride1; _v ++)
+    _vParams->setAt(_paramCount++,(_v/_vStride1));
+  _vParams->setAt(_paramCount,1.0);
+
   for ( real_t _u = 0 ; _u < _uStride1 ; _u ++){
     for (real_t _v = 0; _v < _vStride1; _v ++) {
 
-      _pointList->setAt(_pointCount++,
-                        bezierPatch->getPointAt((_u/_uStride1),
-                                                (_v/_vStride1)));
-
       _indexList->setAt(_indexCount++,Index4(_cur,
                                              _cur + 1,
                                              _cur + _vStride + 1,
@@ -492,18 +614,11 @@ bool Discretizer::process( BezierPatch * bezierPatch ) {
 
     };
 
-    _pointList->setAt(_pointCount++,
-                      bezierPatch->getPointAt((_u/_uStride1),1.0));
-
     _cur++;
 
   };
 
-  for (real_t _v = 0; _v < _vStride1; _v ++)
-    _pointList->setAt(_pointCount++,
-                      bezierPatch->getPointAt(1.0,(_v/_vStride1)));
-
-  _pointList->setAt(_pointCount,bezierPatch->getPointAt(1.0,1.0));
+  Point3ArrayPtr _pointList = bezierPatch->getPointsAt(_uParams,_vParams);
 
   PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
                                      Vector3(0,0,0)));
@@ -922,7 +1037,7 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
 
 
   // Computes the position of the top
-  Point3Array::const_iterator _begin = _vertical->begin();
+  Point3Array::const_iterator _begin = const_array(*_vertical).begin();
   pair<Point3Array::const_iterator,Point3Array::const_iterator>
     _minAndMax = _vertical->getYMinAndMax();
   uint_t _ndxBot = distance(_begin,_minAndMax.first);
@@ -935,7 +1050,7 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
   while (_iNdx != _ndxTop) {
     _ndx1.push_back(_iNdx);
     uint_t _jNdx = (_iNdx + 1) % _vSize;
-    _len1 += norm(_vertical->getAt(_iNdx) - _vertical->getAt(_jNdx));
+    _len1 += norm(const_array(*_vertical).getAt(_iNdx) - const_array(*_vertical).getAt(_jNdx));
     _iNdx = _jNdx;
   };
   _ndx1.push_back(_ndxTop);
@@ -947,7 +1062,7 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
   while (_iNdx != _ndxTop) {
     _ndx2.push_back(_iNdx);
     uint_t _jNdx = _iNdx == 0 ? _vSize - 1 : _iNdx - 1;
-    _len2 += norm(_vertical->getAt(_iNdx) - _vertical->getAt(_jNdx));
+    _len2 += norm(const_array(*_vertical).getAt(_iNdx) - const_array(*_vertical).getAt(_jNdx));
     _iNdx = _jNdx;
   };
 
@@ -973,10 +1088,10 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
 
   Vector3 _p1, _p2;
 
-  real_t _dtSeg1 = norm(_vertical->getAt(_ndx1[0]) -
-                      _vertical->getAt(_ndx1[1])) / _len1;
-  real_t _dtSeg2 = norm(_vertical->getAt(_ndx2[0]) -
-                      _vertical->getAt(_ndx2[1])) / _len2;
+  real_t _dtSeg1 = norm(const_array(*_vertical).getAt(_ndx1[0]) -
+                      const_array(*_vertical).getAt(_ndx1[1])) / _len1;
+  real_t _dtSeg2 = norm(const_array(*_vertical).getAt(_ndx2[0]) -
+                      const_array(*_vertical).getAt(_ndx2[1])) / _len2;
 
   real_t _dt1 = _dtSeg1;
   real_t _dt2 = _dtSeg2;
@@ -998,34 +1113,34 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
     if (_stacks1 != _stacks) {
       while (_dt1 < _t) {
         _i1++;
-        _dtSeg1 = norm(_vertical->getAt(_ndx1[_i1]) -
-                       _vertical->getAt(_ndx1[_i1 + 1])) / _len1;
+        _dtSeg1 = norm(const_array(*_vertical).getAt(_ndx1[_i1]) -
+                       const_array(*_vertical).getAt(_ndx1[_i1 + 1])) / _len1;
         if (_dtSeg1 > GEOM_TOLERANCE) _dt1 += _dtSeg1;
       };
       GEOM_ASSERT(_dtSeg1 > GEOM_TOLERANCE);
       real_t _alpha1 = (_dt1 - _t) / _dtSeg1;
-      _p1 = (_vertical->getAt(_ndx1[_i1 + 1]) * (1 - _alpha1) +
-             _vertical->getAt(_ndx1[_i1]) * _alpha1);
+      _p1 = (const_array(*_vertical).getAt(_ndx1[_i1 + 1]) * (1 - _alpha1) +
+             const_array(*_vertical).getAt(_ndx1[_i1]) * _alpha1);
     }
     else
-        _p1 = _vertical->getAt(_ndx1[++_i1]);
+        _p1 = const_array(*_vertical).getAt(_ndx1[++_i1]);
     //_p1.print(cout) << endl;
 
     // Computes p2
     if (_stacks2 != _stacks) {
       while (_dt2 < _t) {
         _i2++;
-        _dtSeg2 = norm(_vertical->getAt(_ndx2[_i2]) -
-                       _vertical->getAt(_ndx2[_i2 + 1])) / _len2;
+        _dtSeg2 = norm(const_array(*_vertical).getAt(_ndx2[_i2]) -
+                       const_array(*_vertical).getAt(_ndx2[_i2 + 1])) / _len2;
         if (_dtSeg2 > GEOM_TOLERANCE) _dt2 += _dtSeg2;
       };
       GEOM_ASSERT(_dtSeg1 > GEOM_TOLERANCE);
       real_t _alpha2 = (_dt2 - _t) / _dtSeg2;
-      _p2 = (_vertical->getAt(_ndx2[_i2 + 1]) * (1 - _alpha2) +
-             _vertical->getAt(_ndx2[_i2]) * _alpha2);
+      _p2 = (const_array(*_vertical).getAt(_ndx2[_i2 + 1]) * (1 - _alpha2) +
+             const_array(*_vertical).getAt(_ndx2[_i2]) * _alpha2);
     }
     else
-      _p2 = _vertical->getAt(_ndx2[++_i2]);
+      _p2 = const_array(*_vertical).getAt(_ndx2[++_i2]);
     //_p2.print(cout) << endl;
 
     // To map the horizontal profile we used a transformation  composed of:
@@ -1045,7 +1160,7 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
 
     for (uint_t _hPoint = 0; _hPoint < _hSize; _hPoint++) {
 
-      const Vector2 _p = Vector2(_horizontal->getAt(_hPoint).x(),_horizontal->getAt(_hPoint).y());
+      const Vector2 _p = Vector2(const_array(*_horizontal).getAt(_hPoint).x(),const_array(*_horizontal).getAt(_hPoint).y());
 
       _pointList->setAt(_pointCount++,
                         Vector3(_cosA * _sf * (_p.x()- _xcenter) + _v.x(),
@@ -1075,13 +1190,13 @@ bool Discretizer::process( ExtrudedHull * extrudedHull ) {
 
   };
 
-  _pointList->setAt(_pointCount++,Vector3(_vertical->getAt(_ndxBot).x(),
+  _pointList->setAt(_pointCount++,Vector3(const_array(*_vertical).getAt(_ndxBot).x(),
                                           _ycenter,
-                                          _vertical->getAt(_ndxBot).y()));
+                                          const_array(*_vertical).getAt(_ndxBot).y()));
 
-  _pointList->setAt(_pointCount++,Vector3(_vertical->getAt(_ndxTop).x(),
+  _pointList->setAt(_pointCount++,Vector3(const_array(*_vertical).getAt(_ndxTop).x(),
                                           _ycenter,
-                                          _vertical->getAt(_ndxTop).y()));
+                                          const_array(*_vertical).getAt(_ndxTop).y()));
 
   GEOM_ASSERT(_pointCount == _pointList->size());
   GEOM_ASSERT(_indexCount == _indexList->size());
@@ -1135,8 +1250,8 @@ bool Discretizer::process( Extrusion * extrusion ){
 
     Point3ArrayPtr _crossPoints = _explicitCrossSection->getPointList();
     bool closed = false;
-    if(!(norm(_crossPoints->getAt(0) - _crossPoints->getAt(_crossPoints->size()-1)) > GEOM_EPSILON)){
-      _crossPoints = Point3ArrayPtr(new Point3Array(_crossPoints->begin(),_crossPoints->end() -1));
+    if(!(norm(const_array(*_crossPoints).getAt(0) - const_array(*_crossPoints).getAt(_crossPoints->size()-1)) > GEOM_EPSILON)){
+      _crossPoints = Point3ArrayPtr(new Point3Array(const_array(*_crossPoints).begin(),const_array(*_crossPoints).end() -1));
       closed = true;
     }
 
@@ -1172,12 +1287,19 @@ bool Discretizer::process( Extrusion * extrusion ){
     uint_t _j2 = 0;
     uint_t _k = 0;
 
+    // The centers of the sections, at the same parameters as the frames.
+    RealArrayPtr _params(new RealArray(_size + 1));
+    real_t _u = _start;
+    for (uint_t _i = 0; _i < _size; _i++, _u += _step) _params->setAt(_i,_u);
+    _params->setAt(_size,_axis->getLastKnot());
+    const Point3ArrayPtr _centers = curvePointsAt(_axis, _params);
+
     Vector3 _oldBinormal;
     Vector3 _normal( extrusion->getInitialNormalValue() );
     Matrix3 _frame = extrusion->getFrameAt(_start);
 
     for (uint_t _i = 0; _i < _size; _i++) {
-        Vector3 _center = _axis->getPointAt(_start);
+        const Vector3& _center = const_array(*_centers).getAt(_i);
         /*
         Vector3 _velocity = _axis->getTangentAt(_start);
         if(_i!=0) {
@@ -1251,7 +1373,7 @@ bool Discretizer::process( Extrusion * extrusion ){
     Matrix3 _frame(_normal,_binormal,_velocity);
     */
     OrthonormalBasis3D _transf(_frame);
-    Vector3 _center = _axis->getPointAt(_start);
+    const Vector3& _center = const_array(*_centers).getAt(_size);
     Point3ArrayPtr _newPoint;
     if(_useTransf){
         Transformation2DPtr _transf2D =  (*_profileTransf)(_starttransf);
@@ -1458,21 +1580,21 @@ bool Discretizer::process( Group * group )  {
   GEOM_ASSERT(group);
   GEOM_DISCRETIZER_CHECK_CACHE(group);
   const GeometryArrayPtr& _geometryList = group->getGeometryList();
-  (*(_geometryList->begin()))->apply(*this);
+  (*(const_array(*_geometryList).begin()))->apply(*this);
   if(!__discretization)
   {
     GEOM_DISCRETIZER_UPDATE_CACHE(group);
     return false;
   }
   ExplicitModelPtr basegeom;
-  if (__discretization  == *_geometryList->begin())
+  if (__discretization  == *const_array(*_geometryList).begin())
       basegeom = __discretization->casted_deepcopy<ExplicitModel>();
   else basegeom = __discretization;
   Merge fusion(*this,basegeom);
 
   GeometryPtr geom2;
-  for (GeometryArray::const_iterator _i = _geometryList->begin()+1;
-       _i != _geometryList->end();
+  for (GeometryArray::const_iterator _i = const_array(*_geometryList).begin()+1;
+       _i != const_array(*_geometryList).end();
        _i++) {
       geom2 = *_i;
       if(!fusion.apply(geom2)){
@@ -1520,7 +1642,7 @@ bool Discretizer::process( IFS * ifs )  {
 
   uint_t size= matrixList->size();
 
-  Matrix4Array::const_iterator matrix= matrixList->begin();
+  Matrix4Array::const_iterator matrix= const_array(*matrixList).begin();
   Transform4Ptr t(new Transform4(*matrix));
 
   ExplicitModelPtr bigD = __discretization->transform(dynamic_pointer_cast<Transformation3D>(t));
@@ -1530,7 +1652,7 @@ bool Discretizer::process( IFS * ifs )  {
 
   ExplicitModelPtr tmpD;
   matrix++;
-  while( matrix != matrixList->end() )
+  while( matrix != const_array(*matrixList).end() )
     {
     t->getMatrix()= *matrix;
     tmpD= __discretization->transform(dynamic_pointer_cast<Transformation3D>(t));
@@ -1567,14 +1689,16 @@ bool Discretizer::process( NurbsCurve * nurbsCurve ) {
   real_t _start = nurbsCurve->getFirstKnot();
   uint_t _size = nurbsCurve->getStride();
   real_t _step =  (nurbsCurve->getLastKnot()-_start) / (real_t) _size;
-  Point3ArrayPtr _pointList(new Point3Array(_size + 1));
+  RealArrayPtr _params(new RealArray(_size + 1));
 
   for (uint_t _i = 0; _i < _size; _i++) {
-    _pointList->setAt(_i,nurbsCurve->getPointAt(_start));
+    _params->setAt(_i,_start);
     _start += _step;
   };
 
-  _pointList->setAt(_size, nurbsCurve->getPointAt(nurbsCurve->getLastKnot()));
+  _params->setAt(_size, nurbsCurve->getLastKnot());
+
+  Point3ArrayPtr _pointList = nurbsCurve->getPointsAt(_params);
 
   __discretization = ExplicitModelPtr(new Polyline(_pointList,nurbsCurve->getWidth()));
 
@@ -1595,12 +1719,10 @@ bool Discretizer::process( NurbsPatch * nurbsPatch ) {
   real_t _vStride1 = _vStride - real_t(1);
 
 
-  Point3ArrayPtr _pointList(new Point3Array(_uStride * _vStride));
   Index4ArrayPtr _indexList(new Index4Array( (_uStride - 1) * (_vStride - 1)));
 
   uint_t _cur = 0;
 
-  uint_t _pointCount = 0;
   uint_t _indexCount = 0;
 
   real_t _ufirst=nurbsPatch->getFirstUKnot();
@@ -1611,11 +1733,21 @@ bool Discretizer::process( NurbsPatch * nurbsPatch ) {
   real_t _vlast=nurbsPatch->getLastVKnot();
   real_t _vinter=_vlast-_vfirst;
 
+  RealArrayPtr _uParams(new RealArray(_uStride));
+  RealArrayPtr _vParams(new RealArray(_vStride));
+
+  uint_t _paramCount = 0;
+  for ( real_t _u = 0 ; _u < _uStride1 - GEOM_EPSILON ; ++_u)
+    _uParams->setAt(_paramCount++,_ufirst + (_u * _uinter) / _uStride1);
+  _uParams->setAt(_paramCount,_ulast);
+
+  _paramCount = 0;
+  for (real_t _v = 0; _v < _vStride1 - GEOM_EPSILON ; ++_v)
+    _vParams->setAt(_paramCount++,_vfirst + (_v * _vinter) / _vStride1);
+  _vParams->setAt(_paramCount,_vlast);
+
   for ( real_t _u = 0 ; _u < _uStride1 - GEOM_EPSILON ; ++_u) {
     for (real_t _v = 0; _v < _vStride1 - GEOM_EPSILON ; ++_v) {
-      _pointList->setAt(_pointCount++,
-                        nurbsPatch->getPointAt(_ufirst + (_u * _uinter) / _uStride1,
-                                               _vfirst + (_v * _vinter) / _vStride1));
       _indexList->setAt(_indexCount++,
                         Index4(_cur,                _cur + 1,
                                _cur + _vStride + 1, _cur + _vStride));
@@ -1623,20 +1755,11 @@ bool Discretizer::process( NurbsPatch * nurbsPatch ) {
       _cur++;
     };
 
-    _pointList->setAt(_pointCount++,
-                      nurbsPatch->getPointAt(_ufirst + (_u * _uinter) / _uStride1,_vlast));
      _cur++;
 
   };
 
-  for (real_t _v = 0; _v < _vStride1 - GEOM_EPSILON; ++_v ){
-    _pointList->setAt(_pointCount++,
-                       nurbsPatch->getPointAt(_ulast,
-                                               (_vfirst +
-                                                (_v * _vinter) / _vStride1)));
-  }
-
-  _pointList->setAt(_pointCount,nurbsPatch->getPointAt(_ulast,_vlast));
+  Point3ArrayPtr _pointList = nurbsPatch->getPointsAt(_uParams,_vParams);
 
   PolylinePtr _skeleton(new Polyline(Vector3(0,0,0),
                                      Vector3(0,0,0)));
@@ -1794,14 +1917,14 @@ bool Discretizer::process( Revolution * revolution ) {
     real_t _x = cos(_i * _angleStep);
     real_t _y = sin(_i * _angleStep);
 
-    real_t _rad = _curve->getAt(0).x();
-    real_t _z = _curve->getAt(0).y();
+    real_t _rad = const_array(*_curve).getAt(0).x();
+    real_t _z = const_array(*_curve).getAt(0).y();
 
     _pointList->setAt(_pointsCount++,Vector3(_x * _rad, _y * _rad, _z));
 
     for (uint_t _j = 1; _j < _curveSize; _j++) {
-      real_t _rad = _curve->getAt(_j).x();
-      real_t _z = _curve->getAt(_j).y();
+      real_t _rad = const_array(*_curve).getAt(_j).x();
+      real_t _z = const_array(*_curve).getAt(_j).y();
 
       _pointList->setAt(_pointsCount++,Vector3(_x * _rad, _y * _rad, _z));
 
@@ -1887,20 +2010,20 @@ bool Discretizer::process( Swung * swung )
     crv2D= section->getSection2DAt(angleMin);
     cosa= cos(angle);
     sina= sin(angle);
-    rad= crv2D->getAt(0).x();
+    rad= const_array(*crv2D).getAt(0).x();
     ref_pt_up.x()= rad * cosa;
     ref_pt_up.y()= rad * sina;
-    ref_pt_up.z()= crv2D->getAt(0).y();
-    rad= crv2D->getAt(sectionSize - 1).x();
+    ref_pt_up.z()= const_array(*crv2D).getAt(0).y();
+    rad= const_array(*crv2D).getAt(sectionSize - 1).x();
     ref_pt_down.x()= rad * cosa;
     ref_pt_down.y()= rad * sina;
-    ref_pt_down.z()= crv2D->getAt(sectionSize - 1).y();
+    ref_pt_down.z()= const_array(*crv2D).getAt(sectionSize - 1).y();
   }
   else
   {
     crv3D= section->getSection3DAt(angle);
-    ref_pt_up = crv3D->getAt(0);
-    ref_pt_down = crv3D->getAt(sectionSize - 1);
+    ref_pt_up = const_array(*crv3D).getAt(0);
+    ref_pt_down = const_array(*crv3D).getAt(sectionSize - 1);
   }
 
   for( i= 0; i < slices; i++ )
@@ -1911,15 +2034,15 @@ bool Discretizer::process( Swung * swung )
       cosa= cos(angle);
       sina= sin(angle);
 
-      rad= crv2D->getAt(0).x();
+      rad= const_array(*crv2D).getAt(0).x();
       pt.x()= rad * cosa;
       pt.y()= rad * sina;
-      pt.z()= crv2D->getAt(0).y();
+      pt.z()= const_array(*crv2D).getAt(0).y();
       }
     else
       {
       crv3D= section->getSection3DAt(angle);
-      pt= crv3D->getAt(0);
+      pt= const_array(*crv3D).getAt(0);
       }
 
     pointList->setAt(pointsCount++,pt);
@@ -1933,14 +2056,14 @@ bool Discretizer::process( Swung * swung )
       {
       if( is2D )
         {
-        Vector2& p2d = crv2D->getAt(j);
+        const Vector2& p2d = const_array(*crv2D).getAt(j);
         rad= p2d.x();
         pt.x()= rad * cosa;
         pt.y()= rad * sina;
         pt.z()= p2d.y();
         }
       else
-        pt= crv3D->getAt(j);
+        pt= const_array(*crv3D).getAt(j);
 
       pointList->setAt(pointsCount++,pt);
       if( j == sectionSize - 1 && norm(pt - ref_pt_down) > epsilon)
@@ -2184,13 +2307,15 @@ bool Discretizer::process( BezierCurve2D * bezierCurve ) {
   real_t _start = 0;
   uint_t _size = bezierCurve->getStride();
   real_t _step = 1.0 / (real_t)_size;
-  Point3ArrayPtr _pointList(new Point3Array(_size + 1));
+  RealArrayPtr _params(new RealArray(_size + 1));
 
   for (uint_t _i = 0; _i <= _size; _i++) {
-    _pointList->setAt(_i,Vector3(bezierCurve->getPointAt(_start),0));
+    _params->setAt(_i,_start);
     _start += _step;
   };
 
+  Point3ArrayPtr _pointList(new Point3Array(bezierCurve->getPointsAt(_params),0));
+
   __discretization = ExplicitModelPtr(new Polyline(_pointList,bezierCurve->getWidth()));
 
   GEOM_DISCRETIZER_UPDATE_CACHE(bezierCurve);
@@ -2266,14 +2391,16 @@ bool Discretizer::process( NurbsCurve2D * nurbsCurve ) {
   real_t _start = nurbsCurve->getFirstKnot();
   uint_t _size = nurbsCurve->getStride();
   real_t _step =  (nurbsCurve->getLastKnot()-_start) / (real_t) _size;
-  Point3ArrayPtr _pointList(new Point3Array(_size + 1));
+  RealArrayPtr _params(new RealArray(_size + 1));
 
   for (uint_t _i = 0; _i < _size; _i++) {
-    _pointList->setAt(_i,Vector3(nurbsCurve->getPointAt(_start),0));
+    _params->setAt(_i,_start);
     _start += _step;
   };
 
-  _pointList->setAt(_size, Vector3(nurbsCurve->getPointAt(nurbsCurve->getLastKnot()),0));
+  _params->setAt(_size, nurbsCurve->getLastKnot());
+
+  Point3ArrayPtr _pointList(new Point3Array(nurbsCurve->getPointsAt(_params),0));
 
   __discretization = ExplicitModelPtr(new Polyline(_pointList,nurbsCurve->getWidth()));
 
@@ -2315,19 +2442,19 @@ Discretizer::gridTexCoord(Point3ArrayPtr pts, int gw, int gh) const {
     Point2ArrayPtr _texList = Point2ArrayPtr(new Point2Array(gw * gh));
     for ( int _u = 0 ; _u < gw ; _u ++){
         real_t length = 0;
-        Vector3 p1 = pts->getAt(_u*gh);
+        Vector3 p1 = const_array(*pts).getAt(_u*gh);
         _texList->setAt(_u*gh,Vector2(0,0));
         {
             for (int _v = 1; _v < gh; _v ++) {
-                Vector3 p2 = pts->getAt(_u*gh+_v);
+                Vector3 p2 = const_array(*pts).getAt(_u*gh+_v);
                 length += norm(p2-p1);
                 p1 = p2;
             }
         }
         real_t length2 = 0;
-        p1 = pts->getAt(_u*gh);
+        p1 = const_array(*pts).getAt(_u*gh);
         for (int _v = 1; _v < gh; _v ++) {
-            Vector3 p2 = pts->getAt(_u*gh+_v);
+            Vector3 p2 = const_array(*pts).getAt(_u*gh+_v);
             length2 += norm(p2-p1);
             p1 = p2;
             _texList->setAt(_u*gh+_v,Vector2(length2/length,0));
@@ -2335,18 +2462,18 @@ Discretizer::gridTexCoord(Point3ArrayPtr pts, int gw, int gh) const {
     }
     for (int _v = 0; _v < gh; _v ++) {
         real_t length = 0;
-        Vector3 p1 = pts->getAt(_v);
+        Vector3 p1 = const_array(*pts).getAt(_v);
         {
             for ( int _u = 1 ; _u < gw ; _u ++){
-                Vector3 p2 = pts->getAt(_u*gh+_v);
+                Vector3 p2 = const_array(*pts).getAt(_u*gh+_v);
                 length += norm(p2-p1);
                 p1 = p2;
             }
         }
         real_t length2 = 0;
-        p1 = pts->getAt(_v);
+        p1 = const_array(*pts).getAt(_v);
         for ( int _u = 1 ; _u < gw ; _u ++){
-            Vector3 p2 = pts->getAt(_u*gh+_v);
+            Vector3 p2 = const_array(*pts).getAt(_u*gh+_v);
             length2 += norm(p2-p1);
             p1 = p2;
             _texList->getAt(_v+_u*gh).y() = length2/length;
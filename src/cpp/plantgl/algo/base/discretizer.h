@@ -55,6 +55,7 @@
 #include <plantgl/tool/util_cache.h>
 #include <plantgl/scenegraph/core/action.h>
 #include <plantgl/scenegraph/geometry/explicitmodel.h>
+#include <vector>
 
 #ifndef GEOM_FWDEF
 #include <plantgl/scenegraph/container/pointarray.h>
@@ -73,6 +74,29 @@ class Point3Array;
 typedef RCPtr<Point3Array> Point3ArrayPtr;
 #endif
 
+class Scene;
+typedef RCPtr<Scene> ScenePtr;
+class Shape3D;
+typedef RCPtr<Shape3D> Shape3DPtr;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class SharedDiscretizationCache
+   \brief A cache of discretized geometries that several Discretizer,
+   possibly running in different threads, can use at the same time.
+*/
+class ALGO_API SharedDiscretizationCache : public RefCountObject, public ConcurrentLRUCache<ExplicitModelPtr>
+{
+public:
+  /// Constructs a SharedDiscretizationCache with the default budget of a Discretizer.
+  SharedDiscretizationCache( );
+  /// Constructs a SharedDiscretizationCache with a memory budget of \e maxcost bytes.
+  SharedDiscretizationCache( size_t maxcost );
+};
+
+typedef RCPtr<SharedDiscretizationCache> SharedDiscretizationCachePtr;
+
 /* ----------------------------------------------------------------------- */
 
 /**
@@ -95,6 +119,31 @@ public:
   /// Clears \e self.
   void clear( );
 
+  typedef LRUCache<ExplicitModelPtr> DiscretizationCache;
+
+  /// Default memory budget of the cache, in bytes.
+  static const size_t DEFAULT_CACHE_MAX_SIZE;
+
+  /// Returns the cache of discretized geometries, to tune its budget or read its statistics.
+  inline DiscretizationCache& getCache( ) { return __cache; }
+  inline const DiscretizationCache& getCache( ) const { return __cache; }
+
+  /** Makes \e self use \e cache instead of its own cache, so that several
+      Discretizer can reuse the same results. A null \e cache restores the
+      use of the own cache. The shared cache is not emptied by clear().
+      \warning A cache must only be shared by actions of the same type:
+      a Tesselator and a Discretizer do not compute the same results. */
+  inline void setSharedCache( const SharedDiscretizationCachePtr& cache ) { __sharedCache = cache; }
+  inline const SharedDiscretizationCachePtr& getSharedCache( ) const { return __sharedCache; }
+
+  /** Discretizes in parallel each shape of \e scene and returns the results in
+      the order of the scene. A shape that cannot be discretized gives a null result.
+      Geometries shared by several shapes are discretized once, and the workers share
+      the cache of \e self if any, or a temporary one. Workers are made by newWorker(),
+      so that a Tesselator returns triangulations. */
+  std::vector<ExplicitModelPtr> discretize( const ScenePtr& scene );
+  std::vector<ExplicitModelPtr> discretize( const std::vector<Shape3DPtr>& shapes );
+
   /// Returns the last computed discretized  geomety when applying \e self.
   inline const ExplicitModelPtr& getDiscretization( ) const { return __discretization; }
 
@@ -227,13 +276,23 @@ public:
   Point2ArrayPtr gridTexCoord(Point3ArrayPtr pts, int gw, int gh) const;
 
 protected:
+  /// Returns a new action of the type of \e self, with the same options, to discretize in a worker thread.
+  virtual Discretizer * newWorker( ) const;
+
   template <class T> bool check_cache(T * geom);
   template <class T> bool check_cache_with_tex(T * geom);
   template <class T> void update_cache(T * geom);
   template <class T> bool transformed(T * geom);
 
+  /// Set the last discretization from the cache entry of the object id if it is still valid.
+  bool findInCache(size_t id, size_t stamp);
+  /// Store the last discretization in the cache for the object id.
+  void storeInCache(size_t id, size_t stamp);
+
   /// The cache storing the already discretized geometries.
-  Cache<ExplicitModelPtr> __cache;
+  DiscretizationCache __cache;
+  /// The cache shared with other Discretizer, used instead of __cache if valid.
+  SharedDiscretizationCachePtr __sharedCache;
 
   /// The last computed discretized geometry.
   ExplicitModelPtr __discretization;
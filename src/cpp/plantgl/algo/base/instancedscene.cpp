@@ -0,0 +1,154 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+
+#include "instancedscene.h"
+#include <plantgl/scenegraph/transformation/translated.h>
+#include <plantgl/scenegraph/transformation/oriented.h>
+#include <plantgl/scenegraph/transformation/scaled.h>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+InstancedScene::InstancedScene() :
+  RefCountObject()
+{
+}
+
+InstancedScene::~InstancedScene()
+{
+}
+
+uint32_t
+InstancedScene::addPrototype(const GeometryPtr& prototype)
+{
+  pgl_hash_map<size_t,uint32_t>::const_iterator it = __prototypeindices.find((size_t)prototype.get());
+  if (it != __prototypeindices.end()) return it->second;
+  uint32_t index = __prototypes.size();
+  __prototypes.push_back(prototype);
+  __prototypeindices[(size_t)prototype.get()] = index;
+  return index;
+}
+
+void
+InstancedScene::add(uint32_t prototype, const Matrix4& transformation, const AppearancePtr& appearance, uint32_t id, uint32_t parentid)
+{
+  GEOM_ASSERT(prototype < __prototypes.size());
+  uint32_t material;
+  pgl_hash_map<size_t,uint32_t>::const_iterator it = __materialindices.find((size_t)appearance.get());
+  if (it != __materialindices.end()) material = it->second;
+  else {
+      material = __materials.size();
+      __materials.push_back(appearance);
+      __materialindices[(size_t)appearance.get()] = material;
+  }
+  __prototypeids.push_back(prototype);
+  __transformations.push_back(transformation);
+  __materialids.push_back(material);
+  __shapeids.push_back(id);
+  __parentids.push_back(parentid);
+  __scene = ScenePtr();
+}
+
+void
+InstancedScene::add(const ShapePtr& shape)
+{
+  GEOM_ASSERT(is_valid_ptr(shape) && is_valid_ptr(shape->getGeometry()));
+  add(shape->getGeometry(), Matrix4::IDENTITY, shape->getAppearance(), shape->getId(), shape->getParentId());
+}
+
+void
+InstancedScene::clear()
+{
+  __prototypes.clear();
+  __prototypeindices.clear();
+  __prototypeids.clear();
+  __transformations.clear();
+  __materialids.clear();
+  __shapeids.clear();
+  __parentids.clear();
+  __materials.clear();
+  __materialindices.clear();
+  __scene = ScenePtr();
+}
+
+/* ----------------------------------------------------------------------- */
+
+GeometryPtr
+InstancedScene::getInstanceGeometry(size_t i) const
+{
+  const Matrix4& m = __transformations[i];
+  Vector3 c0(m(0,0), m(1,0), m(2,0));
+  Vector3 c1(m(0,1), m(1,1), m(2,1));
+  Vector3 c2(m(0,2), m(1,2), m(2,2));
+  Vector3 scale(c0.normalize(), c1.normalize(), c2.normalize());
+  Vector3 translation(m(0,3), m(1,3), m(2,3));
+
+  GeometryPtr geometry = __prototypes[__prototypeids[i]];
+  if (scale != Vector3(1,1,1))
+      geometry = GeometryPtr(new Scaled(scale, geometry));
+  if (c0 != Vector3::OX || c1 != Vector3::OY)
+      geometry = GeometryPtr(new Oriented(c0, c1, geometry));
+  if (translation != Vector3::ORIGIN)
+      geometry = GeometryPtr(new Translated(translation, geometry));
+  return geometry;
+}
+
+Shape3DPtr
+InstancedScene::getInstanceShape(size_t i) const
+{
+  return Shape3DPtr(new Shape(getInstanceGeometry(i), __materials[__materialids[i]], __shapeids[i], __parentids[i]));
+}
+
+const ScenePtr&
+InstancedScene::getScene() const
+{
+  if (is_null_ptr(__scene)) {
+      __scene = ScenePtr(new Scene(size()));
+      for (size_t i = 0; i < size(); ++i)
+          __scene->setAt(i, getInstanceShape(i));
+  }
+  return __scene;
+}
+
+/* ----------------------------------------------------------------------- */
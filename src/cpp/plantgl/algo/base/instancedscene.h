@@ -0,0 +1,177 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+/*! \file instancedscene.h
+    \brief Flat arrays of instances of prototype geometries. see InstancedScene.
+*/
+
+#ifndef __instancedscene_h__
+#define __instancedscene_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_hashmap.h>
+#include <plantgl/math/util_matrix.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/scenegraph/geometry/geometry.h>
+#include <plantgl/scenegraph/appearance/appearance.h>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+  \class InstancedScene
+  \brief A set of instances of prototype geometries stored as flat arrays.
+
+  Each instance is a record made of the index of its prototype in
+  getPrototypes(), a 4x4 transformation from the prototype to the world,
+  the index of its appearance in getMaterials() and the ids of the shape
+  and of its parent. No scene graph object is created per instance.
+
+  Transformations are expected to be made of a translation, a rotation and
+  positive scaling factors along the axes of the prototype, as the ones
+  computed from a turtle frame. A shape that cannot be instanced is added as
+  the single instance of its geometry with an identity transformation, so
+  that the instances keep the order in which the shapes were added.
+  getScene() builds on demand a Scene with one Shape per instance, sharing
+  the prototypes. CompiledScene can compile the instances directly,
+  tesselating each prototype only once.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class ALGO_API InstancedScene : public RefCountObject
+{
+
+public :
+
+  /// Constructor.
+  InstancedScene();
+
+  /// Destructor.
+  virtual ~InstancedScene();
+
+  /// Return the index of \e prototype in getPrototypes(), adding it if needed.
+  uint32_t addPrototype(const GeometryPtr& prototype);
+
+  /// Add an instance of the prototype of index \e prototype.
+  void add(uint32_t prototype, const Matrix4& transformation, const AppearancePtr& appearance, uint32_t id, uint32_t parentid = Shape::NOID);
+
+  /// Add an instance of \e prototype.
+  inline void add(const GeometryPtr& prototype, const Matrix4& transformation, const AppearancePtr& appearance, uint32_t id, uint32_t parentid = Shape::NOID)
+  { add(addPrototype(prototype), transformation, appearance, id, parentid); }
+
+  /// Add \e shape as the single instance of its geometry, with an identity transformation.
+  void add(const ShapePtr& shape);
+
+  /// Remove all instances and prototypes.
+  void clear();
+
+  /// Return the number of instances.
+  inline size_t size() const { return __prototypeids.size(); }
+
+  inline bool empty() const { return __prototypeids.empty(); }
+
+  /// Prototype geometries, without duplicates.
+  inline const std::vector<GeometryPtr>& getPrototypes() const { return __prototypes; }
+
+  /// Index in getPrototypes() of the geometry of each instance.
+  inline const std::vector<uint32_t>& getPrototypeIds() const { return __prototypeids; }
+
+  /// Transformation of each instance.
+  inline const std::vector<Matrix4>& getTransformations() const { return __transformations; }
+
+  /// Index in getMaterials() of the appearance of each instance.
+  inline const std::vector<uint32_t>& getMaterialIds() const { return __materialids; }
+
+  /// Appearances of the instances, without duplicates.
+  inline const std::vector<AppearancePtr>& getMaterials() const { return __materials; }
+
+  /// Id of the shape of each instance.
+  inline const std::vector<uint32_t>& getShapeIds() const { return __shapeids; }
+
+  /// Id of the parent shape of each instance.
+  inline const std::vector<uint32_t>& getParentIds() const { return __parentids; }
+
+  /// Return a geometry made of the prototype of the \e i-th instance transformed into world space.
+  GeometryPtr getInstanceGeometry(size_t i) const;
+
+  /// Return a Shape for the \e i-th instance.
+  Shape3DPtr getInstanceShape(size_t i) const;
+
+  /// Return a scene with a Shape for each instance. It is built at the first call after a modification.
+  const ScenePtr& getScene() const;
+
+protected:
+
+  std::vector<GeometryPtr> __prototypes;
+  pgl_hash_map<size_t,uint32_t> __prototypeindices;
+
+  std::vector<uint32_t> __prototypeids;
+  std::vector<Matrix4> __transformations;
+  std::vector<uint32_t> __materialids;
+  std::vector<uint32_t> __shapeids;
+  std::vector<uint32_t> __parentids;
+
+  std::vector<AppearancePtr> __materials;
+  pgl_hash_map<size_t,uint32_t> __materialindices;
+
+  mutable ScenePtr __scene;
+
+};
+
+typedef RCPtr<InstancedScene> InstancedScenePtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+// __instancedscene_h__
+#endif
@@ -293,7 +293,6 @@ IntersectionType  PGL(triangle_triangle_intersection)(const Vector3& t11, const
 std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr>
 PGL(auto_intersection)(Point3ArrayPtr points, Index3ArrayPtr triangles)
 {
-#ifdef PGL_WITH_ANN
     std::vector<std::pair<uint32_t,uint32_t> > intersectionpair;
     GeometryArrayPtr intersectionresult(new GeometryArray());
     Point3ArrayPtr centroids = centroids_of_groups(points, triangles);
@@ -305,7 +304,7 @@ PGL(auto_intersection)(Point3ArrayPtr points, Index3ArrayPtr triangles)
         if (maxsize < size) maxsize = size;
     }
 
-    ANNKDTree3 kdtree(centroids);
+    KDTree3 kdtree(centroids);
     IndexArrayPtr nbgs = kdtree.r_nearest_neighbors(2*maxsize);
     Vector3 intersectionstart, intersectionend;
 
@@ -381,12 +380,4 @@ PGL(auto_intersection)(Point3ArrayPtr points, Index3ArrayPtr triangles)
         }
     }
     return std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> (intersectionpair, intersectionresult);
-#else
-    #ifdef _MSC_VER
-    #pragma message("function 'auto_intersection' disabled. ANN needed.")
-    #else
-    #warning "function 'auto_intersection' disabled. ANN needed"
-    #endif
-    return std::pair<std::vector<std::pair<uint32_t,uint32_t> >,GeometryArrayPtr> ();
-#endif
 }
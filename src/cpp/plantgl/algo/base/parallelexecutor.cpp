@@ -0,0 +1,174 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+#include "parallelexecutor.h"
+#include <plantgl/tool/util_progress.h>
+#include <plantgl/tool/util_profiler.h>
+
+#include <boost/asio.hpp>
+#include <boost/thread.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// State of a parallel loop shared by the calling thread and the workers.
+// Workers that start after the end of the loop find no chunk left and
+// only touch this state, which is kept alive by their shared pointer.
+struct ParallelLoop {
+    size_t begin;
+    size_t end;
+    size_t chunksize;
+    size_t nbchunks;
+    const ParallelExecutor::RangeFunction * function;
+    ProgressStatus * status;
+
+    std::atomic<size_t> next;
+    std::atomic<bool> failed;
+    size_t remaining;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable done;
+
+    void process() {
+        size_t chunk;
+        while ((chunk = next++) < nbchunks) {
+            size_t cbegin = begin + chunk * chunksize;
+            size_t cend = std::min(end, cbegin + chunksize);
+            if (!failed) {
+                try { (*function)(cbegin, cend); }
+                catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!error) error = std::current_exception();
+                    failed = true;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (status != NULL) status->increment(cend - cbegin);
+            if (--remaining == 0) done.notify_all();
+        }
+    }
+};
+
+/* ----------------------------------------------------------------------- */
+
+ParallelExecutor::ParallelExecutor():
+    __pool(),
+    __nb_threads(std::max<size_t>(1, boost::thread::hardware_concurrency()))
+{}
+
+ParallelExecutor::~ParallelExecutor()
+{
+    if(__pool) __pool->join();
+}
+
+ParallelExecutor::ThreadPoolPtr
+ParallelExecutor::getPool()
+{
+    std::lock_guard<std::mutex> lock(__pool_mutex);
+    // the calling thread takes part in the loops
+    if(!__pool) __pool.reset(new boost::asio::thread_pool(__nb_threads - 1));
+    return __pool;
+}
+
+void ParallelExecutor::set_nb_threads(size_t nbthreads)
+{
+    if (nbthreads == 0) nbthreads = std::max<size_t>(1, boost::thread::hardware_concurrency());
+    ThreadPoolPtr oldpool;
+    {
+        std::lock_guard<std::mutex> lock(__pool_mutex);
+        if (nbthreads == __nb_threads) return;
+        oldpool.swap(__pool);
+        __nb_threads = nbthreads;
+    }
+    // the loops that still use the old pool hold their own reference to it.
+    // Their calling threads process the chunks left by its stopped workers.
+    if(oldpool) oldpool->join();
+}
+
+void ParallelExecutor::parallel_for(size_t begin, size_t end, const RangeFunction& function, size_t chunksize, ProgressStatus * status)
+{
+    if (end <= begin) return;
+    size_t nbelements = end - begin;
+    size_t nbthreads = __nb_threads;
+    if (chunksize == 0) chunksize = std::max<size_t>(1, nbelements / (8 * nbthreads));
+
+    std::shared_ptr<ParallelLoop> loop(new ParallelLoop());
+    loop->begin = begin;
+    loop->end = end;
+    loop->chunksize = chunksize;
+    loop->nbchunks = (nbelements + chunksize - 1) / chunksize;
+    loop->function = &function;
+    loop->status = status;
+    loop->next = 0;
+    loop->failed = false;
+    loop->remaining = loop->nbchunks;
+
+    if (nbthreads > 1 && loop->nbchunks > 1) {
+        size_t nbworkers = std::min(nbthreads - 1, loop->nbchunks - 1);
+        ThreadPoolPtr pool = getPool();
+        for (size_t i = 0; i < nbworkers; ++i)
+            boost::asio::post(*pool, [loop]() {
+                PGL_PROFILE_ZONE("ParallelExecutor::worker");
+                loop->process();
+            });
+    }
+    loop->process();
+
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->done.wait(lock, [&loop]() { return loop->remaining == 0; });
+    if (loop->error) std::rethrow_exception(loop->error);
+}
+
+// Singleton access
+ParallelExecutor& ParallelExecutor::get()
+{
+    static ParallelExecutor EXECUTOR;
+    return EXECUTOR;
+}
+
+/* ----------------------------------------------------------------------- */
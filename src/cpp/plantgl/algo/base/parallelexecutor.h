@@ -0,0 +1,125 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+/*! \file parallelexecutor.h
+    \brief Definition of ParallelExecutor, a shared executor for parallel loops.
+*/
+
+
+
+#ifndef __parallelexecutor_h__
+#define __parallelexecutor_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "../algo_config.h"
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+/* ----------------------------------------------------------------------- */
+
+namespace boost { namespace asio { class thread_pool; };};
+
+PGL_BEGIN_NAMESPACE
+
+class ProgressStatus;
+
+/* ----------------------------------------------------------------------- */
+
+/**
+    \class ParallelExecutor
+    \brief A thread pool shared by the parallel algorithms of the library.
+
+    parallel_for splits a range into chunks. The worker threads and the
+    calling thread pick the next unprocessed chunk until none is left, so
+    that a slow chunk does not stall the others. The calling thread never
+    waits for a chunk it could process itself, which makes nested parallel
+    loops safe. Each index is processed exactly as in the serial loop, so
+    results do not depend on the number of threads.
+*/
+
+class ALGO_API ParallelExecutor {
+public:
+    typedef std::function<void(size_t, size_t)> RangeFunction;
+
+    ~ParallelExecutor();
+
+    /// Number of threads used by parallel loops, including the calling thread.
+    size_t nb_threads() const { return __nb_threads; }
+
+    /** Change the number of threads. 0 means the number of cores. 1 makes all the loops serial.
+        Loops already running finish on the previous pool. */
+    void set_nb_threads(size_t nbthreads);
+
+    /// Call function(chunkbegin, chunkend) on chunks of [begin, end). If chunksize is 0, a size is chosen from the number of threads.
+    void parallel_for(size_t begin, size_t end, const RangeFunction& function, size_t chunksize = 0, ProgressStatus * status = NULL);
+
+    /// Call function(i) for each i of [begin, end).
+    template<class Function>
+    void parallel_for_each(size_t begin, size_t end, Function function, size_t chunksize = 0, ProgressStatus * status = NULL)
+    {
+        parallel_for(begin, end, [&function](size_t cbegin, size_t cend) { for (size_t i = cbegin; i < cend; ++i) function(i); }, chunksize, status);
+    }
+
+    // Singleton access
+    static ParallelExecutor& get();
+
+protected:
+    ParallelExecutor();
+
+    typedef std::shared_ptr<boost::asio::thread_pool> ThreadPoolPtr;
+
+    ThreadPoolPtr getPool();
+
+    ThreadPoolPtr __pool;
+    std::atomic<size_t> __nb_threads;
+    std::mutex __pool_mutex;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
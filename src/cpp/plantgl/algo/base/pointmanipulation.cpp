@@ -43,9 +43,11 @@
 #include "discretizer.h"
 #include "../../pgl_container.h"
 #include "bboxcomputer.h"
+#include "parallelexecutor.h"
 #include <plantgl/scenegraph/container/indexarray_iterator.h>
 #include <plantgl/scenegraph/transformation/transformed.h>
 #include <plantgl/tool/util_progress.h>
+#include <plantgl/tool/util_profiler.h>
 #include <plantgl/scenegraph/geometry/boundingbox.h>
 #include <plantgl/algo/grid/kdtree.h>
 
@@ -60,7 +62,7 @@
 
 PGL_USING_NAMESPACE
 
-static unsigned int nthreads = boost::thread::hardware_concurrency();
+static inline unsigned int get_nb_threads() { return ParallelExecutor::get().nb_threads(); }
 
 class ThreadAdapter
 {
@@ -87,7 +89,7 @@ public:
 struct PointDistance {
   const Point3ArrayPtr &points;
 
-  real_t operator()(uint32_t a, uint32_t b) const { return norm(points->getAt(a) - points->getAt(b)); }
+  real_t operator()(uint32_t a, uint32_t b) const { return norm(const_array(*points).getAt(a) - const_array(*points).getAt(b)); }
 
   PointDistance(const Point3ArrayPtr &_points) : points(_points) {}
 };
@@ -96,7 +98,7 @@ struct PowerPointDistance {
   const Point3ArrayPtr points;
   real_t power;
 
-  real_t operator()(uint32_t a, uint32_t b) const { return pow(norm(points->getAt(a) - points->getAt(b)), power); }
+  real_t operator()(uint32_t a, uint32_t b) const { return pow(norm(const_array(*points).getAt(a) - const_array(*points).getAt(b)), power); }
 
   PowerPointDistance(const Point3ArrayPtr _points, real_t _power) : points(_points), power(_power) {}
 };
@@ -266,7 +268,7 @@ std::pair<Point3ArrayPtr, Index> PGL(add_baricenter_points_of_path)(Point3ArrayP
 	ThreadAdapterAddBaricenterPointsOfPath adapter(point, kclosest, radius);
 	adapter.status = ProgressStatus(path.size(), "Computing baricenter points of path.", 0.1f);
 
-	boost::asio::thread_pool threadPool(nthreads);
+	boost::asio::thread_pool threadPool(get_nb_threads());
 
 	for (Index::const_iterator it = path.begin(); it != path.end(); ++it) {
 		boost::asio::post(threadPool, boost::bind(&ThreadAdapterAddBaricenterPointsOfPath::operator(), &adapter, *it));
@@ -354,7 +356,7 @@ RealArrayPtr PGL(get_radii_of_path)(Point3ArrayPtr const &point, IndexArrayPtr c
 	adapter.status = ProgressStatus(totalTasks, "Computing all radius of path.", 0.1f);
 	adapter.status.refresh();
 	
-	boost::asio::thread_pool threadPool(nthreads);
+	boost::asio::thread_pool threadPool(get_nb_threads());
 
 	for (Index::const_iterator it = path.begin(); it != path.end(); ++it) {
 		Index::const_iterator const next = it + 1;
@@ -482,7 +484,7 @@ Index PGL(select_wire_from_path)(Point3ArrayPtr const &point, Index const &path,
 	adapter.status.refresh();
 
 	// Thread pool
-	boost::asio::thread_pool threadPool(nthreads > 1 ? nthreads - 1 : 1);
+	boost::asio::thread_pool threadPool(get_nb_threads() > 1 ? get_nb_threads() - 1 : 1);
 
 	// Main thread
 	boost::thread thread(&ThreadAdapterWireSelection::main, &adapter, boost::ref(path), boost::ref(radii), boost::ref(threadPool));
@@ -972,7 +974,7 @@ std::pair<Index, real_t> PGL(select_pole_from_point)(Point3ArrayPtr const &point
 {
 	srand(time(0));
 
-	boost::asio::thread_pool threadPool(nthreads);
+	boost::asio::thread_pool threadPool(get_nb_threads());
 	ThreadAdapterRansac adapter(points, 0.14, -1.0, maxAngle);
 
 	adapter.status = ProgressStatus(iterations, "Selecting pole.");
@@ -1017,7 +1019,7 @@ std::pair<Index, real_t> PGL(select_pole_points_mt)(Point3ArrayPtr const &point,
 	ThreadAdapterRansac adapter(point, radius, tolerance, 0.261799);
 	adapter.status = ProgressStatus(iterations, "Finding pole.", 0.1f);
 	
-	boost::asio::thread_pool threadPool(nthreads);
+	boost::asio::thread_pool threadPool(get_nb_threads());
 
 	for (uint_t i = 0; i < iterations; ++i) {
 		boost::asio::post(threadPool, boost::bind(&ThreadAdapterRansac::operator(), &adapter, 1));
@@ -1059,20 +1061,10 @@ PGL(k_closest_points_from_delaunay)(const Point3ArrayPtr points, size_t k) {
 
 IndexArrayPtr
 PGL(k_closest_points_from_ann)(const Point3ArrayPtr points, size_t k, bool symmetric) {
-#ifdef PGL_WITH_ANN
-  ANNKDTree3 kdtree(points);
+  KDTree3 kdtree(points);
   IndexArrayPtr result = kdtree.k_nearest_neighbors(k);
   if (symmetric) result = symmetrize_connections(result);
   return result;
-#else
-    #ifdef _MSC_VER
-    #pragma message("function 'k_closest_points_from_ann' disabled. ANN needed.")
-    #else
-    #warning "function 'k_closest_points_from_ann' disabled. ANN needed"
-    #endif
-
-    return IndexArrayPtr();
-#endif
 }
 
 
@@ -1091,6 +1083,39 @@ PGL(symmetrize_connections)(const IndexArrayPtr adjacencies) {
   return newadjacencies;
 }
 
+CSRIndexArrayPtr
+PGL(symmetrize_connections)(const CSRIndexArrayPtr adjacencies) {
+  uint32_t nbPoints = adjacencies->size();
+  const std::vector<uint_t>& offsets = adjacencies->getOffsets();
+  const std::vector<uint_t>& indices = adjacencies->getIndices();
+
+  // transposed graph, with sources sorted by increasing ids for each target.
+  std::vector<uint_t> roffsets(nbPoints + 1, 0);
+  for (std::vector<uint_t>::const_iterator itc = indices.begin(); itc != indices.end(); ++itc)
+    ++roffsets[*itc + 1];
+  for (uint32_t pid = 0; pid < nbPoints; ++pid)
+    roffsets[pid + 1] += roffsets[pid];
+  std::vector<uint_t> rindices(indices.size());
+  std::vector<uint_t> rpos(roffsets.begin(), roffsets.end() - 1);
+  for (uint32_t pid = 0; pid < nbPoints; ++pid)
+    for (uint_t k = offsets[pid]; k < offsets[pid + 1]; ++k)
+      rindices[rpos[indices[k]]++] = pid;
+
+  CSRIndexArrayPtr newadjacencies(new CSRIndexArray());
+  newadjacencies->reserve(nbPoints, 2 * indices.size());
+  std::vector<uint_t>& newindices = newadjacencies->getIndices();
+  for (uint32_t pid = 0; pid < nbPoints; ++pid) {
+    size_t rowbegin = newindices.size();
+    newindices.insert(newindices.end(), indices.begin() + offsets[pid], indices.begin() + offsets[pid + 1]);
+    for (uint_t k = roffsets[pid]; k < roffsets[pid + 1]; ++k) {
+      if (find(newindices.begin() + rowbegin, newindices.end(), rindices[k]) == newindices.end())
+        newindices.push_back(rindices[k]);
+    }
+    newadjacencies->getOffsets().push_back(newindices.size());
+  }
+  return newadjacencies;
+}
+
 #include <plantgl/tool/util_hashset.h>
 
 struct OneDistance {
@@ -1127,7 +1152,6 @@ PGL(get_all_connex_components)(const Point3ArrayPtr points, const IndexArrayPtr
 
 IndexArrayPtr
 PGL(connect_all_connex_components)(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, bool verbose) {
-#ifdef PGL_WITH_ANN
   // ids of points not accessible from the root connex component
   pgl_hash_set_uint32 nonconnected;
 
@@ -1188,7 +1212,7 @@ PGL(connect_all_connex_components)(const Point3ArrayPtr points, const IndexArray
     if (nonconnected.empty()) break;
 
     // create kdtree from connected points
-    ANNKDTree3 kdtree(refpoints);
+    KDTree3 kdtree(refpoints);
     real_t dist = REAL_MAX;
     std::pair<uint32_t, uint32_t> connection;
     bool allempty = true;
@@ -1221,15 +1245,6 @@ PGL(connect_all_connex_components)(const Point3ArrayPtr points, const IndexArray
   }
 
   return newadjacencies;
-#else
-	#ifdef _MSC_VER
-    #pragma message("function 'connect_all_connex_components' disabled. ANN needed.")
-    #else
-    #warning "function 'connect_all_connex_components' disabled. ANN needed"
-    #endif
-
-    return adjacencies;
-#endif
 }
 
 Index
@@ -1255,7 +1270,7 @@ PGL(r_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencie
   uint32_t current = 0;
   IndexArrayPtr result(new IndexArray(nbPoints));
   // std::vector<std::vector<std::pair<uint32_t, real_t> > > preinfo(nbPoints);
-  DijkstraReusingAllocator allocator;
+  DijkstraSparseResetAllocator allocator;
 
   ProgressStatus st(nbPoints, "R-neighborhood computed for %.2f%% of points.");
   for (RealArray::const_iterator itradii = radii->begin(); itradii != radii->end(); ++itradii, ++st) {
@@ -1289,7 +1304,7 @@ public:
 		ThreadAdapter(),
 		points(points),
 		adjacencies(adjacencies),
-		pdevaluator(points),
+		pdevaluator(this->points),
 		radius(radius)
 	{
 		result = IndexArrayPtr(new IndexArray(points->size()));
@@ -1299,15 +1314,16 @@ public:
 	{
 		uint32_t const size = points->size();
 		uint32_t const end = current + maxIter;
+		DijkstraSparseResetAllocator allocator;
 
 		for (; current < end && current < size; ++current) {
-			execute(current);
+			execute(current, allocator);
 		}
 	}
 
-	void execute(uint32_t current)
+	void execute(uint32_t current, const DijkstraSparseResetAllocator& allocator)
 	{
-		DijkstraNodeList const lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, radius, UINT32_MAX, DijkstraReusingAllocator());
+		DijkstraNodeList const lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, radius, UINT32_MAX, allocator);
 		// preinfo[current].clear();
 		Index lres;
 		lres.reserve(lneighborhood.size());
@@ -1331,9 +1347,10 @@ PGL(r_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencie
 
   adapter.status = ProgressStatus(nbPoints, "R-neighborhood computed for %.2f%% of points.", 0.01f);
   adapter.status.refresh();
+  DijkstraSparseResetAllocator allocator;
 
   for (uint32_t current = 0; current < nbPoints; ++current) {
-	  adapter.execute(current);
+	  adapter.execute(current, allocator);
 	  if (verbose) {
 		  adapter.status.set(adapter.progress);
 	  }
@@ -1344,26 +1361,62 @@ PGL(r_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencie
 
 IndexArrayPtr
 PGL(r_neighborhoods_mt)(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, real_t radius, bool verbose) {
+  PGL_PROFILE_ZONE("r_neighborhoods_mt");
   uint32_t const nbPoints = points->size();
   GEOM_ASSERT(nbPoints == adjacencies->size());
   GEOM_ASSERT(nbPoints == radii->size());
 
   ThreadAdapterRNeighborhoods adapter(points, adjacencies, radius);
-  boost::asio::thread_pool pool(nthreads);
 
   adapter.status = ProgressStatus(nbPoints, "R-neighborhood computed for %.2f%% of points.", 0.01f);
   adapter.status.refresh();
 
-  for (uint32_t current = 0; current < nbPoints; current += 1000) {
-	  boost::asio::post(pool, boost::bind(&ThreadAdapterRNeighborhoods::operator(), &adapter, current, 1000));
-  }
+  ParallelExecutor::get().parallel_for(0, nbPoints, [&adapter](size_t begin, size_t end) { adapter(begin, end - begin); },
+                                       1000, verbose ? &adapter.status : NULL);
+  return adapter.result;
+}
 
-  if (verbose) {
-	  adapter.wait();
+// Append the neighborhoods of the points in [begin, end) to result.
+static void csr_neighborhoods_range(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies,
+                                    real_t radius, uint32_t maxnbelements,
+                                    uint32_t begin, uint32_t end, CSRIndexArray * result) {
+  struct PointDistance pdevaluator(points);
+  DijkstraSparseResetAllocator allocator;
+  std::vector<uint_t>& indices = result->getIndices();
+  for (uint32_t current = begin; current < end; ++current) {
+    DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, radius, maxnbelements, allocator);
+    for (DijkstraNodeList::const_iterator itn = lneighborhood.begin(); itn != lneighborhood.end(); ++itn)
+      indices.push_back(itn->id);
+    result->getOffsets().push_back(indices.size());
   }
+}
 
-  pool.join();
-  return adapter.result;
+CSRIndexArrayPtr
+PGL(r_neighborhoods)(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies, real_t radius) {
+  uint32_t const nbPoints = points->size();
+  GEOM_ASSERT(nbPoints == adjacencies->size());
+  CSRIndexArrayPtr result(new CSRIndexArray());
+  csr_neighborhoods_range(points, adjacencies, radius, UINT32_MAX, 0, nbPoints, result.get());
+  return result;
+}
+
+CSRIndexArrayPtr
+PGL(r_neighborhoods_mt)(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies, real_t radius) {
+  PGL_PROFILE_ZONE("r_neighborhoods_mt");
+  uint32_t const nbPoints = points->size();
+  GEOM_ASSERT(nbPoints == adjacencies->size());
+  uint32_t const blocksize = 1000;
+  std::vector<CSRIndexArray> blocks((nbPoints + blocksize - 1) / blocksize);
+
+  ParallelExecutor::get().parallel_for_each(0, blocks.size(), [&](size_t block) {
+    csr_neighborhoods_range(points, adjacencies, radius, UINT32_MAX,
+                            block * blocksize, std::min<uint32_t>(nbPoints, (block + 1) * blocksize), &blocks[block]);
+  }, 1);
+
+  CSRIndexArrayPtr result(new CSRIndexArray());
+  for (std::vector<CSRIndexArray>::const_iterator itblock = blocks.begin(); itblock != blocks.end(); ++itblock)
+    result->append(*itblock);
+  return result;
 }
 
 struct PointAnisotropicDistance {
@@ -1372,7 +1425,7 @@ struct PointAnisotropicDistance {
   real_t alpha, beta;
 
   real_t operator()(uint32_t a, uint32_t b) const {
-    return radialAnisotropicNorm(points->getAt(a) - points->getAt(b), direction, alpha, beta);
+    return radialAnisotropicNorm(const_array(*points).getAt(a) - const_array(*points).getAt(b), direction, alpha, beta);
   }
 
   PointAnisotropicDistance(const Point3ArrayPtr _points, const Vector3 &_direction, real_t _alpha, real_t _beta)
@@ -1402,23 +1455,25 @@ IndexArrayPtr
 PGL(r_anisotropic_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, const RealArrayPtr radii,
                                  const Point3ArrayPtr directions,
                                  const real_t alpha, const real_t beta) {
+  PGL_PROFILE_ZONE("r_anisotropic_neighborhoods");
   uint32_t nbPoints = points->size();
   GEOM_ASSERT(nbPoints == adjacencies->size());
   GEOM_ASSERT(nbPoints == radii->size());
   GEOM_ASSERT(nbPoints == directions->size());
 
-  uint32_t current = 0;
   IndexArrayPtr result(new IndexArray(nbPoints));
 
-  for (RealArray::const_iterator itradii = radii->begin(); itradii != radii->end(); ++itradii) {
-    struct PointAnisotropicDistance pdevaluator(points, directions->getAt(current), alpha, beta);
-    DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, *itradii);
-    Index lres;
-    for (DijkstraNodeList::const_iterator itn = lneighborhood.begin(); itn != lneighborhood.end(); ++itn)
-      lres.push_back(itn->id);
-    result->setAt(current, lres);
-    ++current;
-  }
+  ParallelExecutor::get().parallel_for(0, nbPoints, [&](size_t begin, size_t end) {
+    DijkstraSparseResetAllocator allocator;
+    for (uint32_t current = begin; current < end; ++current) {
+      struct PointAnisotropicDistance pdevaluator(points, const_array(*directions).getAt(current), alpha, beta);
+      DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, const_array(*radii).getAt(current), UINT32_MAX, allocator);
+      Index& lres = result->getAt(current);
+      lres.reserve(lneighborhood.size());
+      for (DijkstraNodeList::const_iterator itn = lneighborhood.begin(); itn != lneighborhood.end(); ++itn)
+        lres.push_back(itn->id);
+    }
+  });
   return result;
 }
 
@@ -1427,6 +1482,7 @@ IndexArrayPtr
 PGL(r_anisotropic_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, real_t radius,
                                  const Point3ArrayPtr directions,
                                  const real_t alpha, const real_t beta) {
+  PGL_PROFILE_ZONE("r_anisotropic_neighborhoods");
   uint32_t nbPoints = points->size();
   GEOM_ASSERT(nbPoints == adjacencies->size());
   GEOM_ASSERT(nbPoints == radii->size());
@@ -1434,14 +1490,17 @@ PGL(r_anisotropic_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPt
 
 
   IndexArrayPtr result(new IndexArray(nbPoints));
-  for (uint32_t current = 0; current < nbPoints; ++current) {
-    struct PointAnisotropicDistance pdevaluator(points, directions->getAt(current), alpha, beta);
-    DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, radius);
-    Index lres;
-    for (DijkstraNodeList::const_iterator itn = lneighborhood.begin(); itn != lneighborhood.end(); ++itn)
-      lres.push_back(itn->id);
-    result->setAt(current, lres);
-  }
+  ParallelExecutor::get().parallel_for(0, nbPoints, [&](size_t begin, size_t end) {
+    DijkstraSparseResetAllocator allocator;
+    for (uint32_t current = begin; current < end; ++current) {
+      struct PointAnisotropicDistance pdevaluator(points, const_array(*directions).getAt(current), alpha, beta);
+      DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, radius, UINT32_MAX, allocator);
+      Index& lres = result->getAt(current);
+      lres.reserve(lneighborhood.size());
+      for (DijkstraNodeList::const_iterator itn = lneighborhood.begin(); itn != lneighborhood.end(); ++itn)
+        lres.push_back(itn->id);
+    }
+  });
   return result;
 }
 
@@ -1460,15 +1519,14 @@ RealArrayPtr
 PGL(densities_from_r_neighborhood)(const Point3ArrayPtr points,
                                    const IndexArrayPtr adjacencies,
                                    const real_t radius) {
+  PGL_PROFILE_ZONE("densities_from_r_neighborhood");
   uint32_t nbPoints = points->size();
   GEOM_ASSERT(nbPoints == adjacencies->size());
   RealArrayPtr result(new RealArray(nbPoints));
-  uint32_t current = 0;
   ProgressStatus st(nbPoints, "Density computed for %.2f%% of points.", 0.1);
-  for (RealArray::iterator itres = result->begin(); itres != result->end(); ++itres, ++st) {
-    *itres = density_from_r_neighborhood(current, points, adjacencies, radius);
-    ++current;
-  }
+  ParallelExecutor::get().parallel_for_each(0, nbPoints, [&](size_t current) {
+    result->setAt(current, density_from_r_neighborhood(current, points, adjacencies, radius));
+  }, 0, &st);
   return result;
 }
 
@@ -1476,14 +1534,22 @@ PGL(densities_from_r_neighborhood)(const Point3ArrayPtr points,
 RealArrayPtr
 PGL(densities_from_r_neighborhood)(const IndexArrayPtr neighborhood,
                                    const real_t radius) {
+  PGL_PROFILE_ZONE("densities_from_r_neighborhood");
   uint32_t nbPoints = neighborhood->size();
   RealArrayPtr result(new RealArray(nbPoints));
-  uint32_t current = 0;
-  IndexArray::const_iterator itnbg = neighborhood->begin();
   ProgressStatus st(nbPoints, "Density computed for %.2f%% of points.", 0.1);
-  for (RealArray::iterator itres = result->begin(); itres != result->end(); ++itres, ++itnbg, ++st) {
-    *itres = itnbg->size() / (radius * radius);
-  }
+  ParallelExecutor::get().parallel_for_each(0, nbPoints, [&](size_t current) {
+    result->setAt(current, const_array(*neighborhood).getAt(current).size() / (radius * radius));
+  }, 0, &st);
+  return result;
+}
+
+CSRIndexArrayPtr
+PGL(k_neighborhoods)(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies, const uint32_t k) {
+  uint32_t const nbPoints = points->size();
+  GEOM_ASSERT(nbPoints == adjacencies->size());
+  CSRIndexArrayPtr result(new CSRIndexArray());
+  csr_neighborhoods_range(points, adjacencies, REAL_MAX, k, 0, nbPoints, result.get());
   return result;
 }
 
@@ -1527,6 +1593,7 @@ PGL(k_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencie
   struct PointDistance pdevaluator(points);
 
   IndexArrayPtr result(new IndexArray(nbPoints));
+  DijkstraSparseResetAllocator allocator;
   for (uint32_t current = 0; current < nbPoints; ++current) {
     Index lres;
     const Index &candidates = adjacencies->getAt(current);
@@ -1534,7 +1601,7 @@ PGL(k_neighborhoods)(const Point3ArrayPtr points, const IndexArrayPtr adjacencie
             lres = get_k_closest_from_n(candidates,k,current,points);
         }
         else {*/
-    DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, REAL_MAX, k);
+    DijkstraNodeList lneighborhood = dijkstra_shortest_paths_in_a_range(adjacencies, current, pdevaluator, REAL_MAX, k, allocator);
     for (DijkstraNodeList::const_iterator itn = lneighborhood.begin(); itn != lneighborhood.end(); ++itn)
       lres.push_back(itn->id);
     // }
@@ -1601,7 +1668,7 @@ PGL(pointset_mean_radial_distance)(const Vector3 &origin,
   if (group.empty()) return 0;
   real_t sum_distance = 0;
   for (Index::const_iterator it = group.begin(); it != group.end(); ++it)
-    sum_distance += radialAnisotropicNorm(origin - points->getAt(*it), direction, 0, 1);
+    sum_distance += radialAnisotropicNorm(origin - const_array(*points).getAt(*it), direction, 0, 1);
   return sum_distance / group.size();
 }
 
@@ -1740,7 +1807,7 @@ PGL(point_section)(uint32_t pid,
                    const IndexArrayPtr adjacencies,
                    const Vector3 &direction,
                    real_t width) {
-  Vector3 &pt = points->getAt(pid);
+  const Vector3 &pt = const_array(*points).getAt(pid);
   Vector3 dir = direction.normed();
   Index result;
   result.push_back(pid);
@@ -1753,11 +1820,11 @@ PGL(point_section)(uint32_t pid,
     uint32_t cid = toprocess.front();
     toprocess.pop_front();
 
-    const Index &padjacency = adjacencies->getAt(cid);
+    const Index &padjacency = const_array(*adjacencies).getAt(cid);
     for (Index::const_iterator it = padjacency.begin(); it != padjacency.end(); ++it)
       if (considered.find(*it) == considered.end()) {
         considered.insert(*it);
-        if (radialAnisotropicNorm(points->getAt(*it) - pt, dir, 1, 0) < width) {
+        if (radialAnisotropicNorm(const_array(*points).getAt(*it) - pt, dir, 1, 0) < width) {
           result.push_back(*it);
           toprocess.push_back(*it);
         }
@@ -1773,7 +1840,7 @@ PGL(point_section)(uint32_t pid,
                    const Vector3 &direction,
                    real_t width,
                    real_t maxradius) {
-  Vector3 &pt = points->getAt(pid);
+  const Vector3 &pt = const_array(*points).getAt(pid);
   Vector3 dir = direction.normed();
   Index result;
   result.push_back(pid);
@@ -1786,11 +1853,11 @@ PGL(point_section)(uint32_t pid,
     uint32_t cid = toprocess.front();
     toprocess.pop_front();
 
-    const Index &padjacency = adjacencies->getAt(cid);
+    const Index &padjacency = const_array(*adjacencies).getAt(cid);
     for (Index::const_iterator it = padjacency.begin(); it != padjacency.end(); ++it)
       if (considered.find(*it) == considered.end()) {
         considered.insert(*it);
-        Vector3 lpoint = points->getAt(*it) - pt;
+        Vector3 lpoint = const_array(*points).getAt(*it) - pt;
         real_t a = dot(lpoint, dir);
         real_t b = norm(lpoint - a * dir);
         if ((fabs(a) < width) && (b < maxradius)) {
@@ -1827,7 +1894,7 @@ PGL(pointset_circle)(const Point3ArrayPtr points,
                      bool bounding) {
   size_t gsize = group.size();
   if (gsize == 0) return std::pair<Vector3, real_t>(Vector3(0, 0, 0), 0);
-  else if (gsize == 1) return std::pair<Vector3, real_t>(points->getAt(group[0]), 0);
+  else if (gsize == 1) return std::pair<Vector3, real_t>(const_array(*points).getAt(group[0]), 0);
 
   Vector3 center;
   Plane3 plane;
@@ -1842,7 +1909,7 @@ PGL(pointset_circle)(const Point3ArrayPtr points,
       Point2ArrayPtr lpoints2(new Point2Array(group.size()));
       Point2Array::iterator itp2 = lpoints2->begin();
       for (Index::const_iterator itg = group.begin(); itg != group.end(); ++itg, ++itp2) {
-        Vector3 p = points->getAt(*itg) - center;
+        Vector3 p = const_array(*points).getAt(*itg) - center;
         *itp2 = Vector2(dot(p, a), dot(p, b));
       }
 
@@ -1871,7 +1938,7 @@ PGL(pointset_circle)(const Point3ArrayPtr points,
                      bool bounding) {
   size_t gsize = group.size();
   if (gsize == 0) return std::pair<Vector3, real_t>(Vector3(0, 0, 0), 0);
-  else if (gsize == 1) return std::pair<Vector3, real_t>(points->getAt(group[0]), 0);
+  else if (gsize == 1) return std::pair<Vector3, real_t>(const_array(*points).getAt(group[0]), 0);
 
   Vector3 center = centroid_of_group(points, group);
 
@@ -1885,7 +1952,7 @@ PGL(pointset_circle)(const Point3ArrayPtr points,
     Point2ArrayPtr lpoints2(new Point2Array(group.size()));
     Point2Array::iterator itp2 = lpoints2->begin();
     for (Index::const_iterator itg = group.begin(); itg != group.end(); ++itg, ++itp2) {
-      Vector3 p = points->getAt(*itg) - center;
+      Vector3 p = const_array(*points).getAt(*itg) - center;
       *itp2 = Vector2(dot(p, a), dot(p, b));
     }
 
@@ -1931,24 +1998,20 @@ PGL(pointsets_section_circles)(const Point3ArrayPtr points,
                                const Point3ArrayPtr directions,
                                real_t width,
                                bool bounding) {
+  PGL_PROFILE_ZONE("pointsets_section_circles");
   size_t nbpoints = points->size();
   Point3ArrayPtr respoints(new Point3Array(nbpoints));
   RealArrayPtr resradius(new RealArray(nbpoints, 0));
-  Point3Array::iterator itrp = respoints->begin();
-  RealArray::iterator itrr = resradius->begin();
-  size_t pid = 0;
 
   ProgressStatus st(nbpoints, "Section and circles computed for %.2f%% of points.");
 
-  for (Point3Array::const_iterator itd = directions->begin();
-       itd != directions->end(); ++itd, ++itrp, ++itrr, ++pid, ++st) {
-    Index section = point_section(pid, points, adjacencies, *itd, width);
-    // if(section.size() == 0) printf("Pb with %i\n",pid);
-    std::pair<Vector3, real_t> lres;
-    lres = pointset_circle(points, section, *itd, bounding);
-    *itrp = lres.first;
-    *itrr = lres.second;
-  }
+  ParallelExecutor::get().parallel_for_each(0, directions->size(), [&](size_t pid) {
+    const Vector3& direction = const_array(*directions).getAt(pid);
+    Index section = point_section(pid, points, adjacencies, direction, width);
+    std::pair<Vector3, real_t> lres = pointset_circle(points, section, direction, bounding);
+    respoints->setAt(pid, lres.first);
+    resradius->setAt(pid, lres.second);
+  }, 0, &st);
   return std::pair<Point3ArrayPtr, RealArrayPtr>(respoints, resradius);
 
 }
@@ -2355,7 +2418,7 @@ PGL(centroid_of_group)(const Point3ArrayPtr points,
   Vector3 gcentroid;
   real_t nbpoints = 0;
   for (Index::const_iterator itn = group.begin(); itn != group.end(); ++itn, ++nbpoints) {
-    gcentroid += points->getAt(*itn);
+    gcentroid += const_array(*points).getAt(*itn);
   }
   return gcentroid / nbpoints;
 }
@@ -2363,11 +2426,11 @@ PGL(centroid_of_group)(const Point3ArrayPtr points,
 Point3ArrayPtr
 PGL(centroids_of_groups)(const Point3ArrayPtr points,
                          const IndexArrayPtr groups) {
+  PGL_PROFILE_ZONE("centroids_of_groups");
   Point3ArrayPtr result(new Point3Array(groups->size()));
-  uint32_t cgroup = 0;
-  for (IndexArray::const_iterator itgs = groups->begin(); itgs != groups->end(); ++itgs, ++cgroup) {
-    result->setAt(cgroup, centroid_of_group(points, *itgs));
-  }
+  ParallelExecutor::get().parallel_for_each(0, groups->size(), [&](size_t cgroup) {
+    result->setAt(cgroup, centroid_of_group(points, const_array(*groups).getAt(cgroup)));
+  });
   return result;
 }
 
@@ -2376,11 +2439,7 @@ PGL(skeleton_from_distance_to_root_clusters)(const Point3ArrayPtr points, uint32
                                              Uint32Array1Ptr &group_parents, IndexArrayPtr &group_components,
                                              bool connect_all_points, bool verbose) {
   if (verbose)std::cout << "Compute Remanian graph." << std::endl;
-#ifdef PGL_WITH_ANN
   IndexArrayPtr remaniangraph = k_closest_points_from_ann(points, k, connect_all_points);
-#else
-  IndexArrayPtr remaniangraph =  k_closest_points_from_delaunay(points, k);
-#endif
   if (connect_all_points) {
     if (verbose)std::cout << "Connect all components of Riemanian graph." << std::endl;
     remaniangraph = connect_all_connex_components(points, remaniangraph, verbose);
@@ -2549,7 +2608,6 @@ PGL(average_radius)(const Point3ArrayPtr points,
                     const Point3ArrayPtr nodes,
                     const Uint32Array1Ptr parents,
                     uint32_t maxclosestnode) {
-#ifdef PGL_WITH_ANN
   uint32_t root;
   IndexArrayPtr children = determine_children(parents, root);
 
@@ -2558,7 +2616,7 @@ PGL(average_radius)(const Point3ArrayPtr points,
   if (maxclosestnode >= nb_nodes) maxclosestnode = nb_nodes;
   real_t sum_min_dist = 0;
   uint32_t nb_samples = 0;
-  ANNKDTree3 tree(nodes);
+  KDTree3 tree(nodes);
   for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp) {
     real_t minpdist = REAL_MAX;
     Index nids = tree.k_closest_points(*itp, maxclosestnode);
@@ -2580,15 +2638,6 @@ PGL(average_radius)(const Point3ArrayPtr points,
     }
   }
   return sum_min_dist / nb_samples;
-#else
-                                                                                                                          #ifdef _MSC_VER
-    #pragma message("function 'average_radius' disabled. ANN needed.")
-    #else
-    #warning "function 'average_radius' disabled. ANN needed"
-    #endif
-
-    return 0;
-#endif
 }
 
 real_t PGL(average_distance_to_shape)(const Point3ArrayPtr points,
@@ -2596,7 +2645,6 @@ real_t PGL(average_distance_to_shape)(const Point3ArrayPtr points,
                                       const Uint32Array1Ptr parents,
                                       const RealArrayPtr radii,
                                       uint32_t maxclosestnodes) {
-#ifdef PGL_WITH_ANN
   uint32_t root;
   IndexArrayPtr children = determine_children(parents, root);
 
@@ -2605,7 +2653,7 @@ real_t PGL(average_distance_to_shape)(const Point3ArrayPtr points,
   if (maxclosestnodes >= nb_nodes) maxclosestnodes = nb_nodes;
   real_t sum_min_dist = 0;
   uint32_t nb_samples = 0;
-  ANNKDTree3 tree(nodes);
+  KDTree3 tree(nodes);
   ProgressStatus st(points->size(), "distance to shape for %.2f%% of points.");
 
   for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++st) {
@@ -2635,15 +2683,6 @@ real_t PGL(average_distance_to_shape)(const Point3ArrayPtr points,
     }
   }
   return sum_min_dist / nb_samples;
-#else
-                                                                                                                          #ifdef _MSC_VER
-    #pragma message("function 'average_distance_to_shape' disabled. ANN needed.")
-    #else
-    #warning "function 'average_distance_to_shape' disabled. ANN needed"
-    #endif
-
-    return 0;
-#endif
 }
 
 RealArrayPtr PGL(distance_to_shape)(const Point3ArrayPtr points,
@@ -2651,7 +2690,6 @@ RealArrayPtr PGL(distance_to_shape)(const Point3ArrayPtr points,
                                            const Uint32Array1Ptr parents,
                                            const RealArrayPtr radii,
                                            uint32_t maxclosestnodes) {
-#ifdef PGL_WITH_ANN
   uint32_t root;
   IndexArrayPtr children = determine_children(parents, root);
 
@@ -2661,7 +2699,7 @@ RealArrayPtr PGL(distance_to_shape)(const Point3ArrayPtr points,
   uint32_t nbPoints = points->size();
   RealArrayPtr result(new RealArray(nbPoints));
   uint32_t pid = 0;
-  ANNKDTree3 tree(nodes);
+  KDTree3 tree(nodes);
   ProgressStatus st(nbPoints, "distance to shape for %.2f%% of points.");
 
   for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++pid, ++st) {
@@ -2688,15 +2726,6 @@ RealArrayPtr PGL(distance_to_shape)(const Point3ArrayPtr points,
     result->getAt(pid) = minpdist;
   }
   return result;
-#else
-                                                                                                                          #ifdef _MSC_VER
-    #pragma message("function 'distance_to_shape' disabled. ANN needed.")
-    #else
-    #warning "function 'distance_to_shape' disabled. ANN needed"
-    #endif
-
-    return 0;
-#endif
 }
 
 RealArrayPtr PGL(estimate_radii_from_points)(const Point3ArrayPtr points,
@@ -2704,7 +2733,7 @@ RealArrayPtr PGL(estimate_radii_from_points)(const Point3ArrayPtr points,
                                                     const Uint32Array1Ptr parents,
                                                     bool maxmethod,
                                                     uint32_t maxclosestnodes) {
-#ifdef PGL_WITH_ANN
+  PGL_PROFILE_ZONE("estimate_radii_from_points");
   uint32_t root;
   IndexArrayPtr children = determine_children(parents, root);
 
@@ -2714,21 +2743,25 @@ RealArrayPtr PGL(estimate_radii_from_points)(const Point3ArrayPtr points,
   uint32_t nbPoints = points->size();
   RealArrayPtr result(new RealArray(nb_nodes));
   Uint32Array1Ptr resultnb(new Uint32Array1(nb_nodes));
-  uint32_t pid = 0;
-  ANNKDTree3 tree(nodes);
+  // the queries are run in parallel by the native tree, which is thread safe.
+  NativeKDTree3 tree(nodes);
+  IndexArrayPtr closestnodes = tree.k_closest_points(points, maxclosestnodes);
+  std::vector<uint32_t> pointnode(nbPoints);
+  std::vector<real_t> pointdist(nbPoints);
   ProgressStatus st(nbPoints, "distance to shape for %.2f%% of points.");
 
-  for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++pid, ++st) {
+  ParallelExecutor::get().parallel_for_each(0, nbPoints, [&](size_t pid) {
+    const Vector3& point = const_array(*points).getAt(pid);
+    const Index& nids = const_array(*closestnodes).getAt(pid);
     real_t minpdist = REAL_MAX;
-    Index nids = tree.k_closest_points(*itp, maxclosestnodes);
     uint32_t nid1 = 0, nid2 = 0;
     real_t posu = 0;
     for (Index::const_iterator nit = nids.begin(); nit != nids.end(); ++nit) {
 
-      Vector3 point(*itp);
+      Vector3 lpoint(point);
       real_t u;
-      uint32_t parent = parents->getAt(*nit);
-      real_t d = closestPointToSegment(point, nodes->getAt(*nit), nodes->getAt(parent), &u);
+      uint32_t parent = const_array(*parents).getAt(*nit);
+      real_t d = closestPointToSegment(lpoint, const_array(*nodes).getAt(*nit), const_array(*nodes).getAt(parent), &u);
       if (d < minpdist) {
         minpdist = d;
         nid1 = *nit;
@@ -2736,9 +2769,9 @@ RealArrayPtr PGL(estimate_radii_from_points)(const Point3ArrayPtr points,
         posu = u;
       }
 
-      for (Index::const_iterator nitc = children->getAt(*nit).begin(); nitc != children->getAt(*nit).end(); ++nitc) {
-        Vector3 mpoint(*itp);
-        d = closestPointToSegment(mpoint, nodes->getAt(*nit), nodes->getAt(*nitc), &u);
+      for (Index::const_iterator nitc = const_array(*children).getAt(*nit).begin(); nitc != const_array(*children).getAt(*nit).end(); ++nitc) {
+        Vector3 mpoint(point);
+        d = closestPointToSegment(mpoint, const_array(*nodes).getAt(*nit), const_array(*nodes).getAt(*nitc), &u);
         if (d < minpdist) {
           minpdist = d;
           nid1 = *nit;
@@ -2750,10 +2783,17 @@ RealArrayPtr PGL(estimate_radii_from_points)(const Point3ArrayPtr points,
     if (posu > 0.5) {
       nid1 = nid2;
     }
+    pointnode[pid] = nid1;
+    pointdist[pid] = minpdist;
+  }, 0, &st);
+
+  // accumulate in point order so that the sums do not depend on the scheduling
+  for (uint32_t pid = 0; pid < nbPoints; ++pid) {
+    uint32_t nid1 = pointnode[pid];
     if (maxmethod)
-      result->getAt(nid1) = std::max(result->getAt(nid1), minpdist);
+      result->getAt(nid1) = std::max(result->getAt(nid1), pointdist[pid]);
     else {
-      result->getAt(nid1) += minpdist;
+      result->getAt(nid1) += pointdist[pid];
       resultnb->getAt(nid1) += 1;
     }
   }
@@ -2764,15 +2804,6 @@ RealArrayPtr PGL(estimate_radii_from_points)(const Point3ArrayPtr points,
   }
 
   return result;
-#else
-                                                                                                                          #ifdef _MSC_VER
-    #pragma message("function 'estimate_radii_from_points' disabled. ANN needed.")
-    #else
-    #warning "function 'distance_to_shape' disabled. ANN needed"
-    #endif
-
-    return 0;
-#endif
 }
 
 inline bool distance_test(real_t d, real_t distance, bool reversed) {
@@ -2785,7 +2816,6 @@ Index PGL(points_at_distance_from_skeleton)(const Point3ArrayPtr points,
                                             const Uint32Array1Ptr parents,
                                             real_t distance,
                                             uint32_t maxclosestnodes) {
-#ifdef PGL_WITH_ANN
   Index result;
   uint32_t root;
   IndexArrayPtr children = determine_children(parents, root);
@@ -2802,7 +2832,7 @@ Index PGL(points_at_distance_from_skeleton)(const Point3ArrayPtr points,
   }
 
 
-  ANNKDTree3 tree(nodes);
+  KDTree3 tree(nodes);
 
   size_t pid = 0;
   for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++pid) {
@@ -2833,37 +2863,18 @@ Index PGL(points_at_distance_from_skeleton)(const Point3ArrayPtr points,
     if (!ok && reversed) result.push_back(pid);
   }
   return result;
-#else
-                                                                                                                          #ifdef _MSC_VER
-    #pragma message("function 'points_at_distance_from_skeleton' disabled. ANN needed.")
-    #else
-    #warning "function 'points_at_distance_from_skeleton' disabled. ANN needed"
-    #endif
-
-    return Index();
-#endif
 }
 
 IndexArrayPtr PGL(cluster_points)(const Point3ArrayPtr points, const Point3ArrayPtr clustercentroid) {
   IndexArrayPtr result(new IndexArray(clustercentroid->size()));
 
-#ifdef PGL_WITH_ANN
-  ANNKDTree3 centroids(clustercentroid);
-#else
-  Point3GridPtr centroids(new Point3Grid(clustercentroid,20));
-#endif
+  KDTree3 centroids(clustercentroid);
 
   size_t pid = 0;
   for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++pid) {
     real_t minpdist = REAL_MAX;
-#ifdef PGL_WITH_ANN
     Index nids = centroids.k_closest_points(*itp, 1);
     result->getAt(nids[0]).push_back(pid);
-#else
-                                                                                                                            size_t pidclosest;
-        if( centroids->closest_point(*itp, pidclosest) )
-            result->getAt(pidclosest).push_back(pid);
-#endif
 
   }
 
@@ -2873,23 +2884,13 @@ IndexArrayPtr PGL(cluster_points)(const Point3ArrayPtr points, const Point3Array
 Uint32Array1Ptr PGL(points_clusters)(const Point3ArrayPtr points, const Point3ArrayPtr clustercentroid) {
   Uint32Array1Ptr result(new Uint32Array1(points->size()));
 
-#ifdef PGL_WITH_ANN
-  ANNKDTree3 centroids(clustercentroid);
-#else
-  Point3GridPtr centroids(new Point3Grid(clustercentroid,20));
-#endif
+  KDTree3 centroids(clustercentroid);
 
   size_t pid = 0;
   for (Point3Array::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++pid) {
     real_t minpdist = REAL_MAX;
-#ifdef PGL_WITH_ANN
     Index nids = centroids.k_closest_points(*itp, 1);
     result->setAt(pid, nids[0]);
-#else
-                                                                                                                            size_t pidclosest;
-        if( centroids->closest_point(*itp, pidclosest) )
-            result->setAt(pid,pidclosest);
-#endif
 
   }
 
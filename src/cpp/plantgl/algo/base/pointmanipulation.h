@@ -158,6 +158,9 @@ PGL_BEGIN_NAMESPACE
   ALGO_API IndexArrayPtr
   symmetrize_connections(const IndexArrayPtr adjacencies);
 
+  ALGO_API CSRIndexArrayPtr
+  symmetrize_connections(const CSRIndexArrayPtr adjacencies);
+
   ALGO_API IndexArrayPtr
   get_all_connex_components(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, bool verbose = false);
 
@@ -178,6 +181,13 @@ PGL_BEGIN_NAMESPACE
   ALGO_API IndexArrayPtr
   r_neighborhoods_mt(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, real_t radius, bool verbose = false);
 
+  // Versions working directly on compressed sparse row adjacency graphs.
+  ALGO_API CSRIndexArrayPtr
+  r_neighborhoods(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies, real_t radius);
+
+  ALGO_API CSRIndexArrayPtr
+  r_neighborhoods_mt(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies, real_t radius);
+
   ALGO_API Index
   r_anisotropic_neighborhood(uint32_t pid, const Point3ArrayPtr points,
                              const IndexArrayPtr adjacencies,
@@ -208,6 +218,9 @@ PGL_BEGIN_NAMESPACE
   ALGO_API IndexArrayPtr
   k_neighborhoods(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, const uint32_t k);
 
+  ALGO_API CSRIndexArrayPtr
+  k_neighborhoods(const Point3ArrayPtr points, const CSRIndexArrayPtr adjacencies, const uint32_t k);
+
 
 // Useful function
 
@@ -42,6 +42,7 @@
 
 #include "pointmanipulation.h"
 #include <plantgl/scenegraph/container/indexarray_iterator.h>
+#include "parallelexecutor.h"
 
 PGL_USING_NAMESPACE
 
@@ -281,10 +282,10 @@ PGL::principal_curvatures(const Point3ArrayPtr points, uint32_t pid, const Index
   typedef My_Monge_via_jet_fitting::Monge_form     My_Monge_form;
 
 std::vector<DPoint> in_points;
-in_points.push_back(toPoint3<DPoint>(points->getAt(pid)));
+in_points.push_back(toPoint3<DPoint>(const_array(*points).getAt(pid)));
 
 for(Index::const_iterator itNg = group.begin(); itNg != group.end(); ++itNg)
-    if (*itNg != pid) in_points.push_back(toPoint3<DPoint>(points->getAt(*itNg)));
+    if (*itNg != pid) in_points.push_back(toPoint3<DPoint>(const_array(*points).getAt(*itNg)));
 
 My_Monge_form monge_form;
 My_Monge_via_jet_fitting monge_fit;
@@ -310,22 +311,22 @@ result.normal = toVector3(monge_form.normal_direction());
 
 std::vector<CurvatureInfo>
 PGL::principal_curvatures(const Point3ArrayPtr points, const IndexArrayPtr groups, size_t fitting_degree, size_t monge_degree) {
-  std::vector<CurvatureInfo> result;
-  uint32_t i = 0;
-  for (IndexArray::const_iterator it = groups->begin(); it != groups->end(); ++it, ++i)
-    result.push_back(principal_curvatures(points, i, *it, fitting_degree, monge_degree));
+  std::vector<CurvatureInfo> result(groups->size());
+  ParallelExecutor::get().parallel_for_each(0, groups->size(), [&](size_t i) {
+    result[i] = principal_curvatures(points, i, const_array(*groups).getAt(i), fitting_degree, monge_degree);
+  });
   return result;
 }
 
 std::vector<CurvatureInfo>
 PGL::principal_curvatures(const Point3ArrayPtr points, const IndexArrayPtr adjacencies, real_t radius, size_t fitting_degree, size_t monge_degree) {
-  std::vector<CurvatureInfo> result;
   uint32_t nbPoints = points->size();
+  std::vector<CurvatureInfo> result(nbPoints);
 
-  for (uint32_t i = 0; i < nbPoints; ++i) {
+  ParallelExecutor::get().parallel_for_each(0, nbPoints, [&](size_t i) {
     Index ng = r_neighborhood(i, points, adjacencies, radius);
-    result.push_back(principal_curvatures(points, i, ng, fitting_degree, monge_degree));
-  }
+    result[i] = principal_curvatures(points, i, ng, fitting_degree, monge_degree);
+  });
   return result;
 
 }
@@ -339,7 +340,7 @@ Vector3 PGL::pointset_normal(const Point3ArrayPtr points, const Index &group) {
   std::list<CPoint> pointdata;
   // for (Point3Array::const_iterator it = points->begin(); it != points->end() ; ++it)
   for (Index::const_iterator it = group.begin(); it != group.end(); ++it)
-    pointdata.push_back(toPoint3<CPoint>(points->getAt(*it)));
+    pointdata.push_back(toPoint3<CPoint>(const_array(*points).getAt(*it)));
 
   CPlane plane;
   linear_least_squares_fitting_3(pointdata.begin(), pointdata.end(), plane, CGAL::Dimension_tag<0>());
@@ -359,10 +360,9 @@ Vector3 PGL::pointset_normal(const Point3ArrayPtr points, const Index &group) {
 Point3ArrayPtr
 PGL::pointsets_normals(const Point3ArrayPtr points, const IndexArrayPtr groups) {
   Point3ArrayPtr result(new Point3Array(points->size()));
-  uint32_t i = 0;
-  for (IndexArray::const_iterator it = groups->begin(); it != groups->end(); ++it, ++i) {
-    result->setAt(i, pointset_normal(points, *it));
-  }
+  ParallelExecutor::get().parallel_for_each(0, groups->size(), [&](size_t i) {
+    result->setAt(i, pointset_normal(points, const_array(*groups).getAt(i)));
+  });
   return result;
 }
 
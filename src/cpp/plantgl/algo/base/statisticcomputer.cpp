@@ -50,6 +50,9 @@
 #include <plantgl/pgl_transformation.h>
 #include <plantgl/pgl_container.h>
 #include <plantgl/scenegraph/scene/shape.h>
+#include <boost/core/demangle.hpp>
+#include <typeinfo>
+#include <algorithm>
 
 PGL_USING_NAMESPACE
 
@@ -71,11 +74,74 @@ using namespace std;
     GEOM_BEGIN(obj); \
     __element++; \
     __shape[num]++; \
-    __memsize += sizeof(*obj); \
+    if (visit(obj)) addMemory(num, sizeof(*obj) + string_memory_size(obj->getName())); \
 
 #define GEOM_APPLY(obj,field) \
     if(obj->get##field())obj->get##field()->apply(*this);
 
+#define GEOM_ARRAY(num,array) \
+    if(array) addArray(num, *array); \
+
+#define GEOM_MESH_ARRAYS(mesh,num) \
+    GEOM_ARRAY(num,mesh->getPointList()); \
+    GEOM_ARRAY(num,mesh->getIndexList()); \
+    GEOM_ARRAY(num,mesh->getNormalList()); \
+    GEOM_ARRAY(num,mesh->getNormalIndexList()); \
+    GEOM_ARRAY(num,mesh->getTexCoordList()); \
+    GEOM_ARRAY(num,mesh->getTexCoordIndexList()); \
+    GEOM_ARRAY(num,mesh->getColorList()); \
+    GEOM_ARRAY(num,mesh->getColorIndexList()); \
+
+
+/* ----------------------------------------------------------------------- */
+
+// Number of bytes allocated by \e s, if its characters do not fit in the string itself.
+static size_t string_memory_size(const std::string& s)
+{
+  const char * data = s.data();
+  const char * begin = reinterpret_cast<const char *>(&s);
+  if (data >= begin && data < begin + sizeof(s)) return 0;
+  return s.capacity() + 1;
+}
+
+// Number of bytes allocated for the elements of an array and, for an IndexArray, for its indices.
+template<class T>
+static size_t array_memory_size(const Array1<T>& array) { return array.getMemorySize(); }
+
+template<class T>
+static size_t array_memory_size(const Array2<T>& array) { return array.getMemorySize(); }
+
+static size_t array_memory_size(const IndexArray& array)
+{
+  size_t result = array.getMemorySize();
+  for (IndexArray::const_iterator it = array.begin(); it != array.end(); ++it)
+    result += it->capacity() * sizeof(uint_t);
+  return result;
+}
+
+// The elements of an Array1 can be shared by its copies. Those of an Array2 cannot.
+template<class T>
+static const void * array_buffer(const Array1<T>& array) { return array.getBufferId(); }
+
+template<class T>
+static const void * array_buffer(const Array2<T>& array) { return NULL; }
+
+template<class T>
+static bool array_is_shared(const Array1<T>& array) { return array.isShared(); }
+
+template<class T>
+static bool array_is_shared(const Array2<T>& array) { return false; }
+
+static const char * ElementNames[] = {
+  "Shape", "Material", "MonoSpectral", "MultiSpectral", "AmapSymbol", "AsymmetricHull",
+  "AxisRotated", "BezierCurve", "BezierPatch", "Box", "Cone", "Cylinder", "ElevationGrid",
+  "EulerRotated", "ExtrudedHull", "FaceSet", "Frustum", "Extrusion", "Group", "NurbsCurve",
+  "NurbsPatch", "Oriented", "Paraboloid", "PointSet", "Polyline", "Revolution", "QuadSet",
+  "Scaled", "Sphere", "Tapered", "Translated", "TriangleSet", "BezierCurve2D", "Disc",
+  "NurbsCurve2D", "PointSet2D", "Polyline2D", "Swung", "IFS", "ImageTexture", "Text", "Font",
+  "Texture2D", "Texture2DTransformation", "ScreenProjected"
+};
+
 
 /* ----------------------------------------------------------------------- */
 
@@ -86,12 +152,35 @@ StatisticComputer::StatisticComputer( ) :
   __element(0),
   __named(0),
   __shape((unsigned int)45,0),
-  __memsize(0){
+  __memsize(0),
+  __sharedmemsize(0),
+  __visited(),
+  __memsizes(__shape.size(),0),
+  __shapememsizes(),
+  __arrays(){
 }
 
 StatisticComputer::~StatisticComputer( ) {
 }
 
+void StatisticComputer::clear( ) {
+  __cache.clear();
+  __element = 0;
+  __named = 0;
+  std::fill(__shape.begin(), __shape.end(), 0);
+  __memsize = 0;
+  __sharedmemsize = 0;
+  __visited.clear();
+  std::fill(__memsizes.begin(), __memsizes.end(), 0);
+  __shapememsizes.clear();
+  __arrays.clear();
+}
+
+bool StatisticComputer::beginProcess( ) {
+  clear();
+  return true;
+}
+
 const uint_t
 StatisticComputer::getSize() const{
   return __element;
@@ -102,24 +191,85 @@ StatisticComputer::getNamed() const{
   return __named;
 }
 
-const uint_t
+size_t
 StatisticComputer::getMemorySize() const {
   return __memsize;
 }
 
+size_t
+StatisticComputer::getSharedMemorySize() const {
+  return __sharedmemsize;
+}
+
 const vector<uint_t>&
 StatisticComputer::getElements() const{
   return __shape;
 }
 
+const vector<size_t>&
+StatisticComputer::getMemorySizes() const{
+  return __memsizes;
+}
+
+const char *
+StatisticComputer::getElementName(uint_t i){
+  if (i >= sizeof(ElementNames) / sizeof(const char *)) return "";
+  return ElementNames[i];
+}
+
+const pgl_hash_map<uint_t,size_t>&
+StatisticComputer::getShapeMemorySizes() const{
+  return __shapememsizes;
+}
+
+const std::map<std::string,StatisticComputer::ArrayStatistics>&
+StatisticComputer::getArrayStatistics() const{
+  return __arrays;
+}
+
+bool StatisticComputer::visit(const void * object){
+  return __visited.insert(reinterpret_cast<size_t>(object)).second;
+}
+
+void StatisticComputer::addMemory(uint_t type, size_t size){
+  __memsize += size;
+  __memsizes[type] += size;
+}
+
+template<class A>
+void StatisticComputer::addArray(uint_t type, const A& array){
+  if (!visit(&array)) return;
+  std::string name = boost::core::demangle(typeid(array).name());
+  size_t pos = name.rfind("::");
+  if (pos != std::string::npos) name = name.substr(pos+2);
+  ArrayStatistics& stat = __arrays[name];
+  stat.count += 1;
+  stat.size += array.size();
+  stat.memsize += sizeof(array);
+  addMemory(type, sizeof(array));
+  // the elements shared by several copies of an array are counted once.
+  const void * buffer = array_buffer(array);
+  if (buffer && !visit(buffer)) return;
+  size_t elementsize = array_memory_size(array);
+  stat.memsize += elementsize;
+  addMemory(type, elementsize);
+  if (array_is_shared(array)) {
+    stat.sharedmemsize += elementsize;
+    __sharedmemsize += elementsize;
+  }
+}
+
 
 /* ----------------------------------------------------------------------- */
 
 
 bool StatisticComputer::process(Shape * shape){
+    // the objects shared by several shapes are counted with the first one.
+    size_t _memsize = __memsize;
     GEOM_COMPUTE(shape,0);
     GEOM_APPLY(shape,Geometry);
     GEOM_APPLY(shape,Appearance);
+    __shapememsizes[shape->getId()] += __memsize - _memsize;
     return true;
 }
 
@@ -137,6 +287,7 @@ bool StatisticComputer::process( Material * material ) {
 
 bool StatisticComputer::process( ImageTexture * texture ) {
     GEOM_COMPUTE(texture,39);
+    if (visit(&texture->getFilename())) addMemory(39, string_memory_size(texture->getFilename()));
     return true;
 }
 
@@ -171,8 +322,8 @@ bool StatisticComputer::process( MonoSpectral * monoSpectral ) {
 bool StatisticComputer::process( MultiSpectral * multiSpectral ) {
     GEOM_COMPUTE(multiSpectral,3);
 
-    __memsize += sizeof(*(multiSpectral->getReflectance()));
-    __memsize += sizeof(*(multiSpectral->getTransmittance()));
+    GEOM_ARRAY(3,multiSpectral->getReflectance());
+    GEOM_ARRAY(3,multiSpectral->getTransmittance());
 
     return true;
 }
@@ -184,9 +335,7 @@ bool StatisticComputer::process( MultiSpectral * multiSpectral ) {
 bool StatisticComputer::process( AmapSymbol * amapSymbol ) {
     GEOM_COMPUTE(amapSymbol,4);
 
-    __memsize += sizeof(*(amapSymbol->getPointList()));
-    __memsize += sizeof(*(amapSymbol->getIndexList()));
-    __memsize += sizeof(*(amapSymbol->getNormalList()));
+    GEOM_MESH_ARRAYS(amapSymbol,4);
 
     GEOM_APPLY(amapSymbol,Skeleton);
 
@@ -222,7 +371,7 @@ bool StatisticComputer::process( AxisRotated * axisRotated ) {
 bool StatisticComputer::process( BezierCurve * bezierCurve ) {
     GEOM_COMPUTE(bezierCurve,7);
 
-    __memsize += sizeof(*(bezierCurve->getCtrlPointList()));
+    GEOM_ARRAY(7,bezierCurve->getCtrlPointList());
 
     return true;
 }
@@ -234,7 +383,7 @@ bool StatisticComputer::process( BezierCurve * bezierCurve ) {
 bool StatisticComputer::process( BezierPatch * bezierPatch ) {
     GEOM_COMPUTE(bezierPatch,8);
 
-    __memsize += sizeof(*(bezierPatch->getCtrlPointMatrix()));
+    GEOM_ARRAY(8,bezierPatch->getCtrlPointMatrix());
 
     return true;
 }
@@ -276,7 +425,7 @@ bool StatisticComputer::process( Cylinder * cylinder ) {
 bool StatisticComputer::process( ElevationGrid * elevationGrid ) {
   GEOM_COMPUTE(elevationGrid,12);
 
-  __memsize += sizeof(*(elevationGrid->getHeightList()));
+  GEOM_ARRAY(12,elevationGrid->getHeightList());
 
   return true;
 }
@@ -313,8 +462,7 @@ bool StatisticComputer::process( ExtrudedHull * extrudedHull ) {
 bool StatisticComputer::process( FaceSet * faceSet ) {
   GEOM_COMPUTE(faceSet,15);
 
-  __memsize += sizeof(*(faceSet->getPointList()));
-  __memsize += sizeof(*(faceSet->getIndexList()));
+  GEOM_MESH_ARRAYS(faceSet,15);
 
   GEOM_APPLY(faceSet,Skeleton);
 
@@ -341,15 +489,13 @@ bool StatisticComputer::process( Extrusion * extrusion ) {
   GEOM_APPLY(extrusion,Axis);
   GEOM_APPLY(extrusion,CrossSection);
   if(extrusion->getProfileTransformation()){
-      __memsize += sizeof(*(extrusion->getProfileTransformation()));
-      if(extrusion->getProfileTransformation()->getScale())
-           __memsize += sizeof(*(extrusion->getProfileTransformation()->getScale()));
-      if(extrusion->getProfileTransformation()->getScale())
-           __memsize += sizeof(*(extrusion->getProfileTransformation()->getScale()));
-      if(extrusion->getProfileTransformation()->getOrientation())
-           __memsize += sizeof(*(extrusion->getProfileTransformation()->getOrientation()));
-      if(!extrusion->getProfileTransformation()->isKnotListToDefault())
-           __memsize += sizeof(*(extrusion->getProfileTransformation()->getKnotList()));
+      if (visit(extrusion->getProfileTransformation().get()))
+          addMemory(17, sizeof(*(extrusion->getProfileTransformation())));
+      GEOM_ARRAY(17,extrusion->getProfileTransformation()->getScale());
+      GEOM_ARRAY(17,extrusion->getProfileTransformation()->getOrientation());
+      if(!extrusion->getProfileTransformation()->isKnotListToDefault()){
+           GEOM_ARRAY(17,extrusion->getProfileTransformation()->getKnotList());
+      }
   }
 
   return true;
@@ -377,7 +523,7 @@ bool StatisticComputer::process( Group * group  ) {
 bool StatisticComputer::process( NurbsCurve * nurbsCurve ) {
   GEOM_COMPUTE(nurbsCurve,19);
 
-  __memsize += sizeof(*(nurbsCurve->getCtrlPointList()));
+  GEOM_ARRAY(19,nurbsCurve->getCtrlPointList());
 
   return true;
 }
@@ -388,7 +534,7 @@ bool StatisticComputer::process( NurbsCurve * nurbsCurve ) {
 bool StatisticComputer::process( NurbsPatch * nurbsPatch ) {
   GEOM_COMPUTE(nurbsPatch,20);
 
-  __memsize += sizeof(*(nurbsPatch->getCtrlPointMatrix()));
+  GEOM_ARRAY(20,nurbsPatch->getCtrlPointMatrix());
 
   return true;
 }
@@ -421,7 +567,7 @@ bool StatisticComputer::process( Paraboloid * paraboloid ) {
 bool StatisticComputer::process( PointSet * pointSet ) {
   GEOM_COMPUTE(pointSet,23);
 
-  __memsize += sizeof(*(pointSet->getPointList()));
+  GEOM_ARRAY(23,pointSet->getPointList());
 
   return true;
 }
@@ -433,7 +579,7 @@ bool StatisticComputer::process( PointSet * pointSet ) {
 bool StatisticComputer::process( Polyline * polyline ) {
   GEOM_COMPUTE(polyline,24);
 
-  __memsize += sizeof(*(polyline->getPointList()));
+  GEOM_ARRAY(24,polyline->getPointList());
 
   return true;
 }
@@ -457,8 +603,7 @@ bool StatisticComputer::process( Revolution * revolution ) {
 bool StatisticComputer::process( QuadSet * quadSet ) {
   GEOM_COMPUTE(quadSet,26);
 
-  __memsize += sizeof(*(quadSet->getPointList()));
-  __memsize += sizeof(*(quadSet->getIndexList()));
+  GEOM_MESH_ARRAYS(quadSet,26);
 
   GEOM_APPLY(quadSet,Skeleton);
 
@@ -530,8 +675,7 @@ bool StatisticComputer::process( Translated * translated ) {
 bool StatisticComputer::process( TriangleSet * triangleSet ) {
     GEOM_COMPUTE(triangleSet,31);
 
-    __memsize += sizeof(*(triangleSet->getPointList()));
-    __memsize += sizeof(*(triangleSet->getIndexList()));
+    GEOM_MESH_ARRAYS(triangleSet,31);
 
     GEOM_APPLY(triangleSet,Skeleton);
 
@@ -545,7 +689,7 @@ bool StatisticComputer::process( TriangleSet * triangleSet ) {
 bool StatisticComputer::process( BezierCurve2D * bezierCurve ) {
   GEOM_COMPUTE(bezierCurve,32);
 
-  __memsize += sizeof(*(bezierCurve->getCtrlPointList()));
+  GEOM_ARRAY(32,bezierCurve->getCtrlPointList());
 
   return true;
 }
@@ -567,7 +711,7 @@ bool StatisticComputer::process( Disc * disc ) {
 bool StatisticComputer::process( NurbsCurve2D * nurbsCurve ) {
   GEOM_COMPUTE(nurbsCurve,34);
 
-  __memsize += sizeof(*(nurbsCurve->getCtrlPointList()));
+  GEOM_ARRAY(34,nurbsCurve->getCtrlPointList());
 
   return true;
 }
@@ -578,7 +722,7 @@ bool StatisticComputer::process( NurbsCurve2D * nurbsCurve ) {
 bool StatisticComputer::process( PointSet2D * pointSet ) {
   GEOM_COMPUTE(pointSet,35);
 
-  __memsize += sizeof(*(pointSet->getPointList()));
+  GEOM_ARRAY(35,pointSet->getPointList());
 
   return true;
 }
@@ -590,7 +734,7 @@ bool StatisticComputer::process( PointSet2D * pointSet ) {
 bool StatisticComputer::process( Polyline2D * polyline ) {
   GEOM_COMPUTE(polyline,36);
 
-  __memsize += sizeof(*(polyline->getPointList()));
+  GEOM_ARRAY(36,polyline->getPointList());
 
   return true;
 }
@@ -603,7 +747,7 @@ bool StatisticComputer::process( Swung * swung )
 {
   GEOM_COMPUTE(swung,37);
 
-  __memsize += sizeof(*(swung->getAngleList()));
+  GEOM_ARRAY(37,swung->getAngleList());
 
   GEOM_APPLY(swung,ProfileList);
 
@@ -621,10 +765,10 @@ GEOM_TRACE("process IFS");
 //todo OK
 
   const Transform4ArrayPtr& tList= ifs->getTransfoList();
-  Transform4Ptr t4= *(tList->begin());
-
-  for( uchar_t i= 0; i < tList->size(); i++ )
-    __memsize += sizeof(*t4) * sizeof(*(ifs->getTransfoList()));
+  GEOM_ARRAY(38,tList);
+  if (tList)
+    for(Transform4Array::const_iterator it = tList->begin(); it != tList->end(); ++it)
+      if (*it && visit(it->get())) addMemory(38, sizeof(Transform4));
 
   GEOM_APPLY(ifs,Geometry);
 
@@ -636,6 +780,7 @@ GEOM_TRACE("process IFS");
 
 bool StatisticComputer::process( Text * text ) {
   GEOM_COMPUTE(text,40);
+  if (visit(&text->getString())) addMemory(40, string_memory_size(text->getString()));
   GEOM_APPLY(text,FontStyle);
   return true;
 }
@@ -644,6 +789,7 @@ bool StatisticComputer::process( Text * text ) {
 
 bool StatisticComputer::process( Font * font ) {
   GEOM_COMPUTE(font,41);
+  if (visit(&font->getFamily())) addMemory(41, string_memory_size(font->getFamily()));
   return true;
 }
 
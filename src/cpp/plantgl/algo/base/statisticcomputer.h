@@ -56,8 +56,11 @@
 //#endif
 
 #include <vector>
+#include <map>
+#include <string>
 #include <plantgl/tool/util_types.h>
 #include <plantgl/tool/util_hashset.h>
+#include <plantgl/tool/util_hashmap.h>
 
 /* ----------------------------------------------------------------------- */
 
@@ -68,6 +71,10 @@ PGL_BEGIN_NAMESPACE
 /**
    \class StatisticComputer
    \brief An action which compute statistics on a scene.
+
+   The memory size is the number of bytes of the objects of the scene and of
+   the buffers they allocate, without the overhead of the allocator. An object,
+   an array or the elements of arrays shared by several copies are counted once.
 */
 
 
@@ -76,25 +83,58 @@ class ALGO_API StatisticComputer : public Action
 {
 public:
 
+  struct ArrayStatistics {
+    ArrayStatistics( ) : count(0), size(0), memsize(0), sharedmemsize(0) {}
+    /// Number of arrays.
+    size_t count;
+    /// Number of elements of the arrays.
+    size_t size;
+    /// Memory size of the arrays, including their elements.
+    size_t memsize;
+    /// Memory size of the elements shared with copies of the arrays.
+    size_t sharedmemsize;
+  };
+
   /** Constructs a  StatisticComputer*/
   StatisticComputer();
 
   /// Destructor
   virtual ~StatisticComputer( ) ;
 
+  /// Clears the statistics and the objects already counted.
+  void clear( );
+
+  /// Clears the statistics before the process of a scene.
+  virtual bool beginProcess();
+
   /// Get the number of element of a scene.
   virtual const uint_t getSize() const;
 
   /// Get the number of named element of a scene.
   virtual const uint_t getNamed() const;
 
-  /// Get the memory size of the scene.
-  virtual const uint_t getMemorySize() const ;
+  /// Get the memory size of the scene, including the elements of its arrays.
+  virtual size_t getMemorySize() const ;
+
+  /// Get the memory size of the elements of the arrays of the scene that are shared with copies of these arrays.
+  virtual size_t getSharedMemorySize() const ;
 
 
   /// Get the all elements of the scene.
   virtual const std::vector<uint_t>& getElements() const;
 
+  /// Get the memory size of the elements of each type, including their arrays, in the order of getElements.
+  virtual const std::vector<size_t>& getMemorySizes() const;
+
+  /// Get the name of the type of the \e i-th value of getElements.
+  static const char * getElementName(uint_t i);
+
+  /// Get the memory size of each shape, by id. Objects shared by several shapes are counted with the first one.
+  virtual const pgl_hash_map<uint_t,size_t>& getShapeMemorySizes() const;
+
+  /// Get the statistics of the arrays of each class.
+  virtual const std::map<std::string,ArrayStatistics>& getArrayStatistics() const;
+
 
 
   /// @name Shape
@@ -348,7 +388,30 @@ public:
   std::vector<uint_t> __shape;
 
   /// memory size.
-  uint_t __memsize;
+  size_t __memsize;
+
+  /// memory size of the shared array elements.
+  size_t __sharedmemsize;
+
+  /// Returns whether \e object is visited for the first time.
+  bool visit(const void * object);
+
+  void addMemory(uint_t type, size_t size);
+
+  template<class A>
+  void addArray(uint_t type, const A& array);
+
+  /// addresses of the objects, arrays and buffers already counted in the memory size.
+  pgl_hash_set<size_t> __visited;
+
+  /// memory size by class.
+  std::vector<size_t> __memsizes;
+
+  /// memory size by shape id.
+  pgl_hash_map<uint_t,size_t> __shapememsizes;
+
+  /// statistics by array class.
+  std::map<std::string,ArrayStatistics> __arrays;
 
 };
 
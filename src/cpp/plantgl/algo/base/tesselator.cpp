@@ -71,9 +71,7 @@ using namespace std;
 
 #define GEOM_TESSELATOR_CHECK_CACHE(geom) \
 if(!geom->unique()){ \
-  Cache<ExplicitModelPtr>::Iterator _it = __cache.find(geom->getObjectId()); \
-  if (! (_it == __cache.end())) { \
-    __discretization = _it->second; \
+  if (findInCache(geom->getObjectId(), geom->getDeepModificationStamp())) { \
     return true; \
   }} else __discretization= ExplicitModelPtr();
 
@@ -81,7 +79,7 @@ if(!geom->unique()){ \
 #define GEOM_TESSELATOR_UPDATE_CACHE(geom) \
 if(!geom->unique()){ \
   if(geom->isNamed())__discretization->setName(geom->getName()); \
-  __cache.insert(geom->getObjectId(),__discretization); \
+  storeInCache(geom->getObjectId(), geom->getDeepModificationStamp()); \
 }
 
 
@@ -96,6 +94,12 @@ Tesselator::~Tesselator( )
 {
 }
 
+Discretizer * Tesselator::newWorker( ) const {
+  Tesselator * worker = new Tesselator();
+  worker->computeTexCoord(__computeTexCoord);
+  return worker;
+}
+
 TriangleSetPtr Tesselator::getTriangulation( ) const {
   return TriangleSetPtr(dynamic_pointer_cast<TriangleSet>(__discretization));
 }
@@ -397,10 +401,10 @@ bool Tesselator::process( FaceSet * faceSet ) {
   if (!faceSet->getNormalPerVertex() && faceSet->getNormalList()){
       Point3ArrayPtr _nml( new Point3Array(tr->getIndexList()->size()));
       Point3Array::iterator _it = _nml->begin();
-      Point3Array::const_iterator _it2 = faceSet->getNormalList()->begin();
+      Point3Array::const_iterator _it2 = const_array(*faceSet->getNormalList()).begin();
 
-      for (IndexArray::iterator _itInd = faceSet->getIndexList()->begin();
-           _itInd != faceSet->getIndexList()->end(); ++_itInd)
+      for (IndexArray::const_iterator _itInd = const_array(*faceSet->getIndexList()).begin();
+           _itInd != const_array(*faceSet->getIndexList()).end(); ++_itInd)
       {
           if(_itInd->size() >=3){
               for (uint_t i = 0 ; i < _itInd->size() - 2; ++i)
@@ -414,10 +418,10 @@ bool Tesselator::process( FaceSet * faceSet ) {
   if (!faceSet->getColorPerVertex() && faceSet->getColorList()){
       Color4ArrayPtr _cl( new Color4Array(tr->getIndexList()->size()));
       Color4Array::iterator _it = _cl->begin();
-      Color4Array::const_iterator _it2 = faceSet->getColorList()->begin();
+      Color4Array::const_iterator _it2 = const_array(*faceSet->getColorList()).begin();
 
-      for (IndexArray::iterator _itInd = faceSet->getIndexList()->begin();
-           _itInd != faceSet->getIndexList()->end(); ++_itInd)
+      for (IndexArray::const_iterator _itInd = const_array(*faceSet->getIndexList()).begin();
+           _itInd != const_array(*faceSet->getIndexList()).end(); ++_itInd)
       {
           if(_itInd->size() >=3){
             for (uint_t i = 0 ; i < _itInd->size() - 2; ++i)
@@ -573,8 +577,8 @@ bool Tesselator::process( QuadSet * quadSet ) {
   if (!quadSet->getNormalPerVertex() && quadSet->getNormalList()){
       Point3ArrayPtr _nml( new Point3Array(quadSet->getNormalList()->size()*2));
       Point3Array::iterator _it = _nml->begin();
-      for (Point3Array::const_iterator _it2 = quadSet->getNormalList()->begin();
-           _it2 != quadSet->getNormalList()->end(); ++_it2)
+      for (Point3Array::const_iterator _it2 = const_array(*quadSet->getNormalList()).begin();
+           _it2 != const_array(*quadSet->getNormalList()).end(); ++_it2)
       {
           *_it = *_it2; ++_it;
           *_it = *_it2; ++_it;
@@ -585,8 +589,8 @@ bool Tesselator::process( QuadSet * quadSet ) {
   if (!quadSet->getColorPerVertex() && quadSet->getColorList()){
       Color4ArrayPtr _cl( new Color4Array(quadSet->getColorList()->size()*2));
       Color4Array::iterator _it = _cl->begin();
-      for (Color4Array::const_iterator _it2 = quadSet->getColorList()->begin();
-           _it2 != quadSet->getColorList()->end(); ++_it2)
+      for (Color4Array::const_iterator _it2 = const_array(*quadSet->getColorList()).begin();
+           _it2 != const_array(*quadSet->getColorList()).end(); ++_it2)
       {
           *_it = *_it2; ++_it;
           *_it = *_it2; ++_it;
@@ -760,7 +764,7 @@ typedef CGAL::Random_points_in_square_2<Point_2, Creator>   Point_generator;
 bool PGL(is_simple_polygon)(Point2ArrayPtr contour){
 #ifdef PGL_WITH_CGAL
    Polygon_2    polygon;
-   for(Point2Array::const_iterator it = contour->begin(); it != contour->end(); ++it)
+   for(Point2Array::const_iterator it = const_array(*contour).begin(); it != const_array(*contour).end(); ++it)
         polygon.push_back(Point_2(it->x(), it->y()));
    return polygon.is_simple();
 #else
@@ -792,7 +796,7 @@ IndexArrayPtr PGL(polygonization)(Point2ArrayPtr contour, TriangulationMethod me
    Polygon_list partition_polys;
 
 
-   for(Point2Array::const_iterator it = contour->begin(); it != contour->end(); ++it)
+   for(Point2Array::const_iterator it = const_array(*contour).begin(); it != const_array(*contour).end(); ++it)
         polygon.push_back(Point_2(it->x(), it->y()));
 
    if (!polygon.is_simple()) {
@@ -840,7 +844,7 @@ IndexArrayPtr PGL(polygonization)(Point2ArrayPtr contour, TriangulationMethod me
    {
        Index ind;
        for(Polygon_2::Vertex_iterator polit = pollistit->vertices_begin(); polit != pollistit->vertices_end(); ++polit){
-            ind.push_back(std::distance(contour->begin(),std::find(contour->begin(),contour->end(),Vector2(polit->x(),polit->y()))));
+            ind.push_back(std::distance(const_array(*contour).begin(),std::find(const_array(*contour).begin(),const_array(*contour).end(),Vector2(polit->x(),polit->y()))));
        }
        iarray->push_back(ind);
    }
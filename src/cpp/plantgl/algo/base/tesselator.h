@@ -135,6 +135,10 @@ public:
 
   //@}
 
+protected:
+
+  virtual Discretizer * newWorker( ) const;
+
 };
 
 enum TriangulationMethod {
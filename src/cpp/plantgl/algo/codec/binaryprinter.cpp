@@ -43,6 +43,7 @@
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/tool/bfstream.h>
 #include <plantgl/tool/util_enviro.h>
+#include <plantgl/tool/util_profiler.h>
 
 
 #include "binaryprinter.h"
@@ -399,8 +400,7 @@ void BinaryPrinter::write(const Index4& val) {
 void BinaryPrinter::write(const Index& val) {
     uint_t _sizej = val.size();
     writeUint32(_sizej);
-    for(Index::const_iterator it = val.begin(); it != val.end(); ++it)
-        writeUint32(*it);
+    writeElements(val.begin(),val.end());
 };
 
 
@@ -560,6 +560,31 @@ void BinaryPrinter::writeReal(real_t var)
     }
 }
 
+/// write real_t values as one block
+void BinaryPrinter::writeReals(const real_t * values, size_t nb)
+{
+    if (nb == 0) return;
+    if (__double_precision == (sizeof(real_t) == sizeof(double))) {
+        __outputStream.writeBlock((const char *)values, sizeof(real_t), nb);
+    }
+    else if (__double_precision) {
+        std::vector<double> converted(values, values+nb);
+        __outputStream.writeBlock((const char *)&converted[0], sizeof(double), nb);
+    }
+    else {
+        std::vector<float> converted(values, values+nb);
+        __outputStream.writeBlock((const char *)&converted[0], sizeof(float), nb);
+    }
+}
+
+/// write uint32_t values as one block
+void BinaryPrinter::writeUint32s(const uint32_t * values, size_t nb)
+{ if (nb > 0) __outputStream.writeBlock((const char *)values, sizeof(uint32_t), nb); }
+
+/// write uchar_t values as one block
+void BinaryPrinter::writeUchars(const uchar_t * values, size_t nb)
+{ if (nb > 0) __outputStream.writeBlock((const char *)values, sizeof(uchar_t), nb); }
+
 /// write a string value from stream
 void BinaryPrinter::writeString(const std::string& var)
 { writeUint16(var.length()); if(var.length() != 0)__outputStream << var.c_str(); }
@@ -598,6 +623,7 @@ std::string BinaryPrinter::tobinarystring(ScenePtr scene, bool double_precision,
 
 
 bool BinaryPrinter::print(ScenePtr scene,const char * comment){
+    PGL_PROFILE_ZONE("BinaryPrinter::print");
     header(comment);
     StatisticComputer _sc;
     scene->apply(_sc);
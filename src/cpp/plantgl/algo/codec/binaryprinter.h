@@ -57,6 +57,7 @@
 #include <plantgl/tool/util_types.h>
 #include <plantgl/pgl_container.h>
 #include <vector>
+#include <type_traits>
 
 /* ----------------------------------------------------------------------- */
 
@@ -78,6 +79,59 @@ typedef RCPtr<Transform4> Transform4Ptr;
 
 #define TokReference std::string("Reference")
 
+/* ----------------------------------------------------------------------- */
+
+/// Number of elements of an array converted at once by the bulk array I/O.
+#define PGL_BINARY_BLOCK_SIZE 65536
+
+/**
+   \class BinaryBlock
+   \brief Describes how an element of an array is stored in a binary file
+   as \e dim contiguous scalars of type \e scalar_type. Arrays of such
+   elements are read and written as whole blocks. Elements with no
+   specialization (dim = 0) are read and written one by one.
+*/
+template<class T>
+struct BinaryBlock {
+  typedef T scalar_type;
+  static const size_t dim = 0;
+};
+
+template<>
+struct BinaryBlock<real_t> {
+  typedef real_t scalar_type;
+  static const size_t dim = 1;
+  static inline real_t& at(real_t& v, size_t) { return v; }
+  static inline const real_t& at(const real_t& v, size_t) { return v; }
+};
+
+template<>
+struct BinaryBlock<uint32_t> {
+  typedef uint32_t scalar_type;
+  static const size_t dim = 1;
+  static inline uint32_t& at(uint32_t& v, size_t) { return v; }
+  static inline const uint32_t& at(const uint32_t& v, size_t) { return v; }
+};
+
+#define PGL_BINARY_TUPLE_BLOCK(type,scalar,size) \
+template<> \
+struct BinaryBlock<type> { \
+  typedef scalar scalar_type; \
+  static const size_t dim = size; \
+  static inline scalar& at(type& v, size_t i) { return v.getAt(uchar_t(i)); } \
+  static inline const scalar& at(const type& v, size_t i) { return v.getAt(uchar_t(i)); } \
+};
+
+PGL_BINARY_TUPLE_BLOCK(Vector2,real_t,2)
+PGL_BINARY_TUPLE_BLOCK(Vector3,real_t,3)
+PGL_BINARY_TUPLE_BLOCK(Vector4,real_t,4)
+PGL_BINARY_TUPLE_BLOCK(Color3,uchar_t,3)
+PGL_BINARY_TUPLE_BLOCK(Color4,uchar_t,4)
+PGL_BINARY_TUPLE_BLOCK(Index3,uint32_t,3)
+PGL_BINARY_TUPLE_BLOCK(Index4,uint32_t,4)
+
+#undef PGL_BINARY_TUPLE_BLOCK
+
 
 /**
    \class TokenCode
@@ -348,13 +402,31 @@ public:
   void write(const Matrix3& var);
   void write(const Matrix4& var);
 
+  /// write \e nb real_t values stored contiguously in \e values as one block
+  void writeReals(const real_t * values, size_t nb);
+
+  /// write \e nb uint32_t values stored contiguously in \e values as one block
+  void writeUint32s(const uint32_t * values, size_t nb);
+
+  /// write \e nb uchar_t values stored contiguously in \e values as one block
+  void writeUchars(const uchar_t * values, size_t nb);
+
+  inline void writeScalars(const real_t * values, size_t nb) { writeReals(values,nb); }
+  inline void writeScalars(const uint32_t * values, size_t nb) { writeUint32s(values,nb); }
+  inline void writeScalars(const uchar_t * values, size_t nb) { writeUchars(values,nb); }
+
+  /// write the elements from \e beg to \e end. Elements described by BinaryBlock are written by blocks.
+  template<class Iterator>
+  void writeElements(Iterator beg, Iterator end){
+    typedef typename std::iterator_traits<Iterator>::value_type element_type;
+    writeElements(beg, end, std::integral_constant<bool,(BinaryBlock<element_type>::dim > 0)>());
+  }
+
   template<class Array>
   void writeArray(const Array& array){
     uint_t _sizei = array.size();
     writeUint32(_sizei);
-    for (typename Array::const_iterator it = array.begin(); it != array.end(); ++it) {
-      write(*it);
-    };
+    writeElements(array.begin(),array.end());
   }
 
   template<class Array>
@@ -370,9 +442,7 @@ public:
     uint_t _cols = array.getColumnNb();
     writeUint32( _rows );
     writeUint32( _cols );
-    for (typename Array2::const_iterator it = array.begin(); it != array.end(); ++it) {
-        write(*it);
-    };
+    writeElements(array.begin(),array.end());
   }
 
   template<class Array2>
@@ -385,6 +455,27 @@ protected:
   /// Return a Token Number for the string \e _string.
   void printType(const std::string& _string);
 
+  template<class Iterator>
+  void writeElements(Iterator beg, Iterator end, std::false_type){
+    for (Iterator it = beg; it != end; ++it) {
+      write(*it);
+    };
+  }
+
+  template<class Iterator>
+  void writeElements(Iterator beg, Iterator end, std::true_type){
+    typedef BinaryBlock<typename std::iterator_traits<Iterator>::value_type> Block;
+    std::vector<typename Block::scalar_type> buffer;
+    buffer.reserve(PGL_BINARY_BLOCK_SIZE * Block::dim);
+    for (Iterator it = beg; it != end; ) {
+      buffer.clear();
+      for (size_t nb = 0; it != end && nb < PGL_BINARY_BLOCK_SIZE; ++it, ++nb)
+        for (size_t i = 0; i < Block::dim; ++i)
+          buffer.push_back(Block::at(*it,i));
+      writeScalars(&buffer[0],buffer.size());
+    }
+  }
+
   /// Binary output stream.
   fostream __outputStream;
 
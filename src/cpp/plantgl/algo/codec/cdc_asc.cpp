@@ -49,6 +49,7 @@
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/math/util_vector.h>
 #include <plantgl/tool/util_progress.h>
+#include <plantgl/tool/util_profiler.h>
 #include <plantgl/tool/util_string.h>
 #include <plantgl/algo/base/discretizer.h>
 #include <fstream>
@@ -75,6 +76,7 @@ SceneFormatList AscCodec::formats() const {
 }
 
 ScenePtr AscCodec::read(const std::string &fname) {
+  PGL_PROFILE_ZONE("AscCodec::read");
   Point3ArrayPtr pts(new Point3Array());
   Color4ArrayPtr col(new Color4Array());
 
@@ -155,6 +157,7 @@ ScenePtr AscCodec::read(const std::string &fname) {
 }
 
 bool AscCodec::write(const std::string &fname, const ScenePtr &scene) {
+  PGL_PROFILE_ZONE("AscCodec::write");
   std::cout << "Write " << fname << std::endl;
   std::ofstream file(fname.c_str(), std::ofstream::out);
 
@@ -51,6 +51,7 @@
 #include <plantgl/tool/util_string.h>
 #include <plantgl/tool/errormsg.h>
 #include <plantgl/tool/timer.h>
+#include <plantgl/tool/util_profiler.h>
 
 #include <plantgl/scenegraph/core/sceneobject.h>
 #include <plantgl/scenegraph/core/smbtable.h>
@@ -140,6 +141,7 @@ SceneFormatList GeomCodec::formats() const
 
 ScenePtr GeomCodec::read(const std::string& fname)
 {
+  PGL_PROFILE_ZONE("GeomCodec::read");
   if(BinaryParser::isAGeomBinaryFile(fname)){
       BinaryParser _parser(*PglErrorStream::error);
       _parser.parse(fname);
@@ -168,6 +170,7 @@ ScenePtr GeomCodec::read(const std::string& fname)
 
 bool GeomCodec::write(const std::string& fname,const ScenePtr&  scene)
 {
+    PGL_PROFILE_ZONE("GeomCodec::write");
     std::string ext = get_suffix(fname);
     ext = toUpper(ext);
     if(ext == "BGEOM"){
@@ -204,6 +207,7 @@ SceneFormatList BGeomCodec::formats() const
 
 ScenePtr BGeomCodec::read(const std::string& fname)
 {
+  PGL_PROFILE_ZONE("BGeomCodec::read");
   if(BinaryParser::isAGeomBinaryFile(fname)){
       BinaryParser _parser(*PglErrorStream::error);
       _parser.parse(fname);
@@ -214,6 +218,7 @@ ScenePtr BGeomCodec::read(const std::string& fname)
 
 bool BGeomCodec::write(const std::string& fname,const ScenePtr& scene)
 {
+    PGL_PROFILE_ZONE("BGeomCodec::write");
     BinaryPrinter::print(scene,fname,"File Generated with PlantGL.");
     return true;
 }
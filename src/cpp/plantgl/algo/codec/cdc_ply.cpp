@@ -45,13 +45,154 @@
 #include <plantgl/scenegraph/geometry/pointset.h>
 #include <plantgl/scenegraph/geometry/faceset.h>
 #include <plantgl/tool/util_progress.h>
+#include <plantgl/tool/util_profiler.h>
+#include <plantgl/algo/base/parallelexecutor.h>
 #include "plyprinter.h"
 #include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
 #include <boost/bind.hpp>
-#include <boost/function.hpp>
 
 PGL_USING_NAMESPACE
 
+/* ----------------------------------------------------------------------- */
+
+/// Number of records decoded at once.
+#define PLY_RECORD_BLOCK_SIZE 65536
+
+/// Size of the read buffers.
+#define PLY_BUFFER_SIZE (1 << 24)
+
+/* ----------------------------------------------------------------------- */
+
+/// Buffered reader of the data of a binary ply file.
+class PlyCodec::BinaryReader {
+public:
+	BinaryReader(std::istream &stream, bool reverse) :
+		reverse(reverse), m_stream(stream), m_begin(0), m_end(0) {
+	}
+
+	/// Return a pointer on the next \e size bytes. It stays valid until the next call.
+	const char *take(std::size_t size) {
+		if (m_end - m_begin < size) {
+			std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+			m_end -= m_begin;
+			m_begin = 0;
+			if (m_buffer.size() < std::max<std::size_t>(size, PLY_BUFFER_SIZE)) {
+				m_buffer.resize(std::max<std::size_t>(size, PLY_BUFFER_SIZE));
+			}
+			m_stream.read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+			m_end += m_stream.gcount();
+			if (m_end < size) {
+				throw std::runtime_error("Truncated file");
+			}
+		}
+		const char *result = m_buffer.data() + m_begin;
+		m_begin += size;
+		return result;
+	}
+
+	const bool reverse;
+
+private:
+	std::istream &m_stream;
+	std::vector<char> m_buffer;
+	std::size_t m_begin;
+	std::size_t m_end;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// Buffered reader of the lines of an ascii ply file.
+class PlyCodec::AsciiReader {
+public:
+	AsciiReader(std::istream &stream) :
+		m_stream(stream), m_begin(0), m_end(0) {
+	}
+
+	/** Collect up to \e nblines non empty lines as null terminated strings.
+	    They stay valid until the next call. Return the number of lines found. */
+	std::size_t nextLines(std::size_t nblines, std::vector<const char *> &lines) {
+		lines.clear();
+		while (lines.size() < nblines) {
+			char *const begin = m_buffer.data() + m_begin;
+			char *const end = m_buffer.data() + m_end;
+			char *const eol = std::find(begin, end, '\n');
+
+			if (eol == end) {
+				if (!lines.empty()) {
+					// Refilling would move the lines already collected
+					break;
+				}
+				if (!refill()) {
+					// Last line without end of line
+					if (m_begin < m_end) {
+						m_buffer.resize(m_end + 1);
+						m_buffer[m_end] = '\0';
+						if (!isBlank(m_buffer.data() + m_begin)) {
+							lines.push_back(m_buffer.data() + m_begin);
+						}
+						m_begin = m_end;
+					}
+					break;
+				}
+				continue;
+			}
+
+			*eol = '\0';
+			if (!isBlank(begin)) {
+				lines.push_back(begin);
+			}
+			m_begin = eol + 1 - m_buffer.data();
+		}
+		return lines.size();
+	}
+
+private:
+	static bool isBlank(const char *line) {
+		for (; *line != '\0'; ++line) {
+			if (!std::isspace((unsigned char)*line)) return false;
+		}
+		return true;
+	}
+
+	bool refill() {
+		std::memmove(m_buffer.data(), m_buffer.data() + m_begin, m_end - m_begin);
+		m_end -= m_begin;
+		m_begin = 0;
+		if (m_buffer.size() < m_end + PLY_BUFFER_SIZE) {
+			m_buffer.resize(m_end + PLY_BUFFER_SIZE);
+		}
+		m_stream.read(m_buffer.data() + m_end, m_buffer.size() - m_end);
+		std::size_t const count = m_stream.gcount();
+		m_end += count;
+		return count > 0;
+	}
+
+	std::istream &m_stream;
+	std::vector<char> m_buffer;
+	std::size_t m_begin;
+	std::size_t m_end;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// Read the next number of an ascii line.
+static inline double nextAsciiValue(const char *&line)
+{
+	char *end;
+	double const value = std::strtod(line, &end);
+	if (end == line) {
+		throw std::runtime_error("Invalid value");
+	}
+	line = end;
+	return value;
+}
+
+/* ----------------------------------------------------------------------- */
+
 PlyCodec::PlyCodec() :
 	SceneCodec("PLY", ReadWrite),
 	m_reverseBytes(false)
@@ -60,21 +201,22 @@ PlyCodec::PlyCodec() :
 	m_fcodingTypes.push_back("binary_big_endian");
 	m_fcodingTypes.push_back("ascii");
 
-	m_propertiesTypes["float"] = float();
-	m_propertiesTypes["float32"] = float();
-	m_propertiesTypes["int"] = int();
-	m_propertiesTypes["int8"] = int8_t();
-	m_propertiesTypes["int16"] = int16_t();
-	m_propertiesTypes["int32"] = int32_t();
-	m_propertiesTypes["uint"] = uint_t();
-	m_propertiesTypes["uint8"] = uint8_t();
-	m_propertiesTypes["uint16"] = uint16_t();
-	m_propertiesTypes["uint32"] = uint32_t();
-	m_propertiesTypes["uchar"] = uchar_t();
-	m_propertiesTypes["char"] = char();
-	m_propertiesTypes["short"] = short();
-	m_propertiesTypes["ushort"] = uint16_t();
-	m_propertiesTypes["double"] = double();
+	m_propertiesTypes["float"] = eFloat32;
+	m_propertiesTypes["float32"] = eFloat32;
+	m_propertiesTypes["float64"] = eFloat64;
+	m_propertiesTypes["int"] = eInt32;
+	m_propertiesTypes["int8"] = eInt8;
+	m_propertiesTypes["int16"] = eInt16;
+	m_propertiesTypes["int32"] = eInt32;
+	m_propertiesTypes["uint"] = eUint32;
+	m_propertiesTypes["uint8"] = eUint8;
+	m_propertiesTypes["uint16"] = eUint16;
+	m_propertiesTypes["uint32"] = eUint32;
+	m_propertiesTypes["uchar"] = eUint8;
+	m_propertiesTypes["char"] = eInt8;
+	m_propertiesTypes["short"] = eInt16;
+	m_propertiesTypes["ushort"] = eUint16;
+	m_propertiesTypes["double"] = eFloat64;
 
 	m_knownColorTypes.push_back("red");
 	m_knownColorTypes.push_back("green");
@@ -111,187 +253,388 @@ ScenePtr PlyCodec::read(std::string const &fname)
 
 ScenePtr PlyCodec::readScene(std::string const &fname)
 {
+	PGL_PROFILE_ZONE("PlyCodec::readScene");
 	std::ifstream file = openFile(fname);
 
 	FormatInfos const format = parseFormatInfos(file);
 
 	m_reverseBytes = isBytesReverseNeeded(format.coding);
 
-	std::map<std::string, SpecElement> specs = parseHeader(file, format);
+	SpecList const specs = parseHeader(file, format);
 
 	m_colorProps = parseColorProps(specs);
 
 	// Data size
-	std::size_t const vertexSize = specs.find("vertex") != specs.end() ? specs["vertex"].number : 0;
+	std::size_t vertexSize = 0;
+	std::size_t faceSize = 0;
+
+	for (SpecList::const_iterator it = specs.begin(); it != specs.end(); ++it) {
+		if (it->name == "vertex") vertexSize = it->number;
+		else if (it->name == "face") faceSize = it->number;
+	}
+
 	std::size_t const colorSize = !m_colorProps.empty() ? vertexSize : 0;
-	std::size_t const faceSize = specs.find("face") != specs.end() ? specs["face"].number : 0;
 
 	// Data
 	Point3ArrayPtr const points = new Point3Array(vertexSize);
 	Color4ArrayPtr const colors = new Color4Array(colorSize);
 	IndexArrayPtr const faces = new IndexArray(faceSize);
 
-	for (std::map<std::string, SpecElement>::const_iterator it = specs.begin(); it != specs.end(); ++it) {
-		// Parsing progression
-		ProgressStatus status(it->second.number, "Loading PLY file.", 0.25f);
+	BinaryReader binary(file, m_reverseBytes);
+	AsciiReader ascii(file);
+	bool const isAscii = (format.coding == "ascii");
 
-		for (std::size_t i = 0; i < it->second.number; ++i, ++status) {
-			// The element being processed
-			pgl_hash_map_string<std::vector<propertyType> > element;
+	// Elements are stored in the order of the header
+	for (SpecList::const_iterator it = specs.begin(); it != specs.end(); ++it) {
+		ElementLayout const layout = compileLayout(*it);
 
-			if (format.coding == "ascii") {
-				// ASCII
-				parseAsciiValue(file, it, element);
-			}
-			else {
-				// Binary
-				parseBinaryValue(file, it, element);
-			}
-
-			if (it->first == "vertex") {
-				// Vertex
-				parseVertex(i, element, points, colors);
-			}
-			else if (it->first == "face") {
-				// Face
-				parseFace(i, element, faces);
-			}
+		if (it->name == "vertex") {
+			readVertices(isAscii ? NULL : &binary, isAscii ? &ascii : NULL, layout, 0, layout.number, points, colors, 0);
+		}
+		else if (it->name == "face") {
+			readFaces(isAscii ? NULL : &binary, isAscii ? &ascii : NULL, layout, faces);
+		}
+		else {
+			skipElement(isAscii ? NULL : &binary, isAscii ? &ascii : NULL, layout);
 		}
 	}
 
 	return createScene(points, colors, faces);
 }
 
-void PlyCodec::parseAsciiValue(std::ifstream& file, std::map<std::string, SpecElement>::const_iterator const &it, pgl_hash_map_string<std::vector<propertyType> > &element)
+void PlyCodec::readPointChunks(std::string const &fname, PointChunkCallback callback, std::size_t chunksize)
 {
-	std::vector<std::string> const lineValues = split(readNextLine(file));
-	std::size_t itv = 0;
-	
-	for (std::vector<PropertyElement>::const_iterator propIt = it->second.properties.begin(); propIt != it->second.properties.end(); ++propIt) {
-		// We check if the property type exists
-		pgl_hash_map_string<propertyType>::const_iterator const typeIt = m_propertiesTypes.find(propIt->type);
+	PGL_PROFILE_ZONE("PlyCodec::readPointChunks");
+	std::ifstream file = openFile(fname);
 
-		if (typeIt == m_propertiesTypes.end()) {
-			// Unknown property
-			continue;
-		}
+	FormatInfos const format = parseFormatInfos(file);
 
-		// Here we insert the new vector
-		std::pair<pgl_hash_map_string<std::vector<propertyType> >::iterator, bool> const vect = element.insert(std::pair<std::string, std::vector<propertyType> >(propIt->name, std::vector<propertyType>()));
+	m_reverseBytes = isBytesReverseNeeded(format.coding);
 
-		// A reference to the vector containing the values
-		std::vector<propertyType> &values = vect.first->second;
+	SpecList const specs = parseHeader(file, format);
 
-		propertyType type = typeIt->second;
+	m_colorProps = parseColorProps(specs);
 
-		if (propIt->isList) {
-			std::size_t const propCount = toNumber<std::size_t>(lineValues[itv++]);
+	BinaryReader binary(file, m_reverseBytes);
+	AsciiReader ascii(file);
+	bool const isAscii = (format.coding == "ascii");
 
-			for (std::size_t i = 0; i < propCount; ++i) {
-				ReadVisitor visitor(lineValues[itv++]); 
-				boost::apply_visitor(visitor)(type);
-				
-				values.push_back(visitor.get_value());
-			}
+	if (chunksize == 0) chunksize = 1;
+
+	for (SpecList::const_iterator it = specs.begin(); it != specs.end(); ++it) {
+		ElementLayout const layout = compileLayout(*it);
+
+		if (it->name != "vertex") {
+			skipElement(isAscii ? NULL : &binary, isAscii ? &ascii : NULL, layout);
+			continue;
 		}
-		else {
-			ReadVisitor visitor(lineValues[itv++]);
-			boost::apply_visitor(visitor)(type);
-			
-			values.push_back(visitor.get_value());
+
+		for (std::size_t begin = 0; begin < layout.number; begin += chunksize) {
+			std::size_t const end = std::min(begin + chunksize, layout.number);
+
+			Point3ArrayPtr const points = new Point3Array(end - begin);
+			Color4ArrayPtr const colors = new Color4Array(m_colorProps.empty() ? 0 : end - begin);
+
+			readVertices(isAscii ? NULL : &binary, isAscii ? &ascii : NULL, layout, begin, end, points, colors, 0);
+
+			callback(points, colors, begin);
 		}
+
+		// Following elements are not needed
+		return;
 	}
 }
 
-void PlyCodec::parseBinaryValue(std::ifstream& file, std::map<std::string, SpecElement>::const_iterator const &it, pgl_hash_map_string<std::vector<propertyType> > &element)
+/* ----------------------------------------------------------------------- */
+
+std::size_t PlyCodec::scalarSize(ScalarType type)
 {
-	for (std::vector<PropertyElement>::const_iterator propIt = it->second.properties.begin(); propIt != it->second.properties.end(); ++propIt) {
-		// We check if the property type exists
-		pgl_hash_map_string<propertyType>::const_iterator const typeIt = m_propertiesTypes.find(propIt->type);
+	switch (type) {
+		case eInt8: case eUint8: return 1;
+		case eInt16: case eUint16: return 2;
+		case eInt32: case eUint32: case eFloat32: return 4;
+		case eFloat64: return 8;
+	}
+	return 0;
+}
 
-		if (typeIt == m_propertiesTypes.end()) {
-			// Unknown property
-			continue;
-		}
+template<class T>
+static inline T decodeScalar(const char *data, bool reverse)
+{
+	T value;
+	if (reverse) {
+		flipBytes(data, (char *)&value, sizeof(T));
+	}
+	else {
+		std::memcpy(&value, data, sizeof(T));
+	}
+	return value;
+}
 
-		if (propIt->isList) {
-			// Here we insert the new vector
-			std::pair<pgl_hash_map_string<std::vector<propertyType> >::iterator, bool> const vect = element.insert(std::pair<std::string, std::vector<propertyType> >(propIt->name, std::vector<propertyType>()));
+double PlyCodec::scalarValue(const char *data, ScalarType type, bool reverse)
+{
+	switch (type) {
+		case eInt8: return *(const int8_t *)data;
+		case eUint8: return *(const uint8_t *)data;
+		case eInt16: return decodeScalar<int16_t>(data, reverse);
+		case eUint16: return decodeScalar<uint16_t>(data, reverse);
+		case eInt32: return decodeScalar<int32_t>(data, reverse);
+		case eUint32: return decodeScalar<uint32_t>(data, reverse);
+		case eFloat32: return decodeScalar<float>(data, reverse);
+		case eFloat64: return decodeScalar<double>(data, reverse);
+	}
+	return 0;
+}
 
-			// A reference to the vector containing the values
-			std::vector<propertyType>& values = vect.first->second;
+PlyCodec::ElementLayout PlyCodec::compileLayout(SpecElement const &spec) const
+{
+	ElementLayout layout;
+
+	layout.name = spec.name;
+	layout.number = spec.number;
+	layout.recordSize = 0;
+
+	bool fixedSize = true;
 
-			propertyType const sizeType = m_propertiesTypes[propIt->sizetype];
-			GetVisitor<size_t> visitor;
-			
-			propertyType const tmp = readNextValue(file, sizeType);
-			tmp.apply_visitor(visitor);
+	for (std::vector<PropertyElement>::const_iterator propIt = spec.properties.begin(); propIt != spec.properties.end(); ++propIt) {
+		PropertyLayout property;
 
-			std::size_t const propCount = visitor.get_value();
+		property.isList = propIt->isList;
+		property.type = m_propertiesTypes.find(propIt->type)->second;
+		property.sizetype = propIt->isList ? m_propertiesTypes.find(propIt->sizetype)->second : property.type;
+		property.offset = layout.recordSize;
+		property.target = eIgnored;
+
+		if (spec.name == "vertex" && !propIt->isList) {
+			if (propIt->name == "x") property.target = eX;
+			else if (propIt->name == "y") property.target = eY;
+			else if (propIt->name == "z") property.target = eZ;
+			else {
+				std::vector<std::string>::const_iterator const colorIt = std::find(m_colorProps.begin(), m_colorProps.end(), propIt->name);
+				std::size_t const channel = std::distance(m_colorProps.begin(), colorIt);
 
-			for (std::size_t i = 0; i < propCount; ++i) {
-				values.push_back(readNextValue(file, typeIt->second));
+				if (colorIt != m_colorProps.end() && (channel < 3 || *colorIt == "alpha")) {
+					property.target = PropertyTarget(eColor0 + channel);
+				}
 			}
 		}
+		else if (spec.name == "face" && propIt->isList && (propIt->name == "vertex_indices" || propIt->name == "vertex_index")) {
+			property.target = eFaceIndices;
+		}
+
+		if (propIt->isList) {
+			fixedSize = false;
+		}
 		else {
-			element.insert(std::pair<std::string, std::vector<propertyType> >(propIt->name, std::vector<propertyType>(1, readNextValue(file, typeIt->second))));
+			layout.recordSize += scalarSize(property.type);
 		}
-	}
-}
 
-void PlyCodec::parseVertex(std::size_t i, pgl_hash_map_string<std::vector<propertyType> > &element, Point3ArrayPtr const points, Color4ArrayPtr const colors)
-{
-	GetVisitor<float> visitor;
+		layout.properties.push_back(property);
+	}
 
-	element["x"][0].apply_visitor(visitor);
-	float const x = visitor.get_value();
-	
-	element["y"][0].apply_visitor(visitor);
-	float const y = visitor.get_value();
-	
-	element["z"][0].apply_visitor(visitor);
-	float const z = visitor.get_value();
-	
-	points->setAt(i, Vector3(x, y, z));
-	
-	if (m_colorProps.empty()) {
-		return;
+	if (!fixedSize) {
+		layout.recordSize = 0;
 	}
 
+	return layout;
+}
+
+/* ----------------------------------------------------------------------- */
+
+/// Store the decoded values of a vertex.
+struct PlyVertexValues {
+	Vector3 point;
 	uchar_t rgba[4];
-	std::size_t index = 0;
 
-	for (std::vector<std::string>::const_iterator cni = m_colorProps.begin(); cni != m_colorProps.end(); ++cni, ++index) {
-		GetVisitor<uchar_t> v;
-		element[*cni][0].apply_visitor(v);
-		rgba[index] = v.get_value();
+	PlyVertexValues() : point(0, 0, 0) {
+		rgba[0] = rgba[1] = rgba[2] = rgba[3] = 0;
+	}
+};
+
+#define PLY_SET_VERTEX_VALUE(values,target,value) \
+	switch (target) { \
+		case eX: values.point.x() = real_t(value); break; \
+		case eY: values.point.y() = real_t(value); break; \
+		case eZ: values.point.z() = real_t(value); break; \
+		case eColor0: case eColor1: case eColor2: \
+			values.rgba[target - eColor0] = uchar_t(value); break; \
+		case eColor3: \
+			values.rgba[3] = uchar_t(255 - uchar_t(value)); break; \
+		default: break; \
 	}
 
-	if (m_colorProps.size() >= 4 && m_colorProps[3] == "alpha") {
-		rgba[3] = 255 - rgba[3];
+void PlyCodec::readVertices(BinaryReader *binary, AsciiReader *ascii, ElementLayout const &layout, std::size_t begin, std::size_t end,
+                            Point3ArrayPtr points, Color4ArrayPtr colors, std::size_t offset) const
+{
+	bool const withColors = !colors->empty();
+	ProgressStatus status(end - begin, "Loading PLY vertices.", 0.25f);
+
+	if (binary && layout.recordSize > 0) {
+		// Fixed size records: decode blocks of records in parallel
+		bool const reverse = binary->reverse;
+		for (std::size_t i = begin; i < end; i += PLY_RECORD_BLOCK_SIZE) {
+			std::size_t const nb = std::min<std::size_t>(PLY_RECORD_BLOCK_SIZE, end - i);
+			const char *const data = binary->take(nb * layout.recordSize);
+			std::size_t const first = offset + i - begin;
+
+			ParallelExecutor::get().parallel_for_each(0, nb, [&](std::size_t j) {
+				const char *const record = data + j * layout.recordSize;
+				PlyVertexValues values;
+				for (std::vector<PropertyLayout>::const_iterator propIt = layout.properties.begin(); propIt != layout.properties.end(); ++propIt) {
+					if (propIt->target != eIgnored) {
+						double const value = scalarValue(record + propIt->offset, propIt->type, reverse);
+						PLY_SET_VERTEX_VALUE(values, propIt->target, value)
+					}
+				}
+				points->setAt(first + j, values.point);
+				if (withColors) colors->setAt(first + j, Color4(values.rgba[0], values.rgba[1], values.rgba[2], values.rgba[3]));
+			});
+			status.increment(nb);
+		}
+	}
+	else if (binary) {
+		// Variable size records
+		for (std::size_t i = begin; i < end; ++i, ++status) {
+			PlyVertexValues values;
+			for (std::vector<PropertyLayout>::const_iterator propIt = layout.properties.begin(); propIt != layout.properties.end(); ++propIt) {
+				if (propIt->isList) {
+					std::size_t const count = std::size_t(scalarValue(binary->take(scalarSize(propIt->sizetype)), propIt->sizetype, binary->reverse));
+					binary->take(count * scalarSize(propIt->type));
+				}
+				else {
+					double const value = scalarValue(binary->take(scalarSize(propIt->type)), propIt->type, binary->reverse);
+					PLY_SET_VERTEX_VALUE(values, propIt->target, value)
+				}
+			}
+			points->setAt(offset + i - begin, values.point);
+			if (withColors) colors->setAt(offset + i - begin, Color4(values.rgba[0], values.rgba[1], values.rgba[2], values.rgba[3]));
+		}
 	}
 	else {
-		rgba[3] = 0;
+		// Ascii: one record per line, parsed in parallel
+		std::vector<const char *> lines;
+		for (std::size_t i = begin; i < end; ) {
+			std::size_t const nb = ascii->nextLines(end - i, lines);
+			if (nb == 0) {
+				throw std::runtime_error("Truncated file");
+			}
+			std::size_t const first = offset + i - begin;
+
+			ParallelExecutor::get().parallel_for_each(0, nb, [&](std::size_t j) {
+				const char *line = lines[j];
+				PlyVertexValues values;
+				for (std::vector<PropertyLayout>::const_iterator propIt = layout.properties.begin(); propIt != layout.properties.end(); ++propIt) {
+					if (propIt->isList) {
+						std::size_t const count = std::size_t(nextAsciiValue(line));
+						for (std::size_t k = 0; k < count; ++k) nextAsciiValue(line);
+					}
+					else {
+						double const value = nextAsciiValue(line);
+						PLY_SET_VERTEX_VALUE(values, propIt->target, value)
+					}
+				}
+				points->setAt(first + j, values.point);
+				if (withColors) colors->setAt(first + j, Color4(values.rgba[0], values.rgba[1], values.rgba[2], values.rgba[3]));
+			});
+			i += nb;
+			status.increment(nb);
+		}
 	}
+}
 
-	colors->setAt(i, Color4(rgba));
+void PlyCodec::readFaces(BinaryReader *binary, AsciiReader *ascii, ElementLayout const &layout, IndexArrayPtr faces) const
+{
+	ProgressStatus status(layout.number, "Loading PLY faces.", 0.25f);
+
+	if (binary) {
+		// Records have a variable size and are decoded sequentially
+		for (std::size_t i = 0; i < layout.number; ++i, ++status) {
+			for (std::vector<PropertyLayout>::const_iterator propIt = layout.properties.begin(); propIt != layout.properties.end(); ++propIt) {
+				if (!propIt->isList) {
+					binary->take(scalarSize(propIt->type));
+					continue;
+				}
+				std::size_t const count = std::size_t(scalarValue(binary->take(scalarSize(propIt->sizetype)), propIt->sizetype, binary->reverse));
+				std::size_t const size = scalarSize(propIt->type);
+				const char *const data = binary->take(count * size);
+				if (propIt->target == eFaceIndices) {
+					Index index(count);
+					for (std::size_t k = 0; k < count; ++k) {
+						index[k] = uint_t(scalarValue(data + k * size, propIt->type, binary->reverse));
+					}
+					faces->setAt(i, index);
+				}
+			}
+		}
+	}
+	else {
+		std::vector<const char *> lines;
+		for (std::size_t i = 0; i < layout.number; ) {
+			std::size_t const nb = ascii->nextLines(layout.number - i, lines);
+			if (nb == 0) {
+				throw std::runtime_error("Truncated file");
+			}
+
+			ParallelExecutor::get().parallel_for_each(0, nb, [&](std::size_t j) {
+				const char *line = lines[j];
+				for (std::vector<PropertyLayout>::const_iterator propIt = layout.properties.begin(); propIt != layout.properties.end(); ++propIt) {
+					if (!propIt->isList) {
+						nextAsciiValue(line);
+						continue;
+					}
+					std::size_t const count = std::size_t(nextAsciiValue(line));
+					if (propIt->target == eFaceIndices) {
+						Index index(count);
+						for (std::size_t k = 0; k < count; ++k) {
+							index[k] = uint_t(nextAsciiValue(line));
+						}
+						faces->setAt(i + j, index);
+					}
+					else {
+						for (std::size_t k = 0; k < count; ++k) nextAsciiValue(line);
+					}
+				}
+			});
+			i += nb;
+			status.increment(nb);
+		}
+	}
 }
 
-void PlyCodec::parseFace(std::size_t i, pgl_hash_map_string<std::vector<propertyType> > const &element, IndexArrayPtr const faces)
+void PlyCodec::skipElement(BinaryReader *binary, AsciiReader *ascii, ElementLayout const &layout) const
 {
-	pgl_hash_map_string<std::vector<propertyType> >::const_iterator it = element.find("vertex_indices");
-	
-	GetVisitor<uint_t> visitor;
-	Index index;
-	
-	for (std::vector<propertyType>::const_iterator v = it->second.begin(); v != it->second.end(); ++v) {
-		v->apply_visitor(visitor);
-		index.push_back(visitor.get_value());
+	if (binary && layout.recordSize > 0) {
+		for (std::size_t i = 0; i < layout.number; i += PLY_RECORD_BLOCK_SIZE) {
+			binary->take(std::min<std::size_t>(PLY_RECORD_BLOCK_SIZE, layout.number - i) * layout.recordSize);
+		}
+	}
+	else if (binary) {
+		for (std::size_t i = 0; i < layout.number; ++i) {
+			for (std::vector<PropertyLayout>::const_iterator propIt = layout.properties.begin(); propIt != layout.properties.end(); ++propIt) {
+				if (propIt->isList) {
+					std::size_t const count = std::size_t(scalarValue(binary->take(scalarSize(propIt->sizetype)), propIt->sizetype, binary->reverse));
+					binary->take(count * scalarSize(propIt->type));
+				}
+				else {
+					binary->take(scalarSize(propIt->type));
+				}
+			}
+		}
+	}
+	else {
+		std::vector<const char *> lines;
+		for (std::size_t i = 0; i < layout.number; ) {
+			std::size_t const nb = ascii->nextLines(layout.number - i, lines);
+			if (nb == 0) {
+				throw std::runtime_error("Truncated file");
+			}
+			i += nb;
+		}
 	}
-	
-	faces->setAt(i, index);
 }
 
+/* ----------------------------------------------------------------------- */
+
 std::ifstream PlyCodec::openFile(std::string const& path) const
 {
 	std::ifstream file(path.c_str(), std::ios::binary);
@@ -334,39 +677,45 @@ PlyCodec::FormatInfos PlyCodec::parseFormatInfos(std::ifstream &file) const
 	return infos;
 }
 
-std::map<std::string, PlyCodec::SpecElement> PlyCodec::parseHeader(std::ifstream &file, FormatInfos const &format) const
+PlyCodec::SpecList PlyCodec::parseHeader(std::ifstream &file, FormatInfos const &format) const
 {
-	std::map<std::string, SpecElement> specs;
-
-	std::string lastSpecName;
+	SpecList specs;
 
 	for (std::string line = readNextLine(file); line != "end_header" && file.good(); line = readNextLine(file)) {
 		if (line.find("element") == 0) {
-			lastSpecName = parseHeaderElement(specs, line);
+			parseHeaderElement(specs, line);
 		}
 		else if (line.find("property") == 0) {
-			parseHeaderProperty(specs, line, lastSpecName);
+			parseHeaderProperty(specs, line);
 		}
 	}
 
 	return specs;
 }
 
-std::string PlyCodec::parseHeaderElement(std::map<std::string, SpecElement> &specs, std::string const& line) const
+void PlyCodec::parseHeaderElement(SpecList &specs, std::string const& line) const
 {
 	std::vector<std::string> const elements = split(line);
 
+	if (elements.size() < 3) {
+		throw std::runtime_error("Invalid header");
+	}
+
 	std::string const &name = elements[1];
 	std::string const &number = elements[2];
 
-	specs[name] = SpecElement(toNumber<std::size_t>(number));
-	return name;
+	specs.push_back(SpecElement(name, toNumber<std::size_t>(number)));
 }
 
-void PlyCodec::parseHeaderProperty(std::map<std::string, SpecElement> &specs, std::string const& line, std::string const& lastSpecName) const
+void PlyCodec::parseHeaderProperty(SpecList &specs, std::string const& line) const
 {
 	std::vector<std::string> const properties = split(line);
 
+	if (specs.empty()) {
+		// Property before any element
+		throw std::runtime_error("Invalid header");
+	}
+
 	if (properties.size() == 3) {
 		std::string const &type = properties[1];
 		std::string const &name = properties[2];
@@ -376,7 +725,7 @@ void PlyCodec::parseHeaderProperty(std::map<std::string, SpecElement> &specs, st
 			throw std::runtime_error("Invalid header");
 		}
 		
-		specs[lastSpecName].properties.push_back(PropertyElement(name, type));
+		specs.back().properties.push_back(PropertyElement(name, type));
 	}
 	else if (properties.size() == 5) {
 		std::string const &sizeType = properties[2];
@@ -388,20 +737,20 @@ void PlyCodec::parseHeaderProperty(std::map<std::string, SpecElement> &specs, st
 			throw std::runtime_error("Invalid header");
 		}
 
-		specs[lastSpecName].properties.push_back(PropertyElement(name, sizeType, type));
+		specs.back().properties.push_back(PropertyElement(name, sizeType, type));
 	}
 }
 
-std::vector<std::string> PlyCodec::parseColorProps(std::map<std::string, SpecElement> const& specs) const
+std::vector<std::string> PlyCodec::parseColorProps(SpecList const& specs) const
 {
 	std::vector<std::string> colorProps;
 
-	std::map<std::string, SpecElement>::const_iterator const it = specs.find("vertex");
+	for (SpecList::const_iterator it = specs.begin(); it != specs.end(); ++it) {
+		if (it->name != "vertex") continue;
 
-	if (it != specs.end()) {
-		SpecElement const &vertex = it->second;
+		SpecElement const &vertex = *it;
 
-		for (std::size_t i = 2; i < vertex.properties.size(); ++i) {
+		for (std::size_t i = 0; i < vertex.properties.size(); ++i) {
 			if (std::find(m_knownColorTypes.begin(), m_knownColorTypes.end(), vertex.properties[i].name) != m_knownColorTypes.end()) {
 				colorProps.push_back(vertex.properties[i].name);
 			}
@@ -458,6 +807,7 @@ ScenePtr PlyCodec::createScene(Point3ArrayPtr points, Color4ArrayPtr colors, Ind
 
 bool PlyCodec::write(std::string const &fname, ScenePtr const &scene)
 {
+	PGL_PROFILE_ZONE("PlyCodec::write");
 	return PlyPrinter::print(scene, fname, NULL, PlyPrinter::ply_binary_little_endian);
 }
 
@@ -474,37 +824,6 @@ std::string PlyCodec::readNextLine(std::ifstream &file) const
 	return strip(line);
 }
 
-PlyCodec::propertyType PlyCodec::readNextValue(std::ifstream &file, propertyType const &type)
-{
-	boost::apply_visitor(sizeVisitor)(type);
-	
-	std::size_t const size = sizeVisitor.get_size();
-	// Total size: source + destination
-	std::size_t const totalSize = size * 2;
-
-	if (totalSize > m_buffer.size()) {
-		// If required, we resize the buffer
-		m_buffer.resize(totalSize);
-	}
-
-	char *const buffer = &m_buffer[0];
-
-	file.read(buffer, size);
-
-	if (m_reverseBytes) {
-		// Switch endianness
-		flipBytes(buffer, buffer + size, size);
-	}
-	else {
-		std::memcpy(buffer + size, buffer, size);
-	}
-
-	ReinterpretVisitor const visitor(buffer + size);
-	boost::apply_visitor(visitor)(type);
-	
-	return visitor.get_res();
-}
-
 bool PlyCodec::colorPropsSortFunction(std::string const &c1, std::string const &c2) const
 {
 	std::size_t const indexc1 = std::distance(m_knownColorTypes.begin(), std::find(m_knownColorTypes.begin(), m_knownColorTypes.end(), c1));
@@ -47,7 +47,8 @@
 #include <iostream>
 #include <fstream>
 #include <map>
-#include <boost/variant.hpp>
+#include <boost/function.hpp>
+#include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/colorarray.h>
 #include <plantgl/scenegraph/container/indexarray.h>
 #include <plantgl/tool/util_hashmap.h>
@@ -59,87 +60,18 @@ PGL_BEGIN_NAMESPACE
 /* ----------------------------------------------------------------------- */
 
   class CODEC_API PlyCodec : public SceneCodec {
-    typedef boost::variant<float, int, uint_t, char, uchar_t, short, uint16_t, double> propertyType;
 
-    struct SizeVisitor : public boost::static_visitor<> {
-      SizeVisitor()
-              : size(0) {
-      }
-
-      template<typename T>
-      void operator()(T &x) const {
-        this->size = sizeof(x);
-      }
-
-      std::size_t get_size() const {
-        return size;
-      }
-
-    private:
-      mutable std::size_t size;
-    };
-
-    struct ReadVisitor : public boost::static_visitor<> {
-      ReadVisitor(const std::string &str)
-              : str(str) {
-      }
-
-      template<typename T>
-      void operator()(T &x) const {
-        this->value = toNumber<T>(this->str);
-      }
-
-      propertyType get_value() const {
-        return value;
-      }
-
-    private:
-      mutable propertyType value;
-      const std::string str;
-    };
-
-    struct ReinterpretVisitor : public boost::static_visitor<> {
-      ReinterpretVisitor(const char *value)
-              : value(value) {
-      }
-
-      template<typename T>
-      void operator()(T &) const {
-        res = *(T *) (this->value);
-      }
-
-      propertyType get_res() const {
-        return res;
-      }
-
-    private:
-      mutable propertyType res;
-      const char *value;
-    };
-
-    template<typename U>
-    struct GetVisitor : public boost::static_visitor<> {
-      GetVisitor() {
-      }
-
-      template<typename T>
-      void operator()(T &x) const {
-        value = (U) x;
-      }
+    /// The scalar types of the properties of a ply file.
+    enum ScalarType { eInt8, eUint8, eInt16, eUint16, eInt32, eUint32, eFloat32, eFloat64 };
 
-      U get_value() const {
-        return value;
-      }
-
-    private:
-      mutable U value;
-    };
+    /// What a property is used for when building the scene.
+    enum PropertyTarget { eIgnored, eX, eY, eZ, eColor0, eColor1, eColor2, eColor3, eFaceIndices };
 
     struct PropertyElement {
-      const bool isList;
-      const std::string name;
-      const std::string type;
-      const std::string sizetype;
+      bool isList;
+      std::string name;
+      std::string type;
+      std::string sizetype;
 
       PropertyElement(const std::string &name, const std::string &type)
               : isList(false), name(name), type(type) {
@@ -148,37 +80,43 @@ PGL_BEGIN_NAMESPACE
       PropertyElement(const std::string &name, const std::string &sizetype, const std::string &type)
               : isList(true), name(name), type(type), sizetype(sizetype) {
       }
-
-      PropertyElement(const PropertyElement &propertyElement)
-              : isList(propertyElement.isList), name(propertyElement.name), type(propertyElement.type), sizetype(propertyElement.sizetype) {
-      }
-
-      PropertyElement &operator=(const PropertyElement &propertyElement) {
-        return *this;
-      }
     };
 
     struct SpecElement {
+      std::string name;
       std::size_t number;
       std::vector<PropertyElement> properties;
 
-      SpecElement(const std::size_t &number = 0)
-              : number(number) {
-      }
-
-      SpecElement(const SpecElement &specElement)
-              : number(specElement.number), properties(specElement.properties) {
+      SpecElement(const std::string &name = "", const std::size_t &number = 0)
+              : name(name), number(number) {
       }
+    };
 
-      SpecElement &operator=(const SpecElement &specElement) {
-        this->properties = specElement.properties;
-        this->number = specElement.number;
+    /// A property compiled from the header: its types, its offset in fixed size records and its target.
+    struct PropertyLayout {
+      bool isList;
+      ScalarType type;
+      ScalarType sizetype;
+      std::size_t offset;
+      PropertyTarget target;
+    };
 
-        return *this;
-      }
+    /// An element compiled from the header. recordSize is 0 if records have a variable size (list properties).
+    struct ElementLayout {
+      std::string name;
+      std::size_t number;
+      std::size_t recordSize;
+      std::vector<PropertyLayout> properties;
     };
 
+    class BinaryReader;
+    class AsciiReader;
+
   public:
+    /** Function called on each chunk of vertices of a point cloud by readPointChunks:
+        the positions, the colors (empty if the file has none) and the index of the first vertex. */
+    typedef boost::function<void(const Point3ArrayPtr&, const Color4ArrayPtr&, std::size_t)> PointChunkCallback;
+
     PlyCodec();
 
     virtual SceneFormatList formats() const;
@@ -187,6 +125,10 @@ PGL_BEGIN_NAMESPACE
 
     virtual bool write(const std::string &fname, const ScenePtr &scene);
 
+    /** Stream the vertices of the ply file \e fname to \e callback by chunks of \e chunksize
+        vertices, without building a Scene. Other elements are skipped. Throws on invalid files. */
+    void readPointChunks(const std::string &fname, PointChunkCallback callback, std::size_t chunksize = 1 << 20);
+
   private:
 	struct FormatInfos
 	{
@@ -195,27 +137,34 @@ PGL_BEGIN_NAMESPACE
 		float version;
 	};
 
+	typedef std::vector<SpecElement> SpecList;
+
 	ScenePtr readScene(std::string const &fname);
 
-	void parseAsciiValue(std::ifstream& file, std::map<std::string, SpecElement>::const_iterator const &it, pgl_hash_map_string<std::vector<propertyType> > &element);
+	ElementLayout compileLayout(SpecElement const &spec) const;
+
+	static std::size_t scalarSize(ScalarType type);
 
-	void parseBinaryValue(std::ifstream& file, std::map<std::string, SpecElement>::const_iterator const &it, pgl_hash_map_string<std::vector<propertyType> > &element);
+	static double scalarValue(const char *data, ScalarType type, bool reverse);
 
-	void parseVertex(std::size_t i, pgl_hash_map_string<std::vector<propertyType> > &element, Point3ArrayPtr const points, Color4ArrayPtr const colors);
+	void readVertices(BinaryReader *binary, AsciiReader *ascii, ElementLayout const &layout, std::size_t begin, std::size_t end,
+	                  Point3ArrayPtr points, Color4ArrayPtr colors, std::size_t offset) const;
 
-	void parseFace(std::size_t i, pgl_hash_map_string<std::vector<propertyType> > const &element, IndexArrayPtr const faces);
+	void readFaces(BinaryReader *binary, AsciiReader *ascii, ElementLayout const &layout, IndexArrayPtr faces) const;
+
+	void skipElement(BinaryReader *binary, AsciiReader *ascii, ElementLayout const &layout) const;
 
 	std::ifstream openFile(std::string const &path) const;
 
 	FormatInfos parseFormatInfos(std::ifstream &file) const;
 
-	std::map<std::string, SpecElement> parseHeader(std::ifstream &file, FormatInfos const &format) const;
+	SpecList parseHeader(std::ifstream &file, FormatInfos const &format) const;
 
-	std::string parseHeaderElement(std::map<std::string, SpecElement> &specs, std::string const &line) const;
+	void parseHeaderElement(SpecList &specs, std::string const &line) const;
 
-	void parseHeaderProperty(std::map<std::string, SpecElement> &specs, std::string const &line, std::string const &lastSpecName) const;
+	void parseHeaderProperty(SpecList &specs, std::string const &line) const;
 
-	std::vector<std::string> parseColorProps(std::map<std::string, SpecElement> const &specs) const;
+	std::vector<std::string> parseColorProps(SpecList const &specs) const;
 
 	bool isBytesReverseNeeded(std::string const &fcoding) const;
 
@@ -223,17 +172,13 @@ PGL_BEGIN_NAMESPACE
 
     std::string readNextLine(std::ifstream &file) const;
 
-    propertyType readNextValue(std::ifstream &file, propertyType const &type);
-
     bool colorPropsSortFunction(std::string const &c1, std::string const &c2) const;
 
     std::vector<std::string> m_fcodingTypes;
-	pgl_hash_map_string<propertyType> m_propertiesTypes;
+	pgl_hash_map_string<ScalarType> m_propertiesTypes;
     std::vector<std::string> m_knownColorTypes;
-    SizeVisitor sizeVisitor;
-	
+
 	bool m_reverseBytes;
-	std::vector<char> m_buffer;
 	std::vector<std::string> m_colorProps;
   };
 
@@ -45,6 +45,7 @@
 
 #include "plyprinter.h"
 #include <plantgl/algo/base/discretizer.h>
+#include <plantgl/algo/base/instancedscene.h>
 
 #include <plantgl/pgl_scene.h>
 #include <plantgl/pgl_appearance.h>
@@ -60,20 +61,24 @@ using namespace std;
 
 /* ----------------------------------------------------------------------- */
 
+#define GEOM_PLY_POINT(point) \
+  (__transformation ? (*__transformation) * (point) : (point))
+
 #define GEOM_PLY_MESH(obj,gindex,len) \
   if( __pass == 1 ){ \
     __vertex += obj->getPointList()->size(); \
     __face += obj->getIndexList()->size(); \
   } \
   else if( __pass == 2 ){ \
-    for(Point3Array::const_iterator _it = obj->getPointList()->begin(); \
-        _it != obj->getPointList()->end(); _it++){ \
-         stream << _it->x() << ' ' <<_it->y()  << ' ' << _it->z()  << ' ' << __red   << ' ' << __green   << ' ' << __blue << endl; \
+    for(Point3Array::const_iterator _it = const_array(*obj->getPointList()).begin(); \
+        _it != const_array(*obj->getPointList()).end(); _it++){ \
+         const Vector3 _pt = GEOM_PLY_POINT(*_it); \
+         stream << _pt.x() << ' ' <<_pt.y()  << ' ' << _pt.z()  << ' ' << __red   << ' ' << __green   << ' ' << __blue << endl; \
     } \
   } \
   else if( __pass == 3 ){ \
-    for(gindex##Array::const_iterator _it = obj->getIndexList()->begin(); \
-        _it != obj->getIndexList()->end(); _it++){ \
+    for(gindex##Array::const_iterator _it = const_array(*obj->getIndexList()).begin(); \
+        _it != const_array(*obj->getIndexList()).end(); _it++){ \
        stream << len; \
        for(gindex::const_iterator _it2 = _it->begin(); \
           _it2 != _it->end(); _it2++) \
@@ -91,14 +96,15 @@ using namespace std;
     __face += obj->getIndexList()->size(); \
   } \
   else if( __pass == 2 ){ \
-    for(Point3Array::const_iterator _it = obj->getPointList()->begin(); \
-        _it != obj->getPointList()->end(); _it++){ \
-      stream << (float)_it->x() << (float)_it->y()  << (float)_it->z() << (uchar_t)__red  << (uchar_t)__green  << (uchar_t)__blue; \
+    for(Point3Array::const_iterator _it = const_array(*obj->getPointList()).begin(); \
+        _it != const_array(*obj->getPointList()).end(); _it++){ \
+      const Vector3 _pt = GEOM_PLY_POINT(*_it); \
+      stream << (float)_pt.x() << (float)_pt.y()  << (float)_pt.z() << (uchar_t)__red  << (uchar_t)__green  << (uchar_t)__blue; \
     } \
   } \
   else if( __pass == 3 ){ \
-    for(gindex##Array::const_iterator _it = obj->getIndexList()->begin(); \
-        _it != obj->getIndexList()->end(); _it++){ \
+    for(gindex##Array::const_iterator _it = const_array(*obj->getIndexList()).begin(); \
+        _it != const_array(*obj->getIndexList()).end(); _it++){ \
        stream << (uchar_t)len; \
        for(gindex::const_iterator _it2 = _it->begin(); \
           _it2 != _it->end(); _it2++) \
@@ -120,7 +126,8 @@ PlyPrinter::PlyPrinter( ostream& stream , Discretizer& discretizer) :
   __red(160),
   __green(160),
   __blue(160),
-  __index(0)
+  __index(0),
+  __transformation(NULL)
 {
 }
 
@@ -685,6 +692,36 @@ PlyPrinter::process(ScenePtr scene, const char * comment)
   return true;
 }
 
+bool
+PlyPrinter::process(const InstancedScenePtr& instances, const char * comment)
+{
+  GEOM_ASSERT(instances);
+  const std::vector<GeometryPtr>& prototypes = instances->getPrototypes();
+  const std::vector<uint32_t>& prototypeids = instances->getPrototypeIds();
+  const std::vector<uint32_t>& materialids = instances->getMaterialIds();
+
+  std::vector<ExplicitModelPtr> discretizations(prototypes.size());
+  for(size_t p = 0; p < prototypes.size(); ++p)
+    if(prototypes[p]->apply(__discretizer))
+      discretizations[p] = __discretizer.getDiscretization();
+
+  for(__pass = 1; __pass <= 3; ++__pass){
+    if( __pass == 2 ) header(comment);
+    for(size_t i = 0; i < instances->size(); ++i){
+      const ExplicitModelPtr& discretization = discretizations[prototypeids[i]];
+      if(is_null_ptr(discretization)) continue;
+      if( __pass == 2 ){
+        const AppearancePtr& appearance = instances->getMaterials()[materialids[i]];
+        if(appearance) appearance->apply(*this);
+      }
+      __transformation = &instances->getTransformations()[i];
+      discretization->apply(*this);
+    }
+    __transformation = NULL;
+  }
+  return true;
+}
+
 
 /* ----------------------------------------------------------------------- */
 
@@ -729,6 +766,31 @@ PlyPrinter::print(ScenePtr scene,string filename,const char * comment, ply_forma
 
 
 
+bool
+PlyPrinter::print(const InstancedScenePtr& instances,string filename,const char * comment, ply_format format )
+{
+  Discretizer discretizer;
+  if(format == ply_ascii){
+    ofstream stream(filename.c_str());
+    if(!stream)return false;
+    PlyPrinter printer(stream,discretizer);
+    return printer.process(instances,comment);
+  }
+  else if (format == ply_binary_little_endian){
+    leofstream stream(filename.c_str());
+    if(!stream)return false;
+    PlyBinaryPrinter printer(stream,discretizer,format);
+    return printer.process(instances,comment);
+  }
+  else {
+    beofstream stream(filename.c_str());
+    if(!stream)return false;
+    PlyBinaryPrinter printer(stream,discretizer,format);
+    return printer.process(instances,comment);
+  }
+}
+
+
 bool
 PlyPrinter::print(ScenePtr scene,Discretizer & discretizer,
       string filename,const char * comment, ply_format format )
@@ -787,10 +849,11 @@ bool PlyBinaryPrinter::process(PGL::PointSet *pointSet) {
     __vertex += pointSet->getPointList()->size();
   else if( __pass == 2 ) {
     uint_t index = 0;
-    for(Point3Array::const_iterator _it = pointSet->getPointList()->begin(); _it != pointSet->getPointList()->end(); ++_it, index++) {
-      this->stream << (float) _it->x() << (float) _it->y() << (float) _it->z();
+    for(Point3Array::const_iterator _it = const_array(*pointSet->getPointList()).begin(); _it != const_array(*pointSet->getPointList()).end(); ++_it, index++) {
+      const Vector3 _pt = GEOM_PLY_POINT(*_it);
+      this->stream << (float) _pt.x() << (float) _pt.y() << (float) _pt.z();
       if (pointSet->hasColorList()) {
-        Color4 color = pointSet->getColorList()->getAt(index);
+        Color4 color = const_array(*pointSet->getColorList()).getAt(index);
         this->stream << (uchar_t) color.getRed() << (uchar_t) color.getGreen() << (uchar_t) color.getBlue();
       } else
         this->stream << (uchar_t) __red << (uchar_t) __green << (uchar_t) __blue;
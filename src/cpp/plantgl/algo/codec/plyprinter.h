@@ -67,6 +67,9 @@ PGL_BEGIN_NAMESPACE
 class Discretizer;
 class Scene;
 typedef RCPtr<Scene> ScenePtr;
+class InstancedScene;
+typedef RCPtr<InstancedScene> InstancedScenePtr;
+class Matrix4;
 
 /* ----------------------------------------------------------------------- */
 
@@ -374,9 +377,16 @@ public :
       - \e scene must be non null and valid. */
   virtual bool process(ScenePtr scene, const char * comment);
 
+  /** Applies \e self to the instances of \e instances. Each prototype is
+      discretized once and its points are transformed for each instance. */
+  bool process(const InstancedScenePtr& instances, const char * comment);
+
   /// Print the scene \e scene in the file \e filename in ply format.
   static bool print(ScenePtr scene,std::string filename,const char * comment = NULL, ply_format format = ply_ascii );
 
+  /// Print the instances \e instances in the file \e filename in ply format.
+  static bool print(const InstancedScenePtr& instances,std::string filename,const char * comment = NULL, ply_format format = ply_ascii );
+
   /// Print the scene \e scene in the file \e filename in ply format.
   static bool print(ScenePtr scene,Discretizer & discretizer,
                     std::string filename,const char * comment = NULL, ply_format format = ply_ascii);
@@ -407,6 +417,9 @@ protected :
   /// index of point.
   uint_t __index;
 
+  /// transformation of the points of the current instance, if any.
+  const Matrix4 * __transformation;
+
 
 };
 
@@ -431,6 +444,8 @@ public :
   /// Destructor.
   virtual ~PlyBinaryPrinter();
 
+  using PlyPrinter::process;
+
 
   /// Add comment in the header of the outpu file.
   virtual bool header(const char * comment = NULL);
@@ -52,6 +52,7 @@
 
 #include <plantgl/scenegraph/container/geometryarray2.h>
 #include <plantgl/algo/base/tesselator.h>
+#include <plantgl/algo/base/instancedscene.h>
 #include <plantgl/scenegraph/geometry/boundingbox.h>
 #include <plantgl/scenegraph/container/pointarray.h>
 
@@ -135,7 +136,7 @@ using namespace std;
 
 
 #define GEOM_POVPRINT_TEXTURE_REF \
-  __geomStream << __indent << "texture { " << __texture << " }" << endl;
+  if (!__texture.empty()) __geomStream << __indent << "texture { " << __texture << " }" << endl;
 
 #define GEOM_POVPRINT_TEXTURE(obj) \
   if (!obj->isNamed()) GEOM_POVPRINT_TEXTURE_REF
@@ -360,6 +361,39 @@ bool PovPrinter::process( Inline * geomInline ) {
   return true;
 }
 
+bool PovPrinter::process( const InstancedScenePtr& instances ) {
+  GEOM_ASSERT(instances);
+  const std::vector<GeometryPtr>& prototypes = instances->getPrototypes();
+  const std::vector<uint32_t>& prototypeids = instances->getPrototypeIds();
+  const std::vector<uint32_t>& materialids = instances->getMaterialIds();
+  std::vector<bool> declared(prototypes.size(), false);
+
+  for (size_t i = 0; i < instances->size(); ++i){
+    const AppearancePtr& appearance = instances->getMaterials()[materialids[i]];
+    if (appearance) appearance->apply(*this);
+
+    const GeometryPtr& prototype = prototypes[prototypeids[i]];
+    if (!declared[prototypeids[i]]){
+      // Declared without texture so that each instance can give its own.
+      std::string texture = __texture;
+      __texture.clear();
+      __geomStream << __indent << "#declare PROTO_" << prototype->getObjectId() << " = ";
+      GEOM_POVPRINT_BEG_(__geomStream,"object");
+      prototype->apply(*this);
+      GEOM_POVPRINT_END_(__geomStream);
+      __texture = texture;
+      declared[prototypeids[i]] = true;
+    }
+
+    GEOM_POVPRINT_BEG_(__geomStream,"object");
+    __geomStream << __indent << "PROTO_" << prototype->getObjectId() << endl;
+    GEOM_POVPRINT_MATRIX(__geomStream,instances->getTransformations()[i]);
+    GEOM_POVPRINT_TEXTURE_REF;
+    GEOM_POVPRINT_END_(__geomStream);
+  }
+  return true;
+}
+
 /* ----------------------------------------------------------------------- */
 
 
@@ -775,8 +809,8 @@ bool PovPrinter::process( IFS * ifs )
 
   GEOM_POVPRINT_BEGIN(__geomStream,"union",ifs);
 
-  Matrix4Array::const_iterator matrix= matrixList->begin();
-  while( matrix != matrixList->end() )
+  Matrix4Array::const_iterator matrix= const_array(*matrixList).begin();
+  while( matrix != const_array(*matrixList).end() )
     {
     GEOM_POVPRINT_BEG_(__geomStream,"object");
     ifs->getGeometry()->apply(*this);
@@ -864,9 +898,9 @@ bool PovPrinter::process( PointSet * pointSet ) {
 
   GEOM_POVPRINT_BEGIN(__geomStream,"union",pointSet);
   Color4Array::const_iterator itColor;
-  if (pointSet->hasColorList()) itColor = pointSet->getColorList()->begin();
-  for (Point3Array::const_iterator _i = pointSet->getPointList()->begin();
-    _i != pointSet->getPointList()->end(); _i++) {
+  if (pointSet->hasColorList()) itColor = const_array(*pointSet->getColorList()).begin();
+  for (Point3Array::const_iterator _i = const_array(*pointSet->getPointList()).begin();
+    _i != const_array(*pointSet->getPointList()).end(); _i++) {
     const Vector3& _vertex1 = *_i;
     GEOM_POVPRINT_BEG_(__geomStream,"sphere");
     __geomStream << __indent;
@@ -920,8 +954,8 @@ bool PovPrinter::process( Polyline * polyline ) {
       else {
         GEOM_POVPRINT_BEGIN(__geomStream,"cylinder",polyline);
       }
-      for (Point3Array::const_iterator _i = polyline->getPointList()->begin();
-            _i != polyline->getPointList()->end()-1; _i++) {
+      for (Point3Array::const_iterator _i = const_array(*polyline->getPointList()).begin();
+            _i != const_array(*polyline->getPointList()).end()-1; _i++) {
             const Vector3& _vertex1 = *_i;
             const Vector3& _vertex2 = *(_i+1);
             if(norm(_vertex1-_vertex2) > GEOM_EPSILON){
@@ -1178,13 +1212,13 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
               if (transform)  newtexcoord = transform->transform(newtexcoord);
           }
           __geomStream << " uv_vectors ";
-          const Vector2& _vertex1 = newtexcoord->getAt(triangleSet->getFaceTexCoordIndexAt(_i,0));
+          const Vector2& _vertex1 = const_array(*newtexcoord).getAt(triangleSet->getFaceTexCoordIndexAt(_i,0));
           GEOM_POVPRINT_VECTOR2(__geomStream,_vertex1);
           __geomStream << ", ";
-          const Vector2& _vertex2 = newtexcoord->getAt(triangleSet->getFaceTexCoordIndexAt(_i,1));
+          const Vector2& _vertex2 = const_array(*newtexcoord).getAt(triangleSet->getFaceTexCoordIndexAt(_i,1));
           GEOM_POVPRINT_VECTOR2(__geomStream,_vertex2);
           __geomStream << ", ";
-          const Vector2& _vertex3 = newtexcoord->getAt(triangleSet->getFaceTexCoordIndexAt(_i,2));
+          const Vector2& _vertex3 = const_array(*newtexcoord).getAt(triangleSet->getFaceTexCoordIndexAt(_i,2));
           GEOM_POVPRINT_VECTOR2(__geomStream,_vertex3);
       }
     __geomStream << "}" << endl;
@@ -1197,9 +1231,9 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
     __geomStream << __indent << "vertex_vectors { " << triangleSet->getPointList()->size() << endl << __indent;
     size_t pointperline = 5;
     size_t cpid = 0;
-    Point3Array::const_iterator endpoints = triangleSet->getPointList()->end();
+    Point3Array::const_iterator endpoints = const_array(*triangleSet->getPointList()).end();
 
-    for (Point3Array::const_iterator itPoints = triangleSet->getPointList()->begin(); itPoints != endpoints; ++itPoints, ++cpid) 
+    for (Point3Array::const_iterator itPoints = const_array(*triangleSet->getPointList()).begin(); itPoints != endpoints; ++itPoints, ++cpid) 
     {
             GEOM_POVPRINT_VECTOR3(__geomStream,(*itPoints));
             if (itPoints != endpoints -1){
@@ -1214,9 +1248,9 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
     __geomStream << __indent << "normal_vectors { " << triangleSet->getNormalList()->size() << endl << __indent;
 
     cpid = 0;
-    endpoints = triangleSet->getNormalList()->end();
+    endpoints = const_array(*triangleSet->getNormalList()).end();
 
-    for (Point3Array::const_iterator itPoints = triangleSet->getNormalList()->begin(); itPoints != endpoints; ++itPoints, ++cpid) 
+    for (Point3Array::const_iterator itPoints = const_array(*triangleSet->getNormalList()).begin(); itPoints != endpoints; ++itPoints, ++cpid) 
     {
             GEOM_POVPRINT_VECTOR3(__geomStream,(*itPoints));
             if (itPoints != endpoints -1){
@@ -1236,9 +1270,9 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
         __geomStream << __indent << "uv_vectors  { " << newtexcoord->size() << endl << __indent;
 
         cpid = 0;
-        Point2Array::const_iterator endtex = newtexcoord->end();
+        Point2Array::const_iterator endtex = const_array(*newtexcoord).end();
 
-        for (Point2Array::const_iterator itTex = newtexcoord->begin(); itTex != endtex; ++itTex, ++cpid) 
+        for (Point2Array::const_iterator itTex = const_array(*newtexcoord).begin(); itTex != endtex; ++itTex, ++cpid) 
         {
                 GEOM_POVPRINT_VECTOR2(__geomStream,(*itTex));
                 if (itTex != endtex -1){
@@ -1254,9 +1288,9 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
         __geomStream << __indent << "texture_list  { " << triangleSet->getColorList()->size() << endl << __indent;
 
         cpid = 0;
-        Color4Array::const_iterator endColor = triangleSet->getColorList()->end();
+        Color4Array::const_iterator endColor = const_array(*triangleSet->getColorList()).end();
 
-        for (Color4Array::const_iterator itColor = triangleSet->getColorList()->begin(); itColor != endColor; ++itColor, ++cpid) 
+        for (Color4Array::const_iterator itColor = const_array(*triangleSet->getColorList()).begin(); itColor != endColor; ++itColor, ++cpid) 
         {
                 __geomStream << "texture { pigment { rgbt ";
                 GEOM_POVPRINT_COLOR4(__geomStream,(*itColor));
@@ -1272,9 +1306,9 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
     __geomStream << __indent << "face_indices  { " << nbFaces << endl << __indent;
 
     cpid = 0;
-    Index3Array::const_iterator endIndex = triangleSet->getIndexList()->end();
+    Index3Array::const_iterator endIndex = const_array(*triangleSet->getIndexList()).end();
 
-    for (Index3Array::const_iterator itIndex = triangleSet->getIndexList()->begin(); itIndex != endIndex; ++itIndex, ++cpid) 
+    for (Index3Array::const_iterator itIndex = const_array(*triangleSet->getIndexList()).begin(); itIndex != endIndex; ++itIndex, ++cpid) 
     {
             GEOM_POVPRINT_INDEX3(__geomStream,(*itIndex));
             if (triangleSet->hasColorList()){
@@ -1283,7 +1317,7 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
                     __geomStream << cpid << ", " << cpid << ", " << cpid;
                 }
                 else {
-                    Index3& ind = (is_null_ptr(triangleSet->getColorIndexList()) ? triangleSet->getIndexList()->getAt(cpid) : triangleSet->getColorIndexList()->getAt(cpid));
+                    const Index3& ind = (is_null_ptr(triangleSet->getColorIndexList()) ? const_array(*triangleSet->getIndexList()).getAt(cpid) : const_array(*triangleSet->getColorIndexList()).getAt(cpid));
                     __geomStream << ind.getAt(0) << ", " << ind.getAt(1) << ", " << ind.getAt(2) ;
                 }
             }
@@ -1305,7 +1339,7 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
                     GEOM_POVPRINT_INDEX3(__geomStream,findex);
                 }
                 else {
-                    GEOM_POVPRINT_INDEX3(__geomStream,triangleSet->getNormalIndexList()->getAt(cpid));
+                    GEOM_POVPRINT_INDEX3(__geomStream,const_array(*triangleSet->getNormalIndexList()).getAt(cpid));
                 }
                 if (cpid != nbFaces -1){
                     __geomStream << ", ";
@@ -1321,7 +1355,7 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
 
         for (cpid = 0; cpid < nbFaces;  ++cpid) 
         {
-                GEOM_POVPRINT_INDEX3(__geomStream,triangleSet->getTexCoordIndexList()->getAt(cpid));
+                GEOM_POVPRINT_INDEX3(__geomStream,const_array(*triangleSet->getTexCoordIndexList()).getAt(cpid));
                 if (cpid != nbFaces -1){
                     __geomStream << ", ";
                     if ((cpid+1) % 5 == 0) __geomStream << endl << __indent;
@@ -1375,13 +1409,13 @@ bool PovPrinter::process( TriangleSet * triangleSet ) {
               if (transform)  newtexcoord = transform->transform(newtexcoord);
           }
           __geomStream << " uv_vectors ";
-          const Vector2& _vertex1 = newtexcoord->getAt(triangleSet->getFaceTexCoordIndexAt(_i,0));
+          const Vector2& _vertex1 = const_array(*newtexcoord).getAt(triangleSet->getFaceTexCoordIndexAt(_i,0));
           GEOM_POVPRINT_VECTOR2(__geomStream,_vertex1);
           __geomStream << ", ";
-          const Vector2& _vertex2 = newtexcoord->getAt(triangleSet->getFaceTexCoordIndexAt(_i,1));
+          const Vector2& _vertex2 = const_array(*newtexcoord).getAt(triangleSet->getFaceTexCoordIndexAt(_i,1));
           GEOM_POVPRINT_VECTOR2(__geomStream,_vertex2);
           __geomStream << ", ";
-          const Vector2& _vertex3 = newtexcoord->getAt(triangleSet->getFaceTexCoordIndexAt(_i,2));
+          const Vector2& _vertex3 = const_array(*newtexcoord).getAt(triangleSet->getFaceTexCoordIndexAt(_i,2));
           GEOM_POVPRINT_VECTOR2(__geomStream,_vertex3);
       }
     __geomStream << "}" << endl;
@@ -1468,8 +1502,8 @@ bool PovPrinter::process( PointSet2D * pointSet ) {
 
   GEOM_POVPRINT_BEGIN(__geomStream,"union",pointSet);
   Vector3 _vertex1;
-  for (Point2Array::const_iterator _i = pointSet->getPointList()->begin();
-    _i != pointSet->getPointList()->end(); _i++) {
+  for (Point2Array::const_iterator _i = const_array(*pointSet->getPointList()).begin();
+    _i != const_array(*pointSet->getPointList()).end(); _i++) {
     _vertex1 = Vector3(*_i,0);
     GEOM_POVPRINT_BEG_(__geomStream,"sphere");
     __geomStream << __indent;
@@ -71,6 +71,8 @@ class Tesselator;
 class Color3;
 class BoundingBox;
 typedef RCPtr<BoundingBox> BoundingBoxPtr;
+class InstancedScene;
+typedef RCPtr<InstancedScene> InstancedScenePtr;
 
 /* ----------------------------------------------------------------------- */
 
@@ -139,6 +141,10 @@ public:
 
   virtual bool process(Inline * geomInline);
 
+  /** Print the instances of \e instances. Each prototype is declared once
+      and each instance refers to it with its own matrix and texture. */
+  bool process(const InstancedScenePtr& instances);
+
   //@}
 
   /// @name Material
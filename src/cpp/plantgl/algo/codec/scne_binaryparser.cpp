@@ -54,12 +54,14 @@
 #include <plantgl/tool/bfstream.h>
 #include <plantgl/tool/dirnames.h>
 #include <plantgl/tool/util_enviro.h>
+#include <plantgl/tool/util_profiler.h>
 
 #include "scne_parser.h"
 
 #include <iostream>
 
 #include <typeinfo>
+#include <algorithm>
 
 PGL_USING_NAMESPACE
 
@@ -132,9 +134,7 @@ bool PGL(isParserVerbose)()
     uint_t _sizej = readUint32(); \
     if (_sizej > 0){ \
       obj = type##Ptr (new type(_sizej)); \
-      for (type::iterator _it = obj->begin();_it != obj->end() && !stream->eof(); _it++) { \
-      *_it = read##primitive(); \
-      }; \
+      readElements(obj->begin(), obj->end()); \
     }; \
   };
 
@@ -152,9 +152,7 @@ bool PGL(isParserVerbose)()
     uint_t _rows  = readUint32(); \
     uint_t _cols  = readUint32(); \
     obj = type##Ptr (new type(_rows,_cols)); \
-    for (type::iterator _it = obj->begin();_it != obj->end() && !stream->eof(); _it++) { \
-    *_it = read##primitive(); \
-    }; \
+    readElements(obj->begin(), obj->end()); \
   };
 
 
@@ -361,6 +359,33 @@ real_t BinaryParser::readReal()
  { float val;  *stream >> val; return val; }
 }
 
+/// read real_t values stored as one block
+void BinaryParser::readReals(real_t * values, size_t nb)
+{
+  if (nb == 0) return;
+  if (__double_precision == (sizeof(real_t) == sizeof(double))) {
+      stream->readBlock((char *)values, sizeof(real_t), nb);
+  }
+  else if (__double_precision) {
+      std::vector<double> buffer(nb);
+      stream->readBlock((char *)&buffer[0], sizeof(double), nb);
+      std::copy(buffer.begin(), buffer.end(), values);
+  }
+  else {
+      std::vector<float> buffer(nb);
+      stream->readBlock((char *)&buffer[0], sizeof(float), nb);
+      std::copy(buffer.begin(), buffer.end(), values);
+  }
+}
+
+/// read uint32_t values stored as one block
+void BinaryParser::readUint32s(uint32_t * values, size_t nb)
+{ if (nb > 0) stream->readBlock((char *)values, sizeof(uint32_t), nb); }
+
+/// read uchar_t values stored as one block
+void BinaryParser::readUchars(uchar_t * values, size_t nb)
+{ if (nb > 0) stream->readBlock((char *)values, sizeof(uchar_t), nb); }
+
 /// read a string value from stream
 std::string BinaryParser::readString()
 {
@@ -459,8 +484,7 @@ Index BinaryParser::readIndex()
 {
   uint_t size = readUint32();
   Index val(size);
-  for(Index::iterator it = val.begin(); it != val.end(); ++it)
-      *it = readUint32();
+  readElements(val.begin(), val.end());
   return val;
 }
 
@@ -667,6 +691,7 @@ bool BinaryParser::parse(const string& filename){
 }
 
 bool BinaryParser::parse(){
+    PGL_PROFILE_ZONE("BinaryParser::parse");
     if(!readHeader())return false;
     if(!readSceneHeader())return false;
     PglErrorStream::Binder psb(__outputStream);
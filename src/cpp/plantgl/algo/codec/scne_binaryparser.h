@@ -54,6 +54,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <type_traits>
 #include "codec_config.h"
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/math/util_math.h>
@@ -62,6 +63,7 @@
 #include <plantgl/tool/util_cache.h>
 #include <plantgl/scenegraph/appearance/color.h>
 #include <plantgl/scenegraph/container/indexarray.h>
+#include "binaryprinter.h"
 
 /* ----------------------------------------------------------------------- */
 
@@ -375,15 +377,31 @@ public:
   template<class T>
   T read();
 
+  /// read \e nb real_t values stored as one block
+  void readReals(real_t * values, size_t nb);
+
+  /// read \e nb uint32_t values stored as one block
+  void readUint32s(uint32_t * values, size_t nb);
+
+  /// read \e nb uchar_t values stored as one block
+  void readUchars(uchar_t * values, size_t nb);
+
+  inline void readScalars(real_t * values, size_t nb) { readReals(values,nb); }
+  inline void readScalars(uint32_t * values, size_t nb) { readUint32s(values,nb); }
+  inline void readScalars(uchar_t * values, size_t nb) { readUchars(values,nb); }
+
+  /// read the elements from \e beg to \e end. Elements described by BinaryBlock are read by blocks.
+  template<class Iterator>
+  void readElements(Iterator beg, Iterator end) {
+      typedef typename std::iterator_traits<Iterator>::value_type element_type;
+      readElements(beg, end, std::integral_constant<bool,(BinaryBlock<element_type>::dim > 0)>());
+  }
 
   template <class Array>
   RCPtr<Array> readArray() {
       uint32_t _sizei = readUint32();
       RCPtr<Array> result(new Array(_sizei));
-      uint32_t pid = 0;
-      for(typename Array::iterator it = result->begin(); it != result->end(); ++it, ++pid){
-          *it = read<typename Array::element_type>();
-      }
+      readElements(result->begin(), result->end());
       return result;
   }
 
@@ -399,8 +417,7 @@ public:
       uint32_t _rows = readUint32();
       uint32_t _cols = readUint32();
       RCPtr<Array2> result(new Array2(_rows, _cols));
-      for(typename Array2::iterator it = result->begin(); it != result->end(); ++it)
-          *it = read<typename Array2::element_type>();
+      readElements(result->begin(), result->end());
       return result;
   }
 
@@ -412,6 +429,30 @@ public:
   }
 
   protected :
+
+  template<class Iterator>
+  void readElements(Iterator beg, Iterator end, std::false_type) {
+      for(Iterator it = beg; it != end && !eof(); ++it)
+          *it = read<typename std::iterator_traits<Iterator>::value_type>();
+  }
+
+  template<class Iterator>
+  void readElements(Iterator beg, Iterator end, std::true_type) {
+      typedef BinaryBlock<typename std::iterator_traits<Iterator>::value_type> Block;
+      std::vector<typename Block::scalar_type> buffer;
+      size_t remaining = std::distance(beg, end);
+      for(Iterator it = beg; remaining > 0 && !eof(); ) {
+          size_t nb = (remaining < PGL_BINARY_BLOCK_SIZE ? remaining : PGL_BINARY_BLOCK_SIZE);
+          remaining -= nb;
+          buffer.resize(nb * Block::dim);
+          readScalars(&buffer[0], buffer.size());
+          typename std::vector<typename Block::scalar_type>::const_iterator itbuf = buffer.begin();
+          for (; nb > 0; --nb, ++it)
+              for (size_t i = 0; i < Block::dim; ++i, ++itbuf)
+                  Block::at(*it,i) = *itbuf;
+      }
+  }
+
   /// The resulting scene.
   ScenePtr __scene;
 
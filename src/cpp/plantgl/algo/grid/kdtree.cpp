@@ -45,6 +45,10 @@
 
 #include "kdtree.h"
 #include "annkdtree_p.h"
+#include "../base/parallelexecutor.h"
+
+#include <algorithm>
+#include <limits>
 
 PGL_USING_NAMESPACE
 /* ----------------------------------------------------------------------- */
@@ -89,3 +93,349 @@ ANNKDTREEDECLARATIONCORE(KDTree4,Point4Array)
 
 /* ----------------------------------------------------------------------- */
 
+#define KDTREE_QUERY_CHUNK 1024
+#define KDTREE_PARALLEL_BUILD_SIZE 65536
+
+/* ----------------------------------------------------------------------- */
+
+// Number of nodes of the trees of nbpoints and nbpoints+1 points.
+// Since a node of n points is split in n/2 and n-n/2, the shape of the tree
+// only depends on its size and subtrees can be built independently.
+static std::pair<size_t,size_t> kdtree_nb_nodes(size_t nbpoints, uint32_t maxLeafSize)
+{
+    if (nbpoints + 1 <= maxLeafSize) return std::pair<size_t,size_t>(1,1);
+    if (nbpoints <= maxLeafSize) return std::pair<size_t,size_t>(1,3);
+    std::pair<size_t,size_t> half = kdtree_nb_nodes(nbpoints / 2, maxLeafSize);
+    if (nbpoints % 2 == 0)
+        return std::pair<size_t,size_t>(1 + 2 * half.first, 1 + half.first + half.second);
+    else
+        return std::pair<size_t,size_t>(1 + half.first + half.second, 1 + 2 * half.second);
+}
+
+template<class ContainerType, class CoordType>
+PGL(NativeKDTree)<ContainerType,CoordType>::NativeKDTree(const PointContainerPtr& points, uint32_t maxLeafSize) :
+    BaseType(points),
+    __maxLeafSize(std::max<uint32_t>(1,maxLeafSize)),
+    __multithreaded(true)
+{
+    size_t nbpoints = points ? points->size() : 0;
+    if (nbpoints == 0) return;
+
+    __ids.resize(nbpoints);
+    __coords.resize(nbpoints * Dimension);
+    uint32_t pid = 0;
+    for (typename PointContainer::const_iterator itp = points->begin(); itp != points->end(); ++itp, ++pid) {
+        __ids[pid] = pid;
+        for (size_t d = 0; d < Dimension; ++d)
+            __coords[d * nbpoints + pid] = CoordType(itp->getAt(d));
+    }
+
+    __nodes.resize(kdtree_nb_nodes(nbpoints, __maxLeafSize).first);
+
+    size_t nbthreads = ParallelExecutor::get().nb_threads();
+    if (__multithreaded && nbthreads > 1 && nbpoints > KDTREE_PARALLEL_BUILD_SIZE) {
+        // build the top of the tree and then its subtrees in parallel
+        uint32_t paralleldepth = 2;
+        while ((1u << paralleldepth) < 4 * nbthreads) ++paralleldepth;
+        std::vector<BuildTask> tasks;
+        buildNode(0, 0, nbpoints, 0, paralleldepth, &tasks);
+        ParallelExecutor::get().parallel_for_each(0, tasks.size(), [this, &tasks](size_t i) {
+            buildNode(tasks[i].node, tasks[i].begin, tasks[i].end, 0, 0, NULL);
+        }, 1);
+    }
+    else buildNode(0, 0, nbpoints, 0, 0, NULL);
+
+    // permute the coordinates in tree order
+    std::vector<CoordType> coords(nbpoints * Dimension);
+    for (size_t d = 0; d < Dimension; ++d) {
+        const CoordType * src = &__coords[d * nbpoints];
+        CoordType * dest = &coords[d * nbpoints];
+        for (size_t i = 0; i < nbpoints; ++i) dest[i] = src[__ids[i]];
+    }
+    __coords.swap(coords);
+}
+
+template<class ContainerType, class CoordType>
+PGL(NativeKDTree)<ContainerType,CoordType>::~NativeKDTree()
+{
+}
+
+template<class ContainerType, class CoordType>
+void PGL(NativeKDTree)<ContainerType,CoordType>::buildNode(uint32_t nodeid, uint32_t begin, uint32_t end, uint32_t depth, uint32_t paralleldepth, std::vector<BuildTask> * tasks)
+{
+    uint32_t nbpoints = end - begin;
+    if (tasks != NULL && depth == paralleldepth && nbpoints > __maxLeafSize) {
+        BuildTask task = { nodeid, begin, end };
+        tasks->push_back(task);
+        return;
+    }
+
+    Node& node = __nodes[nodeid];
+    node.begin = begin;
+    node.end = end;
+    node.right = 0;
+    node.split = 0;
+    if (nbpoints <= __maxLeafSize) {
+        node.axis = Dimension;
+        return;
+    }
+
+    // split along the axis of largest extent
+    size_t totalsize = __ids.size();
+    CoordType maxextent = -1;
+    uint32_t axis = 0;
+    for (uint32_t d = 0; d < Dimension; ++d) {
+        const CoordType * coords = &__coords[d * totalsize];
+        CoordType minv = coords[__ids[begin]], maxv = minv;
+        for (uint32_t i = begin + 1; i < end; ++i) {
+            CoordType v = coords[__ids[i]];
+            if (v < minv) minv = v;
+            else if (v > maxv) maxv = v;
+        }
+        if (maxv - minv > maxextent) { maxextent = maxv - minv; axis = d; }
+    }
+
+    const CoordType * coords = &__coords[axis * totalsize];
+    uint32_t mid = begin + nbpoints / 2;
+    std::nth_element(__ids.begin() + begin, __ids.begin() + mid, __ids.begin() + end,
+                     [coords](uint32_t a, uint32_t b) { return coords[a] < coords[b]; });
+
+    node.axis = axis;
+    node.split = coords[__ids[mid]];
+    node.right = nodeid + 1 + kdtree_nb_nodes(mid - begin, __maxLeafSize).first;
+
+    uint32_t right = node.right;
+    buildNode(nodeid + 1, begin, mid, depth + 1, paralleldepth, tasks);
+    buildNode(right, mid, end, depth + 1, paralleldepth, tasks);
+}
+
+template<class ContainerType, class CoordType>
+void PGL(NativeKDTree)<ContainerType,CoordType>::knnSearch(uint32_t nodeid, const CoordType * query, CoordType * offsets, CoordType rd, size_t k, CoordType sqrMaxDist, NeighborHeap& heap, CoordType * dists) const
+{
+    const Node& node = __nodes[nodeid];
+    if (node.axis == Dimension) {
+        size_t totalsize = __ids.size();
+        uint32_t nbpoints = node.end - node.begin;
+        for (uint32_t i = 0; i < nbpoints; ++i) dists[i] = 0;
+        for (size_t d = 0; d < Dimension; ++d) {
+            const CoordType * coords = &__coords[d * totalsize + node.begin];
+            CoordType q = query[d];
+            for (uint32_t i = 0; i < nbpoints; ++i) {
+                CoordType diff = coords[i] - q;
+                dists[i] += diff * diff;
+            }
+        }
+        for (uint32_t i = 0; i < nbpoints; ++i) {
+            if (heap.size() < k) {
+                if (dists[i] <= sqrMaxDist) {
+                    heap.push_back(Neighbor(dists[i], __ids[node.begin + i]));
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            else if (dists[i] < heap.front().first) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = Neighbor(dists[i], __ids[node.begin + i]);
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+        return;
+    }
+
+    CoordType diff = query[node.axis] - node.split;
+    uint32_t nearchild = nodeid + 1, farchild = node.right;
+    if (diff >= 0) std::swap(nearchild, farchild);
+
+    knnSearch(nearchild, query, offsets, rd, k, sqrMaxDist, heap, dists);
+
+    CoordType oldoffset = offsets[node.axis];
+    rd += diff * diff - oldoffset * oldoffset;
+    CoordType worst = (heap.size() < k ? sqrMaxDist : heap.front().first);
+    if (rd <= worst) {
+        offsets[node.axis] = diff;
+        knnSearch(farchild, query, offsets, rd, k, sqrMaxDist, heap, dists);
+        offsets[node.axis] = oldoffset;
+    }
+}
+
+template<class ContainerType, class CoordType>
+void PGL(NativeKDTree)<ContainerType,CoordType>::radiusSearch(uint32_t nodeid, const CoordType * query, CoordType * offsets, CoordType rd, CoordType sqrRadius, NeighborHeap& result, CoordType * dists) const
+{
+    const Node& node = __nodes[nodeid];
+    if (node.axis == Dimension) {
+        size_t totalsize = __ids.size();
+        uint32_t nbpoints = node.end - node.begin;
+        for (uint32_t i = 0; i < nbpoints; ++i) dists[i] = 0;
+        for (size_t d = 0; d < Dimension; ++d) {
+            const CoordType * coords = &__coords[d * totalsize + node.begin];
+            CoordType q = query[d];
+            for (uint32_t i = 0; i < nbpoints; ++i) {
+                CoordType diff = coords[i] - q;
+                dists[i] += diff * diff;
+            }
+        }
+        for (uint32_t i = 0; i < nbpoints; ++i)
+            if (dists[i] <= sqrRadius) result.push_back(Neighbor(dists[i], __ids[node.begin + i]));
+        return;
+    }
+
+    CoordType diff = query[node.axis] - node.split;
+    uint32_t nearchild = nodeid + 1, farchild = node.right;
+    if (diff >= 0) std::swap(nearchild, farchild);
+
+    radiusSearch(nearchild, query, offsets, rd, sqrRadius, result, dists);
+
+    CoordType oldoffset = offsets[node.axis];
+    rd += diff * diff - oldoffset * oldoffset;
+    if (rd <= sqrRadius) {
+        offsets[node.axis] = diff;
+        radiusSearch(farchild, query, offsets, rd, sqrRadius, result, dists);
+        offsets[node.axis] = oldoffset;
+    }
+}
+
+// Scratch buffer of the distances to the points of a leaf, reused by the successive queries of a thread.
+template<class CoordType>
+inline CoordType * kdtree_leaf_dists(size_t size)
+{
+    static thread_local std::vector<CoordType> dists;
+    if (dists.size() < size) dists.resize(size);
+    return &dists[0];
+}
+
+template<class ContainerType, class CoordType>
+void PGL(NativeKDTree)<ContainerType,CoordType>::queryRange(const CoordType * queries, size_t k, CoordType sqrDist, bool byradius, IndexArray * result, size_t begin, size_t end) const
+{
+    size_t totalsize = __ids.size();
+    bool treepoints = (queries == NULL);
+    // the query point itself is found and removed from the result
+    if (treepoints && !byradius) ++k;
+    k = std::min(k, totalsize);
+
+    CoordType * dists = kdtree_leaf_dists<CoordType>(__maxLeafSize);
+    CoordType query[Dimension];
+    CoordType offsets[Dimension];
+    NeighborHeap heap;
+    for (size_t qid = begin; qid < end; ++qid) {
+        uint32_t self = UINT32_MAX;
+        if (treepoints) {
+            for (size_t d = 0; d < Dimension; ++d) query[d] = __coords[d * totalsize + qid];
+            self = __ids[qid];
+        }
+        else {
+            for (size_t d = 0; d < Dimension; ++d) query[d] = queries[qid * Dimension + d];
+        }
+        for (size_t d = 0; d < Dimension; ++d) offsets[d] = 0;
+
+        heap.clear();
+        if (byradius) {
+            radiusSearch(0, query, offsets, 0, sqrDist, heap, dists);
+            std::sort(heap.begin(), heap.end());
+        }
+        else if (k > 0) {
+            knnSearch(0, query, offsets, 0, k, sqrDist, heap, dists);
+            std::sort_heap(heap.begin(), heap.end());
+        }
+
+        // with duplicated points, the query point may not be part of its k+1 closest points.
+        size_t maxsize = (treepoints && !byradius) ? k - 1 : heap.size();
+        Index& res = result->getAt(treepoints ? self : qid);
+        res.reserve(maxsize);
+        for (typename NeighborHeap::const_iterator itn = heap.begin(); itn != heap.end() && res.size() < maxsize; ++itn)
+            if (itn->second != self) res.push_back(itn->second);
+    }
+}
+
+template<class ContainerType, class CoordType>
+IndexArrayPtr PGL(NativeKDTree)<ContainerType,CoordType>::dispatch(const CoordType * queries, size_t nbqueries, size_t k, CoordType sqrDist, bool byradius) const
+{
+    IndexArrayPtr result(new IndexArray(nbqueries, Index()));
+    if (__nodes.empty() || nbqueries == 0) return result;
+    if (__multithreaded && nbqueries > KDTREE_QUERY_CHUNK) {
+        IndexArray * res = result.get();
+        ParallelExecutor::get().parallel_for(0, nbqueries, [=](size_t begin, size_t end) {
+            queryRange(queries, k, sqrDist, byradius, res, begin, end);
+        }, KDTREE_QUERY_CHUNK);
+    }
+    else queryRange(queries, k, sqrDist, byradius, result.get(), 0, nbqueries);
+    return result;
+}
+
+template<class CoordType>
+inline CoordType kdtree_sqr_dist(real_t dist)
+{
+    if (dist >= REAL_MAX) return std::numeric_limits<CoordType>::max();
+    return CoordType(dist * dist);
+}
+
+template<class ContainerType, class CoordType>
+Index PGL(NativeKDTree)<ContainerType,CoordType>::k_closest_points(const VectorType& point, size_t k, real_t maxdist)
+{
+    Index result;
+    if (__nodes.empty() || k == 0) return result;
+    k = std::min(k, __ids.size());
+
+    CoordType query[Dimension];
+    CoordType offsets[Dimension];
+    for (size_t d = 0; d < Dimension; ++d) { query[d] = CoordType(point.getAt(d)); offsets[d] = 0; }
+
+    // Single point queries are often made in loops. They reuse the buffers of their thread.
+    static thread_local NeighborHeap heap;
+    heap.clear();
+    knnSearch(0, query, offsets, 0, k, kdtree_sqr_dist<CoordType>(maxdist), heap, kdtree_leaf_dists<CoordType>(__maxLeafSize));
+    std::sort_heap(heap.begin(), heap.end());
+    result.reserve(heap.size());
+    for (typename NeighborHeap::const_iterator itn = heap.begin(); itn != heap.end(); ++itn)
+        result.push_back(itn->second);
+    return result;
+}
+
+template<class ContainerType, class CoordType>
+IndexArrayPtr PGL(NativeKDTree)<ContainerType,CoordType>::k_nearest_neighbors(size_t k)
+{
+    return dispatch(NULL, __ids.size(), k, std::numeric_limits<CoordType>::max(), false);
+}
+
+template<class ContainerType, class CoordType>
+IndexArrayPtr PGL(NativeKDTree)<ContainerType,CoordType>::r_nearest_neighbors(real_t radius)
+{
+    return dispatch(NULL, __ids.size(), 0, kdtree_sqr_dist<CoordType>(radius), true);
+}
+
+template<class ContainerType, class CoordType>
+IndexArrayPtr PGL(NativeKDTree)<ContainerType,CoordType>::k_closest_points(const PointContainerPtr& queries, size_t k, real_t maxdist) const
+{
+    size_t nbqueries = queries ? queries->size() : 0;
+    std::vector<CoordType> coords(nbqueries * Dimension);
+    size_t i = 0;
+    if (queries)
+        for (typename PointContainer::const_iterator itp = queries->begin(); itp != queries->end(); ++itp)
+            for (size_t d = 0; d < Dimension; ++d, ++i) coords[i] = CoordType(itp->getAt(d));
+    return dispatch(nbqueries > 0 ? &coords[0] : NULL, nbqueries, k, kdtree_sqr_dist<CoordType>(maxdist), false);
+}
+
+template<class ContainerType, class CoordType>
+IndexArrayPtr PGL(NativeKDTree)<ContainerType,CoordType>::r_closest_points(const PointContainerPtr& queries, real_t radius) const
+{
+    size_t nbqueries = queries ? queries->size() : 0;
+    std::vector<CoordType> coords(nbqueries * Dimension);
+    size_t i = 0;
+    if (queries)
+        for (typename PointContainer::const_iterator itp = queries->begin(); itp != queries->end(); ++itp)
+            for (size_t d = 0; d < Dimension; ++d, ++i) coords[i] = CoordType(itp->getAt(d));
+    return dispatch(nbqueries > 0 ? &coords[0] : NULL, nbqueries, 0, kdtree_sqr_dist<CoordType>(radius), true);
+}
+
+// for instanciation
+PGL_BEGIN_NAMESPACE
+
+template class NativeKDTree<Point2Array,real_t>;
+template class NativeKDTree<Point3Array,real_t>;
+template class NativeKDTree<Point4Array,real_t>;
+
+template class NativeKDTree<Point2Array,float>;
+template class NativeKDTree<Point3Array,float>;
+template class NativeKDTree<Point4Array,float>;
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
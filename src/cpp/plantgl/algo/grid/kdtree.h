@@ -53,6 +53,7 @@
 #include "../algo_config.h"
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/container/indexarray.h>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -104,6 +105,114 @@ typedef RCPtr<AbstractKDTree2>       KDTree2Ptr;
 typedef RCPtr<AbstractKDTree3>       KDTree3Ptr;
 typedef RCPtr<AbstractKDTree4>       KDTree4Ptr;
 
+/* ----------------------------------------------------------------------- */
+
+/**
+    \class NativeKDTree
+    \brief A KD-tree that does not depend on ANN.
+
+    Nodes are stored in a flat array built by median splits along the axis
+    of largest extent. Coordinates are permuted in tree order and stored one
+    axis after the other so that leaf scans run over contiguous memory and
+    can be vectorized by the compiler. CoordType can be set to float to
+    halve the memory footprint on very large point clouds.
+    Queries on all the points of the tree and batch queries are dispatched
+    on all the cores.
+*/
+
+template<class ContainerType, class CoordType = real_t>
+class ALGO_API NativeKDTree : public AbstractKDTree<ContainerType>
+{
+public:
+    typedef AbstractKDTree<ContainerType> BaseType;
+    typedef typename BaseType::PointContainer PointContainer;
+    typedef typename BaseType::PointContainerPtr PointContainerPtr;
+    typedef typename BaseType::VectorType VectorType;
+
+    static const size_t Dimension = VectorType::SIZE;
+
+    NativeKDTree(const PointContainerPtr& points, uint32_t maxLeafSize = 16);
+    virtual ~NativeKDTree();
+
+    /// Return the ids of the k closest points of point sorted by distance, limited to the points at a distance inferior to maxdist.
+    virtual Index k_closest_points(const VectorType& point, size_t k, real_t maxdist = REAL_MAX);
+
+    /// Return the k closest points of each point of the tree, excluding itself.
+    virtual IndexArrayPtr k_nearest_neighbors(size_t k);
+
+    /// Return the points at a distance inferior to radius of each point of the tree, excluding itself.
+    virtual IndexArrayPtr r_nearest_neighbors(real_t radius);
+
+    virtual size_t size() const { return __ids.size(); }
+
+    /// Return the k closest points of each of the query points.
+    IndexArrayPtr k_closest_points(const PointContainerPtr& queries, size_t k, real_t maxdist = REAL_MAX) const;
+
+    /// Return the points of the tree at a distance inferior to radius of each of the query points.
+    IndexArrayPtr r_closest_points(const PointContainerPtr& queries, real_t radius) const;
+
+    inline uint32_t getMaxLeafSize() const { return __maxLeafSize; }
+    inline size_t getNbNodes() const { return __nodes.size(); }
+
+    inline bool isMultiThreaded() const { return __multithreaded; }
+    inline void setMultiThreaded(bool value) { __multithreaded = value; }
+
+protected:
+    struct Node {
+        CoordType split;
+        uint32_t begin;
+        uint32_t end;
+        // index of the right child. Left child is stored just after its parent.
+        uint32_t right;
+        // split axis or Dimension for leaves
+        uint32_t axis;
+    };
+
+    struct BuildTask {
+        uint32_t node;
+        uint32_t begin;
+        uint32_t end;
+    };
+
+    typedef std::pair<CoordType,uint32_t> Neighbor;
+    typedef std::vector<Neighbor> NeighborHeap;
+
+    void buildNode(uint32_t nodeid, uint32_t begin, uint32_t end, uint32_t depth, uint32_t paralleldepth, std::vector<BuildTask> * tasks);
+
+    void knnSearch(uint32_t nodeid, const CoordType * query, CoordType * offsets, CoordType rd, size_t k, CoordType sqrMaxDist, NeighborHeap& heap, CoordType * dists) const;
+    void radiusSearch(uint32_t nodeid, const CoordType * query, CoordType * offsets, CoordType rd, CoordType sqrRadius, NeighborHeap& result, CoordType * dists) const;
+
+    // process queries [begin,end). If queries is null, the points of the tree are used as queries and excluded from their own result.
+    void queryRange(const CoordType * queries, size_t k, CoordType sqrDist, bool byradius, IndexArray * result, size_t begin, size_t end) const;
+    IndexArrayPtr dispatch(const CoordType * queries, size_t nbqueries, size_t k, CoordType sqrDist, bool byradius) const;
+
+    // original ids of the points in tree order
+    std::vector<uint32_t> __ids;
+    // coordinates in tree order, axis after axis
+    std::vector<CoordType> __coords;
+    std::vector<Node> __nodes;
+    uint32_t __maxLeafSize;
+    bool __multithreaded;
+};
+
+typedef NativeKDTree<Point2Array>         NativeKDTree2;
+typedef NativeKDTree<Point3Array>         NativeKDTree3;
+typedef NativeKDTree<Point4Array>         NativeKDTree4;
+
+typedef NativeKDTree<Point2Array,float>   NativeKDTree2f;
+typedef NativeKDTree<Point3Array,float>   NativeKDTree3f;
+typedef NativeKDTree<Point4Array,float>   NativeKDTree4f;
+
+typedef RCPtr<NativeKDTree2>       NativeKDTree2Ptr;
+typedef RCPtr<NativeKDTree3>       NativeKDTree3Ptr;
+typedef RCPtr<NativeKDTree4>       NativeKDTree4Ptr;
+
+typedef RCPtr<NativeKDTree2f>      NativeKDTree2fPtr;
+typedef RCPtr<NativeKDTree3f>      NativeKDTree3fPtr;
+typedef RCPtr<NativeKDTree4f>      NativeKDTree4fPtr;
+
+/* ----------------------------------------------------------------------- */
+
 #ifdef PGL_WITH_ANN
 
 class ANNKDTree2Internal;
@@ -142,6 +251,12 @@ typedef ANNKDTree2 KDTree2 ;
 typedef ANNKDTree3 KDTree3 ;
 typedef ANNKDTree4 KDTree4 ;
 
+#else
+
+typedef NativeKDTree2 KDTree2 ;
+typedef NativeKDTree3 KDTree3 ;
+typedef NativeKDTree4 KDTree4 ;
+
 #endif
 
 /* ----------------------------------------------------------------------- */
@@ -43,6 +43,7 @@
 #include "tile.h"
 #include "voxelintersection.h"
 #include "../base/discretizer.h"
+#include "../base/parallelexecutor.h"
 
 
 // #define CPL_DEBUG
@@ -57,6 +58,7 @@
 #include "../raycasting/rayintersection.h"
 
 #include <plantgl/tool/timer.h>
+#include <plantgl/tool/util_profiler.h>
 #include <plantgl/math/util_math.h>
 
 PGL_USING_NAMESPACE
@@ -103,10 +105,18 @@ Octree::~Octree(){
 bool Octree::setScene( const ScenePtr& scene){
     __scene = scene;
     __root = OctreeNode(0,0,Tile::Undetermined);
+    clear();
     build();
     return true;
 }
 
+void Octree::clear(){
+    __triangles = CompiledScenePtr();
+    __nodes.clear();
+    __noderanges.clear();
+    __triangleids.clear();
+}
+
 
 bool Octree::isValid( ) const {
     return true;
@@ -117,6 +127,7 @@ bool Octree::isValid( ) const {
 void Octree::build()
 /////////////////////////////////////////////////////////////////////////////
 {
+    PGL_PROFILE_ZONE("Octree::build");
     if (__method == ShapeBased) build1();
     else build2();
 }
@@ -127,6 +138,200 @@ void Octree::build()
 #define LLDELTA_P(a) a *= (a >= 0 ? 0.9 : 1.1 );
 #define LLDELTA(a) LLDELTA_P(a.x())LLDELTA_P(a.y())LLDELTA_P(a.z())
 
+/* ----------------------------------------------------------------------- */
+
+/*! Children of a voxel of center \e center to which the triangle (p0,p1,p2) is assigned, as a bit mask.
+    The triangle is assigned to the children that contain the signs of its vertices relative to the center,
+    and to all of them when no coordinate sign is the same for the 3 vertices. */
+static uchar_t topDownMask( const Vector3& center,
+                            const Vector3& p0, const Vector3& p1, const Vector3& p2 )
+{
+    Vector3 d0= p0 - center, d1= p1 - center, d2= p2 - center;
+
+    bool x0= ( d0.x() > 0 ), x1= ( d1.x() > 0 ), x2= ( d2.x() > 0 );
+    bool y0= ( d0.y() > 0 ), y1= ( d1.y() > 0 ), y2= ( d2.y() > 0 );
+    bool z0= ( d0.z() > 0 ), z1= ( d1.z() > 0 ), z2= ( d2.z() > 0 );
+
+    bool x_cst= (x0&&x1&&x2) || (!x0&&!x1&&!x2); // x=0 or x=1
+    bool y_cst= (y0&&y1&&y2) || (!y0&&!y1&&!y2); // y=0 or y=1
+    bool z_cst= (z0&&z1&&z2) || (!z0&&!z1&&!z2); // z=0 or z=1
+
+    if( x_cst && y_cst && z_cst )
+      {
+      uchar_t l(0);
+      if(x0) l |= 1;
+      if(z0) l |= 2;
+      if(y0) l |= 4;
+      return uchar_t(1 << l);
+      }
+
+    bool xy= x_cst && y_cst, xz= x_cst && z_cst, yz= y_cst && z_cst;
+    if( xy || xz || yz )
+      {
+      uchar_t l1(0), l2(0);
+      if( x_cst && x0 ) { l1|= 1; l2|= 1; }
+      if( z_cst && z0 ) { l1|= 2; l2|= 2; }
+      if( y_cst && y0 ) { l1|= 4; l2|= 4; }
+
+      l2|= (yz) ? 1 : (xy) ? 2 : 4;
+      return uchar_t((1 << l1) | (1 << l2));
+      }
+
+    if( x_cst || y_cst || z_cst )
+      {
+      uchar_t l1(0), l2(0), l3(0), l4(0);
+      if( x_cst && x0 ) { l1|= 1; l2|= 1; l3|= 1; l4|= 1; }
+      if( z_cst && z0 ) { l1|= 2; l2|= 2; l3|= 2; l4|= 2; }
+      if( y_cst && y0 ) { l1|= 4; l2|= 4; l3|= 4; l4|= 4; }
+      if( x_cst ) { l2|= 2; l4|= 2; l3|= 4; l4|= 4; }
+      if( y_cst ) { l2|= 1; l4|= 1; l3|= 2; l4|= 2; }
+      if( z_cst ) { l2|= 1; l4|= 1; l3|= 4; l4|= 4; }
+      return uchar_t((1 << l1) | (1 << l2) | (1 << l3) | (1 << l4));
+      }
+
+    // gloups on est en diagonal. umps. difffficile.
+    return uchar_t(0xff);
+}
+
+/* ----------------------------------------------------------------------- */
+
+/*! Triangle based construction of the nodes of an octree.
+    Nodes are stored in arrays and refer to each other by index. The 8 children of a node are contiguous
+    and stored after it. The triangles of a leaf are a range of the indices of the tree. */
+class OctreeBuilder {
+public:
+
+  struct Node {
+    Node(uint32_t _parent, uchar_t _scale, uchar_t _num, Tile::TileType _type, const Vector3& _ll, const Vector3& _ur) :
+      parent(_parent), children(0), scale(_scale), num(_num), type(_type), ll(_ll), ur(_ur), begin(0), end(0) { }
+
+    uint32_t parent;
+    /// index of the first child. 0 if the node is not decomposed.
+    uint32_t children;
+    uchar_t scale;
+    uchar_t num;
+    Tile::TileType type;
+    Vector3 ll;
+    Vector3 ur;
+    /// range of the triangles of a leaf.
+    uint32_t begin;
+    uint32_t end;
+  };
+
+  struct Tree {
+    Tree() : nbundetermined(0) { }
+
+    /// Append the nodes of \e subtree, whose root is the node \e nodeid of \e self.
+    void graft(uint32_t nodeid, const Tree& subtree)
+    {
+      uint32_t nodeoffset = uint32_t(nodes.size()) - 1;
+      uint32_t triangleoffset = uint32_t(triangles.size());
+      for(size_t i = 0; i < subtree.nodes.size(); ++i)
+        {
+        Node n = subtree.nodes[i];
+        if(n.children) n.children += nodeoffset;
+        n.begin += triangleoffset;
+        n.end += triangleoffset;
+        if( i == 0 ) { n.parent = nodes[nodeid].parent; nodes[nodeid] = n; }
+        else {
+          n.parent = (n.parent == 0 ? nodeid : n.parent + nodeoffset);
+          nodes.push_back(n);
+        }
+        }
+      triangles.insert(triangles.end(), subtree.triangles.begin(), subtree.triangles.end());
+      nbundetermined += subtree.nbundetermined;
+    }
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> triangles;
+    /// number of undetermined nodes other than the root.
+    size_t nbundetermined;
+  };
+
+  /// Nodes that remain to decompose with their triangles.
+  typedef std::vector<std::pair<uint32_t, std::vector<uint32_t> > > Tasks;
+
+  OctreeBuilder(const std::vector<Vector3>& positions, uint_t maxscale, uint_t maxelts) :
+    __positions(positions), __maxscale(maxscale), __maxelts(maxelts) { }
+
+  /*! Decompose the node \e nodeid of \e tree and distribute \e triangles among its children.
+      Children that have to be decomposed are appended to \e tasks with their triangles.
+      If the node cannot be decomposed, it becomes a leaf that keeps \e triangles. */
+  void split(Tree& tree, uint32_t nodeid, const std::vector<uint32_t>& triangles, Tasks& tasks) const
+  {
+    Node node = tree.nodes[nodeid];
+    Vector3 center = (node.ll+node.ur)/2;
+    // same conditions as OctreeNode::decompose
+    if( node.type != Tile::Undetermined || node.scale >= __maxscale ||
+        !(fabs(center.x()-node.ll.x()) > GEOM_EPSILON &&
+          fabs(center.y()-node.ll.y()) > GEOM_EPSILON &&
+          fabs(center.y()-node.ll.y()) > GEOM_EPSILON ) )
+      {
+      setTriangles(tree, nodeid, triangles);
+      return;
+      }
+
+    std::vector<uint32_t> children[8];
+    for(std::vector<uint32_t>::const_iterator _it = triangles.begin(); _it != triangles.end(); ++_it)
+      {
+      const Vector3 * p = &__positions[3 * *_it];
+      uchar_t mask = topDownMask(center, p[0], p[1], p[2]);
+      for(uchar_t i = 0; i < 8; ++i)
+        if( mask & (1 << i) ) children[i].push_back(*_it);
+      }
+
+    uint32_t first = uint32_t(tree.nodes.size());
+    tree.nodes[nodeid].children = first;
+    for(uchar_t i = 0; i < 8; ++i)
+      {
+      Vector3 ll((i & 1) ? center.x() : node.ll.x(), (i & 4) ? center.y() : node.ll.y(), (i & 2) ? center.z() : node.ll.z());
+      Vector3 ur((i & 1) ? node.ur.x() : center.x(), (i & 4) ? node.ur.y() : center.y(), (i & 2) ? node.ur.z() : center.z());
+      Tile::TileType type = Tile::Empty;
+      if( !children[i].empty() )
+        type = ( children[i].size() < __maxelts ? Tile::Filled : Tile::Undetermined );
+      tree.nodes.push_back(Node(nodeid, uchar_t(node.scale+1), i, type, ll, ur));
+      }
+
+    for(uchar_t i = 0; i < 8; ++i)
+      {
+      if( tree.nodes[first+i].type == Tile::Filled )
+        setTriangles(tree, first+i, children[i]);
+      else if( tree.nodes[first+i].type == Tile::Undetermined )
+        {
+        ++tree.nbundetermined;
+        tasks.push_back(Tasks::value_type(first+i, std::vector<uint32_t>()));
+        tasks.back().second.swap(children[i]);
+        }
+      }
+  }
+
+  /// Decompose recursively the node \e nodeid of \e tree.
+  void build(Tree& tree, uint32_t nodeid, const std::vector<uint32_t>& triangles) const
+  {
+    Tasks tasks;
+    split(tree, nodeid, triangles, tasks);
+    for(Tasks::iterator _it = tasks.begin(); _it != tasks.end(); ++_it)
+      {
+      std::vector<uint32_t> subtriangles;
+      subtriangles.swap(_it->second);
+      build(tree, _it->first, subtriangles);
+      }
+  }
+
+protected:
+
+  void setTriangles(Tree& tree, uint32_t nodeid, const std::vector<uint32_t>& triangles) const
+  {
+    tree.nodes[nodeid].begin = uint32_t(tree.triangles.size());
+    tree.triangles.insert(tree.triangles.end(), triangles.begin(), triangles.end());
+    tree.nodes[nodeid].end = uint32_t(tree.triangles.size());
+  }
+
+  const std::vector<Vector3>& __positions;
+  uint_t __maxscale;
+  uint_t __maxelts;
+};
+
 /////////////////////////////////////////////////////////////////////////////
 void Octree::build1()
 /////////////////////////////////////////////////////////////////////////////
@@ -344,7 +549,6 @@ void Octree::build2()
     Tesselator discretizer;
 
     BBoxComputer bboxcomputer(discretizer);
-    VoxelIntersection intersection(bboxcomputer);
 
     if( __root.getMinCoord() == Vector3::ORIGIN &&
         __root.getMaxCoord() == Vector3::ORIGIN )
@@ -360,107 +564,63 @@ void Octree::build2()
         }
       }
 
-    __scene->applyGeometryOnly(discretizer);
+    __triangles = CompiledScenePtr(new CompiledScene(__scene));
 
-    OctreeNode * node;
-    OctreeNode * _complex;
+    OctreeBuilder builder(__triangles->getPositions(), __maxscale, __maxelts);
 
-    queue<OctreeNode *> _myQueue;
+    OctreeBuilder::Tree tree;
+    tree.nodes.push_back(OctreeBuilder::Node(0, 0, 0, Tile::Undetermined, __root.getMinCoord(), __root.getMaxCoord()));
 
-    _myQueue.push(&__root);
-    __root.getGeometry() = __scene;
+    OctreeBuilder::Tasks frontier(1);
+    frontier[0].first = 0;
+    frontier[0].second.resize(__triangles->nbTriangles());
+    for(uint32_t t = 0; t < frontier[0].second.size(); ++t) frontier[0].second[t] = t;
 
-    uint_t max_count2= 0;
-    uint_t total_triangles= 0;
-    uchar_t i;
-    while(!_myQueue.empty())
+    // the first levels are decomposed breadth first until there are enough subtrees to build in parallel.
+    ParallelExecutor& executor = ParallelExecutor::get();
+    const size_t nbtasks = 8 * executor.nb_threads();
+    size_t next = 0;
+    while( next < frontier.size() && frontier.size() - next < nbtasks )
       {
-      max_count2+= 8;
-      _complex = _myQueue.front();
-      _myQueue.pop();
-
-      if( _complex->getType() == Tile::Undetermined &&
-          _complex->getScale() < __maxscale )
-        {
-        if( _complex->decompose() )
-          {
-          ScenePtr s(_complex->getGeometry());
-          ScenePtr n[8];
-          uint_t nb_triangles[8];
-          double xm[8], ym[8], zm[8];
-          for( i = 0 ; i <  8 ; i++ )
-            {
-            n[i]= ScenePtr(new Scene());
-            nb_triangles[i]= 0;
-            xm[i]= 0.; ym[i]= 0.; zm[i]= 0.;
-            }
-
-          // on parcourt tous les triangles du noeud _complex (pere)
-          // on les repartit dans le fils adequat
-          Scene::iterator _it;
-          for( _it = s->begin(); _it!=s->end(); _it++ )
-            {
-            if((*_it)->apply(discretizer))
-              {
-              TriangleSetPtr ts= discretizer.getTriangulation( );
-
-              Index3ArrayPtr triangles[8];
-              real_t _xm[8], _ym[8], _zm[8];
-              topDown(_complex, ts, triangles, _xm, _ym, _zm);
-              for( i = 0 ; i <  8 ; i++ )
-                {
-                if( ! triangles[i]->empty() )
-                  {
-                  nb_triangles[i]+= triangles[i]->size();
-                  xm[i]+= _xm[i]; ym[i]+= _ym[i]; zm[i]+= _zm[i];
-                  TriangleSetPtr tri(new TriangleSet( ts->getPointList(),
-                                                      triangles[i],
-                                                      ts->getNormalPerVertex(),
-                                                      ts->getCCW(),
-                                                      ts->getSolid(),
-                                                      ts->getSkeleton()));
-
-                  n[i]->add(Shape3DPtr(new Shape( GeometryPtr(tri), AppearancePtr() )));
-                  }
-                }
-              }
-            }
+      std::vector<uint32_t> triangles;
+      triangles.swap(frontier[next].second);
+      builder.split(tree, frontier[next].first, triangles, frontier);
+      ++next;
+      }
 
-          for( i = 0 ; i <  8 ; i++ )
-            {
-            node = _complex->getComponent(i);
-            if( ! nb_triangles[i] )
-              node->getType() = Tile::Empty;
-            else
-              {
-              node->getGeometry()= n[i];
-              if( nb_triangles[i] < __maxelts )
-                {
-                node->getType() = Tile::Filled;
-                total_triangles+= nb_triangles[i];
-                }
-              else
-                {
-                node->getType() = Tile::Undetermined;
-                Vector3 ns = node->getSize()/2.;
-/*                if( fabs(ns.x()) > max(xm[i],GEOM_EPSILON) &&
-                    fabs(ns.y()) > max(ym[i],GEOM_EPSILON) &&
-                    fabs(ns.z()) > max(zm[i],GEOM_EPSILON) )
-                   {*/
-                   _myQueue.push(node);
-                   if( node->getScale() == __maxscale )
-                     total_triangles+= nb_triangles[i];
-/*                   }
-                else
-                  total_triangles+= nb_triangles[i];*/
-                }
-              }
-            } // for 2
-          } //if2
-        }//if1
+    size_t nbsubtrees = frontier.size() - next;
+    std::vector<OctreeBuilder::Tree> subtrees(nbsubtrees);
+    executor.parallel_for_each(0, nbsubtrees, [&](size_t i) {
+        PGL_PROFILE_ZONE("Octree::buildSubtree");
+        OctreeBuilder::Tree& subtree = subtrees[i];
+        subtree.nodes.push_back(tree.nodes[frontier[next+i].first]);
+        builder.build(subtree, 0, frontier[next+i].second);
+    }, 1);
+
+    for(size_t i = 0; i < nbsubtrees; ++i)
+      tree.graft(frontier[next+i].first, subtrees[i]);
+
+    // the nodes are stored in the pool in the order of the tree so that parents are created before their children.
+    __nodes.reserve(tree.nodes.size()-1);
+    __noderanges.reserve(tree.nodes.size());
+    __noderanges.push_back(std::pair<uint32_t,uint32_t>(tree.nodes[0].begin, tree.nodes[0].end));
+    for(size_t i = 1; i < tree.nodes.size(); ++i)
+      {
+      const OctreeBuilder::Node& n = tree.nodes[i];
+      OctreeNode * parent = (n.parent == 0 ? &__root : &__nodes[n.parent-1]);
+      __nodes.push_back(OctreeNode(parent, n.scale, n.type, n.num, n.ll, n.ur));
+      __noderanges.push_back(std::pair<uint32_t,uint32_t>(n.begin, n.end));
       }
+    for(size_t i = 0; i < tree.nodes.size(); ++i)
+      if( tree.nodes[i].children )
+        {
+        OctreeNode * node = (i == 0 ? &__root : &__nodes[i-1]);
+        node->setPooledComponents(&__nodes[tree.nodes[i].children-1]);
+        }
+    __triangleids.swap(tree.triangles);
 
-    __nbnode = (uint_t)max_count2;
+    // 8 nodes were counted for the root and for each undetermined node.
+    __nbnode = 8 * (1 + tree.nbundetermined);
 }
 
 ScenePtr Octree::getRepresentation() const{
@@ -646,7 +806,11 @@ bool Octree::intersect( const Ray& ray,
 
   while( voxel )
     {
-    if(voxel->getGeometry())
+    if(__triangles)
+      {
+      if(intersectTriangles(ray, voxel, intersection)) return true;
+      }
+    else if(voxel->getGeometry())
       {
       isOk= voxel->getGeometry()->applyGeometryOnly(actionRay);
       if(isOk) break;
@@ -743,6 +907,34 @@ bool Octree::intersect( const Ray& ray,
     return false;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+bool Octree::intersectTriangles( const Ray& ray,
+                                 const OctreeNode* voxel,
+                                 Vector3& intersection ) const
+/////////////////////////////////////////////////////////////////////////////
+{
+  size_t nodeid = (voxel == &__root ? 0 : size_t(voxel - &__nodes[0]) + 1);
+  const std::pair<uint32_t,uint32_t>& range = __noderanges[nodeid];
+  const std::vector<Vector3>& positions = __triangles->getPositions();
+
+  real_t dist= REAL_MAX;
+  Vector3 pt;
+  for( uint32_t t = range.first; t < range.second; ++t )
+    {
+    const Vector3 * p = &positions[3 * __triangleids[t]];
+    if( ray.intersect(p[0], p[1], p[2], pt) == 1 )
+      {
+      real_t d_cur= normSquared(ray.getOrigin()-pt);
+      if( d_cur < dist )
+        {
+        intersection= pt;
+        dist= d_cur;
+        }
+      }
+    }
+  return dist < REAL_MAX;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 const OctreeNode* Octree::getLeafNode( const Vector3& point,
                                        const Vector3& dir,
@@ -799,9 +991,7 @@ bool Octree::topDown( const OctreeNode* voxel,
   Index3ArrayPtr indices(mesh->getIndexList());
 
   Vector3 p0, p1, p2;
-  Vector3 d0, d1, d2;
   Vector3 h0, h1, h2;
-  bool x0, x1, x2, y0, y1, y2, z0, z1, z2;
   Index3Array::iterator _it;
   for( _it = indices->begin(); _it != indices->end(); _it++ )
     {
@@ -809,76 +999,18 @@ bool Octree::topDown( const OctreeNode* voxel,
     p1= points->getAt(_it->getAt(1));
     p2= points->getAt(_it->getAt(2));
 
-    d0= p0 - center; d1= p1 - center; d2= p2 - center;
     h0= p0 - p1; h1= p1 - p2; h2= p2 - p0;
     real_t max_x= max(fabs(h0.x()), max(fabs(h1.x()),fabs(h2.x())));
     real_t max_y= max(fabs(h0.y()), max(fabs(h1.y()),fabs(h2.y())));
     real_t max_z= max(fabs(h0.z()), max(fabs(h1.z()),fabs(h2.z())));
 
-    x0= ( d0.x() > 0 ); x1= ( d1.x() > 0 ); x2= ( d2.x() > 0 );
-    y0= ( d0.y() > 0 ); y1= ( d1.y() > 0 ); y2= ( d2.y() > 0 );
-    z0= ( d0.z() > 0 ); z1= ( d1.z() > 0 ); z2= ( d2.z() > 0 );
-
-    bool x_cst= (x0&&x1&&x2) || (!x0&&!x1&&!x2); // x=0 or x=1
-    bool y_cst= (y0&&y1&&y2) || (!y0&&!y1&&!y2); // y=0 or y=1
-    bool z_cst= (z0&&z1&&z2) || (!z0&&!z1&&!z2); // z=0 or z=1
-
-    if( x_cst && y_cst && z_cst )
-      {
-      uchar_t l(0);
-      if(x0) l |= 1;
-      if(z0) l |= 2;
-      if(y0) l |= 4;
-      triangles[l]->push_back(*_it);
-      xm[l]+= max_x; ym[l]+= max_y; zm[l]+= max_z;
-      }
-    else
-      {
-      bool xy= x_cst && y_cst, xz= x_cst && z_cst, yz= y_cst && z_cst;
-      if( xy || xz || yz )
+    uchar_t mask= topDownMask(center, p0, p1, p2);
+    for( i= 0; i < 8; i++ )
+      if( mask & (1 << i) )
         {
-        uchar_t l1(0), l2(0);
-        if( x_cst && x0 ) { l1|= 1; l2|= 1; }
-        if( z_cst && z0 ) { l1|= 2; l2|= 2; }
-        if( y_cst && y0 ) { l1|= 4; l2|= 4; }
-
-        l2|= (yz) ? 1 : (xy) ? 2 : 4;
-        triangles[l1]->push_back(*_it);
-        triangles[l2]->push_back(*_it);
-        xm[l1]+= max_x; ym[l1]+= max_y; zm[l1]+= max_z;
-        xm[l2]+= max_x; ym[l2]+= max_y; zm[l2]+= max_z;
+        triangles[i]->push_back(*_it);
+        xm[i]+= max_x; ym[i]+= max_y; zm[i]+= max_z;
         }
-      else
-      if( x_cst || y_cst || z_cst )
-        {
-        // to do
-        uchar_t l1(0), l2(0), l3(0), l4(0);
-        if( x_cst && x0 ) { l1|= 1; l2|= 1; l3|= 1; l4|= 1; }
-        if( z_cst && z0 ) { l1|= 2; l2|= 2; l3|= 2; l4|= 2; }
-        if( y_cst && y0 ) { l1|= 4; l2|= 4; l3|= 4; l4|= 4; }
-        if( x_cst ) { l2|= 2; l4|= 2; l3|= 4; l4|= 4; }
-        if( y_cst ) { l2|= 1; l4|= 1; l3|= 2; l4|= 2; }
-        if( z_cst ) { l2|= 1; l4|= 1; l3|= 4; l4|= 4; }
-        triangles[l1]->push_back(*_it);
-        triangles[l2]->push_back(*_it);
-        triangles[l3]->push_back(*_it);
-        triangles[l4]->push_back(*_it);
-        xm[l1]+= max_x; ym[l1]+= max_y; zm[l1]+= max_z;
-        xm[l2]+= max_x; ym[l2]+= max_y; zm[l2]+= max_z;
-        xm[l3]+= max_x; ym[l3]+= max_y; zm[l3]+= max_z;
-        xm[l4]+= max_x; ym[l4]+= max_y; zm[l4]+= max_z;
-        }
-      else
-        {
-        // gloups on est en diagonal. umps. difffficile.
-        // todo
-        for( i= 0; i < 8; i++ )
-          {
-          triangles[i]->push_back(*_it);
-          xm[i]+= max_x; ym[i]+= max_y; zm[i]+= max_z;
-          }
-        }
-      }
     }
 
   for( i= 0; i < 8; i++ )
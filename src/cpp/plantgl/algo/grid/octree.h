@@ -52,7 +52,9 @@
 
 #include "mvs.h"
 #include "octreenode.h"
+#include "../base/compiledscene.h"
 #include <queue>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -157,7 +159,11 @@ protected:
   /*! Implementation of the triangle based octree sorting.
       with max number of triangles per voxel condition used
       and fast overestimating marking of intercepted voxel
-      based on triangle bounding box */
+      based on triangle bounding box.
+      The scene is compiled once into world space triangles and nodes
+      keep ranges of triangle indices. Once the first levels are
+      decomposed, the subtrees are built in parallel. The nodes are then
+      stored in a pool, the 8 children of a node being contiguous. */
   void build2();
 
   /*! A first implementation of the triangle based octree sorting */
@@ -187,7 +193,27 @@ protected:
   /// The construction method
   ConstructionMethod __method;
 
+  /// Triangles of the scene when built with TriangleBased method.
+  CompiledScenePtr __triangles;
+
+  /// Pool of the nodes other than the root when built with TriangleBased method.
+  std::vector<OctreeNode> __nodes;
+
+  /// Range in __triangleids of the triangles of each node. The root is first, followed by the nodes of the pool.
+  std::vector<std::pair<uint32_t,uint32_t> > __noderanges;
+
+  /// Index in __triangles of the triangles of the leaves.
+  std::vector<uint32_t> __triangleids;
+
 private:
+  /// Remove the results of a previous build.
+  void clear();
+
+  /// Intersection of \e ray with the triangles of \e voxel. Return the closest to the ray origin.
+  bool intersectTriangles( const Ray& ray,
+                           const OctreeNode* voxel,
+                           Vector3& intersection ) const;
+
   Index3ArrayPtr intersect( const TriangleSetPtr& mesh,
                             const OctreeNode* voxel ) const;
 
@@ -59,16 +59,24 @@ OctreeNode::OctreeNode(Tile * Complex,
                        const Vector3& PMax) :
     Voxel(Complex,Scale,Type,Num,PMin,PMax),
     __components(NULL),
+    __pooled(false),
     __objects(){
 }
 
 
 OctreeNode::~OctreeNode(){
-    if(__components) delete [] __components;
+    if(__components && !__pooled) delete [] __components;
 }
 
 bool OctreeNode::setComponents(OctreeNode * _components){
     __components =_components;
+    __pooled = false;
+    return true;
+}
+
+bool OctreeNode::setPooledComponents(OctreeNode * _components){
+    __components =_components;
+    __pooled = true;
     return true;
 }
 
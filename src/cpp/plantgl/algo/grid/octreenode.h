@@ -93,6 +93,12 @@ class ALGO_API OctreeNode : public Voxel {
         - \e the number of components must be equal to 8. */
      bool setComponents(OctreeNode * _components);
 
+     /** Set components \e _components to \e self without taking their ownership.
+        They belong to a pool of nodes that outlives \e self.
+        \pre
+        - \e the number of components must be equal to 8. */
+     bool setPooledComponents(OctreeNode * _components);
+
      virtual uchar_t getComponentsSize() const {
         return (__components ? uchar_t(8) : uchar_t(0));
      }
@@ -190,6 +196,9 @@ protected :
   /// Components of \e self.
   OctreeNode * __components;
 
+  /// Whether components are owned by a pool and not deleted with \e self.
+  bool __pooled;
+
   /// Object contains in the node
   ScenePtr __objects;
 
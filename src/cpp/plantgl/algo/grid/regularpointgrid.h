@@ -213,11 +213,19 @@ SpatialArrayN<std::vector<size_t>,typename PointContainer::element_type,NbDimens
 
     PointIndexList query_points_in_cone(const VectorType& coneorigin, const VectorType& conedirection,
                                        real_t coneradius,  real_t coneangle = GEOM_HALF_PI) const{
-        VectorType mdirection = conedirection.normed();
-        VoxelIdList voxels = this->query_voxels_in_cone(coneorigin,mdirection,coneradius,coneangle);
-        PointIndexList res;
+        return query_points_in_cones(coneorigin, std::vector<VectorType>(1, conedirection), coneradius, coneangle)[0];
+    }
+
+    /// Points in each of the cones of same origin, radius and angle. Same result as successive calls to query_points_in_cone.
+    std::vector<PointIndexList> query_points_in_cones(const VectorType& coneorigin, const std::vector<VectorType>& conedirections,
+                                       real_t coneradius,  real_t coneangle = GEOM_HALF_PI) const{
+        std::vector<VoxelIdList> conevoxels = this->query_voxels_in_cones(coneorigin,conedirections,coneradius,coneangle);
+        std::vector<PointIndexList> res(conedirections.size());
         real_t cosconeangle = cos(coneangle / 2);
-        for(typename VoxelIdList::const_iterator itvoxel = voxels.begin(); itvoxel != voxels.end(); ++itvoxel){
+        for(size_t d = 0; d < conedirections.size(); ++d){
+          VectorType mdirection = conedirections[d].normed();
+          const VoxelIdList& voxels = conevoxels[d];
+          for(typename VoxelIdList::const_iterator itvoxel = voxels.begin(); itvoxel != voxels.end(); ++itvoxel){
             const PointIndexList& voxelpointlist = Base::getAt(*itvoxel);
             if(!voxelpointlist.empty()){
               for(typename PointIndexList::const_iterator itPointIndex = voxelpointlist.begin(); itPointIndex != voxelpointlist.end(); ++itPointIndex){
@@ -225,9 +233,10 @@ SpatialArrayN<std::vector<size_t>,typename PointContainer::element_type,NbDimens
                 VectorType pointtoconeorigin = points().getAt(*itPointIndex)-coneorigin;
                 real_t dist = pointtoconeorigin.normalize();
                 if ((dist <= coneradius + GEOM_EPSILON) && (dot(pointtoconeorigin,mdirection) > (cosconeangle - GEOM_EPSILON)))
-                    res.push_back(*itPointIndex);
+                    res[d].push_back(*itPointIndex);
               }
             }
+          }
         }
         return res;
     }
@@ -295,28 +304,29 @@ SpatialArrayN<std::vector<size_t>,typename PointContainer::element_type,NbDimens
     }
 
 
+    /// Remove point pid from its voxel list. The last point of the voxel list takes its place.
     bool disable_point(PointIndex pid) {
-        VectorType point = points().getAt(pid);
-        PointIndexList& voxelpointlist = this->getAt(this->cellIdFromPoint(point));
-        typename PointIndexList::iterator itPointIndex = std::find(voxelpointlist.begin(),voxelpointlist.end(),pid);
-        if (itPointIndex != voxelpointlist.end()) { voxelpointlist.erase(itPointIndex); return true; }
-        return false;
+        if (!is_point_enabled(pid)) return false;
+        PointIndexList& voxelpointlist = this->getAt(this->cellIdFromPoint(points().getAt(pid)));
+        PointIndex slot = __pointslots[pid];
+        PointIndex lastpid = voxelpointlist.back();
+        voxelpointlist[slot] = lastpid;
+        __pointslots[lastpid] = slot;
+        voxelpointlist.pop_back();
+        __pointslots[pid] = NOSLOT;
+        return true;
     }
 
     bool enable_point(PointIndex pid) {
-        VectorType point = points().getAt(pid);
-        PointIndexList& voxelpointlist = this->getAt(this->cellIdFromPoint(point));
-        typename PointIndexList::const_iterator itPointIndex = std::find(voxelpointlist.begin(),voxelpointlist.end(),pid);
-        if (itPointIndex == voxelpointlist.end()) { voxelpointlist.push_back(pid); return true; }
-        return false;
+        if (pid >= __pointslots.size() || __pointslots[pid] != NOSLOT) return false;
+        PointIndexList& voxelpointlist = this->getAt(this->cellIdFromPoint(points().getAt(pid)));
+        __pointslots[pid] = voxelpointlist.size();
+        voxelpointlist.push_back(pid);
+        return true;
     }
 
-    bool is_point_enabled(PointIndex pid) const {
-        VectorType point = points().getAt(pid);
-        const PointIndexList& voxelpointlist = this->getAt(this->cellIdFromPoint(point));
-        typename PointIndexList::const_iterator itPointIndex = std::find(voxelpointlist.begin(),voxelpointlist.end(),pid);
-        if (itPointIndex == voxelpointlist.end()) { return false; }
-        return true;
+    inline bool is_point_enabled(PointIndex pid) const {
+        return pid < __pointslots.size() && __pointslots[pid] != NOSLOT;
     }
 
     inline void disable_points(const PointIndexList& pids)
@@ -416,15 +426,24 @@ SpatialArrayN<std::vector<size_t>,typename PointContainer::element_type,NbDimens
         PointIndex pid = points().size();
         ContainerPolicy::__points.push_back(point);
         VoxelId vid = this->cellIdFromPoint(point);
+        if (__pointslots.size() <= pid) __pointslots.resize(pid+1, PointIndex(NOSLOT));
+        __pointslots[pid] = this->getAt(vid).size();
         this->getAt(vid).push_back(pid);
         return pid;
     }
 
 protected:
+    static const PointIndex NOSLOT = PointIndex(-1);
+
+    // position of each point in its voxel list, or NOSLOT if the point is disabled.
+    std::vector<PointIndex> __pointslots;
+
     template<class Iterator>
     inline void registerData(Iterator beg, Iterator end, PointIndex startingindex){
         for(Iterator it = beg; it != end; ++it){
             VoxelId vid = this->cellIdFromPoint(*it);
+            if (__pointslots.size() <= startingindex) __pointslots.resize(startingindex+1, PointIndex(NOSLOT));
+            __pointslots[startingindex] = this->getAt(vid).size();
             this->getAt(vid).push_back(startingindex);
             startingindex++;
         }
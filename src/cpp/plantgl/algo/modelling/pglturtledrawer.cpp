@@ -145,7 +145,73 @@ AppearancePtr PglTurtle::getCurrentInitialMaterial() const{
 }
 */
 
-void  PglTurtleDrawer::reset() { __scene = ScenePtr(new Scene()); }
+void  PglTurtleDrawer::reset() {
+    __scene = ScenePtr(new Scene());
+    if (is_valid_ptr(__instances)) __instances = InstancedScenePtr(new InstancedScene());
+}
+
+const ScenePtr& PglTurtleDrawer::getScene() const
+{
+    if (is_null_ptr(__instances)) return __scene;
+    return __instances->getScene();
+}
+
+void PglTurtleDrawer::setInstancing(bool enabled)
+{
+    if (enabled == isInstancing()) return;
+    if (enabled) {
+        // shapes already drawn become instances, before the next ones.
+        __instances = InstancedScenePtr(new InstancedScene());
+        for (Scene::const_iterator it = __scene->begin(); it != __scene->end(); ++it) {
+            ShapePtr shape = dynamic_pointer_cast<Shape>(*it);
+            if (is_valid_ptr(shape)) __instances->add(shape);
+        }
+        __scene = ScenePtr(new Scene());
+    }
+    else {
+        __scene = ScenePtr(new Scene(*__instances->getScene()));
+        __instances = InstancedScenePtr();
+    }
+}
+
+GeometryPtr PglTurtleDrawer::getPrototype(PrototypeType type, uint_t sectionResolution)
+{
+    if (type == eSpherePrototype && sectionResolution == Cylinder::DEFAULT_SLICES) {
+        if (is_null_ptr(DEFAULT_SPHERE)) DEFAULT_SPHERE = GeometryPtr(new Sphere(1));
+        return DEFAULT_SPHERE;
+    }
+    GeometryPtr& prototype = __prototypes[std::pair<int,uint_t>(type, sectionResolution)];
+    if (is_null_ptr(prototype)) {
+        switch (type) {
+            case eCylinderPrototype:
+                prototype = GeometryPtr(new Cylinder(1, 1, false, sectionResolution));
+                break;
+            case eConePrototype:
+                prototype = GeometryPtr(new Cone(1, 1, false, sectionResolution));
+                break;
+            case eSpherePrototype:
+                prototype = GeometryPtr(new Sphere(1, sectionResolution, sectionResolution));
+                break;
+        }
+    }
+    return prototype;
+}
+
+bool PglTurtleDrawer::_addInstance(const GeometryPtr& prototype, const FrameInfo& frameinfo, const Vector3& scale, const id_pair ids, AppearancePtr app)
+{
+    // screen projected and mirrored primitives are kept in the scene.
+    if (is_null_ptr(__instances) || frameinfo.screenprojection) return false;
+    if (scale.x() < GEOM_EPSILON || scale.y() < GEOM_EPSILON || scale.z() < GEOM_EPSILON) return false;
+
+    // same frame as transform(): Oriented(up,-left) then Translated(position).
+    Vector3 secondary(-frameinfo.left);
+    Matrix4 transformation(frameinfo.up * scale.x(),
+                           secondary * scale.y(),
+                           direction(cross(frameinfo.up, secondary)) * scale.z(),
+                           frameinfo.position);
+    __instances->add(prototype, transformation, app, ids.id, ids.parent_id);
+    return true;
+}
 
 void PglTurtleDrawer::customGeometry(const id_pair ids,
                                 AppearancePtr appearance,
@@ -157,7 +223,8 @@ void PglTurtleDrawer::customGeometry(const id_pair ids,
         PlanarModelPtr _2Dtest = dynamic_pointer_cast<PlanarModel>(smb); 
         if (is_valid_ptr(_2Dtest) && frameinfo.screenprojection)
             _addToScene(transform(frameinfo, GeometryPtr(new Oriented(Vector3(0,1,0),Vector3(0,0,1),GeometryPtr(new Scaled(frameinfo.scaling*scale,smb))))), ids, appearance, frameinfo.screenprojection);
-        else    _addToScene(transform(frameinfo, GeometryPtr(new Scaled(frameinfo.scaling*scale,smb))), ids, appearance, frameinfo.screenprojection);
+        else if (!_addInstance(smb, frameinfo, frameinfo.scaling*scale, ids, appearance))
+                _addToScene(transform(frameinfo, GeometryPtr(new Scaled(frameinfo.scaling*scale,smb))), ids, appearance, frameinfo.screenprojection);
     }
 }
 
@@ -193,7 +260,8 @@ void PglTurtleDrawer::_addToScene(const GeometryPtr geom, id_pair ids, Appearanc
     if (projection)
       mgeom = GeometryPtr(new ScreenProjected(GeometryPtr(new Oriented(Vector3(0,0,1),Vector3(1,0,0),mgeom)),false));
 
-    __scene->add(Shape3DPtr(new Shape(mgeom, app, ids.id, ids.parent_id)));
+    if (is_valid_ptr(__instances)) __instances->add(ShapePtr(new Shape(mgeom, app, ids.id, ids.parent_id)));
+    else __scene->add(Shape3DPtr(new Shape(mgeom, app, ids.id, ids.parent_id)));
 }
 
 void PglTurtleDrawer::frustum(id_pair ids,
@@ -211,10 +279,15 @@ void PglTurtleDrawer::frustum(id_pair ids,
         if (frameinfo.scaling !=  Vector3(1,1,1) &&
             (frameinfo.scaling.x() == frameinfo.scaling.y()))
             baseradius *= frameinfo.scaling.x();
-        if (FABS(taper) < GEOM_EPSILON)
+        Vector3 scale(baseradius, baseradius, length*frameinfo.scaling.z());
+        if (FABS(taper) < GEOM_EPSILON) {
+            if (_addInstance(getPrototype(eConePrototype, sectionResolution), frameinfo, scale, ids, appearance)) return;
             a = GeometryPtr(new Cone(baseradius,length*frameinfo.scaling.z(), false, sectionResolution));
-        else if (FABS(taper-1.0) < GEOM_EPSILON)
+        }
+        else if (FABS(taper-1.0) < GEOM_EPSILON) {
+            if (_addInstance(getPrototype(eCylinderPrototype, sectionResolution), frameinfo, scale, ids, appearance)) return;
             a = GeometryPtr(new Cylinder(baseradius, length*frameinfo.scaling.z(), false, sectionResolution));
+        }
         else
             a = GeometryPtr(new Frustum(baseradius, length*frameinfo.scaling.z(), taper, false, sectionResolution));
 
@@ -260,7 +333,9 @@ void PglTurtleDrawer::cylinder(const id_pair ids,
         if ( frameinfo.scaling !=  Vector3(1,1,1) &&
             (frameinfo.scaling.x() == frameinfo.scaling.y()))
             radius *= frameinfo.scaling.x();
-        _addToScene(transform(frameinfo, GeometryPtr(new Cylinder(radius, length*frameinfo.scaling.z(), false, sectionResolution))), ids, appearance, frameinfo.screenprojection);
+        if (!_addInstance(getPrototype(eCylinderPrototype, sectionResolution), frameinfo,
+                          Vector3(radius, radius, length*frameinfo.scaling.z()), ids, appearance))
+            _addToScene(transform(frameinfo, GeometryPtr(new Cylinder(radius, length*frameinfo.scaling.z(), false, sectionResolution))), ids, appearance, frameinfo.screenprojection);
       }
   }
 }
@@ -361,7 +436,8 @@ void PglTurtleDrawer::sphere(const id_pair ids,
                         uint_t sectionResolution) {
   if (sectionResolution == Cylinder::DEFAULT_SLICES){
       if (is_null_ptr(DEFAULT_SPHERE))DEFAULT_SPHERE = GeometryPtr(new Sphere(1));
-      _addToScene(transform(frameinfo, GeometryPtr(new Scaled(frameinfo.scaling * radius,DEFAULT_SPHERE))), ids, appearance, frameinfo.screenprojection);
+      if (!_addInstance(DEFAULT_SPHERE, frameinfo, frameinfo.scaling * radius, ids, appearance))
+        _addToScene(transform(frameinfo, GeometryPtr(new Scaled(frameinfo.scaling * radius,DEFAULT_SPHERE))), ids, appearance, frameinfo.screenprojection);
 
   }
   else {
@@ -372,6 +448,9 @@ void PglTurtleDrawer::sphere(const id_pair ids,
       {
             anisotropicscaling = false;
       }
+      real_t sphereradius = (anisotropicscaling ? radius * frameinfo.scaling.x() : radius);
+      if (_addInstance(getPrototype(eSpherePrototype, sectionResolution), frameinfo, Vector3(sphereradius, sphereradius, sphereradius), ids, appearance))
+            return;
       if (anisotropicscaling)
             _addToScene(transform(frameinfo, GeometryPtr(new Sphere(radius * frameinfo.scaling.x(), sectionResolution,sectionResolution))), ids, appearance, frameinfo.screenprojection);
       else
@@ -563,6 +642,12 @@ ScenePtr PglTurtleDrawer::partialView(const id_pair ids,
                                       std::vector<real_t>& radiusList,
                                       TurtleDrawParameter& initial) {
     ScenePtr currentscene = new Scene(*__scene);
+    // the partial view is drawn in a copy of the scene, out of the instances.
+    InstancedScenePtr currentinstances = __instances;
+    if (is_valid_ptr(__instances)) {
+        __scene = ScenePtr(new Scene(*__instances->getScene()));
+        __instances = InstancedScenePtr();
+    }
     if(generalizedCylinderOn && pointList->size() > 1){
         this->generalizedCylinder(ids, appearance, frameinfo, pointList, leftList, radiusList, initial.crossSection, initial.crossSectionCCW, sectionResolution);
     }
@@ -570,6 +655,7 @@ ScenePtr PglTurtleDrawer::partialView(const id_pair ids,
     frame(ids, frameinfo, 0, 0, 0, 0, 0, 0, 0);
     ScenePtr result = __scene;
     __scene = currentscene;
+    __instances = currentinstances;
     return result;
 }
 
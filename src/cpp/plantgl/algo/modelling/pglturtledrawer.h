@@ -47,6 +47,8 @@
 #include <plantgl/scenegraph/geometry/polyline.h>
 #include <plantgl/scenegraph/appearance/material.h>
 #include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/algo/base/instancedscene.h>
+#include <map>
 
 
 PGL_BEGIN_NAMESPACE
@@ -64,8 +66,19 @@ public:
 
     virtual ~PglTurtleDrawer();
 
-    const ScenePtr& getScene() const
-    { return __scene;  }
+    /// Return the drawn scene. In instancing mode, it is built from the instances at the first call after a modification.
+    const ScenePtr& getScene() const;
+
+    /** In instancing mode, cylinders, cones, spheres and custom geometries are recorded
+        in getInstances() as instances of shared prototypes. Other shapes, and primitives drawn with
+        screen projection or negative dimensions, are recorded in getInstances() as single instances
+        of their geometry, so that the instances keep the drawing order. */
+    void setInstancing(bool enabled);
+
+    inline bool isInstancing() const { return is_valid_ptr(__instances); }
+
+    /// Instances drawn in instancing mode.
+    inline const InstancedScenePtr& getInstances() const { return __instances; }
 
     virtual void  reset();
 
@@ -194,8 +207,19 @@ protected:
 
     void _addToScene(const GeometryPtr geom, const id_pair ids, AppearancePtr app = NULL, bool projection = false);
 
+    enum PrototypeType { eCylinderPrototype, eConePrototype, eSpherePrototype };
+
+    /// Return a primitive of unit dimensions shared by all the instances of same type and resolution.
+    GeometryPtr getPrototype(PrototypeType type, uint_t sectionResolution);
+
+    /// Add an instance of prototype scaled by scale along its axes and placed in the turtle frame. Return false if not in instancing mode.
+    bool _addInstance(const GeometryPtr& prototype, const FrameInfo& frameinfo, const Vector3& scale, const id_pair ids, AppearancePtr app);
+
     ScenePtr __scene;
 
+    InstancedScenePtr __instances;
+    std::map<std::pair<int,uint_t>, GeometryPtr> __prototypes;
+
 };
 
 typedef RCPtr<PglTurtleDrawer> PglTurtleDrawerPtr;
@@ -41,8 +41,10 @@
 
 #include "spacecolonization.h"
 #include "../base/pointmanipulation.h"
+#include "../base/parallelexecutor.h"
 #include <plantgl/scenegraph/container/indexarray_iterator.h>
 #include <plantgl/math/util_math.h>
+#include <plantgl/tool/util_profiler.h>
 
 PGL_USING_NAMESPACE
 
@@ -72,6 +74,11 @@ SpaceColonization::SpaceColonization(const Point3ArrayPtr _attractors,
     skeletonnodes(initialskeletonnodes),
     skeletonparents(initialskeletonparents),
     active_nodes(_active_nodes),
+    nbresolvedbuds(0),
+    perceptions_radius(0),
+    perceptions_coneangle(0),
+    perceptions_insertion_angle(0),
+    perceptions_nb_buds_per_whorl(0),
     nbIteration(0)
 {
    if(!is_null_ptr(skeletonnodes) && active_nodes.size() == 0)
@@ -97,6 +104,11 @@ SpaceColonization::SpaceColonization(const Point3ArrayPtr _attractors,
     skeletonparents(),
     nodeattractors(),
     active_nodes(),
+    nbresolvedbuds(0),
+    perceptions_radius(0),
+    perceptions_coneangle(0),
+    perceptions_insertion_angle(0),
+    perceptions_nb_buds_per_whorl(0),
     nbIteration(0)
 {
     add_node(root);
@@ -187,23 +199,87 @@ SpaceColonization::lateral_directions(const Vector3& dir, real_t angle, int nb){
     return result;
 }
 
-void SpaceColonization::generate_buds(size_t pid) {
-    Vector3 pos = node_position(pid);
+std::vector<Vector3> SpaceColonization::bud_directions(size_t pid) {
     Vector3 dir = node_direction(pid);
     std::vector<Vector3> lateral_dirs = lateral_directions(dir, insertion_angle, nb_buds_per_whorl);
     lateral_dirs.push_back(dir);
+    return lateral_dirs;
+}
 
-    for(std::vector<Vector3>::const_iterator itldir = lateral_dirs.begin(); itldir != lateral_dirs.end(); ++itldir)
+void SpaceColonization::generate_buds(size_t pid) {
+    PerceptionMap::const_iterator itnode = perceptions.find(pid);
+    if (itnode != perceptions.end() && perceptions_are_valid(true)) {
+        // use the attractors perceived in parallel in each bud direction
+        for(PerceptionList::const_iterator itp = itnode->second.begin(); itp != itnode->second.end(); ++itp)
+            try_to_set_bud_with_attractors(pid, itp->first, itp->second);
+        return;
+    }
+
+    std::vector<Vector3> dirs = bud_directions(pid);
+
+    for(std::vector<Vector3>::const_iterator itldir = dirs.begin(); itldir != dirs.end(); ++itldir)
     {
         // generate a bud
         try_to_set_bud(pid, *itldir);
     }
 }
 
+void SpaceColonization::perceive_attractors()
+{
+    PGL_PROFILE_ZONE("SpaceColonization::perceive_attractors");
+    perceptions.clear();
+    std::vector<PerceptionList> perceived(active_nodes.size());
+
+    // the grid is only read during this phase. Each active node fills its own slot.
+    ParallelExecutor::get().parallel_for_each(0, active_nodes.size(), [this, &perceived](size_t i) {
+        size_t pid = active_nodes[i];
+        std::vector<Vector3> dirs = bud_directions(pid);
+        if (dirs.empty()) return;
+        std::vector<AttractorList> attractorlists = attractor_grid->query_points_in_cones(node_position(pid), dirs, perception_radius, coneangle);
+        PerceptionList& result = perceived[i];
+        result.reserve(dirs.size());
+        for(size_t d = 0; d < dirs.size(); ++d){
+            result.push_back(PerceptionList::value_type(dirs[d], AttractorList()));
+            result.back().second.swap(attractorlists[d]);
+        }
+    });
+
+    for(size_t i = 0; i < active_nodes.size(); ++i)
+        if (!perceived[i].empty()) perceptions[active_nodes[i]].swap(perceived[i]);
+
+    perceptions_radius = perception_radius;
+    perceptions_coneangle = coneangle;
+    perceptions_insertion_angle = insertion_angle;
+    perceptions_nb_buds_per_whorl = nb_buds_per_whorl;
+}
+
+bool SpaceColonization::perceptions_are_valid(bool checkdirections) const
+{
+    if (perceptions_radius != perception_radius || perceptions_coneangle != coneangle) return false;
+    if (checkdirections && (perceptions_insertion_angle != insertion_angle || perceptions_nb_buds_per_whorl != nb_buds_per_whorl)) return false;
+    return true;
+}
+
+const SpaceColonization::AttractorList *
+SpaceColonization::find_perception(size_t pid, const Vector3& direction) const
+{
+    PerceptionMap::const_iterator itnode = perceptions.find(pid);
+    if (itnode == perceptions.end() || !perceptions_are_valid(false)) return NULL;
+    for(PerceptionList::const_iterator itp = itnode->second.begin(); itp != itnode->second.end(); ++itp)
+        if (itp->first == direction) return &itp->second;
+    return NULL;
+}
+
 bool SpaceColonization::try_to_set_bud(size_t pid, const Vector3& direction)
 {
     // find nearest attractor points in cone of perception of given radius and angle
-    AttractorList neighbour_attractor_indices = attractor_grid->query_points_in_cone(node_position(pid), direction, perception_radius, coneangle);
+    const AttractorList * perceived = find_perception(pid, direction);
+    if (perceived != NULL) return try_to_set_bud_with_attractors(pid, direction, *perceived);
+    return try_to_set_bud_with_attractors(pid, direction, attractor_grid->query_points_in_cone(node_position(pid), direction, perception_radius, coneangle));
+}
+
+bool SpaceColonization::try_to_set_bud_with_attractors(size_t pid, const Vector3& direction, const AttractorList& neighbour_attractor_indices)
+{
     if (neighbour_attractor_indices.size() >= min_nb_pt_per_bud) {
         // generate a bud
         add_bud(pid, direction, neighbour_attractor_indices);
@@ -217,14 +293,12 @@ void SpaceColonization::add_bud(size_t pid, const Vector3& direction, const Attr
 {
     Uint32ArrayPtr attlist(new Uint32Array1(attractors.begin(),attractors.end()));
     budlist.push_back(Bud(pid,direction,attlist));
-    register_attractors(node_position(pid), attlist);
 }
 
 void SpaceColonization::add_bud(size_t pid, const AttractorList& attractors, real_t level)
 {
     Uint32ArrayPtr attlist(new Uint32Array1(attractors.begin(),attractors.end()));
     budlist.push_back(Bud(pid,attlist,level));
-    register_attractors(node_position(pid), attlist);
 }
 
 void SpaceColonization::add_latent_bud(size_t pid, const AttractorList& attractors, real_t level, uint32_t latency)
@@ -235,11 +309,14 @@ void SpaceColonization::add_latent_bud(size_t pid, const AttractorList& attracto
 }
 
 void SpaceColonization::generate_all_buds() {
+    PGL_PROFILE_ZONE("SpaceColonization::generate_all_buds");
     budlist.clear();
-    attractormap.clear();
+    nbresolvedbuds = 0;
     LatentBudList previouslatentbudlist = latentbudlist;
     latentbudlist.clear();
 
+    if (uses_perceptions()) perceive_attractors();
+
     for(Index::const_iterator it = active_nodes.begin(); it != active_nodes.end(); ++it){
         node_buds_preprocess(*it);
         generate_buds(*it);
@@ -252,49 +329,45 @@ void SpaceColonization::generate_all_buds() {
                 it->first.attractors = Uint32ArrayPtr(new Uint32Array1(attractor_grid->filter_disabled(*(it->first.attractors))));
 
                 budlist.push_back(it->first);
-                register_attractors(node_position(it->first.pid), it->first.attractors);
             }
             else latentbudlist.push_back(std::pair<Bud,uint32_t>(it->first,it->second-1));
         }
     }
 
-    attractormap.clear();
+    perceptions.clear();
+    resolve_attractors_competition();
     active_nodes.clear();
 }
 
-void SpaceColonization::register_attractors(const Vector3& pos, Uint32ArrayPtr attlist)
+void SpaceColonization::resolve_attractors_competition()
 {
-    size_t aid = 0;
-    std::vector<size_t> todelete;
-    for(Uint32Array1::const_iterator it = attlist->begin(); it != attlist->end(); ++it, ++aid)
+    PGL_PROFILE_ZONE("SpaceColonization::resolve_attractors_competition");
+    // Each attractor goes to the closest bud. On equal distance, the last bud wins,
+    // as if the buds had claimed their attractors one after the other.
+    typedef pgl_hash_map<size_t, std::pair<real_t, size_t> > AttractorOwnerMap;
+    AttractorOwnerMap owners;
+    for(size_t bid = nbresolvedbuds; bid < budlist.size(); ++bid)
     {
-        real_t dist = norm(pos-attractors->getAt(*it));
-        AttractorMap::iterator itmap = attractormap.find(*it);
-        std::pair<Uint32ArrayPtr,real_t> info;
-        if (itmap != attractormap.end()){
-            // Competition
-            if (dist > itmap->second.second) {
-                info = itmap->second;
-
-                // remove from this bud
-                todelete.push_back(aid);
-            }
-            else {
-                info = std::pair<Uint32ArrayPtr,real_t>(attlist,dist);
-
-                // remove from previous bud
-                Uint32ArrayPtr prevattlist = itmap->second.first;
-                Uint32Array1::iterator itd = std::find(prevattlist->begin(), prevattlist->end(), *it);
-                prevattlist->erase(itd);
-            }
-        }
-        else {
-            info = std::pair<Uint32ArrayPtr,real_t>(attlist,dist);
+        const Vector3& pos = node_position(budlist[bid].pid);
+        const Uint32ArrayPtr& attlist = budlist[bid].attractors;
+        for(Uint32Array1::const_iterator it = attlist->begin(); it != attlist->end(); ++it)
+        {
+            real_t dist = norm(pos-attractors->getAt(*it));
+            std::pair<AttractorOwnerMap::iterator, bool> itmap = owners.insert(AttractorOwnerMap::value_type(*it, std::pair<real_t, size_t>(dist, bid)));
+            if (!itmap.second && !(dist > itmap.first->second.first))
+                itmap.first->second = std::pair<real_t, size_t>(dist, bid);
         }
-        attractormap[*it] = info;
     }
-    for(std::vector<size_t>::const_reverse_iterator itdel = todelete.rbegin(); itdel != todelete.rend(); ++itdel)
-        attlist->erase(attlist->begin()+*itdel);
+
+    for(size_t bid = nbresolvedbuds; bid < budlist.size(); ++bid)
+    {
+        Uint32ArrayPtr attlist = budlist[bid].attractors;
+        Uint32Array1::iterator itkept = attlist->begin();
+        for(Uint32Array1::const_iterator it = attlist->begin(); it != attlist->end(); ++it)
+            if (owners[*it].second == bid) *itkept++ = *it;
+        attlist->erase(itkept, attlist->end());
+    }
+    nbresolvedbuds = budlist.size();
 }
 
 void SpaceColonization::process_bud(const Bud& bud)
@@ -317,6 +390,10 @@ void SpaceColonization::process_bud(const Bud& bud)
 
 void SpaceColonization::growth()
 {
+    PGL_PROFILE_ZONE("SpaceColonization::growth");
+    // buds added after generate_all_buds still compete for their attractors.
+    if (nbresolvedbuds < budlist.size()) resolve_attractors_competition();
+
     if (!budlist.empty()){
         size_t cparent = budlist[0].pid;
         node_child_preprocess(cparent);
@@ -335,11 +412,13 @@ void SpaceColonization::growth()
         }
         node_child_postprocess(cparent, Index(active_nodes.begin()+nbactivenode,active_nodes.end()));
         budlist.clear();
+        nbresolvedbuds = 0;
     }
 }
 
 void SpaceColonization::step()
 {
+    PGL_PROFILE_ZONE("SpaceColonization::step");
     StartEach();
     generate_all_buds();
     growth();
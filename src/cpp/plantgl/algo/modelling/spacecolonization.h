@@ -60,8 +60,6 @@ class ALGO_API SpaceColonization : public RefCountObject {
 
     protected:
 
-      void register_attractors(const Vector3& pos, Uint32ArrayPtr attlist);
-
         struct Bud {
             size_t pid;
             Vector3 direction;
@@ -89,8 +87,30 @@ class ALGO_API SpaceColonization : public RefCountObject {
         BudList budlist;
         LatentBudList latentbudlist;
 
-        typedef pgl_hash_map<size_t, std::pair<Uint32ArrayPtr, real_t> > AttractorMap;
-        AttractorMap attractormap;
+        // number of buds of budlist whose attractors competition is already resolved.
+        size_t nbresolvedbuds;
+
+        // attractors perceived by the active nodes in each of their bud directions.
+        // Computed in parallel at the beginning of generate_all_buds with the grid and parameters of that time.
+        typedef std::vector<std::pair<Vector3, AttractorList> > PerceptionList;
+        typedef pgl_hash_map<size_t, PerceptionList> PerceptionMap;
+        PerceptionMap perceptions;
+        real_t perceptions_radius;
+        real_t perceptions_coneangle;
+        real_t perceptions_insertion_angle;
+        size_t perceptions_nb_buds_per_whorl;
+
+        void perceive_attractors();
+        // whether generate_buds uses the perceptions. Otherwise they are not computed.
+        virtual bool uses_perceptions() const { return true; }
+        // whether perceptions are still valid for the current parameters (that node_buds_preprocess may change).
+        bool perceptions_are_valid(bool checkdirections) const;
+        const AttractorList * find_perception(size_t pid, const Vector3& direction) const;
+
+        bool try_to_set_bud_with_attractors(size_t pid, const Vector3& direction, const AttractorList& neighbour_attractor_indices);
+
+        /// give each attractor claimed by several of the new buds to the closest one.
+        void resolve_attractors_competition();
 
     public:
 
@@ -116,19 +136,20 @@ class ALGO_API SpaceColonization : public RefCountObject {
 
     size_t add_node(const Vector3& position, size_t parent = NOID, const Index& attractors = Index(), bool active = true);
 
+    // nodes are read through const arrays, which perceive_attractors() does from several threads.
     inline Vector3 node_direction(size_t pid) const {
-        size_t parent = skeletonparents->getAt(pid);
+        size_t parent = const_array(*skeletonparents).getAt(pid);
         if (parent == NOID || parent == pid) return Vector3::OZ;
-        return direction(skeletonnodes->getAt(pid) - skeletonnodes->getAt(parent));
+        return direction(const_array(*skeletonnodes).getAt(pid) - const_array(*skeletonnodes).getAt(parent));
 
     }
 
     inline const Vector3& node_position(size_t pid) const {
-        return skeletonnodes->getAt(pid);
+        return const_array(*skeletonnodes).getAt(pid);
     }
 
     inline const Index& node_attractors(size_t pid) const {
-        return nodeattractors->getAt(pid);
+        return const_array(*nodeattractors).getAt(pid);
     }
 
     bool try_to_set_bud(size_t pid, const Vector3& direction);
@@ -162,6 +183,9 @@ class ALGO_API SpaceColonization : public RefCountObject {
     /// compute a whorl of 'nb' buds at branching angles.
     std::vector<Vector3> lateral_directions(const Vector3& dir, real_t angle, int nb);
 
+    /// directions in which node 'pid' look for attractors to set its buds.
+    virtual std::vector<Vector3> bud_directions(size_t pid);
+
     virtual void generate_buds(size_t pid) ;
     virtual void process_bud(const Bud& bud);
 
@@ -226,6 +250,9 @@ class ALGO_API GraphColonization : public SpaceColonization {
 
       virtual ~GraphColonization();
 
+      virtual std::vector<Vector3> bud_directions(size_t pid) { return std::vector<Vector3>(); }
+      virtual bool uses_perceptions() const { return false; }
+
       virtual void generate_buds(size_t pid) ;
       virtual void process_bud(const Bud& bud);
 
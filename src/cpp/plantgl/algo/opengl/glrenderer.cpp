@@ -693,7 +693,7 @@ bool GLRenderer::process(AmapSymbol *amapSymbol) {
         __ogl->glColor4fv(_rgba);
       }
 
-      const Index &_index = _indexList->getAt(_i);
+      const Index &_index = const_array(*_indexList).getAt(_i);
       uint_t _sizej = _index.size();
       for (uint_t _j = 0; _j < _sizej; _j++) {
         __ogl->glGeomNormal(amapSymbol->getFaceNormalAt(_i, _j));
@@ -730,8 +730,8 @@ bool GLRenderer::process(AmapSymbol *amapSymbol) {
       __ogl->glTexCoordPointer( 2, GL_GEOM_REAL, sizeof(real_t) ,&texCoord[1]);
     }
 
-    for(IndexArray::const_iterator it = amapSymbol->getIndexList()->begin();
-        it != amapSymbol->getIndexList()->end(); it++)
+    for(IndexArray::const_iterator it = const_array(*amapSymbol->getIndexList()).begin();
+        it != const_array(*amapSymbol->getIndexList()).end(); it++)
       {
         __ogl->glDrawElements( GL_POLYGON, it->size() , GL_UNSIGNED_INT, ( const GLvoid* )( &*( it->begin() ) ));
       }
@@ -907,7 +907,7 @@ bool GLRenderer::process(FaceSet * faceSet) {
         __ogl->glColor4fv(_rgba);
       }
 
-      const Index &_index = _indexList->getAt(_i);
+      const Index &_index = const_array(*_indexList).getAt(_i);
       uint_t _sizej = _index.size();
       for (uint_t _j = 0; _j < _sizej; _j++) {
         if (normalV)__ogl->glGeomNormal(faceSet->getFaceNormalAt(_i, _j));
@@ -948,8 +948,8 @@ bool GLRenderer::process(FaceSet * faceSet) {
     }
 
     size_t _i = 0;
-    for(IndexArray::const_iterator it = faceSet->getIndexList()->begin();
-        it != faceSet->getIndexList()->end(); it++)
+    for(IndexArray::const_iterator it = const_array(*faceSet->getIndexList()).begin();
+        it != const_array(*faceSet->getIndexList()).end(); it++)
       {
         if (!normalV)
       __ogl->glGeomNormal(faceSet->getNormalAt(_i));
@@ -1001,8 +1001,8 @@ bool GLRenderer::process(Extrusion * extrusion) {
 bool GLRenderer::process(Group * group) {
   GEOM_ASSERT_OBJ(group);
   GEOM_GLRENDERER_PRECOMPILE_BEG(group);
-  for (GeometryArray::const_iterator it = group->getGeometryList()->begin();
-      it != group->getGeometryList()->end(); ++it) {
+  for (GeometryArray::const_iterator it = const_array(*group->getGeometryList()).begin();
+      it != const_array(*group->getGeometryList()).end(); ++it) {
 #ifdef GEOM_TREECALLDEBUG
       printf("Look at child of group %zu in mode %i\n", group->getObjectId(),  __compil);
 #endif
@@ -1038,8 +1038,8 @@ bool GLRenderer::process(IFS * ifs) {
 
   __dopushpop = true;
 
-  Matrix4Array::const_iterator matrix = matrixList->begin();
-  while (matrix != matrixList->end())
+  Matrix4Array::const_iterator matrix = const_array(*matrixList).begin();
+  while (matrix != const_array(*matrixList).end())
   {
     GL_PUSH_MATRIX(ifs->getGeometry());
     __ogl->glGeomMultMatrix(*matrix);
@@ -1344,7 +1344,7 @@ bool GLRenderer::process(PointSet * pointSet) {
 
   if(!__withvertexarray){
     Color4Array::const_iterator _itCol;
-    if (color) _itCol = pointSet->getColorList()->begin();
+    if (color) _itCol = const_array(*pointSet->getColorList()).begin();
     GLfloat _rgba[4];
     GLuint index = 0;
 
@@ -1352,7 +1352,7 @@ bool GLRenderer::process(PointSet * pointSet) {
     if (primitiveselection) __ogl->glPushName(0);
     else __ogl->glBegin(GL_POINTS);
 
-    for (Point3Array::const_iterator _i = points->begin(); _i != points->end(); _i++, index++) {
+    for (Point3Array::const_iterator _i = const_array(*points).begin(); _i != const_array(*points).end(); _i++, index++) {
       if (primitiveselection) {
         __ogl->glLoadName(index);
         __ogl->glBegin(GL_POINTS);
@@ -1420,11 +1420,11 @@ bool GLRenderer::process(PGL(Polyline) * polyline) {
 
   if(!__withvertexarray){
     Color4Array::const_iterator _itCol;
-    if (color) _itCol = polyline->getColorList()->begin();
+    if (color) _itCol = const_array(*polyline->getColorList()).begin();
     GLfloat _rgba[4];
     __ogl->glBegin(GL_LINE_STRIP);
-    for (Point3Array::const_iterator _i = points->begin();
-        _i != points->end();
+    for (Point3Array::const_iterator _i = const_array(*points).begin();
+        _i != const_array(*points).end();
         _i++) {
       if (color) {
         const Color4 &_ambient = *_itCol;
@@ -1560,8 +1560,8 @@ bool GLRenderer::process(QuadSet * quadSet) {
     }
     else {
       size_t _i = 0;
-      for(Index4Array::const_iterator it = quadSet->getIndexList()->begin();
-      it != quadSet->getIndexList()->end(); it++) {
+      for(Index4Array::const_iterator it = const_array(*quadSet->getIndexList()).begin();
+      it != const_array(*quadSet->getIndexList()).end(); it++) {
             __ogl->glGeomNormal(quadSet->getNormalAt(_i));_i++;
             __ogl->glDrawElements(   GL_QUADS, 4 , GL_UNSIGNED_INT, it->begin());
       }
@@ -1840,8 +1840,8 @@ bool GLRenderer::process(TriangleSet * triangleSet) {
     // }
     /*else {
       size_t _i = 0;
-      for(Index3Array::const_iterator it = triangleSet->getIndexList()->begin();
-      it != triangleSet->getIndexList()->end(); it++, _i++) {
+      for(Index3Array::const_iterator it = const_array(*triangleSet->getIndexList()).begin();
+      it != const_array(*triangleSet->getIndexList()).end(); it++, _i++) {
             glGeomNormal(triangleSet->getNormalAt(_i));
             glDrawElements(   GL_TRIANGLES, 3 , GL_UNSIGNED_INT, it->begin());
             }
@@ -48,40 +48,232 @@
 #include <plantgl/scenegraph/geometry/triangleset.h>
 #include <plantgl/scenegraph/container/indexarray.h>
 #include <plantgl/algo/base/planeclipping.h>
+#include <plantgl/algo/base/parallelexecutor.h>
+#include <algorithm>
+#include <climits>
 
 /* ----------------------------------------------------------------------- */
 
 PGL_USING_NAMESPACE
 
-DepthSortEngine::DepthSortEngine() :
-    ProjectionEngine()
+// A polygon covering more cells than this is not registered in the cells.
+#define PGL_DEPTHSORT_MAX_CELLS 256
+// Cell size relative to the mean extent of the indexed polygons.
+#define PGL_DEPTHSORT_CELL_FACTOR 2
+
+/* ----------------------------------------------------------------------- */
+
+DepthSortEngine::PolygonStore::PolygonStore(real_t cellsize) :
+    __cellsize(cellsize),
+    __autosize(cellsize <= 0),
+    __extentsum(0),
+    __nbindexed(0),
+    __nextcheck(64),
+    __nextrank(0)
 {
 }
 
-DepthSortEngine::~DepthSortEngine()
+inline real_t polygonextent(const DepthSortEngine::PolygonInfo& polygon)
+{ return std::max(polygon.pmax.x() - polygon.pmin.x(), polygon.pmax.y() - polygon.pmin.y()); }
+
+inline int32_t DepthSortEngine::PolygonStore::_cellcoord(real_t v) const
 {
+    real_t c = floor(v / __cellsize);
+    if (c < -(INT_MAX/2)) return -(INT_MAX/2);
+    if (c > (INT_MAX/2)) return (INT_MAX/2);
+    return int32_t(c);
+}
+
+void DepthSortEngine::PolygonStore::_index(PolygonInfoSet::iterator it)
+{
+    real_t extent = polygonextent(*it);
+    if (__cellsize <= 0) __cellsize = (extent > GEOM_EPSILON ? PGL_DEPTHSORT_CELL_FACTOR * extent : 1);
+    __extentsum += extent;
+    ++__nbindexed;
+
+    it->rank = __nextrank++;
+    it->cxmin = _cellcoord(it->pmin.x()); it->cxmax = _cellcoord(it->pmax.x());
+    it->cymin = _cellcoord(it->pmin.y()); it->cymax = _cellcoord(it->pmax.y());
+    if (uint64_t(it->cxmax - it->cxmin + 1) * uint64_t(it->cymax - it->cymin + 1) > PGL_DEPTHSORT_MAX_CELLS) {
+        it->cxmin = 1; it->cxmax = 0;
+        __large.push_back(it);
+        return;
+    }
+    for (int32_t i = it->cxmin; i <= it->cxmax; ++i)
+        for (int32_t j = it->cymin; j <= it->cymax; ++j)
+            __cells[_cellkey(i,j)].push_back(it);
+}
 
+inline void removefromcell(std::vector<DepthSortEngine::PolygonInfoSet::iterator>& cell, DepthSortEngine::PolygonInfoSet::iterator it)
+{
+    std::vector<DepthSortEngine::PolygonInfoSet::iterator>::iterator pos = std::find(cell.begin(), cell.end(), it);
+    if (pos != cell.end()) {
+        *pos = cell.back();
+        cell.pop_back();
+    }
 }
 
+void DepthSortEngine::PolygonStore::_unindex(PolygonInfoSet::iterator it)
+{
+    __extentsum -= polygonextent(*it);
+    --__nbindexed;
+    if (it->cxmin > it->cxmax) {
+        removefromcell(__large, it);
+        return;
+    }
+    for (int32_t i = it->cxmin; i <= it->cxmax; ++i)
+        for (int32_t j = it->cymin; j <= it->cymax; ++j) {
+            CellMap::iterator cell = __cells.find(_cellkey(i,j));
+            if (cell == __cells.end()) continue;
+            removefromcell(cell->second, it);
+            if (cell->second.empty()) __cells.erase(cell);
+        }
+}
 
-void DepthSortEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid )
+DepthSortEngine::PolygonInfoSet::iterator DepthSortEngine::PolygonStore::append(const PolygonInfo& polygon)
+{
+    PolygonInfoSet::iterator it = __polygons.insert(__polygons.end(), polygon);
+    _index(it);
+    if (__autosize && __nbindexed >= __nextcheck) {
+        // the first polygons may not be representative: adapt the cell size when it is far from the mean extent.
+        real_t cellsize = PGL_DEPTHSORT_CELL_FACTOR * __extentsum / __nbindexed;
+        if (cellsize > GEOM_EPSILON && (cellsize > 4 * __cellsize || 4 * cellsize < __cellsize)) rebuild(cellsize);
+        else __nextcheck = 2 * __nbindexed;
+    }
+    return it;
+}
+
+DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::PolygonStore::append(PolygonInfoList::const_iterator begin, PolygonInfoList::const_iterator end)
+{
+    PolygonInfoIteratorList result;
+    for(PolygonInfoList::const_iterator it = begin; it != end; ++it)
+        result.push_back(append(*it));
+    return result;
+}
+
+void DepthSortEngine::PolygonStore::remove(PolygonInfoSet::iterator it)
+{
+    _unindex(it);
+    __polygons.erase(it);
+}
+
+inline bool boxoverlap(const DepthSortEngine::PolygonInfo& p1, const DepthSortEngine::PolygonInfo& p2)
+{
+    if ((p1.pmin.x() > p2.pmax.x())||(p1.pmax.x() < p2.pmin.x())) { return false; }
+    if ((p1.pmin.y() > p2.pmax.y())||(p1.pmax.y() < p2.pmin.y())) { return false; }
+    return true;
+}
+
+inline bool rankorder(const DepthSortEngine::PolygonInfoSet::iterator& it1, const DepthSortEngine::PolygonInfoSet::iterator& it2)
+{ return it1->rank < it2->rank; }
+
+DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::PolygonStore::intersecting(const PolygonInfo& polygon)
+{
+    PolygonInfoIteratorList result;
+    if (__polygons.empty()) return result;
+
+    int32_t cxmin = _cellcoord(polygon.pmin.x()), cxmax = _cellcoord(polygon.pmax.x());
+    int32_t cymin = _cellcoord(polygon.pmin.y()), cymax = _cellcoord(polygon.pmax.y());
+    uint64_t nbcells = uint64_t(cxmax - cxmin + 1) * uint64_t(cymax - cymin + 1);
+
+    if (nbcells > __cells.size() || nbcells > PGL_DEPTHSORT_MAX_CELLS) {
+        // the query covers most of the grid: a scan of the list is cheaper.
+        for (PolygonInfoSet::iterator it = __polygons.begin(); it != __polygons.end(); ++it)
+            if (boxoverlap(polygon, *it)) result.push_back(it);
+        return result;
+    }
+
+    Cell candidates;
+    for (int32_t i = cxmin; i <= cxmax; ++i)
+        for (int32_t j = cymin; j <= cymax; ++j) {
+            CellMap::const_iterator cell = __cells.find(_cellkey(i,j));
+            if (cell == __cells.end()) continue;
+            for (Cell::const_iterator it = cell->second.begin(); it != cell->second.end(); ++it)
+                if (boxoverlap(polygon, **it)) candidates.push_back(*it);
+        }
+    for (Cell::const_iterator it = __large.begin(); it != __large.end(); ++it)
+        if (boxoverlap(polygon, **it)) candidates.push_back(*it);
+
+    // a polygon is found once per cell it covers. Return them in insertion order.
+    std::sort(candidates.begin(), candidates.end(), rankorder);
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    result.insert(result.end(), candidates.begin(), candidates.end());
+    return result;
+}
+
+void DepthSortEngine::PolygonStore::rebuild(real_t cellsize)
+{
+    __cells.clear();
+    __large.clear();
+    if (cellsize <= 0) {
+        real_t extentsum = 0;
+        for (PolygonInfoSet::const_iterator it = __polygons.begin(); it != __polygons.end(); ++it)
+            extentsum += polygonextent(*it);
+        cellsize = (__polygons.empty() ? 0 : PGL_DEPTHSORT_CELL_FACTOR * extentsum / __polygons.size());
+        if (cellsize <= GEOM_EPSILON && !__polygons.empty()) cellsize = 1;
+    }
+    __cellsize = cellsize;
+    __extentsum = 0;
+    __nbindexed = 0;
+    __nextrank = 0;
+    for (PolygonInfoSet::iterator it = __polygons.begin(); it != __polygons.end(); ++it)
+        _index(it);
+    __nextcheck = std::max<size_t>(64, 2 * __nbindexed);
+}
+
+void DepthSortEngine::PolygonStore::clear()
+{
+    __polygons.clear();
+    __cells.clear();
+    __large.clear();
+    if (__autosize) __cellsize = 0;
+    __extentsum = 0;
+    __nbindexed = 0;
+    __nextcheck = 64;
+    __nextrank = 0;
+}
+
+void DepthSortEngine::PolygonStore::merge(std::vector<PolygonStore>& parts)
+{
+    for (std::vector<PolygonStore>::iterator it = parts.begin(); it != parts.end(); ++it) {
+        __polygons.splice(__polygons.end(), it->__polygons);
+        it->clear();
+    }
+    rebuild(__autosize ? 0 : __cellsize);
+}
+
+/* ----------------------------------------------------------------------- */
+
+DepthSortEngine::DepthSortEngine() :
+    ProjectionEngine(),
+    __polygons(),
+    __pending(),
+    __deferred(false),
+    __parallelThreshold(1024)
 {
-	#ifdef PGL_WITH_CGAL
+}
 
-    /*
-    const Point3ArrayPtr points(triangles->getPointList());
-    const Index3ArrayPtr indices(triangles->getIndexList());
+DepthSortEngine::~DepthSortEngine()
+{
 
-    bool ccw = triangles->getCCW();
+}
 
-    triangles->checkNormalList();
+void DepthSortEngine::beginProcess()
+{
+    __deferred = true;
+}
 
-    bool hasColor = triangles->hasColorList();
-    */
+void DepthSortEngine::endProcess()
+{
+    __deferred = false;
+    _resolvePending();
+}
+
+void DepthSortEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid )
+{
     size_t nbfaces = triangles->getIndexListSize();
 
     for(uint32_t itidx = 0; itidx < nbfaces; ++itidx){
-        //printf("triangle %i on %i\n", itidx, nbfaces);
         const Vector3& v0 = triangles->getFacePointAt(itidx,0);
         const Vector3& v1 = triangles->getFacePointAt(itidx,1);
         const Vector3& v2 = triangles->getFacePointAt(itidx,2);
@@ -89,8 +281,6 @@ void DepthSortEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearanc
         processTriangle(v0, v1, v2, id);
 
     }  
-
-	#endif
 }
 
 void DepthSortEngine::iprocess(PolylinePtr polyline, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid )
@@ -103,8 +293,142 @@ void DepthSortEngine::iprocess(PointSetPtr pointset, MaterialPtr material, uint3
 
 }
 
+DepthSortEngine::PolygonInfo DepthSortEngine::_toPolygonInfo(const Point3ArrayPtr& points, uint32_t id) const
+{
+    DepthSortEngine::PolygonInfo pinfo;
+    pinfo.points = points;
+    std::pair<Vector3,Vector3> bounds = points->getBounds();
+    pinfo.pmin = bounds.first;
+    pinfo.pmax = bounds.second;
+    pinfo.id = id;
+    pinfo.rank = 0;
+    pinfo.cxmin = pinfo.cymin = 1;
+    pinfo.cxmax = pinfo.cymax = 0;
+    return pinfo;
+}
 
 
+DepthSortEngine::PolygonInfoList DepthSortEngine::_toPolygonInfo(const std::vector<Point3ArrayPtr>& polygons, uint32_t id) const
+{
+    PolygonInfoList result;   
+    for (std::vector<Point3ArrayPtr>::const_iterator it = polygons.begin(); it != polygons.end() ; ++it) {
+        result.push_back( _toPolygonInfo(*it, id));
+    }
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+// Clip a convex polygon by the half plane coord(axis) >= value (side > 0) or <= value (side < 0).
+// Depth is interpolated linearly, which is exact for planar polygons.
+std::vector<Vector3> clipaxis(const std::vector<Vector3>& polygon, int axis, real_t value, real_t side)
+{
+    std::vector<Vector3> result;
+    size_t nb = polygon.size();
+    for (size_t i = 0; i < nb; ++i) {
+        const Vector3& a = polygon[i];
+        const Vector3& b = polygon[(i+1)%nb];
+        real_t da = side * (a[axis] - value);
+        real_t db = side * (b[axis] - value);
+        if (da >= 0) result.push_back(a);
+        if ((da >= 0) != (db >= 0)) {
+            Vector3 p = a + (b - a) * (da / (da - db));
+            p[axis] = value;
+            result.push_back(p);
+        }
+    }
+    return result;
+}
+
+// Part of a ccw triangle inside a screen tile, as a fan of ccw triangles.
+std::vector<Point3ArrayPtr> cliptotile(const Point3ArrayPtr& triangle, real_t xmin, real_t xmax, real_t ymin, real_t ymax)
+{
+    std::vector<Point3ArrayPtr> result;
+    std::vector<Vector3> polygon(triangle->begin(), triangle->end());
+    polygon = clipaxis(polygon, 0, xmin, 1);
+    if (polygon.size() >= 3) polygon = clipaxis(polygon, 0, xmax, -1);
+    if (polygon.size() >= 3) polygon = clipaxis(polygon, 1, ymin, 1);
+    if (polygon.size() >= 3) polygon = clipaxis(polygon, 1, ymax, -1);
+    for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+        if (fabs(edgeFunction(polygon[0], polygon[i], polygon[i+1])) <= GEOM_EPSILON) continue;
+        Point3ArrayPtr points(new Point3Array());
+        points->push_back(polygon[0]); points->push_back(polygon[i]); points->push_back(polygon[i+1]);
+        result.push_back(points);
+    }
+    return result;
+}
+
+void DepthSortEngine::_resolvePending()
+{
+    if (__pending.empty()) return;
+
+    ParallelExecutor& executor = ParallelExecutor::get();
+    size_t nbthreads = executor.nb_threads();
+    if (nbthreads <= 1 || __pending.size() < __parallelThreshold) {
+        for (PolygonInfoList::const_iterator it = __pending.begin(); it != __pending.end(); ++it)
+            _insertPolygon(__polygons, *it);
+        __pending.clear();
+        return;
+    }
+
+    // Screen extent of the already resolved and of the new polygons
+    real_t xmin = __pending.front().pmin.x(), xmax = __pending.front().pmax.x();
+    real_t ymin = __pending.front().pmin.y(), ymax = __pending.front().pmax.y();
+    const PolygonInfoList * lists[2] = { &__polygons.polygons(), &__pending };
+    for (int l = 0; l < 2; ++l)
+        for (PolygonInfoList::const_iterator it = lists[l]->begin(); it != lists[l]->end(); ++it) {
+            xmin = std::min(xmin, it->pmin.x()); xmax = std::max(xmax, it->pmax.x());
+            ymin = std::min(ymin, it->pmin.y()); ymax = std::max(ymax, it->pmax.y());
+        }
+    real_t width = std::max<real_t>(xmax - xmin, GEOM_EPSILON);
+    real_t height = std::max<real_t>(ymax - ymin, GEOM_EPSILON);
+
+    // Several tiles per thread so that dense regions do not stall the others.
+    size_t nbtiles = 4 * nbthreads;
+    size_t nx = std::max<size_t>(1, size_t(sqrt(nbtiles * width / height) + 0.5));
+    nx = std::min(nx, nbtiles);
+    size_t ny = std::max<size_t>(1, (nbtiles + nx - 1) / nx);
+    real_t tilewidth = width / nx, tileheight = height / ny;
+
+    // Polygons overlapping several tiles are clipped: tiles are then independent.
+    // tiles[0] receives the already resolved polygons and tiles[1] the new ones.
+    std::vector<PolygonInfoList> tiles[2] = { std::vector<PolygonInfoList>(nx * ny), std::vector<PolygonInfoList>(nx * ny) };
+    for (int l = 0; l < 2; ++l)
+        for (PolygonInfoList::const_iterator it = lists[l]->begin(); it != lists[l]->end(); ++it) {
+            size_t ix0 = std::min(nx - 1, size_t(std::max<real_t>(0, (it->pmin.x() - xmin) / tilewidth)));
+            size_t ix1 = std::min(nx - 1, size_t(std::max<real_t>(0, (it->pmax.x() - xmin) / tilewidth)));
+            size_t iy0 = std::min(ny - 1, size_t(std::max<real_t>(0, (it->pmin.y() - ymin) / tileheight)));
+            size_t iy1 = std::min(ny - 1, size_t(std::max<real_t>(0, (it->pmax.y() - ymin) / tileheight)));
+            if (ix0 == ix1 && iy0 == iy1) {
+                tiles[l][ix0 + nx * iy0].push_back(*it);
+                continue;
+            }
+            for (size_t ix = ix0; ix <= ix1; ++ix)
+                for (size_t iy = iy0; iy <= iy1; ++iy) {
+                    real_t txmin = (ix == 0 ? xmin : xmin + ix * tilewidth);
+                    real_t txmax = (ix == nx - 1 ? xmax : xmin + (ix + 1) * tilewidth);
+                    real_t tymin = (iy == 0 ? ymin : ymin + iy * tileheight);
+                    real_t tymax = (iy == ny - 1 ? ymax : ymin + (iy + 1) * tileheight);
+                    PolygonInfoList pieces = _toPolygonInfo(cliptotile(it->points, txmin, txmax, tymin, tymax), it->id);
+                    PolygonInfoList& tile = tiles[l][ix + nx * iy];
+                    tile.splice(tile.end(), pieces);
+                }
+        }
+    __polygons.clear();
+    __pending.clear();
+
+    std::vector<PolygonStore> stores(nx * ny);
+    executor.parallel_for_each(0, stores.size(), [&](size_t t) {
+        PolygonStore& store = stores[t];
+        store.append(tiles[0][t].begin(), tiles[0][t].end());
+        for (PolygonInfoList::const_iterator it = tiles[1][t].begin(); it != tiles[1][t].end(); ++it)
+            _insertPolygon(store, *it);
+        tiles[0][t].clear();
+        tiles[1][t].clear();
+    }, 1);
+
+    __polygons.merge(stores);
+}
 #ifdef PGL_WITH_CGAL
 #include <CGAL/Exact_predicates_exact_constructions_kernel.h>
 #include <CGAL/Boolean_set_operations_2.h>
@@ -318,9 +642,6 @@ bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2,
     Polygon_2 p2 = toPolygon(polygon2);
     assert( p1.is_counterclockwise_oriented ());
     assert( p2.is_counterclockwise_oriented ());
-    print_polygon(p1);
-    print_polygon(p2);
-    printf("intersect: %s\n",CGAL::do_intersect(p1, p2)?"True":"False");
     Pwh_list_2 result;
     CGAL::intersection(p1, p2, std::back_inserter(result));
 
@@ -330,25 +651,21 @@ bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2,
     // CGAL::cpp11::result_of<Kernel::Intersect_2(Triangle_2, Triangle_2)>::type
     // result = intersection(p1, p2);
 
-    printf("intersect:%lu\n",result.size());
     if (result.size() == 0) return false;
 
     std::list<Polygon_2> polys = triangulate(result);
-    printf("nb pol:%lu\n",polys.size());
 
     intersection1 = project(polys, polygon1);
     intersection2 = project(polys, polygon2);
 
     Pwh_list_2 result2;
     CGAL::difference(p1, p2, std::back_inserter(result2));
-    printf("diff1:%lu\n",result2.size());
 
     std::list<Polygon_2> polys2 = triangulate(result2);
     rest1 = project(polys2, polygon1);
 
     Pwh_list_2 result3;
     CGAL::difference(p2, p1, std::back_inserter(result3));
-    printf("diff2:%lu\n",result3.size());
 
     std::list<Polygon_2> polys3 = triangulate(result3);
     rest2 = project(polys3, polygon2);
@@ -357,69 +674,113 @@ bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2,
 
 }
 
-DepthSortEngine::PolygonInfo DepthSortEngine::_toPolygonInfo(const Point3ArrayPtr& points, uint32_t id) const
+#else
+
+// Without CGAL, the polygons are convex (triangles or their clipped parts): their
+// intersection and differences are computed by clipping with half planes.
+
+typedef std::vector<Vector2> Polygon2D;
+
+inline real_t polygonarea(const Polygon2D& polygon)
 {
-    // printf("polygon info : %u %u\n", id , points->size());
-    DepthSortEngine::PolygonInfo pinfo;
-    pinfo.points = points;
-    std::pair<Vector3,Vector3> bounds = points->getBounds();
-    pinfo.pmin = bounds.first;
-    pinfo.pmax = bounds.second;
-    pinfo.id = id;
-    return pinfo;
+    real_t area = 0;
+    for (size_t i = 0, nb = polygon.size(); i < nb; ++i)
+        area += cross(polygon[i], polygon[(i+1)%nb]);
+    return area / 2;
 }
 
-
-DepthSortEngine::PolygonInfoList DepthSortEngine::_toPolygonInfo(const std::vector<Point3ArrayPtr>& polygons, uint32_t id) const
+Polygon2D toPolygon(Point3ArrayPtr polygon)
 {
-    PolygonInfoList result;   
-    for (std::vector<Point3ArrayPtr>::const_iterator it = polygons.begin(); it != polygons.end() ; ++it) {
-        result.push_back( _toPolygonInfo(*it, id));
-    }
-    return result;
+    Polygon2D pol;
+    for (Point3Array::const_iterator it = polygon->begin(); it != polygon->end(); ++it)
+        pol.push_back(Vector2(it->x(), it->y()));
+    if (polygonarea(pol) < 0) std::reverse(pol.begin(), pol.end());
+    return pol;
 }
 
-std::pair<real_t, real_t> polygonzbounds(const DepthSortEngine::PolygonInfoList& polygons) {
-    DepthSortEngine::PolygonInfoList::const_iterator it = polygons.begin();
-    real_t zmin = it->pmin.z();
-    real_t zmax = it->pmax.z();
-    for (++it; it != polygons.end() ; ++it) { 
-        if (zmin > it->pmin.z()) zmin = it->pmin.z();
-        if (zmax < it->pmax.z()) zmin = it->pmax.z();
+// Part of a convex polygon on the left (side > 0) or on the right (side < 0) of the line (a, b).
+Polygon2D cliphalfplane(const Polygon2D& polygon, const Vector2& a, const Vector2& b, real_t side)
+{
+    Polygon2D result;
+    size_t nb = polygon.size();
+    for (size_t i = 0; i < nb; ++i) {
+        const Vector2& p = polygon[i];
+        const Vector2& q = polygon[(i+1)%nb];
+        real_t dp = side * cross(b - a, p - a);
+        real_t dq = side * cross(b - a, q - a);
+        if (dp >= 0) result.push_back(p);
+        if ((dp >= 0) != (dq >= 0)) result.push_back(p + (q - p) * (dp / (dp - dq)));
     }
-    return std::pair<real_t,real_t>(zmin, zmax);
+    return result;
 }
 
-void DepthSortEngine::removePolygon(PolygonInfoSet::iterator it)
+// Split the convex polygon p1 into its part inside the ccw convex polygon p2 and convex parts outside of it.
+Polygon2D splitconvex(const Polygon2D& p1, const Polygon2D& p2, std::vector<Polygon2D>& rest)
 {
-    __polygonlist.erase(it);
+    Polygon2D inside = p1;
+    for (size_t i = 0, nb = p2.size(); i < nb && inside.size() >= 3; ++i) {
+        Polygon2D outside = cliphalfplane(inside, p2[i], p2[(i+1)%nb], -1);
+        if (outside.size() >= 3 && polygonarea(outside) > GEOM_EPSILON) rest.push_back(outside);
+        inside = cliphalfplane(inside, p2[i], p2[(i+1)%nb], 1);
+    }
+    return inside;
 }
 
-DepthSortEngine::PolygonInfoSet::iterator DepthSortEngine::appendPolygon(const PolygonInfo& polygon)
+// Lift the triangles of a fan of proj to the plane of the triangle polygon.
+void project(const Polygon2D& proj, Point3ArrayPtr polygon, std::vector<Point3ArrayPtr>& result)
 {
-
-
-    return __polygonlist.insert(__polygonlist.end(), polygon);
+    const Vector3& a = polygon->getAt(0);
+    const Vector3& b = polygon->getAt(1);
+    const Vector3& c = polygon->getAt(2);
+    real_t area = edgeFunction(a, b, c);
+    for (size_t i = 1; i + 1 < proj.size(); ++i) {
+        if (fabs(cross(proj[i] - proj[0], proj[i+1] - proj[0])) / 2 <= GEOM_EPSILON) continue;
+        Point3ArrayPtr points(new Point3Array());
+        const Vector2 * vertices[3] = { &proj[0], &proj[i], &proj[i+1] };
+        for (int j = 0; j < 3; ++j) {
+            const Vector2& vertex = *vertices[j];
+            real_t w0 = edgeFunction(b, c, vertex);
+            real_t w1 = edgeFunction(c, a, vertex);
+            real_t w2 = edgeFunction(a, b, vertex);
+            real_t sumw = (fabs(area) <= GEOM_EPSILON ? w0 + w1 + w2 : area);
+            points->push_back(a * (w0 / sumw) + b * (w1 / sumw) + c * (w2 / sumw));
+        }
+        result.push_back(points);
+    }
 }
 
-DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::appendPolygons(DepthSortEngine::PolygonInfoList::iterator begin, DepthSortEngine::PolygonInfoList::iterator end)
+bool intersect(Point3ArrayPtr polygon1, Point3ArrayPtr polygon2, 
+               std::vector<Point3ArrayPtr>& intersection1, std::vector<Point3ArrayPtr>& intersection2, 
+               std::vector<Point3ArrayPtr>& rest1,  std::vector<Point3ArrayPtr>& rest2)
 {
-    DepthSortEngine::PolygonInfoIteratorList result;
-    for(DepthSortEngine::PolygonInfoList::iterator it = begin; it != end; ++it)
-        result.push_back(appendPolygon(*it));
-    return result;
+    Polygon2D p1 = toPolygon(polygon1);
+    Polygon2D p2 = toPolygon(polygon2);
+    std::vector<Polygon2D> outside1, outside2;
+    Polygon2D inside = splitconvex(p1, p2, outside1);
+    if (inside.size() < 3 || polygonarea(inside) <= GEOM_EPSILON) return false;
+    splitconvex(p2, p1, outside2);
+
+    project(inside, polygon1, intersection1);
+    project(inside, polygon2, intersection2);
+    if (intersection1.empty() || intersection2.empty()) return false;
+    for (std::vector<Polygon2D>::const_iterator it = outside1.begin(); it != outside1.end(); ++it)
+        project(*it, polygon1, rest1);
+    for (std::vector<Polygon2D>::const_iterator it = outside2.begin(); it != outside2.end(); ++it)
+        project(*it, polygon2, rest2);
+    return true;
 }
 
+#endif
 
-DepthSortEngine::PolygonInfoIteratorList DepthSortEngine::getIntersectingPolygons(const PolygonInfo& polygon)
-{
-    DepthSortEngine::PolygonInfoIteratorList result;
-    for (DepthSortEngine::PolygonInfoSet::iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it) {
-        if ((polygon.pmin.x() > it->pmax.x())||(polygon.pmax.x() < it->pmin.x())) { continue; }
-        if ((polygon.pmin.y() > it->pmax.y())||(polygon.pmax.y() < it->pmin.y())) { continue; }
-        result.push_back(it);
+std::pair<real_t, real_t> polygonzbounds(const DepthSortEngine::PolygonInfoList& polygons) {
+    DepthSortEngine::PolygonInfoList::const_iterator it = polygons.begin();
+    real_t zmin = it->pmin.z();
+    real_t zmax = it->pmax.z();
+    for (++it; it != polygons.end() ; ++it) { 
+        if (zmin > it->pmin.z()) zmin = it->pmin.z();
+        if (zmax < it->pmax.z()) zmax = it->pmax.z();
     }
-    return result;
+    return std::pair<real_t,real_t>(zmin, zmax);
 }
 
 void swap(Vector3& v1, Vector3& v2){
@@ -430,10 +791,14 @@ void swap(Vector3& v1, Vector3& v2){
 
 void DepthSortEngine::processTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, uint32_t id)
 {
-    setlocale(LC_ALL, "en_GB");
-
-    printf("[(%f,%f,%f),(%f,%f,%f),(%f,%f,%f)]\n",v0.x(),v0.y(),v0.z(),v1.x(),v1.y(),v1.z(),v2.x(),v2.y(),v2.z());
+    PolygonInfo p;
+    if (!_projectTriangle(v0, v1, v2, id, p)) return;
+    if (__deferred) __pending.push_back(p);
+    else _insertPolygon(__polygons, p);
+}
 
+bool DepthSortEngine::_projectTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, uint32_t id, PolygonInfo& result) const
+{
     Vector3 v0Cam = __camera->worldToCamera(v0);
     Vector3 v1Cam = __camera->worldToCamera(v1);
     Vector3 v2Cam = __camera->worldToCamera(v2);
@@ -467,36 +832,35 @@ void DepthSortEngine::processTriangle(const Vector3& v0, const Vector3& v1, cons
 
 
     real_t direction = cross(Vector2(v1Cam.x()-v0Cam.x(),v1Cam.y()-v0Cam.y()), Vector2(v2Cam.x()-v0Cam.x(),v2Cam.y()-v0Cam.y()));
-    real_t direction2 = cross(Vector3(v1Cam.x()-v0Cam.x(),v1Cam.y()-v0Cam.y(),0), Vector3(v2Cam.x()-v0Cam.x(),v2Cam.y()-v0Cam.y(),0)).z();
-
-    printf("[(%f,%f),(%f,%f),(%f,%f)]:%s\n",v0Cam.x(),v0Cam.y(),v1Cam.x(),v1Cam.y(),v2Cam.x(),v2Cam.y(),(direction>0?"ccw":"cw"));
-    printf("%f - %f\n", direction, direction2);
-
 
     Point3ArrayPtr points(new Point3Array());
     if (fabs(direction) < GEOM_EPSILON) {
-        return;
+        return false;
     }
     else if (direction < 0) {
-        printf("reverse cw\n");
         points->push_back(v0Cam); points->push_back(v2Cam); points->push_back(v1Cam); 
     }
     else { // CCW
         points->push_back(v0Cam); points->push_back(v1Cam); points->push_back(v2Cam); 
     }
 
-    PolygonInfo p = _toPolygonInfo(points, id);
-    PolygonInfoIteratorList intersections = getIntersectingPolygons(p);
-    _processTriangle(p, intersections, intersections.begin());
+    result = _toPolygonInfo(points, id);
+    return true;
+}
+
+void DepthSortEngine::_insertPolygon(PolygonStore& store, const PolygonInfo& polygon) const
+{
+    PolygonInfoIteratorList intersections = store.intersecting(polygon);
+    _processTriangle(store, polygon, intersections, intersections.begin());
 }
 
 typename DepthSortEngine::PolygonInfoIteratorList::iterator 
-DepthSortEngine::_processTriangle( PolygonInfo polygon, 
+DepthSortEngine::_processTriangle( PolygonStore& store,
+                                   PolygonInfo polygon, 
                                    DepthSortEngine::PolygonInfoIteratorList& polygonstotest, 
-                                   DepthSortEngine::PolygonInfoIteratorList::iterator begin)
+                                   DepthSortEngine::PolygonInfoIteratorList::iterator begin) const
 {
     bool processed = false;
-    printf("Process triangle %u\n", polygon.id);
     for (DepthSortEngine::PolygonInfoIteratorList::iterator it = begin; it != polygonstotest.end(); ) {
         PolygonInfo& current = *(*it);
         uint32_t itid = current.id;
@@ -507,42 +871,31 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
             std::vector<Point3ArrayPtr> intersection2; 
             std::vector<Point3ArrayPtr> rest1;
             std::vector<Point3ArrayPtr> rest2;
-            printf("Test intersection\n");
             if (!intersect(polygon.points, current.points, intersection1, intersection2, rest1, rest2)) { 
-                printf("No intersection\n");
                 ++it; continue; 
             }
             bool isbegin = (it == begin);
-            printf("intersect\n");
-            printf("%lu %lu %lu %lu\n", intersection1.size(), intersection2.size(), rest1.size(), rest2.size());
 
             PolygonInfoList mrest2 = _toPolygonInfo(rest2, itid);
             PolygonInfoList mrest1 = _toPolygonInfo(rest1, polygon.id);
             
             // We should process depth comparison
             PolygonInfoList mintersection1 = _toPolygonInfo(intersection1, polygon.id);
-            printf("mintersection1 : %lu\n", mintersection1.size());
             std::pair<real_t, real_t> zbounds1 = polygonzbounds(mintersection1);
             real_t zmin1 = zbounds1.first; real_t zmax1 = zbounds1.second;
 
             PolygonInfoList mintersection2 = _toPolygonInfo(intersection2, itid);
-            printf("mintersection2 : %lu\n", mintersection2.size());
             std::pair<real_t, real_t> zbounds2 = polygonzbounds(mintersection2);
             real_t zmin2 = zbounds2.first; real_t zmax2 = zbounds2.second;
 
-            printf("i1: %f %f\n", zmin1, zmax1);
-            printf("i2: %f %f\n", zmin2, zmax2);
             if (zmax1 <= zmin2) {
                 // new polygon hide the previous one.
                 // we remove the previous one and replace it by its non overlaping part.
-                printf("new polygon hide the previous one\n");
-                removePolygon(*it);
-                printf("remove polygon \n");
+                store.remove(*it);
                 it = polygonstotest.erase(it);
 
                 if (mrest2.size() > 0) {
-                    printf("rest2 : %lu\n", mrest2.size());
-                    DepthSortEngine::PolygonInfoIteratorList newPol = appendPolygons(mrest2.begin(), mrest2.end());
+                    DepthSortEngine::PolygonInfoIteratorList newPol = store.append(mrest2.begin(), mrest2.end());
                     polygonstotest.insert(it, newPol.begin(), newPol.end());
                     if (isbegin) { 
                         begin = it;
@@ -564,7 +917,6 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                  // new polygon is hidden by the previous one.
                  // we keep the previous one.
                  // and test for the non overlapping area of the new one.
-                printf("new polygon is hidden the previous one\n");
                 ++it;
                 if (!mrest1.empty()){
                     if(mrest1.size() == 1) {
@@ -572,7 +924,7 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                         continue;
                     }
                     for (PolygonInfoList::const_iterator itR1 = mrest1.begin(); itR1 != mrest1.end() ; ++itR1) {
-                        it = _processTriangle(*itR1, polygonstotest, it);
+                        it = _processTriangle(store, *itR1, polygonstotest, it);
                     }
                 }
                 processed = true;
@@ -588,11 +940,9 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
 
                 for (PolygonInfoList::const_iterator itI2 = mintersection2.begin(); itI2 != mintersection2.end() ; ++itI2) {
                     Point3ArrayPtr points = plane_triangle_clip(plane, itI2->points->getAt(0), itI2->points->getAt(1), itI2->points->getAt(2));
-                    printf("Clip triangle intersection2\n");
                     if (is_null_ptr(points) || points->size() < 3) continue;
-                    printf("intersection2 %u\n", points->size());
                     if (points->size() == 3) {
-                        appendPolygon(_toPolygonInfo(points, itI2->id));
+                        store.append(_toPolygonInfo(points, itI2->id));
                     }
                     else {
                         Vector3& first = points->getAt(0);
@@ -601,7 +951,7 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                             lpoints->push_back(first);
                             lpoints->push_back(*itP);
                             lpoints->push_back(*(itP+1));
-                            appendPolygon(_toPolygonInfo(lpoints, itI2->id));
+                            store.append(_toPolygonInfo(lpoints, itI2->id));
                         }
                     } 
                 }
@@ -612,32 +962,27 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                 Plane3 planeb (-cross(p1b-p0b,p2b-p0b), p0b);
                 for (PolygonInfoList::const_iterator itI1 = mintersection1.begin(); itI1 != mintersection1.end() ; ++itI1) {
                     Point3ArrayPtr points = plane_triangle_clip(planeb, itI1->points->getAt(0), itI1->points->getAt(1), itI1->points->getAt(2));
-                    printf("Clip triangle intersection1\n");
                     if (is_null_ptr(points) || points->size() < 3) continue;
-                    printf("intersection1 %u\n", points->size());
                     if (points->size() == 3) {
-                        printf("result in triangle\n");
-                        appendPolygon(_toPolygonInfo(points, itI1->id));
+                        store.append(_toPolygonInfo(points, itI1->id));
                     }
                     else {
-                        printf("result in polygon\n");
                         Vector3& first = points->getAt(0);
                         for(Point3Array::const_iterator itP = points->begin()+1; itP != points->end()-1; ++itP){
                             Point3ArrayPtr lpoints(new Point3Array());
                             lpoints->push_back(first);
                             lpoints->push_back(*itP);
                             lpoints->push_back(*(itP+1));
-                            appendPolygon(_toPolygonInfo(lpoints, itI1->id));
+                            store.append(_toPolygonInfo(lpoints, itI1->id));
                         }
                     } 
                 }
 
-                removePolygon(*it);
+                store.remove(*it);
                 it = polygonstotest.erase(it);
 
                 if (mrest2.size() > 0) {
-                    printf("rest2 : %lu\n", mrest2.size());
-                    DepthSortEngine::PolygonInfoIteratorList newPol = appendPolygons(mrest2.begin(), mrest2.end());
+                    DepthSortEngine::PolygonInfoIteratorList newPol = store.append(mrest2.begin(), mrest2.end());
                     polygonstotest.insert(it, newPol.begin(), newPol.end());
                     if (isbegin) {
                         begin = it;
@@ -649,7 +994,6 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                     }
                 }
 
-                printf("rest1 : %lu\n", mrest1.size());
                 if (!mrest1.empty()) {
                     if(mrest1.size() == 1) {
                         polygon = mrest1.front();
@@ -657,7 +1001,7 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
                     }
                     // We should process depth comparison
                     for (PolygonInfoList::const_iterator itR1 = mrest1.begin(); itR1 != mrest1.end() ; ++itR1) {
-                        it = _processTriangle(*itR1, polygonstotest, it);
+                        it = _processTriangle(store, *itR1, polygonstotest, it);
                     }
                 }
 
@@ -669,8 +1013,7 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
         } 
     }
     if (!processed) {
-        printf("add to list\n");
-        appendPolygon(polygon);
+        store.append(polygon);
     }
     return begin;
 }
@@ -678,7 +1021,7 @@ DepthSortEngine::_processTriangle( PolygonInfo polygon,
 ScenePtr DepthSortEngine::getResult(Color4::eColor4Format format, bool cameraCoordinates) const
 {
     ScenePtr scene(new Scene());
-    for(PolygonInfoList::const_iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it){
+    for(PolygonInfoList::const_iterator it = __polygons.polygons().begin(); it != __polygons.polygons().end(); ++it){
         Color4 col = Color4::fromUint(it->id, format);
         Material * mat = new Material(Color3(col));
         mat->getTransparency() = col.getAlphaClamped();
@@ -698,7 +1041,7 @@ ScenePtr DepthSortEngine::getResult(Color4::eColor4Format format, bool cameraCoo
 ScenePtr DepthSortEngine::getProjectionResult(Color4::eColor4Format format, bool cameraCoordinates) const
 {
     ScenePtr scene(new Scene());
-    for(PolygonInfoList::const_iterator it = __polygonlist.begin(); it != __polygonlist.end(); ++it){
+    for(PolygonInfoList::const_iterator it = __polygons.polygons().begin(); it != __polygons.polygons().end(); ++it){
         Color4 col = Color4::fromUint(it->id, format);
         Material * mat = new Material(Color3(col));
         mat->getTransparency() = col.getAlphaClamped();
@@ -718,5 +1061,3 @@ ScenePtr DepthSortEngine::getProjectionResult(Color4::eColor4Format format, bool
     }
     return scene;
 }
-
-#endif
@@ -60,6 +60,8 @@
 #include <plantgl/scenegraph/scene/scene.h>
 #include "projectionengine.h"
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 /* ----------------------------------------------------------------------- */
 
@@ -91,32 +93,108 @@ public :
     virtual void iprocess(PolylinePtr polyline, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
     virtual void iprocess(PointSetPtr pointset, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
 
+    /// Between beginProcess and endProcess, triangles are queued and resolved all at once by screen tiles in parallel.
+    virtual void beginProcess();
+    virtual void endProcess();
+
+    /// Minimal number of queued triangles for the screen to be split into tiles resolved in parallel.
+    void setParallelThreshold(size_t nbtriangles) { __parallelThreshold = nbtriangles; }
+    size_t getParallelThreshold() const { return __parallelThreshold; }
+
+    /// Number of polygons of the current result.
+    size_t getPolygonCount() const { return __polygons.size(); }
+
     struct PolygonInfo {
         Point3ArrayPtr points;
         Vector3 pmin, pmax;
         uint32_t id;
+        // insertion rank and cells covered in the spatial index
+        uint64_t rank;
+        int32_t cxmin, cymin, cxmax, cymax;
     };
 
     typedef std::list<PolygonInfo> PolygonInfoList;
     typedef std::list<PolygonInfo> PolygonInfoSet;
     typedef std::list<PolygonInfoSet::iterator> PolygonInfoIteratorList;
 
+    /**
+        \class PolygonStore
+        \brief The polygons of a depth sort, indexed by a uniform grid over their projected bounding boxes.
+
+        Each polygon is registered in all the cells covered by its x-y bounding box.
+        Overlap queries only look at the cells covered by the query box and
+        return the polygons in insertion order, as a linear scan of the list would.
+        The cell size is taken from the mean extent of the polygons and the grid is
+        rebuilt when it drifts too much.
+    */
+    class ALGO_API PolygonStore {
+    public:
+        PolygonStore(real_t cellsize = 0);
+
+        PolygonInfoSet::iterator append(const PolygonInfo& polygon);
+        PolygonInfoIteratorList append(PolygonInfoList::const_iterator begin, PolygonInfoList::const_iterator end);
+        void remove(PolygonInfoSet::iterator it);
+
+        /// Polygons whose x-y bounding box overlaps the one of polygon.
+        PolygonInfoIteratorList intersecting(const PolygonInfo& polygon);
+
+        /// Reindex all the polygons with a new cell size. 0 means computed from the polygons.
+        void rebuild(real_t cellsize = 0);
+
+        void clear();
+        /// Move all the polygons of parts in this store and reindex them.
+        void merge(std::vector<PolygonStore>& parts);
+
+        const PolygonInfoList& polygons() const { return __polygons; }
+        size_t size() const { return __polygons.size(); }
+        bool empty() const { return __polygons.empty(); }
+        real_t cellSize() const { return __cellsize; }
+
+    protected:
+        typedef std::vector<PolygonInfoSet::iterator> Cell;
+        typedef std::unordered_map<uint64_t, Cell> CellMap;
+
+        void _index(PolygonInfoSet::iterator it);
+        void _unindex(PolygonInfoSet::iterator it);
+        inline int32_t _cellcoord(real_t v) const;
+        static inline uint64_t _cellkey(int32_t i, int32_t j)
+        { return (uint64_t(uint32_t(i)) << 32) | uint64_t(uint32_t(j)); }
+
+        PolygonInfoList __polygons;
+        CellMap __cells;
+        // polygons covering too many cells are kept apart and always tested
+        Cell __large;
+        real_t __cellsize;
+        bool __autosize;
+        real_t __extentsum;
+        size_t __nbindexed;
+        size_t __nextcheck;
+        uint64_t __nextrank;
+    };
+
 protected:
 
-    void removePolygon(DepthSortEngine::PolygonInfoSet::iterator it);
-    DepthSortEngine::PolygonInfoSet::iterator appendPolygon(const PolygonInfo& polygon);
-    DepthSortEngine::PolygonInfoIteratorList appendPolygons(DepthSortEngine::PolygonInfoList::iterator begin, DepthSortEngine::PolygonInfoList::iterator end);
-    DepthSortEngine::PolygonInfoIteratorList getIntersectingPolygons(const PolygonInfo& polygon);
+    /// Project a triangle in camera space. Return false if it is degenerated.
+    bool _projectTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, uint32_t id, PolygonInfo& result) const;
+
+    /// Insert a polygon in store, splitting it and the polygons it overlaps according to their depth.
+    void _insertPolygon(PolygonStore& store, const PolygonInfo& polygon) const;
 
+    /// Resolve the queued polygons. Screen tiles are processed independently in parallel.
+    void _resolvePending();
 
     PolygonInfo _toPolygonInfo(const Point3ArrayPtr& points, uint32_t id) const;
     DepthSortEngine::PolygonInfoList _toPolygonInfo(const std::vector<Point3ArrayPtr>& polygons, uint32_t id) const;
 
-    DepthSortEngine::PolygonInfoIteratorList::iterator _processTriangle( PolygonInfo polygon, 
+    DepthSortEngine::PolygonInfoIteratorList::iterator _processTriangle( PolygonStore& store,
+                                                                         PolygonInfo polygon, 
                                                                          DepthSortEngine::PolygonInfoIteratorList& polygonstotest, 
-                                                                         DepthSortEngine::PolygonInfoIteratorList::iterator begin);
+                                                                         DepthSortEngine::PolygonInfoIteratorList::iterator begin) const;
 
-    PolygonInfoList __polygonlist; 
+    PolygonStore __polygons;
+    PolygonInfoList __pending;
+    bool __deferred;
+    size_t __parallelThreshold;
 };
 
 /* ----------------------------------------------------------------------- */
@@ -0,0 +1,240 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2018 - Cirad/Inra/Inria
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://github.com/openalea/plantgl
+ *
+ *  ----------------------------------------------------------------------------
+ * 
+ *                      GNU General Public Licence
+ *           
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */             
+
+#include "mipmaptexture.h"
+#include <plantgl/math/util_math.h>
+#include <cstring>
+#include <cmath>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+const size_t MipmapTexture::DEFAULT_CACHE_MAX_SIZE = 256 * 1024 * 1024;
+
+/* ----------------------------------------------------------------------- */
+
+static inline uint32_t packTexel(const Color4& c)
+{
+    uchar_t rgba[4] = { c.getRed(), c.getGreen(), c.getBlue(), c.getAlpha() };
+    uint32_t texel;
+    memcpy(&texel, rgba, 4);
+    return texel;
+}
+
+MipmapTexture::MipmapTexture(const ImagePtr& image) :
+    RefCountObject(), __levels(), __texels()
+{
+    if (is_null_ptr(image) || image->width() == 0 || image->height() == 0) return;
+
+    // Size of all the levels, to allocate the texels once.
+    size_t nbtexels = 0;
+    for (uint_t w = image->width(), h = image->height(); ; w = pglMax<uint_t>(1, w/2), h = pglMax<uint_t>(1, h/2)) {
+        nbtexels += size_t((w+3)/4) * ((h+3)/4) * 16;
+        if (w == 1 && h == 1) break;
+    }
+    __texels.reserve(nbtexels);
+
+    addLevel(image->width(), image->height());
+    const Level& base = __levels[0];
+    for (uint_t y = 0; y < base.height; ++y)
+        for (uint_t x = 0; x < base.width; ++x)
+            __texels[index(base, x, y)] = packTexel(image->getPixelAt(x, y));
+
+    // Each level is the 2x2 box filtering of the previous one.
+    while (__levels.back().width > 1 || __levels.back().height > 1) {
+        addLevel(pglMax<uint_t>(1, __levels.back().width/2), pglMax<uint_t>(1, __levels.back().height/2));
+        const Level& prev = __levels[__levels.size()-2];
+        const Level& cur = __levels.back();
+        for (uint_t y = 0; y < cur.height; ++y) {
+            uint_t py0 = pglMin(2*y, prev.height-1), py1 = pglMin(2*y+1, prev.height-1);
+            for (uint_t x = 0; x < cur.width; ++x) {
+                uint_t px0 = pglMin(2*x, prev.width-1), px1 = pglMin(2*x+1, prev.width-1);
+                const uchar_t * t[4] = { (const uchar_t *)&__texels[index(prev, px0, py0)],
+                                         (const uchar_t *)&__texels[index(prev, px1, py0)],
+                                         (const uchar_t *)&__texels[index(prev, px0, py1)],
+                                         (const uchar_t *)&__texels[index(prev, px1, py1)] };
+                uchar_t rgba[4];
+                for (int c = 0; c < 4; ++c)
+                    rgba[c] = uchar_t((t[0][c] + t[1][c] + t[2][c] + t[3][c] + 2) / 4);
+                memcpy(&__texels[index(cur, x, y)], rgba, 4);
+            }
+        }
+    }
+}
+
+MipmapTexture::~MipmapTexture() {}
+
+void MipmapTexture::addLevel(uint_t width, uint_t height)
+{
+    Level level;
+    level.width = width;
+    level.height = height;
+    level.nbtilesx = (width+3)/4;
+    level.offset = __texels.size();
+    __levels.push_back(level);
+    // the texels of all the levels were reserved by the constructor.
+    __texels.resize(__texels.size() + size_t(level.nbtilesx) * ((height+3)/4) * 16, 0);
+}
+
+/* ----------------------------------------------------------------------- */
+
+real_t MipmapTexture::getLevelOfDetail(real_t uvarea, real_t rasterarea) const
+{
+    if (isEmpty() || rasterarea <= 0) return 0;
+    real_t texelarea = fabs(uvarea) * width() * height();
+    if (texelarea <= rasterarea) return 0;
+    // the footprint of a pixel is texelarea / rasterarea texels, i.e. a side of sqrt(texelarea / rasterarea).
+    return 0.5 * log2(texelarea / rasterarea);
+}
+
+static inline real_t wrapCoordinate(real_t u, bool repeat)
+{
+    if (u < 0 || u > 1) {
+        if (repeat) {
+            u = fmod(u, 1.0);
+            if (u < 0) u += 1.0;
+        }
+        else if (u < 0) u = 0;
+        else u = 1;
+    }
+    return u;
+}
+
+static inline void neighbors(real_t f, uint_t size, bool repeat, uint_t& i0, uint_t& i1, float& t)
+{
+    real_t fl = std::floor(f);
+    t = float(f - fl);
+    int32_t j0 = int32_t(fl), j1 = j0 + 1;
+    if (repeat) {
+        if (j0 < 0) j0 += size;
+        if (j1 >= int32_t(size)) j1 -= size;
+    }
+    else {
+        if (j0 < 0) j0 = 0;
+        if (j1 >= int32_t(size)) j1 = size - 1;
+    }
+    i0 = uint_t(j0); i1 = uint_t(j1);
+}
+
+void MipmapTexture::bilinear(const Level& level, real_t u, real_t v, bool repeatu, bool repeatv, float * rgba) const
+{
+    uint_t x0, x1, y0, y1;
+    float tx, ty;
+    neighbors(wrapCoordinate(u, repeatu) * level.width - 0.5, level.width, repeatu, x0, x1, tx);
+    neighbors((1 - wrapCoordinate(v, repeatv)) * level.height - 0.5, level.height, repeatv, y0, y1, ty);
+    const uchar_t * t00 = (const uchar_t *)&__texels[index(level, x0, y0)];
+    const uchar_t * t10 = (const uchar_t *)&__texels[index(level, x1, y0)];
+    const uchar_t * t01 = (const uchar_t *)&__texels[index(level, x0, y1)];
+    const uchar_t * t11 = (const uchar_t *)&__texels[index(level, x1, y1)];
+    float w00 = (1-tx)*(1-ty), w10 = tx*(1-ty), w01 = (1-tx)*ty, w11 = tx*ty;
+    for (int c = 0; c < 4; ++c)
+        rgba[c] = t00[c] * w00 + t10[c] * w10 + t01[c] * w01 + t11[c] * w11;
+}
+
+static inline Color4 toColor(const float * rgba)
+{
+    return Color4(uchar_t(rgba[0] + 0.5f), uchar_t(rgba[1] + 0.5f), uchar_t(rgba[2] + 0.5f), uchar_t(rgba[3] + 0.5f));
+}
+
+Color4 MipmapTexture::sample(real_t u, real_t v, uint_t level, bool repeatu, bool repeatv) const
+{
+    if (isEmpty()) return Color4();
+    float rgba[4];
+    bilinear(__levels[pglMin<uint_t>(level, nbLevels()-1)], u, v, repeatu, repeatv, rgba);
+    return toColor(rgba);
+}
+
+Color4 MipmapTexture::sample(real_t u, real_t v, real_t lod, bool repeatu, bool repeatv) const
+{
+    if (isEmpty()) return Color4();
+    if (lod <= 0) return sample(u, v, uint_t(0), repeatu, repeatv);
+    uint_t level = uint_t(lod);
+    if (level >= nbLevels()-1) return sample(u, v, nbLevels()-1, repeatu, repeatv);
+    float t = float(lod - level);
+    float rgba0[4], rgba1[4];
+    bilinear(__levels[level], u, v, repeatu, repeatv, rgba0);
+    bilinear(__levels[level+1], u, v, repeatu, repeatv, rgba1);
+    for (int c = 0; c < 4; ++c) rgba0[c] += (rgba1[c] - rgba0[c]) * t;
+    return toColor(rgba0);
+}
+
+/* ----------------------------------------------------------------------- */
+
+MipmapTexturePtr MipmapTexture::get(const ImageTexturePtr& imgdef)
+{
+    MipmapTexturePtr texture;
+    if (getCache().find(imgdef->getObjectId(), imgdef->getModificationStamp(), texture)) return texture;
+    // The texture is built out of the lock of the cache. Threads that miss the same texture at the same time build it each.
+    texture = MipmapTexturePtr(new MipmapTexture(ImagePtr(new Image(imgdef->getFilename()))));
+    getCache().insert(imgdef->getObjectId(), imgdef->getModificationStamp(), texture, texture->getMemorySize());
+    return texture;
+}
+
+MipmapTexture::Cache& MipmapTexture::getCache()
+{
+    static Cache cache(DEFAULT_CACHE_MAX_SIZE, "MipmapTexture");
+    return cache;
+}
+
+void MipmapTexture::setCacheMaxSize(size_t maxsize)
+{
+    getCache().setMaxCost(maxsize);
+}
+
+size_t MipmapTexture::getCacheMaxSize()
+{
+    return getCache().getMaxCost();
+}
+
+size_t MipmapTexture::getCacheSize()
+{
+    return getCache().getCost();
+}
+
+size_t MipmapTexture::getCacheHits()
+{
+    return getCache().getHits();
+}
+
+size_t MipmapTexture::getCacheMisses()
+{
+    return getCache().getMisses();
+}
+
+void MipmapTexture::clearCache()
+{
+    getCache().clear();
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,155 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: Modeling Plant Geometry
+ *
+ *       Copyright 2000-2018 - Cirad/Inra/Inria
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al.
+ *
+ *       Development site : https://github.com/openalea/plantgl
+ *
+ *  ----------------------------------------------------------------------------
+ * 
+ *                      GNU General Public Licence
+ *           
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */             
+
+/*! \file mipmaptexture.h
+    \brief Definition of the mipmapped textures sampled by the ZBufferEngine.
+*/
+
+
+
+#ifndef __MipmapTexture_h__
+#define __MipmapTexture_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_cache.h>
+#include <plantgl/scenegraph/appearance/texture.h>
+#include <plantgl/scenegraph/appearance/util_image.h>
+#include "../algo_config.h"
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+class MipmapTexture;
+typedef RCPtr<MipmapTexture> MipmapTexturePtr;
+
+/**
+    \class MipmapTexture
+    \brief A texture stored with its precomputed mip levels for filtered sampling.
+
+    Texels are stored as interlaced RGBA values of 32 bits. Each level is
+    stored by tiles of 4x4 texels (64 bytes) so that the four texels of a
+    bilinear lookup are usually in the same cache line. Each level halves the
+    resolution of the previous one down to a single texel.
+
+    A MipmapTexture is not modified after its construction and can thus be
+    sampled by several threads. The textures of ImageTexture objects are shared
+    by all the engines through a cache with a memory budget.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class ALGO_API MipmapTexture : public RefCountObject {
+public:
+
+    typedef ConcurrentLRUCache<MipmapTexturePtr> Cache;
+
+    /// Default memory budget of the cache of textures, in bytes.
+    static const size_t DEFAULT_CACHE_MAX_SIZE;
+
+    /// Constructs the mip levels of \e image.
+    MipmapTexture(const ImagePtr& image);
+
+    virtual ~MipmapTexture();
+
+    /** Returns the texture of \e imgdef. It is read and built the first time and
+        then kept in a cache shared by all the threads and engines. */
+    static MipmapTexturePtr get(const ImageTexturePtr& imgdef);
+
+    /// Returns the cache of textures shared by all the threads and engines.
+    static Cache& getCache();
+
+    /// Sets the memory budget of the shared cache and evicts the textures that exceed it.
+    static void setCacheMaxSize(size_t maxsize);
+    static size_t getCacheMaxSize();
+
+    /// Returns the memory used by the textures of the shared cache, in bytes.
+    static size_t getCacheSize();
+
+    /// Returns the number of lookups of the shared cache that found their texture.
+    static size_t getCacheHits();
+    static size_t getCacheMisses();
+
+    static void clearCache();
+
+    uint_t width(uint_t level = 0) const { return __levels[level].width; }
+    uint_t height(uint_t level = 0) const { return __levels[level].height; }
+    uint_t nbLevels() const { return __levels.size(); }
+    bool isEmpty() const { return __levels.empty(); }
+
+    /// Returns the memory used by the texels of all the levels, in bytes.
+    size_t getMemorySize() const { return __texels.size() * sizeof(uint32_t); }
+
+    Color4 getTexelAt(uint_t x, uint_t y, uint_t level = 0) const
+    { return Color4((const uchar_t *)&__texels[index(__levels[level], x, y)]); }
+
+    /** Returns the level of detail to sample a triangle with texture coordinates
+        of area \e uvarea that covers \e rasterarea pixels. */
+    real_t getLevelOfDetail(real_t uvarea, real_t rasterarea) const;
+
+    /// Bilinear sampling of \e level at (\e u, \e v). Coordinates out of [0,1] are repeated or clamped.
+    Color4 sample(real_t u, real_t v, uint_t level, bool repeatu = true, bool repeatv = true) const;
+
+    /// Trilinear sampling at (\e u, \e v) with a fractional level of detail \e lod.
+    Color4 sample(real_t u, real_t v, real_t lod, bool repeatu = true, bool repeatv = true) const;
+
+protected:
+
+    struct Level {
+        uint_t width;
+        uint_t height;
+        uint_t nbtilesx;
+        size_t offset;
+    };
+
+    static inline size_t index(const Level& level, uint_t x, uint_t y)
+    { return level.offset + (size_t((y >> 2) * level.nbtilesx + (x >> 2)) << 4) + ((y & 3) << 2) + (x & 3); }
+
+    void addLevel(uint_t width, uint_t height);
+    void bilinear(const Level& level, real_t u, real_t v, bool repeatu, bool repeatv, float * rgba) const;
+
+    std::vector<Level> __levels;
+    std::vector<uint32_t> __texels;
+};
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
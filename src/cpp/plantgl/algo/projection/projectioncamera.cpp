@@ -181,9 +181,10 @@ void ProjectionCamera::scaleModel(const Vector3& v)
 
 real_t ProjectionCamera::projectedArea(uint16_t x, uint16_t y, real_t z, const uint16_t imageWidth, const uint16_t imageHeight)
 {
-    Vector3 dir1 = rasterToCamera(Vector3(x,y,1), imageWidth, imageHeight);
-    Vector3 dir2 = rasterToCamera(Vector3(x+1,y,1), imageWidth, imageHeight);
-    Vector3 dir3 = rasterToCamera(Vector3(x,y+1,1), imageWidth, imageHeight);
+    // the pixel is measured at the depth z
+    Vector3 dir1 = rasterToCamera(Vector3(x,y,z), imageWidth, imageHeight);
+    Vector3 dir2 = rasterToCamera(Vector3(x+1,y,z), imageWidth, imageHeight);
+    Vector3 dir3 = rasterToCamera(Vector3(x,y+1,z), imageWidth, imageHeight);
     real_t alpha = norm(Vector3(dir2)-Vector3(dir1));
     real_t beta = norm(Vector3(dir3)-Vector3(dir1));
     return alpha*beta;
@@ -92,6 +92,7 @@ public :
       { __camera->lookAt(eyePosition3D, center3D, upVector3D); }
 
       const ProjectionCameraPtr& camera() const { return __camera; }
+      inline void setCamera(const ProjectionCameraPtr& camera) { __camera = camera; }
 
       inline void transformModel(const Matrix4& transform)
       {  __camera->transformModel(transform); }
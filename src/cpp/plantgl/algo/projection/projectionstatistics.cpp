@@ -0,0 +1,234 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+             
+
+
+/* ----------------------------------------------------------------------- */
+
+#include "projectionstatistics.h"
+#include <boost/bind.hpp>
+#include <algorithm>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+// A depth engine reused for all the shapes rendered alone by a thread.
+class ShapeProjectionEngine : public ZBufferEngine {
+public:
+    ShapeProjectionEngine(uint16_t imageWidth, uint16_t imageHeight, const ProjectionCameraPtr& camera):
+        ZBufferEngine(imageWidth, imageHeight, ZBufferEngine::eDepthOnly, Color3::BLACK, Shape::NOID, false),
+        __empty(REAL_MAX)
+    { 
+        __camera = camera; 
+    }
+
+    /*! Render the shape alone, keeping its nearest or its farthest points.
+        Only the pixels of the returned rectangle are cleared and may be covered. */
+    Index4 renderShape(const MultiViewZBufferEngine& primitives, size_t shape, bool farthest)
+    {
+        __farthestdepth = farthest;
+        __empty = (farthest ? -REAL_MAX : REAL_MAX);
+
+        std::pair<size_t,size_t> blocks = primitives.getShapeBlocks(shape);
+        Index4 rect(__imageWidth, 0, __imageHeight, 0);
+        for (size_t b = blocks.first; b < blocks.second; ++b){
+            Index4 blockrect;
+            if (!primitives.getRasterBounds(primitives.getBlocks()[b], __camera, blockrect)) {
+                rect = Index4(0, __imageWidth - 1, 0, __imageHeight - 1);
+                break;
+            }
+            if (blockrect[0] > blockrect[1]) continue;
+            rect = Index4(pglMin(rect[0], blockrect[0]), pglMax(rect[1], blockrect[1]), pglMin(rect[2], blockrect[2]), pglMax(rect[3], blockrect[3]));
+        }
+        if (rect[0] > rect[1] || rect[2] > rect[3]) return rect;
+
+        for (uint32_t x = rect[0]; x <= rect[1]; ++x)
+            for (uint32_t y = rect[2]; y <= rect[3]; ++y)
+                __depthBuffer->setAt(x, y, __empty);
+
+        for (size_t b = blocks.first; b < blocks.second; ++b){
+            const MultiViewZBufferEngine::PrimitiveBlock& block = primitives.getBlocks()[b];
+            if (primitives.isInView(block, __camera)) primitives.render(*this, block, __camera);
+        }
+        return rect;
+    }
+
+    inline bool isCovered(uint32_t x, uint32_t y) const { return __depthBuffer->getAt(x, y) != __empty; }
+
+protected:
+    real_t __empty;
+};
+
+/* ----------------------------------------------------------------------- */
+
+static void computeProjectionSizes(std::atomic<uint32_t> * nextshape,
+                                   const MultiViewZBufferEngine * primitives,
+                                   ProjectionCameraPtr camera,
+                                   std::vector<real_t> * sizes)
+{
+    ShapeProjectionEngine engine(primitives->getImageWidth(), primitives->getImageHeight(), camera);
+    uint32_t nbshapes = primitives->getNbShapes();
+    for (uint32_t shape = (*nextshape)++; shape < nbshapes; shape = (*nextshape)++){
+        Index4 rect = engine.renderShape(*primitives, shape, false);
+        real_t size = 0;
+        for (uint32_t x = rect[0]; x <= rect[1]; ++x)
+            for (uint32_t y = rect[2]; y <= rect[3]; ++y)
+                if (engine.isCovered(x, y))
+                    size += camera->projectedArea(x, y, engine.getDepthBuffer()->getAt(x, y), primitives->getImageWidth(), primitives->getImageHeight());
+        (*sizes)[shape] = size;
+    }
+}
+
+std::vector<std::pair<uint32_t,real_t> > PGL(projectionSizes)(const ScenePtr& scene,
+                                                              const ProjectionCameraPtr& camera,
+                                                              uint16_t imageWidth,
+                                                              uint16_t imageHeight)
+{
+    MultiViewZBufferEngine primitives(imageWidth, imageHeight);
+    primitives.setScene(scene);
+    uint32_t nbshapes = primitives.getNbShapes();
+
+    std::vector<real_t> sizes(nbshapes, 0);
+    std::atomic<uint32_t> nextshape(0);
+    size_t nbthreads = pglMin<size_t>(ThreadManager::get().nb_threads(), pglMax<size_t>(1,nbshapes));
+    for (size_t i = 0 ; i < nbthreads ; ++i) {
+        ThreadManager::get().new_task(boost::bind(&computeProjectionSizes, &nextshape, &primitives, ProjectionCameraPtr(camera->copy()), &sizes));
+    }
+    ThreadManager::get().join();
+
+    std::vector<std::pair<uint32_t,real_t> > result;
+    result.reserve(nbshapes);
+    for(uint32_t shape = 0; shape < nbshapes; ++shape)
+        result.push_back(std::pair<uint32_t,real_t>(primitives.getShapeId(shape), sizes[shape]));
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+std::vector<std::pair<uint32_t,uint32_t> > PGL(pixelPerShape)(const ScenePtr& scene,
+                                                              const ProjectionCameraPtr& camera,
+                                                              uint16_t imageWidth,
+                                                              uint16_t imageHeight,
+                                                              real_t * pixelwidth)
+{
+    ZBufferEngine engine(imageWidth, imageHeight, ZBufferEngine::eIdBased, Color3::BLACK, Shape::NOID, true);
+    engine.setCamera(ProjectionCameraPtr(camera->copy()));
+    engine.setTileBinning(true);
+    engine.process(scene);
+
+    pgl_hash_map<uint32_t,uint32_t> histo = engine.idhistogram(false);
+    std::vector<std::pair<uint32_t,uint32_t> > result(histo.begin(), histo.end());
+    std::sort(result.begin(), result.end());
+
+    if (pixelwidth) *pixelwidth = sqrt(camera->projectedArea(imageWidth/2, imageHeight/2, 1, imageWidth, imageHeight));
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
+
+typedef std::vector<std::pair<uint32_t,ShapeRayHit> > PixelHitList;
+
+static void computeRayHits(std::atomic<uint32_t> * nextshape,
+                           const MultiViewZBufferEngine * primitives,
+                           ProjectionCameraPtr camera,
+                           bool backtest,
+                           std::vector<PixelHitList> * hits)
+{
+    uint16_t imageWidth = primitives->getImageWidth();
+    uint16_t imageHeight = primitives->getImageHeight();
+    ShapeProjectionEngine engine(imageWidth, imageHeight, camera);
+    uint32_t nbshapes = primitives->getNbShapes();
+    for (uint32_t shape = (*nextshape)++; shape < nbshapes; shape = (*nextshape)++){
+        uint32_t id = primitives->getShapeId(shape);
+        PixelHitList& shapehits = (*hits)[shape];
+        Index4 rect = engine.renderShape(*primitives, shape, false);
+        for (uint32_t x = rect[0]; x <= rect[1]; ++x)
+            for (uint32_t y = rect[2]; y <= rect[3]; ++y)
+                if (engine.isCovered(x, y)) {
+                    Vector3 front = camera->rasterToWorld(Vector3(x, y, engine.getDepthBuffer()->getAt(x, y)), imageWidth, imageHeight);
+                    shapehits.push_back(std::pair<uint32_t,ShapeRayHit>(x * imageHeight + y, ShapeRayHit(id, front, front)));
+                }
+
+        if (backtest && !shapehits.empty()) {
+            // the hits are in the same pixel order in both passes.
+            rect = engine.renderShape(*primitives, shape, true);
+            PixelHitList::iterator itHit = shapehits.begin();
+            for (uint32_t x = rect[0]; x <= rect[1]; ++x)
+                for (uint32_t y = rect[2]; y <= rect[3]; ++y)
+                    if (itHit != shapehits.end() && itHit->first == x * imageHeight + y) {
+                        if (engine.isCovered(x, y))
+                            itHit->second.back = camera->rasterToWorld(Vector3(x, y, engine.getDepthBuffer()->getAt(x, y)), imageWidth, imageHeight);
+                        ++itHit;
+                    }
+        }
+    }
+}
+
+ShapeRayHitBufferPtr PGL(castRays)(const ScenePtr& scene,
+                                   const ProjectionCameraPtr& camera,
+                                   uint16_t imageWidth,
+                                   uint16_t imageHeight,
+                                   bool backtest)
+{
+    MultiViewZBufferEngine primitives(imageWidth, imageHeight);
+    primitives.setScene(scene);
+    uint32_t nbshapes = primitives.getNbShapes();
+
+    std::vector<PixelHitList> hits(nbshapes);
+    std::atomic<uint32_t> nextshape(0);
+    size_t nbthreads = pglMin<size_t>(ThreadManager::get().nb_threads(), pglMax<size_t>(1,nbshapes));
+    for (size_t i = 0 ; i < nbthreads ; ++i) {
+        ThreadManager::get().new_task(boost::bind(&computeRayHits, &nextshape, &primitives, ProjectionCameraPtr(camera->copy()), backtest, &hits));
+    }
+    ThreadManager::get().join();
+
+    ShapeRayHitBufferPtr result(new ShapeRayHitBuffer(imageWidth, imageHeight));
+    for(std::vector<PixelHitList>::iterator itShape = hits.begin(); itShape != hits.end(); ++itShape){
+        for(PixelHitList::const_iterator itHit = itShape->begin(); itHit != itShape->end(); ++itHit)
+            result->getAt(itHit->first / imageHeight, itHit->first % imageHeight).push_back(itHit->second);
+        PixelHitList().swap(*itShape);
+    }
+    return result;
+}
+
+/* ----------------------------------------------------------------------- */
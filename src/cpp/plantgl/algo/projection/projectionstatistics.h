@@ -0,0 +1,109 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+             
+
+/*! \file projectionstatistics.h
+    \brief Per shape statistics of a projected scene, computed with ZBufferEngine.
+*/
+
+
+
+#ifndef __projectionstatistics_h__
+#define __projectionstatistics_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "zbufferengine.h"
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/*! Projected area of each shape of the scene, rendered alone with the camera.
+    The area covered by a pixel is given by ProjectionCamera::projectedArea at the depth of the shape.
+    The shapes are rendered in parallel. Return the pairs (id, area) in the order of the scene. */
+std::vector<std::pair<uint32_t,real_t> > ALGO_API projectionSizes(const ScenePtr& scene,
+                                                                  const ProjectionCameraPtr& camera,
+                                                                  uint16_t imageWidth = 800,
+                                                                  uint16_t imageHeight = 800);
+
+/*! Number of visible pixels of each shape id, with the occlusions between the shapes.
+    If given, \e pixelwidth is set to the width of a pixel at the unit depth. 
+    Return the pairs (id, number of pixels) sorted by id. */
+std::vector<std::pair<uint32_t,uint32_t> > ALGO_API pixelPerShape(const ScenePtr& scene,
+                                                                  const ProjectionCameraPtr& camera,
+                                                                  uint16_t imageWidth = 800,
+                                                                  uint16_t imageHeight = 800,
+                                                                  real_t * pixelwidth = NULL);
+
+/// Intersection of the ray of a pixel with a shape : its nearest (front) and farthest (back) points.
+struct ALGO_API ShapeRayHit {
+    ShapeRayHit(uint32_t _id = Shape::NOID, 
+                const Vector3& _front = Vector3::ORIGIN, 
+                const Vector3& _back = Vector3::ORIGIN):
+        id(_id), front(_front), back(_back) {}
+
+    uint32_t id;
+    Vector3 front;
+    Vector3 back;
+};
+
+typedef std::vector<ShapeRayHit> ShapeRayHitList;
+typedef Array2<ShapeRayHitList> ShapeRayHitBuffer;
+typedef RCPtr<ShapeRayHitBuffer> ShapeRayHitBufferPtr;
+
+/*! Intersections of the ray of each pixel (x,y) with each shape of the scene, rendered alone with the camera.
+    The hits of a pixel are in the order of the scene. If \e backtest is false, the back point of a hit is its front point.
+    The shapes are rendered in parallel. */
+ShapeRayHitBufferPtr ALGO_API castRays(const ScenePtr& scene,
+                                       const ProjectionCameraPtr& camera,
+                                       uint16_t imageWidth = 800,
+                                       uint16_t imageHeight = 800,
+                                       bool backtest = true);
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
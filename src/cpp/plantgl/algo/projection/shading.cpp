@@ -121,27 +121,43 @@ void IdBasedShader::process(int32_t x, int32_t y, int32_t z, float w0, float w1,
 }
 */
 
-TextureShader::TextureShader(ZBufferEngine * engine) : TriangleShader(engine) {}
+TextureShader::TextureShader(ZBufferEngine * engine) : TriangleShader(engine), textureid(0), texturestamp(0), lod(0) {}
 TextureShader::~TextureShader() {}
 
 void TextureShader::init(AppearancePtr appearance, TriangleSetPtr triangles, uint32_t trid, const ProjectionCameraPtr& camera, const LightPtr& light)
 {
     initEnv(camera, light);
 
-    Texture2DPtr texture = dynamic_pointer_cast<Texture2D>(appearance);
-    if (is_valid_ptr(texture) && is_valid_ptr(texture->getImage())){
-        image = __engine->getTexture(texture->getImage());
+    lod = 0;
+    Texture2DPtr texture2d = dynamic_pointer_cast<Texture2D>(appearance);
+    if (is_valid_ptr(texture2d) && is_valid_ptr(texture2d->getImage())){
+        // consecutive triangles usually have the same texture. The shared cache is not locked for them.
+        const ImageTexturePtr& imgdef = texture2d->getImage();
+        if (is_null_ptr(texture) || imgdef->getObjectId() != textureid || imgdef->getModificationStamp() != texturestamp) {
+            texture = __engine->getTexture(imgdef);
+            textureid = imgdef->getObjectId();
+            texturestamp = imgdef->getModificationStamp();
+        }
         uv0 = triangles->getFaceTexCoordAt(trid, 0);    
         uv1 = triangles->getFaceTexCoordAt(trid, 1);    
         uv2 = triangles->getFaceTexCoordAt(trid, 2);    
-        if (texture->getTransformation()){
-            uv0 = texture->getTransformation()->transform(uv0);
-            uv1 = texture->getTransformation()->transform(uv1);
-            uv2 = texture->getTransformation()->transform(uv2);
+        if (texture2d->getTransformation()){
+            uv0 = texture2d->getTransformation()->transform(uv0);
+            uv1 = texture2d->getTransformation()->transform(uv1);
+            uv2 = texture2d->getTransformation()->transform(uv2);
         }
-        repeatu = texture->getImage()->getRepeatS();
-        repeatv = texture->getImage()->getRepeatT();
+        repeatu = imgdef->getRepeatS();
+        repeatv = imgdef->getRepeatT();
+
+        uint16_t width = __engine->getImageWidth(), height = __engine->getImageHeight();
+        Vector3 r0 = camera->worldToRaster(triangles->getFacePointAt(trid, 0), width, height);
+        Vector3 r1 = camera->worldToRaster(triangles->getFacePointAt(trid, 1), width, height);
+        Vector3 r2 = camera->worldToRaster(triangles->getFacePointAt(trid, 2), width, height);
+        real_t rasterarea = fabs((r1.x()-r0.x())*(r2.y()-r0.y()) - (r2.x()-r0.x())*(r1.y()-r0.y())) / 2;
+        real_t uvarea = fabs((uv1.x()-uv0.x())*(uv2.y()-uv0.y()) - (uv2.x()-uv0.x())*(uv1.y()-uv0.y())) / 2;
+        lod = texture->getLevelOfDetail(uvarea, rasterarea);
     }
+    else texture = MipmapTexturePtr();
 }
 
 TriangleShader *  TextureShader::copy(bool deep) const
@@ -153,7 +169,7 @@ Color4 TextureShader::process(int32_t x, int32_t y, int32_t z, float w0, float w
 {
     Vector2 uv = uv0 * w0 + uv1 * w1 + uv2 * w2;
     Color4 rasterColor;
-    if(is_valid_ptr(image))rasterColor = image->getPixelAtUV(uv.x(), uv.y(), repeatu, repeatv);
+    if(is_valid_ptr(texture))rasterColor = texture->sample(uv.x(), uv.y(), lod, repeatu, repeatv);
     return rasterColor;
 }
 
@@ -61,6 +61,7 @@
 #include "../algo_config.h"
 #include "projectioncamera.h"
 #include "light.h"
+#include "mipmaptexture.h"
 /* ----------------------------------------------------------------------- */
 
 PGL_BEGIN_NAMESPACE
@@ -150,10 +151,14 @@ public:
     virtual Color4 process(int32_t x, int32_t y, int32_t z, float w0, float w1, float w2) ;
     virtual TriangleShader * copy(bool deep = false) const;
 
-    ImagePtr image;
+    MipmapTexturePtr texture;
+    size_t textureid;
+    size_t texturestamp;
     Vector2 uv0;
     Vector2 uv1;
     Vector2 uv2;
+    // Level of detail of the texture, computed once for the whole triangle from its projected area.
+    real_t lod;
     bool repeatu;
     bool repeatv;
 };
@@ -207,6 +212,74 @@ public:
 
 };
 
+/* ----------------------------------------------------------------------- */
+
+/*
+    Span shaders are used by the specialized rasterizer of ZBufferEngine in place of
+    the simplest triangle shaders. Their type is known at compile time and they
+    compute the colors of all the visible pixels of a scanline span at once,
+    from the perspective corrected weights of the vertices.
+*/
+
+struct NoSpanShader {
+    static const bool colored = false;
+
+    inline void shade(size_t nb, const float * w0, const float * w1, const float * w2, Color4 * colors) const { }
+};
+
+struct ColorSpanShader {
+    static const bool colored = true;
+
+    ColorSpanShader(const ColorBasedShader& shader) : c0(shader.c0), c1(shader.c1), c2(shader.c2) { }
+
+    inline void shade(size_t nb, const float * w0, const float * w1, const float * w2, Color4 * colors) const
+    { for (size_t i = 0; i < nb; ++i) colors[i] = c0 * w0[i]  + c1 * w1[i]  + c2 * w2[i]; }
+
+    Color4 c0;
+    Color4 c1;
+    Color4 c2;
+};
+
+struct GouraudSpanShader {
+    static const bool colored = true;
+
+    GouraudSpanShader(const GouraudInterpolation& shader) : c0(shader.c0), c1(shader.c1), c2(shader.c2) { }
+
+    inline void shade(size_t nb, const float * w0, const float * w1, const float * w2, Color4 * colors) const
+    { for (size_t i = 0; i < nb; ++i) colors[i] = Color4::interpolate(c0, w0[i], c1, w1[i], c2, w2[i]); }
+
+    Color4 c0;
+    Color4 c1;
+    Color4 c2;
+};
+
+struct TextureSpanShader {
+    static const bool colored = true;
+
+    TextureSpanShader(const TextureShader& shader) : 
+        texture(shader.texture.get()), uv0(shader.uv0), uv1(shader.uv1), uv2(shader.uv2), 
+        lod(shader.lod), repeatu(shader.repeatu), repeatv(shader.repeatv) { }
+
+    inline void shade(size_t nb, const float * w0, const float * w1, const float * w2, Color4 * colors) const
+    { 
+        if (texture == NULL) { for (size_t i = 0; i < nb; ++i) colors[i] = Color4(); return; }
+        for (size_t i = 0; i < nb; ++i) {
+            Vector2 uv = uv0 * w0[i] + uv1 * w1[i] + uv2 * w2[i];
+            colors[i] = texture->sample(uv.x(), uv.y(), lod, repeatu, repeatv);
+        }
+    }
+
+    const MipmapTexture * texture;
+    Vector2 uv0;
+    Vector2 uv1;
+    Vector2 uv2;
+    real_t lod;
+    bool repeatu;
+    bool repeatv;
+};
+
+/* ----------------------------------------------------------------------- */
+
 class TriangleShaderSelector : public TriangleShader {
 public:
     TriangleShaderSelector(ZBufferEngine * engine);
@@ -45,10 +45,12 @@
 #include "zbufferengine.h"
 #include "projectionrenderer.h"
 #include "projection_util.h"
+#include <plantgl/tool/util_profiler.h>
 #include <boost/asio.hpp>
 #include <boost/thread.hpp>
 #include <boost/bind.hpp>
 #include <chrono>
+#include <typeinfo>
 /* ----------------------------------------------------------------------- */
 
 PGL_USING_NAMESPACE
@@ -70,7 +72,14 @@ ZBufferEngine::ZBufferEngine(uint16_t imageWidth,
     __imageMutex(),
     __triangleshader((style != eDepthOnly) ? new TriangleShaderSelector(this) : NULL),
     __triangleshaderset(NULL),
-    __multithreaded(multithreaded)
+    __multithreaded(multithreaded),
+    __tilebinning(false),
+    __tilesize(32),
+    __binning(false),
+    __spanshading(true),
+    __farthestdepth(false),
+    __nbtilesx(0),
+    __nbtilesy(0)
 {
     beginProcess();
 }    
@@ -78,24 +87,32 @@ ZBufferEngine::ZBufferEngine(uint16_t imageWidth,
     
 ZBufferEngine::~ZBufferEngine()
 {
+    if(__triangleshaderset != NULL) delete [] __triangleshaderset;
 }
 
+// In tile binning mode, each pixel is written by the single thread owning its tile.
 void ZBufferEngine::lock(uint_t x, uint_t y)
 {
-    if(__multithreaded) __imageMutex->lock(x,y);
+    if(__multithreaded && !__tilebinning) __imageMutex->lock(x,y);
 }
 
 void ZBufferEngine::unlock(uint_t x, uint_t y)
 {
-    if(__multithreaded) __imageMutex->unlock(x,y);    
+    if(__multithreaded && !__tilebinning) __imageMutex->unlock(x,y);    
 }
 
 bool ZBufferEngine::tryLock(uint_t x, uint_t y)
 {
-    if(__multithreaded) return __imageMutex->tryLock(x,y);
+    if(__multithreaded && !__tilebinning) return __imageMutex->tryLock(x,y);
     return true;   
 }
 
+void ZBufferEngine::setTileBinning(bool enabled, uint16_t tileSize)
+{
+    __tilebinning = enabled;
+    __tilesize = pglMax<uint16_t>(1, tileSize);
+}
+
 void ZBufferEngine::beginProcess()
 {
 
@@ -190,6 +207,7 @@ void ZBufferEngine::setFrameBufferAt(uint32_t x, uint32_t y, const Color4& raste
 bool ZBufferEngine::isVisible(int32_t x, int32_t y, real_t z) const
 {
     real_t cz = __depthBuffer->getAt(x, y);
+    if (__farthestdepth) return (z > cz && (z-cz) > GEOM_EPSILON);
     return (z < cz && (cz-z) > GEOM_EPSILON); 
 }
 
@@ -271,8 +289,9 @@ void ZBufferEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance,
     size_t nbfaces = triangles->getIndexListSize();
     bool hasColor = triangles->hasColorList();
 
+    // In id only mode, the shaders still give the transparency of the fragments.
     TriangleShaderPtr shader;
-    if (getRenderingStyle() & eColorBased){
+    if (getRenderingStyle() != eDepthOnly){
         if (threadid != 0) {
             assert(threadid <= ThreadManager::get().nb_threads());
             //printf("session %u\n", threadid);
@@ -296,7 +315,7 @@ void ZBufferEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance,
         }
       
         // shader->initEnv(_camera, __light);
-        renderShadedTriangle(v0, v1, v2, ccw, id, shader, _camera);
+        renderShadedTriangle(v0, v1, v2, ccw, id, shader, _camera, threadid);
 
     }
     // printf("end process TriangleSetPtr\n");
@@ -304,7 +323,7 @@ void ZBufferEngine::iprocess(TriangleSetPtr triangles, AppearancePtr appearance,
 }
 
 
-void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw, const uint32_t id, const TriangleShaderPtr& shader,  const ProjectionCameraPtr& camera)
+void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw, const uint32_t id, const TriangleShaderPtr& shader,  const ProjectionCameraPtr& camera, uint32_t threadid)
 {
     
      // Projection in camera space
@@ -340,7 +359,7 @@ void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(V
     zmin = min3(v0Raster.z(), v1Raster.z(), v2Raster.z());
     zmax = max3(v0Raster.z(), v1Raster.z(), v2Raster.z());
 
-    if(camera->methodType() == ProjectionCamera::eRayIntersection && (std::floor(xmax)-std::floor(xmin)>1) && (std::floor(ymax)-std::floor(ymin)>1)) {
+    if(camera->methodType() == ProjectionCamera::eRayIntersection && !useAffineSpans(camera) && (std::floor(xmax)-std::floor(xmin)>1) && (std::floor(ymax)-std::floor(ymin)>1)) {
         std::pair<Vector3, real_t> csphere = circumsphere(v0Raster,v1Raster,v2Raster);
         Vector3 vMeanRaster = csphere.first;
         real_t radius = csphere.second;
@@ -369,7 +388,21 @@ void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(V
     int32_t y0 = pglMax(int32_t(0), (int32_t)(std::floor(ymin)));
     int32_t y1 = pglMin(int32_t(__imageHeight) - 1, (int32_t)(std::ceil(ymax)));
 
-    if (__multithreaded && (x1-x0+1)*(y1-y0+1) > 20) {
+    bool singlepixel = (x0 == x1) && (y0 == y1);
+
+    if (__binning) {
+        RasterPrimitive primitive;
+        primitive.rect = Index4(x0,x1,y0,y1);
+        primitive.singlepixel = singlepixel;
+        primitive.isfragment = false;
+        primitive.ccw = ccw;
+        primitive.id = id;
+        primitive.vRaster[0] = v0Raster; primitive.vRaster[1] = v1Raster; primitive.vRaster[2] = v2Raster;
+        primitive.vCam[0] = v0Cam; primitive.vCam[1] = v1Cam; primitive.vCam[2] = v2Cam;
+        primitive.shader = is_valid_ptr(shader) ? TriangleShaderPtr(shader->copy()) : shader;
+        binPrimitive(primitive, threadid);
+    }
+    else if (__multithreaded && !__tilebinning && (x1-x0+1)*(y1-y0+1) > 20) {
         std::tuple<Vector3,Vector3,Vector3> vRasters(v0Raster, v1Raster, v2Raster);
         std::tuple<Vector3,Vector3,Vector3> vCams(v0Cam,v1Cam,v2Cam);
 
@@ -377,10 +410,10 @@ void ZBufferEngine::renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(V
                                                   // v0Raster, v1Raster, v2Raster, v0Cam,v1Cam,v2Cam,
                                                   vRasters,vCams,
                                                   ccw, id, 
-                                                  (getRenderingStyle() & eColorBased) ? TriangleShaderPtr(shader->copy()) : shader, ProjectionCameraPtr(camera->copy())));
+                                                  is_valid_ptr(shader) ? TriangleShaderPtr(shader->copy()) : shader, ProjectionCameraPtr(camera->copy())));
     }
     else {
-        rasterize(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,v0Cam,v1Cam,v2Cam,ccw,id,shader,camera);
+        rasterize(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,v0Cam,v1Cam,v2Cam,ccw,id,shader,camera,singlepixel);
     }
 }
 
@@ -398,7 +431,7 @@ void ZBufferEngine::rasterizeMT(const Index4& rect,
               std::get<0>(vRasters),std::get<1>(vRasters),std::get<2>(vRasters),
               std::get<0>(vCams),std::get<1>(vCams),std::get<2>(vCams),
              // v1Raster,v2Raster,v0Cam,v1Cam,v2Cam,
-              ccw,id,shader,camera);  
+              ccw,id,shader,camera,(rect[0] == rect[1]) && (rect[2] == rect[3]));  
 }
 
 void findorder(real_t * zs, int& firstpoint, int& secpoint, int& thirdpoint){
@@ -412,7 +445,7 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
                               TOOLS(Vector3) v0Raster, TOOLS(Vector3) v1Raster, TOOLS(Vector3) v2Raster, 
                               TOOLS(Vector3) v0Cam, TOOLS(Vector3) v1Cam, TOOLS(Vector3) v2Cam, 
                               bool ccw, const uint32_t id, 
-                              const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera)
+                              const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera, bool singlepixel)
 {
 
     // printf("rasterize [%i,%i]*[%i,%i]\n",x0,x1,y0,y1);
@@ -424,21 +457,32 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
 
     // Precompute reciprocal of vertex z-coordinate
     real_t area;
-    if (camera->methodType() == ProjectionCamera::eRayIntersection){
+    bool affine = useAffineSpans(camera);
+    if (camera->methodType() == ProjectionCamera::eRayIntersection && !affine){
         area = norm(cross(v0Cam-v1Cam, v0Cam-v2Cam));
     }
     else {
-        v0Raster.z() = 1. / v0Raster.z();
-        v1Raster.z() = 1. / v1Raster.z();
-        v2Raster.z() = 1. / v2Raster.z();
+        if (!affine) {
+            v0Raster.z() = 1. / v0Raster.z();
+            v1Raster.z() = 1. / v1Raster.z();
+            v2Raster.z() = 1. / v2Raster.z();
+        }
 
         area = edgeFunction(v0Raster, v1Raster, v2Raster, ccw);
+
+        if (!singlepixel && __spanshading) {
+            bool rasterized = (affine ? rasterizeBySpans<true>(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,z0,z1,z2,area,ccw,id,shader,camera)
+                                      : rasterizeBySpans<false>(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,z0,z1,z2,area,ccw,id,shader,camera));
+            if (rasterized) return;
+        }
+        // The other shaders of an orthographic projection use the ray intersections.
+        if (affine) area = norm(cross(v0Cam-v1Cam, v0Cam-v2Cam));
     }
 
     FragmentQueue fragqueue;
 
     // Inner loop
-    if ((x0 == x1) && (y0 == y1)) {
+    if (singlepixel) {
         if (camera->isValidPixel(x0,y0,__imageWidth, __imageHeight)){
             real_t z = (z0+z1+z2)/3;
             real_t w0 = 1/3.;
@@ -497,6 +541,127 @@ void ZBufferEngine::rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
 }
 
 
+bool ZBufferEngine::useAffineSpans(const ProjectionCameraPtr& camera) const
+{
+    return __spanshading && camera->type() == ProjectionCamera::eOrthographic;
+}
+
+template<bool Affine>
+bool ZBufferEngine::rasterizeBySpans(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
+                                     const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const TOOLS(Vector3)& v2Raster, 
+                                     real_t z0, real_t z1, real_t z2, real_t area,
+                                     bool ccw, const uint32_t id, 
+                                     const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera)
+{
+    // The simplest shaders are replaced by their span counterpart, with no virtual call per pixel.
+    // In id only mode, the colors are still computed to skip the totally transparent fragments.
+    TriangleShader * tshader = shader.get();
+    if (tshader != NULL && typeid(*tshader) == typeid(TriangleShaderSelector)) 
+        tshader = static_cast<TriangleShaderSelector *>(tshader)->__current.get();
+    if (tshader == NULL)
+        rasterizeSpans<NoSpanShader,Affine>(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,z0,z1,z2,area,ccw,id,NoSpanShader(),camera);
+    else if (typeid(*tshader) == typeid(ColorBasedShader))
+        rasterizeSpans<ColorSpanShader,Affine>(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,z0,z1,z2,area,ccw,id,ColorSpanShader(*static_cast<ColorBasedShader *>(tshader)),camera);
+    else if (typeid(*tshader) == typeid(GouraudInterpolation))
+        rasterizeSpans<GouraudSpanShader,Affine>(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,z0,z1,z2,area,ccw,id,GouraudSpanShader(*static_cast<GouraudInterpolation *>(tshader)),camera);
+    else if (typeid(*tshader) == typeid(TextureShader))
+        rasterizeSpans<TextureSpanShader,Affine>(x0,x1,y0,y1,v0Raster,v1Raster,v2Raster,z0,z1,z2,area,ccw,id,TextureSpanShader(*static_cast<TextureShader *>(tshader)),camera);
+    else return false;
+    return true;
+}
+
+// Number of pixels of a span processed at once.
+#define PGL_ZBUFFER_SPAN_SIZE 64
+
+template<class SpanShader, bool Affine>
+void ZBufferEngine::rasterizeSpans(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
+                                   const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const TOOLS(Vector3)& v2Raster, 
+                                   real_t z0, real_t z1, real_t z2, real_t area,
+                                   bool ccw, const uint32_t id, 
+                                   const SpanShader& shader, const ProjectionCameraPtr& camera)
+{
+    // Edge e goes from a[e] to b[e] and gives the weight of the opposite vertex.
+    // Along a scanline, an edge function is (px - ax) * dy - rowterm. It is evaluated with
+    // the same operations as edgeFunction so that exactly the same pixels are covered.
+    const Vector3 * a[3] = { &v1Raster, &v2Raster, &v0Raster };
+    const Vector3 * b[3] = { &v2Raster, &v0Raster, &v1Raster };
+    real_t ax[3], dy[3];
+    for (int e = 0; e < 3; ++e) {
+        ax[e] = a[e]->x();
+        dy[e] = (ccw ? b[e]->y() - a[e]->y() : a[e]->y() - b[e]->y());
+    }
+
+    real_t w[3][PGL_ZBUFFER_SPAN_SIZE];
+    int32_t xs[PGL_ZBUFFER_SPAN_SIZE];
+    real_t zs[PGL_ZBUFFER_SPAN_SIZE];
+    float ws[3][PGL_ZBUFFER_SPAN_SIZE];
+    Color4 colors[SpanShader::colored ? PGL_ZBUFFER_SPAN_SIZE : 1];
+
+    for (int32_t y = y0; y <= y1; ++y) {
+        real_t py = y + 0.5;
+        real_t rowterm[3];
+        for (int e = 0; e < 3; ++e)
+            rowterm[e] = (ccw ? (py - a[e]->y()) * (b[e]->x() - a[e]->x()) : (a[e]->x() - b[e]->x()) * (py - a[e]->y()));
+
+        for (int32_t xbegin = x0; xbegin <= x1; xbegin += PGL_ZBUFFER_SPAN_SIZE) {
+            int32_t nbpixels = pglMin<int32_t>(PGL_ZBUFFER_SPAN_SIZE, x1 - xbegin + 1);
+
+            // Edge functions of the whole span, with no branch.
+            for (int e = 0; e < 3; ++e) {
+                real_t * we = w[e];
+                for (int32_t i = 0; i < nbpixels; ++i) {
+                    real_t t = (xbegin + i + 0.5 - ax[e]) * dy[e];
+                    we[i] = (ccw ? t - rowterm[e] : rowterm[e] - t);
+                }
+            }
+
+            // Covered pixels in front of the depth buffer
+            int32_t nbvisible = 0;
+            for (int32_t i = 0; i < nbpixels; ++i) {
+                real_t w0 = w[0][i], w1 = w[1][i], w2 = w[2][i];
+                if ((w0 > -GEOM_EPSILON && w1 > -GEOM_EPSILON && w2 > -GEOM_EPSILON) || (w0 < GEOM_EPSILON && w1 < GEOM_EPSILON && w2 < GEOM_EPSILON)) {
+                    w0 /= area;
+                    w1 /= area;
+                    w2 /= area;
+                    // An affine projection interpolates the depth linearly. A perspective one interpolates its reciprocal.
+                    real_t z = (Affine ? v0Raster.z() * w0 + v1Raster.z() * w1 + v2Raster.z() * w2
+                                       : 1. / (v0Raster.z() * w0 + v1Raster.z() * w1 + v2Raster.z() * w2));
+                    int32_t x = xbegin + i;
+                    if (camera->isInZRange(z) && isVisible(x, y, z)) {
+                        xs[nbvisible] = x;
+                        zs[nbvisible] = z;
+                        ws[0][nbvisible] = (Affine ? w0 : w0 * z / z0);
+                        ws[1][nbvisible] = (Affine ? w1 : w1 * z / z1);
+                        ws[2][nbvisible] = (Affine ? w2 : w2 * z / z2);
+                        ++nbvisible;
+                    }
+                }
+            }
+            if (nbvisible == 0) continue;
+
+            shader.shade(nbvisible, ws[0], ws[1], ws[2], colors);
+
+            for (int32_t i = 0; i < nbvisible; ++i) {
+                int32_t x = xs[i];
+                real_t z = zs[i];
+                if (SpanShader::colored && isTotallyTransparent(colors[i].getAlpha())) continue;
+                // The depth is tested again since other threads may have written the pixel.
+                lock(x,y);
+                if (isVisible(x,y,z)) {
+                    __depthBuffer->setAt(x, y, z);
+                    if(__style & eColorBased){
+                        setFrameBufferAt(x, y, SpanShader::colored ? colors[i] : Color4::BLACK);
+                    }
+                    if(__style & eIdBased){
+                        __idBuffer->setAt(x, y, id);
+                    }
+                }
+                unlock(x,y);
+            }
+        }
+    }
+}
+
 
 void ZBufferEngine::renderTriangle(const Vector3& v0, const Vector3& v1, const Vector3& v2, 
                                      const Color4& c0,  const Color4& c1,  const Color4& c2, 
@@ -510,7 +675,7 @@ void ZBufferEngine::renderTriangle(const Vector3& v0, const Vector3& v1, const V
 }
 
 
-void ZBufferEngine::renderPoint(const TOOLS(Vector3)& v, const Color4& c, const uint32_t width, const uint32_t id, ProjectionCameraPtr camera)
+void ZBufferEngine::renderPoint(const TOOLS(Vector3)& v, const Color4& c, const uint32_t width, const uint32_t id, ProjectionCameraPtr camera, uint32_t threadid)
 {
     
     if(is_null_ptr(camera)) camera = __camera;
@@ -539,18 +704,18 @@ void ZBufferEngine::renderPoint(const TOOLS(Vector3)& v, const Color4& c, const
     for (int32_t y = y0; y <= y1; ++y) {
         for (int32_t x = x0; x <= x1; ++x) {
             if (camera->isValidPixel(x,y,__imageWidth, __imageHeight)){
-                renderRaster(x, y, vRaster.z(), c, id);
+                _renderOrBinRaster(x, y, vRaster.z(), c, id, threadid);
             }
         }
     }
 }
 
-void ZBufferEngine::renderSegment(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const Color4& c0, const Color4& c1, const uint32_t width, const uint32_t id, ProjectionCameraPtr camera)
+void ZBufferEngine::renderSegment(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const Color4& c0, const Color4& c1, const uint32_t width, const uint32_t id, ProjectionCameraPtr camera, uint32_t threadid)
 {
     if(is_null_ptr(camera)) camera = __camera;
 
-    renderPoint(v0, c0, width, id, camera);
-    renderPoint(v1, c1, width, id, camera);
+    renderPoint(v0, c0, width, id, camera, threadid);
+    renderPoint(v1, c1, width, id, camera, threadid);
 
     Vector3 v0Cam = camera->worldToCamera(v0);
     Vector3 v1Cam = camera->worldToCamera(v1);
@@ -561,23 +726,23 @@ void ZBufferEngine::renderSegment(const TOOLS(Vector3)& v0, const TOOLS(Vector3)
 
     if (fabs(v1Raster.y()-v0Raster.y()) < fabs(v1Raster.x()-v0Raster.x())){
         if(v0Raster.x() > v1Raster.x()){
-            _renderSegment(0, v1Raster, v0Raster, c1, c0, width, id);
+            _renderSegment(0, v1Raster, v0Raster, c1, c0, width, id, threadid);
         }
         else{
-            _renderSegment(0, v0Raster, v1Raster, c0, c1, width, id);
+            _renderSegment(0, v0Raster, v1Raster, c0, c1, width, id, threadid);
         }
     }
     else {
         if(v0Raster.y() > v1Raster.y()){
-            _renderSegment(1, v1Raster, v0Raster, c1, c0, width, id);
+            _renderSegment(1, v1Raster, v0Raster, c1, c0, width, id, threadid);
         }
         else {
-            _renderSegment(1, v0Raster, v1Raster, c0, c1, width, id);
+            _renderSegment(1, v0Raster, v1Raster, c0, c1, width, id, threadid);
         }
     }
 }
 
-void ZBufferEngine::_renderSegment(uchar dim, const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const Color4& c0, const Color4& c1, const uint32_t width, const uint32_t id)
+void ZBufferEngine::_renderSegment(uchar dim, const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const Color4& c0, const Color4& c1, const uint32_t width, const uint32_t id, uint32_t threadid)
 {
     Vector3 dRaster = v1Raster - v0Raster;
     real_t totW = norm(dRaster);
@@ -608,7 +773,7 @@ void ZBufferEngine::_renderSegment(uchar dim, const TOOLS(Vector3)& v0Raster, co
             for (int di = w0 ; di <= w1; ++di) {
                 ciRaster[otherdim] = di;
                 if (__camera->isValidPixel(ciRaster.x(),ciRaster.y(),__imageWidth, __imageHeight)){
-                    renderRaster(ciRaster.x(), ciRaster.y(), ciRaster.z(), c, id);
+                    _renderOrBinRaster(ciRaster.x(), ciRaster.y(), ciRaster.z(), c, id, threadid);
                 }
             }
         }
@@ -630,13 +795,13 @@ void ZBufferEngine::iprocess(PolylinePtr polyline, MaterialPtr material, uint32_
         Color4ArrayPtr colorlist = polyline->getColorList();
         if (is_valid_ptr(colorlist)){
             for(uint32_t i = 0; i < points->size()-1; ++i){
-                renderSegment(points->getAt(i), points->getAt(i+1), colorlist->getAt(i), colorlist->getAt(i+1), polyline->getWidth(), id, camera );
+                renderSegment(const_array(*points).getAt(i), const_array(*points).getAt(i+1), const_array(*colorlist).getAt(i), const_array(*colorlist).getAt(i+1), polyline->getWidth(), id, camera, threadid );
             }
         }
         else {
             Color4 color = Color4(material->getDiffuseColor(),material->getTransparency());
             for(uint32_t i = 0; i < points->size()-1; ++i){
-                renderSegment(points->getAt(i), points->getAt(i+1), color, color, polyline->getWidth(), id, camera );
+                renderSegment(const_array(*points).getAt(i), const_array(*points).getAt(i+1), color, color, polyline->getWidth(), id, camera, threadid );
             }
 
         }
@@ -652,31 +817,28 @@ void ZBufferEngine::iprocess(PointSetPtr pointset, MaterialPtr material, uint32_
     Color4Array::const_iterator itCol;
     bool colorPerPoint = pointset->hasColorList();
     if (colorPerPoint) {
-        itCol = pointset->getColorList()->begin();
+        itCol = const_array(*pointset->getColorList()).begin();
     }
     uint32_t pointsize = pointset->getWidth();
-    for (Point3Array::const_iterator it = points->begin(); it!= points->end(); ++it)
+    for (Point3Array::const_iterator it = const_array(*points).begin(); it!= const_array(*points).end(); ++it)
     {
-        renderPoint(*it, (colorPerPoint?*itCol:defaultcolor), pointsize, id, camera);
+        renderPoint(*it, (colorPerPoint?*itCol:defaultcolor), pointsize, id, camera, threadid);
     }
 }
 
-ImagePtr ZBufferEngine::getTexture(const ImageTexturePtr imgdef)
+MipmapTexturePtr ZBufferEngine::getTexture(const ImageTexturePtr imgdef)
 {
-    Cache<ImagePtr>::const_Iterator it = __cachetexture.find(imgdef->getObjectId());
-    if (it != __cachetexture.end()){
-        return it->second;
-    }
-    else {
-        ImagePtr img(new Image(imgdef->getFilename()));
-        __cachetexture.insert(imgdef->getObjectId(),img);
-        return img;
-    }
+    return MipmapTexture::get(imgdef);
 }
 
 
 void ZBufferEngine::process(ScenePtr scene)
 {
+    PGL_PROFILE_ZONE("ZBufferEngine::process");
+    if(__multithreaded && __tilebinning) {
+        processSceneTiled(scene);
+        return;
+    }
     beginProcess();
     size_t msize = scene->size();
     if(__multithreaded && msize > 100){
@@ -710,6 +872,7 @@ void ZBufferEngine::process(ScenePtr scene)
 
 void ZBufferEngine::processScene(Scene::const_iterator scene_begin, Scene::const_iterator scene_end, ProjectionCameraPtr camera, uint32_t threadid)
 {
+    PGL_PROFILE_ZONE("ZBufferEngine::processScene");
     Discretizer d;
     Tesselator t;
     ProjectionRenderer r(*this, camera, t, d, threadid);
@@ -718,6 +881,183 @@ void ZBufferEngine::processScene(Scene::const_iterator scene_begin, Scene::const
 }
 
 
+void ZBufferEngine::processSceneTiled(ScenePtr scene)
+{
+    beginProcess();
+    beginBinning();
+    size_t msize = scene->size();
+    size_t nbthreads = ThreadManager::get().nb_threads();
+    size_t nbShapePerThread = (msize / nbthreads);
+    if (nbShapePerThread * nbthreads < msize) { nbShapePerThread += 1; }
+
+    // Geometry stage: contiguous ranges of shapes are projected and their primitives binned into tiles.
+    uint32_t threadid = 1;
+    for (size_t i = 0 ; i < msize ; i+=nbShapePerThread, ++threadid) {
+        Scene::const_iterator itbegin = scene->begin() + i ;
+        Scene::const_iterator itend = scene->begin() + pglMin(msize, i + nbShapePerThread);
+        ThreadManager::get().new_task(boost::bind(&ZBufferEngine::processScene, this, itbegin, itend, ProjectionCameraPtr(__camera->copy()),threadid));
+    }
+    ThreadManager::get().join();
+
+    rasterizeBins();
+    endProcess();
+}
+
+void ZBufferEngine::beginBinning()
+{
+    size_t nbthreads = ThreadManager::get().nb_threads();
+    if(__triangleshaderset != NULL) delete [] __triangleshaderset;
+    __triangleshaderset = new TriangleShaderPtr[nbthreads];
+    for (size_t j = 0 ; j < nbthreads ; ++j){
+        __triangleshaderset[j] = TriangleShaderPtr(is_valid_ptr(__triangleshader) ? __triangleshader->copy(true) : NULL);
+    }
+
+    __nbtilesx = (__imageWidth + __tilesize - 1) / __tilesize;
+    __nbtilesy = (__imageHeight + __tilesize - 1) / __tilesize;
+    __tilebins.assign(nbthreads+1, TileBins());
+    for (std::vector<TileBins>::iterator itbins = __tilebins.begin(); itbins != __tilebins.end(); ++itbins)
+        itbins->tiles.resize(__nbtilesx * __nbtilesy);
+    __binning = true;
+}
+
+void ZBufferEngine::rasterizeBins()
+{
+    PGL_PROFILE_ZONE("ZBufferEngine::rasterizeBins");
+    __binning = false;
+
+    // Raster stage: each tile is rasterized by a single thread.
+    for (uint32_t tileid = 0; tileid < __nbtilesx * __nbtilesy; ++tileid) {
+        ThreadManager::get().new_task(boost::bind(&ZBufferEngine::rasterizeTile, this, tileid));
+    }
+    ThreadManager::get().join();
+
+    __tilebins.clear();
+}
+
+// Number of triangles of a compiled scene from which the rendering is split among threads.
+#define PGL_ZBUFFER_MT_MIN_TRIANGLES 2048
+
+void ZBufferEngine::process(const CompiledScenePtr& scene)
+{
+    PGL_PROFILE_ZONE("ZBufferEngine::process");
+    beginProcess();
+    size_t nbtriangles = scene->nbTriangles();
+    bool tiled = __multithreaded && __tilebinning;
+    if(tiled || (__multithreaded && nbtriangles > PGL_ZBUFFER_MT_MIN_TRIANGLES)){
+        if (tiled) beginBinning();
+        size_t nbthreads = ThreadManager::get().nb_threads();
+        size_t nbTrianglePerThread = (nbtriangles / nbthreads);
+        if (nbTrianglePerThread * nbthreads < nbtriangles) { nbTrianglePerThread += 1; }
+
+        uint32_t threadid = 1;
+        for (size_t i = 0 ; i < nbtriangles ; i+=nbTrianglePerThread, ++threadid) {
+            ThreadManager::get().new_task(boost::bind(&ZBufferEngine::processCompiledScene, this, scene, i, pglMin(nbtriangles, i + nbTrianglePerThread), ProjectionCameraPtr(__camera->copy()),threadid));
+        }
+        if (tiled) {
+            ThreadManager::get().join();
+            rasterizeBins();
+        }
+    }
+    else {
+        processCompiledScene(scene, 0, nbtriangles, __camera);
+    }
+    endProcess();
+}
+
+void ZBufferEngine::process(const InstancedScenePtr& instances)
+{
+    process(CompiledScenePtr(new CompiledScene(instances)));
+}
+
+void ZBufferEngine::processCompiledScene(const CompiledScenePtr& scene, size_t begin, size_t end, ProjectionCameraPtr camera, uint32_t threadid)
+{
+    PGL_PROFILE_ZONE("ZBufferEngine::processCompiledScene");
+    // Colors are interpolated from the lighting of the material at the vertices, as with a Gouraud shading.
+    GouraudInterpolation * shader = NULL;
+    TriangleShaderPtr shaderptr;
+    if (getRenderingStyle() != eDepthOnly) {
+        shader = new GouraudInterpolation(this);
+        shader->initEnv(camera, __light);
+        shaderptr = TriangleShaderPtr(shader);
+    }
+
+    const std::vector<uint32_t>& shapeids = scene->getShapeIds();
+    uint32_t currentmaterial = UINT32_MAX;
+    MaterialPtr material;
+    for (size_t i = begin; i < end; ++i) {
+        const Vector3& v0 = scene->getTrianglePointAt(i,0);
+        const Vector3& v1 = scene->getTrianglePointAt(i,1);
+        const Vector3& v2 = scene->getTrianglePointAt(i,2);
+        if (shader) {
+            uint32_t materialid = scene->getMaterialIds()[i];
+            if (materialid != currentmaterial) {
+                currentmaterial = materialid;
+                material = dynamic_pointer_cast<Material>(scene->getMaterials()[materialid]);
+                if (is_null_ptr(material)) material = dynamic_pointer_cast<Material>(Material::DEFAULT_MATERIAL);
+            }
+            shader->c0 = phong(v0, scene->getTriangleNormalAt(i,0), camera->position(), __light, material);
+            shader->c1 = phong(v1, scene->getTriangleNormalAt(i,1), camera->position(), __light, material);
+            shader->c2 = phong(v2, scene->getTriangleNormalAt(i,2), camera->position(), __light, material);
+        }
+        renderShadedTriangle(v0, v1, v2, true, shapeids[i], shaderptr, camera, threadid);
+    }
+}
+
+void ZBufferEngine::binPrimitive(const RasterPrimitive& primitive, uint32_t threadid)
+{
+    TileBins& bins = __tilebins[threadid];
+    uint32_t primitiveid = bins.primitives.size();
+    bins.primitives.push_back(primitive);
+    for (uint32_t ty = primitive.rect[2] / __tilesize; ty <= primitive.rect[3] / __tilesize; ++ty)
+        for (uint32_t tx = primitive.rect[0] / __tilesize; tx <= primitive.rect[1] / __tilesize; ++tx)
+            bins.tiles[ty * __nbtilesx + tx].push_back(primitiveid);
+}
+
+void ZBufferEngine::rasterizeTile(uint32_t tileid)
+{
+    PGL_PROFILE_ZONE("ZBufferEngine::rasterizeTile");
+    int32_t tx0 = (tileid % __nbtilesx) * __tilesize;
+    int32_t ty0 = (tileid / __nbtilesx) * __tilesize;
+    int32_t tx1 = pglMin<int32_t>(tx0 + __tilesize, __imageWidth) - 1;
+    int32_t ty1 = pglMin<int32_t>(ty0 + __tilesize, __imageHeight) - 1;
+
+    // bins are ordered as the shapes in the scene. Thus pixels receive their fragments in the same order as in the single threaded mode.
+    for (std::vector<TileBins>::const_iterator itbins = __tilebins.begin(); itbins != __tilebins.end(); ++itbins){
+        const std::vector<uint32_t>& tile = itbins->tiles[tileid];
+        for (std::vector<uint32_t>::const_iterator itprim = tile.begin(); itprim != tile.end(); ++itprim){
+            const RasterPrimitive& primitive = itbins->primitives[*itprim];
+            if (primitive.isfragment) {
+                renderRaster(primitive.rect[0], primitive.rect[2], primitive.vRaster[0].z(), primitive.color, primitive.id);
+            }
+            else {
+                rasterize(pglMax<int32_t>(primitive.rect[0], tx0), pglMin<int32_t>(primitive.rect[1], tx1),
+                          pglMax<int32_t>(primitive.rect[2], ty0), pglMin<int32_t>(primitive.rect[3], ty1),
+                          primitive.vRaster[0], primitive.vRaster[1], primitive.vRaster[2],
+                          primitive.vCam[0], primitive.vCam[1], primitive.vCam[2],
+                          primitive.ccw, primitive.id, primitive.shader, __camera, primitive.singlepixel);
+            }
+        }
+    }
+}
+
+void ZBufferEngine::_renderOrBinRaster(uint32_t x, uint32_t y, real_t z, const Color4& rasterColor, const uint32_t id, uint32_t threadid)
+{
+    if (__binning) {
+        RasterPrimitive primitive;
+        primitive.rect = Index4(x,x,y,y);
+        primitive.singlepixel = true;
+        primitive.isfragment = true;
+        primitive.ccw = true;
+        primitive.id = id;
+        primitive.vRaster[0] = Vector3(x,y,z);
+        primitive.color = rasterColor;
+        binPrimitive(primitive, threadid);
+    }
+    else {
+        renderRaster(x, y, z, rasterColor, id);
+    }
+}
+
 void ZBufferEngine::duplicateBuffer(const TOOLS(Vector3)& from, const TOOLS(Vector3)& to, bool useDefaultColor, const Color3& defaultcolor)
 {
     Vector3 vRasterFrom = __camera->worldToRaster(from,__imageWidth, __imageHeight);
@@ -870,6 +1210,18 @@ void ThreadManager::process_task(std::function<void()> task)
     __threadend_mutex.unlock();
 }
 
+void ThreadManager::set_nb_threads(size_t nbthreads)
+{
+    if (nbthreads == 0 || nbthreads == __nb_threads) return;
+    join();
+    if(__pool != NULL) {
+        __pool->join();
+        delete __pool;
+        __pool = NULL;
+    }
+    __nb_threads = nbthreads;
+}
+
 void ThreadManager::join()
 {
     while(!hasCompletedTasks()){
@@ -1026,12 +1378,12 @@ ScenePtr ZBufferEngine::grabSortedZBufferPoints(real_t jitter, real_t raywidth )
     }
     else {
         typedef pgl_hash_map<uint32_t,PointSetPtr> PointSetMap;
-        Point3Array::const_iterator piter = std::get<0>(pointinfos)->begin();
-        Point3Array::const_iterator piterend = std::get<0>(pointinfos)->end();
+        Point3Array::const_iterator piter = const_array(*std::get<0>(pointinfos)).begin();
+        Point3Array::const_iterator piterend = const_array(*std::get<0>(pointinfos)).end();
         bool hasColor = is_valid_ptr(std::get<1>(pointinfos));
         Color3Array::const_iterator citer;
-        if (hasColor) citer = std::get<1>(pointinfos)->begin();
-        Uint32Array1::const_iterator iiter = std::get<2>(pointinfos)->begin();
+        if (hasColor) citer = const_array(*std::get<1>(pointinfos)).begin();
+        Uint32Array1::const_iterator iiter = const_array(*std::get<2>(pointinfos)).begin();
         PointSetMap idmap;
         for(;piter != piterend; ++piter, ++citer, ++iiter){
             PointSetMap::const_iterator imiter = idmap.find(*iiter);
@@ -1090,12 +1442,12 @@ RealArray2Ptr PGL(formFactors)(const Point3ArrayPtr& points,
     RealArray2Ptr result(new RealArray2(triangles->size(),triangles->size(),0));
     uint32_t id = 0;
     Color4 color = Color4::BLACK;
-    for(Index3Array::const_iterator it = triangles->begin(); it != triangles->end(); ++it, ++id){
-        const Vector3& v0 = points->getAt((*it)[0]); 
-        const Vector3& v1 = points->getAt((*it)[1]); 
-        const Vector3& v2 = points->getAt((*it)[2]); 
+    for(Index3Array::const_iterator it = const_array(*triangles).begin(); it != const_array(*triangles).end(); ++it, ++id){
+        const Vector3& v0 = const_array(*points).getAt((*it)[0]); 
+        const Vector3& v1 = const_array(*points).getAt((*it)[1]); 
+        const Vector3& v2 = const_array(*points).getAt((*it)[2]); 
         Vector3 center = (v0+v1+v2)/3;
-        Vector3 normal = (is_valid_ptr(normals) ? normals->getAt(id) : cross(v1-v0,v2-v0));
+        Vector3 normal = (is_valid_ptr(normals) ? const_array(*normals).getAt(id) : cross(v1-v0,v2-v0));
         if(normal.normalize() > GEOM_EPSILON){
             Vector3 up = v0-center;
             ZBufferEngine ze(discretization,discretization,ZBufferEngine::eIdBased, Color3::BLACK, Shape::NOID, false);
@@ -1103,9 +1455,9 @@ RealArray2Ptr PGL(formFactors)(const Point3ArrayPtr& points,
             ze.lookAt(center, center+normal, up);
             uint32_t id2 = 0;
             ze.beginProcess();
-            for(Index3Array::const_iterator it2 = triangles->begin(); it2 != triangles->end(); ++it2, ++id2){
+            for(Index3Array::const_iterator it2 = const_array(*triangles).begin(); it2 != const_array(*triangles).end(); ++it2, ++id2){
                 if (it2 != it){
-                    ze.renderTriangle(points->getAt((*it2)[0]), points->getAt((*it2)[1]), points->getAt((*it2)[2]), 
+                    ze.renderTriangle(const_array(*points).getAt((*it2)[0]), const_array(*points).getAt((*it2)[1]), const_array(*points).getAt((*it2)[2]), 
                                       color, color, color, ccw, id2);
                 }
             }
@@ -1119,3 +1471,447 @@ RealArray2Ptr PGL(formFactors)(const Point3ArrayPtr& points,
     return result;
 }
 
+/* ----------------------------------------------------------------------- */
+
+// A hemicube engine reused for all the rows computed by a thread.
+class FormFactorEngine : public ZBufferEngine {
+public:
+    FormFactorEngine(uint16_t discretization, bool solidangle):
+        ZBufferEngine(discretization,discretization,ZBufferEngine::eIdBased, Color3::BLACK, Shape::NOID, false),
+        __emptyDepthBuffer(),
+        __weights()
+    {
+        setHemisphericCamera();
+        __emptyDepthBuffer = std::vector<real_t>(__depthBuffer->begin(), __depthBuffer->end());
+        __weights.reserve(__emptyDepthBuffer.size());
+        for (int32_t i = 0 ; i < __imageWidth ; i++) 
+            for (int32_t j = 0 ; j < __imageHeight ; j++) 
+                __weights.push_back(solidangle ? __camera->solidAngle(i,j,__imageWidth,__imageHeight) : 1);
+    }
+
+    void processRow(uint32_t id, 
+                    const Point3ArrayPtr& points, 
+                    const Index3ArrayPtr& triangles, 
+                    const std::vector<Vector3>& centers,
+                    const std::vector<Vector3>& normals,
+                    bool ccw,
+                    std::vector<real_t>& accumulator,
+                    std::vector<std::pair<uint32_t,real_t> >& row)
+    {
+        const Vector3& center = centers[id];
+        const Vector3& normal = normals[id];
+        lookAt(center, center+normal, const_array(*points).getAt(const_array(*triangles).getAt(id)[0])-center);
+        std::copy(__emptyDepthBuffer.begin(), __emptyDepthBuffer.end(), __depthBuffer->begin());
+        std::fill(__idBuffer->begin(), __idBuffer->end(), __defaultid);
+
+        uint32_t id2 = 0;
+        for(Index3Array::const_iterator it2 = const_array(*triangles).begin(); it2 != const_array(*triangles).end(); ++it2, ++id2){
+            if (id2 == id) continue;
+            const Vector3& v0 = const_array(*points).getAt((*it2)[0]); 
+            const Vector3& v1 = const_array(*points).getAt((*it2)[1]); 
+            const Vector3& v2 = const_array(*points).getAt((*it2)[2]); 
+            // cull the triangles totally behind the hemisphere plane.
+            if (dot(v0-center,normal) < 0 && dot(v1-center,normal) < 0 && dot(v2-center,normal) < 0) continue;
+            renderShadedTriangle(v0, v1, v2, ccw, id2, TriangleShaderPtr(), __camera);
+        }
+
+        std::vector<uint32_t> seen;
+        std::vector<real_t>::const_iterator itWeight = __weights.begin();
+        for (Uint32Array2::const_iterator itId = __idBuffer->begin(); itId != __idBuffer->end(); ++itId, ++itWeight){
+            if (*itId != __defaultid){
+                if (accumulator[*itId] == 0) seen.push_back(*itId);
+                accumulator[*itId] += *itWeight;
+            }
+        }
+        std::sort(seen.begin(), seen.end());
+        row.clear();
+        for (std::vector<uint32_t>::const_iterator itSeen = seen.begin(); itSeen != seen.end(); ++itSeen){
+            row.push_back(std::pair<uint32_t,real_t>(*itSeen, accumulator[*itSeen]));
+            accumulator[*itSeen] = 0;
+        }
+    }
+
+protected:
+    std::vector<real_t> __emptyDepthBuffer;
+    std::vector<real_t> __weights;
+};
+
+static void computeFormFactorRows(std::atomic<uint32_t> * nextrow,
+                                  const Point3ArrayPtr& points, 
+                                  const Index3ArrayPtr& triangles, 
+                                  const std::vector<Vector3> * centers,
+                                  const std::vector<Vector3> * normals,
+                                  bool ccw,
+                                  uint16_t discretization,
+                                  bool solidangle,
+                                  std::vector<std::vector<std::pair<uint32_t,real_t> > > * rows)
+{
+    FormFactorEngine engine(discretization, solidangle);
+    std::vector<real_t> accumulator(triangles->size(), 0);
+    uint32_t nbtriangles = triangles->size();
+    for (uint32_t id = (*nextrow)++; id < nbtriangles; id = (*nextrow)++){
+        if (norm((*normals)[id]) > GEOM_EPSILON)
+            engine.processRow(id, points, triangles, *centers, *normals, ccw, accumulator, (*rows)[id]);
+    }
+}
+
+SparseFormFactors PGL(sparseFormFactors)(const Point3ArrayPtr& points, 
+                                         const Index3ArrayPtr& triangles, 
+                                         const Point3ArrayPtr& normals,
+                                         bool ccw,
+                                         uint16_t discretization,
+                                         bool solidangle)
+{
+    uint32_t nbtriangles = triangles->size();
+    std::vector<Vector3> centers(nbtriangles);
+    std::vector<Vector3> unitnormals(nbtriangles);
+    uint32_t id = 0;
+    for(Index3Array::const_iterator it = const_array(*triangles).begin(); it != const_array(*triangles).end(); ++it, ++id){
+        const Vector3& v0 = const_array(*points).getAt((*it)[0]); 
+        const Vector3& v1 = const_array(*points).getAt((*it)[1]); 
+        const Vector3& v2 = const_array(*points).getAt((*it)[2]); 
+        centers[id] = (v0+v1+v2)/3;
+        Vector3 normal = (is_valid_ptr(normals) ? const_array(*normals).getAt(id) : cross(v1-v0,v2-v0));
+        // degenerated triangles get a null normal and an empty row.
+        unitnormals[id] = (normal.normalize() > GEOM_EPSILON ? normal : Vector3::ORIGIN);
+    }
+
+    std::vector<std::vector<std::pair<uint32_t,real_t> > > rows(nbtriangles);
+    std::atomic<uint32_t> nextrow(0);
+    size_t nbthreads = pglMin<size_t>(ThreadManager::get().nb_threads(), pglMax<size_t>(1,nbtriangles));
+    for (size_t i = 0 ; i < nbthreads ; ++i) {
+        ThreadManager::get().new_task(boost::bind(&computeFormFactorRows, &nextrow, points, triangles, &centers, &unitnormals, ccw, discretization, solidangle, &rows));
+    }
+    ThreadManager::get().join();
+
+    Uint32Array1Ptr rowpointers(new Uint32Array1(nbtriangles+1));
+    uint32_t nbvalues = 0;
+    for(uint32_t i = 0; i < nbtriangles; ++i){
+        rowpointers->setAt(i, nbvalues);
+        nbvalues += rows[i].size();
+    }
+    rowpointers->setAt(nbtriangles, nbvalues);
+
+    Uint32Array1Ptr columns(new Uint32Array1(nbvalues));
+    RealArrayPtr values(new RealArray(nbvalues));
+    Uint32Array1::iterator itColumn = columns->begin();
+    RealArray::iterator itValue = values->begin();
+    for(std::vector<std::vector<std::pair<uint32_t,real_t> > >::iterator itRow = rows.begin(); itRow != rows.end(); ++itRow){
+        for(std::vector<std::pair<uint32_t,real_t> >::const_iterator it = itRow->begin(); it != itRow->end(); ++it, ++itColumn, ++itValue){
+            *itColumn = it->first;
+            *itValue = it->second;
+        }
+        std::vector<std::pair<uint32_t,real_t> >().swap(*itRow);
+    }
+    return SparseFormFactors(rowpointers, columns, values);
+}
+
+/* ----------------------------------------------------------------------- */
+
+// A projection engine that records the primitives of a scene in world coordinates.
+class WorldPrimitiveRecorder : public ProjectionEngine {
+public:
+    WorldPrimitiveRecorder(MultiViewZBufferEngine& target):
+        ProjectionEngine(), __target(target) {}
+
+    virtual void iprocess(TriangleSetPtr triangles, AppearancePtr appearance, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid)
+    { __target.addTriangles(triangles, appearance, camera->getModelTransformationMatrix(), id); }
+
+    virtual void iprocess(PolylinePtr polyline, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid)
+    { __target.addSegments(polyline, materialColor(material), camera->getModelTransformationMatrix(), id); }
+
+    virtual void iprocess(PointSetPtr pointset, MaterialPtr material, uint32_t id, ProjectionCameraPtr camera, uint32_t threadid)
+    { __target.addPoints(pointset, materialColor(material), camera->getModelTransformationMatrix(), id); }
+
+protected:
+    static Color4 materialColor(const MaterialPtr& material)
+    { return is_valid_ptr(material) ? Color4(material->getDiffuseColor(),material->getTransparency()) : Color4::BLACK; }
+
+    MultiViewZBufferEngine& __target;
+};
+
+// An id engine reused for all the views rendered by a thread.
+class MultiViewEngine : public ZBufferEngine {
+public:
+    MultiViewEngine(uint16_t imageWidth, uint16_t imageHeight, uint32_t defaultid):
+        ZBufferEngine(imageWidth, imageHeight, ZBufferEngine::eIdBased, Color3::BLACK, defaultid, false)
+    { }
+
+    void processView(const MultiViewZBufferEngine& scene, MultiViewZBufferEngine::View& view, bool keepBuffers, bool solidangle)
+    {
+        __camera = view.camera;
+        std::fill(__depthBuffer->begin(), __depthBuffer->end(), REAL_MAX);
+        std::fill(__idBuffer->begin(), __idBuffer->end(), __defaultid);
+        if (__camera->type() == ProjectionCamera::eHemispheric) {
+            // as in setSphericalCamera, the pixels out of the view are hidden.
+            for (uint32_t x = 0; x < __imageWidth; ++x)
+                for (uint32_t y = 0; y < __imageHeight; ++y)
+                    if (!__camera->isValidPixel(x,y,__imageWidth,__imageHeight))
+                        __depthBuffer->setAt(x, y, __camera->near);
+        }
+
+        const std::vector<MultiViewZBufferEngine::PrimitiveBlock>& blocks = scene.getBlocks();
+        for(std::vector<MultiViewZBufferEngine::PrimitiveBlock>::const_iterator itBlock = blocks.begin(); itBlock != blocks.end(); ++itBlock){
+            if (scene.isInView(*itBlock, __camera)) scene.render(*this, *itBlock, __camera);
+        }
+
+        view.histogram.clear();
+        for (int32_t i = 0 ; i < __imageWidth ; i++) {
+            for (int32_t j = 0 ; j < __imageHeight ; j++) {
+                uint32_t pid = __idBuffer->getAt(i,j);
+                if (pid != __defaultid){
+                    view.histogram[pid] += (solidangle ? __camera->solidAngle(i,j,__imageWidth,__imageHeight) : 1);
+                }
+            }
+        }
+
+        if (keepBuffers) {
+            view.depthBuffer = RealArray2Ptr(new RealArray2(*__depthBuffer));
+            view.idBuffer = Uint32Array2Ptr(new Uint32Array2(*__idBuffer));
+        }
+        else {
+            view.depthBuffer = RealArray2Ptr();
+            view.idBuffer = Uint32Array2Ptr();
+        }
+    }
+};
+
+static void renderViews(std::atomic<uint32_t> * nextview,
+                        const MultiViewZBufferEngine * scene,
+                        std::vector<MultiViewZBufferEngine::View> * views,
+                        bool keepBuffers,
+                        bool solidangle)
+{
+    MultiViewEngine engine(scene->getImageWidth(), scene->getImageHeight(), scene->getDefaultId());
+    uint32_t nbviews = views->size();
+    for (uint32_t view = (*nextview)++; view < nbviews; view = (*nextview)++){
+        engine.processView(*scene, (*views)[view], keepBuffers, solidangle);
+    }
+}
+
+MultiViewZBufferEngine::MultiViewZBufferEngine(uint16_t imageWidth, uint16_t imageHeight, uint32_t defaultid):
+    __imageWidth(imageWidth),
+    __imageHeight(imageHeight),
+    __defaultid(defaultid)
+{
+}
+
+MultiViewZBufferEngine::~MultiViewZBufferEngine()
+{
+}
+
+void MultiViewZBufferEngine::setScene(ScenePtr scene)
+{
+    __blocks.clear();
+    __triangles.clear();
+    __vertices.clear();
+    __colors.clear();
+    __shapeids.clear();
+    __shapeblocks.clear();
+
+    WorldPrimitiveRecorder recorder(*this);
+    Discretizer d;
+    Tesselator t;
+    ProjectionRenderer r(recorder, recorder.camera(), t, d);
+    for (Scene::const_iterator it = scene->begin(); it != scene->end(); ++it){
+        ShapePtr sh = dynamic_pointer_cast<Shape>(*it);
+        __shapeids.push_back(is_valid_ptr(sh) ? sh->getId() : (*it)->getObjectId());
+        __shapeblocks.push_back(__blocks.size());
+        (*it)->apply(r);
+    }
+}
+
+void MultiViewZBufferEngine::render(ZBufferEngine& engine, const PrimitiveBlock& block, const ProjectionCameraPtr& camera) const
+{
+    switch(block.type){
+        case eTriangles: {
+            // As with a single view, the shaders give the transparency of the fragments. 
+            // A material gives its transparency to all the fragments of the block.
+            TriangleShaderPtr shader;
+            if (is_valid_ptr(block.triangles)) shader = engine.getShader();
+            else {
+                MaterialPtr material = dynamic_pointer_cast<Material>(block.appearance);
+                if (is_valid_ptr(material) && is_valid_ptr(engine.getShader()) && engine.isTotallyTransparent(Color4(Color3::BLACK, material->getTransparency()))) break;
+            }
+            for (size_t i = block.begin, trid = 0; i < block.end; i += 3, ++trid) {
+                if (is_valid_ptr(shader)) shader->init(block.appearance, block.triangles, trid, camera, engine.getLight());
+                engine.renderShadedTriangle(__triangles[i], __triangles[i+1], __triangles[i+2], block.ccw, block.id, shader, camera);
+            }
+            break;
+        }
+        case eSegments:
+            for (size_t i = block.begin; i < block.end; i += 2)
+                engine.renderSegment(__vertices[i], __vertices[i+1], __colors[i], __colors[i+1], block.width, block.id, camera);
+            break;
+        case ePoints:
+            for (size_t i = block.begin; i < block.end; ++i)
+                engine.renderPoint(__vertices[i], __colors[i], block.width, block.id, camera);
+            break;
+    }
+}
+
+// Close the block of the last added primitives, or drop it if it is empty.
+static void closeBlock(std::vector<MultiViewZBufferEngine::PrimitiveBlock>& blocks, const std::vector<Vector3>& points)
+{
+    MultiViewZBufferEngine::PrimitiveBlock& block = blocks.back();
+    block.end = points.size();
+    if (block.begin == block.end) { blocks.pop_back(); return; }
+    block.lower = block.upper = points[block.begin];
+    for (size_t i = block.begin + 1; i < block.end; ++i){
+        block.lower = Vector3(pglMin(block.lower.x(), points[i].x()), pglMin(block.lower.y(), points[i].y()), pglMin(block.lower.z(), points[i].z()));
+        block.upper = Vector3(pglMax(block.upper.x(), points[i].x()), pglMax(block.upper.y(), points[i].y()), pglMax(block.upper.z(), points[i].z()));
+    }
+}
+
+static MultiViewZBufferEngine::PrimitiveBlock newBlock(MultiViewZBufferEngine::ePrimitiveType type, uint32_t id, bool ccw, uint32_t width, size_t begin)
+{
+    MultiViewZBufferEngine::PrimitiveBlock block;
+    block.type = type;
+    block.id = id;
+    block.ccw = ccw;
+    block.width = width;
+    block.begin = begin;
+    block.end = begin;
+    return block;
+}
+
+void MultiViewZBufferEngine::addTriangles(const TriangleSetPtr& triangles, const AppearancePtr& appearance, const Matrix4& transform, uint32_t id)
+{
+    __blocks.push_back(newBlock(eTriangles, id, triangles->getCCW(), 1, __triangles.size()));
+    __blocks.back().appearance = appearance;
+    if (triangles->hasColorList() || is_valid_ptr(dynamic_pointer_cast<Texture2D>(appearance))) 
+        __blocks.back().triangles = triangles;
+    size_t nbfaces = triangles->getIndexListSize();
+    __triangles.reserve(__triangles.size() + 3 * nbfaces);
+    for(uint32_t itidx = 0; itidx < nbfaces; ++itidx){
+        for(uint32_t j = 0; j < 3; ++j)
+            __triangles.push_back(transform * triangles->getFacePointAt(itidx,j));
+    }
+    closeBlock(__blocks, __triangles);
+}
+
+void MultiViewZBufferEngine::addSegments(const PolylinePtr& polyline, const Color4& color, const Matrix4& transform, uint32_t id)
+{
+    __blocks.push_back(newBlock(eSegments, id, true, polyline->getWidth(), __vertices.size()));
+    Point3ArrayPtr points = polyline->getPointList();
+    if (is_valid_ptr(points) && points->size() > 1){
+        Color4ArrayPtr colorlist = polyline->getColorList();
+        for(uint32_t i = 0; i < points->size()-1; ++i){
+            for(uint32_t j = i; j < i+2; ++j){
+                __vertices.push_back(transform * const_array(*points).getAt(j));
+                __colors.push_back(is_valid_ptr(colorlist) ? const_array(*colorlist).getAt(j) : color);
+            }
+        }
+    }
+    closeBlock(__blocks, __vertices);
+}
+
+void MultiViewZBufferEngine::addPoints(const PointSetPtr& pointset, const Color4& color, const Matrix4& transform, uint32_t id)
+{
+    __blocks.push_back(newBlock(ePoints, id, true, pointset->getWidth(), __vertices.size()));
+    Point3ArrayPtr points = pointset->getPointList();
+    bool colorPerPoint = pointset->hasColorList();
+    for(uint32_t i = 0; i < points->size(); ++i){
+        __vertices.push_back(transform * const_array(*points).getAt(i));
+        __colors.push_back(colorPerPoint ? const_array(*pointset->getColorList()).getAt(i) : color);
+    }
+    closeBlock(__blocks, __vertices);
+}
+
+void MultiViewZBufferEngine::addView(const ProjectionCameraPtr& camera)
+{
+    View view;
+    view.camera = camera;
+    __views.push_back(view);
+}
+
+void MultiViewZBufferEngine::clearViews()
+{
+    __views.clear();
+}
+
+bool MultiViewZBufferEngine::isInView(const PrimitiveBlock& block, const ProjectionCameraPtr& camera) const
+{
+    ProjectionCamera::eProjectionType type = camera->type();
+    // the depth of a cylindrical projection is not bounded by the corners of the box.
+    if (type == ProjectionCamera::eCylindrical) return true;
+
+    Vector3 corners[8];
+    for (uint32_t i = 0; i < 8; ++i){
+        corners[i] = camera->worldToCamera(Vector3((i & 1) ? block.upper.x() : block.lower.x(),
+                                                   (i & 2) ? block.upper.y() : block.lower.y(),
+                                                   (i & 4) ? block.upper.z() : block.lower.z()));
+    }
+
+    if (type == ProjectionCamera::eHemispheric) {
+        // the depth is the distance to the camera. 
+        Vector3 lower = corners[0], upper = corners[0];
+        real_t dmax = 0;
+        for (uint32_t i = 0; i < 8; ++i){
+            lower = Vector3(pglMin(lower.x(), corners[i].x()), pglMin(lower.y(), corners[i].y()), pglMin(lower.z(), corners[i].z()));
+            upper = Vector3(pglMax(upper.x(), corners[i].x()), pglMax(upper.y(), corners[i].y()), pglMax(upper.z(), corners[i].z()));
+            dmax = pglMax(dmax, norm(corners[i]));
+        }
+        Vector3 nearest(pglMax(lower.x(), pglMin(real_t(0), upper.x())),
+                        pglMax(lower.y(), pglMin(real_t(0), upper.y())),
+                        pglMax(lower.z(), pglMin(real_t(0), upper.z())));
+        return camera->isInZRange(norm(nearest) - GEOM_EPSILON, dmax + GEOM_EPSILON);
+    }
+
+    // frustum cameras look toward -z.
+    real_t dmin = REAL_MAX, dmax = -REAL_MAX;
+    for (uint32_t i = 0; i < 8; ++i){
+        dmin = pglMin(dmin, -corners[i].z());
+        dmax = pglMax(dmax, -corners[i].z());
+    }
+    if (!camera->isInZRange(dmin - GEOM_EPSILON, dmax + GEOM_EPSILON)) return false;
+
+    Index4 rect;
+    if (!getRasterBounds(block, camera, rect)) return true;
+    return rect[0] <= rect[1] && rect[2] <= rect[3];
+}
+
+bool MultiViewZBufferEngine::getRasterBounds(const PrimitiveBlock& block, const ProjectionCameraPtr& camera, Index4& rect) const
+{
+    ProjectionCamera::eProjectionType type = camera->type();
+    if (type != ProjectionCamera::ePerspective && type != ProjectionCamera::eOrthographic) return false;
+
+    Vector3 corners[8];
+    for (uint32_t i = 0; i < 8; ++i){
+        corners[i] = camera->worldToCamera(Vector3((i & 1) ? block.upper.x() : block.lower.x(),
+                                                   (i & 2) ? block.upper.y() : block.lower.y(),
+                                                   (i & 4) ? block.upper.z() : block.lower.z()));
+        // the projection of the box is bounded by the projection of its corners only if it is in front of the camera.
+        if (type == ProjectionCamera::ePerspective && -corners[i].z() <= GEOM_EPSILON) return false;
+    }
+
+    real_t xmin = REAL_MAX, xmax = -REAL_MAX, ymin = REAL_MAX, ymax = -REAL_MAX;
+    for (uint32_t i = 0; i < 8; ++i){
+        Vector3 raster = camera->cameraToRaster(corners[i], __imageWidth, __imageHeight);
+        xmin = pglMin(xmin, raster.x()); xmax = pglMax(xmax, raster.x());
+        ymin = pglMin(ymin, raster.y()); ymax = pglMax(ymax, raster.y());
+    }
+    // margin for the rounding of the vertices and the width of the points and segments.
+    real_t margin = 2 + block.width;
+    xmin = std::floor(xmin - margin); xmax = std::ceil(xmax + margin);
+    ymin = std::floor(ymin - margin); ymax = std::ceil(ymax + margin);
+    if (xmin >= __imageWidth || xmax < 0 || ymin >= __imageHeight || ymax < 0) {
+        // empty rectangle
+        rect = Index4(1, 0, 1, 0);
+    }
+    else {
+        rect = Index4(uint32_t(pglMax<real_t>(0, xmin)), uint32_t(pglMin<real_t>(__imageWidth - 1, xmax)),
+                      uint32_t(pglMax<real_t>(0, ymin)), uint32_t(pglMin<real_t>(__imageHeight - 1, ymax)));
+    }
+    return true;
+}
+
+void MultiViewZBufferEngine::process(bool keepBuffers, bool solidangle)
+{
+    std::atomic<uint32_t> nextview(0);
+    size_t nbthreads = pglMin<size_t>(ThreadManager::get().nb_threads(), pglMax<size_t>(1,__views.size()));
+    for (size_t i = 0 ; i < nbthreads ; ++i) {
+        ThreadManager::get().new_task(boost::bind(&renderViews, &nextview, this, &__views, keepBuffers, solidangle));
+    }
+    ThreadManager::get().join();
+}
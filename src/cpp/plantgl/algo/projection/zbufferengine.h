@@ -56,6 +56,7 @@
 #include <plantgl/tool/rcobject.h>
 #include <plantgl/scenegraph/container/indexarray.h>
 #include "../algo_config.h"
+#include "../base/compiledscene.h"
 #include "shading.h"
 #include "light.h"
 #include "projectionengine.h"
@@ -85,6 +86,9 @@ public:
     void join();
     size_t nb_threads() { return __nb_threads; }
 
+    /// Change the number of worker threads. Wait for the pending tasks before recreating the pool.
+    void set_nb_threads(size_t nbthreads);
+
     // Singleton access
     static ThreadManager& get();
 protected:
@@ -159,6 +163,7 @@ public :
   
   void setLight(const Vector3& lightPosition, const Color3& lightColor = Color3(255,255,255), bool directional = false);
   void setLight(const Vector3& lightPosition, const Color3& lightAmbient = Color3(255,255,255), const Color3& lightDiffuse = Color3(255,255,255), const Color3& lightSpecular = Color3(255,255,255), bool directional = false);
+  const LightPtr& getLight() const { return __light; }
   void setLightEnabled(bool enabled) { __light->setEnabled(enabled); }
   bool isLightEnabled() const { return __light->isEnabled() ; }
   
@@ -170,8 +175,8 @@ public :
   void endProcess();
 
   void renderTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, const Color4& c0, const Color4& c1, const Color4& c2, bool ccw = true, const uint32_t id = 0, ProjectionCameraPtr camera = ProjectionCameraPtr());
-  void renderPoint(const TOOLS(Vector3)& v, const Color4& c0, const uint32_t width = 1, const uint32_t id = 0, ProjectionCameraPtr camera = ProjectionCameraPtr());
-  void renderSegment(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const Color4& c0, const Color4& c1, const uint32_t width = 1, const uint32_t id = 0, ProjectionCameraPtr camera = ProjectionCameraPtr());
+  void renderPoint(const TOOLS(Vector3)& v, const Color4& c0, const uint32_t width = 1, const uint32_t id = 0, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
+  void renderSegment(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const Color4& c0, const Color4& c1, const uint32_t width = 1, const uint32_t id = 0, ProjectionCameraPtr camera = ProjectionCameraPtr(), uint32_t threadid = 0);
 
 
   Vector3 worldToRaster(const Vector3& vertexWorld) const 
@@ -199,9 +204,15 @@ public :
 
   void render(ScenePtr scene);
 
-  ImagePtr getTexture(const ImageTexturePtr imgdef);
+  /// Returns the mipmapped texture of \e imgdef, from the cache shared by all the engines. See MipmapTexture.
+  MipmapTexturePtr getTexture(const ImageTexturePtr imgdef);
+
+  typedef MipmapTexture::Cache TextureCache;
 
-  void renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw = true, const uint32_t id = 0, const TriangleShaderPtr& shader = TriangleShaderPtr(), const ProjectionCameraPtr& camera = ProjectionCameraPtr());
+  /// Returns the cache of textures, to tune its budget or read its statistics. It is shared by all the engines.
+  inline TextureCache& getTextureCache() { return MipmapTexture::getCache(); }
+
+  void renderShadedTriangle(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw = true, const uint32_t id = 0, const TriangleShaderPtr& shader = TriangleShaderPtr(), const ProjectionCameraPtr& camera = ProjectionCameraPtr(), uint32_t threadid = 0);
   void renderShadedTriangleMT(const TOOLS(Vector3)& v0, const TOOLS(Vector3)& v1, const TOOLS(Vector3)& v2, bool ccw = true, const uint32_t id = 0, const TriangleShaderPtr& shader = TriangleShaderPtr(), const ProjectionCameraPtr& camera = ProjectionCameraPtr());
 
   TriangleShaderPtr getShader() const { return __triangleshader; }
@@ -220,8 +231,31 @@ public :
   bool isMultiThreaded() const { return __multithreaded; }
   void setMultiThreaded(bool value) { __multithreaded = value; }
 
+  /*! Sort-middle rendering mode used by process when multithreaded.
+      The primitives are first binned into screen tiles of \e tileSize pixels by the worker threads.
+      Each tile is then rasterized by a single thread, in the order of the scene, with no pixel lock.
+      The result is identical to the single threaded rendering. */
+  void setTileBinning(bool enabled, uint16_t tileSize = 32);
+  bool isTileBinningEnabled() const { return __tilebinning; }
+  uint16_t getTileSize() const { return __tilesize; }
+
+  /*! With span shading, triangles shaded by an id, a color list, a material or a texture are rasterized 
+      by scanline spans with a shader type known at compile time, instead of a virtual call per pixel.
+      Other shaders always use the generic path. The result is identical in both cases for perspective cameras.
+      With an orthographic camera, the spans replace the intersection of a ray per pixel. They sample the pixel 
+      centers instead of their corners and the depth is the distance along the view axis, as for points and segments. */
+  void setSpanShading(bool enabled) { __spanshading = enabled; }
+  bool isSpanShadingEnabled() const { return __spanshading; }
+
   virtual void process(ScenePtr scene);
 
+  /*! Render the triangles of a compiled scene, with no traversal of the scene graph.
+      Colors are computed from the materials at the vertices. Textures are not applied. */
+  void process(const CompiledScenePtr& scene);
+
+  /// Render instances, compiled with each prototype tesselated once. See CompiledScene.
+  void process(const InstancedScenePtr& instances);
+
   std::tuple<PGL(Point3ArrayPtr),PGL(Color3ArrayPtr),PGL(Uint32Array1Ptr)> grabZBufferPoints(real_t jitter = 0, real_t raywidth = 0) const;
   ScenePtr grabSortedZBufferPoints(real_t jitter = 0, real_t raywidth = 0) const;
   
@@ -241,17 +275,55 @@ protected :
 
   typedef std::queue<Fragment> FragmentQueue;
 
+  // A primitive binned into screen tiles. Either a triangle or a single fragment.
+  struct RasterPrimitive {
+      // raster bounding rectangle (x0,x1,y0,y1) clipped to the image
+      Index4 rect;
+      bool singlepixel;
+      bool isfragment;
+      bool ccw;
+      uint32_t id;
+      Vector3 vRaster[3];
+      Vector3 vCam[3];
+      Color4 color;
+      TriangleShaderPtr shader;
+  };
+
+  // Primitives produced by a thread and their indices for each tile.
+  struct TileBins {
+      std::vector<RasterPrimitive> primitives;
+      std::vector<std::vector<uint32_t> > tiles;
+  };
+
   bool _tryRenderRaster(uint32_t x, uint32_t y, real_t z, const Color4& rasterColor, const uint32_t id = Shape::NOID);
   void _tryRenderRaster(const struct Fragment& fragment, FragmentQueue& failqueue);
 
-  void _renderSegment(uchar dim, const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const Color4& c0, const Color4& c1, const uint32_t width, const uint32_t id);
+  void _renderSegment(uchar dim, const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const Color4& c0, const Color4& c1, const uint32_t width, const uint32_t id, uint32_t threadid = 0);
+  void _renderOrBinRaster(uint32_t x, uint32_t y, real_t z, const Color4& rasterColor, const uint32_t id, uint32_t threadid);
   void _bufferPeriodizationStep(int32_t xDiff, int32_t yDiff, real_t zDiff, bool useDefaultColor = true, const Color3& defaultcolor = Color3(0,0,0));
 
   void rasterize(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
                  TOOLS(Vector3) v0Raster, TOOLS(Vector3) v1Raster, TOOLS(Vector3) v2Raster, 
                  TOOLS(Vector3) v0Cam, TOOLS(Vector3) v1Cam, TOOLS(Vector3) v2Cam, 
                  bool ccw, const uint32_t id, 
-                 const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera);
+                 const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera, bool singlepixel);
+  // Whether the triangles seen by camera are rasterized by spans of an affine projection.
+  bool useAffineSpans(const ProjectionCameraPtr& camera) const;
+  // Rasterization by spans if shader has a span counterpart. Return false otherwise.
+  template<bool Affine>
+  bool rasterizeBySpans(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
+                        const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const TOOLS(Vector3)& v2Raster, 
+                        real_t z0, real_t z1, real_t z2, real_t area,
+                        bool ccw, const uint32_t id, 
+                        const TriangleShaderPtr& shader, const ProjectionCameraPtr& camera);
+  // Rasterization of a projected triangle by scanline spans, with a shader type known at compile time.
+  // With an affine projection, the raster depths are not inverted and the weights need no perspective correction.
+  template<class SpanShader, bool Affine>
+  void rasterizeSpans(int32_t x0, int32_t x1, int32_t y0, int32_t y1,
+                      const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const TOOLS(Vector3)& v2Raster, 
+                      real_t z0, real_t z1, real_t z2, real_t area,
+                      bool ccw, const uint32_t id, 
+                      const SpanShader& shader, const ProjectionCameraPtr& camera);
   void rasterizeMT(const Index4& rect,
                    const std::tuple<Vector3,Vector3,Vector3>& vRasters, const std::tuple<Vector3,Vector3,Vector3>& vCams,
                  //const TOOLS(Vector3)& v0Raster, const TOOLS(Vector3)& v1Raster, const TOOLS(Vector3)& v2Raster, 
@@ -262,6 +334,14 @@ protected :
   void processScene(Scene::const_iterator scene_begin, Scene::const_iterator scene_end, ProjectionCameraPtr camera, uint32_t threadid = 0);
   void processSceneMT(Scene::const_iterator scene_begin, Scene::const_iterator scene_end, ProjectionCameraPtr camera, uint32_t threadid = 0);
 
+  void processSceneTiled(ScenePtr scene);
+  void processCompiledScene(const CompiledScenePtr& scene, size_t begin, size_t end, ProjectionCameraPtr camera, uint32_t threadid = 0);
+
+  void beginBinning();
+  void rasterizeBins();
+  void binPrimitive(const RasterPrimitive& primitive, uint32_t threadid);
+  void rasterizeTile(uint32_t tileid);
+
   void lock(uint_t x, uint_t y);
   void unlock(uint_t x, uint_t y);
   bool tryLock(uint_t x, uint_t y);
@@ -276,14 +356,22 @@ protected :
   real_t __alphathreshold;
   uint32_t __defaultid;
 
-  Cache<ImagePtr> __cachetexture;
-
   TriangleShaderPtr __triangleshader;
   TriangleShaderPtr * __triangleshaderset;
 
   bool __multithreaded;
   ImageMutexPtr __imageMutex;
 
+  bool __tilebinning;
+  uint16_t __tilesize;
+  bool __binning;
+  bool __spanshading;
+  // keep the farthest fragment of each pixel instead of the nearest one.
+  bool __farthestdepth;
+  uint32_t __nbtilesx;
+  uint32_t __nbtilesy;
+  std::vector<TileBins> __tilebins;
+
 
   static ImageMutexPtr getImageMutex(uint16_t imageWidth, uint16_t imageHeight);
 
@@ -301,6 +389,135 @@ RealArray2Ptr ALGO_API formFactors(const Point3ArrayPtr& points,
                                    uint16_t discretization = 200,
                                    bool solidangle = true);
 
+/// Sparse form factor matrix in compressed sparse row format : (rowpointers, columnindices, values).
+typedef std::tuple<Uint32Array1Ptr,Uint32Array1Ptr,RealArrayPtr> SparseFormFactors;
+
+/*! Compute the form factors between the triangles as a sparse matrix in CSR format.
+    Rows are computed in parallel. Each worker thread keeps its own hemicube engine and buffers, 
+    reset between rows, and the triangles behind the plane of the emitter are culled before rasterization.
+    The row \e i of the result contains the solid angle (or the number of pixels if \e solidangle is false)
+    of the triangles seen from the center of triangle \e i. */
+SparseFormFactors ALGO_API sparseFormFactors(const Point3ArrayPtr& points, 
+                                             const Index3ArrayPtr& triangles, 
+                                             const Point3ArrayPtr& normals = Point3ArrayPtr(),
+                                             bool ccw = true,
+                                             uint16_t discretization = 200,
+                                             bool solidangle = true);
+
+/* ----------------------------------------------------------------------- */
+
+/**
+    \class MultiViewZBufferEngine
+    \brief Id rendering of a scene from a list of cameras.
+
+    The scene is converted once into triangles, segments and points in world coordinates.
+    For each view, the primitives of a shape are culled with its bounding box and rasterized with the camera of the view.
+    The views are rendered in parallel, each worker thread reusing its own engine and buffers.
+*/
+
+class ALGO_API MultiViewZBufferEngine {
+public:
+  MultiViewZBufferEngine(uint16_t imageWidth = 800,
+                         uint16_t imageHeight = 800,
+                         uint32_t defaultId = Shape::NOID);
+
+  virtual ~MultiViewZBufferEngine();
+
+  /// Convert the scene into primitives in world coordinates. The scene is not used anymore after.
+  void setScene(ScenePtr scene);
+
+  size_t getNbTriangles() const { return __triangles.size() / 3; }
+  size_t getNbShapes() const { return __shapeids.size(); }
+  size_t getNbBlocks() const { return __blocks.size(); }
+
+  /// Id of a shape of the scene and the range of its primitive blocks.
+  uint32_t getShapeId(size_t shape) const { return __shapeids[shape]; }
+  std::pair<size_t,size_t> getShapeBlocks(size_t shape) const 
+  { return std::pair<size_t,size_t>(__shapeblocks[shape], shape+1 < __shapeblocks.size() ? __shapeblocks[shape+1] : __blocks.size()); }
+
+  void addView(const ProjectionCameraPtr& camera);
+  void clearViews();
+  size_t getNbViews() const { return __views.size(); }
+  ProjectionCameraPtr getView(size_t view) const { return __views[view].camera; }
+
+  /*! Render all the views and compute their id histograms.
+      If \e keepBuffers is false, the buffers of a view are released once its histogram is computed. */
+  void process(bool keepBuffers = true, bool solidangle = true);
+
+  RealArray2Ptr getDepthBuffer(size_t view) const { return __views[view].depthBuffer; }
+  Uint32Array2Ptr getIdBuffer(size_t view) const { return __views[view].idBuffer; }
+
+  /// Solid angle (or number of pixels if solidangle was false) of each id seen from a view.
+  const pgl_hash_map<uint32_t,real_t>& idhistogram(size_t view) const { return __views[view].histogram; }
+
+  uint16_t getImageWidth() const { return __imageWidth; }
+  uint16_t getImageHeight() const { return __imageHeight; }
+  uint32_t getDefaultId() const { return __defaultid; }
+
+  enum ePrimitiveType {
+      eTriangles,
+      eSegments,
+      ePoints
+  };
+
+  // Primitives of a shape and their world bounding box.
+  struct PrimitiveBlock {
+      ePrimitiveType type;
+      uint32_t id;
+      bool ccw;
+      uint32_t width;
+      // range of vertices in the triangle or the segment and point vertex lists.
+      size_t begin;
+      size_t end;
+      Vector3 lower;
+      Vector3 upper;
+      // Appearance of the triangles. Those with a color list or a texture are kept to shade the transparency of their fragments.
+      AppearancePtr appearance;
+      TriangleSetPtr triangles;
+  };
+
+  struct View {
+      ProjectionCameraPtr camera;
+      RealArray2Ptr depthBuffer;
+      Uint32Array2Ptr idBuffer;
+      pgl_hash_map<uint32_t,real_t> histogram;
+  };
+
+  void addTriangles(const TriangleSetPtr& triangles, const AppearancePtr& appearance, const Matrix4& transform, uint32_t id);
+  void addSegments(const PolylinePtr& polyline, const Color4& color, const Matrix4& transform, uint32_t id);
+  void addPoints(const PointSetPtr& pointset, const Color4& color, const Matrix4& transform, uint32_t id);
+
+  const std::vector<PrimitiveBlock>& getBlocks() const { return __blocks; }
+  const std::vector<Vector3>& getTriangleVertices() const { return __triangles; }
+  const std::vector<Vector3>& getVertices() const { return __vertices; }
+  const std::vector<Color4>& getVertexColors() const { return __colors; }
+
+  /// Whether the primitives of the block can be seen from the camera.
+  bool isInView(const PrimitiveBlock& block, const ProjectionCameraPtr& camera) const;
+
+  /*! Raster rectangle (x0,x1,y0,y1) that contains the pixels of the block, clipped to the image. It is empty if x0 > x1. 
+      Return false if the projection of the block can not be bounded by the corners of its bounding box. */
+  bool getRasterBounds(const PrimitiveBlock& block, const ProjectionCameraPtr& camera, Index4& rect) const;
+
+  /// Rasterize the primitives of the block with the engine.
+  void render(ZBufferEngine& engine, const PrimitiveBlock& block, const ProjectionCameraPtr& camera) const;
+
+protected:
+  uint16_t __imageWidth;
+  uint16_t __imageHeight;
+  uint32_t __defaultid;
+
+  std::vector<PrimitiveBlock> __blocks;
+  std::vector<Vector3> __triangles;
+  std::vector<Vector3> __vertices;
+  std::vector<Color4> __colors;
+
+  std::vector<uint32_t> __shapeids;
+  std::vector<size_t> __shapeblocks;
+
+  std::vector<View> __views;
+};
+
 /* ----------------------------------------------------------------------- */
 
 PGL_END_NAMESPACE
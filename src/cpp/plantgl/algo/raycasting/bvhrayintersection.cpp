@@ -0,0 +1,475 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+
+#include "bvhrayintersection.h"
+#include <plantgl/scenegraph/geometry/boundingbox.h>
+#include <plantgl/scenegraph/scene/shape.h>
+#include <plantgl/math/util_math.h>
+#include <plantgl/algo/base/parallelexecutor.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+#define BVH_NB_BINS 16
+#define BVH_MAX_DEPTH 60
+#define BVH_RAY_CHUNK 4096
+
+static void checkRayBatch(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions)
+{
+  if (!origins || !directions)
+    throw std::invalid_argument("Origins and directions of the rays should be given.");
+  if (origins->size() != 1 && origins->size() != directions->size())
+    throw std::invalid_argument("Origins should contain either one point or one point per direction.");
+}
+
+/* ----------------------------------------------------------------------- */
+
+
+BVHRayIntersection::BVHRayIntersection(uint32_t maxLeafSize) :
+  RefCountObject(),
+  __maxLeafSize(pglMax<uint32_t>(1,maxLeafSize)),
+  __multithreaded(true)
+{
+}
+
+BVHRayIntersection::BVHRayIntersection(const ScenePtr& scene, uint32_t maxLeafSize) :
+  RefCountObject(),
+  __maxLeafSize(pglMax<uint32_t>(1,maxLeafSize)),
+  __multithreaded(true)
+{
+  build(scene);
+}
+
+BVHRayIntersection::BVHRayIntersection(const CompiledScenePtr& scene, uint32_t maxLeafSize) :
+  RefCountObject(),
+  __maxLeafSize(pglMax<uint32_t>(1,maxLeafSize)),
+  __multithreaded(true)
+{
+  build(scene);
+}
+
+BVHRayIntersection::~BVHRayIntersection()
+{
+}
+
+void
+BVHRayIntersection::clear()
+{
+  __nodes.clear();
+  __vertices.clear();
+  __shapeids.clear();
+  __triangleids.clear();
+}
+
+/* ----------------------------------------------------------------------- */
+
+void
+BVHRayIntersection::build(const ScenePtr& scene)
+{
+  if (is_null_ptr(scene)) { clear(); return; }
+  build(CompiledScenePtr(new CompiledScene(scene)));
+}
+
+void
+BVHRayIntersection::build(const CompiledScenePtr& scene)
+{
+  clear();
+  if (is_null_ptr(scene)) return;
+
+  __vertices = scene->getPositions();
+  __shapeids = scene->getShapeIds();
+  __triangleids = scene->getTriangleIds();
+  buildHierarchy();
+}
+
+struct BVHBin {
+    Vector3 lower;
+    Vector3 upper;
+    uint32_t count;
+
+    BVHBin() : lower(REAL_MAX,REAL_MAX,REAL_MAX), upper(-REAL_MAX,-REAL_MAX,-REAL_MAX), count(0) {}
+
+    void extend(const Vector3& l, const Vector3& u) { lower = Min(lower,l); upper = Max(upper,u); }
+    void extend(const BVHBin& b) { if (b.count > 0) { extend(b.lower, b.upper); count += b.count; } }
+
+    real_t halfArea() const {
+        if (count == 0) return 0;
+        Vector3 d = upper - lower;
+        return d.x()*d.y() + d.y()*d.z() + d.z()*d.x();
+    }
+};
+
+struct BVHBuildTask {
+    uint32_t begin, end, depth;
+    // index of the parent node for a second child, UINT32_MAX otherwise.
+    uint32_t parent;
+    BVHBuildTask(uint32_t b, uint32_t e, uint32_t d, uint32_t p = UINT32_MAX) : begin(b), end(e), depth(d), parent(p) {}
+};
+
+void
+BVHRayIntersection::buildHierarchy()
+{
+  __nodes.clear();
+  uint32_t nbtriangles = __shapeids.size();
+  if (nbtriangles == 0) return;
+
+  std::vector<Vector3> lowers(nbtriangles), uppers(nbtriangles), centers(nbtriangles);
+  for (uint32_t i = 0; i < nbtriangles; ++i){
+    const Vector3& a = __vertices[3*i];
+    const Vector3& b = __vertices[3*i+1];
+    const Vector3& c = __vertices[3*i+2];
+    lowers[i] = Min(a,Min(b,c));
+    uppers[i] = Max(a,Max(b,c));
+    centers[i] = (lowers[i]+uppers[i])/2;
+  }
+
+  std::vector<uint32_t> order(nbtriangles);
+  for (uint32_t i = 0; i < nbtriangles; ++i) order[i] = i;
+
+  __nodes.reserve(2*(nbtriangles/__maxLeafSize)+1);
+
+  std::vector<BVHBuildTask> tasks;
+  tasks.push_back(BVHBuildTask(0, nbtriangles, 0));
+  while (!tasks.empty()) {
+    BVHBuildTask task = tasks.back();
+    tasks.pop_back();
+
+    uint32_t nodeid = __nodes.size();
+    if (task.parent != UINT32_MAX) __nodes[task.parent].offset = nodeid;
+
+    Node node;
+    BVHBin bounds, cbounds;
+    for (uint32_t i = task.begin; i < task.end; ++i){
+        bounds.extend(lowers[order[i]], uppers[order[i]]);
+        cbounds.extend(centers[order[i]], centers[order[i]]);
+    }
+    node.lower = bounds.lower;
+    node.upper = bounds.upper;
+    node.offset = task.begin;
+    node.count = task.end - task.begin;
+
+    Vector3 extent = cbounds.upper - cbounds.lower;
+    int axis = extent.getMaxAbsCoord();
+
+    if (node.count <= __maxLeafSize || task.depth >= BVH_MAX_DEPTH || extent[axis] < GEOM_EPSILON) {
+        __nodes.push_back(node);
+        continue;
+    }
+
+    // Binned surface area heuristic along the largest axis of the centroid bounds
+    real_t scale = BVH_NB_BINS / extent[axis];
+    BVHBin bins[BVH_NB_BINS];
+    for (uint32_t i = task.begin; i < task.end; ++i){
+        uint32_t tid = order[i];
+        int b = pglMin<int>(BVH_NB_BINS-1, int((centers[tid][axis]-cbounds.lower[axis])*scale));
+        bins[b].extend(lowers[tid], uppers[tid]);
+        bins[b].count += 1;
+    }
+
+    real_t rightcosts[BVH_NB_BINS];
+    BVHBin acc;
+    for (int b = BVH_NB_BINS-1; b > 0; --b){
+        acc.extend(bins[b]);
+        rightcosts[b] = acc.halfArea() * acc.count;
+    }
+    acc = BVHBin();
+    int bestsplit = -1;
+    real_t bestcost = bounds.halfArea() * node.count;
+    for (int b = 0; b < BVH_NB_BINS-1; ++b){
+        acc.extend(bins[b]);
+        real_t cost = acc.halfArea() * acc.count + rightcosts[b+1];
+        if (acc.count > 0 && acc.count < node.count && cost < bestcost) {
+            bestcost = cost;
+            bestsplit = b;
+        }
+    }
+
+    uint32_t middle;
+    if (bestsplit >= 0) {
+        real_t lcenters = cbounds.lower[axis];
+        middle = std::partition(order.begin()+task.begin, order.begin()+task.end, 
+                     [&](uint32_t tid) { return pglMin<int>(BVH_NB_BINS-1, int((centers[tid][axis]-lcenters)*scale)) <= bestsplit; }) - order.begin();
+    }
+    else {
+        middle = (task.begin + task.end) / 2;
+        std::nth_element(order.begin()+task.begin, order.begin()+middle, order.begin()+task.end,
+                     [&](uint32_t a, uint32_t b) { return centers[a][axis] < centers[b][axis]; });
+    }
+
+    node.count = 0;
+    __nodes.push_back(node);
+    // first child is processed next and thus is placed just after its parent
+    tasks.push_back(BVHBuildTask(middle, task.end, task.depth+1, nodeid));
+    tasks.push_back(BVHBuildTask(task.begin, middle, task.depth+1));
+  }
+
+  std::vector<Vector3> vertices(__vertices.size());
+  std::vector<uint32_t> shapeids(nbtriangles), triangleids(nbtriangles);
+  for (uint32_t i = 0; i < nbtriangles; ++i){
+      uint32_t tid = order[i];
+      vertices[3*i]   = __vertices[3*tid];
+      vertices[3*i+1] = __vertices[3*tid+1];
+      vertices[3*i+2] = __vertices[3*tid+2];
+      shapeids[i] = __shapeids[tid];
+      triangleids[i] = __triangleids[tid];
+  }
+  __vertices.swap(vertices);
+  __shapeids.swap(shapeids);
+  __triangleids.swap(triangleids);
+}
+
+BoundingBoxPtr
+BVHRayIntersection::getBoundingBox() const
+{
+  if (__nodes.empty()) return BoundingBoxPtr();
+  return BoundingBoxPtr(new BoundingBox(__nodes[0].lower, __nodes[0].upper));
+}
+
+/* ----------------------------------------------------------------------- */
+
+inline bool
+BVHRayIntersection::intersectNode(const Node& node, const Vector3& origin, const Vector3& invdir, real_t tmax, real_t& tnear) const
+{
+  real_t t1 = (node.lower.x() - origin.x()) * invdir.x();
+  real_t t2 = (node.upper.x() - origin.x()) * invdir.x();
+  real_t tmin = pglMin(t1,t2);
+  real_t tfar = pglMax(t1,t2);
+
+  t1 = (node.lower.y() - origin.y()) * invdir.y();
+  t2 = (node.upper.y() - origin.y()) * invdir.y();
+  tmin = pglMax(tmin, pglMin(t1,t2));
+  tfar = pglMin(tfar, pglMax(t1,t2));
+
+  t1 = (node.lower.z() - origin.z()) * invdir.z();
+  t2 = (node.upper.z() - origin.z()) * invdir.z();
+  tmin = pglMax(tmin, pglMin(t1,t2));
+  tfar = pglMin(tfar, pglMax(t1,t2));
+
+  tnear = tmin;
+  return tfar >= pglMax<real_t>(tmin,0) && tmin <= tmax;
+}
+
+inline bool
+BVHRayIntersection::intersectTriangle(uint32_t triangle, const Vector3& origin, const Vector3& direction, real_t& t) const
+{
+  // Moller-Trumbore intersection, two sided.
+  const Vector3& v0 = __vertices[3*triangle];
+  Vector3 e1 = __vertices[3*triangle+1] - v0;
+  Vector3 e2 = __vertices[3*triangle+2] - v0;
+  Vector3 p = cross(direction, e2);
+  real_t det = dot(e1, p);
+  if (fabs(det) < GEOM_TOLERANCE) return false;
+  real_t invdet = 1 / det;
+  Vector3 s = origin - v0;
+  real_t u = dot(s, p) * invdet;
+  if (u < 0 || u > 1) return false;
+  Vector3 q = cross(s, e1);
+  real_t v = dot(direction, q) * invdet;
+  if (v < 0 || u + v > 1) return false;
+  t = dot(e2, q) * invdet;
+  return t > GEOM_EPSILON;
+}
+
+template<bool anyhit>
+bool
+BVHRayIntersection::traverse(const Vector3& origin, const Vector3& direction, real_t maxdist, real_t& distance, uint32_t& triangle) const
+{
+  if (__nodes.empty()) return false;
+
+  Vector3 invdir;
+  for (int i = 0; i < 3; ++i)
+    invdir[i] = 1 / (fabs(direction[i]) > REAL_EPSILON ? direction[i] : (direction[i] < 0 ? -REAL_EPSILON : REAL_EPSILON));
+
+  real_t best = maxdist;
+  bool hit = false;
+  real_t tnear, tleft, tright;
+  if (!intersectNode(__nodes[0], origin, invdir, best, tnear)) return false;
+
+  uint32_t stack[BVH_MAX_DEPTH+4];
+  int stacksize = 0;
+  uint32_t current = 0;
+
+  while (true) {
+    const Node& node = __nodes[current];
+    bool descend = false;
+    if (node.count > 0) {
+      real_t t;
+      for (uint32_t i = node.offset; i < node.offset + node.count; ++i){
+        if (intersectTriangle(i, origin, direction, t) && t < best){
+          best = t;
+          triangle = i;
+          hit = true;
+          if (anyhit) { distance = best; return true; }
+        }
+      }
+    }
+    else {
+      uint32_t left = current + 1;
+      uint32_t right = node.offset;
+      bool hitleft = intersectNode(__nodes[left], origin, invdir, best, tleft);
+      bool hitright = intersectNode(__nodes[right], origin, invdir, best, tright);
+      if (hitleft && hitright) {
+        if (tright < tleft) std::swap(left, right);
+        stack[stacksize++] = right;
+        current = left;
+        descend = true;
+      }
+      else if (hitleft) { current = left; descend = true; }
+      else if (hitright) { current = right; descend = true; }
+    }
+    if (!descend) {
+      // pop the next node still closer than the current best hit
+      while (stacksize > 0 && !descend) {
+        current = stack[--stacksize];
+        descend = intersectNode(__nodes[current], origin, invdir, best, tnear);
+      }
+      if (!descend) break;
+    }
+  }
+  if (hit) distance = best;
+  return hit;
+}
+
+/* ----------------------------------------------------------------------- */
+
+bool
+BVHRayIntersection::intersect(const Ray& ray, real_t& distance, uint32_t& shapeid, uint32_t& triangleid, real_t maxdist) const
+{
+  uint32_t triangle;
+  if (traverse<false>(ray.getOrigin(), ray.getDirection(), maxdist, distance, triangle)){
+    shapeid = __shapeids[triangle];
+    triangleid = __triangleids[triangle];
+    return true;
+  }
+  return false;
+}
+
+bool
+BVHRayIntersection::isOccluded(const Ray& ray, real_t maxdist) const
+{
+  real_t distance;
+  uint32_t triangle;
+  return traverse<true>(ray.getOrigin(), ray.getDirection(), maxdist, distance, triangle);
+}
+
+void
+BVHRayIntersection::intersectRange(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist, size_t begin, size_t end, RayHits& result) const
+{
+  bool uniqueorigin = (origins->size() == 1);
+  Point3ArrayPtr points = std::get<0>(result);
+  RealArrayPtr distances = std::get<1>(result);
+  Uint32Array1Ptr shapeids = std::get<2>(result);
+  for (size_t i = begin; i < end; ++i){
+    const Vector3& origin = const_array(*origins).getAt(uniqueorigin ? 0 : i);
+    Vector3 direction = const_array(*directions).getAt(i);
+    if (direction.normalize() < GEOM_EPSILON) continue;
+    real_t distance;
+    uint32_t triangle;
+    if (traverse<false>(origin, direction, maxdist, distance, triangle)){
+        points->setAt(i, origin + direction * distance);
+        distances->setAt(i, distance);
+        shapeids->setAt(i, __shapeids[triangle]);
+    }
+  }
+}
+
+void
+BVHRayIntersection::occludedRange(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist, size_t begin, size_t end, std::vector<char>& result) const
+{
+  bool uniqueorigin = (origins->size() == 1);
+  for (size_t i = begin; i < end; ++i){
+    Vector3 direction = const_array(*directions).getAt(i);
+    if (direction.normalize() < GEOM_EPSILON) continue;
+    real_t distance;
+    uint32_t triangle;
+    result[i] = traverse<true>(const_array(*origins).getAt(uniqueorigin ? 0 : i), direction, maxdist, distance, triangle);
+  }
+}
+
+BVHRayIntersection::RayHits
+BVHRayIntersection::intersect(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist) const
+{
+  checkRayBatch(origins, directions);
+  size_t nbrays = directions->size();
+  RayHits result(Point3ArrayPtr(new Point3Array(origins->size() == 1 ? nbrays : 0)), 
+                 RealArrayPtr(new RealArray(nbrays, REAL_MAX)), 
+                 Uint32Array1Ptr(new Uint32Array1(nbrays, Shape::NOID)));
+  if (origins->size() == 1) {
+    Point3ArrayPtr points = std::get<0>(result);
+    std::fill(points->begin(), points->end(), const_array(*origins).getAt(0));
+  }
+  else {
+    std::get<0>(result) = Point3ArrayPtr(new Point3Array(*origins));
+  }
+
+  if (__multithreaded && nbrays > BVH_RAY_CHUNK) {
+    ParallelExecutor::get().parallel_for(0, nbrays, [&](size_t begin, size_t end) {
+      intersectRange(origins, directions, maxdist, begin, end, result);
+    }, BVH_RAY_CHUNK);
+  }
+  else intersectRange(origins, directions, maxdist, 0, nbrays, result);
+  return result;
+}
+
+BoolArray1Ptr
+BVHRayIntersection::isOccluded(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist) const
+{
+  checkRayBatch(origins, directions);
+  size_t nbrays = directions->size();
+  std::vector<char> occluded(nbrays, 0);
+
+  if (__multithreaded && nbrays > BVH_RAY_CHUNK) {
+    ParallelExecutor::get().parallel_for(0, nbrays, [&](size_t begin, size_t end) {
+      occludedRange(origins, directions, maxdist, begin, end, occluded);
+    }, BVH_RAY_CHUNK);
+  }
+  else occludedRange(origins, directions, maxdist, 0, nbrays, occluded);
+
+  return BoolArray1Ptr(new BoolArray1(occluded.begin(), occluded.end()));
+}
+
+/* ----------------------------------------------------------------------- */
@@ -0,0 +1,191 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+/*! \file bvhrayintersection.h
+    \brief Ray casting on a whole scene accelerated by a bounding volume hierarchy. see BVHRayIntersection.
+*/
+
+#ifndef __bvhrayintersection_h__
+#define __bvhrayintersection_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "ray.h"
+#include <plantgl/algo/base/compiledscene.h>
+#include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_array.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/scenegraph/container/pointarray.h>
+#include <vector>
+#include <tuple>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+  \class BVHRayIntersection
+  \brief Compute intersections between rays and all the triangles of a scene.
+
+  The triangles of a CompiledScene are stored in a bounding volume hierarchy
+  (binned SAH split) laid out as a flat array of nodes. A scene given directly
+  is compiled first. Queries can then be made for a single ray or
+  for a batch of rays, batches being dispatched on all the cores.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class ALGO_API BVHRayIntersection : public RefCountObject
+{
+
+public :
+
+  typedef std::tuple<Point3ArrayPtr,RealArrayPtr,Uint32Array1Ptr> RayHits;
+
+  /// Constructor.
+  BVHRayIntersection(uint32_t maxLeafSize = 4);
+
+  /// Constructor. Build the hierarchy on the triangles of \e scene.
+  BVHRayIntersection(const ScenePtr& scene, uint32_t maxLeafSize = 4);
+
+  /// Constructor. Build the hierarchy on the triangles of a compiled scene.
+  BVHRayIntersection(const CompiledScenePtr& scene, uint32_t maxLeafSize = 4);
+
+  /// Destructor.
+  virtual ~BVHRayIntersection();
+
+  /// Discretize \e scene and (re)build the hierarchy.
+  void build(const ScenePtr& scene);
+
+  /// (Re)build the hierarchy on the triangles of a compiled scene.
+  void build(const CompiledScenePtr& scene);
+
+  /// Remove all triangles from \e self.
+  void clear();
+
+  /*! Closest intersection between \e ray and the scene.
+    \post
+    - \e distance, \e shapeid and \e triangleid are set if returned value is true.
+      \e triangleid is the index of the triangle in the triangulation of the shape.
+  */
+  bool intersect(const Ray& ray, real_t& distance, uint32_t& shapeid, uint32_t& triangleid, real_t maxdist = REAL_MAX) const;
+
+  /// Test if there is any intersection between \e ray and the scene closer than \e maxdist.
+  bool isOccluded(const Ray& ray, real_t maxdist = REAL_MAX) const;
+
+  /*! Closest intersections of a batch of rays.
+    \e origins can contain either one point shared by all rays or one point per direction.
+    Return the intersection points, their distances and the ids of the intersected shapes.
+    Rays without intersection have a distance of REAL_MAX and the id Shape::NOID.
+    Throw std::invalid_argument if the number of origins matches neither.
+  */
+  RayHits intersect(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist = REAL_MAX) const;
+
+  /// Any-hit test of a batch of rays.
+  BoolArray1Ptr isOccluded(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist = REAL_MAX) const;
+
+  /// Return the number of triangles stored in \e self.
+  inline size_t nbTriangles() const { return __shapeids.size(); }
+
+  /// Return the number of nodes of the hierarchy.
+  inline size_t nbNodes() const { return __nodes.size(); }
+
+  /// Return the bounding box of the stored triangles.
+  BoundingBoxPtr getBoundingBox() const;
+
+  inline uint32_t getMaxLeafSize() const { return __maxLeafSize; }
+
+  inline bool isMultiThreaded() const { return __multithreaded; }
+  inline void setMultiThreaded(bool value) { __multithreaded = value; }
+
+protected:
+
+  struct Node {
+      Vector3 lower;
+      Vector3 upper;
+      /// index of the first triangle for a leaf, of the second child for an inner node (first child is next node).
+      uint32_t offset;
+      /// number of triangles of a leaf. 0 for an inner node.
+      uint32_t count;
+  };
+
+  void buildHierarchy();
+
+  bool intersectNode(const Node& node, const Vector3& origin, const Vector3& invdir, real_t tmax, real_t& tnear) const;
+
+  bool intersectTriangle(uint32_t triangle, const Vector3& origin, const Vector3& direction, real_t& t) const;
+
+  template<bool anyhit>
+  bool traverse(const Vector3& origin, const Vector3& direction, real_t maxdist, real_t& distance, uint32_t& triangle) const;
+
+  void intersectRange(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist, size_t begin, size_t end, RayHits& result) const;
+
+  void occludedRange(const Point3ArrayPtr& origins, const Point3ArrayPtr& directions, real_t maxdist, size_t begin, size_t end, std::vector<char>& result) const;
+
+  std::vector<Node> __nodes;
+
+  /// vertices of the triangles, 3 consecutive points per triangle, ordered as in the leaves.
+  std::vector<Vector3> __vertices;
+
+  /// id of the shape of each triangle.
+  std::vector<uint32_t> __shapeids;
+
+  /// index of each triangle in the triangulation of its shape.
+  std::vector<uint32_t> __triangleids;
+
+  uint32_t __maxLeafSize;
+
+  bool __multithreaded;
+
+};
+
+typedef RCPtr<BVHRayIntersection> BVHRayIntersectionPtr;
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+// __bvhrayintersection_h__
+#endif
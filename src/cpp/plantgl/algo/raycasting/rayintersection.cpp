@@ -172,14 +172,14 @@ RayIntersection::process( AmapSymbol * amapSymbol )
   Vector3 intersect;
   Point3ArrayPtr points(amapSymbol->getPointList());
 
-  for(IndexArray::iterator _it = amapSymbol->getIndexList()->begin();
-      _it != amapSymbol->getIndexList()->end();
+  for(IndexArray::const_iterator _it = const_array(*amapSymbol->getIndexList()).begin();
+      _it != const_array(*amapSymbol->getIndexList()).end();
       _it++){
     if( _it->size() == 4 &&
-        __ray.intersect( points->getAt(_it->getAt(0)),
-                         points->getAt(_it->getAt(1)),
-                         points->getAt(_it->getAt(2)),
-                         points->getAt(_it->getAt(3)),
+        __ray.intersect( const_array(*points).getAt(_it->getAt(0)),
+                         const_array(*points).getAt(_it->getAt(1)),
+                         const_array(*points).getAt(_it->getAt(2)),
+                         const_array(*points).getAt(_it->getAt(3)),
                          intersect) == 1){
       bool contained = false;
       for(Point3Array::const_iterator _i = __result->begin(); _i != __result->end() && !contained ; _i++){
@@ -192,9 +192,9 @@ RayIntersection::process( AmapSymbol * amapSymbol )
       }
     }
     else if( _it->size() == 3 &&
-             __ray.intersect( points->getAt(_it->getAt(0)),
-                              points->getAt(_it->getAt(1)),
-                              points->getAt(_it->getAt(2)),
+             __ray.intersect( const_array(*points).getAt(_it->getAt(0)),
+                              const_array(*points).getAt(_it->getAt(1)),
+                              const_array(*points).getAt(_it->getAt(2)),
                               intersect) == 1){
       bool contained = false;
       for(Point3Array::const_iterator _i = __result->begin(); _i != __result->end() && !contained ; _i++){
@@ -334,14 +334,14 @@ RayIntersection::process( FaceSet * faceSet )
   Vector3 intersect;
   Point3ArrayPtr points(faceSet->getPointList());
 
-  for(IndexArray::iterator _it = faceSet->getIndexList()->begin();
-      _it != faceSet->getIndexList()->end();
+  for(IndexArray::const_iterator _it = const_array(*faceSet->getIndexList()).begin();
+      _it != const_array(*faceSet->getIndexList()).end();
       _it++){
     if( _it->size() == 4 &&
-        __ray.intersect( points->getAt(_it->getAt(0)),
-                         points->getAt(_it->getAt(1)),
-                         points->getAt(_it->getAt(2)),
-                         points->getAt(_it->getAt(3)),
+        __ray.intersect( const_array(*points).getAt(_it->getAt(0)),
+                         const_array(*points).getAt(_it->getAt(1)),
+                         const_array(*points).getAt(_it->getAt(2)),
+                         const_array(*points).getAt(_it->getAt(3)),
                          intersect) == 1){
       bool contained = false;
       for(Point3Array::const_iterator _i = __result->begin(); _i != __result->end() && !contained ; _i++){
@@ -354,9 +354,9 @@ RayIntersection::process( FaceSet * faceSet )
       }
     }
     else if( _it->size() == 3 &&
-             __ray.intersect( points->getAt(_it->getAt(0)),
-                              points->getAt(_it->getAt(1)),
-                              points->getAt(_it->getAt(2)),
+             __ray.intersect( const_array(*points).getAt(_it->getAt(0)),
+                              const_array(*points).getAt(_it->getAt(1)),
+                              const_array(*points).getAt(_it->getAt(2)),
                               intersect) == 1){
       bool contained = false;
       for(Point3Array::const_iterator _i = __result->begin(); _i != __result->end() && !contained ; _i++){
@@ -454,7 +454,7 @@ RayIntersection::process( PointSet * pointSet )
   GEOM_ASSERT( pointSet );
   __result = Point3ArrayPtr(new Point3Array());
   Point3ArrayPtr points(pointSet->getPointList());
-  for(Point3Array::const_iterator _it = points->begin(); _it != points->end(); _it++)
+  for(Point3Array::const_iterator _it = const_array(*points).begin(); _it != const_array(*points).end(); _it++)
     if(__ray.intersect(*_it))
       __result->push_back(*_it);
   return (!__result->empty());
@@ -471,7 +471,7 @@ RayIntersection::process( Polyline * polyline )
   Vector3 intersect;
   __result = Point3ArrayPtr(new Point3Array());
   Point3ArrayPtr points(polyline->getPointList());
-  for(Point3Array::const_iterator _it = points->begin(); _it != (points->end()-1); _it++)
+  for(Point3Array::const_iterator _it = const_array(*points).begin(); _it != (const_array(*points).end()-1); _it++)
     if(__ray.intersect(*_it,*(_it+1),intersect) == 1)
       __result->push_back(intersect);
   return (!__result->empty());
@@ -499,13 +499,13 @@ RayIntersection::process( QuadSet * quadSet )
   Vector3 intersect;
   Point3ArrayPtr points(quadSet->getPointList());
 
-  for(Index4Array::iterator _it = quadSet->getIndexList()->begin();
-      _it != quadSet->getIndexList()->end();
+  for(Index4Array::const_iterator _it = const_array(*quadSet->getIndexList()).begin();
+      _it != const_array(*quadSet->getIndexList()).end();
       _it++){
-    if(__ray.intersect( points->getAt(_it->getAt(0)),
-                        points->getAt(_it->getAt(1)),
-                        points->getAt(_it->getAt(2)),
-                        points->getAt(_it->getAt(3)),
+    if(__ray.intersect( const_array(*points).getAt(_it->getAt(0)),
+                        const_array(*points).getAt(_it->getAt(1)),
+                        const_array(*points).getAt(_it->getAt(2)),
+                        const_array(*points).getAt(_it->getAt(3)),
                         intersect) == 1){
       bool contained = false;
       for(Point3Array::const_iterator _i = __result->begin(); _i != __result->end() && !contained ; _i++){
@@ -592,12 +592,12 @@ RayIntersection::process( TriangleSet * triangleSet )
   Vector3 intersect;
   Point3ArrayPtr points(triangleSet->getPointList());
 
-  for(Index3Array::iterator _it = triangleSet->getIndexList()->begin();
-      _it != triangleSet->getIndexList()->end();
+  for(Index3Array::const_iterator _it = const_array(*triangleSet->getIndexList()).begin();
+      _it != const_array(*triangleSet->getIndexList()).end();
       _it++){
-    if(__ray.intersect( points->getAt(_it->getAt(0)),
-                        points->getAt(_it->getAt(1)),
-                        points->getAt(_it->getAt(2)),
+    if(__ray.intersect( const_array(*points).getAt(_it->getAt(0)),
+                        const_array(*points).getAt(_it->getAt(1)),
+                        const_array(*points).getAt(_it->getAt(2)),
                         intersect) == 1){
       bool contained = false;
       for(Point3Array::const_iterator _i = __result->begin(); _i != __result->end() && !contained ; _i++){
@@ -44,6 +44,7 @@
 
 #include <plantgl/tool/util_types.h>
 #include <plantgl/math/util_math.h>
+#include <plantgl/scenegraph/core/sceneobject.h>
 
 template <class U,class T, const U& (T::* func)() const >
 U get_prop_bt_from_class(const T * obj){  return (obj->*func)(); }
@@ -52,13 +53,13 @@ template <class U,class T, const U (T::* func)() const >
 U get_prop_bt_nr_from_class(const T * obj){  return (obj->*func)(); }
 
 template <class U,class T, U& (T::* func)() >
-void set_prop_bt_from_class(T * obj, U val){  (obj->*func)() = val; }
+void set_prop_bt_from_class(T * obj, U val){  (obj->*func)() = val; PGL(touchIfSceneObject)(obj); }
 
 template <class U,class T, const U& (T::* func)() const >
 const U& get_prop_ct_from_class(const T * obj){  return (obj->*func)(); }
 
 template <class U,class T, U& (T::* func)() >
-void set_prop_ct_from_class(T * obj, const U& val){  (obj->*func)() = val; }
+void set_prop_ct_from_class(T * obj, const U& val){  (obj->*func)() = val; PGL(touchIfSceneObject)(obj); }
 
 template <class U,class T, const U& (T::* func)() const >
 U get_prop_ptr_from_class(const T * obj){  return (obj->*func)(); }
@@ -67,10 +68,10 @@ template <class U,class T, const U (T::* func)() const >
 U get_prop_ptr_nr_from_class(const T * obj){  return (obj->*func)(); }
 
 template <class U,class T, U& (T::* func)() >
-void set_prop_ptr_from_class(T * obj, U val){  (obj->*func)() = val; }
+void set_prop_ptr_from_class(T * obj, U val){  (obj->*func)() = val; PGL(touchIfSceneObject)(obj); }
 
 template <class T, real_t& (T::* func)() >
-void set_prop_ang_from_class(T * obj, real_t val){  (obj->*func)() = (real_t) fmod((double)val,(double)2 * GEOM_PI); }
+void set_prop_ang_from_class(T * obj, real_t val){  (obj->*func)() = (real_t) fmod((double)val,(double)2 * GEOM_PI); PGL(touchIfSceneObject)(obj); }
 
 template <class T, const T * static_property>
 T retrieve_static_ptr_property() { return *static_property; }
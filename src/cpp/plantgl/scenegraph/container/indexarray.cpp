@@ -218,3 +218,68 @@ uint_t * IndexArray::data( ) const {
 }
 
 /* ----------------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------------- */
+
+CSRIndexArray::CSRIndexArray( ) :
+  RefCountObject(),
+  __offsets(1,0),
+  __indices() {
+}
+
+CSRIndexArray::CSRIndexArray( const IndexArray& array ) :
+  RefCountObject(),
+  __offsets(),
+  __indices() {
+  size_t _size = 0;
+  for (IndexArray::const_iterator _i = array.begin(); _i != array.end(); _i++)
+        _size += _i->size();
+  __offsets.reserve(array.size()+1);
+  __indices.reserve(_size);
+  __offsets.push_back(0);
+  for (IndexArray::const_iterator _i = array.begin(); _i != array.end(); _i++)
+    push_back(_i->begin(), _i->end());
+}
+
+CSRIndexArray::CSRIndexArray( const std::vector<uint_t>& offsets, const std::vector<uint_t>& indices ) :
+  RefCountObject(),
+  __offsets(offsets),
+  __indices(indices) {
+  if (__offsets.empty()) __offsets.push_back(0);
+  GEOM_ASSERT(isValid());
+}
+
+CSRIndexArray::~CSRIndexArray( ) {
+}
+
+bool CSRIndexArray::isValid( ) const {
+  if (__offsets.empty() || __offsets.front() != 0 || __offsets.back() != __indices.size()) return false;
+  for (std::vector<uint_t>::const_iterator _i = __offsets.begin()+1; _i != __offsets.end(); _i++)
+    if (*_i < *(_i-1)) return false;
+  return true;
+}
+
+void CSRIndexArray::reserve( uint_t nbelements, uint_t nbindices ) {
+  __offsets.reserve(nbelements+1);
+  __indices.reserve(nbindices);
+}
+
+void CSRIndexArray::append( const CSRIndexArray& array ) {
+  uint_t _shift = uint_t(__indices.size());
+  __indices.insert(__indices.end(), array.__indices.begin(), array.__indices.end());
+  for (std::vector<uint_t>::const_iterator _i = array.__offsets.begin()+1; _i != array.__offsets.end(); _i++)
+    __offsets.push_back(*_i + _shift);
+}
+
+void CSRIndexArray::clear( ) {
+  __offsets.assign(1,0);
+  __indices.clear();
+}
+
+IndexArrayPtr CSRIndexArray::toIndexArray( ) const {
+  IndexArrayPtr result(new IndexArray(size()));
+  IndexArray::iterator _res = result->begin();
+  for (std::vector<uint_t>::const_iterator _i = __offsets.begin(); _i+1 != __offsets.end(); _i++, _res++)
+    *_res = Index(__indices.begin() + *_i, __indices.begin() + *(_i+1));
+  return result;
+}
@@ -236,6 +236,108 @@ public:
 typedef RCPtr<IndexArray> IndexArrayPtr;
 PGL_DECLARE_TYPE(IndexArray)
 
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class CSRIndexArray
+   \brief An array of indices of non fixed size stored in compressed sparse row format.
+
+   All the indices are stored contiguously in a single buffer. The indices of the 
+   \b i-th element are in [offsets[i], offsets[i+1]). Designed for large adjacency graphs.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class SG_API CSRIndexArray : public RefCountObject
+{
+
+public:
+
+  /// A read only view on the indices of an element.
+  class IndexRange {
+  public:
+    typedef const uint_t * const_iterator;
+
+    IndexRange(const_iterator first, const_iterator last) : __first(first), __last(last) {}
+    const_iterator begin() const { return __first; }
+    const_iterator end() const { return __last; }
+    uint_t size() const { return uint_t(__last - __first); }
+    bool empty() const { return __first == __last; }
+    uint_t operator[](uint_t i) const { return __first[i]; }
+    uint_t getAt(uint_t i) const { return __first[i]; }
+
+  protected:
+    const_iterator __first;
+    const_iterator __last;
+  };
+
+  typedef IndexRange element_type;
+
+  /// Constructs an empty CSRIndexArray.
+  CSRIndexArray( );
+
+  /// Constructs a CSRIndexArray from an IndexArray.
+  CSRIndexArray( const IndexArray& array );
+
+  /** Constructs a CSRIndexArray from its offsets and indices buffers.
+      \pre
+      - \e offsets must start with 0, be increasing and ends with the size of \e indices. */
+  CSRIndexArray( const std::vector<uint_t>& offsets, const std::vector<uint_t>& indices );
+
+  /// Destructor.
+  virtual ~CSRIndexArray( ) ;
+
+  /// Returns whether \e self is valid.
+  bool isValid( ) const;
+
+  /// Returns the number of elements.
+  inline uint_t size() const { return uint_t(__offsets.size() - 1); }
+
+  inline bool empty() const { return size() == 0; }
+
+  /// Returns the total number of indices.
+  inline uint_t getNbIndices() const { return uint_t(__indices.size()); }
+
+  /// Returns the indices of the \b i-th element.
+  inline IndexRange getAt(uint_t i) const 
+  { GEOM_ASSERT(i < size()); return IndexRange(__indices.data() + __offsets[i], __indices.data() + __offsets[i+1]); }
+
+  inline uint_t getIndexSizeAt(uint_t i) const { return __offsets[i+1] - __offsets[i]; }
+
+  /// Appends an element with the indices in [\e first, \e last).
+  template <class InIterator>
+  void push_back( InIterator first, InIterator last ) {
+    __indices.insert(__indices.end(), first, last);
+    __offsets.push_back(uint_t(__indices.size()));
+  }
+
+  inline void push_back( const Index& value ) { push_back(value.begin(), value.end()); }
+
+  /// Appends all the elements of \e array.
+  void append( const CSRIndexArray& array );
+
+  /// Reserves memory for \e nbelements elements and \e nbindices indices.
+  void reserve( uint_t nbelements, uint_t nbindices );
+
+  void clear( );
+
+  /// Returns the equivalent IndexArray.
+  IndexArrayPtr toIndexArray( ) const;
+
+  const std::vector<uint_t>& getOffsets() const { return __offsets; }
+  const std::vector<uint_t>& getIndices() const { return __indices; }
+  std::vector<uint_t>& getOffsets() { return __offsets; }
+  std::vector<uint_t>& getIndices() { return __indices; }
+
+protected:
+  std::vector<uint_t> __offsets;
+  std::vector<uint_t> __indices;
+
+};
+
+/// CSRIndexArray Pointer
+typedef RCPtr<CSRIndexArray> CSRIndexArrayPtr;
+
 template<class IndexArrayType>
 void shift_all_indices(RCPtr<IndexArrayType> indices, int shift)
 {
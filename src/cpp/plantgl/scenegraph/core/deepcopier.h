@@ -170,7 +170,7 @@ public:
         if(it != __map.end()) return dynamic_pointer_cast<T>(it->second);
       }
       T * ptr = new T(*att);
-      for(TIterator itGeom = att->begin();itGeom != att->end(); ++itGeom)
+      for(TIterator itGeom = ptr->begin();itGeom != ptr->end(); ++itGeom)
            { copy_attribute(*itGeom); }
       if(!att->unique())set(att.get(),ptr);
       return RCPtr<T>(ptr);
@@ -185,7 +185,7 @@ public:
         if(it != __map.end()) return dynamic_pointer_cast<T>(it->second);
       }
       T * ptr = new T(*att);
-      for(TIterator itGeom = att->begin();itGeom != att->end(); ++itGeom)
+      for(TIterator itGeom = ptr->begin();itGeom != ptr->end(); ++itGeom)
            { copy_object_attribute(*itGeom); }
       if(!att->unique())set(att.get(),ptr);
       return RCPtr<T>(ptr);
@@ -83,6 +83,11 @@ void SceneObject::setDefaultName( ) {
   setName("OBJECT_"+number(getObjectId()));
 }
 
+size_t SceneObject::newModificationStamp( ) {
+  // shared with the arrays, so that the deep stamps of objects and arrays can be compared.
+  return nextModificationStamp();
+}
+
 size_t SceneObject::getObjectId( ) const {
   return (size_t)this;
 }
@@ -52,6 +52,8 @@
 
 #include <plantgl/scenegraph/core/action.h>
 #include <plantgl/tool/rcobject.h>
+#include <plantgl/tool/util_array.h>
+#include <plantgl/tool/util_array2.h>
 #include <plantgl/tool/util_hashmap.h>
 #include "deepcopier.h"
 #include "pgl_messages.h"
@@ -150,14 +152,31 @@ public:
       By default, the object is unnamed. */
   SceneObject( ) :
         RefCountObject(),
-        __name() {
+        __name(),
+        __modificationStamp(newModificationStamp()) {
   }
 
   /** Constructor.
       The object is named \e name. */
   SceneObject(const std::string& name ) :
     RefCountObject(),
-        __name(name) {
+        __name(name),
+        __modificationStamp(newModificationStamp()) {
+  }
+
+  /** Copy constructor.
+      The copy gets its own modification stamp. */
+  SceneObject(const SceneObject& other ) :
+    RefCountObject(),
+        __name(other.__name),
+        __modificationStamp(newModificationStamp()) {
+  }
+
+  /// Assignment operator. It marks \e self as modified.
+  SceneObject& operator=(const SceneObject& other ) {
+    __name = other.__name;
+    touch();
+    return *this;
   }
 
   /// Destructor
@@ -181,6 +200,19 @@ public:
    /// Sets the name of \e self.
   void setName( const std::string& name );
 
+  /** Returns the modification stamp of \e self.
+      Stamps are unique among all the objects and change each time \e self is
+      marked as modified, so that caches can detect stale entries. */
+  inline size_t getModificationStamp( ) const { return __modificationStamp; }
+
+  /// Marks \e self as modified.
+  inline void touch( ) { __modificationStamp = newModificationStamp(); }
+
+  /** Returns the greatest of the modification stamps of \e self, of its arrays
+      and of the objects it contains. As stamps are taken from a global counter,
+      it changes when any of them is modified in place. */
+  virtual size_t getDeepModificationStamp( ) const { return __modificationStamp; }
+
    /// Sets the name of \e self to a default value.
   void setDefaultName();
 
@@ -206,11 +238,51 @@ protected:
   /// Self's name
   std::string __name;
 
+  /// Self's modification stamp
+  size_t __modificationStamp;
+
+  /// Returns a new modification stamp.
+  static size_t newModificationStamp( );
+
 }; // class SceneObject
 
+/// Update the modification stamp of \e obj. Does nothing for objects that are not SceneObjects.
+inline void touchIfSceneObject(SceneObject * obj) { obj->touch(); }
+inline void touchIfSceneObject(const void *) { }
+
 /// SceneObject Pointer
 typedef RCPtr<SceneObject> SceneObjectPtr;
 
+/// Returns the deep modification stamp of \e obj, or 0 if it is null.
+inline size_t deepModificationStamp(const SceneObject * obj) { return obj ? obj->getDeepModificationStamp() : 0; }
+
+/// Returns the modification stamp of \e array, or 0 if it is null.
+template<class T>
+inline size_t deepModificationStamp(const Array1<T> * array) { return array ? array->getModificationStamp() : 0; }
+
+/// Returns the modification stamp of \e array, or 0 if it is null.
+template<class T>
+inline size_t deepModificationStamp(const Array2<T> * array) { return array ? array->getModificationStamp() : 0; }
+
+/// Returns the greatest of the modification stamps of \e array and of the objects it contains.
+template<class T>
+inline size_t deepModificationStamp(const Array1<RCPtr<T> > * array) {
+  if (!array) return 0;
+  size_t stamp = array->getModificationStamp();
+  for (typename Array1<RCPtr<T> >::const_iterator it = array->begin(); it != array->end(); ++it)
+    stamp = pglMax<size_t>(stamp, deepModificationStamp(it->get()));
+  return stamp;
+}
+
+template<class T>
+inline size_t deepModificationStamp(const RCPtr<T>& obj) { return deepModificationStamp(obj.get()); }
+
+/// Returns the greatest of the deep modification stamps of \e obj and of \e others.
+template<class T, class... Others>
+inline size_t deepModificationStamp(const RCPtr<T>& obj, const Others&... others) {
+  return pglMax<size_t>(deepModificationStamp(obj), deepModificationStamp(others...));
+}
+
 #define gerr *SceneObject::errorStream
 #define gwarning *SceneObject::warningStream
 #define gcomment *SceneObject::commentStream
@@ -226,7 +298,7 @@ typedef RCPtr<SceneObject> SceneObjectPtr;
 #define PGL_OBJECT_PROPERTY(PROPNAME,PROPTYPE) \
     inline const PROPTYPE& get##PROPNAME() const { return __##PROPNAME; } \
     inline PROPTYPE& get##PROPNAME() { return __##PROPNAME; } \
-    inline void set##PROPNAME(const PROPTYPE& value) { __##PROPNAME = value; } \
+    inline void set##PROPNAME(const PROPTYPE& value) { __##PROPNAME = value; touchIfSceneObject(this); } \
     protected: \
     PROPTYPE __##PROPNAME; \
     public:
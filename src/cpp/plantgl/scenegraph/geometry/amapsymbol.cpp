@@ -121,6 +121,10 @@ AmapSymbol::AmapSymbol( const string& fileName,
 AmapSymbol::~AmapSymbol( ) {
 }
 
+size_t AmapSymbol::getDeepModificationStamp( ) const {
+  return pglMax(FaceSet::getDeepModificationStamp(), deepModificationStamp(__texCoord3List));
+}
+
 const string&
 AmapSymbol::getFileName( ) const {
   return __fileName;
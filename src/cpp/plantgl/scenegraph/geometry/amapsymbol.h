@@ -112,6 +112,9 @@ public:
   /// Destructor
   virtual ~AmapSymbol( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(AmapSymbol)
 
   /// Returns \b FileName value.
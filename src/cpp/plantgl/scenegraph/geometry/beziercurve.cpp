@@ -45,6 +45,7 @@
 #include <plantgl/scenegraph/core/pgl_messages.h>
 #include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/math/util_polymath.h>
+#include <plantgl/tool/util_array.h>
 #include <plantgl/tool/util_string.h>
 #include <plantgl/math/util_math.h>
 
@@ -53,6 +54,21 @@ using namespace std;
 
 /* ----------------------------------------------------------------------- */
 
+// Curves up to this degree are evaluated in a buffer on the stack.
+#define BEZIER_STACK_DEGREE 15
+
+// deCasteljau algorithm on the degree+1 points of Q. The result is in Q[0].
+template<class VectorType>
+static inline void deCasteljau(VectorType * Q, uint_t degree, real_t u)
+{
+  real_t u1 = real_t(1.0) - u;
+  for (uint_t k = 1; k <= degree ; k++)
+    for (uint_t i = 0; i <= ( degree - k ) ; i++)
+      Q[i] = (Q[i] * u1) + (Q[i+1] * u);
+}
+
+/* ----------------------------------------------------------------------- */
+
 
 const uint_t BezierCurve::DEFAULT_STRIDE(30);
 
@@ -170,6 +186,10 @@ BezierCurve::BezierCurve( const Point3ArrayPtr& ctrlPoints, uint_t stride, uchar
 BezierCurve::~BezierCurve( ) {
 }
 
+size_t BezierCurve::getDeepModificationStamp( ) const {
+  return pglMax(ParametricModel::getDeepModificationStamp(), deepModificationStamp(__ctrlPointList));
+}
+
 /* ----------------------------------------------------------------------- */
 
 Point4ArrayPtr
@@ -225,16 +245,13 @@ Vector3 BezierCurve::getPointAt(real_t u) const{
 
   uint_t _deg = getDegree();
 
-  vector<Vector4> Q(__ctrlPointList->begin(),__ctrlPointList->end());
+  Vector4 _local[BEZIER_STACK_DEGREE+1];
+  vector<Vector4> _buffer;
+  Vector4 * Q = _local;
+  if (_deg > BEZIER_STACK_DEGREE) { _buffer.resize(_deg+1); Q = &_buffer[0]; }
 
-  for (vector<Vector4>::iterator it = Q.begin(); it != Q.end(); ++it){
-      it->x() *= it->w(); it->y() *= it->w(); it->z() *= it->w();
-  }
-
-  real_t u1 = real_t(1.0) - u;
-  for (uint_t k = 1; k <= _deg ; k++)
-    for (uint_t i = 0; i <= ( _deg - k ) ; i++)
-      Q[i] = (Q[i] * u1) + (Q[i+1] * u);
+  for (uint_t i = 0; i <= _deg; ++i) Q[i] = __ctrlPointList->getAt(i).wtoxyz();
+  deCasteljau(Q, _deg, u);
 
   if (fabs(Q[0].w()) < GEOM_TOLERANCE)
     return Vector3(Q[0].x(),Q[0].y(),Q[0].z());
@@ -242,6 +259,24 @@ Vector3 BezierCurve::getPointAt(real_t u) const{
   return Q[0].project();
 }
 
+Point3ArrayPtr BezierCurve::getPointsAt(const RealArrayPtr& u) const{
+  uint_t _deg = getDegree();
+
+  vector<Vector4> _ctrlPoints(_deg+1), _buffer(_deg+1);
+  for (uint_t i = 0; i <= _deg; ++i) _ctrlPoints[i] = __ctrlPointList->getAt(i).wtoxyz();
+
+  Point3ArrayPtr result(new Point3Array(u->size()));
+  Point3Array::iterator itres = result->begin();
+  for (RealArray::const_iterator itu = u->begin(); itu != u->end(); ++itu, ++itres) {
+      GEOM_ASSERT( *itu >= 0.0 && *itu <= 1.0 );
+      std::copy(_ctrlPoints.begin(), _ctrlPoints.end(), _buffer.begin());
+      deCasteljau(&_buffer[0], _deg, *itu);
+      if (fabs(_buffer[0].w()) < GEOM_TOLERANCE) *itres = Vector3(_buffer[0].x(),_buffer[0].y(),_buffer[0].z());
+      else *itres = _buffer[0].project();
+  }
+  return result;
+}
+
 
 bool BezierCurve::isValid( ) const {
   Builder _builder;
@@ -414,6 +449,10 @@ BezierCurve2D::BezierCurve2D( const Point2ArrayPtr& ctrlPoints, uint_t stride, u
 BezierCurve2D::~BezierCurve2D( ) {
 }
 
+size_t BezierCurve2D::getDeepModificationStamp( ) const {
+  return pglMax(Curve2D::getDeepModificationStamp(), deepModificationStamp(__ctrlPointList));
+}
+
 /* ----------------------------------------------------------------------- */
 
 Point3ArrayPtr
@@ -476,12 +515,13 @@ Vector2 BezierCurve2D::getPointAt(real_t u) const{
 
   uint_t _deg = getDegree();
 
-  vector<Vector3> Q(__ctrlPointList->begin(),__ctrlPointList->end());
+  Vector3 _local[BEZIER_STACK_DEGREE+1];
+  vector<Vector3> _buffer;
+  Vector3 * Q = _local;
+  if (_deg > BEZIER_STACK_DEGREE) { _buffer.resize(_deg+1); Q = &_buffer[0]; }
 
-  real_t u1 = real_t(1.0) - u;
-  for (uint_t k = 1; k <= _deg ; k++)
-    for (uint_t i = 0; i <= ( _deg - k ) ; i++)
-      Q[i] = (Q[i] * u1) + (Q[i+1] * u);
+  std::copy(__ctrlPointList->begin(), __ctrlPointList->end(), Q);
+  deCasteljau(Q, _deg, u);
 
   if (fabs(Q[0].z()) < GEOM_TOLERANCE)
     return Vector2(Q[0].x(),Q[0].y());
@@ -489,6 +529,23 @@ Vector2 BezierCurve2D::getPointAt(real_t u) const{
   return Q[0].project();
 }
 
+Point2ArrayPtr BezierCurve2D::getPointsAt(const RealArrayPtr& u) const{
+  uint_t _deg = getDegree();
+
+  vector<Vector3> _buffer(_deg+1);
+
+  Point2ArrayPtr result(new Point2Array(u->size()));
+  Point2Array::iterator itres = result->begin();
+  for (RealArray::const_iterator itu = u->begin(); itu != u->end(); ++itu, ++itres) {
+      GEOM_ASSERT( *itu >= 0.0 && *itu <= 1.0 );
+      std::copy(__ctrlPointList->begin(), __ctrlPointList->end(), _buffer.begin());
+      deCasteljau(&_buffer[0], _deg, *itu);
+      if (fabs(_buffer[0].z()) < GEOM_TOLERANCE) *itres = Vector2(_buffer[0].x(),_buffer[0].y());
+      else *itres = _buffer[0].project();
+  }
+  return result;
+}
+
 
 bool BezierCurve2D::isValid( ) const {
   Builder _builder;
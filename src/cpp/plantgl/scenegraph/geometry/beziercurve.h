@@ -65,6 +65,8 @@ class Point3Array;
 typedef RCPtr<Point3Array> Point3ArrayPtr;
 class Point2Array;
 typedef RCPtr<Point2Array> Point2ArrayPtr;
+class RealArray;
+typedef RCPtr<RealArray> RealArrayPtr;
 
 /* ----------------------------------------------------------------------- */
 
@@ -129,6 +131,9 @@ public:
   /// Destructor
   virtual ~BezierCurve( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(BezierCurve)
 
   /// Returns \e Control Points value.
@@ -161,6 +166,12 @@ public:
       - \e u must be in [0,1];*/
   virtual Vector3 getPointAt(real_t u) const;
 
+  /** Returns the \e Points for all the parameters of \e u.
+      No memory is allocated for each point.
+     \pre
+      - values of \e u must be in [0,1];*/
+  virtual Point3ArrayPtr getPointsAt(const RealArrayPtr& u) const;
+
   /** Returns the \e Point for u = \e u.
       using classical algorithm (see the Nurbs book p.22)
      \pre
@@ -251,6 +262,9 @@ public:
   /// Destructor
   virtual ~BezierCurve2D( ) ;
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(BezierCurve2D)
 
   /// Returns \e Control Points value.
@@ -283,6 +297,12 @@ public:
       - \e u must be in [0,1];*/
   virtual Vector2 getPointAt(real_t u) const;
 
+  /*! Returns the \e Points for all the parameters of \e u.
+      No memory is allocated for each point.
+     \pre
+      - values of \e u must be in [0,1];*/
+  virtual Point2ArrayPtr getPointsAt(const RealArrayPtr& u) const;
+
   /* Returns the \e Point for u = \e u.
       using classical algorithm (see the Nurbs book p.22)
      \pre
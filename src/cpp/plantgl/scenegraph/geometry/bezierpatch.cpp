@@ -44,6 +44,7 @@
 #include <plantgl/scenegraph/core/pgl_messages.h>
 #include <plantgl/tool/util_string.h>
 #include <plantgl/math/util_math.h>
+#include <plantgl/tool/util_array.h>
 #include <plantgl/scenegraph/container/pointmatrix.h>
 #include <plantgl/scenegraph/container/pointarray.h>
 
@@ -199,6 +200,10 @@ BezierPatch::BezierPatch() :
 BezierPatch::~BezierPatch( ) {
 }
 
+size_t BezierPatch::getDeepModificationStamp( ) const {
+  return pglMax(Patch::getDeepModificationStamp(), deepModificationStamp(__ctrlPointMatrix));
+}
+
 
 /* ----------------------------------------------------------------------- */
 
@@ -316,6 +321,61 @@ Vector3 BezierPatch::getPointAt(real_t u, real_t v) const{
 }
 
 
+Point3ArrayPtr BezierPatch::getPointsAt(const RealArrayPtr& u, const RealArrayPtr& v) const{
+    uint_t _udeg = getUDegree();
+    uint_t _vdeg = getVDegree();
+    uint_t _nu = u->size();
+    uint_t _nv = v->size();
+
+    Point3ArrayPtr result(new Point3Array(_nu * _nv));
+    if (_nu == 0 || _nv == 0) return result;
+
+    // The direction of lowest degree is reduced first, as in getPointAt.
+    // Its intermediate points depend only on the parameter of the other
+    // direction and are thus computed once per value of this parameter.
+    bool _ufirst = ( _udeg <= _vdeg );
+    uint_t _firstdeg = (_ufirst ? _udeg : _vdeg);
+    uint_t _seconddeg = (_ufirst ? _vdeg : _udeg);
+    const RealArrayPtr& _firstparam = (_ufirst ? u : v);
+    uint_t _nfirst = _firstparam->size();
+
+    vector<Vector4> Q(_nfirst * (_seconddeg+1));
+    vector<Vector4> T(_firstdeg+1);
+    for (uint_t p = 0 ; p < _nfirst ; ++p){
+        real_t t = _firstparam->getAt(p);
+        GEOM_ASSERT( t >= 0.0 && t <= 1.0);
+        real_t t1 = real_t(1.0) - t;
+        for (uint_t j = 0 ; j <= _seconddeg ; ++j){
+            if (_ufirst) T = __ctrlPointMatrix->getRow(j);
+            else T = __ctrlPointMatrix->getColumn(j);
+            for (uint_t k = 1 ; k <= _firstdeg ; ++k)
+                for (uint_t i = 0 ; i <= ( _firstdeg - k ) ; ++i)
+                    T[i] = (T[i] * t1) + (T[i+1] * t);
+            Q[p*(_seconddeg+1)+j] = T[0];
+        }
+    }
+
+    vector<Vector4> R(_seconddeg+1);
+    for (uint_t iu = 0 ; iu < _nu ; ++iu){
+        for (uint_t iv = 0 ; iv < _nv ; ++iv){
+            real_t t = (_ufirst ? v->getAt(iv) : u->getAt(iu));
+            GEOM_ASSERT( t >= 0.0 && t <= 1.0);
+            real_t t1 = real_t(1.0) - t;
+            vector<Vector4>::const_iterator _qbeg = Q.begin() + (_ufirst ? iu : iv) * (_seconddeg+1);
+            std::copy(_qbeg, _qbeg + (_seconddeg+1), R.begin());
+            for (uint_t k = 1 ; k <= _seconddeg ; ++k)
+                for (uint_t j = 0 ; j <= ( _seconddeg - k ) ; ++j)
+                    R[j] = (R[j] * t1) + (R[j+1] * t);
+
+            if (fabs(R[0].w()) < GEOM_TOLERANCE)
+                result->setAt(iu * _nv + iv, Vector3(R[0].x(),R[0].y(),R[0].z()));
+            else result->setAt(iu * _nv + iv, R[0].project());
+        }
+    }
+    return result;
+}
+
+
 LineicModelPtr BezierPatch::getIsoUSectionAt(real_t u) const
 {
     GEOM_ASSERT( u >= 0.0 && u <= 1.0);
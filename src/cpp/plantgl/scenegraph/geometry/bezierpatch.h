@@ -64,6 +64,10 @@ class Point3Matrix;
 typedef RCPtr<Point3Matrix> Point3MatrixPtr;
 class LineicModel;
 typedef RCPtr<LineicModel> LineicModelPtr;
+class Point3Array;
+typedef RCPtr<Point3Array> Point3ArrayPtr;
+class RealArray;
+typedef RCPtr<RealArray> RealArrayPtr;
 
 /* ----------------------------------------------------------------------- */
 
@@ -134,6 +138,9 @@ public:
   /// Destructor
   virtual ~BezierPatch( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(BezierPatch)
 
   /// Returns \e Control Points value.
@@ -176,6 +183,14 @@ public:
       - \e v must be in [0,1];*/
   virtual Vector3 getPointAt(real_t u,real_t v) const;
 
+  /*! Returns the \e Points of the grid of parameters \e u x \e v.
+      The point of u[i] and v[j] is at index i * v->size() + j.
+      Intermediate points are computed once per value of u (or v).
+     \pre
+      - values of \e u must be in [0,1];
+      - values of \e v must be in [0,1];*/
+  virtual Point3ArrayPtr getPointsAt(const RealArrayPtr& u, const RealArrayPtr& v) const;
+
   /* Returns the \e Point for u = \e u.
       using classical algorithm (see the Nurbs book p.22)
      \pre
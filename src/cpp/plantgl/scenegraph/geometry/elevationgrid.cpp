@@ -148,6 +148,10 @@ ElevationGrid::ElevationGrid( const RealArray2Ptr& heights,
 ElevationGrid::~ElevationGrid( ) {
 }
 
+size_t ElevationGrid::getDeepModificationStamp( ) const {
+  return pglMax(Patch::getDeepModificationStamp(), deepModificationStamp(__heightList));
+}
+
 /* ----------------------------------------------------------------------- */
 
 const real_t&
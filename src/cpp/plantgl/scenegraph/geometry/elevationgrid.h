@@ -122,6 +122,9 @@ public:
   /// Destructor
   virtual ~ElevationGrid( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(ElevationGrid)
 
   /** Returns the value of \b HeightList at the i-th row and the j-th column.
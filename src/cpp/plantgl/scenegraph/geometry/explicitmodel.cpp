@@ -122,6 +122,10 @@ ExplicitModel::ExplicitModel(const Point3ArrayPtr& points, const Color4ArrayPtr&
 ExplicitModel::~ExplicitModel( ) {
 }
 
+size_t ExplicitModel::getDeepModificationStamp( ) const {
+  return pglMax(Primitive::getDeepModificationStamp(), deepModificationStamp(__pointList, __colorList));
+}
+
 bool
 ExplicitModel::isExplicit( ) const {
   return true;
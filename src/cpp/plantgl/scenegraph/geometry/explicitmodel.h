@@ -119,6 +119,9 @@ public:
   /// Destructor
   virtual ~ExplicitModel( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   virtual bool isExplicit( ) const;
 
   /// Returns the array of  points \e self contains.
@@ -140,6 +140,10 @@ ExtrudedHull::ExtrudedHull( const Curve2DPtr& vertical,
 ExtrudedHull::~ExtrudedHull( ) {
 }
 
+size_t ExtrudedHull::getDeepModificationStamp( ) const {
+  return pglMax(Hull::getDeepModificationStamp(), deepModificationStamp(__vertical, __horizontal));
+}
+
 bool ExtrudedHull::isValid( ) const {
   Builder _builder;
   _builder.Horizontal = const_cast<Curve2DPtr *>(&__horizontal);
@@ -121,6 +121,9 @@ public:
   /// Destructor
   virtual ~ExtrudedHull( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(ExtrudedHull)
 
   /// Returns \b CCW value.
@@ -297,6 +297,12 @@ Extrusion::Extrusion(const LineicModelPtr& _axis,
 Extrusion::~Extrusion(){
 }
 
+size_t Extrusion::getDeepModificationStamp( ) const {
+  size_t stamp = pglMax(ParametricModel::getDeepModificationStamp(), deepModificationStamp(__axis, __crossSection));
+  if (__profile) stamp = pglMax(stamp, deepModificationStamp(__profile->getScale(), __profile->getOrientation(), __profile->getKnotList()));
+  return stamp;
+}
+
 /* ----------------------------------------------------------------------- */
 
 const Curve2DPtr&
@@ -204,6 +204,9 @@ class SG_API Extrusion : public ParametricModel
   /// Destructor
   virtual ~Extrusion();
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(Extrusion)
 
     /// Return the cross section value of \e self.
@@ -144,6 +144,10 @@ Group::Group( const iterator begin, const iterator end,
 Group::~Group( ) {
 }
 
+size_t Group::getDeepModificationStamp( ) const {
+  return pglMax(Geometry::getDeepModificationStamp(), deepModificationStamp(__geometryList, __skeleton));
+}
+
 /* ----------------------------------------------------------------------- */
 
 const GeometryPtr&
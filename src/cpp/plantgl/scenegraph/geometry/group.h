@@ -125,6 +125,9 @@ public:
   /// Destructor
   virtual ~Group( ) ;
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(Group)
 
   /** Returns the value of the \e i-th geom of  \b GeometryList.
@@ -205,6 +205,10 @@ Mesh::Mesh( const Point3ArrayPtr& points,
 Mesh::~Mesh( ) {
 }
 
+size_t Mesh::getDeepModificationStamp( ) const {
+  return pglMax(ExplicitModel::getDeepModificationStamp(), deepModificationStamp(__normalList, __texCoordList, __skeleton));
+}
+
 const bool
 Mesh::getCCW( ) const {
   return __ccw;
@@ -157,6 +157,9 @@ public:
   /// Destructor
   virtual ~Mesh( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   /// Returns \b CCW value.
   const bool getCCW( ) const;
 
@@ -242,7 +245,7 @@ public:
   inline const Vector3& getPointAt( uint_t i ) const {
     GEOM_ASSERT(__pointList.isValid());
     GEOM_ASSERT(i < __pointList->size());
-    return __pointList->getAt(i);
+    return const_array(*__pointList).getAt(i);
   }
 
   /// Returns the nb of points of the \b i-th face.
@@ -282,7 +285,7 @@ public:
     GEOM_ASSERT(__pointList.isValid());
     GEOM_ASSERT(i < getIndexListSize());
     GEOM_ASSERT(j < getFaceSize(i));
-    return __pointList->getAt(getFacePointIndexAt(i,j));
+    return const_array(*__pointList).getAt(getFacePointIndexAt(i,j));
   }
 
   /// Returns the center of the \b i-th face.
@@ -295,7 +298,7 @@ public:
   inline const Vector3& getNormalAt( uint_t i )  const  {
     GEOM_ASSERT(is_valid_ptr(__normalList));
     GEOM_ASSERT(i < __normalList->size());
-    return __normalList->getAt(i);
+    return const_array(*__normalList).getAt(i);
   }
 
   /** Returns the normal at the \e j-th point of the \e i-th face.
@@ -306,7 +309,7 @@ public:
     GEOM_ASSERT(is_valid_ptr(__normalList));
     GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
-    return __normalList->getAt(getFaceNormalIndexAt(i,j));
+    return const_array(*__normalList).getAt(getFaceNormalIndexAt(i,j));
   }
 
   /** Returns the \e j-th texture coordinates of the \e i-th face.
@@ -316,7 +319,7 @@ public:
   const Vector2& getTexCoordAt( uint_t i ) const  {
     GEOM_ASSERT(is_valid_ptr(__texCoordList));
     GEOM_ASSERT(i < __texCoordList->size());
-    return __texCoordList->getAt(i);
+    return const_array(*__texCoordList).getAt(i);
   }
 
   /** Returns the \e j-th texture coordinates of the \e i-th face.
@@ -328,7 +331,7 @@ public:
     GEOM_ASSERT(is_valid_ptr(__texCoordList));
     GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
-    return __texCoordList->getAt(getFaceTexCoordIndexAt(i,j));
+    return const_array(*__texCoordList).getAt(getFaceTexCoordIndexAt(i,j));
     }
 
   /** Returns the \e j-th colors of the \e i-th face.
@@ -337,7 +340,7 @@ public:
   const Color4& getColorAt( uint_t i ) const {
     GEOM_ASSERT(is_valid_ptr(__colorList));
     GEOM_ASSERT(i < __indexList->size());
-    return __colorList->getAt(i);
+    return const_array(*__colorList).getAt(i);
   }
 
   /** Returns the \e j-th colors of the \e i-th face.
@@ -348,7 +351,7 @@ public:
     GEOM_ASSERT(is_valid_ptr(__colorList));
     GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
-    return __colorList->getAt(getFaceColorIndexAt(i,j));
+    return const_array(*__colorList).getAt(getFaceColorIndexAt(i,j));
   }
 
 #ifndef PGL_NO_DEPRECATED
@@ -539,6 +542,11 @@ public:
   /// Destructor
   virtual ~IndexedMesh<IndexArrayType>( ) { }
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const {
+    return pglMax(Mesh::getDeepModificationStamp(), deepModificationStamp(__indexList, __normalIndexList, __colorIndexList, __texCoordIndexList));
+  }
+
   // Check Validity
   template<class InstanciedMesh>
   bool isAValidMesh( ) const;
@@ -560,7 +568,7 @@ public:
   virtual uint_t getFacePointIndexAt( uint_t i, uint_t j ) const
   { GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
-    return __indexList->getAt(i).getAt(j); }
+    return const_array(*__indexList).getAt(i).getAt(j); }
 
   /** Returns the index of the \e j-th point of the i-th face.
       \warning
@@ -571,8 +579,8 @@ public:
     GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
     if (!__normalPerVertex) return i;
-    if ( __normalIndexList) return __normalIndexList->getAt(i).getAt(j);
-    else  return __indexList->getAt(i).getAt(j);
+    if ( __normalIndexList) return const_array(*__normalIndexList).getAt(i).getAt(j);
+    else  return const_array(*__indexList).getAt(i).getAt(j);
    }
 
   /** Returns the index of the \e j-th point of the i-th face.
@@ -583,8 +591,8 @@ public:
   {
     GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
-    if( __texCoordIndexList) return __texCoordIndexList->getAt(i).getAt(j);
-    else  return __indexList->getAt(i).getAt(j);
+    if( __texCoordIndexList) return const_array(*__texCoordIndexList).getAt(i).getAt(j);
+    else  return const_array(*__indexList).getAt(i).getAt(j);
    }
 
   /** Returns the index of the \e j-th point of the i-th face.
@@ -596,8 +604,8 @@ public:
     GEOM_ASSERT(i < __indexList->size());
     GEOM_ASSERT(j < getFaceSize(i));
     if (!__colorPerVertex) return i;
-    if ( __colorIndexList) return __colorIndexList->getAt(i).getAt(j);
-    else  return __indexList->getAt(i).getAt(j);
+    if ( __colorIndexList) return const_array(*__colorIndexList).getAt(i).getAt(j);
+    else  return const_array(*__indexList).getAt(i).getAt(j);
    }
 
   /// Returns \b IndexList values.
@@ -612,7 +620,7 @@ public:
       \pre
       - \e i must belong to the range [0,size of \b IndexList). */
   inline const IndexType& getIndexListAt( uint_t i ) const
-  { GEOM_ASSERT(i < __indexList->size()); return __indexList->getAt(i); }
+  { GEOM_ASSERT(i < __indexList->size()); return const_array(*__indexList).getAt(i); }
 
   /** Returns the \e i-th value of \b IndexList.
       \pre
@@ -633,7 +641,7 @@ public:
       - \e i must belong to the range [0,size of \b IndexList). */
   inline const IndexType& getNormalIndexListAt( uint_t i ) const
   { GEOM_ASSERT(is_valid_ptr(__normalIndexList) && i < __normalIndexList->size());
-    return __normalIndexList->getAt(i); }
+    return const_array(*__normalIndexList).getAt(i); }
 
   /** Returns the \e i-th value of \b IndexList.
       \pre
@@ -659,7 +667,7 @@ public:
       - \e i must belong to the range [0,size of \b IndexList). */
   inline const IndexType& getColorIndexListAt( uint_t i ) const
   { GEOM_ASSERT(is_valid_ptr(__colorIndexList) && i < __colorIndexList->size());
-    return __colorIndexList->getAt(i); }
+    return const_array(*__colorIndexList).getAt(i); }
 
   /** Returns the \e i-th value of \b IndexList.
       \pre
@@ -685,7 +693,7 @@ public:
       - \e i must belong to the range [0,size of \b IndexList). */
   inline const IndexType& getTexCoordIndexListAt( uint_t i ) const
   { GEOM_ASSERT(is_valid_ptr(__texCoordIndexList) && i < __texCoordIndexList->size());
-    return __texCoordIndexList->getAt(i); }
+    return const_array(*__texCoordIndexList).getAt(i); }
 
   /** Returns the \e i-th value of \b IndexList.
       \pre
@@ -156,7 +156,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
   };
 
   // Indices check
-  typename MeshIndexArrayType::iterator _it = (*IndexList)->begin();
+  typename MeshIndexArrayType::const_iterator _it = const_array(**IndexList).begin();
   for (uint_t _i = 0; _i < _indexListSize; ++_i,++_it) {
     // Max index check
       if (*(std::max_element(_it->begin(),_it->end())) >= _pointListSize) {
@@ -202,7 +202,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
               }
           }
           // NormalIndexList values check
-          typename MeshIndexArrayType::iterator _it = (*NormalIndexList)->begin();
+          typename MeshIndexArrayType::const_iterator _it = const_array(**NormalIndexList).begin();
           for (uint_t _i = 0; _i < _normalIndexListSize; ++_i,++_it) {
             // Max index check
               if (*std::max_element(_it->begin(),_it->end()) >= _normalListSize) {
@@ -211,7 +211,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
                 return false;
             }
             // Size index check
-            if (_it->size() != (*IndexList)->getAt(_i).size()) {
+            if (_it->size() != const_array(**IndexList).getAt(_i).size()) {
                 pglErrorEx
                     (PGLWARNINGMSG(INVALID_FIELD_ITH_VALUE_ssss),classname.c_str(),"NormalIndexList",number(_i+1).c_str(),"Normal indice size do no reflect actual polygon indice size.");
                 return false;
@@ -259,7 +259,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
               }
           }
           // ColorIndexList values check
-          typename MeshIndexArrayType::iterator _it = (*ColorIndexList)->begin();
+          typename MeshIndexArrayType::const_iterator _it = const_array(**ColorIndexList).begin();
           for (uint_t _i = 0; _i < _colorIndexListSize; ++_i,++_it) {
             // Max index check
             if (*(std::max_element(_it->begin(),_it->end())) >= _colorListSize) {
@@ -268,7 +268,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
                 return false;
             }
             // Size index check
-            if (_it->size() != (*IndexList)->getAt(_i).size()) {
+            if (_it->size() != const_array(**IndexList).getAt(_i).size()) {
                 pglErrorEx
                     (PGLWARNINGMSG(INVALID_FIELD_ITH_VALUE_ssss),classname.c_str(),"ColorIndexList",number(_i+1).c_str(),"Color indice size do no reflect actual polygon indice size.");
                 return false;
@@ -300,7 +300,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
             return false;
           }
           // TexCoordIndexList values check
-          typename MeshIndexArrayType::iterator _it = (*TexCoordIndexList)->begin();
+          typename MeshIndexArrayType::const_iterator _it = const_array(**TexCoordIndexList).begin();
           for (uint_t _i = 0; _i < _texCoordIndexListSize; ++_i,++_it) {
             // Max index check
             if (*(std::max_element(_it->begin(),_it->end())) >= _texCoordListSize) {
@@ -309,7 +309,7 @@ bool IndexedMesh<IndexArrayType>::Builder<MeshType>::IndexedMeshValidity( ) cons
                 return false;
             }
             // Size index check
-            if (_it->size() != (*IndexList)->getAt(_i).size()) {
+            if (_it->size() != const_array(**IndexList).getAt(_i).size()) {
                 pglErrorEx
                     (PGLWARNINGMSG(INVALID_FIELD_ITH_VALUE_ssss),classname.c_str(),"TexCoordIndexList",number(_i+1).c_str(),"TexCoord indice size do no reflect actual polygon indice size.");
                 return false;
@@ -244,6 +244,10 @@ NurbsCurve::NurbsCurve(  const Point3ArrayPtr& ctrlPoints,
 
 NurbsCurve::~NurbsCurve( ) {
 }
+
+size_t NurbsCurve::getDeepModificationStamp( ) const {
+  return pglMax(BezierCurve::getDeepModificationStamp(), deepModificationStamp(__knotList));
+}
 /* ----------------------------------------------------------------------- */
 
 const uint_t
@@ -442,11 +446,12 @@ Vector3 NurbsCurve::getPointAt(real_t u) const{
     GEOM_ASSERT( (getFirstKnot() -u ) < GEOM_EPSILON &&  !((u - getLastKnot()) > GEOM_EPSILON));
 
     uint_t span = findSpan(u);
-    RealArrayPtr _basisFunctions = computeBasisFunctions(span,u);
+    real_t * _basisFunctions = (real_t*)alloca((__degree+1)*sizeof(real_t));
+    basisFunctions(span,u,__degree,__knotList,_basisFunctions);
     Vector4 Cw(0.0,0.0,0.0,0.0);
     for (uint_t j = 0; j <= __degree; j++) {
         Vector4 Pj = __ctrlPointList->getAt( span - __degree + j ).wtoxyz();
-        Cw += Pj * _basisFunctions->getAt(j);
+        Cw += Pj * _basisFunctions[j];
     }
 
     if (fabs(Cw.w()) < GEOM_TOLERANCE)
@@ -455,6 +460,25 @@ Vector3 NurbsCurve::getPointAt(real_t u) const{
     return Cw.project();
 }
 
+Point3ArrayPtr NurbsCurve::getPointsAt(const RealArrayPtr& u) const{
+    Point3ArrayPtr result(new Point3Array(u->size()));
+    real_t * _basisFunctions = (real_t*)alloca((__degree+1)*sizeof(real_t));
+    uint_t span = __degree;
+    Point3Array::iterator itres = result->begin();
+    for (RealArray::const_iterator itu = u->begin(); itu != u->end(); ++itu, ++itres) {
+        span = PGL::findSpan(*itu,__degree,__knotList,span);
+        basisFunctions(span,*itu,__degree,__knotList,_basisFunctions);
+        Vector4 Cw(0.0,0.0,0.0,0.0);
+        for (uint_t j = 0; j <= __degree; j++) {
+            Vector4 Pj = __ctrlPointList->getAt( span - __degree + j ).wtoxyz();
+            Cw += Pj * _basisFunctions[j];
+        }
+        if (fabs(Cw.w()) < GEOM_TOLERANCE) *itres = Vector3(Cw.x(),Cw.y(),Cw.z());
+        else *itres = Cw.project();
+    }
+    return result;
+}
+
 Vector3 NurbsCurve::getTangentAt(real_t u) const {
     GEOM_ASSERT( (getFirstKnot() -u ) < GEOM_EPSILON &&  !((u - getLastKnot()) > GEOM_EPSILON));
     return getDerivativeAt( u, 1 );
@@ -566,13 +590,32 @@ PGL(findSpan)(real_t u,
 
 }
 
+uint_t
+PGL(findSpan)(real_t u,
+     uint_t _degree,
+     const RealArrayPtr& _knotList,
+     uint_t hint ){
+  uint_t n = _knotList->size()-_degree -1;
+  if (hint >= _degree && hint < n) {
+      if (u >= _knotList->getAt(hint) && u < _knotList->getAt(hint+1)) return hint;
+      if (hint+1 < n && u >= _knotList->getAt(hint+1) && u < _knotList->getAt(hint+2)) return hint+1;
+  }
+  return PGL(findSpan)(u, _degree, _knotList);
+}
+
 RealArrayPtr
 PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _knotList) {
   RealArrayPtr BasisFunctions(new RealArray(_degree + 1));
+  basisFunctions(span, u, _degree, _knotList, &*BasisFunctions->begin());
+  return BasisFunctions;
+}
+
+void
+PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _knotList, real_t * BasisFunctions) {
   if( span >= _knotList->size()-_degree - 1){ // for clamped vector only
-    for(uint_t _i = 0 ; _i <_degree ; _i ++)
-      BasisFunctions->setAt(_degree - _i ,1.0);
-    return BasisFunctions;
+    for(uint_t _i = 0 ; _i <= _degree ; _i ++)
+      BasisFunctions[_i] = (_i > 0 ? 1.0 : 0.0);
+    return;
   }
 
   /// memory set with alloca is automatically freed at the end of the function
@@ -580,7 +623,7 @@ PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _
   real_t * right= &left[ _degree+1 ];
   real_t saved;
 
-  BasisFunctions->setAt(0,1.0);
+  BasisFunctions[0] = 1.0;
 
   for( uint_t j = 1 ; j <= _degree ; j++ ){
     left[j] = u - _knotList->getAt(span + 1 -j) ;
@@ -593,13 +636,12 @@ PGL(basisFunctions)(uint_t span, real_t u, uint_t _degree, const RealArrayPtr& _
                  << j << '-' << r << "] = " << left[j-r] << endl;
         }
         assert(right[r+1] + left[j-r] != 0);
-        real_t temp = BasisFunctions->getAt(r) / ( right[r+1] + left[j-r] );
-        BasisFunctions->setAt(r, saved + ( right[r+1] * temp ));
+        real_t temp = BasisFunctions[r] / ( right[r+1] + left[j-r] );
+        BasisFunctions[r] = saved + ( right[r+1] * temp );
         saved = left[j-r] * temp;
     }
-    BasisFunctions->setAt(j,saved);
+    BasisFunctions[j] = saved;
   }
-  return BasisFunctions;
 }
 
 /* Algo A2.3 p72 Nurbs Book */
@@ -861,6 +903,10 @@ NurbsCurve2D::NurbsCurve2D(  const Point3ArrayPtr& ctrlPoints, uint_t degree, co
 NurbsCurve2D::~NurbsCurve2D( ) {
 }
 
+size_t NurbsCurve2D::getDeepModificationStamp( ) const {
+  return pglMax(BezierCurve2D::getDeepModificationStamp(), deepModificationStamp(__knotList));
+}
+
 /* ----------------------------------------------------------------------- */
 
 
@@ -946,11 +992,12 @@ Vector2 NurbsCurve2D::getPointAt(real_t u) const{
   GEOM_ASSERT( (getFirstKnot() -u ) < GEOM_EPSILON &&  !((u - getLastKnot()) > GEOM_EPSILON));
 
   uint_t span = findSpan(u);
-  RealArrayPtr _basisFunctions = basisFunctions(span,u,__degree,__knotList);
+  real_t * _basisFunctions = (real_t*)alloca((__degree+1)*sizeof(real_t));
+  basisFunctions(span,u,__degree,__knotList,_basisFunctions);
   Vector3 Cw(0.0,0.0,0.0);
   for (uint_t j = 0; j <= __degree; j++) {
       Vector3 Pj = __ctrlPointList->getAt( span - __degree + j ).ztoxy();
-      Cw += Pj * _basisFunctions->getAt(j);
+      Cw += Pj * _basisFunctions[j];
   }
 
   if (fabs(Cw.z()) < GEOM_TOLERANCE)
@@ -959,6 +1006,25 @@ Vector2 NurbsCurve2D::getPointAt(real_t u) const{
   return Cw.project();
 }
 
+Point2ArrayPtr NurbsCurve2D::getPointsAt(const RealArrayPtr& u) const{
+  Point2ArrayPtr result(new Point2Array(u->size()));
+  real_t * _basisFunctions = (real_t*)alloca((__degree+1)*sizeof(real_t));
+  uint_t span = __degree;
+  Point2Array::iterator itres = result->begin();
+  for (RealArray::const_iterator itu = u->begin(); itu != u->end(); ++itu, ++itres) {
+      span = PGL::findSpan(*itu,__degree,__knotList,span);
+      basisFunctions(span,*itu,__degree,__knotList,_basisFunctions);
+      Vector3 Cw(0.0,0.0,0.0);
+      for (uint_t j = 0; j <= __degree; j++) {
+          Vector3 Pj = __ctrlPointList->getAt( span - __degree + j ).ztoxy();
+          Cw += Pj * _basisFunctions[j];
+      }
+      if (fabs(Cw.z()) < GEOM_TOLERANCE) *itres = Vector2(Cw.x(),Cw.y());
+      else *itres = Cw.project();
+  }
+  return result;
+}
+
 /* Algo A2.3 p72 Nurbs Book */
 RealArray2Ptr NurbsCurve2D::computeDerivatesBasisFunctions(int n,real_t u, int span ) const {
     return derivatesBasisFunctions(n,u,span,__degree,__knotList);
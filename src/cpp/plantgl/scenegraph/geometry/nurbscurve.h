@@ -138,6 +138,9 @@ public:
   /// Destructor
   virtual ~NurbsCurve( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(NurbsCurve)
 
   /// Returns \e Degree value.
@@ -180,6 +183,13 @@ public:
   */
   virtual Vector3 getPointAt(real_t u) const;
 
+  /*!
+     Compute the points on the NURBS for all the parameters of \e u.
+     Knot spans are searched from the span of the previous parameter and
+     basis functions are computed on the stack.
+  */
+  virtual Point3ArrayPtr getPointsAt(const RealArrayPtr& u) const;
+
   /* Returns the \e Tangent for u = \e u.
       (see the Nurbs book p.12)
      \pre
@@ -326,6 +336,9 @@ public:
   /// Destructor
   virtual ~NurbsCurve2D( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(NurbsCurve2D)
 
   /// Returns \e Degree value.
@@ -407,6 +420,13 @@ public:
   */
   virtual Vector2 getPointAt(real_t u) const;
 
+  /*!
+     Compute the points on the NURBS for all the parameters of \e u.
+     Knot spans are searched from the span of the previous parameter and
+     basis functions are computed on the stack.
+  */
+  virtual Point2ArrayPtr getPointsAt(const RealArrayPtr& u) const;
+
   /* Returns the \e Tangent for u = \e u.
       (see the Nurbs book p.12)
      \pre
@@ -438,6 +458,13 @@ typedef RCPtr<NurbsCurve2D> NurbsCurve2DPtr;
 uint_t SG_API findSpan(real_t u,  uint_t _degree,
         const RealArrayPtr& _knotList);
 
+  /*! Determine the knot Span index, starting from the span \e hint.
+    The span is found in constant time if \e u lies in \e hint or in the next span,
+    as for increasing parameters.
+  */
+uint_t SG_API findSpan(real_t u,  uint_t _degree,
+        const RealArrayPtr& _knotList, uint_t hint);
+
 /*! \brief Compute the Basis Functions Values
   Algo 2.2 From The Nurbs Book p70
 */
@@ -445,6 +472,14 @@ RealArrayPtr SG_API basisFunctions(uint_t span, real_t u,
                    uint_t _degree,
                    const RealArrayPtr& _knotList );
 
+/*! \brief Compute the Basis Functions Values into \e result
+  which must hold _degree+1 values. Nothing is allocated.
+*/
+void SG_API basisFunctions(uint_t span, real_t u,
+                   uint_t _degree,
+                   const RealArrayPtr& _knotList,
+                   real_t * result );
+
 /*!
   \brief Compute the Derivates Basis Functions Values
   Algo A2.3 p72 Nurbs Book
@@ -51,6 +51,10 @@
 #include <plantgl/tool/util_array.h>
 #include <plantgl/scenegraph/container/pointmatrix.h>
 #include <plantgl/scenegraph/container/pointarray.h>
+#ifdef _WIN32
+#include <malloc.h>
+#define alloca _alloca
+#endif
 //#include <iostream>
 
 PGL_USING_NAMESPACE
@@ -315,6 +319,10 @@ NurbsPatch::NurbsPatch( const Point3MatrixPtr& ctrlPoints,
 NurbsPatch::~NurbsPatch( ) {
 }
 
+size_t NurbsPatch::getDeepModificationStamp( ) const {
+  return pglMax(BezierPatch::getDeepModificationStamp(), deepModificationStamp(__uKnotList, __vKnotList));
+}
+
 
 SceneObjectPtr NurbsPatch::copy(DeepCopier& copier) const {
   NurbsPatch * ptr = new NurbsPatch(*this);
@@ -515,9 +523,11 @@ Vector3 NurbsPatch::getPointAt(real_t u, real_t v) const{
   GEOM_ASSERT( u >= getFirstUKnot() && u <= getLastUKnot() && v>= getFirstVKnot() && v<= getLastVKnot());
 
   uint_t uspan = findSpan(u,__udegree,__uKnotList);
-  RealArrayPtr Nu = basisFunctions(uspan, u, __udegree, __uKnotList);
+  real_t * Nu = (real_t*)alloca((__udegree+1)*sizeof(real_t));
+  basisFunctions(uspan, u, __udegree, __uKnotList, Nu);
   uint_t vspan = findSpan(v,__vdegree,__vKnotList);
-  RealArrayPtr Nv = basisFunctions(vspan, v, __vdegree, __vKnotList);
+  real_t * Nv = (real_t*)alloca((__vdegree+1)*sizeof(real_t));
+  basisFunctions(vspan, v, __vdegree, __vKnotList, Nv);
   Vector4 Sw( 0 , 0 , 0 ,0 );
 
   uint_t uind = uspan - __udegree;
@@ -533,10 +543,10 @@ Vector3 NurbsPatch::getPointAt(real_t u, real_t v) const{
              NurbsPatch.getPointAt which is  coherent.
            */
           Vector4 ipt = __ctrlPointMatrix->getAt(uind+k,vind).wtoxyz();
-          temp += (ipt *  (Nu->getAt(k))) ;
+          temp += (ipt *  Nu[k]) ;
 
       }
-      Sw += temp * Nv->getAt(l);
+      Sw += temp * Nv[l];
   }
 
 
@@ -547,6 +557,55 @@ Vector3 NurbsPatch::getPointAt(real_t u, real_t v) const{
   return Sw.project();
 }
 
+Point3ArrayPtr NurbsPatch::getPointsAt(const RealArrayPtr& u, const RealArrayPtr& v) const{
+  uint_t nu = u->size();
+  uint_t nv = v->size();
+  Point3ArrayPtr result(new Point3Array(nu * nv));
+  if (nu == 0 || nv == 0) return result;
+
+  // Spans and basis functions in v are shared by all the rows of the grid.
+  vector<uint_t> vspans(nv);
+  vector<real_t> Nv(nv * (__vdegree+1));
+  uint_t vspan = __vdegree;
+  for (uint_t j = 0 ; j < nv ; j++ ){
+      real_t _v = v->getAt(j);
+      GEOM_ASSERT( _v >= getFirstVKnot() && _v <= getLastVKnot() );
+      vspan = findSpan(_v,__vdegree,__vKnotList,vspan);
+      vspans[j] = vspan;
+      basisFunctions(vspan, _v, __vdegree, __vKnotList, &Nv[j * (__vdegree+1)]);
+  }
+
+  // For each u, control points are combined in u once for every column.
+  uint_t vdim = __ctrlPointMatrix->getColumnNb();
+  vector<Vector4> temp(vdim);
+  real_t * Nu = (real_t*)alloca((__udegree+1)*sizeof(real_t));
+  uint_t uspan = __udegree;
+  Point3Array::iterator itres = result->begin();
+  for (uint_t i = 0 ; i < nu ; i++ ){
+      real_t _u = u->getAt(i);
+      GEOM_ASSERT( _u >= getFirstUKnot() && _u <= getLastUKnot() );
+      uspan = findSpan(_u,__udegree,__uKnotList,uspan);
+      basisFunctions(uspan, _u, __udegree, __uKnotList, Nu);
+      uint_t uind = uspan - __udegree;
+      for (uint_t c = 0 ; c < vdim ; c++ ){
+          Vector4 t( 0 , 0 , 0 ,0 );
+          for (uint_t k = 0 ; k <= __udegree ; k++ )
+              t += (__ctrlPointMatrix->getAt(uind+k,c).wtoxyz() * Nu[k]);
+          temp[c] = t;
+      }
+      for (uint_t j = 0 ; j < nv ; j++, ++itres ){
+          const real_t * _nv = &Nv[j * (__vdegree+1)];
+          Vector4 Sw( 0 , 0 , 0 ,0 );
+          uint_t vind = vspans[j] - __vdegree;
+          for (uint_t l = 0 ; l <= __vdegree ; l++ )
+              Sw += temp[vind+l] * _nv[l];
+          if (fabs(Sw.w()) < GEOM_TOLERANCE) *itres = Vector3(Sw.x(),Sw.y(),Sw.z());
+          else *itres = Sw.project();
+      }
+  }
+  return result;
+}
+
 
 Vector3 NurbsPatch::getUTangentAt(real_t u, real_t v) const {
     GEOM_ASSERT( u >= getFirstUKnot( ) && u <= getLastUKnot( ) && v>= getFirstVKnot( ) && v<=getLastVKnot( ));
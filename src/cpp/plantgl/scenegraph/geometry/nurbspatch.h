@@ -147,6 +147,9 @@ public:
   /// Destructor
   virtual ~NurbsPatch( ) ;
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(NurbsPatch)
 
   /// Returns \e UDegree value.
@@ -220,6 +223,12 @@ public:
       - \e v must be in [0,1];*/
   virtual Vector3 getPointAt(real_t u,real_t v) const;
 
+  /*! Returns the \e Points of the grid of parameters \e u x \e v.
+      The point of u[i] and v[j] is at index i * v->size() + j.
+      Basis functions in v are computed once for the whole grid and
+      control points are combined in u once per value of u.*/
+  virtual Point3ArrayPtr getPointsAt(const RealArrayPtr& u, const RealArrayPtr& v) const;
+
   /* Returns the \e Metric for  u = \e u and v = \e v.
       (see Differential Geometry, Kreyszig p. 82)
      \author Michael Walker
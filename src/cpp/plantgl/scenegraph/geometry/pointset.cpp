@@ -232,6 +232,10 @@ PointSet2D::PointSet2D(  ) :
 PointSet2D::~PointSet2D( ) {
 }
 
+size_t PointSet2D::getDeepModificationStamp( ) const {
+  return pglMax(PlanarModel::getDeepModificationStamp(), deepModificationStamp(__pointList));
+}
+
 bool PointSet2D::isValid( ) const {
   Builder _builder;
   _builder.PointList = const_cast<Point2ArrayPtr *>(&__pointList);
@@ -207,6 +207,9 @@ public:
   /// Destructor
   virtual ~PointSet2D( ) ;
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(PointSet2D)
 
   /** Returns the value of the \e i-th point of \b PointList.
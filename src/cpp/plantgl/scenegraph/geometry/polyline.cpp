@@ -339,6 +339,10 @@ Polyline2D::Polyline2D( const Point2ArrayPtr& points, uchar_t width ) :
 Polyline2D::~Polyline2D( ) {
 }
 
+size_t Polyline2D::getDeepModificationStamp( ) const {
+  return pglMax(Curve2D::getDeepModificationStamp(), deepModificationStamp(__pointList));
+}
+
 bool Polyline2D::isValid( ) const {
   Builder _builder;
   if(__pointList)_builder.PointList = const_cast<Point2ArrayPtr *>(&__pointList);
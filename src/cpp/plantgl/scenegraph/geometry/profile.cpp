@@ -552,7 +552,7 @@ real_t ProfileInterpolation::getUMax() const
 
 /////////////////////////////////////////////////////////////////////////////
 
-const Point2ArrayPtr& ProfileInterpolation::getSection2DAt(real_t u) const
+Point2ArrayPtr ProfileInterpolation::getSection2DAt(real_t u) const
 {
 #ifdef DEBUG
   cout<<"-> getSectionAt "<< u << endl;
@@ -562,14 +562,14 @@ const Point2ArrayPtr& ProfileInterpolation::getSection2DAt(real_t u) const
     return __evalPt2D;
 
   GEOM_ASSERT( __is2D );
-  GEOM_ASSERT( __evalPt2D && __fctList2D );
-  GEOM_ASSERT( __evalPt2D->size() == __fctList2D->size() );
+  GEOM_ASSERT( __fctList2D );
 
   Curve2DArray::const_iterator itBegin= __fctList2D->begin();
   Curve2DArray::const_iterator itEnd=   __fctList2D->end();
   Curve2DArray::const_iterator it= itBegin;
 
-  Point2Array::iterator itPt= __evalPt2D->begin();
+  Point2ArrayPtr section( new Point2Array( __fctList2D->size() ) );
+  Point2Array::iterator itPt= section->begin();
 
   for( it= itBegin; it < itEnd; it++, itPt++ )
     {
@@ -579,12 +579,12 @@ const Point2ArrayPtr& ProfileInterpolation::getSection2DAt(real_t u) const
 #ifdef DEBUG
 //cout<<"<-"<<endl;
 #endif
-  return __evalPt2D;
+  return section;
 }
 
 /////////////////////////////////////////////////////////////////////////////
 
-const Point3ArrayPtr& ProfileInterpolation::getSection3DAt(real_t u) const
+Point3ArrayPtr ProfileInterpolation::getSection3DAt(real_t u) const
 {
 #ifdef DEBUG
 //cout<<"-> getSectionAt "<< u <<endl;
@@ -594,14 +594,14 @@ const Point3ArrayPtr& ProfileInterpolation::getSection3DAt(real_t u) const
     return __evalPt3D;
 
   GEOM_ASSERT( !__is2D );
-  GEOM_ASSERT( __evalPt3D && __fctList3D );
-  GEOM_ASSERT( __evalPt3D->size() == __fctList3D->size() );
+  GEOM_ASSERT( __fctList3D );
 
   CurveArray::const_iterator itBegin= __fctList3D->begin();
   CurveArray::const_iterator itEnd=   __fctList3D->end();
   CurveArray::const_iterator it= itBegin;
 
-  Point3Array::iterator itPt= __evalPt3D->begin();
+  Point3ArrayPtr section( new Point3Array( __fctList3D->size() ) );
+  Point3Array::iterator itPt= section->begin();
 
   for( it= itBegin; it < itEnd; it++, itPt++ )
     {
@@ -611,7 +611,7 @@ const Point3ArrayPtr& ProfileInterpolation::getSection3DAt(real_t u) const
 #ifdef DEBUG
 //cout<<"<-"<<endl;
 #endif
-  return __evalPt3D;
+  return section;
 }
 
 bool ProfileInterpolation::check_interpolation() {
@@ -814,7 +814,7 @@ cout<<"get2DCurve "<<i<<endl;
       __fctList2D->getAt(i)= local.get2DCurve();
       if(itpEnd != allPts2D->end()){ itpBegin+= n; itpEnd+= n; }
       }
-    __evalPt2D= Point2ArrayPtr( new Point2Array( __stride+1 ) );
+    __evalPt2D= Point2ArrayPtr();
     __evalPt3D= Point3ArrayPtr();
     __fctList3D= CurveArrayPtr();
 
@@ -835,7 +835,7 @@ cout<<"get2DCurve "<<i<<endl;
           __fctList3D->getAt(i)= local.get3DCurve();
           if(itpEnd != allPts3D->end()){ itpBegin+= n; itpEnd+= n; }
       }
-      __evalPt3D= Point3ArrayPtr(new Point3Array( __stride+1 ));
+      __evalPt3D= Point3ArrayPtr();
       __fctList2D= Curve2DArrayPtr();
       __evalPt2D= Point2ArrayPtr();
   }
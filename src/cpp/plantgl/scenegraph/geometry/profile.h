@@ -240,9 +240,9 @@ class SG_API ProfileInterpolation : public RefCountObject
   /// Return the maximal \e u value.
   virtual real_t getUMax() const;
 
-  /// Return the section at u = \e u
-  virtual const Point2ArrayPtr& getSection2DAt(real_t u) const;
-  virtual const Point3ArrayPtr& getSection3DAt(real_t u) const;
+  /// Return the section at u = \e u. Later calls do not modify the returned array, so that sections can be evaluated concurrently.
+  virtual Point2ArrayPtr getSection2DAt(real_t u) const;
+  virtual Point3ArrayPtr getSection3DAt(real_t u) const;
 
   /// Return the Profile List value.
   virtual const Curve2DArrayPtr& getProfileList( ) const;
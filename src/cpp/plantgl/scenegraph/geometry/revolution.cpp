@@ -120,6 +120,10 @@ Revolution::Revolution( const Curve2DPtr& profile,
 Revolution::~Revolution( ) {
 }
 
+size_t Revolution::getDeepModificationStamp( ) const {
+  return pglMax(SOR::getDeepModificationStamp(), deepModificationStamp(__profile));
+}
+
 
 bool Revolution::isValid( ) const {
   Builder _builder;
@@ -105,6 +105,9 @@ public:
   /// Destructor
   virtual ~Revolution( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(Revolution)
 
   /// Returns PointList values.
@@ -218,6 +218,12 @@ Swung::Swung( const Curve2DArrayPtr& profileList,
 Swung::~Swung( )
     { }
 
+size_t Swung::getDeepModificationStamp( ) const {
+  size_t stamp = SOR::getDeepModificationStamp();
+  if (__profiles) stamp = pglMax(stamp, deepModificationStamp(__profiles->getProfileList(), __profiles->getKnotList()));
+  return stamp;
+}
+
 
 SceneObjectPtr Swung::copy(DeepCopier& copier) const {
   Swung * ptr = new Swung(*this);
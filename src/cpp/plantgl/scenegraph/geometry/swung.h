@@ -154,6 +154,9 @@ public:
   /// Destructor
   virtual ~Swung( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(Swung)
 
   /// Returns \b CCW value.
@@ -110,6 +110,10 @@ Deformed::Deformed( const PrimitivePtr& primitive ) :
 Deformed::~Deformed( ) {
 }
 
+size_t Deformed::getDeepModificationStamp( ) const {
+  return pglMax(Transformed::getDeepModificationStamp(), deepModificationStamp(__primitive));
+}
+
 const GeometryPtr
 Deformed::getGeometry( ) const {
   return GeometryPtr(__primitive);
@@ -126,6 +126,9 @@ public:
   /// Destructor.
   virtual ~Deformed( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   virtual const GeometryPtr getGeometry( ) const;
 
   /** Returns \b Primitive value.*/
@@ -135,12 +135,12 @@ Point3ArrayPtr IT::transform( const Point3ArrayPtr& points ) const
 
   Point3Array::iterator _ti = _tPoints->begin();
 
-  Matrix4Array::const_iterator _mi= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mib= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mie= __transfoNodes->end();
-  Point3Array::const_iterator _i = points->begin();
-  Point3Array::const_iterator _ib = points->begin();
-  Point3Array::const_iterator _ie = points->end();
+  Matrix4Array::const_iterator _mi= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mib= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mie= const_array(*__transfoNodes).end();
+  Point3Array::const_iterator _i = const_array(*points).begin();
+  Point3Array::const_iterator _ib = const_array(*points).begin();
+  Point3Array::const_iterator _ie = const_array(*points).end();
 
   for( _mi= _mib; _mi != _mie; _mi++ )
     for( _i = _ib; _i != _ie; _i++ )
@@ -160,12 +160,12 @@ Point4ArrayPtr IT::transform( const Point4ArrayPtr& points ) const
 
   Point4Array::iterator _ti = _tPoints->begin();
 
-  Matrix4Array::const_iterator _mi= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mib= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mie= __transfoNodes->end();
-  Point4Array::const_iterator _i = points->begin();
-  Point4Array::const_iterator _ib = points->begin();
-  Point4Array::const_iterator _ie = points->end();
+  Matrix4Array::const_iterator _mi= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mib= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mie= const_array(*__transfoNodes).end();
+  Point4Array::const_iterator _i = const_array(*points).begin();
+  Point4Array::const_iterator _ib = const_array(*points).begin();
+  Point4Array::const_iterator _ie = const_array(*points).end();
 
   for( _mi= _mib; _mi != _mie; _mi++ )
     for( _i = _ib; _i != _ie; _i++ )
@@ -185,12 +185,12 @@ Point3MatrixPtr IT::transform( const Point3MatrixPtr& points ) const
 
   Point3Matrix::iterator _ti = _tPoints->begin();
 
-  Matrix4Array::const_iterator _mi= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mib= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mie= __transfoNodes->end();
-  Point3Matrix::const_iterator _i = points->begin();
-  Point3Matrix::const_iterator _ib = points->begin();
-  Point3Matrix::const_iterator _ie = points->end();
+  Matrix4Array::const_iterator _mi= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mib= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mie= const_array(*__transfoNodes).end();
+  Point3Matrix::const_iterator _i = const_array(*points).begin();
+  Point3Matrix::const_iterator _ib = const_array(*points).begin();
+  Point3Matrix::const_iterator _ie = const_array(*points).end();
 
   for( _mi= _mib; _mi != _mie; _mi++ )
     for( _i = _ib; _i != _ie; _i++ )
@@ -210,12 +210,12 @@ Point4MatrixPtr IT::transform( const Point4MatrixPtr& points ) const
 
   Point4Matrix::iterator _ti = _tPoints->begin();
 
-  Matrix4Array::const_iterator _mi= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mib= __transfoNodes->begin();
-  Matrix4Array::const_iterator _mie= __transfoNodes->end();
-  Point4Matrix::const_iterator _i = points->begin();
-  Point4Matrix::const_iterator _ib = points->begin();
-  Point4Matrix::const_iterator _ie = points->end();
+  Matrix4Array::const_iterator _mi= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mib= const_array(*__transfoNodes).begin();
+  Matrix4Array::const_iterator _mie= const_array(*__transfoNodes).end();
+  Point4Matrix::const_iterator _i = const_array(*points).begin();
+  Point4Matrix::const_iterator _ib = const_array(*points).begin();
+  Point4Matrix::const_iterator _ie = const_array(*points).end();
 
   for( _mi= _mib; _mi != _mie; _mi++ )
     for( _i = _ib; _i != _ie; _i++ )
@@ -354,6 +354,13 @@ IFS::IFS( uchar_t depth,
 IFS::~IFS( )
 { }
 
+size_t IFS::getDeepModificationStamp( ) const {
+  size_t stamp = pglMax(Transformed::getDeepModificationStamp(), deepModificationStamp(__geometry));
+  // the transformations are not scene objects, only the array is stamped.
+  if (__transfoList) stamp = pglMax(stamp, __transfoList->getModificationStamp());
+  return stamp;
+}
+
 /////////////////////////////////////////////////////////////////////////////
 bool IFS::isValid( ) const
 /////////////////////////////////////////////////////////////////////////////
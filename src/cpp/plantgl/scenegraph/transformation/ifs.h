@@ -179,6 +179,9 @@ public:
   /// Destructor
   virtual ~IFS( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(IFS)
 
   /// Returns the transformation attached to \e self.
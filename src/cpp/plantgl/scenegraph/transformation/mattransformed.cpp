@@ -125,6 +125,10 @@ MatrixTransformed::MatrixTransformed() :
 MatrixTransformed::~MatrixTransformed( ) {
 }
 
+size_t MatrixTransformed::getDeepModificationStamp( ) const {
+  return pglMax(Transformed::getDeepModificationStamp(), deepModificationStamp(__geometry));
+}
+
 const GeometryPtr
 MatrixTransformed::getGeometry( ) const {
   return __geometry;
@@ -177,8 +181,8 @@ GeneralMatrix3Transformation::transform( const Point2ArrayPtr& points ) const{
   GEOM_ASSERT(points);
   Point2ArrayPtr _tPoints(new Point2Array(points->size()));
   Point2Array::iterator _ti = _tPoints->begin();
-  for (Point2Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = (__matrix * Vector3(*_i,1.0)).project();
   return _tPoints;
@@ -189,8 +193,8 @@ GeneralMatrix3Transformation::transform( const Point3ArrayPtr& points ) const{
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = __matrix * (*_i);
   return _tPoints;
@@ -201,8 +205,8 @@ GeneralMatrix3Transformation::transform( const Point2MatrixPtr& points ) const{
   GEOM_ASSERT(points);
   Point2MatrixPtr _tPoints(new Point2Matrix(points->size()));
   Point2Matrix::iterator _ti = _tPoints->begin();
-  for (Point2Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = (__matrix * Vector3(*_i,1.0)).project();
   return _tPoints;
@@ -213,8 +217,8 @@ GeneralMatrix3Transformation::transform( const Point3MatrixPtr& points ) const{
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = __matrix * (*_i);
   return _tPoints;
@@ -329,8 +333,8 @@ Point3ArrayPtr Transform4::transform( const Point3ArrayPtr& points ) const
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  Point3Array::const_iterator _i = points->begin();
-  for ( _i = points->begin(); _i != points->end(); _i++ )
+  Point3Array::const_iterator _i = const_array(*points).begin();
+  for ( _i = const_array(*points).begin(); _i != const_array(*points).end(); _i++ )
     *_ti++ = __matrix * (*_i);
   return _tPoints;
 }
@@ -342,8 +346,8 @@ Point4ArrayPtr Transform4::transform( const Point4ArrayPtr& points ) const
   GEOM_ASSERT(points);
   Point4ArrayPtr _tPoints(new Point4Array(points->size()));
   Point4Array::iterator _ti = _tPoints->begin();
-  Point4Array::const_iterator _i = points->begin();
-  for ( _i = points->begin(); _i != points->end(); _i++ )
+  Point4Array::const_iterator _i = const_array(*points).begin();
+  for ( _i = const_array(*points).begin(); _i != const_array(*points).end(); _i++ )
     *_ti++ = __matrix * (*_i);
   return _tPoints;
 }
@@ -355,8 +359,8 @@ Point3MatrixPtr Transform4::transform( const Point3MatrixPtr& points ) const
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  Point3Matrix::const_iterator _i = points->begin();
-  for ( _i = points->begin(); _i != points->end(); _i++ )
+  Point3Matrix::const_iterator _i = const_array(*points).begin();
+  for ( _i = const_array(*points).begin(); _i != const_array(*points).end(); _i++ )
     *_ti++ = __matrix * (*_i);
   return _tPoints;
 }
@@ -368,8 +372,8 @@ Point4MatrixPtr Transform4::transform( const Point4MatrixPtr& points ) const
   GEOM_ASSERT(points);
   Point4MatrixPtr _tPoints(new Point4Matrix(points->size()));
   Point4Matrix::iterator _ti = _tPoints->begin();
-  Point4Matrix::const_iterator _i = points->begin();
-  for ( _i = points->begin(); _i != points->end(); _i++ )
+  Point4Matrix::const_iterator _i = const_array(*points).begin();
+  for ( _i = const_array(*points).begin(); _i != const_array(*points).end(); _i++ )
     *_ti++ = __matrix * (*_i);
   return _tPoints;
 }
@@ -218,6 +218,9 @@ public:
   /// Destructor.
   virtual ~MatrixTransformed( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   /// Returns Geometry value.
   virtual const GeometryPtr getGeometry( ) const;
 
@@ -89,8 +89,8 @@ Point3ArrayPtr OrthonormalBasis3D::transform( const Point3ArrayPtr& points ) con
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = __matrix * (*_i);
   return _tPoints;
@@ -101,8 +101,8 @@ Point4ArrayPtr OrthonormalBasis3D::transform( const Point4ArrayPtr& points ) con
   GEOM_ASSERT(points);
   Point4ArrayPtr _tPoints(new Point4Array(points->size()));
   Point4Array::iterator _ti = _tPoints->begin();
-  for (Point4Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point4Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector4(__matrix * Vector3(_i->x(),_i->y(),_i->z()),_i->w());
   return _tPoints;
@@ -113,8 +113,8 @@ Point3MatrixPtr OrthonormalBasis3D::transform( const Point3MatrixPtr& points ) c
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = __matrix * (*_i);
   return _tPoints;
@@ -125,8 +125,8 @@ Point4MatrixPtr OrthonormalBasis3D::transform( const Point4MatrixPtr& points ) c
   GEOM_ASSERT(points);
   Point4MatrixPtr _tPoints(new Point4Matrix(points->size()));
   Point4Matrix::iterator _ti = _tPoints->begin();
-  for (Point4Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point4Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector4(__matrix * Vector3(_i->x(),_i->y(),_i->z()),_i->w());
   return _tPoints;
@@ -183,8 +183,8 @@ Point2ArrayPtr OrthonormalBasis2D::transform( const Point2ArrayPtr& points ) con
   GEOM_ASSERT(points);
   Point2ArrayPtr _tPoints(new Point2Array(points->size()));
   Point2Array::iterator _ti = _tPoints->begin();
-  for (Point2Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = __matrix * (*_i);
   return _tPoints;
@@ -195,8 +195,8 @@ Point3ArrayPtr OrthonormalBasis2D::transform( const Point3ArrayPtr& points ) con
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(__matrix * Vector2(_i->x(),_i->y()),_i->z());
   return _tPoints;
@@ -207,8 +207,8 @@ Point2MatrixPtr OrthonormalBasis2D::transform( const Point2MatrixPtr& points ) c
   GEOM_ASSERT(points);
   Point2MatrixPtr _tPoints(new Point2Matrix(points->size()));
   Point2Matrix::iterator _ti = _tPoints->begin();
-  for (Point2Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = __matrix * (*_i);
   return _tPoints;
@@ -219,8 +219,8 @@ Point3MatrixPtr OrthonormalBasis2D::transform( const Point3MatrixPtr& points ) c
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(__matrix * Vector2(_i->x(),_i->y()),_i->z());
   return _tPoints;
@@ -79,8 +79,8 @@ Point3ArrayPtr Scaling::transform( const Point3ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
        _i++)
     *_ti++ = Vector3(_i->x() * __factors.x(),
                      _i->y() * __factors.y(),
@@ -93,8 +93,8 @@ Point4ArrayPtr Scaling::transform( const Point4ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point4ArrayPtr _tPoints(new Point4Array(points->size()));
   Point4Array::iterator _ti = _tPoints->begin();
-  for (Point4Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point4Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector4(_i->x() * __factors.x(),
                      _i->y() * __factors.y(),
@@ -108,8 +108,8 @@ Point3MatrixPtr Scaling::transform( const Point3MatrixPtr& points ) const {
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(_i->x() * __factors.x(),
                      _i->y() * __factors.y(),
@@ -122,8 +122,8 @@ Point4MatrixPtr Scaling::transform( const Point4MatrixPtr& points ) const {
   GEOM_ASSERT(points);
   Point4MatrixPtr _tPoints(new Point4Matrix(points->size()));
   Point4Matrix::iterator _ti = _tPoints->begin();
-  for (Point4Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point4Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector4(_i->x() * __factors.x(),
                      _i->y() * __factors.y(),
@@ -260,8 +260,8 @@ Point2ArrayPtr Scaling2D::transform( const Point2ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point2ArrayPtr _tPoints(new Point2Array(points->size()));
   Point2Array::iterator _ti = _tPoints->begin();
-  for (Point2Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
        _i++)
     *_ti++ = Vector2(_i->x() * __factors.x(),
                      _i->y() * __factors.y());
@@ -273,8 +273,8 @@ Point3ArrayPtr Scaling2D::transform( const Point3ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(_i->x() * __factors.x(),
                      _i->y() * __factors.y(),
@@ -287,8 +287,8 @@ Point2MatrixPtr Scaling2D::transform( const Point2MatrixPtr& points ) const {
   GEOM_ASSERT(points);
   Point2MatrixPtr _tPoints(new Point2Matrix(points->size()));
   Point2Matrix::iterator _ti = _tPoints->begin();
-  for (Point2Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector2(_i->x() * __factors.x(),
                      _i->y() * __factors.y());
@@ -300,8 +300,8 @@ Point3MatrixPtr Scaling2D::transform( const Point3MatrixPtr& points ) const {
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(_i->x() * __factors.x(),
                      _i->y() * __factors.y(),
@@ -110,6 +110,10 @@ ScreenProjected::ScreenProjected( ) :
 ScreenProjected::~ScreenProjected( ) {
 }
 
+size_t ScreenProjected::getDeepModificationStamp( ) const {
+  return pglMax(Transformed::getDeepModificationStamp(), deepModificationStamp(__geometry));
+}
+
 SceneObjectPtr ScreenProjected::copy(DeepCopier& copier) const {
   ScreenProjected * ptr = new ScreenProjected(*this);
   copier.copy_object_attribute(ptr->getGeometry());
@@ -105,6 +105,9 @@ public:
   /// Destructor.
   virtual ~ScreenProjected( );
 
+  /// Returns the greatest of the modification stamps of \e self, of its arrays and of its components.
+  virtual size_t getDeepModificationStamp( ) const;
+
   PGL_OBJECT(ScreenProjected)
 
   /// Returns Geometry value.
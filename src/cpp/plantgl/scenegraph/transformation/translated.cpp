@@ -76,8 +76,8 @@ Point3ArrayPtr Translation::transform( const Point3ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = *_i + __vector;
   return _tPoints;
@@ -88,8 +88,8 @@ Point4ArrayPtr Translation::transform( const Point4ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point4ArrayPtr _tPoints(new Point4Array(points->size()));
   Point4Array::iterator _ti = _tPoints->begin();
-  for (Point4Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point4Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector4(_i->x() + __vector.x() * _i->w(),
                      _i->y() + __vector.y() * _i->w(),
@@ -103,8 +103,8 @@ Point3MatrixPtr Translation::transform( const Point3MatrixPtr& points ) const {
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = *_i + __vector;
   return _tPoints;
@@ -115,8 +115,8 @@ Point4MatrixPtr Translation::transform( const Point4MatrixPtr& points ) const {
   GEOM_ASSERT(points);
   Point4MatrixPtr _tPoints(new Point4Matrix(points->size()));
   Point4Matrix::iterator _ti = _tPoints->begin();
-  for (Point4Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point4Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector4(_i->x() + __vector.x() * _i->w(),
                      _i->y() + __vector.y() * _i->w(),
@@ -261,8 +261,8 @@ Point2ArrayPtr Translation2D::transform( const Point2ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point2ArrayPtr _tPoints(new Point2Array(points->size()));
   Point2Array::iterator _ti = _tPoints->begin();
-  for (Point2Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = *_i + __vector;
   return _tPoints;
@@ -273,8 +273,8 @@ Point3ArrayPtr Translation2D::transform( const Point3ArrayPtr& points ) const {
   GEOM_ASSERT(points);
   Point3ArrayPtr _tPoints(new Point3Array(points->size()));
   Point3Array::iterator _ti = _tPoints->begin();
-  for (Point3Array::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Array::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(_i->x() + __vector.x() * _i->z(),
                      _i->y() + __vector.y() * _i->z(),
@@ -287,8 +287,8 @@ Point2MatrixPtr Translation2D::transform( const Point2MatrixPtr& points ) const
   GEOM_ASSERT(points);
   Point2MatrixPtr _tPoints(new Point2Matrix(points->size()));
   Point2Matrix::iterator _ti = _tPoints->begin();
-  for (Point2Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point2Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = *_i + __vector;
   return _tPoints;
@@ -299,8 +299,8 @@ Point3MatrixPtr Translation2D::transform( const Point3MatrixPtr& points ) const
   GEOM_ASSERT(points);
   Point3MatrixPtr _tPoints(new Point3Matrix(points->size()));
   Point3Matrix::iterator _ti = _tPoints->begin();
-  for (Point3Matrix::const_iterator _i = points->begin();
-       _i != points->end();
+  for (Point3Matrix::const_iterator _i = const_array(*points).begin();
+       _i != const_array(*points).end();
          _i++)
     *_ti++ = Vector3(_i->x() + __vector.x() * _i->z(),
                      _i->y() + __vector.y() * _i->z(),
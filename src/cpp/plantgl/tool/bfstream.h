@@ -52,6 +52,9 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
+#include <cstring>
+#include <stdint.h>
 //using namespace std;
 #include "util_tuple.h"
 
@@ -119,6 +122,40 @@ inline void flipBytes( const char * src, char * dest, size_t n )
         };
 }
 
+/*! \fn void flipBlock( char * data, size_t size, size_t nb )
+    \brief The flipBlock() function flips in place the bytes of \e nb
+    contiguous values of \e size bytes stored in \e data. */
+inline void flipBlock( char * data, size_t size, size_t nb )
+{
+        switch(size)
+        {
+        case 2:
+                for (char * _it = data, * _end = data + 2*nb; _it != _end; _it += 2){
+                    uint16_t v; memcpy(&v,_it,2);
+                    v = uint16_t((v >> 8) | (v << 8));
+                    memcpy(_it,&v,2);
+                }
+                break;
+        case 4:
+                for (char * _it = data, * _end = data + 4*nb; _it != _end; _it += 4){
+                    uint32_t v; memcpy(&v,_it,4);
+                    v = (v >> 24) | ((v >> 8) & 0x0000ff00u) | ((v << 8) & 0x00ff0000u) | (v << 24);
+                    memcpy(_it,&v,4);
+                }
+                break;
+        case 8:
+                for (char * _it = data, * _end = data + 8*nb; _it != _end; _it += 8){
+                    uint64_t v; memcpy(&v,_it,8);
+                    v = ((v >> 56) & 0x00000000000000ffull) | ((v >> 40) & 0x000000000000ff00ull) |
+                        ((v >> 24) & 0x0000000000ff0000ull) | ((v >>  8) & 0x00000000ff000000ull) |
+                        ((v <<  8) & 0x000000ff00000000ull) | ((v << 24) & 0x0000ff0000000000ull) |
+                        ((v << 40) & 0x00ff000000000000ull) | ((v << 56) & 0xff00000000000000ull);
+                    memcpy(_it,&v,8);
+                }
+                break;
+        };
+}
+
 enum PglByteOrder {
     PglBigEndian,
     PglLittleEndian
@@ -280,6 +317,21 @@ void write( const char * data, size_t size )
 {
         __stream.write(data,size);
 }
+
+/** Binary write of \e nb contiguous values of \e size bytes each.
+    The byte order is converted in a single pass over the block. */
+fostream& writeBlock( const char * data, size_t size, size_t nb )
+{
+    if (size > 1 && _mustFlip()) {
+        std::vector<char> flipped_data(data,data+size*nb);
+        flipBlock(&flipped_data[0],size,nb);
+        __stream.write(&flipped_data[0],size*nb);
+    }
+    else {
+        __stream.write(data,size*nb);
+    }
+    return *this;
+}
 //@}
 
 /** @name Stream
@@ -322,13 +374,18 @@ bool getByteOrder() const {
 
 private:
 
-virtual fostream& _writeBytes( const char * data, size_t size )
+bool _mustFlip( ) const
 {
 #if __BYTE_ORDER == __BIG_ENDIAN
-    if (__order == PglLittleEndian)
+    return __order == PglLittleEndian;
 #else
-    if (__order == PglBigEndian)        
+    return __order == PglBigEndian;
 #endif
+}
+
+virtual fostream& _writeBytes( const char * data, size_t size )
+{
+    if (_mustFlip())
     {
         char flipped_data[8];
         flipBytes(data,flipped_data,size);
@@ -520,6 +577,15 @@ void read( char * data, size_t size )
         __stream.read(data,size);
 }
 
+/** Binary read of \e nb contiguous values of \e size bytes each.
+    The byte order is converted in place in a single pass over the block. */
+fistream& readBlock( char * data, size_t size, size_t nb )
+{
+    __stream.read(data,size*nb);
+    if (size > 1 && _mustFlip()) flipBlock(data,size,nb);
+    return *this;
+}
+
 //@}
 
 /** @name Stream
@@ -563,13 +629,18 @@ bool getByteOrder() const {
 
 private:
 
-virtual fistream& _readBytes( char * data, size_t size )
+bool _mustFlip( ) const
 {
 #if __BYTE_ORDER == __BIG_ENDIAN
-    if (__order == PglLittleEndian)
+    return __order == PglLittleEndian;
 #else
-    if (__order == PglBigEndian)        
+    return __order == PglBigEndian;
 #endif
+}
+
+virtual fistream& _readBytes( char * data, size_t size )
+{
+    if (_mustFlip())
     {
         char flipped_data[8];
         __stream.read(flipped_data,size);
@@ -54,6 +54,9 @@
 #include <vector>
 #include <algorithm>
 #include <iostream>
+#include <memory>
+#include <atomic>
+#include <mutex>
 
 #include "rcobject.h"
 #include "tools_config.h"
@@ -94,6 +97,319 @@ bool isUnique(Iterator beg, Iterator end ) {
         return true;
 }
 
+/** Returns \e a as a constant reference. Reading an array through it does
+    not give a shared array its own copy of its elements. */
+template<class T>
+inline const T& const_array( const T& a ) { return a; }
+
+/* ----------------------------------------------------------------------- */
+
+/// Returns the mutex that serializes between threads the copies of the buffer of the PglSharedVector \e vector.
+TOOLS_API std::mutex& sharedVectorMutex( const void * vector );
+
+/** Returns a new modification stamp. Stamps are taken from a counter shared by
+    the containers and the scene objects, so that a new stamp is greater than
+    all the previous ones. */
+TOOLS_API size_t nextModificationStamp( );
+
+/**
+   \class ModificationStamp
+   \brief The modification stamp of a container.
+
+   The non const accessors of the container call touch(), which only resets the
+   stamp. A new stamp is taken the next time it is read, so that repeated
+   writes do not all access the shared counter. A copy gets its own stamp.
+ */
+class ModificationStamp
+{
+public:
+
+ModificationStamp( ) : __stamp(0) { }
+
+ModificationStamp( const ModificationStamp& ) : __stamp(0) { }
+
+ModificationStamp& operator=( const ModificationStamp& ) {
+        touch();
+        return *this;
+}
+
+/// Marks the container as modified.
+inline void touch( ) {
+        if (__stamp.load(std::memory_order_relaxed) != 0) __stamp.store(0, std::memory_order_relaxed);
+}
+
+/// Returns the stamp of the container, that changes each time it is modified.
+inline size_t get( ) const {
+        size_t stamp = __stamp.load(std::memory_order_relaxed);
+        if (stamp != 0) return stamp;
+        size_t newstamp = nextModificationStamp();
+        // another thread may have given a stamp in the meantime.
+        if (__stamp.compare_exchange_strong(stamp, newstamp, std::memory_order_relaxed)) return newstamp;
+        return stamp;
+}
+
+protected:
+
+mutable std::atomic<size_t> __stamp;
+
+};
+
+/**
+   \class PglSharedVector
+   \brief A std::vector whose elements are shared by its copies until one of them is modified.
+
+   Copies share the same buffer. Non const accessors first give \e self its own
+   copy of the buffer if it is shared. Iterators and references obtained from
+   non const accessors should thus not be kept across a copy of \e self.
+   A vector that is not shareable, for instance because its buffer is exposed
+   to another library, is copied immediately.
+
+   Several threads can access \e self at the same time, with const or non const
+   accessors that do not change its size: the buffer is copied once, by the
+   first of them. Copies and changes of size should not be concurrent with
+   other accesses.
+
+   A view on the elements can keep the buffer alive with getBuffer(). Writes
+   through the view and through \e self are then seen by both, until a change
+   of size of \e self, which gives \e self a new buffer and leaves the view on
+   the previous one.
+
+   Non const accessors also mark \e self as modified (see getModificationStamp()).
+   Writes through a view are not seen, the view is considered as a modification
+   when it is created.
+ */
+
+/* ----------------------------------------------------------------------- */
+
+template <class T>
+class PglSharedVector
+{
+
+public:
+
+typedef std::vector<T> vector_type;
+typedef typename vector_type::value_type value_type;
+typedef typename vector_type::size_type size_type;
+typedef typename vector_type::reference reference;
+typedef typename vector_type::const_reference const_reference;
+typedef typename vector_type::const_reverse_iterator const_reverse_iterator;
+typedef typename vector_type::reverse_iterator reverse_iterator;
+typedef typename vector_type::const_iterator const_iterator;
+typedef typename vector_type::iterator iterator;
+
+PglSharedVector( size_t size = 0 ) :
+        __data(std::make_shared<vector_type>(size)),
+        __elements(__data.get()),
+        __owned(true),
+        __shareable(true) {
+}
+
+PglSharedVector( size_t size, const T& t ) :
+        __data(std::make_shared<vector_type>(size,t)),
+        __elements(__data.get()),
+        __owned(true),
+        __shareable(true) {
+}
+
+template <class InIterator>
+PglSharedVector( InIterator begin, InIterator end ) :
+        __data(std::make_shared<vector_type>(begin,end)),
+        __elements(__data.get()),
+        __owned(true),
+        __shareable(true) {
+}
+
+PglSharedVector( const PglSharedVector& v ) :
+        __data(v.__shareable ? v.__data : std::make_shared<vector_type>(*v.elements())),
+        __elements(__data.get()),
+        __owned(!v.__shareable),
+        __shareable(true) {
+        if (v.__shareable) v.__owned = false;
+}
+
+PglSharedVector& operator=( const PglSharedVector& v ) {
+        if (__data == v.__data) return *this;
+        if (v.__shareable && __shareable) {
+            __stamp.touch();
+            __data = v.__data;
+            __elements.store(__data.get(), std::memory_order_release);
+            __owned = false;
+            v.__owned = false;
+        }
+        else assign(v.begin(),v.end());
+        return *this;
+}
+
+PglSharedVector& operator=( const vector_type& v ) {
+        assign(v.begin(),v.end());
+        return *this;
+}
+
+/// Returns whether the buffer of \e self is shared with other vectors.
+/// The buffer of a vector that is not shareable is only referenced by views on its elements.
+inline bool isShared( ) const {
+        return __shareable && __data.use_count() > 1;
+}
+
+/// Returns an identifier of the buffer of \e self, common to all the vectors that share it.
+inline const void * getBufferId( ) const {
+        return elements();
+}
+
+/// Returns the modification stamp of \e self, that changes each time it is modified.
+inline size_t getModificationStamp( ) const {
+        return __stamp.get();
+}
+
+/// Marks \e self as modified.
+inline void touch( ) {
+        __stamp.touch();
+}
+
+/// Returns whether copies of \e self share its buffer.
+inline bool isShareable( ) const {
+        return __shareable;
+}
+
+/// Set whether copies of \e self share its buffer. A buffer that is not shareable is first detached.
+void setShareable( bool shareable ) {
+        if (!shareable) detach();
+        __shareable = shareable;
+}
+
+/// Returns the buffer of \e self, for a view on its elements that keeps it alive. \e self is made not shareable.
+std::shared_ptr<vector_type> getBuffer( ) {
+        setShareable(false);
+        touch();
+        return __data;
+}
+
+/// Gives \e self its own copy of its buffer if it is shared.
+inline void detach( ) {
+        if (!__owned.load(std::memory_order_acquire)) detachShared();
+}
+
+/// Gives \e self its own copy of its buffer if it is shared or viewed, before a change of size that may move the elements.
+inline void detachBuffer( ) {
+        if (__data.use_count() > 1) resetBuffer(std::make_shared<vector_type>(*__data));
+        else detach();
+}
+
+inline const_iterator begin( ) const { return elements()->begin(); }
+inline const_iterator end( ) const { return elements()->end(); }
+inline const_iterator cbegin( ) const { return elements()->cbegin(); }
+inline const_iterator cend( ) const { return elements()->cend(); }
+inline const_reverse_iterator rbegin( ) const { return elements()->rbegin(); }
+inline const_reverse_iterator rend( ) const { return elements()->rend(); }
+inline const_reference operator[]( size_type i ) const { return (*elements())[i]; }
+inline const_reference front( ) const { return elements()->front(); }
+inline const_reference back( ) const { return elements()->back(); }
+inline size_type size( ) const { return elements()->size(); }
+inline size_type capacity( ) const { return elements()->capacity(); }
+inline bool empty( ) const { return elements()->empty(); }
+
+inline iterator begin( ) { detachForWrite(); return elements()->begin(); }
+inline iterator end( ) { detachForWrite(); return elements()->end(); }
+inline reverse_iterator rbegin( ) { detachForWrite(); return elements()->rbegin(); }
+inline reverse_iterator rend( ) { detachForWrite(); return elements()->rend(); }
+inline reference operator[]( size_type i ) { detachForWrite(); return (*elements())[i]; }
+inline reference front( ) { detachForWrite(); return elements()->front(); }
+inline reference back( ) { detachForWrite(); return elements()->back(); }
+
+iterator insert( const_iterator it, const T& t ) {
+        size_type pos = it - cbegin();
+        detachBuffer(); touch();
+        return __data->insert(__data->begin() + pos, t);
+}
+
+template <class InputIterator>
+iterator insert( const_iterator it, InputIterator f, InputIterator l ) {
+        size_type pos = it - cbegin();
+        detachBuffer(); touch();
+        return __data->insert(__data->begin() + pos, f, l);
+}
+
+iterator erase( const_iterator it ) {
+        size_type pos = it - cbegin();
+        detachBuffer(); touch();
+        return __data->erase(__data->begin() + pos);
+}
+
+iterator erase( const_iterator f, const_iterator l ) {
+        size_type pos = f - cbegin(), n = l - f;
+        detachBuffer(); touch();
+        return __data->erase(__data->begin() + pos, __data->begin() + pos + n);
+}
+
+template <class InputIterator>
+void assign( InputIterator f, InputIterator l ) {
+        touch();
+        if (__data.use_count() > 1) resetBuffer(std::make_shared<vector_type>(f,l));
+        else { detach(); __data->assign(f,l); }
+}
+
+void push_back( const T& t ) { detachBuffer(); touch(); __data->push_back(t); }
+void pop_back( ) { detachBuffer(); touch(); __data->pop_back(); }
+void resize( size_type size ) { detachBuffer(); touch(); __data->resize(size); }
+void resize( size_type size, const T& t ) { detachBuffer(); touch(); __data->resize(size,t); }
+void reserve( size_type size ) { detachBuffer(); __data->reserve(size); }
+
+void clear( ) {
+        touch();
+        if (__data.use_count() > 1) resetBuffer(std::make_shared<vector_type>());
+        else { detach(); __data->clear(); }
+}
+
+protected:
+
+inline vector_type * elements( ) const {
+        return __elements.load(std::memory_order_acquire);
+}
+
+/// Detaches the buffer before a write through a non const accessor.
+inline void detachForWrite( ) {
+        detach();
+        touch();
+}
+
+/// Replaces the buffer of \e self by \e data, that is not shared.
+void resetBuffer( const std::shared_ptr<vector_type>& data ) {
+        __data = data;
+        __elements.store(__data.get(), std::memory_order_release);
+        __owned.store(true, std::memory_order_release);
+}
+
+/// Copies the buffer if it is still shared. The threads that access \e self at the same time wait for the copy.
+void detachShared( ) {
+        std::lock_guard<std::mutex> lock(sharedVectorMutex(this));
+        if (__owned.load(std::memory_order_relaxed)) return;
+        if (isShared()) {
+            std::shared_ptr<vector_type> data = std::make_shared<vector_type>(*__data);
+            __elements.store(data.get(), std::memory_order_release);
+            __data.swap(data);
+        }
+        // makes the reads of the copies that released the buffer happen before the next writes.
+        else std::atomic_thread_fence(std::memory_order_acquire);
+        __owned.store(true, std::memory_order_release);
+}
+
+/// The buffer, shared with the copies of \e self.
+std::shared_ptr<vector_type> __data;
+
+/// The buffer read and written by the accessors, that other threads can load while \e __data is replaced.
+std::atomic<vector_type *> __elements;
+
+/// Whether no copy of \e self has shared its buffer since its last detach.
+mutable std::atomic<bool> __owned;
+
+/// Whether copies of \e self share its buffer.
+bool __shareable;
+
+/// The modification stamp of \e self.
+ModificationStamp __stamp;
+
+};
+
 /* ----------------------------------------------------------------------- */
 
 /**
@@ -104,7 +420,7 @@ bool isUnique(Iterator beg, Iterator end ) {
 
 /* ----------------------------------------------------------------------- */
 
-template <class T>
+template <class T, class Container = std::vector<T> >
 class PglVector
 {
 
@@ -114,16 +430,16 @@ public:
 typedef T element_type;
 
 /// A const iterator used to iterate through an Array1.
-typedef typename std::vector<element_type>::const_reverse_iterator const_reverse_iterator;
+typedef typename Container::const_reverse_iterator const_reverse_iterator;
 
 /// An iterator used to iterate through an Array1.
-typedef typename std::vector<element_type>::reverse_iterator reverse_iterator;
+typedef typename Container::reverse_iterator reverse_iterator;
 
 /// A const iterator used to iterate through an Array1.
-typedef typename std::vector<element_type>::const_iterator const_iterator;
+typedef typename Container::const_iterator const_iterator;
 
 /// An iterator used to iterate through an Array1.
-typedef typename std::vector<element_type>::iterator iterator;
+typedef typename Container::iterator iterator;
 
 //   /// The element type.
 //   typedef T element_type;
@@ -222,6 +538,11 @@ inline uint_t size( ) const {
         return __A.size();
 }
 
+/// Returns the number of elements \e self can hold without reallocation.
+inline size_t capacity( ) const {
+        return __A.capacity();
+}
+
 /// Clear \e self.
 inline void clear( ) {
         __A.clear();
@@ -285,7 +606,7 @@ std::ostream& print( std::ostream& stream,
 }
 
 /// Prints \e self to the output stream \e stream.
-friend std::ostream& operator<<(std::ostream& stream, const PglVector<T>& a){
+friend std::ostream& operator<<(std::ostream& stream, const PglVector<T,Container>& a){
         return a.print(stream);
 }
 
@@ -384,26 +705,31 @@ inline attribute_deprecated iterator Erase(iterator first,iterator last) {
 protected:
 
 /// The elements contained by \e self.
-std::vector<T> __A;
+Container __A;
 
 };
 
 /* ----------------------------------------------------------------------- */
 
+/**
+   The elements of an Array1 are shared by its copies until one of them is
+   modified (see PglSharedVector). Copying an array, as done by a DeepCopier,
+   is thus cheap, and only the arrays that are modified afterwards are duplicated.
+*/
 template <class T>
-class Array1 : public RefCountObject, public PglVector<T>
+class Array1 : public RefCountObject, public PglVector<T, PglSharedVector<T> >
 {
 public:
 /// Constructs an Array1 of size \e size
 Array1( size_t size = 0 ) :
         RefCountObject(),
-        PglVector<T>(size) {
+        PglVector<T, PglSharedVector<T> >(size) {
 }
 
 /// Constructs an Array1 with \e size copies of \e t.
 Array1( size_t size, const T& t ) :
         RefCountObject(),
-        PglVector<T>(size,t) {
+        PglVector<T, PglSharedVector<T> >(size,t) {
 }
 
 
@@ -411,14 +737,50 @@ Array1( size_t size, const T& t ) :
 template <class InIterator>
 Array1( InIterator begin, InIterator end ) :
         RefCountObject(),
-        PglVector<T>(begin,end) {
+        PglVector<T, PglSharedVector<T> >(begin,end) {
 }
 
 /// Inserts \e t into \e self before the position pointed by \e it.
 Array1& operator+=( const Array1& t ) {
-        PglVector<T>::__A.insert(PglVector<T>::end(),t.begin(),t.end());
+        this->__A.insert(this->__A.end(),t.begin(),t.end());
         return *this;
 }
+
+/// Returns whether the elements of \e self are shared with a copy of \e self.
+inline bool isShared( ) const {
+        return this->__A.isShared();
+}
+
+/** Set whether the copies of \e self share its elements until they are modified, which is the default.
+    A buffer exposed to another library should not be shared. */
+inline void setShareable( bool shareable ) {
+        this->__A.setShareable(shareable);
+}
+
+/// Returns the number of bytes allocated for the elements of \e self.
+inline size_t getMemorySize( ) const {
+        return this->__A.capacity() * sizeof(T);
+}
+
+/// Returns an identifier of the elements of \e self, common to the copies of \e self that share them.
+inline const void * getBufferId( ) const {
+        return this->__A.getBufferId();
+}
+
+/// Returns the modification stamp of \e self, that changes each time its elements are modified.
+inline size_t getModificationStamp( ) const {
+        return this->__A.getModificationStamp();
+}
+
+/// Marks \e self as modified, for instance after writes through a view on its elements.
+inline void touch( ) {
+        this->__A.touch();
+}
+
+/// Returns the buffer of the elements of \e self, for a view on them that keeps it alive (see PglSharedVector::getBuffer()).
+inline std::shared_ptr<std::vector<T> > getBuffer( ) {
+        return this->__A.getBuffer();
+}
 };
 
 PGL_END_NAMESPACE
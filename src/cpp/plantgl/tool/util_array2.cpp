@@ -48,6 +48,21 @@ PGL_USING_NAMESPACE
 
 /* ----------------------------------------------------------------------- */
 
+std::mutex& PGL(sharedVectorMutex)( const void * vector )
+{
+  // vectors whose addresses fall in the same slot share a mutex.
+  static std::mutex mutexes[64];
+  return mutexes[(size_t(vector) >> 4) % 64];
+}
+
+size_t PGL(nextModificationStamp)( )
+{
+  static std::atomic<size_t> STAMP(0);
+  return ++STAMP;
+}
+
+/* ----------------------------------------------------------------------- */
+
 /// Constructs an Array1 of size \e size
 RealArray::RealArray( uint_t size  ) :
     NumericArray1<real_t>( size ) {
@@ -53,6 +53,7 @@
 
 #include "rcobject.h"
 #include "classinfo.h"
+#include "util_array.h"
 
 #include <vector>
 #include <algorithm>
@@ -116,6 +117,7 @@ public:
 
   /// assignement operator.
   Array2<T>& operator=(const Array2<T>& m){
+    __stamp.touch();
     __A = std::vector<T>(m.__A);
     __rowSize = m.getRowSize();
     return *this;
@@ -123,6 +125,7 @@ public:
 
   /// Changes the matrix dimensions.
   virtual void resize(const uint_t nr, const uint_t nc){
+      __stamp.touch();
       __A = std::vector<T> (nr * nc);
       __rowSize = nc;
   }
@@ -130,6 +133,7 @@ public:
   /// Changes the matrix dimensions.
   virtual void reshape(const uint_t nr, const uint_t nc){
       assert(__A.size() == nr*nc);
+      __stamp.touch();
       __rowSize = nc;
   }
 
@@ -153,6 +157,7 @@ public:
       - \e c must be strictly less than the number of columns of \e self. */
   inline T& getAt( uint_t r, uint_t c ) {
     GEOM_ASSERT(__A.size() !=0 && r < getRowNb() && c < getColumnNb() );
+    __stamp.touch();
     return __A[(r*getRowSize())+c];
   }
 
@@ -187,8 +192,17 @@ public:
   /// Returns whether \e self is empty.
   inline bool empty( ) const { return __A.empty(); }
 
+  /// Returns the modification stamp of \e self, that changes each time it is modified.
+  inline size_t getModificationStamp( ) const { return __stamp.get(); }
+
+  /// Marks \e self as modified.
+  inline void touch( ) { __stamp.touch(); }
+
+  /// Returns the number of bytes allocated for the elements of \e self.
+  inline size_t getMemorySize( ) const { return __A.capacity() * sizeof(T); }
+
   /// Clear \e self.
-  inline void clear( ) { __A.clear(); __rowSize = 0; }
+  inline void clear( ) { __stamp.touch(); __A.clear(); __rowSize = 0; }
 
   /// data
   inline const T * data( ) const { return __A.data(); }
@@ -197,13 +211,13 @@ public:
   inline const_iterator begin( ) const { return __A.begin(); }
 
   /// Returns an iterator at the beginning of \e self.
-  inline iterator begin( ) { return __A.begin(); }
+  inline iterator begin( ) { __stamp.touch(); return __A.begin(); }
 
   /// Returns a const iterator at the end of \e self.
   inline const_iterator end( ) const { return __A.end(); }
 
   /// Returns a const iterator at the end of \e self.
-  inline iterator end( ) { return __A.end(); }
+  inline iterator end( ) { __stamp.touch(); return __A.end(); }
 
   /// Returns a const iterator at the beginning of the row \e row of\e self.
   inline const_iterator beginRow(uint_t row ) const {
@@ -212,6 +226,7 @@ public:
 
   /// Returns an iterator at the beginning of \e self.
   inline iterator beginRow(uint_t row ) {
+      __stamp.touch();
       return (__A.begin()+(row*getRowSize()));
   }
 
@@ -222,6 +237,7 @@ public:
 
   /// Returns a const iterator at the end of \e self.
   inline iterator endRow( uint_t row ) {
+      __stamp.touch();
       return (__A.begin()+((row+1)*getRowSize()));
   }
 
@@ -256,6 +272,7 @@ public:
       GEOM_ASSERT( j <= getRowNb());
       size_t nrsize = distance(begin,end);
       GEOM_ASSERT((j == 0 && __rowSize == 0) || (nrsize == getRowSize()));
+      __stamp.touch();
       iterator _pos;
       if(!__rowSize) { _pos = __A.begin(); __rowSize = nrsize; }
       else _pos = beginRow(j);
@@ -272,6 +289,7 @@ public:
   inline void insertColumn( uint_t i, InIterator begin, InIterator end) {
       GEOM_ASSERT(  (i == 0 && getRowSize() == 0) || (i  <= getColumnNb()) );
       GEOM_ASSERT(  getColumnSize() == 0 || distance(begin,end) ==  getColumnSize());
+      __stamp.touch();
       if (__rowSize == 0) {
           __A.insert(__A.begin(),begin,end);
           __rowSize = 1;
@@ -289,6 +307,7 @@ public:
   template <class InIterator>
   inline void pushRow(InIterator begin, InIterator end ){
     GEOM_ASSERT( __rowSize == 0 || distance(begin,end) == getRowSize() );
+    __stamp.touch();
     __A.insert(__A.end(),begin,end);
     if (__rowSize == 0) __rowSize = __A.size();
    }
@@ -326,6 +345,7 @@ public:
       - \e c must be strictly less than the number of columns of \e self. */
   void setAt( uint_t r, uint_t c, const T& t ) {
       GEOM_ASSERT(r < getRowNb() && c < getColumnNb() );
+      __stamp.touch();
       __A[((r*getRowSize())+c)] = t;
   }
 
@@ -426,6 +446,9 @@ protected:
 
   /// The number of row of \e self.
   uint_t __rowSize;
+
+  /// The modification stamp of \e self.
+  ModificationStamp __stamp;
 };
 
 
@@ -544,6 +567,7 @@ public:
   NumericArray2<T>& operator+=(const NumericArray2<T>&a){
       GEOM_ASSERT(a.getRowSize()!=getRowSize() && a.size()!=getSize());
       typename NumericArray2<T>::const_iterator _i1 = a.begin();
+      this->__stamp.touch();
       for(typename std::vector<T>::iterator  _i2 = this->__A.begin();
           _i2 != this->__A.end();
           _i2++){
@@ -563,6 +587,7 @@ public:
   NumericArray2<T>& operator-=(const NumericArray2<T>& a){
       GEOM_ASSERT(a.getRowSize()!=getRowSize() && a.size()!=getSize());
       typename NumericArray2<T>::const_iterator _i1 = a.begin();
+      this->__stamp.touch();
       for(typename std::vector<T>::iterator  _i2 = this->__A.begin();
           _i2 != this->__A.end(); _i2++){
           *_i2 -= *_i1;
@@ -580,6 +605,7 @@ public:
 
   /// Addition of a matrix and a value.
   NumericArray2<T>& operator+=(T val){
+      this->__stamp.touch();
       for(typename std::vector<T>::iterator  _i2 = this->__A.begin();
           _i2 != this->__A.end(); _i2++){
           *_i2 -= val;
@@ -597,6 +623,7 @@ public:
 
   /// Subtraction of a matrix and a value.
   NumericArray2<T>& operator -= ( T val ){
+      this->__stamp.touch();
       for(typename std::vector<T>::iterator  _i2 = this->__A.begin();
           _i2 != this->__A.end(); _i2++){
           *_i2 -= val;
@@ -612,6 +639,7 @@ public:
 
   /// Multiplication of a matrix and a value.
   NumericArray2<T>& operator *= (T val){
+      this->__stamp.touch();
       for(typename std::vector<T>::iterator  _i2 = this->__A.begin();
           _i2 != this->__A.end(); _i2++){
           *_i2 *= val;
@@ -627,6 +655,7 @@ public:
 
   /// Division of a matrix and a value.
   NumericArray2<T>& operator /= (T val){
+      this->__stamp.touch();
       for(typename std::vector<T>::iterator  _i2 = this->__A.begin();
           _i2 != this->__A.end(); _i2++){
           *_i2 /= val;
@@ -0,0 +1,143 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "util_cache.h"
+#include <map>
+#include <set>
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+std::atomic<size_t> CacheBudget::__totalcost(0);
+std::atomic<size_t> CacheBudget::__softlimit(std::numeric_limits<size_t>::max());
+std::atomic<size_t> CacheBudget::__trimrequests(0);
+
+// The accounts are never deleted, so that static caches can still be cleared at exit.
+typedef std::map<std::string, CacheBudget::Account *> CacheAccountMap;
+
+static CacheAccountMap& cacheAccounts()
+{
+  static CacheAccountMap * accounts = new CacheAccountMap();
+  return *accounts;
+}
+
+static std::mutex& cacheAccountsMutex()
+{
+  static std::mutex * mutex = new std::mutex();
+  return *mutex;
+}
+
+CacheBudget::Account * CacheBudget::getAccount(const std::string& name)
+{
+  std::lock_guard<std::mutex> lock(cacheAccountsMutex());
+  CacheAccountMap::iterator it = cacheAccounts().find(name);
+  if (it != cacheAccounts().end()) return it->second;
+  Account * account = new Account(name);
+  cacheAccounts()[name] = account;
+  return account;
+}
+
+CacheBudget::Account * CacheBudget::getDefaultAccount()
+{
+  static Account * account = getAccount("LRUCache");
+  return account;
+}
+
+std::vector<CacheBudget::AccountStatistics> CacheBudget::statistics()
+{
+  std::vector<AccountStatistics> result;
+  std::lock_guard<std::mutex> lock(cacheAccountsMutex());
+  for (CacheAccountMap::const_iterator it = cacheAccounts().begin(); it != cacheAccounts().end(); ++it) {
+    AccountStatistics stat = { it->first, it->second->entries.load(), it->second->cost.load(), it->second->evictions.load() };
+    result.push_back(stat);
+  }
+  return result;
+}
+
+void CacheBudget::setSoftLimit(size_t limit)
+{
+  __softlimit = limit;
+}
+
+size_t CacheBudget::getSoftLimit()
+{
+  return __softlimit.load();
+}
+
+// The registered caches. Like the accounts, never deleted for the static caches destroyed at exit.
+typedef std::set<CacheBudget::Trimmable *> TrimmableCacheSet;
+
+static TrimmableCacheSet& registeredCaches()
+{
+  static TrimmableCacheSet * caches = new TrimmableCacheSet();
+  return *caches;
+}
+
+static std::mutex& registeredCachesMutex()
+{
+  static std::mutex * mutex = new std::mutex();
+  return *mutex;
+}
+
+void CacheBudget::registerCache(Trimmable * cache)
+{
+  std::lock_guard<std::mutex> lock(registeredCachesMutex());
+  registeredCaches().insert(cache);
+}
+
+void CacheBudget::unregisterCache(Trimmable * cache)
+{
+  std::lock_guard<std::mutex> lock(registeredCachesMutex());
+  registeredCaches().erase(cache);
+}
+
+void CacheBudget::trim()
+{
+  ++__trimrequests;
+  // a cache is unregistered under the same lock before it is destroyed.
+  std::lock_guard<std::mutex> lock(registeredCachesMutex());
+  for (TrimmableCacheSet::const_iterator it = registeredCaches().begin(); it != registeredCaches().end(); ++it) {
+    if (!isOverSoftLimit()) break;
+    (*it)->trim();
+  }
+}
+
+/* ----------------------------------------------------------------------- */
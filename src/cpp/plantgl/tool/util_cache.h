@@ -49,7 +49,14 @@
 
 /* ----------------------------------------------------------------------- */
 
+#include "tools_config.h"
 #include "util_hashmap.h"
+#include <atomic>
+#include <list>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
 
 /* ----------------------------------------------------------------------- */
 
@@ -141,6 +148,413 @@ protected:
 
 
 
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class CacheBudget
+   \brief The memory held by all the LRUCaches, with an optional soft limit.
+
+   Each LRUCache reports the number and the cost, in bytes, of its entries to
+   the account of its kind of cache (for instance "Discretizer"). When the
+   total cost of all the caches exceeds the soft limit, a cache that inserts
+   an entry first evicts its own least recently used entries. Caches are thus
+   trimmed by the threads that use them, the next time they are filled.
+   trim() asks all the caches to evict their least recently used entries until
+   the total cost is under the soft limit. The ConcurrentLRUCaches are trimmed
+   at once. An LRUCache is used by a single thread, so it is trimmed the next
+   time it is looked up or filled.
+
+   Accounts are looked up by name under a lock. Caches that are constructed
+   often resolve their account once, for instance in a function-local static.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class TOOLS_API CacheBudget {
+public:
+
+  struct Account {
+    Account( const std::string& _name ) :
+      name(_name), entries(0), cost(0), evictions(0) {}
+
+    const std::string name;
+    std::atomic<size_t> entries;
+    std::atomic<size_t> cost;
+    std::atomic<size_t> evictions;
+  };
+
+  struct AccountStatistics {
+    std::string name;
+    size_t entries;
+    size_t cost;
+    size_t evictions;
+  };
+
+  /// A cache that can be trimmed from any thread. See registerCache.
+  class TOOLS_API Trimmable {
+  public:
+    virtual ~Trimmable( ) {}
+    virtual void trim( ) = 0;
+  };
+
+  /// Returns the account of the caches called \e name. Accounts are never deleted.
+  static Account * getAccount( const std::string& name );
+
+  /// Returns the account called "LRUCache", used by the caches constructed without account.
+  static Account * getDefaultAccount( );
+
+  /// Returns the content of the accounts, sorted by name.
+  static std::vector<AccountStatistics> statistics( );
+
+  /// Returns the total cost of the entries of all the caches.
+  static inline size_t getTotalCost( ) { return __totalcost.load(std::memory_order_relaxed); }
+
+  /// Sets the soft limit of the total cost of the caches. No limit by default.
+  static void setSoftLimit( size_t limit );
+  static size_t getSoftLimit( );
+
+  /** Evicts the least recently used entries of the caches until the total cost
+      is under the soft limit. The registered caches are trimmed at once, the
+      other ones the next time they are looked up or filled. */
+  static void trim( );
+
+  /// Returns the number of calls to trim(), with which the caches check for a pending request.
+  static inline size_t getTrimRequests( ) { return __trimrequests.load(std::memory_order_relaxed); }
+
+  /** Registers \e cache to be trimmed by trim() from any thread.
+      \e cache must be unregistered before it is destroyed. */
+  static void registerCache( Trimmable * cache );
+  static void unregisterCache( Trimmable * cache );
+
+  static inline bool isOverSoftLimit( ) {
+    return __totalcost.load(std::memory_order_relaxed) > __softlimit.load(std::memory_order_relaxed);
+  }
+
+  static inline void add( Account * account, size_t entries, size_t cost ) {
+    account->entries += entries;
+    account->cost += cost;
+    __totalcost += cost;
+  }
+
+  static inline void remove( Account * account, size_t entries, size_t cost ) {
+    account->entries -= entries;
+    account->cost -= cost;
+    __totalcost -= cost;
+  }
+
+protected:
+  static std::atomic<size_t> __totalcost;
+  static std::atomic<size_t> __softlimit;
+  static std::atomic<size_t> __trimrequests;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class LRUCache
+   \brief A cache with a budget and a least recently used eviction policy.
+
+   Each entry is stored with the modification stamp of the object it was
+   computed from and a cost (for instance its size in bytes). An entry whose
+   stamp differs from the one given at lookup is stale and is discarded.
+   When the total cost exceeds the budget, the least recently used entries
+   are evicted, or when the CacheBudget of all the caches exceeds its soft
+   limit. In the latter case, only the entries of the cache that inserts are
+   evicted. A trim requested by CacheBudget::trim() is done at the next
+   lookup or insertion.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+template <class T>
+class LRUCache {
+
+public:
+
+  struct Entry {
+    size_t id;
+    size_t stamp;
+    size_t cost;
+    T value;
+  };
+
+  typedef std::list<Entry> listtype;
+  typedef typename pgl_hash_map<size_t,typename listtype::iterator> maptype;
+
+  /** Constructs an empty LRUCache with a budget of \e maxcost.
+      Its entries are reported to the CacheBudget \e account. */
+  LRUCache( size_t maxcost = std::numeric_limits<size_t>::max(),
+            CacheBudget::Account * account = CacheBudget::getDefaultAccount() ) :
+    __entries(), __index(), __cost(0), __maxcost(maxcost),
+    __hits(0), __misses(0), __stales(0), __evictions(0),
+    __account(account), __trimrequests(CacheBudget::getTrimRequests()) {
+  }
+
+  /** Constructs an empty LRUCache with a budget of \e maxcost.
+      Its entries are reported to the CacheBudget account called \e account. */
+  LRUCache( size_t maxcost, const std::string& account ) :
+    __entries(), __index(), __cost(0), __maxcost(maxcost),
+    __hits(0), __misses(0), __stales(0), __evictions(0),
+    __account(CacheBudget::getAccount(account)), __trimrequests(CacheBudget::getTrimRequests()) {
+  }
+
+  LRUCache( const LRUCache& cache ) :
+    __entries(cache.__entries), __index(), __cost(cache.__cost), __maxcost(cache.__maxcost),
+    __hits(cache.__hits), __misses(cache.__misses), __stales(cache.__stales), __evictions(cache.__evictions),
+    __account(cache.__account), __trimrequests(cache.__trimrequests) {
+    reindex();
+    CacheBudget::add(__account, __entries.size(), __cost);
+  }
+
+  LRUCache& operator=( const LRUCache& cache ) {
+    if (this == &cache) return *this;
+    clear();
+    __entries = cache.__entries;
+    __cost = cache.__cost;
+    __maxcost = cache.__maxcost;
+    __account = cache.__account;
+    reindex();
+    CacheBudget::add(__account, __entries.size(), __cost);
+    return *this;
+  }
+
+  /// Destructor.
+  ~LRUCache( ) {
+    clear();
+  }
+
+  /// Clears the cache. Statistics are kept.
+  inline void clear( ) {
+    CacheBudget::remove(__account, __entries.size(), __cost);
+    __entries.clear();
+    __index.clear();
+    __cost = 0;
+  }
+
+  /** Looks for the value associated to the object identified with \e id.
+      Returns false if it is not found or if it was computed for another
+      modification \e stamp of the object. */
+  bool find( size_t id, size_t stamp, T& value ) {
+    if (__trimrequests != CacheBudget::getTrimRequests()) trim();
+    typename maptype::iterator _it = __index.find(id);
+    if (_it == __index.end()) { ++__misses; return false; }
+    if (_it->second->stamp != stamp) {
+      ++__misses; ++__stales;
+      erase(_it);
+      return false;
+    }
+    // move the entry at the front of the list
+    __entries.splice(__entries.begin(), __entries, _it->second);
+    value = _it->second->value;
+    ++__hits;
+    return true;
+  }
+
+  /** Inserts into \e self the element \e t associated to the object
+      identified with \e id at modification \e stamp. If the CacheBudget is
+      over its soft limit, the least recently used entries of \e self are
+      evicted, but not the new one. */
+  void insert( size_t id, size_t stamp, const T& t, size_t cost = 1 ) {
+    if (__trimrequests != CacheBudget::getTrimRequests()) trim();
+    remove(id);
+    if (cost > __maxcost) return;
+    Entry entry = { id, stamp, cost, t };
+    __entries.push_front(entry);
+    __index[id] = __entries.begin();
+    __cost += cost;
+    CacheBudget::add(__account, 1, cost);
+    evict(__maxcost);
+    // the new entry is kept, even if the other caches exceed the soft limit.
+    while (CacheBudget::isOverSoftLimit() && __entries.size() > 1) evictLast();
+  }
+
+  inline void remove( size_t id ) {
+    typename maptype::iterator _it = __index.find(id);
+    if(_it != __index.end()) erase(_it);
+  }
+
+  /// Returns whether \e self is empty.
+  inline bool isEmpty( ) const {
+    return __entries.empty();
+  }
+
+  /// Returns the number of entries.
+  inline size_t size( ) const {
+    return __entries.size();
+  }
+
+  /// Returns the total cost of the entries.
+  inline size_t getCost( ) const { return __cost; }
+
+  inline size_t getMaxCost( ) const { return __maxcost; }
+
+  /// Evicts the least recently used entries of \e self while the CacheBudget is over its soft limit.
+  void trim( ) {
+    __trimrequests = CacheBudget::getTrimRequests();
+    while (CacheBudget::isOverSoftLimit() && !__entries.empty()) evictLast();
+  }
+
+  /// Sets the budget of \e self and evicts the entries that exceed it.
+  inline void setMaxCost( size_t maxcost ) {
+    __maxcost = maxcost;
+    evict(__maxcost);
+  }
+
+  inline size_t getHits( ) const { return __hits; }
+  inline size_t getMisses( ) const { return __misses; }
+  inline size_t getStales( ) const { return __stales; }
+  inline size_t getEvictions( ) const { return __evictions; }
+
+  inline void resetStatistics( ) {
+    __hits = 0; __misses = 0; __stales = 0; __evictions = 0;
+  }
+
+  /// Returns the name of the CacheBudget account of \e self.
+  inline const std::string& getAccountName( ) const { return __account->name; }
+
+protected:
+
+  void erase( typename maptype::iterator _it ) {
+    __cost -= _it->second->cost;
+    CacheBudget::remove(__account, 1, _it->second->cost);
+    __entries.erase(_it->second);
+    __index.erase(_it);
+  }
+
+  void evict( size_t maxcost ) {
+    while (__cost > maxcost && !__entries.empty()) evictLast();
+  }
+
+  void evictLast( ) {
+    __cost -= __entries.back().cost;
+    CacheBudget::remove(__account, 1, __entries.back().cost);
+    __index.erase(__entries.back().id);
+    __entries.pop_back();
+    ++__evictions;
+    ++__account->evictions;
+  }
+
+  void reindex( ) {
+    __index.clear();
+    for (typename listtype::iterator _it = __entries.begin(); _it != __entries.end(); ++_it)
+      __index[_it->id] = _it;
+  }
+
+  /// The entries, from the most to the least recently used.
+  listtype __entries;
+  maptype __index;
+
+  size_t __cost;
+  size_t __maxcost;
+
+  size_t __hits;
+  size_t __misses;
+  size_t __stales;
+  size_t __evictions;
+
+  CacheBudget::Account * __account;
+
+  /// The number of trim requests of the CacheBudget at the last trim.
+  size_t __trimrequests;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class ConcurrentLRUCache
+   \brief A LRUCache that can be looked up and filled from several threads.
+   It is registered to the CacheBudget and trimmed at once by CacheBudget::trim().
+*/
+
+/* ----------------------------------------------------------------------- */
+
+template <class T>
+class ConcurrentLRUCache : public CacheBudget::Trimmable {
+
+public:
+
+  /// Constructs an empty ConcurrentLRUCache with a budget of \e maxcost. See LRUCache.
+  ConcurrentLRUCache( size_t maxcost = std::numeric_limits<size_t>::max(),
+                      CacheBudget::Account * account = CacheBudget::getDefaultAccount() ) :
+    __cache(maxcost, account), __mutex() {
+    CacheBudget::registerCache(this);
+  }
+
+  ConcurrentLRUCache( size_t maxcost, const std::string& account ) :
+    __cache(maxcost, account), __mutex() {
+    CacheBudget::registerCache(this);
+  }
+
+  /// Destructor.
+  virtual ~ConcurrentLRUCache( ) {
+    CacheBudget::unregisterCache(this);
+  }
+
+  /// Clears the cache. Statistics are kept.
+  inline void clear( ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    __cache.clear();
+  }
+
+  /// See LRUCache::find.
+  bool find( size_t id, size_t stamp, T& value ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    return __cache.find(id, stamp, value);
+  }
+
+  /// See LRUCache::insert.
+  void insert( size_t id, size_t stamp, const T& t, size_t cost = 1 ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    __cache.insert(id, stamp, t, cost);
+  }
+
+  inline void remove( size_t id ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    __cache.remove(id);
+  }
+
+  /// See LRUCache::trim.
+  virtual void trim( ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    __cache.trim();
+  }
+
+  inline size_t size( ) const {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    return __cache.size();
+  }
+
+  inline size_t getCost( ) const {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    return __cache.getCost();
+  }
+
+  inline size_t getMaxCost( ) const {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    return __cache.getMaxCost();
+  }
+
+  inline void setMaxCost( size_t maxcost ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    __cache.setMaxCost(maxcost);
+  }
+
+  inline size_t getHits( ) const { std::lock_guard<std::mutex> _lock(__mutex); return __cache.getHits(); }
+  inline size_t getMisses( ) const { std::lock_guard<std::mutex> _lock(__mutex); return __cache.getMisses(); }
+  inline size_t getStales( ) const { std::lock_guard<std::mutex> _lock(__mutex); return __cache.getStales(); }
+  inline size_t getEvictions( ) const { std::lock_guard<std::mutex> _lock(__mutex); return __cache.getEvictions(); }
+
+  inline void resetStatistics( ) {
+    std::lock_guard<std::mutex> _lock(__mutex);
+    __cache.resetStatistics();
+  }
+
+protected:
+
+  LRUCache<T> __cache;
+  mutable std::mutex __mutex;
+};
+
 /* ----------------------------------------------------------------------- */
 
 PGL_END_NAMESPACE
@@ -0,0 +1,336 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include "util_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+std::atomic<bool> Profiler::__enabled(false);
+
+static double threadCpuTime()
+{
+#if defined(_WIN32)
+  FILETIME creation, exittime, kernel, user;
+  GetThreadTimes(GetCurrentThread(), &creation, &exittime, &kernel, &user);
+  ULARGE_INTEGER k, u;
+  k.LowPart = kernel.dwLowDateTime; k.HighPart = kernel.dwHighDateTime;
+  u.LowPart = user.dwLowDateTime; u.HighPart = user.dwHighDateTime;
+  return double(k.QuadPart + u.QuadPart) * 1e-7;
+#elif defined(CLOCK_THREAD_CPUTIME_ID)
+  timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+#else
+  return double(clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+typedef std::chrono::steady_clock ProfilerClock;
+
+// Origin of the timestamps of the trace events.
+static const ProfilerClock::time_point profilerOrigin = ProfilerClock::now();
+
+static inline double wallTime()
+{ return std::chrono::duration<double>(ProfilerClock::now() - profilerOrigin).count(); }
+
+/* ----------------------------------------------------------------------- */
+
+// A zone in the call tree of a thread.
+struct ProfileNode {
+  const char * name;
+  ProfileNode * parent;
+  std::vector<std::unique_ptr<ProfileNode> > children;
+  size_t count;
+  double wallTime;
+  double cpuTime;
+
+  ProfileNode(const char * _name, ProfileNode * _parent) :
+    name(_name), parent(_parent), children(), count(0), wallTime(0), cpuTime(0) {}
+
+  ProfileNode * child(const char * _name) {
+    for (size_t i = 0; i < children.size(); ++i)
+      if (children[i]->name == _name || strcmp(children[i]->name, _name) == 0) return children[i].get();
+    children.push_back(std::unique_ptr<ProfileNode>(new ProfileNode(_name, this)));
+    return children.back().get();
+  }
+
+  void reset() {
+    count = 0; wallTime = 0; cpuTime = 0;
+    for (size_t i = 0; i < children.size(); ++i) children[i]->reset();
+  }
+};
+
+struct ProfileEvent {
+  const char * name;
+  double start;
+  double duration;
+  double cpuTime;
+};
+
+struct ProfileFrame {
+  ProfileNode * node;
+  double wallStart;
+  double cpuStart;
+};
+
+// The zones recorded by a thread. The mutex is only contended when the profiler is reported.
+struct ProfileThreadData {
+  size_t id;
+  std::mutex mutex;
+  ProfileNode root;
+  ProfileNode * current;
+  std::vector<ProfileFrame> stack;
+  std::vector<ProfileEvent> events;
+
+  ProfileThreadData(size_t _id) : id(_id), mutex(), root("", NULL), current(&root), stack(), events() {}
+};
+
+// The data of all the threads are kept until the end of the process, so that the zones of
+// finished threads are still reported.
+static std::mutex profilerMutex;
+static std::vector<std::unique_ptr<ProfileThreadData> > profilerThreads;
+static std::atomic<size_t> profilerMaxEvents(1000000);
+
+static ProfileThreadData * threadData()
+{
+  static thread_local ProfileThreadData * data = NULL;
+  if (data == NULL) {
+    std::unique_lock<std::mutex> lock(profilerMutex);
+    profilerThreads.push_back(std::unique_ptr<ProfileThreadData>(new ProfileThreadData(profilerThreads.size())));
+    data = profilerThreads.back().get();
+  }
+  return data;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void Profiler::enable(bool enabled)
+{ __enabled.store(enabled); }
+
+void Profiler::setMaxTraceEvents(size_t maxevents)
+{ profilerMaxEvents.store(maxevents); }
+
+size_t Profiler::getMaxTraceEvents()
+{ return profilerMaxEvents.load(); }
+
+void Profiler::beginZone(const char * name)
+{
+  ProfileThreadData * data = threadData();
+  std::unique_lock<std::mutex> lock(data->mutex);
+  data->current = data->current->child(name);
+  ProfileFrame frame = { data->current, 0, threadCpuTime() };
+  frame.wallStart = wallTime();
+  data->stack.push_back(frame);
+}
+
+void Profiler::endZone()
+{
+  double wallEnd = wallTime();
+  double cpuEnd = threadCpuTime();
+  ProfileThreadData * data = threadData();
+  std::unique_lock<std::mutex> lock(data->mutex);
+  if (data->stack.empty()) return;
+  const ProfileFrame& frame = data->stack.back();
+  ProfileNode * node = frame.node;
+  node->count += 1;
+  node->wallTime += wallEnd - frame.wallStart;
+  node->cpuTime += cpuEnd - frame.cpuStart;
+  if (data->events.size() < profilerMaxEvents.load(std::memory_order_relaxed)) {
+    ProfileEvent event = { node->name, frame.wallStart, wallEnd - frame.wallStart, cpuEnd - frame.cpuStart };
+    data->events.push_back(event);
+  }
+  data->stack.pop_back();
+  data->current = node->parent;
+}
+
+void Profiler::clear()
+{
+  std::unique_lock<std::mutex> lock(profilerMutex);
+  for (size_t i = 0; i < profilerThreads.size(); ++i) {
+    ProfileThreadData * data = profilerThreads[i].get();
+    std::unique_lock<std::mutex> tlock(data->mutex);
+    // the nodes are kept since open zones of the thread may refer to them.
+    data->root.reset();
+    data->events.clear();
+  }
+}
+
+/* ----------------------------------------------------------------------- */
+
+// Adds the statistics of the subtree of node into the merged tree of all the threads.
+static void mergeNode(const ProfileNode * node, ProfileNode * merged)
+{
+  for (size_t i = 0; i < node->children.size(); ++i) {
+    const ProfileNode * child = node->children[i].get();
+    ProfileNode * mchild = merged->child(child->name);
+    mchild->count += child->count;
+    mchild->wallTime += child->wallTime;
+    mchild->cpuTime += child->cpuTime;
+    mergeNode(child, mchild);
+  }
+}
+
+static bool hasCalls(const ProfileNode * node)
+{
+  if (node->count > 0) return true;
+  for (size_t i = 0; i < node->children.size(); ++i)
+    if (hasCalls(node->children[i].get())) return true;
+  return false;
+}
+
+static void collectStatistics(const ProfileNode * node, const std::string& path, size_t depth,
+                              std::vector<Profiler::ZoneStatistics>& result)
+{
+  for (size_t i = 0; i < node->children.size(); ++i) {
+    const ProfileNode * child = node->children[i].get();
+    if (!hasCalls(child)) continue;
+    Profiler::ZoneStatistics stat;
+    stat.name = child->name;
+    stat.path = (path.empty() ? stat.name : path + '/' + stat.name);
+    stat.depth = depth;
+    stat.count = child->count;
+    stat.wallTime = child->wallTime;
+    stat.cpuTime = child->cpuTime;
+    result.push_back(stat);
+    collectStatistics(child, stat.path, depth + 1, result);
+  }
+}
+
+std::vector<Profiler::ZoneStatistics> Profiler::statistics()
+{
+  ProfileNode merged("", NULL);
+  {
+    std::unique_lock<std::mutex> lock(profilerMutex);
+    for (size_t i = 0; i < profilerThreads.size(); ++i) {
+      std::unique_lock<std::mutex> tlock(profilerThreads[i]->mutex);
+      mergeNode(&profilerThreads[i]->root, &merged);
+    }
+  }
+  std::vector<ZoneStatistics> result;
+  collectStatistics(&merged, std::string(), 0, result);
+  return result;
+}
+
+std::string Profiler::summary()
+{
+  std::vector<ZoneStatistics> stats = statistics();
+  size_t width = 4;
+  for (size_t i = 0; i < stats.size(); ++i)
+    width = std::max(width, 2 * stats[i].depth + stats[i].name.size());
+  std::stringstream stream;
+  char line[64];
+  stream << "zone" << std::string(width - 4, ' ');
+  snprintf(line, sizeof(line), " %10s %12s %12s\n", "count", "wall (s)", "cpu (s)");
+  stream << line;
+  for (size_t i = 0; i < stats.size(); ++i) {
+    const ZoneStatistics& stat = stats[i];
+    stream << std::string(2 * stat.depth, ' ') << stat.name << std::string(width - 2 * stat.depth - stat.name.size(), ' ');
+    snprintf(line, sizeof(line), " %10lu %12.6f %12.6f\n", (unsigned long)stat.count, stat.wallTime, stat.cpuTime);
+    stream << line;
+  }
+  return stream.str();
+}
+
+static void writeJsonString(std::ostream& stream, const char * text)
+{
+  stream << '"';
+  for (const char * c = text; *c; ++c) {
+    if (*c == '"' || *c == '\\') stream << '\\' << *c;
+    else if ((unsigned char)*c < 0x20) stream << ' ';
+    else stream << *c;
+  }
+  stream << '"';
+}
+
+static void writeChromeTrace(std::ostream& stream)
+{
+  std::unique_lock<std::mutex> lock(profilerMutex);
+  stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  bool first = true;
+  char values[128];
+  for (size_t i = 0; i < profilerThreads.size(); ++i) {
+    ProfileThreadData * data = profilerThreads[i].get();
+    std::unique_lock<std::mutex> tlock(data->mutex);
+    for (std::vector<ProfileEvent>::const_iterator it = data->events.begin(); it != data->events.end(); ++it) {
+      stream << (first ? "\n" : ",\n") << "{\"name\":";
+      writeJsonString(stream, it->name);
+      // timestamps and durations are in microseconds
+      snprintf(values, sizeof(values), ",\"ph\":\"X\",\"pid\":0,\"tid\":%lu,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"cpu\":%.3f}}",
+               (unsigned long)data->id, it->start * 1e6, it->duration * 1e6, it->cpuTime * 1e6);
+      stream << values;
+      first = false;
+    }
+  }
+  stream << "\n]}\n";
+}
+
+std::string Profiler::chromeTrace()
+{
+  std::stringstream stream;
+  writeChromeTrace(stream);
+  return stream.str();
+}
+
+bool Profiler::saveChromeTrace(const std::string& fname)
+{
+  std::ofstream stream(fname.c_str());
+  if (!stream) return false;
+  writeChromeTrace(stream);
+  return bool(stream);
+}
+
+/* ----------------------------------------------------------------------- */
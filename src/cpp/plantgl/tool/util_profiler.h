@@ -0,0 +1,154 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+/*! \file util_profiler.h
+    \brief Definition of the scoped zone Profiler.
+*/
+
+#ifndef __util_profiler_h__
+#define __util_profiler_h__
+
+/* ----------------------------------------------------------------------- */
+
+#include "tools_config.h"
+#include <atomic>
+#include <string>
+#include <vector>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_BEGIN_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+
+/**
+   \class Profiler
+   \brief A profiler of named and nested zones of code, measured in wall clock and thread CPU time.
+
+   Zones are declared with PGL_PROFILE_ZONE. Each thread records its zones in
+   its own call tree, so that the zones of a worker thread are nested in the
+   zones opened by that thread only. The trees of all the threads are merged
+   by the summary. Each zone is also recorded as an event of a Chrome trace
+   (chrome://tracing or https://ui.perfetto.dev), up to a maximum number of
+   events per thread.
+
+   The profiler is disabled by default. A disabled zone only costs the test
+   of an atomic flag.
+*/
+
+/* ----------------------------------------------------------------------- */
+
+class TOOLS_API Profiler {
+public:
+
+  struct ZoneStatistics {
+    /// Names of the zone and of its enclosing zones, separated by '/'.
+    std::string path;
+    std::string name;
+    size_t depth;
+    size_t count;
+    /// Wall clock time spent in the zone, in seconds.
+    double wallTime;
+    /// CPU time of the threads spent in the zone, in seconds.
+    double cpuTime;
+  };
+
+  static void enable( bool enabled = true );
+  static inline void disable( ) { enable(false); }
+  static inline bool isEnabled( ) { return __enabled.load(std::memory_order_relaxed); }
+
+  /// Resets the statistics and the trace events. No zone should be open in another thread.
+  static void clear( );
+
+  /// Returns the statistics of the zones of all the threads, in depth-first order.
+  static std::vector<ZoneStatistics> statistics( );
+
+  /// Returns the statistics as a table with one zone per line, indented according to its depth.
+  static std::string summary( );
+
+  /// Returns the trace events in the Chrome trace JSON format.
+  static std::string chromeTrace( );
+  static bool saveChromeTrace( const std::string& fname );
+
+  /// Sets the maximum number of trace events recorded by each thread. Statistics are always recorded.
+  static void setMaxTraceEvents( size_t maxevents );
+  static size_t getMaxTraceEvents( );
+
+  /** Opens and closes a zone of the calling thread. The name must remain valid
+      until the end of the profiling, for instance a string literal. */
+  static void beginZone( const char * name );
+  static void endZone( );
+
+protected:
+  static std::atomic<bool> __enabled;
+};
+
+/* ----------------------------------------------------------------------- */
+
+/// Measures the zone \e name from its construction to its destruction if the Profiler is enabled.
+class ProfileZone {
+public:
+  inline ProfileZone( const char * name ) : __active(Profiler::isEnabled())
+  { if (__active) Profiler::beginZone(name); }
+
+  inline ~ProfileZone( )
+  { if (__active) Profiler::endZone(); }
+
+protected:
+  bool __active;
+};
+
+#define PGL_PROFILE_CONCAT_IMPL(a,b) a##b
+#define PGL_PROFILE_CONCAT(a,b) PGL_PROFILE_CONCAT_IMPL(a,b)
+
+/// Profiles the enclosing scope as a zone called \e name (a string literal).
+#define PGL_PROFILE_ZONE(name) PGL(ProfileZone) PGL_PROFILE_CONCAT(__pgl_profile_zone_,__LINE__)(name)
+
+/// Profiles the enclosing function as a zone named after it.
+#define PGL_PROFILE_FUNCTION() PGL_PROFILE_ZONE(__FUNCTION__)
+
+/* ----------------------------------------------------------------------- */
+
+PGL_END_NAMESPACE
+
+/* ----------------------------------------------------------------------- */
+#endif
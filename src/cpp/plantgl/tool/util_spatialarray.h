@@ -307,9 +307,20 @@ public:
     CellIdList query_voxels_in_cone(const VectorType& coneorigin, const VectorType& conedirection,
                                   real_t radius,  real_t coneangle = GEOM_HALF_PI, bool filterEmpty = true
                                   ) const {
-        CellIdList res;
+        return query_voxels_in_cones(coneorigin, std::vector<VectorType>(1, conedirection), radius, coneangle, filterEmpty)[0];
+    }
+
+    /// Voxels of several cones sharing the same origin, radius and angle.
+    /// The voxels around the origin are examined only once for all the cones.
+    std::vector<CellIdList> query_voxels_in_cones(const VectorType& coneorigin, const std::vector<VectorType>& conedirections,
+                                  real_t radius,  real_t coneangle = GEOM_HALF_PI, bool filterEmpty = true
+                                  ) const {
+        std::vector<CellIdList> res(conedirections.size());
         Index centervxl = indexFromPoint(coneorigin);
-        VectorType mdirection = conedirection.normed();
+        std::vector<VectorType> mdirections;
+        mdirections.reserve(conedirections.size());
+        for(typename std::vector<VectorType>::const_iterator itdir = conedirections.begin(); itdir != conedirections.end(); ++itdir)
+            mdirections.push_back(itdir->normed());
 
         // examine all voxels which are in bbox of the sphere around point with radius radius
 
@@ -334,6 +345,7 @@ public:
         real_t halfconeangle = coneangle / 2;
         real_t cosconeangle = cos(halfconeangle);
         real_t coslargeconeangle = cos(std::min<real_t>(halfconeangle+ GEOM_HALF_PI/2,GEOM_PI));
+        std::vector<VectorType> cornerdirections;
         while(!itvoxel.atEnd()){
             // Check whether coord is in ball
             VectorType voxelcentertoconeorigin = getVoxelCenter(itvoxel.index())-coneorigin;
@@ -341,17 +353,24 @@ public:
             if (voxeldist < r ){
                 CellId vxlid = itvoxel.cellId();
                  if(!filterEmpty || !ContainerType::is_empty(vxlid)){
-                    // Check first for center point of the voxel respect the angle condition
-                    real_t a = dot(voxelcentertoconeorigin,mdirection);
-                    if (a > cosconeangle) res.push_back(vxlid);
-                    // if the angle is not too big, we check if one of the corner is inside the cone
-                    else if(a > coslargeconeangle) {
-                        std::vector<VectorType> corners = getVoxelCorners(vxlid);
-                        for(typename std::vector<VectorType>::const_iterator itcorner = corners.begin(); itcorner != corners.end(); ++itcorner){
-                            real_t b = dot(direction(*itcorner - coneorigin),mdirection);
-                            if (b > cosconeangle){
-                                res.push_back(vxlid);
-                                break;
+                    cornerdirections.clear();
+                    for (size_t d = 0; d < mdirections.size(); ++d){
+                        // Check first for center point of the voxel respect the angle condition
+                        real_t a = dot(voxelcentertoconeorigin,mdirections[d]);
+                        if (a > cosconeangle) res[d].push_back(vxlid);
+                        // if the angle is not too big, we check if one of the corner is inside the cone
+                        else if(a > coslargeconeangle) {
+                            if (cornerdirections.empty()) {
+                                std::vector<VectorType> corners = getVoxelCorners(vxlid);
+                                for(typename std::vector<VectorType>::const_iterator itcorner = corners.begin(); itcorner != corners.end(); ++itcorner)
+                                    cornerdirections.push_back(direction(*itcorner - coneorigin));
+                            }
+                            for(typename std::vector<VectorType>::const_iterator itcorner = cornerdirections.begin(); itcorner != cornerdirections.end(); ++itcorner){
+                                real_t b = dot(*itcorner,mdirections[d]);
+                                if (b > cosconeangle){
+                                    res[d].push_back(vxlid);
+                                    break;
+                                }
                             }
                         }
                     }
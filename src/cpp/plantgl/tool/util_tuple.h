@@ -552,7 +552,7 @@ public:
     Base::getAt(0) = a4[0];
     Base::getAt(1) = a4[1];
     Base::getAt(2) = a4[2];
-    Base::getAt(2) = a4[2];
+    Base::getAt(3) = a4[3];
   }
 
   /// Returns whether \e self is equal to \e t.
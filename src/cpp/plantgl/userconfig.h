@@ -0,0 +1,5 @@
+// User configuration of the PlantGL project.
+// This file is automatically generated. Do not edit it directly.
+// Generated on 2026-10-17T02:45:42.
+
+#define PGL_USE_DOUBLE 1
@@ -477,10 +477,36 @@ class ObjCodec (sg.SceneCodec):
     #############################################################################
     #############################################################################
     # PlantGL -> OBJ codec
+    def _shape_meshes(self, scene, d):
+        """ Yield the name, appearance, discretization and transformation (None) of each shape. """
+        for sh in scene:
+            d.texCoord = bool(sh.appearance and sh.appearance.isTexture())
+            if sh.apply(d):
+                yield sh.name, sh.appearance, d.discretization, None
+
+    def _instance_meshes(self, instances, d):
+        """ Yield the name, appearance, discretization of the prototype and transformation of each instance.
+        Each prototype is discretized only once for each kind of appearance. """
+        prototypes = instances.getPrototypes()
+        materials = instances.getMaterials()
+        meshes = {}
+        for protoid, matid, sid, m in zip(instances.getPrototypeIds(), instances.getMaterialIds(), 
+                                          instances.getShapeIds(), instances.getTransformations()):
+            app = materials[matid]
+            hasTexture = bool(app and app.isTexture())
+            if not (protoid, hasTexture) in meshes:
+                d.texCoord = hasTexture
+                meshes[(protoid, hasTexture)] = d.discretization if prototypes[protoid].apply(d) else None
+            mesh = meshes[(protoid, hasTexture)]
+            if mesh is not None:
+                yield 'SHAPE_{}'.format(sid), app, mesh, m
+
     def write(self,fname,scene):
         """ Write an OBJ file from a plantGL scene graph.
 
         This method will convert a PlantGL scene graph into an OBJ file.
+        scene can also be an InstancedScene. The prototypes are then discretized
+        once and their points are transformed for each instance.
 
         :Examples:
             import openalea.plantgl.scenegraph as sg
@@ -504,39 +530,43 @@ class ObjCodec (sg.SceneCodec):
         texcoords= [] # List of texture List
         faces = [] # list  of tuple (offset,index List)
 
+        instanced = isinstance(scene, alg.InstancedScene)
+        appearances = scene.getMaterials() if instanced else [sh.appearance for sh in scene]
+        for appearance in appearances:
+            if appearance and not appearance.isNamed():
+                appearance.name = 'APP_{}'.format(appearance.getObjectId())
+
         vcounter = 1
         tcounter = 1
         ncounter = 1
-        for sh in scene:
-            if sh.appearance and not sh.appearance.isNamed():
-                sh.appearance.name = 'APP_{}'.format(sh.appearance.getObjectId())
-            hasTexture = (sh.appearance and sh.appearance.isTexture())
-            d.texCoord = hasTexture
-            if sh.apply(d):                
-                p = d.discretization
-                pts = p.pointList
-                if p.normalList is None:
-                    p.computeNormalList()
-                ns = p.normalList
-                ts = p.texCoordList
-                if hasTexture:
-                    if sh.appearance.transformation:
-                        ts = sh.appearance.transformation.transform(ts)
-                        p.texCoordList = ts
-                indices = p.indexList
-                n = len(p.pointList)
-                if n > 0:
-                    vertices.append(pts)
-                    if ns:
-                        normals.append(ns)
-                    if ts:
-                        texcoords.append(ts)
-                    faces.append(Faces(sh.name, vcounter, tcounter, ncounter, p, sh.appearance.name))
-                vcounter += n
-                if hasTexture:
-                    tcounter += len(ts)
+        for name, appearance, p, m in (self._instance_meshes(scene, d) if instanced else self._shape_meshes(scene, d)):
+            hasTexture = (appearance and appearance.isTexture())
+            pts = p.pointList
+            if p.normalList is None:
+                p.computeNormalList()
+            ns = p.normalList
+            ts = p.texCoordList
+            if m is not None:
+                pts = sg.Transform4(m).transform(pts)
+                if ns:
+                    nm = mt.Matrix3(m).inverse().transpose()
+                    ns = sg.Point3Array([(nm*nml).normed() for nml in ns])
+            if hasTexture:
+                if appearance.transformation:
+                    ts = appearance.transformation.transform(ts)
+            n = len(pts)
+            if n > 0:
+                vertices.append(pts)
                 if ns:
-                    ncounter += len(ns)
+                    normals.append(ns)
+                if ts:
+                    texcoords.append(ts)
+                faces.append(Faces(name, vcounter, tcounter, ncounter, p, appearance.name))
+            vcounter += n
+            if hasTexture:
+                tcounter += len(ts)
+            if ns:
+                ncounter += len(ns)
 
         for pts in vertices:
             for x, y, z in pts:
@@ -566,8 +596,7 @@ class ObjCodec (sg.SceneCodec):
 
         imgstoconvert = set([])
         appset = set()
-        for sh in scene:
-            app = sh.appearance
+        for app in appearances:
             if not app.getObjectId() in appset:
                 appset.add(app.getObjectId())
                 if isinstance(app, sg.Material):
@@ -0,0 +1,9 @@
+# User configuration of the PlantGL project.
+# This file is automatically generated. Do not edit it directly.
+# Generated on 2026-10-17T02:45:42.
+
+PGL_VERSION = 0x031401
+
+PGL_VERSION_STR = '3.20.1'
+
+PGL_USE_DOUBLE = True
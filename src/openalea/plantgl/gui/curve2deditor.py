@@ -111,7 +111,9 @@ class Bezier2DAccessor (Curve2DAccessor):
         a = self.curve.ctrlPointList[index]
         return (a[0],a[1])
     def setPointWeight(self,index,nweight):
-        self.curve.ctrlPointList[index].z = nweight
+        a = self.curve.ctrlPointList[index]
+        a.z = nweight
+        self.curve.ctrlPointList[index] = a
     def getPointWeight(self,index):
         a = self.curve.ctrlPointList[index]
         return a[2]
@@ -56,6 +56,7 @@ void export_Tesselator();
 void export_BBoxComputer();
 void export_VolComputer();
 void export_SurfComputer();
+void export_StatisticComputer();
 void export_AmapTranslator();
 void export_MatrixComputer();
 void export_WireComputer();
@@ -63,6 +64,8 @@ void export_WireComputer();
 // custom algo
 void export_Merge();
 void export_Fit();
+void export_CompiledScene();
+void export_InstancedScene();
 
 /* ----------------------------------------------------------------------- */
 // abstract printer export
@@ -91,6 +94,7 @@ void export_ProjectionCamera();
 void export_ProjectionEngine();
 void export_ZBufferEngine();
 void export_DepthSortEngine();
+void export_ProjectionStatistics();
 void export_ProjectionRenderer();
 
 /* ----------------------------------------------------------------------- */
@@ -110,6 +114,7 @@ void export_SpaceColonization();
 void export_SegIntersection();
 void export_Ray();
 void export_RayIntersection();
+void export_BVHRayIntersection();
 void export_Intersection();
 
 /* ----------------------------------------------------------------------- */
@@ -62,6 +62,30 @@ bool p_scene( BBoxComputer * b, ScenePtr s){
     return b->process(s);
 }
 
+size_t get_BBC_cacheMaxSize(BBoxComputer * obj){
+  return obj->getCache().getMaxCost();
+}
+void set_BBC_cacheMaxSize(BBoxComputer * obj, size_t v){
+  obj->getCache().setMaxCost(v);
+}
+
+dict py_BBC_cacheStatistics(BBoxComputer * obj){
+  const BBoxComputer::BoundingBoxCache& c = obj->getCache();
+  dict res;
+  res["size"] = c.size();
+  res["cost"] = c.getCost();
+  res["maxcost"] = c.getMaxCost();
+  res["hits"] = c.getHits();
+  res["misses"] = c.getMisses();
+  res["stales"] = c.getStales();
+  res["evictions"] = c.getEvictions();
+  return res;
+}
+
+void py_BBC_resetCacheStatistics(BBoxComputer * obj){
+  obj->getCache().resetStatistics();
+}
+
 /* ----------------------------------------------------------------------- */
 
 void export_BBoxComputer()
@@ -70,6 +94,9 @@ void export_BBoxComputer()
     ("BBoxComputer", init<Discretizer&>("BBoxComputer() -> Compute the objects bounding box" ))
     .def("clear",&BBoxComputer::clear)
     .def("process",&p_scene)
+    .add_property("cacheMaxSize",get_BBC_cacheMaxSize,set_BBC_cacheMaxSize,"Memory budget (in bytes) of the bounding box cache.")
+    .def("cacheStatistics",&py_BBC_cacheStatistics,"Return a dict with the size, cost and hit/miss/stale/eviction counts of the cache.")
+    .def("resetCacheStatistics",&py_BBC_resetCacheStatistics)
     .add_property("boundingbox",d_getBBox,"Return the last computed Bounding Box.")
     .add_property("result",d_getBBox)
     ;
@@ -0,0 +1,107 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include <boost/python.hpp>
+
+#include <plantgl/algo/base/compiledscene.h>
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/exception.h>
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+#define bp boost::python
+
+DEF_POINTEE(CompiledScene)
+
+Uint32Array1Ptr py_cs_shapeIds(CompiledScene * cs)
+{ return Uint32Array1Ptr(new Uint32Array1(cs->getShapeIds().begin(), cs->getShapeIds().end())); }
+
+Uint32Array1Ptr py_cs_triangleIds(CompiledScene * cs)
+{ return Uint32Array1Ptr(new Uint32Array1(cs->getTriangleIds().begin(), cs->getTriangleIds().end())); }
+
+Uint32Array1Ptr py_cs_materialIds(CompiledScene * cs)
+{ return Uint32Array1Ptr(new Uint32Array1(cs->getMaterialIds().begin(), cs->getMaterialIds().end())); }
+
+bp::object py_cs_materials(CompiledScene * cs)
+{
+    bp::list res;
+    for (std::vector<AppearancePtr>::const_iterator it = cs->getMaterials().begin(); it != cs->getMaterials().end(); ++it)
+        res.append(*it);
+    return res;
+}
+
+static void check_shape(CompiledScene * cs, size_t i){
+    if (i >= cs->nbShapes()) throw PythonExc_IndexError("Invalid shape index.");
+}
+
+bp::object py_cs_shapeTriangleRange(CompiledScene * cs, size_t i)
+{
+    check_shape(cs, i);
+    std::pair<size_t,size_t> range = cs->getShapeTriangleRange(i);
+    return bp::make_tuple(range.first, range.second);
+}
+
+uint32_t py_cs_shapeId(CompiledScene * cs, size_t i)
+{
+    check_shape(cs, i);
+    return cs->getShapeId(i);
+}
+
+void export_CompiledScene()
+{
+  class_< CompiledScene, CompiledScenePtr, boost::noncopyable > ("CompiledScene",
+      "The triangles of a scene tesselated and transformed once into world space, stored as flat arrays.",
+      init<>("CompiledScene()"))
+    .def(init<const ScenePtr&>("CompiledScene(scene) - Compile all the shapes of the scene.", args("scene")))
+    .def(init<const InstancedScenePtr&>("CompiledScene(instances) - Compile the instances, tesselating each prototype once.", args("instances")))
+    .def("compile", (void(CompiledScene::*)(const ScenePtr&))&CompiledScene::compile, "compile(scene) - Compile all the shapes of the scene.", args("scene"))
+    .def("compile", (void(CompiledScene::*)(const InstancedScenePtr&))&CompiledScene::compile, "compile(instances) - Compile the instances, tesselating each prototype once.", args("instances"))
+    .def("update", (size_t(CompiledScene::*)())&CompiledScene::update, "update() - Recompile the modified shapes of the current scene. Return the number of recompiled shapes.")
+    .def("update", (size_t(CompiledScene::*)(const ScenePtr&))&CompiledScene::update, "update(scene) - Compile the scene, reusing the unmodified shapes of the current scene. Return the number of recompiled shapes.", args("scene"))
+    .def("clear", &CompiledScene::clear)
+    .add_property("scene", make_function(&CompiledScene::getScene, return_value_policy<copy_const_reference>()))
+    .add_property("instances", make_function(&CompiledScene::getInstances, return_value_policy<copy_const_reference>()))
+    .add_property("nbTriangles", &CompiledScene::nbTriangles)
+    .add_property("nbShapes", &CompiledScene::nbShapes)
+    .def("getPointList", &CompiledScene::getPointList, "Vertices of the triangles, 3 consecutive points per triangle.")
+    .def("getNormalList", &CompiledScene::getNormalList, "Normals at the vertices of the triangles, 3 consecutive normals per triangle.")
+    .def("getShapeIds", &py_cs_shapeIds, "Id of the shape of each triangle.")
+    .def("getTriangleIds", &py_cs_triangleIds, "Index of each triangle in the triangulation of its shape.")
+    .def("getMaterialIds", &py_cs_materialIds, "Index in getMaterials() of the appearance of each triangle.")
+    .def("getMaterials", &py_cs_materials, "Appearances of the compiled shapes.")
+    .def("getShapeTriangleRange", &py_cs_shapeTriangleRange, "getShapeTriangleRange(i) - Range [first, last) of the triangles of the i-th compiled shape.", args("i"))
+    .def("getShapeId", &py_cs_shapeId, args("i"))
+    .def("getDeepModificationStamp", &CompiledScene::getDeepModificationStamp, args("shape"))
+    .staticmethod("getDeepModificationStamp")
+    ;
+  implicitly_convertible<CompiledScenePtr, RefCountObjectPtr>();
+}
@@ -52,16 +52,16 @@ using namespace std;
 
 void export_DepthSortEngine()
 {
-#ifdef PGL_WITH_CGAL
-
   class_< DepthSortEngine, bases<ProjectionEngine>, boost::noncopyable >
       ("DepthSortEngine", init<>("Construct a DepthSortEngine.") )
       .def("processTriangle", &DepthSortEngine::processTriangle)
       .def("getResult", &DepthSortEngine::getResult, (bp::arg("format")=Color4::eARGB, bp::arg("cameraCoordinates")=true))
       .def("getProjectionResult", &DepthSortEngine::getProjectionResult, (bp::arg("format")=Color4::eARGB, bp::arg("cameraCoordinates")=true))
+      .def("beginProcess", &DepthSortEngine::beginProcess, "Queue the next triangles. They are resolved in parallel by screen tiles at endProcess.")
+      .def("endProcess", &DepthSortEngine::endProcess)
+      .def("getPolygonCount", &DepthSortEngine::getPolygonCount)
+      .add_property("parallelThreshold", &DepthSortEngine::getParallelThreshold, &DepthSortEngine::setParallelThreshold)
       ;
-
-#endif
 }
 
 
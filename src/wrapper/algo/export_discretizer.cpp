@@ -46,7 +46,10 @@
 #include <plantgl/algo/base/tesselator.h>
 #include <plantgl/scenegraph/geometry/explicitmodel.h>
 #include <plantgl/scenegraph/geometry/triangleset.h>
+#include <plantgl/scenegraph/scene/scene.h>
 #include <plantgl/python/exception.h>
+#include <plantgl/python/export_list.h>
+#include <plantgl/python/export_refcountptr.h>
 
 /* ----------------------------------------------------------------------- */
 
@@ -68,6 +71,48 @@ void set_Dis_texCoord(Discretizer * obj, bool v){
   obj->computeTexCoord(v);
 }
 
+size_t get_Dis_cacheMaxSize(Discretizer * obj){
+  return obj->getCache().getMaxCost();
+}
+void set_Dis_cacheMaxSize(Discretizer * obj, size_t v){
+  obj->getCache().setMaxCost(v);
+}
+
+dict py_Dis_cacheStatistics(Discretizer * obj){
+  const Discretizer::DiscretizationCache& c = obj->getCache();
+  dict res;
+  res["size"] = c.size();
+  res["cost"] = c.getCost();
+  res["maxcost"] = c.getMaxCost();
+  res["hits"] = c.getHits();
+  res["misses"] = c.getMisses();
+  res["stales"] = c.getStales();
+  res["evictions"] = c.getEvictions();
+  return res;
+}
+
+void py_Dis_resetCacheStatistics(Discretizer * obj){
+  obj->getCache().resetStatistics();
+}
+
+object py_Dis_discretizeScene(Discretizer * obj, const ScenePtr& scene){
+  return make_list(obj->discretize(scene))();
+}
+
+/* ----------------------------------------------------------------------- */
+
+dict py_SDC_statistics(SharedDiscretizationCache * c){
+  dict res;
+  res["size"] = c->size();
+  res["cost"] = c->getCost();
+  res["maxcost"] = c->getMaxCost();
+  res["hits"] = c->getHits();
+  res["misses"] = c->getMisses();
+  res["stales"] = c->getStales();
+  res["evictions"] = c->getEvictions();
+  return res;
+}
+
 ExplicitModelPtr py_discretize( const GeometryPtr& obj) {
     if (!obj)throw PythonExc_ValueError("Cannot discretize empty object.");
     Discretizer d;
@@ -79,11 +124,29 @@ ExplicitModelPtr py_discretize( const GeometryPtr& obj) {
 
 void export_Discretizer()
 {
+  class_< SharedDiscretizationCache, SharedDiscretizationCachePtr, boost::noncopyable >
+    ("SharedDiscretizationCache", "A discretization cache that several Discretizer can use at the same time.",
+     init<>("SharedDiscretizationCache([maxsize]) -> A cache with a memory budget of maxsize bytes."))
+    .def(init<size_t>(args("maxsize")))
+    .add_property("maxSize",&SharedDiscretizationCache::getMaxCost,&SharedDiscretizationCache::setMaxCost)
+    .def("__len__",&SharedDiscretizationCache::size)
+    .def("clear",&SharedDiscretizationCache::clear)
+    .def("statistics",&py_SDC_statistics,"Return a dict with the size, cost and hit/miss/stale/eviction counts of the cache.")
+    .def("resetStatistics",&SharedDiscretizationCache::resetStatistics)
+    ;
+
   class_< Discretizer,bases< Action >,boost::noncopyable >
     ("Discretizer", init<>("Discretizer() -> Compute the objects discretization" ))
     .def("clear",&Discretizer::clear)
     .add_property("discretization",d_getDiscretization, "Return the last computed discretization.")
     .add_property("texCoord",get_Dis_texCoord,set_Dis_texCoord)
+    .add_property("cacheMaxSize",get_Dis_cacheMaxSize,set_Dis_cacheMaxSize,"Memory budget (in bytes) of the discretization cache.")
+    .def("cacheStatistics",&py_Dis_cacheStatistics,"Return a dict with the size, cost and hit/miss/stale/eviction counts of the cache.")
+    .def("resetCacheStatistics",&py_Dis_resetCacheStatistics)
+    .add_property("sharedCache",make_function(&Discretizer::getSharedCache,return_value_policy<copy_const_reference>()),&Discretizer::setSharedCache,
+                  "Cache shared with other Discretizer. If set, it is used instead of the own cache.")
+    .def("discretizeScene",&py_Dis_discretizeScene,args("scene"),
+         "Discretize in parallel the shapes of scene and return the list of results, with None for shapes that cannot be discretized.")
     .add_property("result",d_getDiscretization)
     ;
 
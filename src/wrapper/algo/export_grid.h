@@ -62,6 +62,16 @@ template<class PointGrid>
  object py_query_points_in_cone(PointGrid * grid, typename PointGrid::VectorType origin, typename PointGrid::VectorType direction, real_t radius, real_t angle)
  { return make_list(grid->query_points_in_cone(origin,direction,radius,angle))(); }
 
+template<class PointGrid>
+ object py_query_points_in_cones(PointGrid * grid, typename PointGrid::VectorType origin, object directions, real_t radius, real_t angle)
+ {
+    std::vector<typename PointGrid::PointIndexList> res = grid->query_points_in_cones(origin,extract_vec<typename PointGrid::VectorType>(directions)(),radius,angle);
+    boost::python::list result;
+    for(typename std::vector<typename PointGrid::PointIndexList>::const_iterator it = res.begin(); it != res.end(); ++it)
+        result.append(make_list(*it)());
+    return result;
+ }
+
 template<class PointGrid>
  object py_closest_point(PointGrid * grid, typename PointGrid::VectorType point, real_t maxdist = REAL_MAX)
  {
@@ -300,6 +310,7 @@ class pointgrid_func : public boost::python::def_visitor<pointgrid_func<PointGri
      .def(spatialarray_func<PointGrid>())
      .def("query_ball_point",&py_query_ball_point<PointGrid>,bp::args("center","radius"))
      .def("query_points_in_cone",&py_query_points_in_cone<PointGrid>,bp::args("origin","direction","radius","angle"))
+     .def("query_points_in_cones",&py_query_points_in_cones<PointGrid>,bp::args("origin","directions","radius","angle"),"Return the points of each cone of same origin, radius and angle.")
      .def("closest_point",&py_closest_point<PointGrid>,(bp::arg("point"),bp::arg("maxdist")=REAL_MAX))
      .def("enable_point",&PointGrid::enable_point)
      .def("disable_point",&PointGrid::disable_point)
@@ -0,0 +1,129 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+
+#include <boost/python.hpp>
+
+#include <plantgl/algo/base/instancedscene.h>
+#include <plantgl/algo/codec/plyprinter.h>
+#include <plantgl/tool/util_array.h>
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/exception.h>
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+#define bp boost::python
+
+DEF_POINTEE(InstancedScene)
+
+Uint32Array1Ptr py_is_prototypeIds(InstancedScene * is)
+{ return Uint32Array1Ptr(new Uint32Array1(is->getPrototypeIds().begin(), is->getPrototypeIds().end())); }
+
+Uint32Array1Ptr py_is_materialIds(InstancedScene * is)
+{ return Uint32Array1Ptr(new Uint32Array1(is->getMaterialIds().begin(), is->getMaterialIds().end())); }
+
+Uint32Array1Ptr py_is_shapeIds(InstancedScene * is)
+{ return Uint32Array1Ptr(new Uint32Array1(is->getShapeIds().begin(), is->getShapeIds().end())); }
+
+Uint32Array1Ptr py_is_parentIds(InstancedScene * is)
+{ return Uint32Array1Ptr(new Uint32Array1(is->getParentIds().begin(), is->getParentIds().end())); }
+
+template<class T>
+bp::object py_is_tolist(const std::vector<T>& values)
+{
+    bp::list res;
+    for (typename std::vector<T>::const_iterator it = values.begin(); it != values.end(); ++it)
+        res.append(*it);
+    return res;
+}
+
+bp::object py_is_prototypes(InstancedScene * is) { return py_is_tolist(is->getPrototypes()); }
+bp::object py_is_materials(InstancedScene * is) { return py_is_tolist(is->getMaterials()); }
+bp::object py_is_transformations(InstancedScene * is) { return py_is_tolist(is->getTransformations()); }
+
+static void check_instance(InstancedScene * is, size_t i){
+    if (i >= is->size()) throw PythonExc_IndexError("Invalid instance index.");
+}
+
+GeometryPtr py_is_instanceGeometry(InstancedScene * is, size_t i)
+{
+    check_instance(is, i);
+    return is->getInstanceGeometry(i);
+}
+
+Shape3DPtr py_is_instanceShape(InstancedScene * is, size_t i)
+{
+    check_instance(is, i);
+    return is->getInstanceShape(i);
+}
+
+void py_is_add(InstancedScene * is, const GeometryPtr& prototype, const Matrix4& transformation, const AppearancePtr& appearance, uint32_t id, uint32_t parentid)
+{ is->add(prototype, transformation, appearance, id, parentid); }
+
+void py_is_addShape(InstancedScene * is, const ShapePtr& shape)
+{
+  if (is_null_ptr(shape) || is_null_ptr(shape->getGeometry())) throw PythonExc_ValueError("Invalid shape.");
+  is->add(shape);
+}
+
+bool py_is_write_ply(const InstancedScenePtr& is, const std::string& fname, bool binary)
+{ return PlyPrinter::print(is, fname, NULL, binary ? PlyPrinter::ply_binary_little_endian : PlyPrinter::ply_ascii); }
+
+void export_InstancedScene()
+{
+  class_< InstancedScene, InstancedScenePtr, boost::noncopyable > ("InstancedScene",
+      "Instances of prototype geometries stored as flat arrays of prototype index, transformation, material index and shape ids.",
+      init<>("InstancedScene()"))
+    .def("addPrototype", &InstancedScene::addPrototype, "addPrototype(geometry) - Return the index of the prototype, adding it if needed.", args("geometry"))
+    .def("add", &py_is_add, "add(prototype, transformation, appearance, id, parentid) - Add an instance of prototype.",
+         (bp::arg("prototype"), bp::arg("transformation"), bp::arg("appearance") = AppearancePtr(), bp::arg("id") = Shape::NOID, bp::arg("parentid") = Shape::NOID))
+    .def("add", &py_is_addShape, "add(shape) - Add shape as the single instance of its geometry, with an identity transformation.", args("shape"))
+    .def("clear", &InstancedScene::clear)
+    .def("__len__", &InstancedScene::size)
+    .def("empty", &InstancedScene::empty)
+    .def("getPrototypes", &py_is_prototypes, "Prototype geometries, without duplicates.")
+    .def("getPrototypeIds", &py_is_prototypeIds, "Index in getPrototypes() of the geometry of each instance.")
+    .def("getTransformations", &py_is_transformations, "Transformation of each instance.")
+    .def("getMaterialIds", &py_is_materialIds, "Index in getMaterials() of the appearance of each instance.")
+    .def("getMaterials", &py_is_materials, "Appearances of the instances, without duplicates.")
+    .def("getShapeIds", &py_is_shapeIds, "Id of the shape of each instance.")
+    .def("getParentIds", &py_is_parentIds, "Id of the parent shape of each instance.")
+    .def("getInstanceGeometry", &py_is_instanceGeometry, "getInstanceGeometry(i) - Prototype of the i-th instance transformed into world space.", args("i"))
+    .def("getInstanceShape", &py_is_instanceShape, "getInstanceShape(i) - Shape of the i-th instance.", args("i"))
+    .def("getScene", &InstancedScene::getScene, return_value_policy<copy_const_reference>(), "Scene with a Shape for each instance.")
+    ;
+  implicitly_convertible<InstancedScenePtr, RefCountObjectPtr>();
+
+  def("write_ply_instances", &py_is_write_ply, (bp::arg("instances"), bp::arg("fname"), bp::arg("binary") = true),
+      "write_ply_instances(instances, fname, binary) : write the instances in a ply file, discretizing each prototype once.");
+}
@@ -41,8 +41,10 @@
 
 
 #include <plantgl/python/export_property.h>
+#include <plantgl/python/export_refcountptr.h>
 #include <plantgl/algo/raycasting/util_intersection.h>
 #include <plantgl/algo/raycasting/rayintersection.h>
+#include <plantgl/algo/raycasting/bvhrayintersection.h>
 #include <plantgl/algo/base/discretizer.h>
 #include <plantgl/algo/base/intersection.h>
 #include <plantgl/scenegraph/geometry/geometry.h>
@@ -56,6 +58,7 @@ using namespace boost::python;
 using namespace std;
 #define bp boost::python
 
+DEF_POINTEE(BVHRayIntersection)
 
 void export_SegIntersection()
 {
@@ -170,6 +173,53 @@ void export_RayIntersection()
     ;
 }
 
+object bvh_intersect(BVHRayIntersection * self, const Ray& ray, real_t maxdist)
+{
+    real_t distance;
+    uint32_t shapeid, triangleid;
+    if (self->intersect(ray, distance, shapeid, triangleid, maxdist))
+        return boost::python::make_tuple(ray.getAt(distance), distance, shapeid, triangleid);
+    else return object();
+}
+
+object bvh_intersect_rays(BVHRayIntersection * self, Point3ArrayPtr origins, Point3ArrayPtr directions, real_t maxdist)
+{
+    BVHRayIntersection::RayHits res = self->intersect(origins, directions, maxdist);
+    return boost::python::make_tuple(std::get<0>(res), std::get<1>(res), std::get<2>(res));
+}
+
+object bvh_intersect_rays_from(BVHRayIntersection * self, const Vector3& origin, Point3ArrayPtr directions, real_t maxdist)
+{
+    return bvh_intersect_rays(self, Point3ArrayPtr(new Point3Array(1, origin)), directions, maxdist);
+}
+
+BoolArray1Ptr bvh_occluded_rays_from(BVHRayIntersection * self, const Vector3& origin, Point3ArrayPtr directions, real_t maxdist)
+{
+    return self->isOccluded(Point3ArrayPtr(new Point3Array(1, origin)), directions, maxdist);
+}
+
+void export_BVHRayIntersection()
+{
+  class_< BVHRayIntersection, BVHRayIntersectionPtr, boost::noncopyable > ("BVHRayIntersection", 
+      init<const ScenePtr&, bp::optional<uint32_t> >("BVHRayIntersection(scene[, maxLeafSize]) - Build a bounding volume hierarchy on the triangles of the scene.", (bp::arg("scene"), bp::arg("maxLeafSize")=4)) )
+    .def(init<const CompiledScenePtr&, bp::optional<uint32_t> >("BVHRayIntersection(compiledscene[, maxLeafSize]) - Build a bounding volume hierarchy on the triangles of a CompiledScene.", (bp::arg("compiledscene"), bp::arg("maxLeafSize")=4)) )
+    .def("build",(void(BVHRayIntersection::*)(const ScenePtr&))&BVHRayIntersection::build, "build(scene) - Rebuild the hierarchy on the triangles of the scene.", args("scene"))
+    .def("build",(void(BVHRayIntersection::*)(const CompiledScenePtr&))&BVHRayIntersection::build, "build(compiledscene) - Rebuild the hierarchy on the triangles of a CompiledScene.", args("compiledscene"))
+    .def("clear",&BVHRayIntersection::clear)
+    .def("intersect",&bvh_intersect, "intersect(ray[, maxdist]) - Return (point, distance, shapeid, triangleid) of the closest intersection or None.", (bp::arg("ray"), bp::arg("maxdist")=REAL_MAX))
+    .def("isOccluded",(bool(BVHRayIntersection::*)(const Ray&, real_t) const)&BVHRayIntersection::isOccluded, "isOccluded(ray[, maxdist]) - Test if the ray intersects any triangle.", (bp::arg("ray"), bp::arg("maxdist")=REAL_MAX))
+    .def("intersectRays",&bvh_intersect_rays, "intersectRays(origins, directions[, maxdist]) - Return points, distances and shape ids of the closest intersections of all the rays.", (bp::arg("origins"), bp::arg("directions"), bp::arg("maxdist")=REAL_MAX))
+    .def("intersectRays",&bvh_intersect_rays_from, (bp::arg("origin"), bp::arg("directions"), bp::arg("maxdist")=REAL_MAX))
+    .def("areOccluded",(BoolArray1Ptr(BVHRayIntersection::*)(const Point3ArrayPtr&, const Point3ArrayPtr&, real_t) const)&BVHRayIntersection::isOccluded, "areOccluded(origins, directions[, maxdist]) - Test for each ray if it intersects any triangle.", (bp::arg("origins"), bp::arg("directions"), bp::arg("maxdist")=REAL_MAX))
+    .def("areOccluded",&bvh_occluded_rays_from, (bp::arg("origin"), bp::arg("directions"), bp::arg("maxdist")=REAL_MAX))
+    .def("getBoundingBox",&BVHRayIntersection::getBoundingBox)
+    .add_property("nbTriangles",&BVHRayIntersection::nbTriangles)
+    .add_property("nbNodes",&BVHRayIntersection::nbNodes)
+    .add_property("multithreaded",&BVHRayIntersection::isMultiThreaded, &BVHRayIntersection::setMultiThreaded)
+    ;
+  implicitly_convertible<BVHRayIntersectionPtr, RefCountObjectPtr>();
+}
+
 
 object py_polygon2ds_intersection_1(Point2ArrayPtr polygon1, Point2ArrayPtr polygon2)
 {
@@ -66,14 +66,47 @@ class kdtree_func : public boost::python::def_visitor<kdtree_func<KDTreeN> >
     }
 };
 
+template<class NativeKDTreeN>
+class native_kdtree_func : public boost::python::def_visitor<native_kdtree_func<NativeKDTreeN> >
+{
+    friend class boost::python::def_visitor_access;
+
+    typedef typename NativeKDTreeN::PointContainerPtr PointContainerPtr;
+
+    template <class classT>
+    void visit(classT& c) const
+    {
+        c.def("k_closest_points", (IndexArrayPtr(NativeKDTreeN::*)(const PointContainerPtr&, size_t, real_t) const)&NativeKDTreeN::k_closest_points, (bp::arg("points"),bp::arg("k"),bp::arg("maxdist")= REAL_MAX),"Return the k closest points of each of the query points")
+         .def("k_closest_points", (Index(NativeKDTreeN::*)(const typename NativeKDTreeN::VectorType&, size_t, real_t))&NativeKDTreeN::k_closest_points, (bp::arg("point"),bp::arg("k"),bp::arg("maxdist")= REAL_MAX),"Return the k closest points of point")
+         .def("r_closest_points", &NativeKDTreeN::r_closest_points, (bp::arg("points"),bp::arg("radius")),"Return the points at a distance inf of radius of each of the query points")
+         .add_property("maxLeafSize", &NativeKDTreeN::getMaxLeafSize)
+         .add_property("nbNodes", &NativeKDTreeN::getNbNodes)
+         .add_property("multithreaded", &NativeKDTreeN::isMultiThreaded, &NativeKDTreeN::setMultiThreaded)
+        ;
+    }
+};
+
 #ifdef PGL_WITH_ANN
 
 KDTree2Ptr init_kdtree2(const Point2ArrayPtr points) { return KDTree2Ptr(new ANNKDTree2(points)); }
 KDTree3Ptr init_kdtree3(const Point3ArrayPtr points) { return KDTree3Ptr(new ANNKDTree3(points)); }
 KDTree4Ptr init_kdtree4(const Point4ArrayPtr points) { return KDTree4Ptr(new ANNKDTree4(points)); }
 
+#else
+
+KDTree2Ptr init_kdtree2(const Point2ArrayPtr points) { return KDTree2Ptr(new NativeKDTree2(points)); }
+KDTree3Ptr init_kdtree3(const Point3ArrayPtr points) { return KDTree3Ptr(new NativeKDTree3(points)); }
+KDTree4Ptr init_kdtree4(const Point4ArrayPtr points) { return KDTree4Ptr(new NativeKDTree4(points)); }
+
 #endif
 
+#define EXPORT_NATIVEKDTREE(NAME, BASE, POINTS, DIM) \
+  class_< NAME, NAME##Ptr, bases<BASE>, boost::noncopyable > \
+      (#NAME, init<POINTS, optional<uint32_t> >(args("points","maxLeafSize"), "Construct a KD-Tree from a set of " #DIM " points without ANN.") ) \
+      .def(native_kdtree_func<NAME>()); \
+  implicitly_convertible< NAME##Ptr, RCPtr<BASE> >(); \
+
+
 void export_KDtree()
 {
   class_< AbstractKDTree2, KDTree2Ptr, boost::noncopyable > ("AbstractKDTree2", no_init )
@@ -85,6 +118,13 @@ void export_KDtree()
   class_< AbstractKDTree4, KDTree4Ptr, boost::noncopyable > ("AbstractKDTree4", no_init )
      .def(kdtree_func<AbstractKDTree4>());
 
+  EXPORT_NATIVEKDTREE(NativeKDTree2, AbstractKDTree2, Point2ArrayPtr, 2D)
+  EXPORT_NATIVEKDTREE(NativeKDTree3, AbstractKDTree3, Point3ArrayPtr, 3D)
+  EXPORT_NATIVEKDTREE(NativeKDTree4, AbstractKDTree4, Point4ArrayPtr, 4D)
+  EXPORT_NATIVEKDTREE(NativeKDTree2f, AbstractKDTree2, Point2ArrayPtr, 2D)
+  EXPORT_NATIVEKDTREE(NativeKDTree3f, AbstractKDTree3, Point3ArrayPtr, 3D)
+  EXPORT_NATIVEKDTREE(NativeKDTree4f, AbstractKDTree4, Point4ArrayPtr, 4D)
+
 #ifdef PGL_WITH_ANN
 
   class_< ANNKDTree2, ANNKDTree2Ptr, bases<AbstractKDTree2>, boost::noncopyable >
@@ -99,11 +139,11 @@ void export_KDtree()
       ("ANNKDTree4", init<Point4ArrayPtr>("Construct a KD-Tree from a set of 4D points.") );
   implicitly_convertible< ANNKDTree4Ptr, KDTree4Ptr >();
 
+#endif
+
   def("KDTree2", init_kdtree2, args("points"), "Construct a KD-Tree from a set of 2D points.");
   def("KDTree3", init_kdtree3, args("points"), "Construct a KD-Tree from a set of 3D points.");
   def("KDTree4", init_kdtree4, args("points"), "Construct a KD-Tree from a set of 4D points.");
-
-#endif
 }
 
 
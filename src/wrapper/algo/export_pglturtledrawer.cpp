@@ -44,17 +44,22 @@
 #include <plantgl/python/export_property.h>
 #include <plantgl/python/export_list.h>
 #include <plantgl/python/extract_list.h>
+#include <plantgl/python/export_refcountptr.h>
 
 #include <boost/python.hpp>
 using namespace boost::python;
 #define bp boost::python
 PGL_USING_NAMESPACE
 
+DEF_POINTEE(PglTurtleDrawer)
 
 void export_PglTurtleDrawer()
 {
-  class_< PglTurtleDrawer , boost::noncopyable, bases<TurtleDrawer> >("PglTurtleDrawer", init<>("PglTurtleDrawer() -> Create PglTurtleDrawer"))
+  class_< PglTurtleDrawer , PglTurtleDrawerPtr, boost::noncopyable, bases<TurtleDrawer> >("PglTurtleDrawer", init<>("PglTurtleDrawer() -> Create PglTurtleDrawer"))
     .def("getScene", &PglTurtleDrawer::getScene, return_value_policy<return_by_value>() )
+    .def("getInstances", &PglTurtleDrawer::getInstances, return_value_policy<copy_const_reference>(), "Instances drawn in instancing mode.")
+    .add_property("instancing", &PglTurtleDrawer::isInstancing, &PglTurtleDrawer::setInstancing,
+                  "If True, cylinders, cones, spheres and custom geometries are recorded as instances of shared prototypes in getInstances().")
     ;
 
      implicitly_convertible<PglTurtleDrawerPtr, TurtleDrawerPtr>();
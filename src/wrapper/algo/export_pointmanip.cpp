@@ -41,6 +41,7 @@
 
 
 #include <plantgl/algo/base/pointmanipulation.h>
+#include <plantgl/algo/base/parallelexecutor.h>
 #include <boost/python.hpp>
 #include <plantgl/python/export_list.h>
 #include <plantgl/python/extract_list.h>
@@ -63,6 +64,9 @@ using namespace boost::python;
 /* ----------------------------------------------------------------------- */
 
 
+size_t py_get_nb_threads() { return ParallelExecutor::get().nb_threads(); }
+void py_set_nb_threads(size_t nbthreads) { ParallelExecutor::get().set_nb_threads(nbthreads); }
+
 object py_points_dijkstra_shortest_path(const Point3ArrayPtr points,
                                         const IndexArrayPtr adjacencies,
                                         uint32_t root) {
@@ -260,16 +264,18 @@ void export_PointManip() {
   def("select_pole_points_mt", &py_select_pole_points_mt, (bp::arg("point"), bp::arg("radius"), bp::arg("iterations"), bp::arg("tolerance") = -1.0));
   def("select_pole_from_point", &py_select_pole_from_point, (bp::arg("points"), bp::arg("startPoint"), bp::arg("iterations"), bp::arg("maxAngle")));
 
+  def("get_nb_threads", &py_get_nb_threads, "Return the number of threads used by the parallel point algorithms.");
+  def("set_nb_threads", &py_set_nb_threads, (bp::arg("nbthreads") = 0), "Set the number of threads used by the parallel point algorithms. 0 means the number of cores.");
+
 #ifdef PGL_WITH_CGAL
   def("delaunay_point_connection", &delaunay_point_connection, args("points"));
   def("delaunay_triangulation", &delaunay_triangulation, args("points"));
   def("k_closest_points_from_delaunay", &k_closest_points_from_delaunay, args("points", "k"));
 #endif
-#ifdef PGL_WITH_ANN
   def("k_closest_points_from_ann", &k_closest_points_from_ann, (bp::arg("points"), bp::arg("k"), bp::arg("symmetric") = false));
-#endif
 
-  def("symmetrize_connections", &symmetrize_connections, (bp::arg("adjacencies")));
+  def("symmetrize_connections", (IndexArrayPtr(*)(const IndexArrayPtr))&symmetrize_connections, (bp::arg("adjacencies")));
+  def("symmetrize_connections", (CSRIndexArrayPtr(*)(const CSRIndexArrayPtr))&symmetrize_connections, (bp::arg("adjacencies")));
   def("get_all_connex_components", &get_all_connex_components, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("verbose") = false));
   def("connect_all_connex_components", &connect_all_connex_components, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("verbose") = false));
 
@@ -278,12 +284,15 @@ void export_PointManip() {
   def("r_neighborhoods", (IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const RealArrayPtr)) &r_neighborhoods, args("points", "adjacencies", "radii"));
   def("r_neighborhoods", (IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, real_t, bool)) &r_neighborhoods, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("radius"), bp::arg("verbose") = false));
   def("r_neighborhoods_mt", (IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, real_t, bool)) &r_neighborhoods_mt, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("radius"), bp::arg("verbose") = false));
+  def("r_neighborhoods", (CSRIndexArrayPtr(*)(const Point3ArrayPtr, const CSRIndexArrayPtr, real_t)) &r_neighborhoods, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("radius")));
+  def("r_neighborhoods_mt", (CSRIndexArrayPtr(*)(const Point3ArrayPtr, const CSRIndexArrayPtr, real_t)) &r_neighborhoods_mt, (bp::arg("points"), bp::arg("adjacencies"), bp::arg("radius")));
   def("r_anisotropic_neighborhood", &r_anisotropic_neighborhood, args("pid", "points", "adjacencies", "radius", "direction", "alpha", "beta"));
   def("r_anisotropic_neighborhoods", (IndexArrayPtr (*)(const Point3ArrayPtr, const IndexArrayPtr, const RealArrayPtr, const Point3ArrayPtr, const real_t, const real_t)) &r_anisotropic_neighborhoods, args("points", "adjacencies", "radii", "directions", "alpha", "beta"));
   def("r_anisotropic_neighborhoods", (IndexArrayPtr (*)(const Point3ArrayPtr, const IndexArrayPtr, const real_t, const Point3ArrayPtr, const real_t, const real_t)) &r_anisotropic_neighborhoods, args("points", "adjacencies", "radius", "directions", "alpha", "beta"));
 
   def("k_neighborhood", &k_neighborhood, args("pid", "points", "adjacencies", "k"));
-  def("k_neighborhoods", &k_neighborhoods, args("points", "adjacencies", "k"));
+  def("k_neighborhoods", (IndexArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const uint32_t))&k_neighborhoods, args("points", "adjacencies", "k"));
+  def("k_neighborhoods", (CSRIndexArrayPtr(*)(const Point3ArrayPtr, const CSRIndexArrayPtr, const uint32_t))&k_neighborhoods, args("points", "adjacencies", "k"));
 
   def("density_from_r_neighborhood", &density_from_r_neighborhood, args("pid", "points", "adjacencies", "radius"));
   def("densities_from_r_neighborhood", (RealArrayPtr(*)(const Point3ArrayPtr, const IndexArrayPtr, const real_t)) &densities_from_r_neighborhood, args("points", "adjacencies", "radius"));
@@ -44,6 +44,7 @@
 
 #include <plantgl/algo/codec/povprinter.h>
 #include <plantgl/algo/base/tesselator.h>
+#include <plantgl/algo/base/instancedscene.h>
 
 #include <boost/python.hpp>
 
@@ -73,6 +74,7 @@ void export_PovPrinter()
   class_< PovPrinter, bases< Printer >, boost::noncopyable > ("PovPrinter", no_init )
     .def("setLight",&PovPrinter::setLight,           "setLight(Vector3 position, Color3 color)", args("position","color") )
     .def("setBackground",&PovPrinter::setBackGround, "setBackGround(Color3 color)",args("color"))
+    .def("process",(bool(PovPrinter::*)(const InstancedScenePtr&))&PovPrinter::process, "process(instances) - Print the instances, declaring each prototype once.",args("instances"))
     ;
 
   class_< PyStrPovPrinter, bases< PyStrPrinter, PovPrinter >, boost::noncopyable >
@@ -0,0 +1,90 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright 1995-2007 UMR CIRAD/INRIA/INRA DAP 
+ *
+ *       File author(s): F. Boudon et al.
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *                      GNU General Public Licence
+ *
+ *       This program is free software; you can redistribute it and/or
+ *       modify it under the terms of the GNU General Public License as
+ *       published by the Free Software Foundation; either version 2 of
+ *       the License, or (at your option) any later version.
+ *
+ *       This program is distributed in the hope that it will be useful,
+ *       but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *       MERCHANTABILITY or FITNESS For A PARTICULAR PURPOSE. See the
+ *       GNU General Public License for more details.
+ *
+ *       You should have received a copy of the GNU General Public
+ *       License along with this program; see the file COPYING. If not,
+ *       write to the Free Software Foundation, Inc., 59
+ *       Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+#include <plantgl/algo/projection/projectionstatistics.h>
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/boost_python.h>
+
+PGL_USING_NAMESPACE
+TOOLS_USING_NAMESPACE
+using namespace boost::python;
+using namespace std;
+#define bp boost::python
+
+
+boost::python::object py_projectionSizes(const ScenePtr& scene, const ProjectionCameraPtr& camera, uint16_t imageWidth = 800, uint16_t imageHeight = 800){
+    std::vector<std::pair<uint32_t,real_t> > res = projectionSizes(scene, camera, imageWidth, imageHeight);
+    boost::python::list bres;
+    for(std::vector<std::pair<uint32_t,real_t> >::const_iterator _it = res.begin(); _it != res.end(); ++_it){
+      bres.append(boost::python::make_tuple(_it->first,_it->second));
+    }
+    return bres;
+}
+
+boost::python::object py_pixelPerShape(const ScenePtr& scene, const ProjectionCameraPtr& camera, uint16_t imageWidth = 800, uint16_t imageHeight = 800){
+    real_t pixelwidth = 0;
+    std::vector<std::pair<uint32_t,uint32_t> > res = pixelPerShape(scene, camera, imageWidth, imageHeight, &pixelwidth);
+    boost::python::list bres;
+    for(std::vector<std::pair<uint32_t,uint32_t> >::const_iterator _it = res.begin(); _it != res.end(); ++_it){
+      bres.append(boost::python::make_tuple(_it->first,_it->second));
+    }
+    return boost::python::make_tuple(bres,pixelwidth);
+}
+
+// Same layout as the result of Viewer.castRays2 : for each pixel, a list of (id, back point, front point).
+boost::python::object py_castRays(const ScenePtr& scene, const ProjectionCameraPtr& camera, uint16_t imageWidth = 800, uint16_t imageHeight = 800, bool backtest = true){
+    ShapeRayHitBufferPtr buf = castRays(scene, camera, imageWidth, imageHeight, backtest);
+    boost::python::list res;
+    for(size_t i = 0; i < buf->getColumnSize(); i++){
+        boost::python::list row;
+        for(size_t j = 0; j < buf->getRowSize(); j++){
+            boost::python::list zlist;
+            const ShapeRayHitList& hits = buf->getAt(i,j);
+            for(ShapeRayHitList::const_iterator _it = hits.begin(); _it != hits.end(); ++_it){
+                zlist.append(boost::python::make_tuple(_it->id,_it->back,_it->front));
+            }
+            row.append(zlist);
+        }
+        res.append(row);
+    }
+    return res;
+}
+
+void export_ProjectionStatistics()
+{
+    def("projectionSizes", &py_projectionSizes, (bp::arg("scene"), bp::arg("camera"), bp::arg("imageWidth")=800, bp::arg("imageHeight")=800),
+        "Projected area of each shape of the scene rendered alone with the camera. Return a list of (id, area) in the order of the scene.");
+    def("pixelPerShape", &py_pixelPerShape, (bp::arg("scene"), bp::arg("camera"), bp::arg("imageWidth")=800, bp::arg("imageHeight")=800),
+        "Number of visible pixels of each shape id. Return ([(id, nbpixels)], pixelwidth).");
+    def("castRays", &py_castRays, (bp::arg("scene"), bp::arg("camera"), bp::arg("imageWidth")=800, bp::arg("imageHeight")=800, bp::arg("backtest")=true),
+        "Intersections of the ray of each pixel with each shape. Return for each pixel (x,y) a list of (id, back point, front point).");
+}
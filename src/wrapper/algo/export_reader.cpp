@@ -52,6 +52,8 @@
 #include <plantgl/scenegraph/core/smbtable.h>
 #endif
 #include <plantgl/algo/codec/scne_binaryparser.h>
+#include <plantgl/algo/codec/cdc_ply.h>
+#include <plantgl/python/exception.h>
 #include <sstream>
 
 /* ----------------------------------------------------------------------- */
@@ -73,6 +75,22 @@ object pgl_read(const std::string& txt, const std::string& fname)
 
 #endif
 
+void py_ply_chunk_callback(boost::python::object callback, const Point3ArrayPtr& points, const Color4ArrayPtr& colors, size_t offset)
+{
+    callback(points, colors, offset);
+}
+
+void py_read_ply_points(const std::string& fname, boost::python::object callback, size_t chunksize)
+{
+    PlyCodec codec;
+    try {
+        codec.readPointChunks(fname, boost::bind(&py_ply_chunk_callback, callback, _1, _2, _3), chunksize);
+    }
+    catch (const std::runtime_error& e) {
+        throw PythonExc_ValueError(e.what());
+    }
+}
+
 void export_PglReader()
 {
 #ifdef PGL_WITH_BISONFLEX
@@ -80,4 +98,6 @@ void export_PglReader()
 #endif
     def("pglParserVerbose",&parserVerbose, (bp::arg("verbose")=true));
     def("isPglParserVerbose",&isParserVerbose);
+    def("read_ply_points",&py_read_ply_points, (bp::arg("fname"),bp::arg("callback"),bp::arg("chunksize")=1 << 20),
+        "read_ply_points(fname, callback, chunksize) : call callback(points, colors, offset) on successive chunks of the vertices of a ply file, without building a Scene.");
 }
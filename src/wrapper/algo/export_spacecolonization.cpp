@@ -103,6 +103,9 @@ public:
             INHERIT_SIMPLE_FUNC0(SpaceColonization,StartEach);
             INHERIT_SIMPLE_FUNC0(SpaceColonization,EndEach);
 
+        // the attractors perceived in advance are only used by the C++ generate_buds.
+        virtual bool uses_perceptions() const
+        { return !this->get_override("generate_buds"); }
 
     void py_add_bud(size_t pid, const Vector3& direction, const Index& attractors){
         add_bud(pid, direction, AttractorList(attractors.begin(),attractors.end()));
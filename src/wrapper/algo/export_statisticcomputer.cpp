@@ -0,0 +1,109 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+#include <boost/python.hpp>
+
+#include <plantgl/algo/base/statisticcomputer.h>
+#include <plantgl/scenegraph/scene/scene.h>
+#include <plantgl/python/export_list.h>
+
+/* ----------------------------------------------------------------------- */
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+using namespace std;
+
+/* ----------------------------------------------------------------------- */
+
+object sc_elements(StatisticComputer * sc){
+    return make_list(sc->getElements())();
+}
+
+dict sc_memorysizes(StatisticComputer * sc){
+    dict res;
+    const std::vector<size_t>& memsizes = sc->getMemorySizes();
+    for (uint_t i = 0; i < memsizes.size(); ++i)
+        if (memsizes[i] > 0) res[StatisticComputer::getElementName(i)] = memsizes[i];
+    return res;
+}
+
+dict sc_shapememorysizes(StatisticComputer * sc){
+    dict res;
+    const pgl_hash_map<uint_t,size_t>& memsizes = sc->getShapeMemorySizes();
+    for (pgl_hash_map<uint_t,size_t>::const_iterator it = memsizes.begin(); it != memsizes.end(); ++it)
+        res[it->first] = it->second;
+    return res;
+}
+
+dict sc_arraystatistics(StatisticComputer * sc){
+    dict res;
+    const std::map<std::string,StatisticComputer::ArrayStatistics>& arrays = sc->getArrayStatistics();
+    for (std::map<std::string,StatisticComputer::ArrayStatistics>::const_iterator it = arrays.begin(); it != arrays.end(); ++it) {
+        dict stat;
+        stat["count"] = it->second.count;
+        stat["size"] = it->second.size;
+        stat["memorySize"] = it->second.memsize;
+        stat["sharedMemorySize"] = it->second.sharedmemsize;
+        res[it->first] = stat;
+    }
+    return res;
+}
+
+/* ----------------------------------------------------------------------- */
+
+void export_StatisticComputer()
+{
+  class_< StatisticComputer, bases<Action>, boost::noncopyable >
+    ("StatisticComputer", init<>("StatisticComputer() -> compute statistics on the objects of a scene. Use scene.apply(statisticcomputer)."))
+    .add_property("size", &StatisticComputer::getSize, "Return the number of elements")
+    .add_property("named", &StatisticComputer::getNamed, "Return the number of named elements")
+    .add_property("memorySize", &StatisticComputer::getMemorySize, "Return the memory size of the elements, including the elements of their arrays")
+    .add_property("sharedMemorySize", &StatisticComputer::getSharedMemorySize, "Return the memory size of the array elements shared with copies of the arrays")
+    .add_property("elements", &sc_elements, "Return the number of elements of each type")
+    .add_property("memorySizes", &sc_memorysizes, "Return a dict of the memory size of the elements of each type, including their arrays")
+    .add_property("shapeMemorySizes", &sc_shapememorysizes, "Return a dict of the memory size of each shape id. Objects shared by several shapes are counted with the first one")
+    .add_property("arrayStatistics", &sc_arraystatistics, "Return a dict of the count, number of elements and memory size of the arrays of each class")
+    .def("clear", &StatisticComputer::clear, "Clear the statistics. They are also cleared each time a scene is processed.")
+    ;
+}
+
+/* ----------------------------------------------------------------------- */
@@ -32,6 +32,7 @@
 #include <plantgl/algo/projection/zbufferengine.h>
 #include <plantgl/python/export_refcountptr.h>
 #include <plantgl/python/boost_python.h>
+#include <plantgl/python/exception.h>
 
 PGL_USING_NAMESPACE
 TOOLS_USING_NAMESPACE
@@ -39,6 +40,8 @@ using namespace boost::python;
 using namespace std;
 #define bp boost::python
 
+DEF_POINTEE(MipmapTexture)
+
 
 boost::python::object py_grabZBufferPoints(ZBufferEngine * ze, real_t jitter = 0, real_t raywidth = 0){
     std::tuple<Point3ArrayPtr,Color3ArrayPtr,Uint32Array1Ptr> bufpoints = ze->grabZBufferPoints(jitter, raywidth);
@@ -62,6 +65,55 @@ boost::python::object py_idhistogram(ZBufferEngine * ze, bool solidangle = true)
     }
     return bres;
 }
+boost::python::object py_sparseFormFactors(const Point3ArrayPtr& points, const Index3ArrayPtr& triangles, const Point3ArrayPtr& normals = Point3ArrayPtr(), bool ccw = true, uint16_t discretization = 200, bool solidangle = true){
+    SparseFormFactors res = sparseFormFactors(points, triangles, normals, ccw, discretization, solidangle);
+    return boost::python::make_tuple(std::get<0>(res),std::get<1>(res),std::get<2>(res));
+}
+
+void py_setTileBinning(ZBufferEngine * ze, bool enabled){
+    ze->setTileBinning(enabled, ze->getTileSize());
+}
+
+static void check_view(MultiViewZBufferEngine * mv, size_t view){
+    if (view >= mv->getNbViews()) throw PythonExc_IndexError("Invalid view index.");
+}
+
+boost::python::object py_mv_idhistogram(MultiViewZBufferEngine * mv, size_t view){
+    check_view(mv, view);
+    const pgl_hash_map<uint32_t,real_t>& res = mv->idhistogram(view);
+    boost::python::list bres;
+    for(pgl_hash_map<uint32_t,real_t>::const_iterator _it = res.begin(); _it != res.end(); ++_it){
+      bres.append(boost::python::make_tuple(_it->first,_it->second));
+    }
+    return bres;
+}
+
+boost::python::object py_mv_idhistograms(MultiViewZBufferEngine * mv){
+    boost::python::list bres;
+    for(size_t view = 0; view < mv->getNbViews(); ++view){
+      bres.append(py_mv_idhistogram(mv, view));
+    }
+    return bres;
+}
+
+RealArray2Ptr py_mv_getDepthBuffer(MultiViewZBufferEngine * mv, size_t view){
+    check_view(mv, view);
+    return mv->getDepthBuffer(view);
+}
+
+Uint32Array2Ptr py_mv_getIdBuffer(MultiViewZBufferEngine * mv, size_t view){
+    check_view(mv, view);
+    return mv->getIdBuffer(view);
+}
+
+ProjectionCameraPtr py_mv_getView(MultiViewZBufferEngine * mv, size_t view){
+    check_view(mv, view);
+    return mv->getView(view);
+}
+
+size_t py_getNbThreads() { return ThreadManager::get().nb_threads(); }
+void py_setNbThreads(size_t nbthreads) { ThreadManager::get().set_nb_threads(nbthreads); }
+
 void export_ZBufferEngine()
 {
 
@@ -86,7 +138,17 @@ void export_ZBufferEngine()
       .def("getDepthBuffer", &ZBufferEngine::getDepthBuffer)
       .def("getIdBuffer", &ZBufferEngine::getIdBuffer)
       .def("getIdBufferAsImage", &ZBufferEngine::getIdBufferAsImage,(bp::arg("conversionFormat")=Color4::eARGB))
+      .def("process", (void(ZBufferEngine::*)(const CompiledScenePtr&))&ZBufferEngine::process, (bp::arg("compiledscene")), "process(compiledscene) - Render the triangles of a CompiledScene.")
+      .def("process", (void(ZBufferEngine::*)(const InstancedScenePtr&))&ZBufferEngine::process, (bp::arg("instances")), "process(instances) - Render an InstancedScene, tesselating each prototype once.")
       .add_property("multithreaded",&ZBufferEngine::isMultiThreaded, &ZBufferEngine::setMultiThreaded)
+      .def("setTileBinning", &ZBufferEngine::setTileBinning, (bp::arg("enabled")=true, bp::arg("tileSize")=32))
+      .add_property("tileBinning",&ZBufferEngine::isTileBinningEnabled, &py_setTileBinning)
+      .add_property("spanShading",&ZBufferEngine::isSpanShadingEnabled, &ZBufferEngine::setSpanShading)
+      .add_property("tileSize",&ZBufferEngine::getTileSize)
+      .def("getNbThreads", &py_getNbThreads)
+      .staticmethod("getNbThreads")
+      .def("setNbThreads", &py_setNbThreads, (bp::arg("nbthreads")))
+      .staticmethod("setNbThreads")
 
 
       .def("duplicateBuffer", (void(ZBufferEngine::*)(const Vector3&, const Vector3&, bool, const Color3&))&ZBufferEngine::duplicateBuffer,(bp::arg("from"), bp::arg("to")=600, bp::arg("useDefaultColor")=true, bp::arg("defaultcolor")=Color3(0,0,0)))
@@ -101,4 +163,49 @@ void export_ZBufferEngine()
       ;
 
       def("formFactors", &formFactors, (bp::arg("points"), bp::arg("triangles"), bp::arg("normals")=Point3ArrayPtr(0), bp::arg("ccw")=true, bp::arg("discretization")=200, bp::arg("solidangle")=200));
+      def("sparseFormFactors", &py_sparseFormFactors, (bp::arg("points"), bp::arg("triangles"), bp::arg("normals")=Point3ArrayPtr(0), bp::arg("ccw")=true, bp::arg("discretization")=200, bp::arg("solidangle")=true),
+          "Compute the form factors between triangles as a sparse matrix in CSR format. Return (rowpointers, columnindices, values).");
+
+  class_< MultiViewZBufferEngine, boost::noncopyable > 
+      ("MultiViewZBufferEngine", "Id rendering of a scene from a list of cameras, rendered in parallel.", init<uint16_t, uint16_t, uint32_t>("Construct a MultiViewZBufferEngine.",(bp::arg("imageWidth")=800, bp::arg("imageHeight")=800, bp::arg("defaultId")=Shape::NOID)) )
+      .def("setScene", &MultiViewZBufferEngine::setScene, (bp::arg("scene")))
+      .def("addView", &MultiViewZBufferEngine::addView, (bp::arg("camera")))
+      .def("clearViews", &MultiViewZBufferEngine::clearViews)
+      .def("getNbViews", &MultiViewZBufferEngine::getNbViews)
+      .def("getNbTriangles", &MultiViewZBufferEngine::getNbTriangles)
+      .def("getNbShapes", &MultiViewZBufferEngine::getNbShapes)
+      .def("getNbBlocks", &MultiViewZBufferEngine::getNbBlocks)
+      .def("getView", &py_mv_getView, (bp::arg("view")))
+      .def("process", &MultiViewZBufferEngine::process, (bp::arg("keepBuffers")=true, bp::arg("solidangle")=true))
+      .def("getDepthBuffer", &py_mv_getDepthBuffer, (bp::arg("view")))
+      .def("getIdBuffer", &py_mv_getIdBuffer, (bp::arg("view")))
+      .def("idhistogram", &py_mv_idhistogram, (bp::arg("view")))
+      .def("idhistograms", &py_mv_idhistograms)
+      ;
+
+  class_< MipmapTexture, MipmapTexturePtr, boost::noncopyable >
+      ("MipmapTexture", "A texture with its precomputed mip levels, sampled with trilinear filtering by the ZBufferEngine.", init<const ImagePtr&>("MipmapTexture(image)", (bp::arg("image"))) )
+      .def("width", &MipmapTexture::width, (bp::arg("level")=0))
+      .def("height", &MipmapTexture::height, (bp::arg("level")=0))
+      .def("nbLevels", &MipmapTexture::nbLevels)
+      .def("isEmpty", &MipmapTexture::isEmpty)
+      .def("getMemorySize", &MipmapTexture::getMemorySize)
+      .def("getTexelAt", &MipmapTexture::getTexelAt, (bp::arg("x"), bp::arg("y"), bp::arg("level")=0))
+      .def("getLevelOfDetail", &MipmapTexture::getLevelOfDetail, (bp::arg("uvarea"), bp::arg("rasterarea")))
+      .def("sample", (Color4(MipmapTexture::*)(real_t, real_t, real_t, bool, bool) const)&MipmapTexture::sample, (bp::arg("u"), bp::arg("v"), bp::arg("lod")=0, bp::arg("repeatu")=true, bp::arg("repeatv")=true))
+      .def("get", &MipmapTexture::get, (bp::arg("imagetexture")), "get(imagetexture) - Return the texture of an ImageTexture from the cache shared by all the engines.")
+      .staticmethod("get")
+      .def("setCacheMaxSize", &MipmapTexture::setCacheMaxSize, (bp::arg("maxsize")))
+      .staticmethod("setCacheMaxSize")
+      .def("getCacheMaxSize", &MipmapTexture::getCacheMaxSize)
+      .staticmethod("getCacheMaxSize")
+      .def("getCacheSize", &MipmapTexture::getCacheSize)
+      .staticmethod("getCacheSize")
+      .def("getCacheHits", &MipmapTexture::getCacheHits)
+      .staticmethod("getCacheHits")
+      .def("getCacheMisses", &MipmapTexture::getCacheMisses)
+      .staticmethod("getCacheMisses")
+      .def("clearCache", &MipmapTexture::clearCache)
+      .staticmethod("clearCache")
+      ;
 }
@@ -62,6 +62,7 @@ void module_algo()
     export_BBoxComputer();
     export_VolComputer();
     export_SurfComputer();
+    export_StatisticComputer();
     export_AmapTranslator();
     export_MatrixComputer();
     export_WireComputer();
@@ -69,6 +70,8 @@ void module_algo()
     // custom algo
     export_Merge();
     export_Fit();
+    export_InstancedScene();
+    export_CompiledScene();
 
     // abstract printer export
     export_StrPrinter();
@@ -95,6 +98,7 @@ void module_algo()
     export_ProjectionEngine();
     export_ZBufferEngine();
     export_DepthSortEngine();
+    export_ProjectionStatistics();
     export_ProjectionRenderer();
 
     // Turtle export
@@ -111,6 +115,7 @@ void module_algo()
     export_SegIntersection();
     export_Ray();
     export_RayIntersection();
+    export_BVHRayIntersection();
     export_Intersection();
 
     // Grid export
@@ -60,6 +60,13 @@ RCPtr<T> extract_array_from_list( boost::python::object l )
   return extract_pgllist<T>(l).toRCPtr(true);
 }
 
+// Conversion of a numpy array into an array of type T, without going through python sequences.
+// Specialized by EXPORT_NUMPY. Return a null pointer if obj cannot be converted this way.
+template<class T>
+struct array_from_numpy {
+  static RCPtr<T> convert( PyObject * obj ) { return RCPtr<T>(); }
+};
+
 template<class T>
 struct array_from_list {
   array_from_list() {
@@ -74,8 +81,11 @@ struct array_from_list {
    vector_storage_t* the_storage = reinterpret_cast<vector_storage_t*>( data );
    void* memory_chunk = the_storage->storage.bytes;
    if (obj != Py_None){
-        boost::python::list py_sequence( boost::python::handle<PyObject>( boost::python::borrowed( obj ) ) );
-        RCPtr<T> result= extract_array_from_list<T>(py_sequence);
+        RCPtr<T> result = array_from_numpy<T>::convert(obj);
+        if (!result) {
+            boost::python::list py_sequence( boost::python::handle<PyObject>( boost::python::borrowed( obj ) ) );
+            result = extract_array_from_list<T>(py_sequence);
+        }
         new (memory_chunk) T (*result);
    }
    else { new (memory_chunk) T(0); }
@@ -98,8 +108,11 @@ struct array_ptr_from_list {
    void* memory_chunk = the_storage->storage.bytes;
    RCPtr<T> result;
    if (obj != Py_None){
-    boost::python::list py_sequence( boost::python::handle<PyObject>( boost::python::borrowed( obj ) ) );
-    result = extract_array_from_list<T>(py_sequence);
+    result = array_from_numpy<T>::convert(obj);
+    if (!result) {
+      boost::python::list py_sequence( boost::python::handle<PyObject>( boost::python::borrowed( obj ) ) );
+      result = extract_array_from_list<T>(py_sequence);
+    }
    }
    new (memory_chunk) RCPtr<T> (result);
    data->convertible = memory_chunk;
@@ -124,6 +137,10 @@ std::string PREFIX##_str( ARRAY * a ) \
   return ss.str(); \
 } \
 
+template<class T>
+size_t array_bufferid( T * a )
+{ return (size_t)a->getBufferId(); }
+
 template<class T>
 typename T::element_type array_bt_getitem( T * a, int pos )
 {
@@ -133,12 +150,15 @@ typename T::element_type array_bt_getitem( T * a, int pos )
   else throw PythonExc_IndexError();
 }
 
+/* The returned element is a copy of the element of the array.
+   Reading it thus keeps the elements shared with the copies of the array. */
 template<class T>
-typename T::element_type& array_ct_getitem( T * a, int pos )
+typename T::element_type array_ct_getitem( T * a, int pos )
 {
-  size_t len = a->size();
-  if( pos < 0 && pos >= -(int)len ) return a->getAt( len + pos );
-  else if( pos < len ) return a->getAt( pos );
+  const T& ca = *a;
+  size_t len = ca.size();
+  if( pos < 0 && pos >= -(int)len ) return ca.getAt( len + pos );
+  else if( pos < len ) return ca.getAt( pos );
   else throw PythonExc_IndexError();
 }
 
@@ -385,6 +405,15 @@ template<class T>
 size_t array_id( T * a )
 { return (size_t)a; }
 
+/* Iteration through const iterators, which do not copy the shared elements of the array. */
+template<class T>
+typename T::const_iterator array_cbegin( const T& a )
+{ return a.begin(); }
+
+template<class T>
+typename T::const_iterator array_cend( const T& a )
+{ return a.end(); }
+
 template <class T>
 boost::python::object py_split(T * pts, boost::python::object split_method){
     boost::python::dict result;
@@ -601,10 +630,11 @@ class array_func : public boost::python::def_visitor<array_func<ARRAY> >
         .def( "__add__",      &array_addarray<ARRAY>   , boost::python::return_value_policy<boost::python::manage_new_object>() ) \
         .def( "__iadd__",     &array_iaddarray<ARRAY> , boost::python::return_internal_reference<1>() ) \
         .def( "__len__",      &array_len<ARRAY> ) \
-        .def( "__iter__",     boost::python::iterator<ARRAY>() ) \
+        .def( "__iter__",     boost::python::range(&array_cbegin<ARRAY>, &array_cend<ARRAY>) ) \
         .def( "empty",        &ARRAY::empty ) \
         .def( "reverse",      &ARRAY::reverse ) \
         .def( "clear",        &ARRAY::clear ) \
+        .def( "touch",        &ARRAY::touch, "Mark the array as modified, for instance after writes through a numpy view of its elements." ) \
         .def( "insert",       &array_insertitem<ARRAY> ) \
         .def( "append",       &array_appenditem<ARRAY> ) \
         .def( "append",       &array_appendarray<ARRAY> ) \
@@ -638,7 +668,7 @@ class array_func : public boost::python::def_visitor<array_func<ARRAY> >
     EXPORT_ARRAY_FUNC_COMMON( ARRAY, PREFIX ) \
 
 #define EXPORT_ARRAY_FUNC_CT( ARRAY, PREFIX ) \
-    .def( "__getitem__",  &array_ct_getitem<ARRAY>, return_internal_reference<1>() ) \
+    .def( "__getitem__",  &array_ct_getitem<ARRAY> ) \
     EXPORT_ARRAY_FUNC_COMMON( ARRAY, PREFIX ) \
     EXPORT_ARRAY_IO_FUNC( ARRAY )
 
@@ -652,6 +682,9 @@ class array_func : public boost::python::def_visitor<array_func<ARRAY> >
 #define EXPORT_CLASS_ARRAY( PREFIX, ARRAY, STRING )\
 class_< ARRAY, ARRAY##Ptr, bases<RefCountObject> >( #ARRAY , init<size_t>(#ARRAY "(int size)", args("size") ) ) \
     .def( "__init__", make_constructor( &extract_array_from_list<ARRAY> ), STRING ) \
+    .def( "isShared",     &ARRAY::isShared, "Return whether the elements are shared with a copy of the array. They are copied at the first modification." ) \
+    .def( "getBufferId",  &array_bufferid<ARRAY>, "Return an identifier of the buffer of the elements. Arrays sharing their elements have the same identifier." ) \
+    .def( "getMemorySize", &ARRAY::getMemorySize, "Return the number of bytes allocated for the elements." ) \
 
 
 /* --------------------
@@ -681,132 +714,120 @@ class_< ARRAY, ARRAY##Ptr, bases<RefCountObject> >( #ARRAY , init<size_t>(#ARRAY
   DEF_POINTEE( ARRAY ) \
   EXPORT_FUNCTION2( PREFIX, ARRAY)
 
-#ifdef USE_NUMPY
-#define PY_ARRAY_UNIQUE_SYMBOL PlantGL_NUMPY_API_SYMBOL
-#define NO_IMPORT_ARRAY
-#include <numpy/arrayobject.h>
-#include <sstream>
-
-#define CHECK_TYPE( store, C_TYPE )\
-  if( typeid( C_TYPE ) == typeid( int ) )\
-    store = PyArray_INT; \
-  else if( typeid( C_TYPE ) == typeid( unsigned int ) )\
-    store = PyArray_UINT; \
-  else if( typeid( C_TYPE ) == typeid( long ) )\
-    store = PyArray_LONG; \
-  else if( typeid( C_TYPE ) == typeid( unsigned long ) )\
-    store = PyArray_ULONG; \
-  else if( typeid( C_TYPE ) == typeid( char ) )\
-    store = PyArray_BYTE; \
-  else if( typeid( C_TYPE ) == typeid( unsigned char ) )\
-    store = PyArray_UBYTE; \
-  else if( typeid( C_TYPE ) == typeid( float ) )\
-    store = PyArray_FLOAT; \
-  else if( typeid( C_TYPE ) == typeid( double ) )\
-    store = PyArray_DOUBLE; \
-  else\
-    {\
-    PyErr_SetString( PyExc_ValueError, "Error, the wanted type is unknown" );\
-    throw error_already_set();\
-    }
+#if PGL_WITH_BOOST_NUMPY
+#include <boost/python/numpy.hpp>
+#include <cstring>
+
+// Components of an element of an array : the element itself for arrays of scalars, the data of the tuple otherwise.
+template<class T, class C>
+struct numpy_components {
+  static C * get( T& elmt ) { return elmt.data(); }
+};
+
+template<class C>
+struct numpy_components<C,C> {
+  static C * get( C& elmt ) { return &elmt; }
+};
+
+template<class V>
+void release_nparray_buffer( PyObject * capsule )
+{
+  delete static_cast<std::shared_ptr<V> *>( PyCapsule_GetPointer( capsule, NULL ) );
+}
+
+/* Numpy view, with no copy, on the NBCOMPONENTS components of the elements of the array held by self
+   (NBCOMPONENTS = 0 for arrays of scalars). Vectors have a virtual table, so the view is strided.
+   The view keeps the buffer of the array alive. A resize of the array gives it a new buffer,
+   and the view then keeps the elements it had before. */
+template<class ARRAY, class C, int NBCOMPONENTS>
+boost::python::numpy::ndarray array_to_nparray( boost::python::object self )
+{
+  typedef typename ARRAY::element_type T;
+  typedef std::vector<T> buffer_type;
+  static C empty;
+  ARRAY * a = boost::python::extract<ARRAY *>(self)();
+  // the view writes in the buffer of the array that is thus no more shared with its copies.
+  std::shared_ptr<buffer_type> buffer = a->getBuffer();
+  C * data = ( buffer->empty() ? &empty : numpy_components<T,C>::get( buffer->front() ) );
+  boost::python::object owner( boost::python::handle<>( PyCapsule_New( new std::shared_ptr<buffer_type>( buffer ), NULL, &release_nparray_buffer<buffer_type> ) ) );
+  boost::python::tuple shape, strides;
+  if ( NBCOMPONENTS == 0 ) {
+    shape = boost::python::make_tuple( buffer->size() );
+    strides = boost::python::make_tuple( sizeof(T) );
+  }
+  else {
+    shape = boost::python::make_tuple( buffer->size(), NBCOMPONENTS );
+    strides = boost::python::make_tuple( sizeof(T), sizeof(C) );
+  }
+  return boost::python::numpy::from_data( data, boost::python::numpy::dtype::get_builtin<C>(), shape, strides, owner );
+}
+
+/* Build an array from a numpy array of shape (n) or (n, NBCOMPONENTS). The numpy array is cast
+   to C if needed, then copied in a single block if the elements are not padded. */
+template<class ARRAY, class C, int NBCOMPONENTS>
+RCPtr<ARRAY> array_from_nparray( const boost::python::numpy::ndarray& data )
+{
+  namespace np = boost::python::numpy;
+  typedef typename ARRAY::element_type T;
+  const int nbcomponents = ( NBCOMPONENTS == 0 ? 1 : NBCOMPONENTS );
+  if ( NBCOMPONENTS == 0 && data.get_nd() != 1 )
+    throw PythonExc_ValueError( "The numpy array must have 1 dimension." );
+  if ( NBCOMPONENTS != 0 && ( data.get_nd() != 2 || data.shape(1) != NBCOMPONENTS ) )
+    throw PythonExc_ValueError( "The numpy array must be of shape (n, k) with k the number of components of the elements." );
+  np::dtype dt = np::dtype::get_builtin<C>();
+  np::ndarray cdata = data;
+  if ( !np::equivalent( data.get_dtype(), dt ) || !( data.get_flags() & np::ndarray::C_CONTIGUOUS ) )
+    cdata = data.astype( dt );
+  size_t nbelements = cdata.shape(0);
+  RCPtr<ARRAY> result( new ARRAY( nbelements ) );
+  const C * src = reinterpret_cast<const C *>( cdata.get_data() );
+  if ( nbelements == 0 ) return result;
+  if ( sizeof(T) == nbcomponents * sizeof(C) )
+    memcpy( numpy_components<T,C>::get( *result->begin() ), src, nbelements * sizeof(T) );
+  else
+    for ( typename ARRAY::iterator it = result->begin(); it != result->end(); ++it, src += nbcomponents )
+      std::copy( src, src + nbcomponents, numpy_components<T,C>::get( *it ) );
+  return result;
+}
+
+template<class ARRAY, class C, int NBCOMPONENTS>
+struct array_from_numpy_impl {
+  static RCPtr<ARRAY> convert( PyObject * obj ) {
+    boost::python::object pyobj( boost::python::handle<>( boost::python::borrowed( obj ) ) );
+    boost::python::extract<boost::python::numpy::ndarray> data( pyobj );
+    if ( !data.check() ) return RCPtr<ARRAY>();
+    return array_from_nparray<ARRAY, C, NBCOMPONENTS>( data() );
+  }
+};
+
+// Implementation of __array__ : a view of the array, cast or copied only if asked.
+template<class ARRAY, class C, int NBCOMPONENTS>
+boost::python::object array_nparray_protocol( boost::python::object self, boost::python::object dtype, boost::python::object copy )
+{
+  boost::python::numpy::ndarray view = array_to_nparray<ARRAY, C, NBCOMPONENTS>( self );
+  if ( dtype != boost::python::object() )
+    return view.astype( boost::python::numpy::dtype( dtype ) );
+  if ( copy != boost::python::object() && boost::python::extract<bool>( copy )() )
+    return view.copy();
+  return view;
+}
 
 #define EXPORT_NUMPY( PREFIX, T, ARRAY, DIM0, DIM1, C_TYPE ) \
-ARRAY##Ptr PREFIX##_fromnumpy( boost::python::object l ) \
-{\
-  size_t dim0 = DIM0;\
-  size_t dim1 = DIM1;\
-  PyObject* obj = l.ptr(); \
-  if( PyArray_Check( obj ) ) \
-    { \
-    PyArrayObject *a_obj = ( PyArrayObject* )obj; \
-    if( a_obj->nd != 2 )\
-      {\
-      PyErr_SetString(PyExc_TypeError, "The array as argument must have 2 dimensions" );\
-      throw error_already_set();\
-      }\
-    if( dim0 != 0 && a_obj->dimensions[ 0 ] != dim0 ) \
-      {\
-      std::stringstream ss;\
-      ss << "The first dimension of the argument must be of size " << dim0;\
-      PyErr_SetString(PyExc_TypeError, ss.str().c_str() );\
-      throw error_already_set();\
-      }\
-    if( dim1 != 0 && a_obj->dimensions[ 1 ] != dim1 ) \
-      {\
-      std::stringstream ss;\
-      ss << "The second dimension of the argument must be of size " << dim1;\
-      PyErr_SetString(PyExc_TypeError, ss.str().c_str() );\
-      throw error_already_set();\
-      }\
-    int a_type = 0; \
-    int a_require = NPY_CONTIGUOUS|NPY_FORCECAST; \
-    CHECK_TYPE( a_type, C_TYPE );\
-    PyObject *array = PyArray_FromArray( a_obj, PyArray_DescrFromType( a_type ), a_require ); \
-    if( array == NULL )\
-      {\
-      throw error_already_set();\
-      }\
-    int nb_elmt0 = PyArray_DIM( array, 0 ); \
-    int nb_elmt1 = PyArray_DIM( array, 1 ); \
-    int i, j; \
-    ARRAY##Ptr result = new ARRAY( nb_elmt0 ); \
-    for( i = 0 ; i < nb_elmt0 ; ++i ) \
-      {\
-      T elmt( nb_elmt1 );\
-      for( j = 0 ; j < nb_elmt1 ; ++j )\
-        {\
-        elmt.setAt( j, *( C_TYPE* )PyArray_GETPTR2( array, i, j ) );\
-        }\
-      result->setAt( i, elmt );\
-      }\
-    Py_DECREF( array );\
-    return result;\
-    } \
-  return PREFIX##_fromlist( l ); \
-}\
+template<> struct array_from_numpy<ARRAY> : array_from_numpy_impl<ARRAY, C_TYPE, DIM1> { }; \
+ARRAY##Ptr PREFIX##_fromnumpy( boost::python::numpy::ndarray data ) \
+{ return array_from_nparray<ARRAY, C_TYPE, DIM1>( data ); } \
+boost::python::numpy::ndarray PREFIX##_tonumpy( boost::python::object self ) \
+{ return array_to_nparray<ARRAY, C_TYPE, DIM1>( self ); } \
+boost::python::object PREFIX##_nparray( boost::python::object self, boost::python::object dtype, boost::python::object copy ) \
+{ return array_nparray_protocol<ARRAY, C_TYPE, DIM1>( self, dtype, copy ); } \
 
 #define EXPORT_NUMPY_1DIM( PREFIX, T, ARRAY, DIM, C_TYPE ) \
-ARRAY##Ptr PREFIX##_fromnumpy( boost::python::object l ) \
-{\
-  size_t dim = DIM;\
-  PyObject* obj = l.ptr(); \
-  if( PyArray_Check( obj ) ) \
-    { \
-    PyArrayObject *a_obj = ( PyArrayObject* )obj; \
-    if( a_obj->nd != 1 )\
-      {\
-      PyErr_SetString(PyExc_TypeError, "The array as argument must have 1 dimension" );\
-      throw error_already_set();\
-      }\
-    if( dim != 0 && a_obj->dimensions[ 0 ] != dim ) \
-      {\
-      std::stringstream ss;\
-      ss << "The argument must be of size " << dim;\
-      PyErr_SetString(PyExc_TypeError, ss.str().c_str() );\
-      throw error_already_set();\
-      }\
-    int a_type = 0; \
-    int a_require = NPY_CONTIGUOUS|NPY_FORCECAST; \
-    CHECK_TYPE( a_type, C_TYPE );\
-    PyObject *array = PyArray_FromArray( a_obj, PyArray_DescrFromType( a_type ), a_require ); \
-    if( array == NULL )\
-      {\
-      throw error_already_set();\
-      }\
-    int nb_elmt = PyArray_DIM( array, 0 ); \
-    int i, j; \
-    ARRAY##Ptr result = new ARRAY( nb_elmt ); \
-    for( i = 0 ; i < nb_elmt ; ++i ) \
-      {\
-      result->setAt( i, *( C_TYPE*) PyArray_GETPTR1( array, i ) );\
-      }\
-    Py_DECREF( array );\
-    return result;\
-    } \
-  return PREFIX##_fromlist( l ); \
-}\
+  EXPORT_NUMPY( PREFIX, T, ARRAY, DIM, 0, C_TYPE )
 
-#define DEFINE_NUMPY( PREFIX ) .def( "__init__", make_constructor( PREFIX##_fromnumpy ) )
+#define DEFINE_NUMPY( PREFIX ) \
+  .def( "__init__", make_constructor( PREFIX##_fromnumpy ), "Build from a numpy array, copying its buffer at once." ) \
+  .def( "to_array", &PREFIX##_tonumpy, "Return a numpy array sharing the data of the array, with no copy. After a resize of the array, the numpy array keeps the previous elements." ) \
+  .def( "__array__", &PREFIX##_nparray, ( boost::python::arg("dtype") = boost::python::object(), boost::python::arg("copy") = boost::python::object() ) )
 
 #else
 
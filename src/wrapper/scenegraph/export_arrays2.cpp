@@ -68,8 +68,10 @@ EXPORT_FUNCTION( p4m, Point4Matrix )
 EXPORT_FUNCTION( ra,  RealArray2 )
 
 #if PGL_WITH_BOOST_NUMPY
-np::ndarray array_to_nparray(RealArray2 * data)
+// The returned array shares the memory of the RealArray2 and keeps it alive.
+np::ndarray ra2_to_nparray(bp::object self)
 {
+    RealArray2 * data = bp::extract<RealArray2 *>(self)();
     np::dtype dt = np::dtype::get_builtin<real_t>();
     size_t s = sizeof(real_t);
 
@@ -77,7 +79,7 @@ np::ndarray array_to_nparray(RealArray2 * data)
                                       dt,
                                       bp::make_tuple(data->getColumnSize(), data->getRowSize()),
                                       bp::make_tuple(data->getRowSize()*s, s),
-                                      bp::object());
+                                      self);
     return array;
 }
 #endif
@@ -107,7 +109,7 @@ void export_arrays2()
   EXPORT_ARRAY_BT( ra, RealArray2 )
    .def(numarray2_func<RealArray2>())
 #if PGL_WITH_BOOST_NUMPY
-   .def("to_array",&array_to_nparray)
+   .def("to_array",&ra2_to_nparray)
 #endif
    .def("threshold_max_values",&threshold_max_values)
    .def("threshold_min_values",&threshold_min_values);
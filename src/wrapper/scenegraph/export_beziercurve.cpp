@@ -93,6 +93,7 @@ void export_BezierCurve()
     .def( "__repr__", gbc_repr )
     .DEC_BT_NR_PROPERTY_WDV(stride,BezierCurve,Stride,uint_t,DEFAULT_STRIDE)
     .DEC_PTR_PROPERTY(ctrlPointList,BezierCurve,CtrlPointList,Point4ArrayPtr)
+    .def("getPointsAt",&BezierCurve::getPointsAt,args("u"),"Compute the points of the curve for all the parameter values of u.")
     .def("bernstein_factors",&bernstein_factors,args("n","u"),
     "[float] bernstein_factors( int n, float u )"
     "Computes the n + 1 th degree Bernstein polynomials for a fixed u."
@@ -133,6 +134,7 @@ void export_BezierCurve2D()
     .def( "__repr__", gbc2_repr )
     .DEC_BT_NR_PROPERTY_WD(stride,BezierCurve2D,Stride,uint_t)
     .DEC_PTR_PROPERTY(ctrlPointList,BezierCurve2D,CtrlPointList,Point3ArrayPtr)
+    .def("getPointsAt",&BezierCurve2D::getPointsAt,args("u"),"Compute the points of the curve for all the parameter values of u.")
     .DEF_PGLBASE(BezierCurve2D)
     ;
 
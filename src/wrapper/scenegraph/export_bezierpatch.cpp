@@ -43,6 +43,7 @@
 
 #include <plantgl/scenegraph/geometry/bezierpatch.h>
 #include <plantgl/scenegraph/container/pointmatrix.h>
+#include <plantgl/scenegraph/container/pointarray.h>
 #include <plantgl/scenegraph/geometry/lineicmodel.h>
 
 
@@ -82,6 +83,7 @@ void export_BezierPatch()
     .add_static_property("DEFAULT_STRIDE",make_getter(&BezierPatch::DEFAULT_STRIDE))
     .DEC_PTR_PROPERTY(ctrlPointMatrix,BezierPatch,CtrlPointMatrix,Point4MatrixPtr)
     .def("getPointAt",&BezierPatch::getPointAt)
+    .def("getPointsAt",&BezierPatch::getPointsAt,args("u","v"),"Compute the points of the patch on the grid of parameter values u x v. The point of u[i] and v[j] is at index i * len(v) + j.")
     .def("getIsoUSectionAt",&BezierPatch::getIsoUSectionAt,args("u"),"Compute a section line of the patch corresponding to a constant u value.")
     .def("getIsoVSectionAt",&BezierPatch::getIsoVSectionAt,args("v"),"Compute a section line of the patch corresponding to a constant v value.")
     ;
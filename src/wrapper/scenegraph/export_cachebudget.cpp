@@ -0,0 +1,77 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include <boost/python.hpp>
+#include <plantgl/tool/util_cache.h>
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+
+dict py_cachebudget_statistics() {
+  dict res;
+  std::vector<CacheBudget::AccountStatistics> accounts = CacheBudget::statistics();
+  for (std::vector<CacheBudget::AccountStatistics>::const_iterator it = accounts.begin(); it != accounts.end(); ++it) {
+    dict stat;
+    stat["size"] = it->entries;
+    stat["cost"] = it->cost;
+    stat["evictions"] = it->evictions;
+    res[it->name] = stat;
+  }
+  return res;
+}
+
+void export_CacheBudget() {
+  class_<CacheBudget, boost::noncopyable>("CacheBudget",
+      "The memory held by the caches of the algorithms (Discretizer, BBoxComputer, MipmapTexture, ...), with an optional soft limit. "
+      "When the total cost of the caches exceeds the soft limit, the caches evict their least recently used entries the next time they are filled.",
+      no_init)
+    .def("statistics", &py_cachebudget_statistics, "Return a dict with the number of entries, the cost in bytes and the number of evictions of each kind of cache.")
+    .staticmethod("statistics")
+    .def("getTotalCost", &CacheBudget::getTotalCost, "Return the total cost in bytes of the entries of all the caches.")
+    .staticmethod("getTotalCost")
+    .def("setSoftLimit", &CacheBudget::setSoftLimit, args("limit"))
+    .staticmethod("setSoftLimit")
+    .def("getSoftLimit", &CacheBudget::getSoftLimit)
+    .staticmethod("getSoftLimit")
+    .def("trim", &CacheBudget::trim, "Evict the least recently used entries of the caches until the total cost is under the soft limit. "
+         "The caches shared by several threads are trimmed at once, the other ones the next time they are used.")
+    .staticmethod("trim")
+    ;
+}
@@ -0,0 +1,153 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+
+
+#include <plantgl/python/export_refcountptr.h>
+#include <plantgl/python/exception.h>
+
+#include <plantgl/scenegraph/container/indexarray.h>
+#include <boost/python.hpp>
+#include <boost/python/make_constructor.hpp>
+#include <limits>
+
+#if PGL_WITH_BOOST_NUMPY
+#include <boost/python/numpy.hpp>
+#define np boost::python::numpy
+#endif
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+#define bp boost::python
+
+DEF_POINTEE(CSRIndexArray)
+
+CSRIndexArrayPtr csr_from_indexarray(const IndexArrayPtr& array)
+{ return CSRIndexArrayPtr(new CSRIndexArray(*array)); }
+
+Index csr_getitem(CSRIndexArray * array, int pos)
+{
+    if (pos < 0) pos += array->size();
+    if (pos < 0 || pos >= int(array->size())) throw PythonExc_IndexError();
+    CSRIndexArray::IndexRange range = array->getAt(pos);
+    return Index(range.begin(), range.end());
+}
+
+#if PGL_WITH_BOOST_NUMPY
+// The returned arrays share the memory of the CSRIndexArray and keep it alive.
+np::ndarray csr_buffer_to_nparray(bp::object self, const std::vector<uint_t>& buffer)
+{
+    return np::from_data(buffer.data(),
+                         np::dtype::get_builtin<uint_t>(),
+                         bp::make_tuple(buffer.size()),
+                         bp::make_tuple(sizeof(uint_t)),
+                         self);
+}
+
+np::ndarray csr_offsets(bp::object self)
+{ return csr_buffer_to_nparray(self, bp::extract<CSRIndexArray *>(self)()->getOffsets()); }
+
+np::ndarray csr_indices(bp::object self)
+{ return csr_buffer_to_nparray(self, bp::extract<CSRIndexArray *>(self)()->getIndices()); }
+
+// Copies a 1-D numpy array in buffer, casting it to uint_t only if needed.
+void csr_buffer_from_nparray(const np::ndarray& data, std::vector<uint_t>& buffer)
+{
+    if (data.get_nd() != 1) throw PythonExc_ValueError("The offsets and indices must be numpy arrays of 1 dimension.");
+    if (np::equivalent(data.get_dtype(), np::dtype::get_builtin<uint_t>()) && (data.get_flags() & np::ndarray::C_CONTIGUOUS)) {
+        const uint_t * src = reinterpret_cast<const uint_t *>(data.get_data());
+        buffer.assign(src, src + data.shape(0));
+    }
+    else {
+        // The values are checked before being cast, which would wrap the negative ones.
+        np::ndarray cdata = data.astype(np::dtype::get_builtin<int64_t>());
+        const int64_t * src = reinterpret_cast<const int64_t *>(cdata.get_data());
+        buffer.resize(cdata.shape(0));
+        for (std::vector<uint_t>::iterator it = buffer.begin(); it != buffer.end(); ++it, ++src) {
+            if (*src < 0) throw PythonExc_ValueError("The offsets and indices must be positive.");
+            if (*src > int64_t(std::numeric_limits<uint_t>::max())) throw PythonExc_IndexError("Offset or index out of range.");
+            *it = uint_t(*src);
+        }
+    }
+}
+
+CSRIndexArrayPtr csr_from_nparray_nbpoints(np::ndarray offsets, np::ndarray indices, uint_t nbpoints)
+{
+    // The buffers are filled in place and checked before any use of the array.
+    CSRIndexArrayPtr result(new CSRIndexArray());
+    csr_buffer_from_nparray(offsets, result->getOffsets());
+    csr_buffer_from_nparray(indices, result->getIndices());
+    if (!result->isValid()) throw PythonExc_ValueError("Invalid offsets for the given indices.");
+    const std::vector<uint_t>& resindices = result->getIndices();
+    for (std::vector<uint_t>::const_iterator it = resindices.begin(); it != resindices.end(); ++it)
+        if (*it >= nbpoints) throw PythonExc_IndexError("Index out of range of the points.");
+    return result;
+}
+
+// Without a number of points, the indices refer to the elements of the array, as in an adjacency graph.
+CSRIndexArrayPtr csr_from_nparray(np::ndarray offsets, np::ndarray indices)
+{
+    if (offsets.get_nd() == 1 && offsets.shape(0) > 0)
+        return csr_from_nparray_nbpoints(offsets, indices, uint_t(offsets.shape(0) - 1));
+    return csr_from_nparray_nbpoints(offsets, indices, 0);
+}
+#endif
+
+void export_csrindexarray()
+{
+  class_< CSRIndexArray, CSRIndexArrayPtr, boost::noncopyable >( "CSRIndexArray", 
+      "An array of indices of non fixed size stored in compressed sparse row format : all the indices are contiguous in a single buffer and offsets give the bounds of each element.", 
+      init<>() )
+    .def( "__init__", make_constructor( csr_from_indexarray ) )
+#if PGL_WITH_BOOST_NUMPY
+    .def( "__init__", make_constructor( csr_from_nparray ), "CSRIndexArray(offsets, indices) : build from numpy arrays. The indices must refer to the elements of the array." )
+    .def( "__init__", make_constructor( csr_from_nparray_nbpoints ), "CSRIndexArray(offsets, indices, nbpoints) : build from numpy arrays. The indices must be lower than nbpoints." )
+    .add_property( "offsets", &csr_offsets )
+    .add_property( "indices", &csr_indices )
+#endif
+    .def( "__len__", &CSRIndexArray::size )
+    .def( "__getitem__", &csr_getitem )
+    .def( "getNbIndices", &CSRIndexArray::getNbIndices )
+    .def( "getIndexSizeAt", &CSRIndexArray::getIndexSizeAt )
+    .def( "isValid", &CSRIndexArray::isValid )
+    .def( "toIndexArray", &CSRIndexArray::toIndexArray )
+    ;
+  implicitly_convertible< CSRIndexArrayPtr, RefCountObjectPtr >();
+}
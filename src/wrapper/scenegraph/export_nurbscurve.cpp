@@ -122,12 +122,12 @@ void export_NurbsCurve()
      .staticmethod("interpol")
      .def( "getDerivativeAt", &NurbsCurve::getDerivativeAt, args("u","d") )
      .def( "getDerivativesAt", &NurbsCurve::getDerivativesAt, args("u") )
-     .def( "findSpan", &findSpan, args("u","degree","knotList"),
+     .def( "findSpan", (uint_t(*)(real_t,uint_t,const RealArrayPtr&))&findSpan, args("u","degree","knotList"),
            "int findSpan(float u,  int degree,  [float] knotList)."
            "Determine the knot Span index at a given u for degree and on the knot vector knotList."
            "See the Nurbs Book : A2.1 p68" )
      .staticmethod("findSpan")
-     .def( "basisFunctions", &basisFunctions, args("span","u","degree","knotList"),
+     .def( "basisFunctions", (RealArrayPtr(*)(uint_t,real_t,uint_t,const RealArrayPtr&))&basisFunctions, args("span","u","degree","knotList"),
         "[float] basisFunctions(int span, float u, int  degree, [float] knotList)."
         "Compute the Basis Functions values at a given u for degree and on the knot vector knotList."
         "See Algo 2.2 From The Nurbs Book p70.")
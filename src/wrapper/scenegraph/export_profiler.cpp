@@ -0,0 +1,95 @@
+/* -*-c++-*-
+ *  ----------------------------------------------------------------------------
+ *
+ *       PlantGL: The Plant Graphic Library
+ *
+ *       Copyright CIRAD/INRIA/INRA
+ *
+ *       File author(s): F. Boudon (frederic.boudon@cirad.fr) et al. 
+ *
+ *  ----------------------------------------------------------------------------
+ *
+ *   This software is governed by the CeCILL-C license under French law and
+ *   abiding by the rules of distribution of free software.  You can  use, 
+ *   modify and/ or redistribute the software under the terms of the CeCILL-C
+ *   license as circulated by CEA, CNRS and INRIA at the following URL
+ *   "http://www.cecill.info". 
+ *
+ *   As a counterpart to the access to the source code and  rights to copy,
+ *   modify and redistribute granted by the license, users are provided only
+ *   with a limited warranty  and the software's author,  the holder of the
+ *   economic rights,  and the successive licensors  have only  limited
+ *   liability. 
+ *       
+ *   In this respect, the user's attention is drawn to the risks associated
+ *   with loading,  using,  modifying and/or developing or reproducing the
+ *   software by the user in light of its specific status of free software,
+ *   that may mean  that it is complicated to manipulate,  and  that  also
+ *   therefore means  that it is reserved for developers  and  experienced
+ *   professionals having in-depth computer knowledge. Users are therefore
+ *   encouraged to load and test the software's suitability as regards their
+ *   requirements in conditions enabling the security of their systems and/or 
+ *   data to be ensured and,  more generally, to use and operate it in the 
+ *   same conditions as regards security. 
+ *
+ *   The fact that you are presently reading this means that you have had
+ *   knowledge of the CeCILL-C license and that you accept its terms.
+ *
+ *  ----------------------------------------------------------------------------
+ */
+
+#include <boost/python.hpp>
+#include <plantgl/tool/util_profiler.h>
+#include <plantgl/python/export_list.h>
+#include <sstream>
+
+PGL_USING_NAMESPACE
+using namespace boost::python;
+
+boost::python::object py_profiler_statistics() {
+  return make_list(Profiler::statistics())();
+}
+
+std::string py_zonestatistics_repr(const Profiler::ZoneStatistics& stat) {
+  std::stringstream ss;
+  ss << "ZoneStatistics('" << stat.path << "', count=" << stat.count
+     << ", wallTime=" << stat.wallTime << ", cpuTime=" << stat.cpuTime << ")";
+  return ss.str();
+}
+
+void export_Profiler() {
+  scope profiler = class_<Profiler, boost::noncopyable>("Profiler",
+      "A profiler of named and nested zones of the algorithms and codecs, measured in wall clock and thread CPU time.",
+      no_init)
+    .def("enable", &Profiler::enable, (boost::python::arg("enabled")=true))
+    .staticmethod("enable")
+    .def("disable", &Profiler::disable)
+    .staticmethod("disable")
+    .def("isEnabled", &Profiler::isEnabled)
+    .staticmethod("isEnabled")
+    .def("clear", &Profiler::clear, "Reset the statistics and the trace events.")
+    .staticmethod("clear")
+    .def("statistics", &py_profiler_statistics, "Return the statistics of the zones of all the threads, in depth-first order.")
+    .staticmethod("statistics")
+    .def("summary", &Profiler::summary, "Return the statistics as a table with one zone per line.")
+    .staticmethod("summary")
+    .def("chromeTrace", &Profiler::chromeTrace, "Return the trace events in the Chrome trace JSON format.")
+    .staticmethod("chromeTrace")
+    .def("saveChromeTrace", &Profiler::saveChromeTrace, args("fname"))
+    .staticmethod("saveChromeTrace")
+    .def("setMaxTraceEvents", &Profiler::setMaxTraceEvents, args("maxevents"))
+    .staticmethod("setMaxTraceEvents")
+    .def("getMaxTraceEvents", &Profiler::getMaxTraceEvents)
+    .staticmethod("getMaxTraceEvents")
+    ;
+
+  class_<Profiler::ZoneStatistics>("ZoneStatistics", no_init)
+    .def_readonly("path", &Profiler::ZoneStatistics::path)
+    .def_readonly("name", &Profiler::ZoneStatistics::name)
+    .def_readonly("depth", &Profiler::ZoneStatistics::depth)
+    .def_readonly("count", &Profiler::ZoneStatistics::count)
+    .def_readonly("wallTime", &Profiler::ZoneStatistics::wallTime)
+    .def_readonly("cpuTime", &Profiler::ZoneStatistics::cpuTime)
+    .def("__repr__", &py_zonestatistics_repr)
+    ;
+}
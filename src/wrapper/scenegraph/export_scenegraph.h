@@ -45,6 +45,7 @@
 
 void export_arrays();
 void export_arrays2();
+void export_csrindexarray();
 void export_index();
 void export_Color3();
 void export_Color4();
@@ -137,5 +138,7 @@ void export_Function();
 void export_Plane();
 
 void export_Progress();
+void export_Profiler();
+void export_CacheBudget();
 
 #endif
@@ -116,6 +116,7 @@ void module_sg()
 
     export_arrays();
     export_arrays2();
+    export_csrindexarray();
     export_index();
     export_Color3();
     export_Color4();
@@ -226,6 +227,8 @@ void module_sg()
     export_Plane();
 
     export_Progress();
+    export_Profiler();
+    export_CacheBudget();
 
     scope().attr("PGL_VERSION_STR") = getPGLVersionString();
     scope().attr("PGL_VERSION") = PGL_VERSION;
@@ -0,0 +1,34 @@
+""" Load and save throughput of the binary .bgeom format on a large mesh.
+
+    Usage: python bench_binary_io.py [nbpoints ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import os, random, sys, tempfile
+
+def make_scene(nbpoints):
+    random.seed(0)
+    points = Point3Array([Vector3(random.random(),random.random(),random.random()) for i in range(nbpoints)])
+    indices = Index3Array([Index3(i, (i+1) % nbpoints, (i+2) % nbpoints) for i in range(nbpoints)])
+    colors = Color4Array([Color4(i % 256, 0, 0, 255) for i in range(nbpoints)])
+    return Scene([Shape(TriangleSet(points, indices, colorList = colors, colorPerVertex = True), Material())])
+
+def bench(nbpoints):
+    scene = make_scene(nbpoints)
+    fname = os.path.join(tempfile.mkdtemp(), 'bench.bgeom')
+    t = perf_counter()
+    scene.save(fname)
+    tsave = perf_counter() - t
+    size = os.path.getsize(fname) / float(1 << 20)
+    t = perf_counter()
+    loaded = Scene(fname)
+    tload = perf_counter() - t
+    assert len(loaded[0].geometry.pointList) == nbpoints
+    os.remove(fname)
+    print('%10i points | %8.1f MB | save %7.3fs (%7.1f MB/s) | load %7.3fs (%7.1f MB/s)' %
+          (nbpoints, size, tsave, size / tsave, tload, size / tload))
+
+if __name__ == '__main__':
+    sizes = [int(float(v)) for v in sys.argv[1:]] or [int(1e5), int(1e6), int(1e7)]
+    for nbpoints in sizes:
+        bench(nbpoints)
@@ -0,0 +1,67 @@
+""" Benchmark of BVHRayIntersection against the per-Action RayIntersection path.
+
+    Usage: python bench_bvhrayintersection.py [nbtriangles ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def leaf_scene(nbtriangles, trianglespershape = 200):
+    """ A random canopy made of small spheres of about trianglespershape triangles. """
+    random.seed(0)
+    slices = max(3, int((trianglespershape / 2) ** 0.5))
+    nbshapes = max(1, nbtriangles // (2 * slices * slices))
+    size = nbshapes ** (1/3.)
+    geom = Sphere(0.4, slices, slices)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        scene.add(Shape(Translated(pos, geom), id = i))
+    return scene, size
+
+def random_rays(size, nbrays):
+    origins = Point3Array([Vector3(-1,random.uniform(0,size),random.uniform(0,size)) for i in range(nbrays)])
+    directions = Point3Array([Vector3(1,random.uniform(-0.2,0.2),random.uniform(-0.2,0.2)) for i in range(nbrays)])
+    return origins, directions
+
+def action_closest_hit(scene, ray):
+    ri = RayIntersection(Discretizer())
+    ri.setRay(ray)
+    best = None
+    for sh in scene:
+        if sh.apply(ri):
+            for p in ri.intersection:
+                dist = norm(p - ray.origin)
+                if best is None or dist < best:
+                    best = dist
+    return best
+
+def bench(nbtriangles, nbrays = 1000000, nbactionrays = 20):
+    scene, size = leaf_scene(nbtriangles)
+    t = perf_counter()
+    bvh = BVHRayIntersection(scene)
+    tbuild = perf_counter() - t
+    origins, directions = random_rays(size, nbrays)
+
+    t = perf_counter()
+    bvh.intersectRays(origins, directions)
+    tclosest = perf_counter() - t
+
+    t = perf_counter()
+    bvh.areOccluded(origins, directions)
+    tany = perf_counter() - t
+
+    # the per-Action path is far too slow to process all the rays: extrapolate.
+    t = perf_counter()
+    for o, d in zip(origins[:nbactionrays], directions[:nbactionrays]):
+        action_closest_hit(scene, Ray(o,d))
+    taction = (perf_counter() - t) * nbrays / nbactionrays
+
+    print('%10i triangles | build %7.2fs | closest hit %8.2f Mrays/s | any hit %8.2f Mrays/s | RayIntersection %10.6f Mrays/s (speedup x%.0f)' % 
+          (bvh.nbTriangles, tbuild, nbrays / tclosest / 1e6, nbrays / tany / 1e6, nbrays / taction / 1e6, taction / tclosest))
+
+if __name__ == '__main__':
+    sizes = [int(float(v)) for v in sys.argv[1:]] or [int(1e5), int(1e6), int(1e7)]
+    for nbtriangles in sizes:
+        bench(nbtriangles)
@@ -0,0 +1,38 @@
+""" Time and memory of the deep copy of a scene of meshes whose copy is then partially modified.
+
+    Usage: python bench_deepcopy.py [nbshapes [nbpoints]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import sys
+
+def meshes(nbshapes, nbpoints):
+    scene = Scene()
+    for i in range(nbshapes):
+        pts = Point3Array([(i, j, j % 2) for j in range(nbpoints)])
+        ind = Index3Array([Index3(j, j+1, j+2) for j in range(nbpoints-2)])
+        scene.add(Shape(TriangleSet(pts, ind), id = i))
+    return scene
+
+def memory(scene):
+    stat = StatisticComputer()
+    scene.apply(stat)
+    return stat.memorySize, stat.sharedMemorySize
+
+def bench(nbshapes, nbpoints, nbmodified = 10):
+    scene = meshes(nbshapes, nbpoints)
+    t = perf_counter()
+    copy = scene.deepcopy()
+    tcopy = perf_counter() - t
+    t = perf_counter()
+    for i in range(0, nbshapes, max(1, nbshapes // nbmodified)):
+        copy[i].geometry.pointList.append(Vector3(0,0,0))
+    tmodif = perf_counter() - t
+    size, shared = memory(copy)
+    print('%6i shapes of %6i points : deepcopy %.4fs, modification %.4fs, %.1f MB of which %.1f MB shared' %
+          (nbshapes, nbpoints, tcopy, tmodif, size / 1e6, shared / 1e6))
+
+if __name__ == '__main__':
+    nbshapes = int(sys.argv[1]) if len(sys.argv) > 1 else 1000
+    nbpoints = int(sys.argv[2]) if len(sys.argv) > 2 else 3000
+    bench(nbshapes, nbpoints)
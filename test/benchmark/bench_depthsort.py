@@ -0,0 +1,46 @@
+""" Scaling of the DepthSortEngine with the number of triangles and of threads.
+
+    Usage: python bench_depthsort.py [nbleaves ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def random_canopy(nbleaves):
+    """ A canopy of randomly placed and oriented triangular leaves, with a constant density. """
+    random.seed(0)
+    size = (nbleaves / 20.) ** (1/3.)
+    scene = Scene()
+    for i in range(nbleaves):
+        center = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        pts = [center + Vector3(random.uniform(-0.2,0.2),random.uniform(-0.2,0.2),random.uniform(-0.2,0.2)) for j in range(3)]
+        scene.add(Shape(TriangleSet(pts, [(0,1,2)]), Material(), i+1))
+    return scene, size
+
+def project(scene, size):
+    e = DepthSortEngine()
+    e.setOrthographicCamera(-size, size, -size, size, 0.1, 10*size)
+    e.lookAt((-3*size,size/2,size/2),(size/2,size/2,size/2),(0,0,1))
+    t = perf_counter()
+    e.process(scene)
+    return perf_counter() - t, e.getPolygonCount()
+
+def bench(nbleaves = [1000, 5000, 20000, 50000], nbthreads = [1, 2, 4, 8]):
+    initial = get_nb_threads()
+    for nb in nbleaves:
+        scene, size = random_canopy(nb)
+        tref = None
+        for nbthread in nbthreads:
+            set_nb_threads(nbthread)
+            t, nbpolygons = project(scene, size)
+            if tref is None: tref = t
+            print('%6i leaves | %3i threads | %8.3fs (x%5.2f) | %7.2f us/leaf | %i polygons' % 
+                  (nb, nbthread, t, tref / t, 1e6 * t / nb, nbpolygons))
+    set_nb_threads(initial)
+
+if __name__ == '__main__':
+    if len(sys.argv) > 1:
+        bench([int(v) for v in sys.argv[1:]])
+    else:
+        bench()
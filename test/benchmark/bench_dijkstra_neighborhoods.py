@@ -0,0 +1,58 @@
+""" Benchmark of repeated Dijkstra range queries (r_neighborhoods, k_neighborhoods) on LiDAR like point clouds.
+
+    Usage: python bench_dijkstra_neighborhoods.py [nbpoints ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+from math import cos, sin, pi
+import random
+import sys
+
+def lidar_cloud(nbpoints):
+    """ A noisy ground with a few trunks, sampled as a terrestrial scan would be. """
+    random.seed(0)
+    size = (nbpoints / 100.) ** 0.5
+    trunks = [(random.uniform(0,size),random.uniform(0,size)) for i in range(max(1,int(size / 5)))]
+    points = []
+    for i in range(nbpoints):
+        if i % 3 == 0:
+            x, y = random.choice(trunks)
+            a, h = random.uniform(0, 2*pi), random.uniform(0, 10)
+            points.append((x + 0.3*cos(a), y + 0.3*sin(a), h))
+        else:
+            x, y = random.uniform(0,size), random.uniform(0,size)
+            points.append((x, y, 0.2*sin(x)*cos(y) + random.gauss(0,0.01)))
+    return Point3Array(points)
+
+def bench(nbpoints, radius = 0.3, k = 16, nbsinglequeries = 100):
+    points = lidar_cloud(nbpoints)
+    t = perf_counter()
+    adjacencies = k_closest_points_from_ann(points, 8, True)
+    tadj = perf_counter() - t
+
+    t = perf_counter()
+    rnbgs = r_neighborhoods(points, adjacencies, radius)
+    tr = perf_counter() - t
+
+    t = perf_counter()
+    r_neighborhoods_mt(points, adjacencies, radius)
+    trmt = perf_counter() - t
+
+    t = perf_counter()
+    k_neighborhoods(points, adjacencies, k)
+    tk = perf_counter() - t
+
+    # independent queries reinitialize arrays of the size of the cloud : extrapolate.
+    t = perf_counter()
+    for i in range(nbsinglequeries):
+        r_neighborhood(i, points, adjacencies, radius)
+    tsingle = (perf_counter() - t) * nbpoints / nbsinglequeries
+
+    meansize = sum(len(n) for n in rnbgs) / float(nbpoints)
+    print('%9i points | adjacency %6.2fs | r_neighborhoods %6.2fs (mt %6.2fs, %.1f points per neighborhood) | k_neighborhoods %6.2fs | independent queries %9.2fs' % 
+          (nbpoints, tadj, tr, trmt, meansize, tk, tsingle))
+
+if __name__ == '__main__':
+    sizes = [int(float(v)) for v in sys.argv[1:]] or [int(1e4), int(1e5), int(1e6)]
+    for nbpoints in sizes:
+        bench(nbpoints)
@@ -0,0 +1,45 @@
+""" Discretization time of scenes made of NURBS and Bezier curves and patches,
+    and of extrusions along NURBS and Bezier axes.
+
+    Usage: python bench_discretization.py [nbshapes [stride]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random, sys
+
+def make_scene(nbshapes, stride):
+    random.seed(0)
+    def rnd4(): return Vector4(random.random(), random.random(), random.random(), 1)
+    scene = Scene()
+    for i in range(nbshapes):
+        scene += Shape(NurbsCurve(Point4Array([rnd4() for j in range(12)]), 3, stride = stride))
+        scene += Shape(BezierCurve(Point4Array([rnd4() for j in range(6)]), stride = stride))
+        scene += Shape(NurbsPatch(Point4Matrix([[rnd4() for k in range(6)] for j in range(6)]), 3, 3, ustride = stride, vstride = stride))
+        scene += Shape(BezierPatch(Point4Matrix([[rnd4() for k in range(4)] for j in range(4)]), stride, stride))
+        # the centers of the sections are evaluated along the axis in one call.
+        section = Polyline2D.Circle(0.05, 8)
+        scene += Shape(Extrusion(NurbsCurve(Point4Array([rnd4() for j in range(12)]), 3, stride = stride), section))
+        scene += Shape(Extrusion(BezierCurve(Point4Array([rnd4() for j in range(6)]), stride = stride), section))
+    return scene
+
+def bench(nbshapes, stride):
+    scene = make_scene(nbshapes, stride)
+    d = Discretizer()
+    times, nbpoints = {}, {}
+    for sh in scene:
+        name = sh.geometry.__class__.__name__
+        if name == 'Extrusion': name += ' of ' + sh.geometry.axis.__class__.__name__
+        d.clear()
+        t = perf_counter()
+        sh.geometry.apply(d)
+        times[name] = times.get(name, 0) + perf_counter() - t
+        nbpoints[name] = nbpoints.get(name, 0) + len(d.result.pointList)
+    for name in sorted(times):
+        print('%6i %-24s | stride %4i | %10i points | %7.3fs (%7.2f Mpoints/s)' %
+              (nbshapes, name, stride, nbpoints[name], times[name], nbpoints[name] / times[name] * 1e-6))
+
+if __name__ == '__main__':
+    nbshapes = int(sys.argv[1]) if len(sys.argv) > 1 else 200
+    strides = [int(sys.argv[2])] if len(sys.argv) > 2 else [10, 30, 100]
+    for stride in strides:
+        bench(nbshapes, stride)
@@ -0,0 +1,40 @@
+""" Speedup of the parallel discretization of a scene of Extrusions and NurbsPatches with the number of threads.
+
+    Usage: python bench_discretize_scene.py [nbshapes [nbthreads ...]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def make_scene(nbshapes):
+    random.seed(0)
+    section = Polyline2D.Circle(0.1, 12)
+    scene = Scene()
+    for i in range(nbshapes // 2):
+        axis = Polyline([(random.random(), random.random(), j) for j in range(10)])
+        scene += Shape(Extrusion(axis, section))
+        scene += Shape(NurbsPatch(Point4Matrix([[(j, k, random.random(), 1) for k in range(4)] for j in range(4)]), ustride = 20, vstride = 20))
+    return scene
+
+def bench(nbshapes, threads):
+    scene = make_scene(nbshapes)
+    initial = get_nb_threads()
+    t = perf_counter()
+    d = Discretizer()
+    for sh in scene:
+        sh.apply(d)
+    serial = perf_counter() - t
+    times = []
+    for nbthreads in threads:
+        set_nb_threads(nbthreads)
+        t = perf_counter()
+        Discretizer().discretizeScene(scene)
+        times.append(perf_counter() - t)
+    print('%9i shapes | serial %7.2fs | ' % (len(scene), serial) + ' | '.join('%2i threads %7.2fs (x%4.1f)' % (n, t, serial / t) for n, t in zip(threads, times)))
+    set_nb_threads(initial)
+
+if __name__ == '__main__':
+    nbshapes = int(float(sys.argv[1])) if len(sys.argv) > 1 else int(1e4)
+    threads = [int(v) for v in sys.argv[2:]] or [1, 2, 4, 8, 16]
+    bench(nbshapes, threads)
@@ -0,0 +1,30 @@
+""" Benchmark of NativeKDTree3 against the ANN backed ANNKDTree3 when available.
+
+    Usage: python bench_kdtree.py [nbpoints ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def bench_tree(name, constructor, points, k = 8):
+    t = perf_counter()
+    kdtree = constructor(points)
+    tbuild = perf_counter() - t
+    t = perf_counter()
+    kdtree.k_nearest_neighbors(k)
+    tknn = perf_counter() - t
+    print('%15s | %10i points | build %7.2fs | %i-nn %7.2fs' % (name, len(points), tbuild, k, tknn))
+
+def bench(nbpoints):
+    random.seed(0)
+    points = Point3Array([Vector3(random.random(),random.random(),random.random()) for i in range(nbpoints)])
+    bench_tree('NativeKDTree3', NativeKDTree3, points)
+    bench_tree('NativeKDTree3f', NativeKDTree3f, points)
+    if 'ANNKDTree3' in globals():
+        bench_tree('ANNKDTree3', ANNKDTree3, points)
+
+if __name__ == '__main__':
+    sizes = [int(float(v)) for v in sys.argv[1:]] or [int(1e5), int(1e6), int(1e7)]
+    for nbpoints in sizes:
+        bench(nbpoints)
@@ -0,0 +1,67 @@
+""" Rendering of a scene from many points of view, with one ZBufferEngine per view or with a MultiViewZBufferEngine.
+
+    Usage: python bench_multiview.py [nbshapes] [nbviews] [resolution]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+from math import cos, sin, pi
+import random
+import sys
+
+def random_canopy(nbshapes):
+    """ A cloud of randomly placed leaves and spheres. """
+    random.seed(0)
+    size = nbshapes ** (1/3.)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        if i % 10 == 0:
+            scene.add(Shape(Translated(pos, Sphere(0.3)), Material((0,200,0)), i+1))
+        else:
+            pts = [pos + Vector3(random.uniform(-0.5,0.5),random.uniform(-0.5,0.5),random.uniform(-0.5,0.5)) for j in range(4)]
+            scene.add(Shape(TriangleSet(pts, [(0,1,2),(0,2,3)]), Material((0,200,0)), i+1))
+    return scene, size
+
+def viewpoints(size, nbviews):
+    center = Vector3(size/2,size/2,size/2)
+    return [(center + Vector3(2*size*cos(2*pi*i/nbviews), 2*size*sin(2*pi*i/nbviews), size*sin(4*pi*i/nbviews)), center) for i in range(nbviews)]
+
+def render_per_view(scene, views, resolution):
+    histograms = []
+    for eye, center in views:
+        z = ZBufferEngine(resolution, resolution, renderingStyle=eIdBased, multithreaded = False)
+        z.setFrustumCamera(-0.05,0.05,-0.05,0.05,0.1,1000)
+        z.lookAt(eye, center, (0,0,1))
+        z.process(scene)
+        histograms.append(dict(z.idhistogram(False)))
+    return histograms
+
+def render_multiview(scene, views, resolution):
+    mv = MultiViewZBufferEngine(resolution, resolution)
+    mv.setScene(scene)
+    for eye, center in views:
+        camera = PerspectiveCamera(-0.05,0.05,-0.05,0.05,0.1,1000)
+        camera.lookAt(eye, center, (0,0,1))
+        mv.addView(camera)
+    mv.process(keepBuffers = False, solidangle = False)
+    return [dict(h) for h in mv.idhistograms()]
+
+def bench(nbshapes = 5000, nbviews = 64, resolution = 256):
+    scene, size = random_canopy(nbshapes)
+    views = viewpoints(size, nbviews)
+    t = perf_counter()
+    ref = render_per_view(scene, views, resolution)
+    tref = perf_counter() - t
+    t = perf_counter()
+    res = render_multiview(scene, views, resolution)
+    tmv = perf_counter() - t
+    nbids = sum(len(h) for h in ref)
+    nbsame = sum(len([k for k in h if h[k] == h2.get(k)]) for h, h2 in zip(ref, res))
+    print('%i shapes | %i views of %i px | per view %7.3fs | multiview %7.3fs (x%5.2f) | %i threads | identical histogram entries %i/%i' % 
+          (nbshapes, nbviews, resolution, tref, tmv, tref / tmv, ZBufferEngine.getNbThreads(), nbsame, nbids))
+
+if __name__ == '__main__':
+    nbshapes = int(sys.argv[1]) if len(sys.argv) > 1 else 5000
+    nbviews = int(sys.argv[2]) if len(sys.argv) > 2 else 64
+    resolution = int(sys.argv[3]) if len(sys.argv) > 3 else 256
+    bench(nbshapes, nbviews, resolution)
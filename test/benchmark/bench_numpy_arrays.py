@@ -0,0 +1,29 @@
+""" Transfer time of point clouds between numpy and PlantGL arrays.
+
+    Usage: python bench_numpy_arrays.py [nbpoints]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import numpy as np
+import sys
+
+def bench(nbpoints):
+    data = np.random.rand(nbpoints, 3)
+    t = perf_counter()
+    points = Point3Array(list(map(tuple, data)))
+    fromlist = perf_counter() - t
+    t = perf_counter()
+    points = Point3Array(data)
+    fromnumpy = perf_counter() - t
+    t = perf_counter()
+    copy = np.array([tuple(p) for p in points])
+    tolist = perf_counter() - t
+    t = perf_counter()
+    view = points.to_array()
+    toview = perf_counter() - t
+    assert (copy == view).all()
+    print('%9i points | from list %7.3fs | from numpy %7.3fs (x%6.1f) | to list %7.3fs | to view %9.6fs' % (nbpoints, fromlist, fromnumpy, fromlist / fromnumpy, tolist, toview))
+
+if __name__ == '__main__':
+    nbpoints = int(float(sys.argv[1])) if len(sys.argv) > 1 else int(1e6)
+    bench(nbpoints)
@@ -0,0 +1,37 @@
+""" Construction time of a triangle based Octree according to the number of threads.
+
+    Usage: python bench_octree.py [nbshapes ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def canopy(nbshapes):
+    random.seed(0)
+    size = nbshapes ** (1/3.)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        geom = Sphere(0.3,12,8) if i % 2 == 0 else AxisRotated((1,0,0), random.uniform(0,3), Cylinder(0.1,1))
+        scene.add(Shape(Translated(pos, geom), id = i))
+    return scene
+
+def bench(nbshapes, maxscale = 8, maxelements = 20):
+    scene = canopy(nbshapes)
+    nbthreads = get_nb_threads()
+    times = []
+    for threads in [1, nbthreads]:
+        set_nb_threads(threads)
+        t = perf_counter()
+        octree = Octree(scene, maxscale, maxelements)
+        times.append(perf_counter() - t)
+    set_nb_threads(nbthreads)
+    nbnodes = sum(sum(d[1:]) for d in octree.getDetails())
+    print('%7i shapes %9i nodes : %.3fs on 1 thread, %.3fs on %i threads (x%.1f)' %
+          (nbshapes, nbnodes, times[0], times[1], nbthreads, times[0]/times[1]))
+
+if __name__ == '__main__':
+    sizes = [int(a) for a in sys.argv[1:]] or [1000, 10000, 50000]
+    for nbshapes in sizes:
+        bench(nbshapes)
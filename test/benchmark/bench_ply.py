@@ -0,0 +1,37 @@
+""" Load throughput of the PLY codec on large point clouds, in ascii and binary.
+
+    Usage: python bench_ply.py [nbpoints ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import os, struct, sys, tempfile
+
+def write_ply(fname, nb, coding):
+    header = "ply\nformat %s 1.0\nelement vertex %i\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\nproperty uchar green\nproperty uchar blue\nend_header\n" % (coding, nb)
+    with open(fname, 'wb') as f:
+        f.write(header.encode())
+        if coding == 'ascii':
+            f.write(''.join('%g %g %g %i 0 255\n' % (i*0.1, i*0.2, i*0.3, i % 256) for i in range(nb)).encode())
+        else:
+            rec = struct.Struct('<fffBBB')
+            f.write(b''.join(rec.pack(i*0.1, i*0.2, i*0.3, i % 256, 0, 255) for i in range(nb)))
+
+def bench(nbpoints):
+    tmpdir = tempfile.mkdtemp()
+    for coding in ['binary_little_endian', 'ascii']:
+        fname = os.path.join(tmpdir, 'bench.ply')
+        write_ply(fname, nbpoints, coding)
+        size = os.path.getsize(fname) / float(1 << 20)
+        t = perf_counter()
+        Scene(fname)
+        tscene = perf_counter() - t
+        t = perf_counter()
+        read_ply_points(fname, lambda points, colors, offset : None)
+        tstream = perf_counter() - t
+        os.remove(fname)
+        print('%22s | %10i points | %8.1f MB | Scene %7.3fs | streamed %7.3fs' % (coding, nbpoints, size, tscene, tstream))
+
+if __name__ == '__main__':
+    sizes = [int(float(v)) for v in sys.argv[1:]] or [int(1e5), int(1e6), int(1e7)]
+    for nbpoints in sizes:
+        bench(nbpoints)
@@ -0,0 +1,47 @@
+""" Speedup of the parallel point cloud algorithms of pointmanipulation with the number of threads.
+
+    Usage: python bench_pointmanipulation_mt.py [nbpoints [nbthreads ...]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def cloud(nbpoints):
+    random.seed(0)
+    size = (nbpoints / 100.) ** 0.5
+    return Point3Array([(random.uniform(0,size),random.uniform(0,size),random.gauss(0,0.1)) for i in range(nbpoints)])
+
+def functions(points):
+    adjacencies = k_closest_points_from_ann(points, 8, True)
+    radius = 0.3
+    neighborhoods = r_neighborhoods(points, adjacencies, radius)
+    directions = Point3Array([(0,0,1)]*len(points))
+    density = densities_from_r_neighborhood(neighborhoods, radius)
+    nodes = Point3Array(points[::100])
+    parents = Uint32Array1([max(0,i-1) for i in range(len(nodes))])
+    return [('pointsets_normals', lambda : pointsets_normals(points, neighborhoods)),
+            ('principal_curvatures', lambda : principal_curvatures(points, neighborhoods)),
+            ('densities_from_r_neighborhood', lambda : densities_from_r_neighborhood(points, adjacencies, radius)),
+            ('r_anisotropic_neighborhoods', lambda : r_anisotropic_neighborhoods(points, adjacencies, radius, directions, 0.5, 1.0)),
+            ('adaptive_contration', lambda : adaptive_contration(points, directions, adjacencies, density, 0.2, 0.4, None, 0.5, 1.0)),
+            ('pointsets_section_circles', lambda : pointsets_section_circles(points, adjacencies, directions, 0.1)),
+            ('estimate_radii_from_points', lambda : estimate_radii_from_points(points, nodes, parents))]
+
+def bench(nbpoints, threads):
+    points = cloud(nbpoints)
+    initial = get_nb_threads()
+    for name, func in functions(points):
+        times = []
+        for nbthreads in threads:
+            set_nb_threads(nbthreads)
+            t = perf_counter()
+            func()
+            times.append(perf_counter() - t)
+        print('%30s | %9i points | ' % (name, nbpoints) + ' | '.join('%2i threads %7.2fs (x%4.1f)' % (n, t, times[0] / t) for n, t in zip(threads, times)))
+    set_nb_threads(initial)
+
+if __name__ == '__main__':
+    nbpoints = int(float(sys.argv[1])) if len(sys.argv) > 1 else int(1e5)
+    threads = [int(v) for v in sys.argv[2:]] or [1, 2, 4, 8, 16]
+    bench(nbpoints, threads)
@@ -0,0 +1,36 @@
+""" Overhead of the Profiler on the construction of an Octree and the discretization of a scene.
+
+    Usage: python bench_profiler.py [nbshapes [tracefile]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random, sys
+
+def canopy(nbshapes):
+    random.seed(0)
+    size = nbshapes ** (1/3.)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        scene.add(Shape(Translated(pos, Sphere(0.3,12,8)), id = i))
+    return scene
+
+def bench(nbshapes, tracefile = None):
+    scene = canopy(nbshapes)
+    times = []
+    for enabled in [False, True]:
+        Profiler.clear()
+        Profiler.enable(enabled)
+        t = perf_counter()
+        Octree(scene, 8, 20)
+        times.append(perf_counter() - t)
+        Profiler.disable()
+    print('%7i shapes : %.3fs without profiling, %.3fs with profiling' % (nbshapes, times[0], times[1]))
+    print(Profiler.summary())
+    if tracefile:
+        Profiler.saveChromeTrace(tracefile)
+
+if __name__ == '__main__':
+    nbshapes = int(sys.argv[1]) if len(sys.argv) > 1 else 10000
+    tracefile = sys.argv[2] if len(sys.argv) > 2 else None
+    bench(nbshapes, tracefile)
@@ -0,0 +1,39 @@
+""" Time of a SpaceColonization run with the number of attractors and of threads used for the bud perception.
+
+    Usage: python bench_spacecolonization.py [nbattractors [nbthreads ...]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def make_attractors(nbattractors):
+    random.seed(0)
+    center = Vector3(0, 0, 1.2)
+    points = []
+    while len(points) < nbattractors:
+        p = Vector3(random.uniform(-1, 1), random.uniform(-1, 1), random.uniform(0, 2))
+        if norm(p - center) < 1:
+            points.append(p)
+    return points
+
+def bench(nbattractors, threads):
+    attractors = make_attractors(nbattractors)
+    initial = get_nb_threads()
+    results = []
+    for nbthreads in threads:
+        set_nb_threads(nbthreads)
+        sc = SpaceColonization(Point3Array(attractors), 0.05, 0.045, 0.25, Vector3(0, 0, 0.3), 30)
+        t = perf_counter()
+        sc.run()
+        results.append((nbthreads, perf_counter() - t, len(sc.nodes)))
+    set_nb_threads(initial)
+    reference = results[0][1]
+    print('%9i attractors | %6i nodes | ' % (nbattractors, results[0][2]) + ' | '.join('%2i threads %7.2fs (x%4.1f)' % (n, t, reference / t) for n, t, nb in results))
+    assert len(set(nb for n, t, nb in results)) == 1
+
+if __name__ == '__main__':
+    nbattractors = [int(float(sys.argv[1]))] if len(sys.argv) > 1 else [int(1e4), int(1e5), int(1e6)]
+    threads = [int(v) for v in sys.argv[2:]] or [1, 2, 4, 8, 16]
+    for nb in nbattractors:
+        bench(nb, threads)
@@ -0,0 +1,48 @@
+""" Rendering time of textured leaf cards with the mipmapped textures of the ZBufferEngine.
+
+    Usage: python bench_texture_sampling.py [nbcards [resolution]]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random, tempfile, os, sys
+
+def texture_file(size = 512):
+    img = Image(size, size, 4)
+    for y in range(size):
+        for x in range(size):
+            img.setPixelAt(x, y, Color4(40, 120 + (x*y) % 100, 30, 0) if (x//8 + y//8) % 2 else Color4(20, 80, 10, 0))
+    fname = os.path.join(tempfile.mkdtemp(), 'leaf.png')
+    img.save(fname)
+    return fname
+
+def cards(nbcards, fname):
+    random.seed(0)
+    texture = Texture2D(ImageTexture(fname))
+    card = TriangleSet([(0,-0.5,0),(0,0.5,0),(0,0.5,1),(0,-0.5,1)], [(0,1,2),(0,2,3)],
+                       texCoordList = [(0,0),(1,0),(1,1),(0,1)])
+    scene = Scene()
+    size = nbcards ** (1/3.)
+    for i in range(nbcards):
+        pos = (random.uniform(0,size), random.uniform(0,size), random.uniform(0,size))
+        scene.add(Shape(Translated(pos, AxisRotated((0,0,1), random.uniform(0,3), card)), texture, i))
+    return scene, size
+
+def bench(nbcards, resolution):
+    fname = texture_file()
+    scene, size = cards(nbcards, fname)
+    for spanshading in [False, True]:
+        MipmapTexture.clearCache()
+        z = ZBufferEngine(resolution, resolution, renderingStyle=eColorBased, multithreaded = False)
+        z.setPerspectiveCamera(60, 1, 0.1, 1000)
+        z.lookAt((3*size, size/2, size/2), (size/2, size/2, size/2), (0,0,1))
+        z.spanShading = spanshading
+        t = perf_counter()
+        z.process(scene)
+        print('%6i cards %4ipx, span shading %-5s : %.3fs, texture cache %.1f MB' %
+              (nbcards, resolution, spanshading, perf_counter() - t, MipmapTexture.getCacheSize() / 1e6))
+    os.remove(fname)
+
+if __name__ == '__main__':
+    nbcards = int(sys.argv[1]) if len(sys.argv) > 1 else 5000
+    resolution = int(sys.argv[2]) if len(sys.argv) > 2 else 256
+    bench(nbcards, resolution)
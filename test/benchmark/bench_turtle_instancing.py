@@ -0,0 +1,47 @@
+""" Drawing and rendering time of a turtle with and without instancing of its primitives.
+
+    Usage: python bench_turtle_instancing.py [nbsteps]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import sys
+
+def draw(turtle, nbsteps):
+    turtle.setWidth(0.05)
+    for i in range(nbsteps):
+        turtle.push()
+        turtle.down(40)
+        turtle.rollL(137*i)
+        turtle.F(0.5, 0.01)
+        turtle.sphere(0.1)
+        turtle.pop()
+        turtle.F(0.1)
+        turtle.rollL(10)
+        turtle.down(0.5)
+
+def render(geometry):
+    z = ZBufferEngine(800, 800, renderingStyle=eIdBased)
+    z.setPerspectiveCamera(60, 1, 0.1, 1000)
+    z.lookAt((100,0,10), (0,0,10), (0,0,1))
+    t = perf_counter()
+    z.process(geometry)
+    return perf_counter() - t
+
+def bench(nbsteps):
+    for instancing in [False, True]:
+        drawer = PglTurtleDrawer()
+        drawer.instancing = instancing
+        turtle = PglTurtle(drawer)
+        t = perf_counter()
+        draw(turtle, nbsteps)
+        drawing = perf_counter() - t
+        geometry = drawer.getInstances() if instancing else turtle.getScene()
+        rendering = render(geometry)
+        t = perf_counter()
+        scene = turtle.getScene()
+        view = perf_counter() - t
+        print('%-10s | %8i shapes | draw %7.2fs | render %7.2fs | scene %7.2fs' % ('instanced' if instancing else 'scene', len(scene), drawing, rendering, view))
+
+if __name__ == '__main__':
+    nbsteps = int(float(sys.argv[1])) if len(sys.argv) > 1 else int(1e5)
+    bench(nbsteps)
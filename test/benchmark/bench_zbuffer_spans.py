@@ -0,0 +1,53 @@
+""" Rasterization time of the ZBufferEngine with and without span shading,
+    with a perspective and an orthographic camera.
+
+    Usage: python bench_zbuffer_spans.py [nbshapes] [resolution ...]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def random_canopy(nbshapes):
+    """ A cloud of randomly placed and colored leaves, as triangle sets. """
+    random.seed(0)
+    size = nbshapes ** (1/3.)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        pts = [pos + Vector3(random.uniform(-0.5,0.5),random.uniform(-0.5,0.5),random.uniform(-0.5,0.5)) for j in range(4)]
+        scene.add(Shape(TriangleSet(pts, [(0,1,2),(0,2,3)]), Material((random.randint(0,255),random.randint(0,255),random.randint(0,255))), i+1))
+    return scene, size
+
+def render(scene, size, resolution, style, spanshading, orthographic = False):
+    z = ZBufferEngine(resolution, resolution, renderingStyle=style, multithreaded = False)
+    if orthographic:
+        z.setOrthographicCamera(-0.8*size,0.8*size,-0.8*size,0.8*size,0.1,1000)
+    else:
+        z.setPerspectiveCamera(60,1,0.1,1000)
+    z.lookAt((-size,size/2,size/2),(size/2,size/2,size/2),(0,0,1))
+    z.spanShading = spanshading
+    t = perf_counter()
+    z.process(scene)
+    return perf_counter() - t, z
+
+def bench(nbshapes = 20000, resolutions = [1024, 4096]):
+    scene, size = random_canopy(nbshapes)
+    for orthographic in [False, True]:
+        camera = 'orthographic' if orthographic else 'perspective'
+        for resolution in resolutions:
+            for name, style in [('id', eIdBased), ('color', eColorBased), ('id and color', eIdAndColorBased)]:
+                tref, ref = render(scene, size, resolution, style, False, orthographic)
+                tspan, span = render(scene, size, resolution, style, True, orthographic)
+                if orthographic:
+                    # the spans sample the pixel centers and the rays the pixel corners. Only the ids are compared.
+                    comparison = 'identical ids : %5.2f%%' % (100 * (ref.getIdBuffer().to_array() == span.getIdBuffer().to_array()).mean()) if style & eIdBased else ''
+                else:
+                    comparison = 'identical depth : %s' % (ref.getDepthBuffer().to_array() == span.getDepthBuffer().to_array()).all()
+                print('%-12s | %5i px | %-12s | per pixel shading %7.3fs | span shading %7.3fs (x%5.2f) | %s' % 
+                      (camera, resolution, name, tref, tspan, tref / tspan, comparison))
+
+if __name__ == '__main__':
+    nbshapes = int(sys.argv[1]) if len(sys.argv) > 1 else 20000
+    resolutions = [int(v) for v in sys.argv[2:]] if len(sys.argv) > 2 else [1024, 4096]
+    bench(nbshapes, resolutions)
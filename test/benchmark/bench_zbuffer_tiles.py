@@ -0,0 +1,47 @@
+""" Scaling of the multithreaded ZBufferEngine with and without tile binning.
+
+    Usage: python bench_zbuffer_tiles.py [nbshapes] [tilesize]
+"""
+from openalea.plantgl.all import *
+from time import perf_counter
+import random
+import sys
+
+def random_scene(nbshapes):
+    """ A cloud of randomly placed and colored spheres. """
+    random.seed(0)
+    size = nbshapes ** (1/3.)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,size),random.uniform(0,size),random.uniform(0,size))
+        scene.add(Shape(Translated(pos, Sphere(0.4,16,16)), Material((random.randint(0,255),random.randint(0,255),random.randint(0,255))), i))
+    return scene, size
+
+def render(scene, size, multithreaded, tilebinning, tilesize, style = eIdAndColorBased):
+    z = ZBufferEngine(1024, 1024, renderingStyle=style, multithreaded = multithreaded)
+    z.setPerspectiveCamera(60,1,0.1,1000)
+    z.lookAt((-size,size/2,size/2),(size/2,size/2,size/2),(0,0,1))
+    z.setTileBinning(tilebinning, tilesize)
+    t = perf_counter()
+    z.process(scene)
+    return perf_counter() - t, z
+
+def bench(nbshapes = 20000, tilesize = 32, nbthreads = [1, 2, 4, 8, 16, 32, 64]):
+    scene, size = random_scene(nbshapes)
+    tref, ref = render(scene, size, False, False, tilesize)
+    refid = ref.getIdBufferAsImage().to_array()
+    print('%i shapes | single threaded %7.3fs' % (nbshapes, tref))
+    initnbthreads = ZBufferEngine.getNbThreads()
+    for nbthread in nbthreads:
+        ZBufferEngine.setNbThreads(nbthread)
+        tlock, _ = render(scene, size, True, False, tilesize)
+        ttile, tiled = render(scene, size, True, True, tilesize)
+        identical = (tiled.getIdBufferAsImage().to_array() == refid).all()
+        print('%3i threads | pixel locks %7.3fs (x%5.2f) | tiles %7.3fs (x%5.2f) | identical to single threaded : %s' % 
+              (nbthread, tlock, tref / tlock, ttile, tref / ttile, identical))
+    ZBufferEngine.setNbThreads(initnbthreads)
+
+if __name__ == '__main__':
+    nbshapes = int(sys.argv[1]) if len(sys.argv) > 1 else 20000
+    tilesize = int(sys.argv[2]) if len(sys.argv) > 2 else 32
+    bench(nbshapes, tilesize)
@@ -0,0 +1,116 @@
+from openalea.plantgl.all import *
+import numpy as np
+import gc
+
+def test_view_is_shared():
+    a = Point3Array([Vector3(1,2,3), Vector3(4,5,6)])
+    v = a.to_array()
+    assert v.shape == (2,3)
+    assert not v.flags['OWNDATA']
+    v[0,0] = 10
+    assert a[0] == Vector3(10,2,3)
+    a[1] = Vector3(7,8,9)
+    assert list(v[1]) == [7,8,9]
+
+def test_view_keeps_array_alive():
+    v = Point3Array([Vector3(1,2,3)]).to_array()
+    gc.collect()
+    assert list(v[0]) == [1,2,3]
+    m = RealArray2(2,3)
+    v = m.to_array()
+    del m
+    gc.collect()
+    assert (v == 0).all()
+
+def test_view_after_resize():
+    a = Point3Array([Vector3(1,2,3), Vector3(4,5,6)])
+    v = a.to_array()
+    for i in range(1000):
+        a.append(Vector3(i,i,i))
+    gc.collect()
+    # the view keeps the elements it had before the resize
+    assert v.shape == (2,3)
+    assert list(v[1]) == [4,5,6]
+    v[0,0] = 10
+    assert a[0] == Vector3(1,2,3)
+    a.clear()
+    assert list(v[0]) == [10,2,3]
+    r = RealArray([1,2,3])
+    v = r.to_array()
+    r.insert(0, 5)
+    del r
+    gc.collect()
+    assert list(v) == [1,2,3]
+
+def test_from_numpy():
+    data = np.arange(12, dtype=float).reshape(4,3)
+    a = Point3Array(data)
+    assert len(a) == 4 and a[3] == Vector3(9,10,11)
+    assert (a.to_array() == data).all()
+    # non contiguous and of another type
+    a = Point3Array(np.arange(12, dtype=np.int32).reshape(4,3)[::2])
+    assert len(a) == 2 and a[1] == Vector3(6,7,8)
+    # implicit conversion of arguments
+    assert Point4Array(data, 1)[0] == Vector4(0,1,2,1)
+
+def test_other_arrays():
+    assert (Point2Array(np.ones((3,2))).to_array() == 1).all()
+    assert (Point4Array(np.ones((3,4))).to_array() == 1).all()
+    i = Index3Array(np.array([[0,1,2],[2,3,4]]))
+    assert i[1] == Index3(2,3,4)
+    assert i.to_array().dtype == np.uint32
+    c = Color4Array(np.array([[255,0,0,128]], dtype=np.uint8))
+    assert c[0] == Color4(255,0,0,128)
+    assert list(c.to_array()[0]) == [255,0,0,128]
+    r = RealArray(np.linspace(0,1,5))
+    assert r[4] == 1 and len(r.to_array()) == 5
+    u = UIntArray(np.array([1,2,3]))
+    assert list(np.asarray(u)) == [1,2,3]
+    assert Point3Array(0).to_array().shape == (0,3)
+
+def test_array_protocol():
+    a = Point3Array(np.ones((3,3)))
+    assert np.asarray(a).shape == (3,3)
+    assert np.asarray(a, dtype=np.float32).dtype == np.float32
+
+def test_invalid_shape():
+    try:
+        Point3Array(np.ones((3,2)))
+        assert False
+    except ValueError:
+        pass
+
+def test_csr_from_numpy():
+    csr = CSRIndexArray(np.array([0,2,2,5], dtype=np.int64), np.array([1,2,0,1,2], dtype=np.int32))
+    assert len(csr) == 3 and csr.isValid()
+    assert [list(i) for i in csr.toIndexArray()] == [[1,2],[],[0,1,2]]
+    assert list(csr.offsets) == [0,2,2,5]
+    for offsets, indices in [([0,2,1,5],[1,2,0,1,2]), ([0,2,6],[1,2,0,1,2]), ([[0,2]],[1,2])]:
+        try:
+            CSRIndexArray(np.array(offsets), np.array(indices))
+            assert False
+        except ValueError:
+            pass
+    csr = CSRIndexArray(np.array([0,2,3]), np.array([1,4,3]), 5)
+    assert [list(i) for i in csr.toIndexArray()] == [[1,4],[3]]
+    for indices, nbpoints, error in [([1,3,0], None, IndexError), ([1,5,0], 5, IndexError), ([1,-1,0], None, ValueError)]:
+        try:
+            if nbpoints is None:
+                CSRIndexArray(np.array([0,2,3]), np.array(indices))
+            else:
+                CSRIndexArray(np.array([0,2,3]), np.array(indices), nbpoints)
+            assert False
+        except error:
+            pass
+
+
+if __name__ == '__main__':
+    import traceback as tb
+    test_func = [ (n,v) for n,v in list(globals().items()) if ('test' in n) and hasattr(v,'__code__')]
+    test_func.sort(key = lambda x : x[1].__code__.co_firstlineno)
+    for tfn,tf in test_func:
+        print(tfn)
+        try:
+            tf()
+        except:
+            tb.print_exc()
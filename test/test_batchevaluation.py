@@ -0,0 +1,51 @@
+from openalea.plantgl.all import *
+import random
+
+def ctrlpoints(nb, seed = 0):
+    random.seed(seed)
+    return Point4Array([Vector4(random.random(), random.random(), random.random(), 0.5 + random.random()) for i in range(nb)])
+
+def ctrlmatrix(nbrows, nbcols, seed = 0):
+    random.seed(seed)
+    return Point4Matrix([[(random.random(), random.random(), random.random(), 0.5 + random.random()) for j in range(nbcols)] for i in range(nbrows)])
+
+def params(first, last, nb):
+    return RealArray([first + (last - first) * i / float(nb - 1) for i in range(nb)])
+
+def test_curves():
+    for degree in range(1,4):
+        curve = NurbsCurve(ctrlpoints(8), degree)
+        u = params(curve.firstKnot, curve.lastKnot, 51)
+        points = curve.getPointsAt(u)
+        assert len(points) == len(u)
+        for ui, p in zip(u, points):
+            assert norm(p - curve.getPointAt(ui)) < 1e-10
+    curve = BezierCurve(ctrlpoints(5))
+    u = params(0, 1, 21)
+    for ui, p in zip(u, curve.getPointsAt(u)):
+        assert norm(p - curve.getPointAt(ui)) < 1e-10
+    curve = NurbsCurve2D(Point3Array([(0,0,1),(1,1,2),(2,0,1),(3,1,1)]))
+    u = params(curve.firstKnot, curve.lastKnot, 21)
+    for ui, p in zip(u, curve.getPointsAt(u)):
+        assert norm(p - curve.getPointAt(ui)) < 1e-10
+
+def test_patches():
+    patch = NurbsPatch(ctrlmatrix(5, 6), udegree = 2, vdegree = 3)
+    u = params(patch.firstUKnot, patch.lastUKnot, 11)
+    v = params(patch.firstVKnot, patch.lastVKnot, 7)
+    points = patch.getPointsAt(u, v)
+    assert len(points) == len(u) * len(v)
+    for i, ui in enumerate(u):
+        for j, vj in enumerate(v):
+            assert norm(points[i * len(v) + j] - patch.getPointAt(ui, vj)) < 1e-10
+    for m in [ctrlmatrix(3, 4), ctrlmatrix(4, 3)]:
+        patch = BezierPatch(m)
+        u, v = params(0, 1, 9), params(0, 1, 5)
+        points = patch.getPointsAt(u, v)
+        for i, ui in enumerate(u):
+            for j, vj in enumerate(v):
+                assert norm(points[i * len(v) + j] - patch.getPointAt(ui, vj)) < 1e-10
+
+if __name__ == '__main__':
+    test_curves()
+    test_patches()
@@ -36,6 +36,68 @@ def test_bbox_on_benchmark_objects(sceneobj):
     bbox_application(sceneobj)
 
 
+def test_bbox_cache_invalidation():
+    """ Modifying an object through its properties must invalidate cached results """
+    d = Discretizer()
+    b = BBoxComputer(d)
+    s = Sphere(1)
+    assert s.apply(b)
+    assert abs(b.result.upperRightCorner.x - 1) < 1e-5
+    assert s.apply(b)
+    assert b.cacheStatistics()['hits'] >= 1
+    s.radius = 2
+    assert s.apply(b)
+    assert abs(b.result.upperRightCorner.x - 2) < 1e-5
+    assert b.cacheStatistics()['stales'] >= 1
+    s.apply(d)
+    assert abs(max([p.x for p in d.result.pointList]) - 2) < 1e-5
+
+
+def test_bbox_cache_inplace_modification():
+    """ Modifying the arrays of an object in place must invalidate cached results """
+    d = Discretizer()
+    b = BBoxComputer(d)
+    ts = TriangleSet([(0,0,0),(1,0,0),(0,1,0)], [(0,1,2)])
+    t = Translated((0,0,1), ts)
+    shapes = [Shape(ts), Shape(t)]  # shared objects, whose results are cached
+    assert ts.apply(b)
+    assert abs(b.result.upperRightCorner.x - 1) < 1e-5
+    assert t.apply(b)
+    assert abs(b.result.upperRightCorner.x - 1) < 1e-5
+    ts.pointList[1] = Vector3(2,0,0)
+    assert ts.apply(b)
+    assert abs(b.result.upperRightCorner.x - 2) < 1e-5
+    # a composite object sees the modification of its components
+    ts.pointList.append(Vector3(3,0,0))
+    ts.indexList.append(Index3(0,1,3))
+    assert t.apply(b)
+    assert abs(b.result.upperRightCorner.x - 3) < 1e-5
+    assert b.cacheStatistics()['stales'] >= 2
+
+
+def test_discretization_cache_budget():
+    """ The discretization cache must stay within its memory budget """
+    d = Discretizer()
+    spheres = [Sphere(1 + i, 32, 32) for i in range(5)]
+    assert spheres[0].apply(d)
+    entrycost = d.cacheStatistics()['cost']
+    assert entrycost > 0
+    d.clear()
+    d.cacheMaxSize = 2 * entrycost
+    d.resetCacheStatistics()
+    for sp in spheres:
+        assert sp.apply(d)
+    stats = d.cacheStatistics()
+    assert stats['size'] == 2
+    assert stats['cost'] <= 2 * entrycost
+    assert stats['evictions'] == 3
+    # the two most recently used discretizations are still cached
+    d.resetCacheStatistics()
+    for sp in spheres[-2:]:
+        assert sp.apply(d)
+    assert d.cacheStatistics()['hits'] == 2
+
+
 def apply_bbox_on_objects():
     for t in test_bbox_on_default_object():
         pass
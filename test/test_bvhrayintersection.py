@@ -0,0 +1,107 @@
+from openalea.plantgl.all import *
+from math import *
+
+
+def build_scene(nbshapes = 50):
+    import random
+    random.seed(0)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,10),random.uniform(0,10),random.uniform(0,10))
+        geom = Sphere(0.5,16,16) if i % 2 == 0 else Box(0.3,0.2,0.5)
+        scene.add(Shape(Translated(pos, geom), id = i))
+    return scene
+
+def reference_intersection(scene, ray):
+    """ Closest intersection computed with the per-shape RayIntersection action. """
+    d = Discretizer()
+    ri = RayIntersection(d)
+    ri.setRay(ray)
+    best = None
+    for sh in scene:
+        if sh.apply(ri):
+            for p in ri.intersection:
+                dist = norm(p - ray.origin)
+                if best is None or dist < best[0]:
+                    best = (dist, sh.id)
+    return best
+
+def test_bvh_closest_hit():
+    scene = build_scene()
+    bvh = BVHRayIntersection(scene)
+    assert bvh.nbTriangles > 0
+    import random
+    random.seed(1)
+    for i in range(200):
+        ray = Ray(Vector3(-5,random.uniform(0,10),random.uniform(0,10)), Vector3(1,random.uniform(-0.3,0.3),random.uniform(-0.3,0.3)))
+        res = bvh.intersect(ray)
+        ref = reference_intersection(scene, ray)
+        if ref is None:
+            assert res is None
+        else:
+            assert res is not None
+            point, dist, shapeid, triangleid = res
+            assert abs(dist - ref[0]) < 1e-5
+            assert shapeid == ref[1]
+        assert bvh.isOccluded(ray) == (res is not None)
+
+def test_bvh_batch():
+    scene = build_scene()
+    bvh = BVHRayIntersection(scene)
+    import random
+    random.seed(2)
+    origin = Vector3(-5,5,5)
+    directions = Point3Array([Vector3(1,random.uniform(-0.5,0.5),random.uniform(-0.5,0.5)) for i in range(1000)])
+    points, distances, ids = bvh.intersectRays(origin, directions)
+    occluded = bvh.areOccluded(origin, directions)
+    assert len(points) == len(distances) == len(ids) == len(occluded) == len(directions)
+    for d, dist, sid, occ in zip(directions, distances, ids, occluded):
+        res = bvh.intersect(Ray(origin,d))
+        if res is None:
+            assert sid == Shape.NOID and not occ
+        else:
+            assert res[2] == sid and abs(res[1] - dist) < 1e-8 and occ
+    # maximal distance
+    points, distances, ids = bvh.intersectRays(origin, directions, 1)
+    assert all(dist > 1e300 or dist <= 1 for dist in distances)
+
+def test_bvh_batch_multithreaded():
+    scene = build_scene()
+    bvh = BVHRayIntersection(scene)
+    import random
+    random.seed(3)
+    # more rays than a chunk of the multithreaded batches
+    origins = Point3Array([Vector3(-5,random.uniform(0,10),random.uniform(0,10)) for i in range(10000)])
+    directions = Point3Array([Vector3(1,random.uniform(-0.5,0.5),random.uniform(-0.5,0.5)) for i in range(10000)])
+    assert bvh.multithreaded
+    points, distances, ids = bvh.intersectRays(origins, directions)
+    occluded = bvh.areOccluded(origins, directions)
+    bvh.multithreaded = False
+    refpoints, refdistances, refids = bvh.intersectRays(origins, directions)
+    assert list(ids) == list(refids)
+    assert list(distances) == list(refdistances)
+    assert list(points) == list(refpoints)
+    assert list(occluded) == list(bvh.areOccluded(origins, directions))
+    assert any(sid != Shape.NOID for sid in ids)
+
+def test_bvh_batch_invalid_origins():
+    bvh = BVHRayIntersection(build_scene(4))
+    directions = Point3Array([Vector3(1,0,0) for i in range(10)])
+    for origins in [Point3Array([Vector3(-5,0,0) for i in range(5)]), Point3Array()]:
+        try:
+            bvh.intersectRays(origins, directions)
+            assert False, 'intersectRays should raise ValueError'
+        except ValueError:
+            pass
+        try:
+            bvh.areOccluded(origins, directions)
+            assert False, 'areOccluded should raise ValueError'
+        except ValueError:
+            pass
+
+
+if __name__ == '__main__':
+    test_bvh_closest_hit()
+    test_bvh_batch()
+    test_bvh_batch_multithreaded()
+    test_bvh_batch_invalid_origins()
@@ -91,6 +91,97 @@ def binary_str_benchmark(sceneobj):
 def test_binary_str_benchmark(sceneobj):
     binary_str_benchmark(sceneobj)
 
+def test_bgeom_large_arrays():
+    import random
+    random.seed(0)
+    nb = 100000
+    points = Point3Array([Vector3(random.random(),random.random(),random.random()) for i in range(nb)])
+    indices = Index3Array([Index3(i, (i+1) % nb, (i+2) % nb) for i in range(nb)])
+    colors = Color4Array([Color4(i % 256, (i//256) % 256, 7, 255) for i in range(nb)])
+    texcoords = Point2Array([Vector2(p.x,p.y) for p in points])
+    ts = TriangleSet(points, indices, colorList = colors, colorPerVertex = True, texCoordList = texcoords)
+    g = Scene([Shape(ts, Material())])
+    for double_precision in [True, False]:
+        g2 = frombinarystring(tobinarystring(g, double_precision))
+        ts2 = g2[0].geometry
+        assert len(ts2.pointList) == nb and len(ts2.indexList) == nb
+        tol = 0 if double_precision else 1e-6
+        assert all(norm(p1-p2) <= tol for p1,p2 in zip(points, ts2.pointList))
+        assert all(norm(p1-p2) <= tol for p1,p2 in zip(texcoords, ts2.texCoordList))
+        assert list(indices) == list(ts2.indexList)
+        assert list(colors) == list(ts2.colorList)
+
+def write_ply(fname, nb, coding):
+    import struct
+    header = "ply\nformat %s 1.0\nelement vertex %i\nproperty float x\nproperty float y\nproperty float z\nproperty uchar red\nproperty uchar green\nproperty uchar blue\nelement face 1\nproperty list uchar int vertex_indices\nend_header\n" % (coding, nb)
+    with open(fname, 'wb') as f:
+        f.write(header.encode())
+        if coding == 'ascii':
+            f.write(''.join('%i %i %i %i 0 255\n' % (i, 2*i, 3*i, i % 256) for i in range(nb)).encode())
+            f.write(b'3 0 1 2\n')
+        else:
+            e = '<' if coding == 'binary_little_endian' else '>'
+            rec = struct.Struct(e+'fffBBB')
+            f.write(b''.join(rec.pack(i, 2*i, 3*i, i % 256, 0, 255) for i in range(nb)))
+            f.write(struct.pack(e+'Biii', 3, 0, 1, 2))
+
+def test_ply_read():
+    import shutil, tempfile
+    nb = 1000
+    tmpdir = tempfile.mkdtemp()
+    fname = os.path.join(tmpdir, 'test.ply')
+    try:
+        for coding in ['ascii', 'binary_little_endian', 'binary_big_endian']:
+            write_ply(fname, nb, coding)
+            s = Scene(fname)
+            points = s[0].geometry.pointList
+            assert len(points) == nb
+            assert all(points[i] == Vector3(i, 2*i, 3*i) for i in range(nb))
+            assert list(s[0].geometry.indexList[0]) == [0, 1, 2]
+            chunks = []
+            read_ply_points(fname, lambda p, c, offset : chunks.append((len(p), offset, c[0].red)), 300)
+            assert chunks == [(300, 0, 0), (300, 300, 300 % 256), (300, 600, 600 % 256), (100, 900, 900 % 256)]
+    finally:
+        shutil.rmtree(tmpdir)
+
+def test_write_instances():
+    import shutil, tempfile
+    instances = InstancedScene()
+    prototype = Cylinder(0.5, 2, slices = 8)
+    for i in range(5):
+        m = Matrix4(Vector3(1,0,0), Vector3(0,0,1)*2, Vector3(0,-1,0), Vector3(2*i,0,0))
+        instances.add(prototype, m, Material((50*i,0,0)), i+1)
+    reference = instances.getScene()
+    refbbox = BoundingBox(reference)
+    d = Discretizer()
+    prototype.apply(d)
+    nbpoints = len(d.discretization.pointList)
+    def same_bbox(bbox):
+        return norm(bbox.lowerLeftCorner-refbbox.lowerLeftCorner) < 1e-4 and norm(bbox.upperRightCorner-refbbox.upperRightCorner) < 1e-4
+
+    tmpdir = tempfile.mkdtemp()
+    try:
+        fname = os.path.join(tmpdir, 'instances.obj')
+        obj.codec.write(fname, instances)
+        s = Scene(fname)
+        assert len(s) == len(instances)
+        assert same_bbox(BoundingBox(s))
+
+        for binary in [True, False]:
+            fname = os.path.join(tmpdir, 'instances.ply')
+            assert write_ply_instances(instances, fname, binary)
+            s = Scene(fname)
+            assert len(s[0].geometry.pointList) == nbpoints * len(instances)
+            assert same_bbox(BoundingBox(s))
+    finally:
+        shutil.rmtree(tmpdir)
+
+    t = Tesselator()
+    printer = PovStrPrinter(t)
+    printer.process(instances)
+    result = str(printer)
+    assert result.count('#declare PROTO_') == 1
+    assert result.count('matrix <') == len(instances)
 
 
 if __name__ == '__main__':
@@ -0,0 +1,101 @@
+from openalea.plantgl.all import *
+
+
+def build_scene(nbshapes = 30):
+    import random
+    random.seed(0)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(-5,5),random.uniform(-5,5),random.uniform(-5,5))
+        geom = Sphere(0.5,12,12) if i % 2 == 0 else Box(0.3,0.2,0.5)
+        geom = Oriented((1,0,0),(0,1,1),Scaled((1,2,1),geom))
+        scene.add(Shape(Translated(pos, geom), Material((10*i,0,0)), id = i+1))
+    return scene
+
+def test_compile():
+    scene = build_scene()
+    cs = CompiledScene(scene)
+    assert cs.nbShapes == len(scene)
+    points = cs.getPointList()
+    assert len(points) == 3 * cs.nbTriangles == len(cs.getNormalList())
+    shapeids = cs.getShapeIds()
+    t = Tesselator()
+    for i, sh in enumerate(scene):
+        first, last = cs.getShapeTriangleRange(i)
+        assert cs.getShapeId(i) == sh.id
+        assert all(shapeids[j] == sh.id for j in range(first, last))
+        sh.apply(t)
+        assert last - first == len(t.result.indexList)
+        # the triangles are in world space
+        for j, triangle in enumerate(t.result.indexList):
+            assert norm(points[3*(first+j)] - t.result.pointList[triangle[0]]) < 1e-10
+    assert len(cs.getMaterials()) == len(scene)
+
+def test_update():
+    scene = build_scene()
+    cs = CompiledScene(scene)
+    assert cs.update() == 0
+    scene[3].geometry.translation = (0,0,0)
+    scene.add(Shape(Sphere(1), id = 100))
+    assert cs.update() == 2
+    ref = CompiledScene(scene)
+    assert cs.nbTriangles == ref.nbTriangles
+    assert list(cs.getShapeIds()) == list(ref.getShapeIds())
+    assert all(norm(a-b) < 1e-10 for a, b in zip(cs.getPointList(), ref.getPointList()))
+    assert cs.update(Scene(scene[:10])) == 0
+    assert cs.nbShapes == 10
+
+def test_engines():
+    scene = build_scene()
+    cs = CompiledScene(scene)
+    z1 = ZBufferEngine(200,200, renderingStyle=eIdBased)
+    z2 = ZBufferEngine(200,200, renderingStyle=eIdBased)
+    for z in [z1, z2]:
+        z.setPerspectiveCamera(60,1,0.1,100)
+        z.lookAt((20,0,0),(0,0,0),(0,0,1))
+    z1.process(scene)
+    z2.process(cs)
+    assert (z1.getIdBufferAsImage().to_array() == z2.getIdBufferAsImage().to_array()).all()
+    bvh1 = BVHRayIntersection(scene)
+    bvh2 = BVHRayIntersection(cs)
+    assert bvh1.nbTriangles == bvh2.nbTriangles
+    for y in range(-5,6):
+        ray = Ray(Vector3(-20,y,0.5), Vector3(1,0,0))
+        res1, res2 = bvh1.intersect(ray), bvh2.intersect(ray)
+        assert (res1 is None) == (res2 is None)
+        if res1 is not None:
+            assert res1[2] == res2[2] and abs(res1[1] - res2[1]) < 1e-8
+
+def test_instances():
+    import random
+    random.seed(0)
+    instances = InstancedScene()
+    scene = Scene()
+    prototypes = [Sphere(1,12,12), Box(0.3,0.2,0.5)]
+    for i in range(20):
+        pos = Vector3(random.uniform(-5,5),random.uniform(-5,5),random.uniform(-5,5))
+        scale = Vector3(random.uniform(0.5,1),random.uniform(0.5,1),random.uniform(0.5,1))
+        m = Matrix4(Vector3(1,0,0)*scale.x, Vector3(0,0,1)*scale.y, Vector3(0,-1,0)*scale.z, pos)
+        instances.add(prototypes[i % 2], m, Material((10*i,0,0)), i+1)
+        scene.add(Shape(Translated(pos, Oriented((1,0,0),(0,0,1),Scaled(scale,prototypes[i % 2]))), id = i+1))
+    assert len(instances.getPrototypes()) == 2
+    assert len(instances.getScene()) == len(instances)
+    cs, csi = CompiledScene(scene), CompiledScene(instances)
+    assert cs.nbTriangles == csi.nbTriangles
+    assert list(cs.getShapeIds()) == list(csi.getShapeIds())
+    assert all(norm(a-b) < 1e-10 for a, b in zip(cs.getPointList(), csi.getPointList()))
+    z1 = ZBufferEngine(200,200, renderingStyle=eIdBased)
+    z2 = ZBufferEngine(200,200, renderingStyle=eIdBased)
+    for z in [z1, z2]:
+        z.setPerspectiveCamera(60,1,0.1,100)
+        z.lookAt((20,0,0),(0,0,0),(0,0,1))
+    z1.process(scene)
+    z2.process(instances)
+    assert (z1.getIdBufferAsImage().to_array() == z2.getIdBufferAsImage().to_array()).all()
+
+
+if __name__ == '__main__':
+    test_compile()
+    test_update()
+    test_engines()
+    test_instances()
@@ -40,6 +40,61 @@ def test_polyline_as_result():
     sc = Scene()
     sc += s
     sc += s2
+
+def test_deepcopy_shared_arrays():
+    pts = Point3Array([(0,0,0),(1,0,0),(0,1,0)])
+    ts = TriangleSet(pts, Index3Array([Index3(0,1,2)]))
+    sc = Scene()
+    sc.add(Shape(ts))
+    sc2 = sc.deepcopy()
+    pts2 = sc2[0].geometry.pointList
+    assert not pts2 is pts
+    assert pts.isShared() and pts2.isShared()
+    stat = StatisticComputer()
+    sc2.apply(stat)
+    assert stat.sharedMemorySize >= pts.getMemorySize()
+    pts2.append(Vector3(0,0,1))
+    assert not pts.isShared() and not pts2.isShared()
+    assert len(pts) == 3 and len(pts2) == 4
+    assert list(pts) == list(pts2)[:3]
+
+def test_deepcopy_modified_copy():
+    pts = Point3Array([(0,0,0),(1,0,0)])
+    pts2 = Polyline(pts).deepcopy().pointList
+    pts2[0] = Vector3(2,0,0)
+    assert pts[0] == Vector3(0,0,0)
+    assert pts2[0] == Vector3(2,0,0)
+
+def test_deepcopy_element_read():
+    pts = Point3Array([(0,0,0),(1,0,0)])
+    pts2 = Polyline(pts).deepcopy().pointList
+    p = pts2[0]
+    p.x = 2
+    assert pts.isShared() and pts2.isShared()
+    assert pts2[0] == Vector3(0,0,0)
+
+def test_deepcopy_read_passes():
+    pts = Point3Array([(0,0,0),(1,0,0),(0,1,0),(0,0,1)])
+    ind = Index3Array([Index3(0,1,2),Index3(0,2,3)])
+    sc = Scene()
+    sc.add(Shape(TriangleSet(pts, ind)))
+    sc.add(Shape(Translated((1,0,0), TriangleSet(pts, ind))))
+    sc2 = sc.deepcopy()
+    t = Tesselator()
+    for sh in sc2:
+        sh.apply(t)
+    sc2[1].apply(Discretizer())
+    z = ZBufferEngine(100,100)
+    z.setPerspectiveCamera(60,1,0.1,100)
+    z.lookAt((5,0,0),(0,0,0),(0,0,1))
+    z.process(sc2)
+    for sh in sc2:
+        geom = sh.geometry
+        if isinstance(geom, Translated):
+            geom = geom.geometry
+        assert geom.pointList.getBufferId() == pts.getBufferId() and geom.pointList.isShared()
+        assert geom.indexList.getBufferId() == ind.getBufferId() and geom.indexList.isShared()
+
     
 if __name__ == '__main__':
     import traceback as tb
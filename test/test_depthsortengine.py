@@ -0,0 +1,54 @@
+from openalea.plantgl.all import *
+import random
+
+
+def square(depth, offset, id):
+    pts = [(depth,offset,offset),(depth,offset+1,offset),(depth,offset+1,offset+1),(depth,offset,offset+1)]
+    return Shape(TriangleSet(pts, [(0,1,2),(0,2,3)]), Material(), id)
+
+def random_canopy(nbleaves):
+    random.seed(0)
+    scene = Scene()
+    for i in range(nbleaves):
+        center = Vector3(random.uniform(0,5),random.uniform(0,5),random.uniform(0,5))
+        pts = [center + Vector3(random.uniform(-0.4,0.4),random.uniform(-0.4,0.4),random.uniform(-0.4,0.4)) for j in range(3)]
+        scene.add(Shape(TriangleSet(pts, [(0,1,2)]), Material(), i+1))
+    return scene
+
+def visible_areas(scene, parallelThreshold = 1024):
+    e = DepthSortEngine()
+    e.setOrthographicCamera(-10, 10, -10, 10, 0.1, 100)
+    e.lookAt((-20,2.5,2.5),(2.5,2.5,2.5),(0,0,1))
+    e.parallelThreshold = parallelThreshold
+    e.process(scene)
+    result = e.getProjectionResult(eARGB, True)
+    assert len(result) == e.getPolygonCount()
+    areas = {}
+    for sh in result:
+        a, b, c = sh.geometry.pointList
+        areas[sh.id] = areas.get(sh.id, 0) + abs((b.x-a.x)*(c.y-a.y)-(b.y-a.y)*(c.x-a.x)) / 2
+    return areas
+
+def test_depthsort_occlusion():
+    # the first square hides a quarter of the second one
+    areas = visible_areas(Scene([square(0, 0, 1), square(1, 0.5, 2)]))
+    assert abs(areas[1] - 1) < 1e-6
+    assert abs(areas[2] - 0.75) < 1e-6
+
+def test_depthsort_tiled_resolution():
+    scene = random_canopy(400)
+    initial = get_nb_threads()
+    try:
+        set_nb_threads(1)
+        untiled = visible_areas(scene, 1000000)
+        set_nb_threads(4)
+        tiled = visible_areas(scene, 1)
+    finally:
+        set_nb_threads(initial)
+    assert all(abs(untiled.get(i,0) - tiled.get(i,0)) < 1e-3 for i in set(untiled) | set(tiled))
+    assert abs(sum(untiled.values()) - sum(tiled.values())) < 1e-3
+
+
+if __name__ == '__main__':
+    test_depthsort_occlusion()
+    test_depthsort_tiled_resolution()
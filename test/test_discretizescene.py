@@ -0,0 +1,66 @@
+from openalea.plantgl.all import *
+from math import pi
+
+def make_scene(nb = 50):
+    scene = Scene()
+    shared = Sphere(1)
+    for i in range(nb):
+        scene += Shape(Translated((i, 0, 0), Cylinder(0.1, 1 + i * 0.1)))
+        scene += Shape(shared)
+        scene += Shape(Extrusion(Polyline([(0,0,0),(0,0,1),(0,i*0.1,2)]), Polyline2D.Circle(0.1,8)))
+    return scene
+
+def test_discretize_scene():
+    scene = make_scene()
+    d = Discretizer()
+    results = d.discretizeScene(scene)
+    assert len(results) == len(scene)
+    for sh, res in zip(scene, results):
+        assert sh.apply(d)
+        assert len(res.pointList) == len(d.result.pointList)
+        assert all(norm(p - q) < 1e-10 for p, q in zip(res.pointList, d.result.pointList))
+    # shapes sharing a geometry share its discretization
+    assert results[1].getObjectId() == results[4].getObjectId()
+
+def test_tesselate_scene():
+    scene = make_scene()
+    results = Tesselator().discretizeScene(scene)
+    assert all(isinstance(res, TriangleSet) for res in results)
+
+def test_shared_cache():
+    scene = make_scene()
+    cache = SharedDiscretizationCache()
+    d1, d2 = Discretizer(), Discretizer()
+    d1.sharedCache = cache
+    d2.sharedCache = cache
+    d1.discretizeScene(scene)
+    nbentries = len(cache)
+    assert nbentries > 0
+    cache.resetStatistics()
+    d1.discretizeScene(scene)
+    assert cache.statistics()['hits'] >= len(scene) // 3
+    # a consumer can reuse the results of another one
+    assert scene[1].geometry.apply(d2)
+    assert cache.statistics()['hits'] >= len(scene) // 3 + 1
+def test_discretize_shared_swung():
+    # the shapes do not share their geometry but all their Swung, whose sections are evaluated concurrently.
+    profiles = [NurbsCurve2D([(0,0,1),(1+0.5*i,1,1),(1,2,1),(0,3,1)]) for i in range(3)]
+    swung = Swung(profiles, [0, pi, 2*pi], slices = 32)
+    scene = Scene([Shape(Translated((i, 0, 0), swung)) for i in range(200)])
+    initial = get_nb_threads()
+    set_nb_threads(4)
+    try:
+        results = Discretizer().discretizeScene(scene)
+    finally:
+        set_nb_threads(initial)
+    d = Discretizer()
+    for sh, res in zip(scene, results):
+        assert sh.apply(d)
+        assert len(res.pointList) == len(d.result.pointList)
+        assert all(norm(p - q) < 1e-10 for p, q in zip(res.pointList, d.result.pointList))
+
+if __name__ == '__main__':
+    test_discretize_scene()
+    test_tesselate_scene()
+    test_shared_cache()
+    test_discretize_shared_swung()
@@ -0,0 +1,49 @@
+from openalea.plantgl.all import *
+import random
+
+def random_points(nbpoints = 2000, seed = 0):
+    random.seed(seed)
+    return Point3Array([Vector3(random.uniform(0,1),random.uniform(0,1),random.uniform(0,1)) for i in range(nbpoints)])
+
+def brute_force_knn(points, pid, k):
+    p = points[pid]
+    dists = sorted((normSquared(points[j] - p), j) for j in range(len(points)) if j != pid)
+    return [j for d, j in dists[:k]]
+
+def test_native_kdtree_knn():
+    points = random_points()
+    kdtree = NativeKDTree3(points)
+    assert len(kdtree) == len(points)
+    knn = kdtree.k_nearest_neighbors(5)
+    for pid in range(0, len(points), 50):
+        assert list(knn[pid]) == brute_force_knn(points, pid, 5)
+
+def test_native_kdtree_rnn():
+    points = random_points()
+    kdtree = NativeKDTree3(points, 4)
+    radius = 0.1
+    rnn = kdtree.r_nearest_neighbors(radius)
+    for pid in range(0, len(points), 50):
+        ref = set(j for j in range(len(points)) if j != pid and norm(points[j] - points[pid]) <= radius)
+        assert set(rnn[pid]) == ref
+
+def test_native_kdtree_batch_queries():
+    points = random_points()
+    # more queries than a chunk of the multithreaded queries
+    queries = random_points(3000, 1)
+    for kdtree in [NativeKDTree3(points), NativeKDTree3f(points)]:
+        res = kdtree.k_closest_points(queries, 3)
+        assert len(res) == len(queries)
+        for q, r in zip(queries[::10], res[::10]):
+            assert list(r) == list(kdtree.k_closest_points(q, 3))
+        rnn = kdtree.r_closest_points(queries, 0.05)
+        kdtree.multithreaded = False
+        assert list(map(list, res)) == list(map(list, kdtree.k_closest_points(queries, 3)))
+        assert list(map(list, rnn)) == list(map(list, kdtree.r_closest_points(queries, 0.05)))
+        for q, r in zip(queries[:20], rnn[:20]):
+            assert set(r) == set(j for j in range(len(points)) if norm(points[j] - q) <= 0.05)
+
+if __name__ == '__main__':
+    test_native_kdtree_knn()
+    test_native_kdtree_rnn()
+    test_native_kdtree_batch_queries()
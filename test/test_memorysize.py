@@ -0,0 +1,109 @@
+from openalea.plantgl.all import *
+
+
+def mesh(nbpoints = 1000):
+    pts = Point3Array([(i, i % 7, i % 3) for i in range(nbpoints)])
+    ind = Index3Array([Index3(i, i+1, i+2) for i in range(nbpoints-2)])
+    return TriangleSet(pts, ind)
+
+def statistics(scene):
+    stat = StatisticComputer()
+    scene.apply(stat)
+    return stat
+
+def test_memorysize_shared_instance():
+    ts = mesh()
+    single = statistics(Scene([Shape(ts, id = 1)]))
+    sc = Scene([Shape(ts, id = 1), Shape(Translated((1,0,0), ts), id = 2)])
+    stat = statistics(sc)
+    # the mesh referenced by two shapes is counted once
+    assert stat.memorySize < single.memorySize + 1000
+    assert stat.elements[31] == 2
+    shapes = stat.shapeMemorySizes
+    assert shapes[1] >= ts.pointList.getMemorySize() + ts.indexList.getMemorySize()
+    assert shapes[2] < 1000
+    assert sum(shapes.values()) == stat.memorySize
+    assert stat.memorySizes['TriangleSet'] > stat.memorySizes['Translated']
+
+def test_memorysize_reuse():
+    sc = Scene([Shape(mesh(), id = 1)])
+    stat = StatisticComputer()
+    sc.apply(stat)
+    size, elements, memsize = stat.size, list(stat.elements), stat.memorySize
+    # a second pass recomputes the same statistics.
+    sc.apply(stat)
+    assert stat.size == size and list(stat.elements) == elements
+    assert stat.memorySize == memsize > 0
+    assert stat.shapeMemorySizes[1] == memsize
+    stat.clear()
+    assert stat.size == 0 and stat.memorySize == 0 and len(stat.shapeMemorySizes) == 0
+
+def test_memorysize_arrays():
+    ts = mesh()
+    stat = statistics(Scene([Shape(ts)]))
+    arrays = stat.arrayStatistics
+    assert arrays['Point3Array']['count'] == 1
+    assert arrays['Point3Array']['size'] == len(ts.pointList)
+    assert arrays['Point3Array']['memorySize'] >= ts.pointList.getMemorySize()
+    assert arrays['Index3Array']['size'] == len(ts.indexList)
+
+def test_memorysize_deepcopy():
+    sc = Scene([Shape(mesh())])
+    sc2 = sc.deepcopy()
+    single = statistics(sc)
+    stat = statistics(sc + sc2)
+    # the elements of the copied arrays are shared until they are modified
+    assert stat.memorySize < single.memorySize + 1000
+    assert stat.sharedMemorySize >= sc[0].geometry.pointList.getMemorySize()
+    sc2[0].geometry.pointList.append(Vector3(0,0,0))
+    assert statistics(sc + sc2).memorySize > 2 * sc[0].geometry.pointList.getMemorySize()
+
+def test_cachebudget_soft_limit():
+    d = Discretizer()
+    spheres = [Sphere(1 + i, 32, 32) for i in range(5)]
+    assert spheres[0].apply(d)
+    assert CacheBudget.statistics()['Discretizer']['cost'] >= d.cacheStatistics()['cost'] > 0
+    entrycost = d.cacheStatistics()['cost']
+    d.clear()
+    limit = CacheBudget.getSoftLimit()
+    CacheBudget.setSoftLimit(CacheBudget.getTotalCost() + 2 * entrycost)
+    try:
+        for sp in spheres:
+            assert sp.apply(d)
+        assert d.cacheStatistics()['size'] == 2
+        assert d.cacheStatistics()['evictions'] == 3
+    finally:
+        CacheBudget.setSoftLimit(limit)
+    for sp in spheres:
+        assert sp.apply(d)
+    assert d.cacheStatistics()['size'] == 5
+
+def test_cachebudget_trim():
+    d1, d2 = Discretizer(), Discretizer()
+    spheres = [Sphere(1 + i, 32, 32) for i in range(4)]
+    for sp in spheres[:3]:
+        assert sp.apply(d1)
+    limit = CacheBudget.getSoftLimit()
+    CacheBudget.setSoftLimit(CacheBudget.getTotalCost())
+    try:
+        # a cache only evicts its own entries. d2 keeps its new entry and d1 is not trimmed.
+        assert spheres[3].apply(d2)
+        assert d2.cacheStatistics()['size'] == 1
+        assert d1.cacheStatistics()['size'] == 3
+        # a global trim is done by d1 the next time it is looked up. Its least recently used entry is evicted.
+        CacheBudget.trim()
+        assert spheres[2].apply(d1)
+        assert d1.cacheStatistics()['size'] == 2
+        assert d1.cacheStatistics()['evictions'] == 1
+        assert CacheBudget.getTotalCost() <= CacheBudget.getSoftLimit()
+    finally:
+        CacheBudget.setSoftLimit(limit)
+
+
+if __name__ == '__main__':
+    test_memorysize_shared_instance()
+    test_memorysize_reuse()
+    test_memorysize_arrays()
+    test_memorysize_deepcopy()
+    test_cachebudget_soft_limit()
+    test_cachebudget_trim()
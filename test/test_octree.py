@@ -0,0 +1,57 @@
+from openalea.plantgl.all import *
+from math import *
+
+
+def build_scene(nbshapes = 100):
+    import random
+    random.seed(0)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,10),random.uniform(0,10),random.uniform(0,10))
+        geom = Sphere(0.3,12,8) if i % 2 == 0 else AxisRotated((1,0,0), random.uniform(0,3), Cylinder(0.1,1))
+        scene.add(Shape(Translated(pos, geom), id = i))
+    return scene
+
+def check_details(octree, maxscale):
+    details = octree.getDetails()
+    assert len(details) == maxscale+1
+    assert details[0][1:] == [0,1,0]
+    for scale in range(maxscale):
+        # each undetermined node that is not at the max scale is decomposed into 8 children
+        assert sum(details[scale+1][1:]) == 8 * details[scale][2]
+
+def test_octree_details():
+    maxscale = 5
+    octree = Octree(build_scene(), maxscale, 10)
+    check_details(octree, maxscale)
+    size = octree.size
+    assert 0 < octree.getVolume() < 8 * size.x * size.y * size.z
+
+def test_octree_intersection():
+    scene = build_scene(20)
+    scene.add(Shape(Translated((5,5,-5), Sphere(1,32,32)), id = 100))
+    octree = Octree(scene, 6, 5)
+    res = octree.intersection(Ray(Vector3(5.01,5.02,-6.3),Vector3(0,0,1)))
+    assert res is not None
+    assert abs(res.z + 6) < 1e-2
+    assert abs(res.x - 5.01) < 1e-5 and abs(res.y - 5.02) < 1e-5
+    assert octree.intersection(Ray(Vector3(5.01,5.02,-6.3),Vector3(0,0,-1))) is None
+
+def test_octree_setscene():
+    octree = Octree(build_scene(), 4, 10)
+    details = octree.getDetails()
+    octree.scene = build_scene(10)
+    check_details(octree, 4)
+    assert sum(octree.getDetails()[4][1:]) < sum(details[4][1:])
+
+def test_octree_shapebased():
+    maxscale = 4
+    octree = Octree(build_scene(20), maxscale, 10, Octree.ShapeBased)
+    check_details(octree, maxscale)
+
+
+if __name__ == '__main__':
+    test_octree_details()
+    test_octree_intersection()
+    test_octree_setscene()
+    test_octree_shapebased()
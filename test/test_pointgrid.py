@@ -1,5 +1,6 @@
 from openalea.plantgl.all import *
 from random import uniform, randint
+from math import pi, cos
 
 pointrange = (0,10)
 
@@ -46,6 +47,47 @@ def test_point3grid_ball():
     assert p3grid.index(vid) == vcoord
     assert p3grid.getVoxelCenter(vcoord) == p3grid.getVoxelCenterFromId(vid)
 
+def test_pointgrid_disable():
+    nbpoint = 2000
+    p3list = [random_point() for i in range(nbpoint)]
+    p3grid = Point3Grid((0.5,0.5,0.5),p3list)
+    disabled = set()
+    for i in range(5000):
+        pid = randint(0,nbpoint-1)
+        if randint(0,1):
+            assert p3grid.disable_point(pid) == (not pid in disabled)
+            disabled.add(pid)
+        else:
+            assert p3grid.enable_point(pid) == (pid in disabled)
+            disabled.discard(pid)
+    assert set(p3grid.get_disabled_point_indices()) == disabled
+    center = Vector3(5,5,5)
+    pball = p3grid.query_ball_point(center,3)
+    assert set(pball) == set([i for i,p in enumerate(p3list) if not i in disabled and norm(p-center) <= 3])
+
+def test_pointgrid_cones():
+    nbpoint = 2000
+    p3list = [random_point() for i in range(nbpoint)]
+    p3grid = Point3Grid((0.5,0.5,0.5),p3list)
+    disabled = set([randint(0,nbpoint-1) for i in range(200)])
+    for pid in disabled:
+        p3grid.disable_point(pid)
+    origin = Vector3(4,5,6)
+    directions = [Vector3(0,0,1),Vector3(1,1,0),Vector3(-1,0.2,-0.3)]
+    cones = p3grid.query_points_in_cones(origin,directions,3,pi/2)
+    assert len(cones) == len(directions)
+    cosangle = cos(pi/4)
+    for d, cone in zip(directions, cones):
+        d = d.normed()
+        expected = set()
+        for i,p in enumerate(p3list):
+            if i in disabled : continue
+            dist = norm(p-origin)
+            if dist <= 3 and dist > 0 and dot((p-origin)/dist,d) > cosangle:
+                expected.add(i)
+        assert set(cone) == expected
+        assert set(p3grid.query_points_in_cone(origin,d,3,pi/2)) == expected
+
 def test_pointgrid_access():
     p3list = [(1,1,1),(6,6,6),(10,10,10),(20,20,20)]
     r = 0
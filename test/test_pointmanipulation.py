@@ -38,6 +38,89 @@ def test_median_point():
 
 
 
+def grid_graph(size = 12):
+    points = Point3Array([(i,j,0) for i in range(size) for j in range(size)])
+    adjacencies = []
+    for i in range(size):
+        for j in range(size):
+            adjacencies.append([ni*size+nj for ni,nj in [(i-1,j),(i+1,j),(i,j-1),(i,j+1)] if 0 <= ni < size and 0 <= nj < size])
+    return points, adjacencies
+
+def test_repeated_neighborhoods():
+    points, adjacencies = grid_graph()
+    radius = 2.5
+    expected = [sorted(r_neighborhood(i, points, adjacencies, radius)) for i in range(len(points))]
+    assert [sorted(n) for n in r_neighborhoods(points, adjacencies, radius)] == expected
+    assert [sorted(n) for n in r_neighborhoods(points, adjacencies, RealArray([radius]*len(points)))] == expected
+    assert [sorted(n) for n in r_neighborhoods_mt(points, adjacencies, radius)] == expected
+    k = 7
+    expected = [list(k_neighborhood(i, points, adjacencies, k)) for i in range(len(points))]
+    assert [list(n) for n in k_neighborhoods(points, adjacencies, k)] == expected
+
+
+def test_csr_neighborhoods():
+    points, adjacencies = grid_graph()
+    adjacencies = IndexArray(adjacencies)
+    csradjacencies = CSRIndexArray(adjacencies)
+    assert len(csradjacencies) == len(adjacencies)
+    assert csradjacencies.getNbIndices() == sum(len(a) for a in adjacencies)
+    assert list(csradjacencies[5]) == list(adjacencies[5])
+    assert [list(a) for a in csradjacencies.toIndexArray()] == [list(a) for a in adjacencies]
+    radius = 2.5
+    expected = [list(n) for n in r_neighborhoods(points, adjacencies, radius)]
+    assert [list(n) for n in r_neighborhoods(points, csradjacencies, radius).toIndexArray()] == expected
+    assert [list(n) for n in r_neighborhoods_mt(points, csradjacencies, radius).toIndexArray()] == expected
+    expected = [list(n) for n in k_neighborhoods(points, adjacencies, 7)]
+    assert [list(n) for n in k_neighborhoods(points, csradjacencies, 7).toIndexArray()] == expected
+    oriented = IndexArray([[i+1] for i in range(9)]+[[]])
+    expected = [list(n) for n in symmetrize_connections(oriented)]
+    assert [list(n) for n in symmetrize_connections(CSRIndexArray(oriented)).toIndexArray()] == expected
+
+
+def test_parallel_matches_serial():
+    points, adjacencies = grid_graph(30)
+    adjacencies = IndexArray(adjacencies)
+    directions = Point3Array([(1,0.2*(i%5),0) for i in range(len(points))])
+    radii = RealArray([1.5 + 0.1*(i%7) for i in range(len(points))])
+    nodes = Point3Array([(i*3,i*2,0) for i in range(10)])
+    parents = Uint32Array1([0]+list(range(9)))
+    def compute():
+        return ([list(n) for n in r_anisotropic_neighborhoods(points, adjacencies, radii, directions, 0.5, 1.0)],
+                [list(n) for n in r_anisotropic_neighborhoods(points, adjacencies, 2.5, directions, 0.5, 1.0)],
+                list(densities_from_r_neighborhood(points, adjacencies, 2.5)),
+                list(centroids_of_groups(points, r_neighborhoods(points, adjacencies, 2.5))),
+                list(estimate_radii_from_points(points, nodes, parents)))
+    nbthreads = get_nb_threads()
+    set_nb_threads(1)
+    serial = compute()
+    set_nb_threads(4)
+    parallel = compute()
+    set_nb_threads(nbthreads)
+    assert serial == parallel
+
+def test_parallel_on_shared_arrays():
+    points, adjacencies = grid_graph(30)
+    adjacencies = IndexArray(adjacencies)
+    directions = Point3Array([(1,0.2*(i%5),0) for i in range(len(points))])
+    nodes = Point3Array([(i*3,i*2,0) for i in range(10)])
+    parents = Uint32Array1([0]+list(range(9)))
+    def compute(points, directions):
+        centers, radii = pointsets_section_circles(points, adjacencies, directions, 1.5)
+        return (list(centers), list(radii), list(estimate_radii_from_points(points, nodes, parents)))
+    expected = compute(points, directions)
+    # the copies share the elements of the arrays until they are modified
+    copies = [PointSet(a).deepcopy().pointList for a in (points, directions)]
+    assert all(c.isShared() for c in copies)
+    nbthreads = get_nb_threads()
+    set_nb_threads(4)
+    try:
+        result = compute(*copies)
+    finally:
+        set_nb_threads(nbthreads)
+    assert result == expected
+    # the kernels read the arrays without copying them
+    assert all(c.isShared() for c in copies)
+
 if __name__ == '__main__':
     for i in range(50):
         test_median_point()
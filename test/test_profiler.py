@@ -0,0 +1,74 @@
+from openalea.plantgl.all import *
+import json, os, shutil, tempfile
+
+
+def build_scene(nbshapes = 100):
+    import random
+    random.seed(0)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(0,10),random.uniform(0,10),random.uniform(0,10))
+        scene.add(Shape(Translated(pos, Sphere(0.3,12,8)), id = i))
+    return scene
+
+def profile(function):
+    Profiler.clear()
+    Profiler.enable()
+    try:
+        function()
+    finally:
+        Profiler.disable()
+
+def zones():
+    return dict((s.path, s) for s in Profiler.statistics())
+
+def test_profiler_disabled():
+    Profiler.clear()
+    assert not Profiler.isEnabled()
+    Octree(build_scene(10), 3, 10)
+    assert len(Profiler.statistics()) == 0
+
+def test_profiler_octree():
+    scene = build_scene()
+    profile(lambda : Octree(scene, 4, 10))
+    stats = zones()
+    assert stats['Octree::build'].count == 1
+    assert stats['Octree::build/Discretizer::discretize'].depth == 1
+    assert stats['Octree::build'].wallTime >= stats['Octree::build/Discretizer::discretize'].wallTime
+    assert 'Octree::build' in Profiler.summary()
+
+def test_profiler_codec():
+    scene = build_scene(10)
+    tmpdir = tempfile.mkdtemp()
+    fname = os.path.join(tmpdir, 'profiled.bgeom')
+    def io():
+        scene.save(fname)
+        Scene(fname)
+    try:
+        profile(io)
+    finally:
+        shutil.rmtree(tmpdir)
+    names = set(s.name for s in Profiler.statistics())
+    assert 'BinaryPrinter::print' in names
+    assert 'BinaryParser::parse' in names
+
+def test_profiler_chrometrace():
+    profile(lambda : Octree(build_scene(), 4, 10))
+    trace = json.loads(Profiler.chromeTrace())
+    events = trace['traceEvents']
+    assert len(events) == sum(s.count for s in Profiler.statistics())
+    assert all(e['ph'] == 'X' and e['dur'] >= 0 for e in events)
+    Profiler.setMaxTraceEvents(1)
+    try:
+        profile(lambda : Octree(build_scene(), 4, 10))
+        assert Profiler.getMaxTraceEvents() == 1
+        assert len(json.loads(Profiler.chromeTrace())['traceEvents']) < len(events)
+    finally:
+        Profiler.setMaxTraceEvents(1000000)
+
+
+if __name__ == '__main__':
+    test_profiler_disabled()
+    test_profiler_octree()
+    test_profiler_codec()
+    test_profiler_chrometrace()
@@ -0,0 +1,47 @@
+from openalea.plantgl.all import *
+import random
+
+
+def make_attractors(nbattractors = 3000):
+    random.seed(0)
+    center = Vector3(0, 0, 1.2)
+    points = []
+    while len(points) < nbattractors:
+        p = Vector3(random.uniform(-1, 1), random.uniform(-1, 1), random.uniform(0, 2))
+        if norm(p - center) < 1:
+            points.append(p)
+    return Point3Array(points)
+
+class PythonBuds (SpaceColonization):
+    """ Generate the buds as the C++ generate_buds, without the attractors perceived in advance. """
+    def generate_buds(self, pid):
+        direction = self.node_direction(pid)
+        for d in self.lateral_directions(direction, self.insertion_angle, self.nb_buds_per_whorl) + [direction]:
+            self.try_to_set_bud(pid, d)
+
+def grow(nbthreads, colonization = SpaceColonization, nbsteps = 10):
+    initial = get_nb_threads()
+    set_nb_threads(nbthreads)
+    try:
+        sc = colonization(make_attractors(), 0.05, 0.045, 0.25, Vector3(0, 0, 0.3), 30)
+        sc.iterate(nbsteps)
+    finally:
+        set_nb_threads(initial)
+    return sc
+
+def same_skeleton(sc1, sc2):
+    return (list(sc1.parents) == list(sc2.parents) and 
+            all(norm(p - q) < 1e-10 for p, q in zip(sc1.nodes, sc2.nodes)))
+
+def test_spacecolonization_threads():
+    reference = grow(1)
+    assert len(reference.nodes) > 10
+    assert same_skeleton(reference, grow(4))
+
+def test_spacecolonization_python_buds():
+    assert same_skeleton(grow(1), grow(4, PythonBuds))
+
+
+if __name__ == '__main__':
+    test_spacecolonization_threads()
+    test_spacecolonization_python_buds()
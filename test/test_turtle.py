@@ -76,6 +76,40 @@ def test_turtle_customgeometry():
     assert isinstance(a2, pgl.AsymmetricHull) 
     assert a.getPglId() == a2.getPglId()
 
+def draw_branching(p, nbsteps = 20):
+    p.setWidth(0.2)
+    for i in range(nbsteps):
+        p.push()
+        p.down(30)
+        p.rollL(137*i)
+        p.F(1, 0.2 if i % 2 else 0)
+        p.sphere(0.3)
+        p.pglShape(pgl.Box(0.1,0.2,0.3))
+        # a frustum is not instanced
+        p.setWidth(0.2)
+        p.F(0.5, 0.1)
+        p.pop()
+        p.F(1)
+        p.rollL(40)
+
+def test_turtle_instancing():
+    p = pgl.PglTurtle()
+    draw_branching(p)
+    drawer = pgl.PglTurtleDrawer()
+    drawer.instancing = True
+    pi = pgl.PglTurtle(drawer)
+    draw_branching(pi)
+    instances = drawer.getInstances()
+    assert len(instances) == len(p.getScene())
+    # only one prototype per primitive type and resolution
+    assert len([g for g in instances.getPrototypes() if not isinstance(retrieve_primitive(g), pgl.Frustum)]) < 6
+    # shapes keep the drawing order
+    primitives = lambda sc : [type(retrieve_primitive(sh)) for sh in sc]
+    assert primitives(pi.getScene()) == primitives(p.getScene())
+    cs, csi = pgl.CompiledScene(p.getScene()), pgl.CompiledScene(instances)
+    assert cs.nbTriangles == csi.nbTriangles
+    assert all(pgl.norm(a-b) < 1e-6 for a, b in zip(cs.getPointList(), csi.getPointList()))
+
 
 if __name__ == '__main__':
     import traceback as tb
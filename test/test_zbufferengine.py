@@ -164,6 +164,21 @@ def test_formfactors():
     result = formFactors(tr.pointList,tr.indexList,ccw=True,solidangle=True)
     print(result)
 
+def test_sparseformfactors():
+    tr = Scene(join(dirname(__file__),'data/cube.obj'))[0].geometry
+    t = Tesselator()
+    tr.apply(t)
+    tr = t.result
+    dense = formFactors(tr.pointList,tr.indexList,ccw=True,discretization=50,solidangle=False)
+    rowpointers, columns, values = sparseFormFactors(tr.pointList,tr.indexList,ccw=True,discretization=50,solidangle=False)
+    nbtriangles = len(tr.indexList)
+    assert len(rowpointers) == nbtriangles+1
+    assert rowpointers[nbtriangles] == len(columns) == len(values)
+    for i in range(nbtriangles):
+        row = dict((columns[k], values[k]) for k in range(rowpointers[i],rowpointers[i+1]))
+        for j in range(nbtriangles):
+            assert dense[i,j] == row.get(j,0)
+
 def test_solidangle(view = False):
     angle = 359
     rangle = radians(angle)
@@ -183,6 +198,202 @@ def test_solidangle(view = False):
         plt.colorbar(p)
         plt.show()
 
+def tiled_scene(nbshapes = 200):
+    import random
+    random.seed(0)
+    scene = Scene()
+    for i in range(nbshapes):
+        pos = Vector3(random.uniform(-5,5),random.uniform(-5,5),random.uniform(-5,5))
+        scene.add(Shape(Translated(pos, Sphere(random.uniform(0.2,1),12,12)), Material((random.randint(0,255),random.randint(0,255),random.randint(0,255))), i+1))
+    scene.add(Shape(PointSet([(0,0,0),(1,1,1),(2,0,3)]), Material((255,0,0)), nbshapes+1))
+    scene.add(Shape(Polyline([(0,-5,-5),(0,5,5)]), Material((0,255,0)), nbshapes+2))
+    return scene
+
+def render_tiled_scene(scene, multithreaded, tilebinning, style = eIdAndColorBased):
+    z = ZBufferEngine(300,200, renderingStyle=style, multithreaded = multithreaded)
+    z.setPerspectiveCamera(60,1.5,0.1,1000)
+    z.lookAt((20,3,2),(0,0,0),(0,0,1))
+    z.setTileBinning(tilebinning, 16)
+    z.process(scene)
+    return z
+
+def test_tilebinning():
+    scene = tiled_scene()
+    nbthreads = ZBufferEngine.getNbThreads()
+    ZBufferEngine.setNbThreads(4)
+    try:
+        ref = render_tiled_scene(scene, False, False)
+        tiled = render_tiled_scene(scene, True, True)
+    finally:
+        ZBufferEngine.setNbThreads(nbthreads)
+    assert tiled.tileBinning and tiled.tileSize == 16
+    assert (ref.getIdBufferAsImage().to_array() == tiled.getIdBufferAsImage().to_array()).all()
+    assert (ref.getDepthBuffer().to_array() == tiled.getDepthBuffer().to_array()).all()
+    assert (ref.getImage().to_array() == tiled.getImage().to_array()).all()
+
+def test_spanshading():
+    scene = tiled_scene()
+    for style in [eIdBased, eColorBased, eIdAndColorBased]:
+        results = []
+        for spanshading in [False, True]:
+            z = ZBufferEngine(300,200, renderingStyle=style, multithreaded = False)
+            z.setPerspectiveCamera(60,1.5,0.1,1000)
+            z.lookAt((20,3,2),(0,0,0),(0,0,1))
+            z.spanShading = spanshading
+            z.process(scene)
+            results.append(z)
+        ref, span = results
+        assert span.spanShading and not ref.spanShading
+        assert (ref.getDepthBuffer().to_array() == span.getDepthBuffer().to_array()).all()
+        if style & eIdBased:
+            assert (ref.getIdBufferAsImage().to_array() == span.getIdBufferAsImage().to_array()).all()
+        if style & eColorBased:
+            assert (ref.getImage().to_array() == span.getImage().to_array()).all()
+
+def test_orthographic_spanshading():
+    scene = Scene([Shape(Translated((0,-4,0),Sphere(2,32,32)), Material((255,0,0)), 1),
+                   Shape(Translated((0,3,2),Sphere(1.5,32,32)), Material((0,255,0)), 2),
+                   Shape(Translated((-3,1,-3),Sphere(1,32,32)), Material((0,0,255)), 3)])
+    results = []
+    for spanshading in [False, True]:
+        z = ZBufferEngine(301,301, renderingStyle=eIdAndColorBased, multithreaded = False)
+        z.setOrthographicCamera(-7,7,-7,7,0.1,100)
+        z.lookAt((10,0,0),(0,0,0),(0,0,1))
+        z.spanShading = spanshading
+        z.process(scene)
+        results.append(z.getIdBuffer().to_array())
+    ref, span = results
+    # the rays sample the corners of the pixels and the spans their centers. Only the borders of the shapes differ.
+    for sid in [1,2,3]:
+        assert abs((ref == sid).sum() - (span == sid).sum()) <= 0.03 * (ref == sid).sum()
+    # with spans, the depth is the distance along the view axis.
+    quad = TriangleSet([(0,-1,-1),(0,1,-1),(0,1,1),(0,-1,1)], [(0,1,2),(0,2,3)])
+    z = ZBufferEngine(64,64, renderingStyle=eIdBased, multithreaded = False)
+    z.setOrthographicCamera(-2,2,-2,2,0.1,100)
+    z.lookAt((5,0,0),(0,0,0),(0,0,1))
+    z.process(Scene([Shape(quad, Material(), 1)]))
+    covered = z.getIdBuffer().to_array() == 1
+    assert covered.sum() == 32*32
+    assert (abs(z.getDepthBuffer().to_array()[covered] - 5) < 1e-5).all()
+
+def test_transparent_idshading():
+    # the second sphere and the quad are totally transparent and hide the first sphere.
+    quad = TriangleSet([(5,-3,-2),(5,-0.5,-2),(5,-0.5,2),(5,-3,2)], [(0,1,2),(0,2,3)], 
+                       colorList = [Color4(0,0,255,255)]*4, colorPerVertex = True)
+    scene = Scene([Shape(Sphere(2,24,24), Material((255,0,0)), 1),
+                   Shape(Translated((8,1,1),Sphere(2,24,24)), Material((0,255,0), transparency = 1), 2),
+                   Shape(quad, Material(), 3)])
+    for spanshading in [False, True]:
+        results = []
+        for style in [eIdBased, eIdAndColorBased]:
+            z = ZBufferEngine(300,200, renderingStyle=style, multithreaded = False)
+            z.setPerspectiveCamera(60,1.5,0.1,1000)
+            z.lookAt((20,3,2),(0,0,0),(0,0,1))
+            z.spanShading = spanshading
+            z.process(scene)
+            results.append(z.getIdBuffer().to_array())
+        idonly, idandcolor = results
+        assert (idonly == idandcolor).all()
+        assert (idonly == 1).any() and not (idonly == 2).any() and not (idonly == 3).any()
+    mv = MultiViewZBufferEngine(300,200)
+    mv.setScene(scene)
+    camera = PerspectiveCamera(-0.05,0.05,-0.1/3,0.1/3,0.1,1000)
+    camera.lookAt((20,3,2),(0,0,0),(0,0,1))
+    mv.addView(camera)
+    mv.process(solidangle = False)
+    ids = mv.getIdBuffer(0).to_array()
+    assert (ids == 1).any() and not (ids == 2).any() and not (ids == 3).any()
+
+def checker_image(size = 64):
+    img = Image(size, size, 4)
+    for y in range(size):
+        for x in range(size):
+            img.setPixelAt(x, y, Color4(255,255,255,0) if (x//2 + y//2) % 2 else Color4(0,0,0,0))
+    return img
+
+def test_mipmaptexture():
+    img = checker_image()
+    texture = MipmapTexture(img)
+    assert texture.nbLevels() == 7
+    assert texture.width(6) == texture.height(6) == 1
+    assert texture.getTexelAt(3, 5) == img.getPixel4At(3, 5)
+    # a texel center at the finest level returns the texel
+    assert texture.sample(10.5/64, 1-20.5/64) == img.getPixel4At(10, 20)
+    # each 2x2 block is uniform, the next levels average black and white
+    assert texture.getTexelAt(1, 1, 1).red == 0
+    assert texture.getTexelAt(1, 1, 2).red == 128
+    assert texture.getLevelOfDetail(1, 16*16) == 2
+
+def test_texture_spanshading():
+    import tempfile, os, shutil
+    tmpdir = tempfile.mkdtemp()
+    try:
+        fname = os.path.join(tmpdir, 'checker.png')
+        checker_image(256).save(fname)
+        quad = TriangleSet([(0,-1,-1),(0,1,-1),(0,1,1),(0,-1,1)], [(0,1,2),(0,2,3)], 
+                           texCoordList = [(0,0),(1,0),(1,1),(0,1)])
+        scene = Scene([Shape(quad, Texture2D(ImageTexture(fname)))])
+        results = []
+        for spanshading in [False, True]:
+            z = ZBufferEngine(32,32, renderingStyle=eColorBased, multithreaded = False)
+            z.setPerspectiveCamera(60,1,0.1,1000)
+            z.lookAt((1.5,0,0),(0,0,0),(0,0,1))
+            z.spanShading = spanshading
+            z.process(scene)
+            results.append(z.getImage().to_array())
+    finally:
+        shutil.rmtree(tmpdir)
+    assert (results[0] == results[1]).all()
+    # the checker cells are several times smaller than a pixel. They are filtered to a uniform gray.
+    assert results[0].min() >= 127 and results[0].max() <= 128
+    assert MipmapTexture.getCacheHits() >= 1
+
+def test_multiview():
+    scene = tiled_scene()
+    eyes = [(20,3,2),(-20,3,2),(3,20,-2),(0,0,25)]
+    mv = MultiViewZBufferEngine(300,200)
+    mv.setScene(scene)
+    for eye in eyes:
+        camera = PerspectiveCamera(-0.05,0.05,-0.1/3,0.1/3,0.1,1000)
+        camera.lookAt(eye,(0,0,0),(0,0,1))
+        mv.addView(camera)
+    assert mv.getNbViews() == len(eyes)
+    mv.process(solidangle = False)
+    for i, eye in enumerate(eyes):
+        z = ZBufferEngine(300,200, renderingStyle=eIdBased, multithreaded = False)
+        z.setFrustumCamera(-0.05,0.05,-0.1/3,0.1/3,0.1,1000)
+        z.lookAt(eye,(0,0,0),(0,0,1))
+        z.process(scene)
+        # the shapes are transformed before the projection, which may move a few pixels at the borders.
+        diff = (z.getIdBuffer().to_array() != mv.getIdBuffer(i).to_array()).sum()
+        assert diff <= 0.001 * 300 * 200
+        histo = dict(mv.idhistogram(i))
+        assert sum(histo.values()) == (mv.getIdBuffer(i).to_array() != Shape.NOID).sum()
+    mv.process(keepBuffers = False)
+    assert mv.getIdBuffer(0) is None and len(mv.idhistograms()) == len(eyes)
+
+def test_projectionstatistics():
+    scene = Scene([Shape(Translated((0,-2,0),Sphere(1,32,32)), Material((255,0,0)), 1),
+                   Shape(Translated((0,2,0),Sphere(0.5,32,32)), Material((0,255,0)), 2),
+                   Shape(Translated((-3,-2,0),Sphere(0.8,32,32)), Material((0,0,255)), 3)])
+    camera = OrthographicCamera(-4,4,-4,4,0.1,100)
+    camera.lookAt((10,0,0),(0,0,0),(0,0,1))
+    sizes = projectionSizes(scene, camera, 401, 401)
+    assert [sid for sid, size in sizes] == [1,2,3]
+    for (sid, size), radius in zip(sizes, [1,0.5,0.8]):
+        assert abs(size - pi*radius**2) < 0.05 * pi*radius**2
+    # the third sphere is hidden by the first one. An odd resolution keeps pixel centers off the meridians.
+    counts, pixelwidth = pixelPerShape(scene, camera, 401, 401)
+    assert abs(pixelwidth - 8/401.) < 1e-6
+    assert [sid for sid, nbpixels in counts] == [1,2]
+    assert abs(counts[0][1] * pixelwidth**2 - sizes[0][1]) < 1e-6
+    hits = castRays(scene, camera, 401, 401)
+    assert len(hits) == 401 and len(hits[0]) == 401
+    center = hits[100][200]
+    assert [h[0] for h in center] == [1,3]
+    for (sid, back, front), radius in zip(center, [1,0.8]):
+        assert abs((front.x - back.x) - 2*radius) < 0.05
+
 if __name__ == '__main__':
     test_solidangle()
     #test_formfactors()